@@ -5121,6 +5121,61 @@ static void test_RegRenameKey(void)
     RegCloseKey(key);
 }
 
+static void test_large_key(void)
+{
+    char name[32], prev[32];
+    DWORD i, count, len;
+    HKEY key, subkey;
+    LSTATUS ret;
+
+    ret = RegCreateKeyExA(hkey_main, "TestLargeKey", 0, NULL, 0, KEY_ALL_ACCESS, NULL, &key, NULL);
+    ok(!ret, "Unexpected return value %ld.\n", ret);
+
+    /* create the subkeys in reverse order, with enough of them for the key to get indexed */
+    for (i = 0; i < 1000; i++)
+    {
+        sprintf(name, "subkey%04lu", 999 - i);
+        ret = RegCreateKeyExA(key, name, 0, NULL, 0, KEY_ALL_ACCESS, NULL, &subkey, NULL);
+        ok(!ret, "%s: unexpected return value %ld.\n", name, ret);
+        RegCloseKey(subkey);
+    }
+    for (i = 0; i < 1000; i += 3)
+    {
+        sprintf(name, "SUBKEY%04lu", i);
+        ret = RegDeleteKeyA(key, name);
+        ok(!ret, "%s: unexpected return value %ld.\n", name, ret);
+    }
+
+    ret = RegQueryInfoKeyA(key, NULL, NULL, NULL, &count, NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+    ok(!ret, "Unexpected return value %ld.\n", ret);
+    ok(count == 666, "Unexpected subkey count %lu.\n", count);
+
+    /* subkeys are enumerated in alphabetical order */
+    prev[0] = 0;
+    for (i = 0; i < count; i++)
+    {
+        len = sizeof(name);
+        ret = RegEnumKeyExA(key, i, name, &len, NULL, NULL, NULL, NULL);
+        ok(!ret, "%lu: unexpected return value %ld.\n", i, ret);
+        ok(lstrcmpiA(prev, name) < 0, "%lu: got %s after %s.\n", i, name, prev);
+        strcpy(prev, name);
+    }
+    len = sizeof(name);
+    ret = RegEnumKeyExA(key, i, name, &len, NULL, NULL, NULL, NULL);
+    ok(ret == ERROR_NO_MORE_ITEMS, "Unexpected return value %ld.\n", ret);
+
+    for (i = 0; i < 1000; i++)
+    {
+        sprintf(name, "Subkey%04lu", i);
+        ret = RegOpenKeyExA(key, name, 0, KEY_READ, &subkey);
+        ok(ret == (i % 3 ? ERROR_SUCCESS : ERROR_FILE_NOT_FOUND), "%s: unexpected return value %ld.\n", name, ret);
+        if (!ret) RegCloseKey(subkey);
+    }
+
+    delete_key(key);
+    RegCloseKey(key);
+}
+
 START_TEST(registry)
 {
     /* Load pointers for functions that are not available in all Windows versions */
@@ -5161,6 +5216,7 @@ START_TEST(registry)
     test_EnumDynamicTimeZoneInformation();
     test_perflib_key();
     test_RegRenameKey();
+    test_large_key();
 
     /* cleanup */
     delete_key( hkey_main );
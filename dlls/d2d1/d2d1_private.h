@@ -170,6 +170,37 @@ struct d2d_indexed_objects
     size_t count;
 };
 
+struct d2d_effect_intermediate
+{
+    struct d2d_bitmap *bitmap;
+    bool in_use;
+};
+
+struct d2d_effect_blend_state
+{
+    D3D11_RENDER_TARGET_BLEND_DESC desc;
+    ID3D11BlendState *state;
+};
+
+struct d2d_effect_renderer
+{
+    struct d2d_effect_intermediate **intermediates;
+    size_t intermediates_size;
+    size_t intermediate_count;
+
+    struct d2d_effect_blend_state *blend_states;
+    size_t blend_states_size;
+    size_t blend_state_count;
+
+    ID3D11Buffer *vs_cb;
+    ID3D11Buffer *ps_cb;
+    ID3D11Buffer *input_cb;
+    ID3D11SamplerState *point_sampler;
+    ID3D11SamplerState *linear_sampler;
+};
+
+void d2d_effect_renderer_cleanup(struct d2d_effect_renderer *renderer);
+
 struct d2d_device_context
 {
     ID2D1DeviceContext6 ID2D1DeviceContext6_iface;
@@ -221,6 +252,8 @@ struct d2d_device_context
     struct d2d_clip_stack clip_stack;
 
     struct d2d_indexed_objects vertex_buffers;
+
+    struct d2d_effect_renderer effect_renderer;
 };
 
 HRESULT d2d_d3d_create_render_target(struct d2d_device *device, IDXGISurface *surface, IUnknown *outer_unknown,
@@ -498,6 +531,36 @@ struct d2d_curve_outline_vertex
     D2D1_POINT_2F prev, next;
 };
 
+/* The fill and outline buffers of a geometry, uploaded for a particular
+ * device. Cached meshes are linked into both the factory and the geometry
+ * that owns the tessellation data. */
+struct d2d_geometry_mesh
+{
+    struct list entry;
+    struct list geometry_entry;
+    const struct d2d_device *device;
+
+    struct
+    {
+        ID3D11Buffer *ib;
+        ID3D11Buffer *vb;
+        ID3D11Buffer *bezier_vb;
+        ID3D11Buffer *arc_vb;
+        BOOL uploaded;
+    } fill;
+
+    struct
+    {
+        ID3D11Buffer *ib;
+        ID3D11Buffer *vb;
+        ID3D11Buffer *bezier_ib;
+        ID3D11Buffer *bezier_vb;
+        ID3D11Buffer *arc_ib;
+        ID3D11Buffer *arc_vb;
+        BOOL uploaded;
+    } outline;
+};
+
 struct d2d_geometry
 {
     ID2D1Geometry ID2D1Geometry_iface;
@@ -507,6 +570,9 @@ struct d2d_geometry
 
     D2D_MATRIX_3X2_F transform;
 
+    struct list meshes;
+    unsigned int draw_count;
+
     struct
     {
         D2D1_POINT_2F *vertices;
@@ -607,6 +673,35 @@ HRESULT d2d_geometry_group_init(struct d2d_geometry *geometry, ID2D1Factory *fac
         D2D1_FILL_MODE fill_mode, ID2D1Geometry **src_geometries, unsigned int geometry_count);
 struct d2d_geometry *unsafe_impl_from_ID2D1Geometry(ID2D1Geometry *iface);
 
+HRESULT d2d_geometry_mesh_upload_fill(struct d2d_geometry_mesh *mesh,
+        const struct d2d_geometry *geometry, ID3D11Device1 *device);
+HRESULT d2d_geometry_mesh_upload_outline(struct d2d_geometry_mesh *mesh,
+        const struct d2d_geometry *geometry, ID3D11Device1 *device);
+void d2d_geometry_mesh_cleanup(struct d2d_geometry_mesh *mesh);
+struct d2d_geometry_mesh *d2d_geometry_get_mesh(struct d2d_geometry *geometry,
+        const struct d2d_device *device, ID3D11Device1 *d3d_device, BOOL outline);
+void d2d_geometry_purge_meshes(ID2D1Factory *factory, const struct d2d_device *device);
+
+struct d2d_geometry_realization
+{
+    ID2D1GeometryRealization ID2D1GeometryRealization_iface;
+    LONG refcount;
+
+    ID2D1Factory *factory;
+    ID2D1Geometry *geometry;
+    ID3D11Device1 *device;
+    struct d2d_geometry_mesh mesh;
+
+    BOOL stroked;
+    float stroke_width;
+    ID2D1StrokeStyle *stroke_style;
+};
+
+HRESULT d2d_geometry_realization_create(ID2D1Factory *factory, ID3D11Device1 *device,
+        ID2D1Geometry *geometry, BOOL stroked, float stroke_width, ID2D1StrokeStyle *stroke_style,
+        struct d2d_geometry_realization **realization);
+struct d2d_geometry_realization *unsafe_impl_from_ID2D1GeometryRealization(ID2D1GeometryRealization *iface);
+
 struct d2d_device
 {
     ID2D1Device6 ID2D1Device6_iface;
@@ -696,6 +791,9 @@ struct d2d_factory
     struct list effects;
     INIT_ONCE init_builtins;
 
+    SRWLOCK mesh_lock;
+    struct list meshes;
+
     CRITICAL_SECTION cs;
     D2D1_FACTORY_TYPE factory_type;
 };
@@ -706,6 +804,7 @@ static inline struct d2d_factory *unsafe_impl_from_ID2D1Factory(ID2D1Factory *if
 }
 
 void d2d_effects_init_builtins(struct d2d_factory *factory);
+void d2d_effects_init_filters(struct d2d_factory *factory);
 struct d2d_effect_registration * d2d_factory_get_registered_effect(ID2D1Factory *factory,
         const GUID *effect_id);
 void d2d_factory_register_effect(struct d2d_factory *factory,
@@ -746,12 +845,32 @@ struct d2d_render_info
 
     unsigned int mask;
     GUID pixel_shader;
+
+    BYTE *ps_cb_data;
+    UINT32 ps_cb_size;
+    ID3D11Buffer *ps_cb;
+    bool ps_cb_dirty;
+
+    D2D1_FILTER *input_filters;
+    size_t input_filters_size;
+    size_t input_filter_count;
+};
+
+enum d2d_transform_type
+{
+    D2D_TRANSFORM_TYPE_UNKNOWN,
+    D2D_TRANSFORM_TYPE_DRAW,
+    D2D_TRANSFORM_TYPE_OFFSET,
+    D2D_TRANSFORM_TYPE_BLEND,
+    D2D_TRANSFORM_TYPE_BORDER,
+    D2D_TRANSFORM_TYPE_BOUNDS_ADJUSTMENT,
 };
 
 struct d2d_transform_node
 {
     struct list entry;
     ID2D1TransformNode *object;
+    enum d2d_transform_type type;
     struct d2d_render_info *render_info;
     struct d2d_transform_node **inputs;
     unsigned int input_count;
@@ -793,10 +912,29 @@ struct d2d_effect
     ID2D1Image **inputs;
     size_t inputs_size;
     size_t input_count;
+
+    D2D1_CHANGE_TYPE changes;
 };
 
 HRESULT d2d_effect_create(struct d2d_device_context *context, const CLSID *effect_id,
         ID2D1Effect **effect);
+struct d2d_effect *d2d_effect_from_image(ID2D1Image *iface);
+HRESULT d2d_transform_node_initialize(struct d2d_transform_node *node);
+
+/* Image data produced while rendering an effect graph. Texel (0, 0) of
+ * "bitmap" is at "origin" in image space, and "rect" bounds the valid data;
+ * everything outside of it is transparent. */
+struct d2d_effect_source
+{
+    struct d2d_bitmap *bitmap;
+    struct d2d_effect_intermediate *intermediate;
+    D2D1_POINT_2L origin;
+    D2D1_RECT_L rect;
+};
+
+HRESULT d2d_effect_render(struct d2d_device_context *context, struct d2d_effect *effect,
+        const D2D1_RECT_L *rect, struct d2d_effect_source *output);
+void d2d_effect_source_release(struct d2d_device_context *context, struct d2d_effect_source *source);
 void d2d_effect_init_properties(struct d2d_effect *effect, struct d2d_effect_properties *properties);
 HRESULT d2d_effect_properties_add(struct d2d_effect_properties *props, const WCHAR *name,
         UINT32 index, D2D1_PROPERTY_TYPE type, const WCHAR *value);
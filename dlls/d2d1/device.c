@@ -270,6 +270,7 @@ static ULONG STDMETHODCALLTYPE d2d_device_context_inner_Release(IUnknown *iface)
         unsigned int i, j, k;
 
         d2d_clip_stack_cleanup(&context->clip_stack);
+        d2d_effect_renderer_cleanup(&context->effect_renderer);
         IDWriteRenderingParams_Release(context->default_text_rendering_params);
         if (context->text_rendering_params)
             IDWriteRenderingParams_Release(context->text_rendering_params);
@@ -829,12 +830,10 @@ static HRESULT d2d_device_context_update_vs_cb(struct d2d_device_context *contex
     return S_OK;
 }
 
-static void d2d_device_context_draw_geometry(struct d2d_device_context *render_target,
-        const struct d2d_geometry *geometry, struct d2d_brush *brush, float stroke_width)
+static void d2d_device_context_draw_geometry_mesh(struct d2d_device_context *render_target,
+        const struct d2d_geometry *geometry, const struct d2d_geometry_mesh *mesh,
+        struct d2d_brush *brush, float stroke_width)
 {
-    D3D11_SUBRESOURCE_DATA buffer_data;
-    D3D11_BUFFER_DESC buffer_desc;
-    ID3D11Buffer *ib, *vb;
     HRESULT hr;
 
     if (FAILED(hr = d2d_device_context_update_vs_cb(render_target, &geometry->transform, stroke_width)))
@@ -849,111 +848,44 @@ static void d2d_device_context_draw_geometry(struct d2d_device_context *render_t
         return;
     }
 
-    buffer_desc.Usage = D3D11_USAGE_DEFAULT;
-    buffer_desc.CPUAccessFlags = 0;
-    buffer_desc.MiscFlags = 0;
-
-    buffer_data.SysMemPitch = 0;
-    buffer_data.SysMemSlicePitch = 0;
-
-    if (geometry->outline.face_count)
-    {
-        buffer_desc.ByteWidth = geometry->outline.face_count * sizeof(*geometry->outline.faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
-        {
-            WARN("Failed to create index buffer, hr %#lx.\n", hr);
-            return;
-        }
-
-        buffer_desc.ByteWidth = geometry->outline.vertex_count * sizeof(*geometry->outline.vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
-        {
-            ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
-            ID3D11Buffer_Release(ib);
-            return;
-        }
-
-        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_OUTLINE, ib, 3 * geometry->outline.face_count, vb,
+    if (mesh->outline.ib)
+        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_OUTLINE, mesh->outline.ib,
+                3 * geometry->outline.face_count, mesh->outline.vb,
                 sizeof(*geometry->outline.vertices), brush, NULL);
 
-        ID3D11Buffer_Release(vb);
-        ID3D11Buffer_Release(ib);
-    }
-
-    if (geometry->outline.bezier_face_count)
-    {
-        buffer_desc.ByteWidth = geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.bezier_faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
-        {
-            WARN("Failed to create curves index buffer, hr %#lx.\n", hr);
-            return;
-        }
-
-        buffer_desc.ByteWidth = geometry->outline.bezier_count * sizeof(*geometry->outline.beziers);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.beziers;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
-        {
-            ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
-            ID3D11Buffer_Release(ib);
-            return;
-        }
-
-        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_BEZIER_OUTLINE, ib,
-                3 * geometry->outline.bezier_face_count, vb,
+    if (mesh->outline.bezier_ib)
+        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_BEZIER_OUTLINE, mesh->outline.bezier_ib,
+                3 * geometry->outline.bezier_face_count, mesh->outline.bezier_vb,
                 sizeof(*geometry->outline.beziers), brush, NULL);
 
-        ID3D11Buffer_Release(vb);
-        ID3D11Buffer_Release(ib);
-    }
-
-    if (geometry->outline.arc_face_count)
-    {
-        buffer_desc.ByteWidth = geometry->outline.arc_face_count * sizeof(*geometry->outline.arc_faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.arc_faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
-        {
-            WARN("Failed to create arcs index buffer, hr %#lx.\n", hr);
-            return;
-        }
-
-        buffer_desc.ByteWidth = geometry->outline.arc_count * sizeof(*geometry->outline.arcs);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->outline.arcs;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
-        {
-            ERR("Failed to create arcs vertex buffer, hr %#lx.\n", hr);
-            ID3D11Buffer_Release(ib);
-            return;
-        }
+    if (mesh->outline.arc_ib && SUCCEEDED(d2d_device_context_update_ps_cb(render_target, brush, NULL, TRUE, TRUE)))
+        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_ARC_OUTLINE, mesh->outline.arc_ib,
+                3 * geometry->outline.arc_face_count, mesh->outline.arc_vb,
+                sizeof(*geometry->outline.arcs), brush, NULL);
+}
 
-        if (SUCCEEDED(d2d_device_context_update_ps_cb(render_target, brush, NULL, TRUE, TRUE)))
-            d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_ARC_OUTLINE, ib,
-                    3 * geometry->outline.arc_face_count, vb,
-                    sizeof(*geometry->outline.arcs), brush, NULL);
+static void d2d_device_context_draw_geometry(struct d2d_device_context *render_target,
+        struct d2d_geometry *geometry, struct d2d_brush *brush, float stroke_width)
+{
+    struct d2d_geometry_mesh *mesh, transient = {0};
+    HRESULT hr;
 
-        ID3D11Buffer_Release(vb);
-        ID3D11Buffer_Release(ib);
+    if ((mesh = d2d_geometry_get_mesh(geometry, render_target->device, render_target->d3d_device, TRUE)))
+    {
+        d2d_device_context_draw_geometry_mesh(render_target, geometry, mesh, brush, stroke_width);
+        return;
     }
+
+    if (FAILED(hr = d2d_geometry_mesh_upload_outline(&transient, geometry, render_target->d3d_device)))
+        return;
+    d2d_device_context_draw_geometry_mesh(render_target, geometry, &transient, brush, stroke_width);
+    d2d_geometry_mesh_cleanup(&transient);
 }
 
 static void STDMETHODCALLTYPE d2d_device_context_DrawGeometry(ID2D1DeviceContext6 *iface,
         ID2D1Geometry *geometry, ID2D1Brush *brush, float stroke_width, ID2D1StrokeStyle *stroke_style)
 {
-    const struct d2d_geometry *geometry_impl = unsafe_impl_from_ID2D1Geometry(geometry);
+    struct d2d_geometry *geometry_impl = unsafe_impl_from_ID2D1Geometry(geometry);
     struct d2d_device_context *context = impl_from_ID2D1DeviceContext(iface);
     struct d2d_brush *brush_impl = unsafe_impl_from_ID2D1Brush(brush);
     struct d2d_stroke_style *stroke_style_impl = unsafe_impl_from_ID2D1StrokeStyle(stroke_style);
@@ -980,21 +912,12 @@ static void STDMETHODCALLTYPE d2d_device_context_DrawGeometry(ID2D1DeviceContext
     d2d_device_context_draw_geometry(context, geometry_impl, brush_impl, stroke_width);
 }
 
-static void d2d_device_context_fill_geometry(struct d2d_device_context *render_target,
-        const struct d2d_geometry *geometry, struct d2d_brush *brush, struct d2d_brush *opacity_brush)
+static void d2d_device_context_fill_geometry_mesh(struct d2d_device_context *render_target,
+        const struct d2d_geometry *geometry, const struct d2d_geometry_mesh *mesh,
+        struct d2d_brush *brush, struct d2d_brush *opacity_brush)
 {
-    D3D11_SUBRESOURCE_DATA buffer_data;
-    D3D11_BUFFER_DESC buffer_desc;
-    ID3D11Buffer *ib, *vb;
     HRESULT hr;
 
-    buffer_desc.Usage = D3D11_USAGE_DEFAULT;
-    buffer_desc.CPUAccessFlags = 0;
-    buffer_desc.MiscFlags = 0;
-
-    buffer_data.SysMemPitch = 0;
-    buffer_data.SysMemSlicePitch = 0;
-
     if (FAILED(hr = d2d_device_context_update_vs_cb(render_target, &geometry->transform, 0.0f)))
     {
         WARN("Failed to update vs constant buffer, hr %#lx.\n", hr);
@@ -1007,78 +930,45 @@ static void d2d_device_context_fill_geometry(struct d2d_device_context *render_t
         return;
     }
 
-    if (geometry->fill.face_count)
-    {
-        buffer_desc.ByteWidth = geometry->fill.face_count * sizeof(*geometry->fill.faces);
-        buffer_desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.faces;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &ib)))
-        {
-            WARN("Failed to create index buffer, hr %#lx.\n", hr);
-            return;
-        }
-
-        buffer_desc.ByteWidth = geometry->fill.vertex_count * sizeof(*geometry->fill.vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
-        {
-            ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
-            ID3D11Buffer_Release(ib);
-            return;
-        }
-
-        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_TRIANGLE, ib, 3 * geometry->fill.face_count, vb,
+    if (mesh->fill.ib)
+        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_TRIANGLE, mesh->fill.ib,
+                3 * geometry->fill.face_count, mesh->fill.vb,
                 sizeof(*geometry->fill.vertices), brush, opacity_brush);
 
-        ID3D11Buffer_Release(vb);
-        ID3D11Buffer_Release(ib);
-    }
-
-    if (geometry->fill.bezier_vertex_count)
-    {
-        buffer_desc.ByteWidth = geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.bezier_vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
-        {
-            ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
-            return;
-        }
-
-        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_CURVE, NULL, geometry->fill.bezier_vertex_count, vb,
+    if (mesh->fill.bezier_vb)
+        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_CURVE, NULL,
+                geometry->fill.bezier_vertex_count, mesh->fill.bezier_vb,
                 sizeof(*geometry->fill.bezier_vertices), brush, opacity_brush);
 
-        ID3D11Buffer_Release(vb);
-    }
-
-    if (geometry->fill.arc_vertex_count)
-    {
-        buffer_desc.ByteWidth = geometry->fill.arc_vertex_count * sizeof(*geometry->fill.arc_vertices);
-        buffer_desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-        buffer_data.pSysMem = geometry->fill.arc_vertices;
-
-        if (FAILED(hr = ID3D11Device1_CreateBuffer(render_target->d3d_device, &buffer_desc, &buffer_data, &vb)))
-        {
-            ERR("Failed to create arc vertex buffer, hr %#lx.\n", hr);
-            return;
-        }
+    if (mesh->fill.arc_vb && SUCCEEDED(d2d_device_context_update_ps_cb(render_target,
+            brush, opacity_brush, FALSE, TRUE)))
+        d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_CURVE, NULL,
+                geometry->fill.arc_vertex_count, mesh->fill.arc_vb,
+                sizeof(*geometry->fill.arc_vertices), brush, opacity_brush);
+}
 
-        if (SUCCEEDED(d2d_device_context_update_ps_cb(render_target, brush, opacity_brush, FALSE, TRUE)))
-            d2d_device_context_draw(render_target, D2D_SHAPE_TYPE_CURVE, NULL, geometry->fill.arc_vertex_count, vb,
-                    sizeof(*geometry->fill.arc_vertices), brush, opacity_brush);
+static void d2d_device_context_fill_geometry(struct d2d_device_context *render_target,
+        struct d2d_geometry *geometry, struct d2d_brush *brush, struct d2d_brush *opacity_brush)
+{
+    struct d2d_geometry_mesh *mesh, transient = {0};
+    HRESULT hr;
 
-        ID3D11Buffer_Release(vb);
+    if ((mesh = d2d_geometry_get_mesh(geometry, render_target->device, render_target->d3d_device, FALSE)))
+    {
+        d2d_device_context_fill_geometry_mesh(render_target, geometry, mesh, brush, opacity_brush);
+        return;
     }
+
+    if (FAILED(hr = d2d_geometry_mesh_upload_fill(&transient, geometry, render_target->d3d_device)))
+        return;
+    d2d_device_context_fill_geometry_mesh(render_target, geometry, &transient, brush, opacity_brush);
+    d2d_geometry_mesh_cleanup(&transient);
 }
 
 static void STDMETHODCALLTYPE d2d_device_context_FillGeometry(ID2D1DeviceContext6 *iface,
         ID2D1Geometry *geometry, ID2D1Brush *brush, ID2D1Brush *opacity_brush)
 {
-    const struct d2d_geometry *geometry_impl = unsafe_impl_from_ID2D1Geometry(geometry);
+    struct d2d_geometry *geometry_impl = unsafe_impl_from_ID2D1Geometry(geometry);
     struct d2d_brush *opacity_brush_impl = unsafe_impl_from_ID2D1Brush(opacity_brush);
     struct d2d_device_context *context = impl_from_ID2D1DeviceContext(iface);
     struct d2d_brush *brush_impl = unsafe_impl_from_ID2D1Brush(brush);
@@ -2539,11 +2429,99 @@ static void STDMETHODCALLTYPE d2d_device_context_ID2D1DeviceContext_DrawGlyphRun
     d2d_device_context_draw_glyph_run(context, baseline_origin, glyph_run, glyph_run_desc, brush, measuring_mode);
 }
 
+/* Only the part of the effect output that ends up inside the current clip
+ * rectangle is rendered. */
+static void d2d_device_context_draw_effect(struct d2d_device_context *context, struct d2d_effect *effect,
+        const D2D1_POINT_2F *target_offset, const D2D1_RECT_F *image_rect,
+        D2D1_INTERPOLATION_MODE interpolation_mode)
+{
+    D2D1_MATRIX_3X2_F transform, inverse_transform;
+    struct d2d_effect_source output;
+    D2D1_RECT_F visible, src_rect;
+    D2D1_POINT_2F point, offset;
+    D2D1_RECT_L rect;
+    unsigned int i;
+    HRESULT hr;
+
+    d2d_rect_set(&visible, 0.0f, 0.0f, context->pixel_size.width, context->pixel_size.height);
+    if (context->clip_stack.count)
+        d2d_rect_intersect(&visible, &context->clip_stack.stack[context->clip_stack.count - 1]);
+    if (visible.left >= visible.right || visible.top >= visible.bottom)
+        return;
+
+    /* Map the visible area back to image space, through the inverse of the
+     * same DIP to pixel transform as used for drawing. */
+    transform = context->drawing_state.transform;
+    transform._11 *= context->desc.dpiX / 96.0f;
+    transform._21 *= context->desc.dpiX / 96.0f;
+    transform._31 *= context->desc.dpiX / 96.0f;
+    transform._12 *= context->desc.dpiY / 96.0f;
+    transform._22 *= context->desc.dpiY / 96.0f;
+    transform._32 *= context->desc.dpiY / 96.0f;
+    if (!d2d_matrix_invert(&inverse_transform, &transform))
+        return;
+    for (i = 0; i < 4; ++i)
+    {
+        d2d_point_transform(&point, &inverse_transform,
+                (i & 1) ? visible.right : visible.left, (i & 2) ? visible.bottom : visible.top);
+        if (target_offset)
+        {
+            point.x -= target_offset->x;
+            point.y -= target_offset->y;
+        }
+        if (image_rect)
+        {
+            point.x += image_rect->left;
+            point.y += image_rect->top;
+        }
+        if (!i)
+            d2d_rect_set(&src_rect, point.x, point.y, point.x, point.y);
+        else
+            d2d_rect_expand(&src_rect, &point);
+    }
+    if (image_rect)
+        d2d_rect_intersect(&src_rect, image_rect);
+
+    /* Leave room for filtering at the edges. */
+    rect.left = floorf(src_rect.left) - 1;
+    rect.top = floorf(src_rect.top) - 1;
+    rect.right = ceilf(src_rect.right) + 1;
+    rect.bottom = ceilf(src_rect.bottom) + 1;
+    if (rect.left >= rect.right || rect.top >= rect.bottom)
+        return;
+
+    if (FAILED(hr = d2d_effect_render(context, effect, &rect, &output)))
+    {
+        WARN("Failed to render effect %p, hr %#lx.\n", effect, hr);
+        d2d_device_context_set_error(context, hr);
+        return;
+    }
+    if (!output.bitmap)
+        return;
+
+    /* Only the valid part of the output is drawn. */
+    rect = output.rect;
+    d2d_rect_set(&src_rect, rect.left - output.origin.x, rect.top - output.origin.y,
+            rect.right - output.origin.x, rect.bottom - output.origin.y);
+    offset.x = rect.left - (image_rect ? image_rect->left : 0.0f);
+    offset.y = rect.top - (image_rect ? image_rect->top : 0.0f);
+    if (target_offset)
+    {
+        offset.x += target_offset->x;
+        offset.y += target_offset->y;
+    }
+    d2d_device_context_draw_bitmap(context, (ID2D1Bitmap *)&output.bitmap->ID2D1Bitmap1_iface, NULL, 1.0f,
+            interpolation_mode, &src_rect, &offset, NULL);
+
+    d2d_effect_source_release(context, &output);
+}
+
 static void STDMETHODCALLTYPE d2d_device_context_DrawImage(ID2D1DeviceContext6 *iface, ID2D1Image *image,
         const D2D1_POINT_2F *target_offset, const D2D1_RECT_F *image_rect, D2D1_INTERPOLATION_MODE interpolation_mode,
         D2D1_COMPOSITE_MODE composite_mode)
 {
     struct d2d_device_context *context = impl_from_ID2D1DeviceContext(iface);
+    struct d2d_effect *effect;
     ID2D1Bitmap *bitmap;
 
     TRACE("iface %p, image %p, target_offset %s, image_rect %s, interpolation_mode %#x, composite_mode %#x.\n",
@@ -2568,6 +2546,12 @@ static void STDMETHODCALLTYPE d2d_device_context_DrawImage(ID2D1DeviceContext6 *
         return;
     }
 
+    if ((effect = d2d_effect_from_image(image)))
+    {
+        d2d_device_context_draw_effect(context, effect, target_offset, image_rect, interpolation_mode);
+        return;
+    }
+
     FIXME("Unhandled image %p.\n", image);
 }
 
@@ -2671,26 +2655,86 @@ static void STDMETHODCALLTYPE d2d_device_context_ID2D1DeviceContext_FillOpacityM
 static HRESULT STDMETHODCALLTYPE d2d_device_context_CreateFilledGeometryRealization(ID2D1DeviceContext6 *iface,
         ID2D1Geometry *geometry, float tolerance, ID2D1GeometryRealization **realization)
 {
-    FIXME("iface %p, geometry %p, tolerance %.8e, realization %p stub!\n", iface, geometry, tolerance,
-            realization);
+    struct d2d_device_context *context = impl_from_ID2D1DeviceContext(iface);
+    struct d2d_geometry_realization *object;
+    HRESULT hr;
 
-    return E_NOTIMPL;
+    TRACE("iface %p, geometry %p, tolerance %.8e, realization %p.\n", iface, geometry, tolerance, realization);
+
+    if (FAILED(hr = d2d_geometry_realization_create(context->factory, context->d3d_device,
+            geometry, FALSE, 0.0f, NULL, &object)))
+        return hr;
+
+    *realization = &object->ID2D1GeometryRealization_iface;
+
+    return S_OK;
 }
 
 static HRESULT STDMETHODCALLTYPE d2d_device_context_CreateStrokedGeometryRealization(
         ID2D1DeviceContext6 *iface, ID2D1Geometry *geometry, float tolerance, float stroke_width,
         ID2D1StrokeStyle *stroke_style, ID2D1GeometryRealization **realization)
 {
-    FIXME("iface %p, geometry %p, tolerance %.8e, stroke_width %.8e, stroke_style %p, realization %p stub!\n",
+    struct d2d_device_context *context = impl_from_ID2D1DeviceContext(iface);
+    struct d2d_geometry_realization *object;
+    HRESULT hr;
+
+    TRACE("iface %p, geometry %p, tolerance %.8e, stroke_width %.8e, stroke_style %p, realization %p.\n",
             iface, geometry, tolerance, stroke_width, stroke_style, realization);
 
-    return E_NOTIMPL;
+    if (stroke_style)
+        FIXME("Ignoring stroke style %p.\n", stroke_style);
+
+    if (FAILED(hr = d2d_geometry_realization_create(context->factory, context->d3d_device,
+            geometry, TRUE, stroke_width, stroke_style, &object)))
+        return hr;
+
+    *realization = &object->ID2D1GeometryRealization_iface;
+
+    return S_OK;
 }
 
 static void STDMETHODCALLTYPE d2d_device_context_DrawGeometryRealization(ID2D1DeviceContext6 *iface,
         ID2D1GeometryRealization *realization, ID2D1Brush *brush)
 {
-    FIXME("iface %p, realization %p, brush %p stub!\n", iface, realization, brush);
+    struct d2d_geometry_realization *realization_impl = unsafe_impl_from_ID2D1GeometryRealization(realization);
+    struct d2d_device_context *context = impl_from_ID2D1DeviceContext(iface);
+    struct d2d_brush *brush_impl = unsafe_impl_from_ID2D1Brush(brush);
+    struct d2d_geometry *geometry_impl;
+
+    TRACE("iface %p, realization %p, brush %p.\n", iface, realization, brush);
+
+    if (FAILED(context->error.code))
+        return;
+
+    if (context->target.type == D2D_TARGET_COMMAND_LIST)
+    {
+        if (realization_impl->stroked)
+            d2d_command_list_draw_geometry(context->target.command_list, context, realization_impl->geometry,
+                    brush, realization_impl->stroke_width, realization_impl->stroke_style);
+        else
+            d2d_command_list_fill_geometry(context->target.command_list, context, realization_impl->geometry,
+                    brush, NULL);
+        return;
+    }
+
+    geometry_impl = unsafe_impl_from_ID2D1Geometry(realization_impl->geometry);
+
+    /* Realizations created on a different device can't use their buffers
+     * here, draw the source geometry instead. */
+    if (realization_impl->device != context->d3d_device)
+    {
+        if (realization_impl->stroked)
+            d2d_device_context_draw_geometry(context, geometry_impl, brush_impl, realization_impl->stroke_width);
+        else
+            d2d_device_context_fill_geometry(context, geometry_impl, brush_impl, NULL);
+        return;
+    }
+
+    if (realization_impl->stroked)
+        d2d_device_context_draw_geometry_mesh(context, geometry_impl, &realization_impl->mesh,
+                brush_impl, realization_impl->stroke_width);
+    else
+        d2d_device_context_fill_geometry_mesh(context, geometry_impl, &realization_impl->mesh, brush_impl, NULL);
 }
 
 static HRESULT STDMETHODCALLTYPE d2d_device_context_CreateInk(ID2D1DeviceContext6 *iface,
@@ -4302,6 +4346,7 @@ static ULONG WINAPI d2d_device_Release(ID2D1Device6 *iface)
 
     if (!refcount)
     {
+        d2d_geometry_purge_meshes((ID2D1Factory *)device->factory, device);
         IDXGIDevice_Release(device->dxgi_device);
         ID2D1Factory1_Release(device->factory);
         d2d_device_indexed_objects_clear(&device->shaders);
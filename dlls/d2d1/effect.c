@@ -613,6 +613,36 @@ static struct d2d_transform_node * d2d_transform_graph_get_node(const struct d2d
     return NULL;
 }
 
+static enum d2d_transform_type d2d_transform_node_get_type(ID2D1TransformNode *object)
+{
+    static const struct
+    {
+        const GUID *iid;
+        enum d2d_transform_type type;
+    }
+    types[] =
+    {
+        { &IID_ID2D1DrawTransform, D2D_TRANSFORM_TYPE_DRAW },
+        { &IID_ID2D1OffsetTransform, D2D_TRANSFORM_TYPE_OFFSET },
+        { &IID_ID2D1BlendTransform, D2D_TRANSFORM_TYPE_BLEND },
+        { &IID_ID2D1BorderTransform, D2D_TRANSFORM_TYPE_BORDER },
+        { &IID_ID2D1BoundsAdjustmentTransform, D2D_TRANSFORM_TYPE_BOUNDS_ADJUSTMENT },
+    };
+    unsigned int i;
+    IUnknown *obj;
+
+    for (i = 0; i < ARRAY_SIZE(types); ++i)
+    {
+        if (SUCCEEDED(ID2D1TransformNode_QueryInterface(object, types[i].iid, (void **)&obj)))
+        {
+            IUnknown_Release(obj);
+            return types[i].type;
+        }
+    }
+
+    return D2D_TRANSFORM_TYPE_UNKNOWN;
+}
+
 static HRESULT d2d_transform_graph_add_node(struct d2d_transform_graph *graph,
         ID2D1TransformNode *object)
 {
@@ -629,6 +659,7 @@ static HRESULT d2d_transform_graph_add_node(struct d2d_transform_graph *graph,
 
     node->object = object;
     ID2D1TransformNode_AddRef(node->object);
+    node->type = d2d_transform_node_get_type(object);
     list_add_tail(&graph->nodes, &node->entry);
 
     return S_OK;
@@ -1047,18 +1078,6 @@ L"<?xml version='1.0'?>                                                   \
     <Property name='Rect' type='vector4' />                               \
   </Effect>";
 
-static const WCHAR shadow_description[] =
-L"<?xml version='1.0'?>                                                   \
-  <Effect>                                                                \
-    <Property name='DisplayName' type='string' value='Shadow'/>           \
-    <Property name='Author'      type='string' value='The Wine Project'/> \
-    <Property name='Category'    type='string' value='Stub'/>             \
-    <Property name='Description' type='string' value='Shadow'/>           \
-    <Inputs >                                                             \
-      <Input name='Source'/>                                              \
-    </Inputs>                                                             \
-  </Effect>";
-
 static const WCHAR grayscale_description[] =
 L"<?xml version='1.0'?>                                                   \
   <Effect>                                                                \
@@ -1084,7 +1103,6 @@ void d2d_effects_init_builtins(struct d2d_factory *factory)
         { &CLSID_D2D13DPerspectiveTransform, _3d_perspective_transform_description},
         { &CLSID_D2D1Composite, composite_description },
         { &CLSID_D2D1Crop, crop_description },
-        { &CLSID_D2D1Shadow, shadow_description },
         { &CLSID_D2D1Grayscale, grayscale_description },
     };
     unsigned int i;
@@ -1098,6 +1116,7 @@ void d2d_effects_init_builtins(struct d2d_factory *factory)
             WARN("Failed to register the effect %s, hr %#lx.\n", wine_dbgstr_guid(builtin_effects[i].clsid), hr);
         }
     }
+    d2d_effects_init_filters(factory);
 }
 
 /* Same syntax is used for value and default values. */
@@ -1421,17 +1440,30 @@ HRESULT d2d_effect_property_get_uint32_value(const struct d2d_effect_properties
             (BYTE *)value, sizeof(*value));
 }
 
+static void d2d_effect_invalidate(struct d2d_effect *effect, D2D1_CHANGE_TYPE change)
+{
+    if (change > effect->changes)
+        effect->changes = change;
+}
+
 static HRESULT d2d_effect_property_set_value(struct d2d_effect_properties *properties,
         struct d2d_effect_property *prop, D2D1_PROPERTY_TYPE type, const BYTE *value, UINT32 size)
 {
     struct d2d_effect *effect = properties->effect;
+    HRESULT hr;
+
     if (prop->readonly || !effect) return E_INVALIDARG;
     if (type != D2D1_PROPERTY_TYPE_UNKNOWN && prop->type != type) return E_INVALIDARG;
     if (prop->get_function && !prop->set_function) return E_INVALIDARG;
     if (prop->index < 0x80000000 && !prop->set_function) return E_INVALIDARG;
 
     if (prop->set_function)
-        return prop->set_function((IUnknown *)effect->impl, value, size);
+    {
+        if (FAILED(hr = prop->set_function((IUnknown *)effect->impl, value, size)))
+            return hr;
+        d2d_effect_invalidate(effect, D2D1_CHANGE_TYPE_PROPERTIES);
+        return S_OK;
+    }
 
     if (prop->size != size) return E_INVALIDARG;
 
@@ -1445,6 +1477,7 @@ static HRESULT d2d_effect_property_set_value(struct d2d_effect_properties *prope
         default:
             FIXME("Unhandled type %u.\n", prop->type);
     }
+    d2d_effect_invalidate(effect, D2D1_CHANGE_TYPE_PROPERTIES);
 
     return S_OK;
 }
@@ -2043,10 +2076,12 @@ static void STDMETHODCALLTYPE d2d_effect_SetInput(ID2D1Effect *iface, UINT32 ind
     if (index >= effect->input_count)
         return;
 
-    ID2D1Image_AddRef(input);
+    if (input)
+        ID2D1Image_AddRef(input);
     if (effect->inputs[index])
         ID2D1Image_Release(effect->inputs[index]);
     effect->inputs[index] = input;
+    d2d_effect_invalidate(effect, D2D1_CHANGE_TYPE_PROPERTIES);
 }
 
 static HRESULT d2d_effect_set_input_count(struct d2d_effect *effect, UINT32 count)
@@ -2089,6 +2124,7 @@ static HRESULT d2d_effect_set_input_count(struct d2d_effect *effect, UINT32 coun
             if (FAILED(hr = ID2D1EffectImpl_SetGraph(effect->impl, &effect->graph->ID2D1TransformGraph_iface)))
                 WARN("Failed to set a new transform graph, hr %#lx.\n", hr);
         }
+        d2d_effect_invalidate(effect, D2D1_CHANGE_TYPE_GRAPH);
     }
 
     return hr;
@@ -2484,7 +2520,13 @@ static ULONG STDMETHODCALLTYPE d2d_draw_info_Release(ID2D1DrawInfo *iface)
     TRACE("iface %p refcount %lu.\n", iface, refcount);
 
     if (!refcount)
+    {
+        if (render_info->ps_cb)
+            ID3D11Buffer_Release(render_info->ps_cb);
+        free(render_info->ps_cb_data);
+        free(render_info->input_filters);
         free(render_info);
+    }
 
     return refcount;
 }
@@ -2492,17 +2534,41 @@ static ULONG STDMETHODCALLTYPE d2d_draw_info_Release(ID2D1DrawInfo *iface)
 static HRESULT STDMETHODCALLTYPE d2d_draw_info_SetInputDescription(ID2D1DrawInfo *iface,
         UINT32 index, D2D1_INPUT_DESCRIPTION description)
 {
-    FIXME("iface %p, index %u stub.\n", iface, index);
+    struct d2d_render_info *render_info = impl_from_ID2D1DrawInfo(iface);
+    unsigned int i;
 
-    return E_NOTIMPL;
+    TRACE("iface %p, index %u, filter %#x, lod count %u.\n", iface, index,
+            description.filter, description.levelOfDetailCount);
+
+    if (description.levelOfDetailCount)
+        FIXME("Ignoring level of detail count %u.\n", description.levelOfDetailCount);
+
+    if (index >= render_info->input_filter_count)
+    {
+        if (!d2d_array_reserve((void **)&render_info->input_filters, &render_info->input_filters_size,
+                index + 1, sizeof(*render_info->input_filters)))
+            return E_OUTOFMEMORY;
+        for (i = render_info->input_filter_count; i < index; ++i)
+            render_info->input_filters[i] = D2D1_FILTER_MIN_MAG_MIP_LINEAR;
+        render_info->input_filter_count = index + 1;
+    }
+    render_info->input_filters[index] = description.filter;
+
+    return S_OK;
 }
 
 static HRESULT STDMETHODCALLTYPE d2d_draw_info_SetOutputBuffer(ID2D1DrawInfo *iface,
         D2D1_BUFFER_PRECISION precision, D2D1_CHANNEL_DEPTH depth)
 {
-    FIXME("iface %p, precision %u, depth %u stub.\n", iface, precision, depth);
+    struct d2d_render_info *render_info = impl_from_ID2D1DrawInfo(iface);
 
-    return E_NOTIMPL;
+    TRACE("iface %p, precision %u, depth %u.\n", iface, precision, depth);
+
+    /* Intermediates are always 8 bits per channel RGBA. */
+    if (precision > D2D1_BUFFER_PRECISION_8BPC_UNORM_SRGB || depth == D2D1_CHANNEL_DEPTH_1)
+        FIXME("Ignoring precision %u, depth %u.\n", precision, depth);
+
+    return S_OK;
 }
 
 static void STDMETHODCALLTYPE d2d_draw_info_SetCached(ID2D1DrawInfo *iface, BOOL is_cached)
@@ -2519,9 +2585,22 @@ static void STDMETHODCALLTYPE d2d_draw_info_SetInstructionCountHint(ID2D1DrawInf
 static HRESULT STDMETHODCALLTYPE d2d_draw_info_SetPixelShaderConstantBuffer(ID2D1DrawInfo *iface,
         const BYTE *buffer, UINT32 size)
 {
-    FIXME("iface %p, buffer %p, size %u stub.\n", iface, buffer, size);
+    struct d2d_render_info *render_info = impl_from_ID2D1DrawInfo(iface);
+    BYTE *data;
 
-    return E_NOTIMPL;
+    TRACE("iface %p, buffer %p, size %u.\n", iface, buffer, size);
+
+    /* Constant buffers are allocated in multiples of 16 bytes. */
+    if (!(data = calloc(1, (size + 15) & ~15u)))
+        return E_OUTOFMEMORY;
+    memcpy(data, buffer, size);
+
+    free(render_info->ps_cb_data);
+    render_info->ps_cb_data = data;
+    render_info->ps_cb_size = (size + 15) & ~15u;
+    render_info->ps_cb_dirty = true;
+
+    return S_OK;
 }
 
 static HRESULT STDMETHODCALLTYPE d2d_draw_info_SetResourceTexture(ID2D1DrawInfo *iface,
@@ -2594,64 +2673,65 @@ static HRESULT d2d_effect_render_info_create(struct d2d_render_info **obj)
     return S_OK;
 }
 
-static bool d2d_transform_node_needs_render_info(const struct d2d_transform_node *node)
-{
-    static const GUID *iids[] =
-    {
-        &IID_ID2D1SourceTransform,
-        &IID_ID2D1ComputeTransform,
-        &IID_ID2D1DrawTransform,
-    };
-    unsigned int i;
-    IUnknown *obj;
-
-    for (i = 0; i < ARRAY_SIZE(iids); ++i)
-    {
-        if (SUCCEEDED(ID2D1TransformNode_QueryInterface(node->object, iids[i], (void **)&obj)))
-        {
-            IUnknown_Release(obj);
-            return true;
-        }
-    }
-
-    return false;
-}
-
-static HRESULT d2d_effect_transform_graph_initialize_nodes(struct d2d_transform_graph *graph)
+HRESULT d2d_transform_node_initialize(struct d2d_transform_node *node)
 {
     ID2D1DrawTransform *draw_transform;
-    struct d2d_transform_node *node;
     HRESULT hr;
 
-    LIST_FOR_EACH_ENTRY(node, &graph->nodes, struct d2d_transform_node, entry)
+    if (node->render_info)
+        return S_OK;
+
+    switch (node->type)
     {
-        if (d2d_transform_node_needs_render_info(node))
-        {
+        case D2D_TRANSFORM_TYPE_DRAW:
             if (FAILED(hr = d2d_effect_render_info_create(&node->render_info)))
                 return hr;
-        }
 
-        if (SUCCEEDED(ID2D1TransformNode_QueryInterface(node->object, &IID_ID2D1DrawTransform,
-                (void **)&draw_transform)))
-        {
+            ID2D1TransformNode_QueryInterface(node->object, &IID_ID2D1DrawTransform, (void **)&draw_transform);
             hr = ID2D1DrawTransform_SetDrawInfo(draw_transform, &node->render_info->ID2D1DrawInfo_iface);
             ID2D1DrawTransform_Release(draw_transform);
             if (FAILED(hr))
             {
                 WARN("Failed to set draw info, hr %#lx.\n", hr);
+                ID2D1DrawInfo_Release(&node->render_info->ID2D1DrawInfo_iface);
+                node->render_info = NULL;
                 return hr;
             }
-        }
-        else
-        {
+            return S_OK;
+
+        case D2D_TRANSFORM_TYPE_OFFSET:
+        case D2D_TRANSFORM_TYPE_BLEND:
+        case D2D_TRANSFORM_TYPE_BORDER:
+        case D2D_TRANSFORM_TYPE_BOUNDS_ADJUSTMENT:
+            return S_OK;
+
+        default:
             FIXME("Unsupported node %p.\n", node);
             return E_NOTIMPL;
-        }
+    }
+}
+
+static HRESULT d2d_effect_transform_graph_initialize_nodes(struct d2d_transform_graph *graph)
+{
+    struct d2d_transform_node *node;
+    HRESULT hr;
+
+    LIST_FOR_EACH_ENTRY(node, &graph->nodes, struct d2d_transform_node, entry)
+    {
+        if (FAILED(hr = d2d_transform_node_initialize(node)))
+            return hr;
     }
 
     return S_OK;
 }
 
+struct d2d_effect *d2d_effect_from_image(ID2D1Image *iface)
+{
+    if (!iface || iface->lpVtbl != &d2d_effect_image_vtbl)
+        return NULL;
+    return impl_from_ID2D1Image(iface);
+}
+
 HRESULT d2d_effect_create(struct d2d_device_context *context, const CLSID *effect_id,
         ID2D1Effect **effect)
 {
@@ -2682,6 +2762,7 @@ HRESULT d2d_effect_create(struct d2d_device_context *context, const CLSID *effec
     object->ID2D1Image_iface.lpVtbl = &d2d_effect_image_vtbl;
     object->refcount = 1;
     object->effect_context = effect_context;
+    object->changes = D2D1_CHANGE_TYPE_GRAPH;
 
     /* Create properties */
     d2d_effect_duplicate_properties(object, &object->properties, reg->properties);
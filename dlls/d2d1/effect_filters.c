@@ -0,0 +1,1038 @@
+/*
+ * Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "d2d1_private.h"
+#include <d3dcompiler.h>
+
+WINE_DEFAULT_DEBUG_CHANNEL(d2d);
+
+/* Blur, shadow, colour matrix and morphology effects. Each of them is a
+ * chain of single input draw transforms ("passes"). Blurs and morphology are
+ * separable, and run one pass per direction. Blurs with a large standard
+ * deviation are run on a downsampled copy of the input and upsampled
+ * afterwards, so that the number of taps per pixel stays bounded. */
+
+#define D2D_FILTER_MAX_TAPS 32
+#define D2D_FILTER_MAX_BLUR_RADIUS 24
+#define D2D_FILTER_MAX_LEVELS 6
+
+enum d2d_filter_pass_flags
+{
+    D2D_FILTER_PASS_HARD_BORDER   = 0x1,
+    D2D_FILTER_PASS_CLAMP_OUTPUT  = 0x2,
+    D2D_FILTER_PASS_PREMULTIPLIED = 0x4,
+    D2D_FILTER_PASS_DILATE        = 0x8,
+};
+
+enum d2d_filter_pass_scale
+{
+    D2D_FILTER_PASS_SCALE_NONE,
+    D2D_FILTER_PASS_SCALE_DOWN,
+    D2D_FILTER_PASS_SCALE_UP,
+};
+
+/* {8a8c46fc-4d1d-4e7e-9d4e-0b5d0a8e3b60} */
+static const GUID d2d_filter_blur_ps_id = {0x8a8c46fc, 0x4d1d, 0x4e7e, {0x9d, 0x4e, 0x0b, 0x5d, 0x0a, 0x8e, 0x3b, 0x60}};
+/* {8a8c46fc-4d1d-4e7e-9d4e-0b5d0a8e3b61} */
+static const GUID d2d_filter_resample_ps_id = {0x8a8c46fc, 0x4d1d, 0x4e7e, {0x9d, 0x4e, 0x0b, 0x5d, 0x0a, 0x8e, 0x3b, 0x61}};
+/* {8a8c46fc-4d1d-4e7e-9d4e-0b5d0a8e3b62} */
+static const GUID d2d_filter_morphology_ps_id = {0x8a8c46fc, 0x4d1d, 0x4e7e, {0x9d, 0x4e, 0x0b, 0x5d, 0x0a, 0x8e, 0x3b, 0x62}};
+/* {8a8c46fc-4d1d-4e7e-9d4e-0b5d0a8e3b63} */
+static const GUID d2d_filter_color_matrix_ps_id = {0x8a8c46fc, 0x4d1d, 0x4e7e, {0x9d, 0x4e, 0x0b, 0x5d, 0x0a, 0x8e, 0x3b, 0x63}};
+
+struct d2d_filter_pass_cb
+{
+    float direction[2];
+    float scale;
+    UINT32 flags;
+    UINT32 tap_count;
+    UINT32 padding[3];
+    float taps[D2D_FILTER_MAX_TAPS][4];
+};
+
+/* The pixel shaders get the position of the output pixel in SCENE_POSITION,
+ * and TEXCOORD0 maps that position to the input texture. Positions in the
+ * input are "scale" times the output position. The renderer provides the
+ * valid input data in "input_bounds", used to clamp samples for hard
+ * borders. */
+static const char d2d_filter_ps_code[] =
+    "#define HARD_BORDER 0x1\n"
+    "#define CLAMP_OUTPUT 0x2\n"
+    "#define PREMULTIPLIED 0x4\n"
+    "#define DILATE 0x8\n"
+    "\n"
+    "cbuffer cb : register(b0)\n"
+    "{\n"
+    "    float2 direction;\n"
+    "    float scale;\n"
+    "    uint flags;\n"
+    "    uint tap_count;\n"
+    "    float4 taps[32];\n"
+    "};\n"
+    "\n"
+    "cbuffer inputs : register(b1)\n"
+    "{\n"
+    "    float4 input_bounds;\n"
+    "};\n"
+    "\n"
+    "Texture2D t : register(t0);\n"
+    "SamplerState s : register(s0);\n"
+    "\n"
+    "float4 sample_input(float4 uv, float2 scene, float2 position)\n"
+    "{\n"
+    "    if (flags & HARD_BORDER)\n"
+    "        position = clamp(position, input_bounds.xy + 0.5f, input_bounds.zw - 0.5f);\n"
+    "    return t.Sample(s, uv.xy + (position - scene) * uv.zw);\n"
+    "}\n"
+    "\n"
+    "float4 blur_main(float4 position : SV_POSITION, float4 scene : SCENE_POSITION,\n"
+    "        float4 uv : TEXCOORD0) : SV_Target\n"
+    "{\n"
+    "    float4 c = 0.0f;\n"
+    "    uint i;\n"
+    "\n"
+    "    for (i = 0; i < tap_count; ++i)\n"
+    "        c += taps[i].y * sample_input(uv, scene.xy, scene.xy + taps[i].x * direction);\n"
+    "    return c;\n"
+    "}\n"
+    "\n"
+    "float4 resample_main(float4 position : SV_POSITION, float4 scene : SCENE_POSITION,\n"
+    "        float4 uv : TEXCOORD0) : SV_Target\n"
+    "{\n"
+    "    return sample_input(uv, scene.xy, scene.xy * scale);\n"
+    "}\n"
+    "\n"
+    "float4 morphology_main(float4 position : SV_POSITION, float4 scene : SCENE_POSITION,\n"
+    "        float4 uv : TEXCOORD0) : SV_Target\n"
+    "{\n"
+    "    float4 c = (flags & DILATE) ? 0.0f : 1.0f, v;\n"
+    "    uint i;\n"
+    "\n"
+    "    for (i = 0; i < tap_count; ++i)\n"
+    "    {\n"
+    "        v = sample_input(uv, scene.xy, scene.xy + (taps[0].x + i) * direction);\n"
+    "        c = (flags & DILATE) ? max(c, v) : min(c, v);\n"
+    "    }\n"
+    "    return c;\n"
+    "}\n"
+    "\n"
+    "float4 color_matrix_main(float4 position : SV_POSITION, float4 scene : SCENE_POSITION,\n"
+    "        float4 uv : TEXCOORD0) : SV_Target\n"
+    "{\n"
+    "    float4 c = sample_input(uv, scene.xy, scene.xy);\n"
+    "\n"
+    "    if (flags & PREMULTIPLIED)\n"
+    "        c.rgb = c.a ? c.rgb / c.a : 0.0f;\n"
+    "    c = c.r * taps[0] + c.g * taps[1] + c.b * taps[2] + c.a * taps[3] + taps[4];\n"
+    "    if (flags & CLAMP_OUTPUT)\n"
+    "        c = saturate(c);\n"
+    "    if (flags & PREMULTIPLIED)\n"
+    "        c.rgb *= c.a;\n"
+    "    return c;\n"
+    "}\n";
+
+struct d2d_filter_pass
+{
+    ID2D1DrawTransform ID2D1DrawTransform_iface;
+    LONG refcount;
+
+    const GUID *shader_id;
+    D2D1_FILTER filter;
+    enum d2d_filter_pass_scale scale;
+    /* Input pixels needed around each output pixel, in input space. */
+    LONG extent_x, extent_y;
+    /* Whether the output is larger than the input by the same amount. */
+    bool grow;
+
+    struct d2d_filter_pass_cb cb;
+};
+
+enum d2d_filter_type
+{
+    D2D_FILTER_GAUSSIAN_BLUR,
+    D2D_FILTER_DIRECTIONAL_BLUR,
+    D2D_FILTER_SHADOW,
+    D2D_FILTER_COLOR_MATRIX,
+    D2D_FILTER_MORPHOLOGY,
+};
+
+struct d2d_filter_effect
+{
+    ID2D1EffectImpl ID2D1EffectImpl_iface;
+    LONG refcount;
+
+    enum d2d_filter_type type;
+    ID2D1TransformGraph *graph;
+
+    float standard_deviation;
+    float angle;
+    UINT32 optimization;
+    UINT32 border_mode;
+    D2D_VECTOR_4F color;
+    D2D_MATRIX_5X4_F matrix;
+    UINT32 alpha_mode;
+    BOOL clamp_output;
+    UINT32 morphology_mode;
+    UINT32 width;
+    UINT32 height;
+};
+
+static LONG d2d_filter_clamp_coord(LONGLONG value)
+{
+    return value < LONG_MIN ? LONG_MIN : value > LONG_MAX ? LONG_MAX : value;
+}
+
+static LONG d2d_filter_div2_floor(LONG value)
+{
+    return value >= 0 ? value / 2 : -((1 - (LONGLONG)value) / 2);
+}
+
+static LONG d2d_filter_div2_ceil(LONG value)
+{
+    return value > 0 ? value / 2 + (value & 1) : -(LONG)(-(LONGLONG)value / 2);
+}
+
+static void d2d_filter_inflate_rect(D2D1_RECT_L *dst, const D2D1_RECT_L *src, LONG x, LONG y)
+{
+    dst->left = d2d_filter_clamp_coord((LONGLONG)src->left - x);
+    dst->top = d2d_filter_clamp_coord((LONGLONG)src->top - y);
+    dst->right = d2d_filter_clamp_coord((LONGLONG)src->right + x);
+    dst->bottom = d2d_filter_clamp_coord((LONGLONG)src->bottom + y);
+}
+
+static inline struct d2d_filter_pass *impl_from_ID2D1DrawTransform(ID2D1DrawTransform *iface)
+{
+    return CONTAINING_RECORD(iface, struct d2d_filter_pass, ID2D1DrawTransform_iface);
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_filter_pass_QueryInterface(ID2D1DrawTransform *iface, REFIID iid, void **out)
+{
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+
+    if (IsEqualGUID(iid, &IID_ID2D1DrawTransform)
+            || IsEqualGUID(iid, &IID_ID2D1Transform)
+            || IsEqualGUID(iid, &IID_ID2D1TransformNode)
+            || IsEqualGUID(iid, &IID_IUnknown))
+    {
+        ID2D1DrawTransform_AddRef(iface);
+        *out = iface;
+        return S_OK;
+    }
+
+    *out = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG STDMETHODCALLTYPE d2d_filter_pass_AddRef(ID2D1DrawTransform *iface)
+{
+    struct d2d_filter_pass *pass = impl_from_ID2D1DrawTransform(iface);
+    ULONG refcount = InterlockedIncrement(&pass->refcount);
+
+    TRACE("%p increasing refcount to %lu.\n", iface, refcount);
+
+    return refcount;
+}
+
+static ULONG STDMETHODCALLTYPE d2d_filter_pass_Release(ID2D1DrawTransform *iface)
+{
+    struct d2d_filter_pass *pass = impl_from_ID2D1DrawTransform(iface);
+    ULONG refcount = InterlockedDecrement(&pass->refcount);
+
+    TRACE("%p decreasing refcount to %lu.\n", iface, refcount);
+
+    if (!refcount)
+        free(pass);
+
+    return refcount;
+}
+
+static UINT32 STDMETHODCALLTYPE d2d_filter_pass_GetInputCount(ID2D1DrawTransform *iface)
+{
+    TRACE("iface %p.\n", iface);
+
+    return 1;
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_filter_pass_MapOutputRectToInputRects(ID2D1DrawTransform *iface,
+        const D2D1_RECT_L *output_rect, D2D1_RECT_L *input_rects, UINT32 input_rect_count)
+{
+    struct d2d_filter_pass *pass = impl_from_ID2D1DrawTransform(iface);
+    D2D1_RECT_L rect;
+
+    TRACE("iface %p, output_rect %s, input_rects %p, input_rect_count %u.\n",
+            iface, debug_d2d_rect_l(output_rect), input_rects, input_rect_count);
+
+    if (input_rect_count != 1)
+        return E_INVALIDARG;
+
+    switch (pass->scale)
+    {
+        case D2D_FILTER_PASS_SCALE_DOWN:
+            rect.left = d2d_filter_clamp_coord((LONGLONG)output_rect->left * 2);
+            rect.top = d2d_filter_clamp_coord((LONGLONG)output_rect->top * 2);
+            rect.right = d2d_filter_clamp_coord((LONGLONG)output_rect->right * 2);
+            rect.bottom = d2d_filter_clamp_coord((LONGLONG)output_rect->bottom * 2);
+            break;
+
+        case D2D_FILTER_PASS_SCALE_UP:
+            rect.left = d2d_filter_div2_floor(output_rect->left);
+            rect.top = d2d_filter_div2_floor(output_rect->top);
+            rect.right = d2d_filter_div2_ceil(output_rect->right);
+            rect.bottom = d2d_filter_div2_ceil(output_rect->bottom);
+            break;
+
+        default:
+            rect = *output_rect;
+            break;
+    }
+    d2d_filter_inflate_rect(&input_rects[0], &rect, pass->extent_x, pass->extent_y);
+
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_filter_pass_MapInputRectsToOutputRect(ID2D1DrawTransform *iface,
+        const D2D1_RECT_L *input_rects, const D2D1_RECT_L *input_opaque_rects, UINT32 input_rect_count,
+        D2D1_RECT_L *output_rect, D2D1_RECT_L *output_opaque_rect)
+{
+    struct d2d_filter_pass *pass = impl_from_ID2D1DrawTransform(iface);
+    const D2D1_RECT_L *input = &input_rects[0];
+
+    TRACE("iface %p, input_rects %p, input_opaque_rects %p, input_rect_count %u, "
+            "output_rect %p, output_opaque_rect %p.\n", iface, input_rects, input_opaque_rects,
+            input_rect_count, output_rect, output_opaque_rect);
+
+    if (input_rect_count != 1)
+        return E_INVALIDARG;
+
+    memset(output_opaque_rect, 0, sizeof(*output_opaque_rect));
+
+    switch (pass->scale)
+    {
+        case D2D_FILTER_PASS_SCALE_DOWN:
+            output_rect->left = d2d_filter_div2_floor(input->left);
+            output_rect->top = d2d_filter_div2_floor(input->top);
+            output_rect->right = d2d_filter_div2_ceil(input->right);
+            output_rect->bottom = d2d_filter_div2_ceil(input->bottom);
+            break;
+
+        case D2D_FILTER_PASS_SCALE_UP:
+            output_rect->left = d2d_filter_clamp_coord((LONGLONG)input->left * 2);
+            output_rect->top = d2d_filter_clamp_coord((LONGLONG)input->top * 2);
+            output_rect->right = d2d_filter_clamp_coord((LONGLONG)input->right * 2);
+            output_rect->bottom = d2d_filter_clamp_coord((LONGLONG)input->bottom * 2);
+            break;
+
+        default:
+            if (pass->grow)
+                d2d_filter_inflate_rect(output_rect, input, pass->extent_x, pass->extent_y);
+            else
+                *output_rect = *input;
+            break;
+    }
+
+    return S_OK;
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_filter_pass_MapInvalidRect(ID2D1DrawTransform *iface,
+        UINT32 index, D2D1_RECT_L input_rect, D2D1_RECT_L *output_rect)
+{
+    struct d2d_filter_pass *pass = impl_from_ID2D1DrawTransform(iface);
+    D2D1_RECT_L opaque_rect;
+
+    TRACE("iface %p, index %u, input_rect %s, output_rect %p.\n",
+            iface, index, debug_d2d_rect_l(&input_rect), output_rect);
+
+    if (index)
+        return E_INVALIDARG;
+
+    d2d_filter_inflate_rect(&input_rect, &input_rect, pass->extent_x, pass->extent_y);
+    return ID2D1DrawTransform_MapInputRectsToOutputRect(iface, &input_rect, &input_rect, 1,
+            output_rect, &opaque_rect);
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_filter_pass_SetDrawInfo(ID2D1DrawTransform *iface, ID2D1DrawInfo *info)
+{
+    struct d2d_filter_pass *pass = impl_from_ID2D1DrawTransform(iface);
+    D2D1_INPUT_DESCRIPTION input_desc;
+    HRESULT hr;
+
+    TRACE("iface %p, info %p.\n", iface, info);
+
+    input_desc.filter = pass->filter;
+    input_desc.levelOfDetailCount = 0;
+    if (FAILED(hr = ID2D1DrawInfo_SetInputDescription(info, 0, input_desc)))
+        return hr;
+    if (FAILED(hr = ID2D1DrawInfo_SetPixelShader(info, pass->shader_id, D2D1_PIXEL_OPTIONS_NONE)))
+        return hr;
+    return ID2D1DrawInfo_SetPixelShaderConstantBuffer(info, (const BYTE *)&pass->cb, sizeof(pass->cb));
+}
+
+static const ID2D1DrawTransformVtbl d2d_filter_pass_vtbl =
+{
+    d2d_filter_pass_QueryInterface,
+    d2d_filter_pass_AddRef,
+    d2d_filter_pass_Release,
+    d2d_filter_pass_GetInputCount,
+    d2d_filter_pass_MapOutputRectToInputRects,
+    d2d_filter_pass_MapInputRectsToOutputRect,
+    d2d_filter_pass_MapInvalidRect,
+    d2d_filter_pass_SetDrawInfo,
+};
+
+static struct d2d_filter_pass *d2d_filter_pass_create(const GUID *shader_id, D2D1_FILTER filter)
+{
+    struct d2d_filter_pass *pass;
+
+    if (!(pass = calloc(1, sizeof(*pass))))
+        return NULL;
+
+    pass->ID2D1DrawTransform_iface.lpVtbl = &d2d_filter_pass_vtbl;
+    pass->refcount = 1;
+    pass->shader_id = shader_id;
+    pass->filter = filter;
+    pass->cb.scale = 1.0f;
+
+    return pass;
+}
+
+/* Graph construction. Passes are appended to a single chain starting at the
+ * effect input; errors are sticky, and checked once at the end. */
+struct d2d_filter_chain
+{
+    ID2D1TransformGraph *graph;
+    ID2D1TransformNode *last;
+    bool hard_border;
+    HRESULT hr;
+};
+
+static void d2d_filter_chain_append(struct d2d_filter_chain *chain, struct d2d_filter_pass *pass)
+{
+    ID2D1TransformNode *node;
+
+    if (FAILED(chain->hr))
+    {
+        if (pass)
+            ID2D1DrawTransform_Release(&pass->ID2D1DrawTransform_iface);
+        return;
+    }
+    if (!pass)
+    {
+        chain->hr = E_OUTOFMEMORY;
+        return;
+    }
+
+    if (chain->hard_border)
+        pass->cb.flags |= D2D_FILTER_PASS_HARD_BORDER;
+
+    node = (ID2D1TransformNode *)&pass->ID2D1DrawTransform_iface;
+    if (SUCCEEDED(chain->hr = ID2D1TransformGraph_AddNode(chain->graph, node)))
+    {
+        if (chain->last)
+            chain->hr = ID2D1TransformGraph_ConnectNode(chain->graph, chain->last, node, 0);
+        else
+            chain->hr = ID2D1TransformGraph_ConnectToEffectInput(chain->graph, 0, node, 0);
+        chain->last = node;
+    }
+    ID2D1DrawTransform_Release(&pass->ID2D1DrawTransform_iface);
+}
+
+static HRESULT d2d_filter_chain_finish(struct d2d_filter_chain *chain)
+{
+    if (FAILED(chain->hr))
+        return chain->hr;
+    if (!chain->last)
+        return ID2D1TransformGraph_SetPassthroughGraph(chain->graph, 0);
+    return ID2D1TransformGraph_SetOutputNode(chain->graph, chain->last);
+}
+
+static void d2d_filter_chain_append_resample(struct d2d_filter_chain *chain, enum d2d_filter_pass_scale scale)
+{
+    struct d2d_filter_pass *pass;
+
+    if ((pass = d2d_filter_pass_create(&d2d_filter_resample_ps_id, D2D1_FILTER_MIN_MAG_MIP_LINEAR)))
+    {
+        pass->scale = scale;
+        pass->extent_x = pass->extent_y = 1;
+        pass->cb.scale = scale == D2D_FILTER_PASS_SCALE_DOWN ? 2.0f : 0.5f;
+    }
+    d2d_filter_chain_append(chain, pass);
+}
+
+/* Build a Gaussian kernel for a linearly filtered input. Neighbouring taps
+ * are merged into one sample between them, halving the number of samples. */
+static unsigned int d2d_filter_pass_set_gaussian_kernel(struct d2d_filter_pass *pass, float sigma)
+{
+    float weights[D2D_FILTER_MAX_BLUR_RADIUS + 2], sum, weight, offset;
+    unsigned int radius, i, count = 0;
+
+    radius = min(ceilf(3.0f * sigma), D2D_FILTER_MAX_BLUR_RADIUS);
+    for (i = 0; i < ARRAY_SIZE(weights); ++i)
+        weights[i] = i <= radius ? expf(-(float)(i * i) / (2.0f * sigma * sigma)) : 0.0f;
+    sum = weights[0];
+    for (i = 1; i <= radius; ++i)
+        sum += 2.0f * weights[i];
+
+    pass->cb.taps[count][0] = 0.0f;
+    pass->cb.taps[count++][1] = weights[0] / sum;
+    for (i = 1; i <= radius; i += 2)
+    {
+        weight = weights[i] + weights[i + 1];
+        offset = (i * weights[i] + (i + 1) * weights[i + 1]) / weight;
+        pass->cb.taps[count][0] = offset;
+        pass->cb.taps[count++][1] = weight / sum;
+        pass->cb.taps[count][0] = -offset;
+        pass->cb.taps[count++][1] = weight / sum;
+    }
+    pass->cb.tap_count = count;
+
+    return radius;
+}
+
+static void d2d_filter_chain_append_blur_pass(struct d2d_filter_chain *chain, float sigma, float dx, float dy)
+{
+    struct d2d_filter_pass *pass;
+    unsigned int radius;
+
+    if ((pass = d2d_filter_pass_create(&d2d_filter_blur_ps_id, D2D1_FILTER_MIN_MAG_MIP_LINEAR)))
+    {
+        radius = d2d_filter_pass_set_gaussian_kernel(pass, sigma);
+        pass->cb.direction[0] = dx;
+        pass->cb.direction[1] = dy;
+        pass->extent_x = ceilf(radius * fabsf(dx)) + 1;
+        pass->extent_y = ceilf(radius * fabsf(dy)) + 1;
+        pass->grow = !chain->hard_border;
+    }
+    d2d_filter_chain_append(chain, pass);
+}
+
+/* Append a blur along (dx, dy), or along both axes when "separable" is set.
+ * The standard deviation per pass is limited depending on the optimization
+ * mode; anything larger is handled by halving the resolution first. */
+static void d2d_filter_chain_append_blur(struct d2d_filter_chain *chain, float sigma, UINT32 optimization,
+        bool separable, float dx, float dy)
+{
+    static const float max_sigma[] = {2.0f, 4.0f, 8.0f};
+    unsigned int levels = 0, i;
+
+    if (sigma < 0.1f)
+        return;
+
+    while (sigma > max_sigma[min(optimization, 2)] && levels < D2D_FILTER_MAX_LEVELS)
+    {
+        sigma /= 2.0f;
+        ++levels;
+    }
+
+    for (i = 0; i < levels; ++i)
+        d2d_filter_chain_append_resample(chain, D2D_FILTER_PASS_SCALE_DOWN);
+    if (separable)
+    {
+        d2d_filter_chain_append_blur_pass(chain, sigma, 1.0f, 0.0f);
+        d2d_filter_chain_append_blur_pass(chain, sigma, 0.0f, 1.0f);
+    }
+    else
+    {
+        d2d_filter_chain_append_blur_pass(chain, sigma, dx, dy);
+    }
+    for (i = 0; i < levels; ++i)
+        d2d_filter_chain_append_resample(chain, D2D_FILTER_PASS_SCALE_UP);
+}
+
+static void d2d_filter_chain_append_color_matrix(struct d2d_filter_chain *chain,
+        const D2D_MATRIX_5X4_F *matrix, UINT32 flags)
+{
+    struct d2d_filter_pass *pass;
+    unsigned int i;
+
+    if ((pass = d2d_filter_pass_create(&d2d_filter_color_matrix_ps_id, D2D1_FILTER_MIN_MAG_MIP_POINT)))
+    {
+        for (i = 0; i < 5; ++i)
+            memcpy(pass->cb.taps[i], matrix->m[i], sizeof(pass->cb.taps[i]));
+        pass->cb.flags = flags;
+    }
+    d2d_filter_chain_append(chain, pass);
+}
+
+static void d2d_filter_chain_append_morphology(struct d2d_filter_chain *chain, UINT32 size,
+        bool dilate, bool vertical)
+{
+    struct d2d_filter_pass *pass;
+    LONG extent;
+
+    if (size <= 1)
+        return;
+
+    if ((pass = d2d_filter_pass_create(&d2d_filter_morphology_ps_id, D2D1_FILTER_MIN_MAG_MIP_POINT)))
+    {
+        /* The kernel covers [-(size - 1) / 2, size / 2]. */
+        pass->cb.taps[0][0] = -(float)((size - 1) / 2);
+        pass->cb.tap_count = size;
+        pass->cb.direction[vertical] = 1.0f;
+        pass->cb.flags = dilate ? D2D_FILTER_PASS_DILATE : 0;
+        extent = size / 2;
+        pass->extent_x = vertical ? 0 : extent;
+        pass->extent_y = vertical ? extent : 0;
+        pass->grow = dilate;
+    }
+    d2d_filter_chain_append(chain, pass);
+}
+
+static inline struct d2d_filter_effect *impl_from_ID2D1EffectImpl(ID2D1EffectImpl *iface)
+{
+    return CONTAINING_RECORD(iface, struct d2d_filter_effect, ID2D1EffectImpl_iface);
+}
+
+static inline struct d2d_filter_effect *d2d_filter_effect_from_IUnknown(const IUnknown *iface)
+{
+    return impl_from_ID2D1EffectImpl((ID2D1EffectImpl *)iface);
+}
+
+static HRESULT d2d_filter_effect_update_graph(struct d2d_filter_effect *effect)
+{
+    struct d2d_filter_chain chain = {0};
+    D2D_MATRIX_5X4_F matrix;
+    float angle;
+
+    chain.graph = effect->graph;
+    ID2D1TransformGraph_Clear(effect->graph);
+
+    switch (effect->type)
+    {
+        case D2D_FILTER_GAUSSIAN_BLUR:
+            chain.hard_border = effect->border_mode == D2D1_BORDER_MODE_HARD;
+            d2d_filter_chain_append_blur(&chain, effect->standard_deviation, effect->optimization, true, 0.0f, 0.0f);
+            break;
+
+        case D2D_FILTER_DIRECTIONAL_BLUR:
+            chain.hard_border = effect->border_mode == D2D1_BORDER_MODE_HARD;
+            angle = effect->angle * M_PI / 180.0f;
+            d2d_filter_chain_append_blur(&chain, effect->standard_deviation, effect->optimization,
+                    false, cosf(angle), -sinf(angle));
+            break;
+
+        case D2D_FILTER_SHADOW:
+            /* Replace the input with the shadow colour, scaled by the input
+             * alpha, then blur it. */
+            memset(&matrix, 0, sizeof(matrix));
+            matrix._41 = effect->color.x * effect->color.w;
+            matrix._42 = effect->color.y * effect->color.w;
+            matrix._43 = effect->color.z * effect->color.w;
+            matrix._44 = effect->color.w;
+            d2d_filter_chain_append_color_matrix(&chain, &matrix, 0);
+            d2d_filter_chain_append_blur(&chain, effect->standard_deviation, effect->optimization, true, 0.0f, 0.0f);
+            break;
+
+        case D2D_FILTER_COLOR_MATRIX:
+            d2d_filter_chain_append_color_matrix(&chain, &effect->matrix,
+                    (effect->alpha_mode == D2D1_COLORMATRIX_ALPHA_MODE_PREMULTIPLIED ? D2D_FILTER_PASS_PREMULTIPLIED : 0)
+                    | (effect->clamp_output ? D2D_FILTER_PASS_CLAMP_OUTPUT : 0));
+            break;
+
+        case D2D_FILTER_MORPHOLOGY:
+            d2d_filter_chain_append_morphology(&chain, effect->width,
+                    effect->morphology_mode == D2D1_MORPHOLOGY_MODE_DILATE, false);
+            d2d_filter_chain_append_morphology(&chain, effect->height,
+                    effect->morphology_mode == D2D1_MORPHOLOGY_MODE_DILATE, true);
+            break;
+    }
+
+    return d2d_filter_chain_finish(&chain);
+}
+
+static HRESULT d2d_filter_load_shader(ID2D1EffectContext *context, const GUID *id, const char *entry)
+{
+    ID3D10Blob *code;
+    HRESULT hr;
+
+    if (ID2D1EffectContext_IsShaderLoaded(context, id))
+        return S_OK;
+
+    if (FAILED(hr = D3DCompile(d2d_filter_ps_code, sizeof(d2d_filter_ps_code) - 1, entry,
+            NULL, NULL, entry, "ps_4_0", 0, 0, &code, NULL)))
+    {
+        WARN("Failed to compile shader %s, hr %#lx.\n", debugstr_a(entry), hr);
+        return hr;
+    }
+
+    hr = ID2D1EffectContext_LoadPixelShader(context, id, ID3D10Blob_GetBufferPointer(code),
+            ID3D10Blob_GetBufferSize(code));
+    ID3D10Blob_Release(code);
+
+    return hr;
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_filter_effect_QueryInterface(ID2D1EffectImpl *iface, REFIID iid, void **out)
+{
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+
+    if (IsEqualGUID(iid, &IID_ID2D1EffectImpl)
+            || IsEqualGUID(iid, &IID_IUnknown))
+    {
+        ID2D1EffectImpl_AddRef(iface);
+        *out = iface;
+        return S_OK;
+    }
+
+    *out = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG STDMETHODCALLTYPE d2d_filter_effect_AddRef(ID2D1EffectImpl *iface)
+{
+    struct d2d_filter_effect *effect = impl_from_ID2D1EffectImpl(iface);
+    ULONG refcount = InterlockedIncrement(&effect->refcount);
+
+    TRACE("%p increasing refcount to %lu.\n", iface, refcount);
+
+    return refcount;
+}
+
+static ULONG STDMETHODCALLTYPE d2d_filter_effect_Release(ID2D1EffectImpl *iface)
+{
+    struct d2d_filter_effect *effect = impl_from_ID2D1EffectImpl(iface);
+    ULONG refcount = InterlockedDecrement(&effect->refcount);
+
+    TRACE("%p decreasing refcount to %lu.\n", iface, refcount);
+
+    if (!refcount)
+    {
+        if (effect->graph)
+            ID2D1TransformGraph_Release(effect->graph);
+        free(effect);
+    }
+
+    return refcount;
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_filter_effect_Initialize(ID2D1EffectImpl *iface,
+        ID2D1EffectContext *context, ID2D1TransformGraph *graph)
+{
+    struct d2d_filter_effect *effect = impl_from_ID2D1EffectImpl(iface);
+    HRESULT hr;
+
+    TRACE("iface %p, context %p, graph %p.\n", iface, context, graph);
+
+    switch (effect->type)
+    {
+        case D2D_FILTER_GAUSSIAN_BLUR:
+        case D2D_FILTER_DIRECTIONAL_BLUR:
+        case D2D_FILTER_SHADOW:
+            if (FAILED(hr = d2d_filter_load_shader(context, &d2d_filter_blur_ps_id, "blur_main")))
+                return hr;
+            if (FAILED(hr = d2d_filter_load_shader(context, &d2d_filter_resample_ps_id, "resample_main")))
+                return hr;
+            if (effect->type != D2D_FILTER_SHADOW)
+                break;
+            /* fall through */
+        case D2D_FILTER_COLOR_MATRIX:
+            if (FAILED(hr = d2d_filter_load_shader(context, &d2d_filter_color_matrix_ps_id, "color_matrix_main")))
+                return hr;
+            break;
+
+        case D2D_FILTER_MORPHOLOGY:
+            if (FAILED(hr = d2d_filter_load_shader(context, &d2d_filter_morphology_ps_id, "morphology_main")))
+                return hr;
+            break;
+    }
+
+    ID2D1TransformGraph_AddRef(effect->graph = graph);
+
+    return d2d_filter_effect_update_graph(effect);
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_filter_effect_PrepareForRender(ID2D1EffectImpl *iface, D2D1_CHANGE_TYPE type)
+{
+    struct d2d_filter_effect *effect = impl_from_ID2D1EffectImpl(iface);
+
+    TRACE("iface %p, type %#x.\n", iface, type);
+
+    if (type == D2D1_CHANGE_TYPE_NONE)
+        return S_OK;
+
+    return d2d_filter_effect_update_graph(effect);
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_filter_effect_SetGraph(ID2D1EffectImpl *iface, ID2D1TransformGraph *graph)
+{
+    TRACE("iface %p, graph %p.\n", iface, graph);
+
+    return E_NOTIMPL;
+}
+
+static const ID2D1EffectImplVtbl d2d_filter_effect_vtbl =
+{
+    d2d_filter_effect_QueryInterface,
+    d2d_filter_effect_AddRef,
+    d2d_filter_effect_Release,
+    d2d_filter_effect_Initialize,
+    d2d_filter_effect_PrepareForRender,
+    d2d_filter_effect_SetGraph,
+};
+
+static HRESULT d2d_filter_effect_create(enum d2d_filter_type type, IUnknown **effect_impl)
+{
+    struct d2d_filter_effect *object;
+
+    if (!(object = calloc(1, sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    object->ID2D1EffectImpl_iface.lpVtbl = &d2d_filter_effect_vtbl;
+    object->refcount = 1;
+    object->type = type;
+
+    object->standard_deviation = 3.0f;
+    object->optimization = D2D1_GAUSSIANBLUR_OPTIMIZATION_BALANCED;
+    object->border_mode = D2D1_BORDER_MODE_SOFT;
+    object->color.w = 1.0f;
+    object->matrix._11 = object->matrix._22 = object->matrix._33 = object->matrix._44 = 1.0f;
+    object->alpha_mode = D2D1_COLORMATRIX_ALPHA_MODE_PREMULTIPLIED;
+    object->morphology_mode = D2D1_MORPHOLOGY_MODE_ERODE;
+    object->width = object->height = 1;
+
+    *effect_impl = (IUnknown *)&object->ID2D1EffectImpl_iface;
+
+    return S_OK;
+}
+
+static HRESULT d2d_filter_return_value(const void *value, UINT32 value_size,
+        BYTE *data, UINT32 data_size, UINT32 *actual_size)
+{
+    if (actual_size)
+        *actual_size = value_size;
+    if (!data)
+        return S_OK;
+    if (data_size != value_size)
+        return E_INVALIDARG;
+    memcpy(data, value, value_size);
+    return S_OK;
+}
+
+#define D2D_FILTER_PROPERTY(name, field, type, check) \
+static HRESULT STDMETHODCALLTYPE d2d_filter_set_##name(IUnknown *iface, const BYTE *data, UINT32 data_size) \
+{ \
+    struct d2d_filter_effect *effect = d2d_filter_effect_from_IUnknown(iface); \
+    type value; \
+\
+    if (data_size != sizeof(value)) return E_INVALIDARG; \
+    memcpy(&value, data, sizeof(value)); \
+    if (!(check)) return E_INVALIDARG; \
+    effect->field = value; \
+    return S_OK; \
+} \
+\
+static HRESULT STDMETHODCALLTYPE d2d_filter_get_##name(const IUnknown *iface, BYTE *data, UINT32 data_size, \
+        UINT32 *actual_size) \
+{ \
+    const struct d2d_filter_effect *effect = d2d_filter_effect_from_IUnknown(iface); \
+\
+    return d2d_filter_return_value(&effect->field, sizeof(effect->field), data, data_size, actual_size); \
+}
+
+D2D_FILTER_PROPERTY(standard_deviation, standard_deviation, float, value >= 0.0f && value <= 250.0f)
+D2D_FILTER_PROPERTY(angle, angle, float, isfinite(value))
+D2D_FILTER_PROPERTY(optimization, optimization, UINT32, value <= D2D1_GAUSSIANBLUR_OPTIMIZATION_QUALITY)
+D2D_FILTER_PROPERTY(border_mode, border_mode, UINT32, value <= D2D1_BORDER_MODE_HARD)
+D2D_FILTER_PROPERTY(color, color, D2D_VECTOR_4F, true)
+D2D_FILTER_PROPERTY(color_matrix, matrix, D2D_MATRIX_5X4_F, true)
+D2D_FILTER_PROPERTY(alpha_mode, alpha_mode, UINT32,
+        value == D2D1_COLORMATRIX_ALPHA_MODE_PREMULTIPLIED || value == D2D1_COLORMATRIX_ALPHA_MODE_STRAIGHT)
+D2D_FILTER_PROPERTY(clamp_output, clamp_output, BOOL, true)
+D2D_FILTER_PROPERTY(morphology_mode, morphology_mode, UINT32, value <= D2D1_MORPHOLOGY_MODE_DILATE)
+D2D_FILTER_PROPERTY(width, width, UINT32, value >= 1 && value <= 100)
+D2D_FILTER_PROPERTY(height, height, UINT32, value >= 1 && value <= 100)
+
+#undef D2D_FILTER_PROPERTY
+
+#define D2D_FILTER_BINDING(property, name) { L##property, d2d_filter_set_##name, d2d_filter_get_##name }
+
+static HRESULT STDMETHODCALLTYPE d2d_gaussian_blur_factory(IUnknown **effect_impl)
+{
+    return d2d_filter_effect_create(D2D_FILTER_GAUSSIAN_BLUR, effect_impl);
+}
+
+static const WCHAR gaussian_blur_description[] =
+L"<?xml version='1.0'?>                                                            \
+  <Effect>                                                                         \
+    <Property name='DisplayName' type='string' value='Gaussian Blur'/>             \
+    <Property name='Author'      type='string' value='The Wine Project'/>          \
+    <Property name='Category'    type='string' value='Blur'/>                      \
+    <Property name='Description' type='string' value='Gaussian Blur'/>             \
+    <Inputs>                                                                       \
+      <Input name='Source'/>                                                       \
+    </Inputs>                                                                      \
+    <Property name='StandardDeviation' type='float' value='3.0'/>                  \
+    <Property name='Optimization'      type='enum'  value='1'/>                    \
+    <Property name='BorderMode'        type='enum'  value='0'/>                    \
+  </Effect>";
+
+static const D2D1_PROPERTY_BINDING gaussian_blur_bindings[] =
+{
+    D2D_FILTER_BINDING("StandardDeviation", standard_deviation),
+    D2D_FILTER_BINDING("Optimization", optimization),
+    D2D_FILTER_BINDING("BorderMode", border_mode),
+};
+
+static HRESULT STDMETHODCALLTYPE d2d_directional_blur_factory(IUnknown **effect_impl)
+{
+    return d2d_filter_effect_create(D2D_FILTER_DIRECTIONAL_BLUR, effect_impl);
+}
+
+static const WCHAR directional_blur_description[] =
+L"<?xml version='1.0'?>                                                            \
+  <Effect>                                                                         \
+    <Property name='DisplayName' type='string' value='Directional Blur'/>          \
+    <Property name='Author'      type='string' value='The Wine Project'/>          \
+    <Property name='Category'    type='string' value='Blur'/>                      \
+    <Property name='Description' type='string' value='Directional Blur'/>          \
+    <Inputs>                                                                       \
+      <Input name='Source'/>                                                       \
+    </Inputs>                                                                      \
+    <Property name='StandardDeviation' type='float' value='3.0'/>                  \
+    <Property name='Angle'             type='float' value='0.0'/>                  \
+    <Property name='Optimization'      type='enum'  value='1'/>                    \
+    <Property name='BorderMode'        type='enum'  value='0'/>                    \
+  </Effect>";
+
+static const D2D1_PROPERTY_BINDING directional_blur_bindings[] =
+{
+    D2D_FILTER_BINDING("StandardDeviation", standard_deviation),
+    D2D_FILTER_BINDING("Angle", angle),
+    D2D_FILTER_BINDING("Optimization", optimization),
+    D2D_FILTER_BINDING("BorderMode", border_mode),
+};
+
+static HRESULT STDMETHODCALLTYPE d2d_shadow_factory(IUnknown **effect_impl)
+{
+    return d2d_filter_effect_create(D2D_FILTER_SHADOW, effect_impl);
+}
+
+static const WCHAR shadow_description[] =
+L"<?xml version='1.0'?>                                                                  \
+  <Effect>                                                                               \
+    <Property name='DisplayName' type='string' value='Shadow'/>                          \
+    <Property name='Author'      type='string' value='The Wine Project'/>                \
+    <Property name='Category'    type='string' value='Photo'/>                           \
+    <Property name='Description' type='string' value='Shadow'/>                          \
+    <Inputs>                                                                             \
+      <Input name='Source'/>                                                             \
+    </Inputs>                                                                            \
+    <Property name='BlurStandardDeviation' type='float'   value='3.0'/>                  \
+    <Property name='Color'                 type='vector4' value='(0.0,0.0,0.0,1.0)'/>    \
+    <Property name='Optimization'          type='enum'    value='1'/>                    \
+  </Effect>";
+
+static const D2D1_PROPERTY_BINDING shadow_bindings[] =
+{
+    D2D_FILTER_BINDING("BlurStandardDeviation", standard_deviation),
+    D2D_FILTER_BINDING("Color", color),
+    D2D_FILTER_BINDING("Optimization", optimization),
+};
+
+static HRESULT STDMETHODCALLTYPE d2d_color_matrix_factory(IUnknown **effect_impl)
+{
+    return d2d_filter_effect_create(D2D_FILTER_COLOR_MATRIX, effect_impl);
+}
+
+static const WCHAR color_matrix_description[] =
+L"<?xml version='1.0'?>                                                            \
+  <Effect>                                                                         \
+    <Property name='DisplayName' type='string' value='Color Matrix'/>              \
+    <Property name='Author'      type='string' value='The Wine Project'/>          \
+    <Property name='Category'    type='string' value='Color'/>                     \
+    <Property name='Description' type='string' value='Color Matrix'/>              \
+    <Inputs>                                                                       \
+      <Input name='Source'/>                                                       \
+    </Inputs>                                                                      \
+    <Property name='ColorMatrix' type='matrix5x4'                                  \
+        value='(1.0,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0,1.0,0.0,0.0,0.0,0.0)'/> \
+    <Property name='AlphaMode'   type='enum' value='1'/>                           \
+    <Property name='ClampOutput' type='bool' value='false'/>                       \
+  </Effect>";
+
+static const D2D1_PROPERTY_BINDING color_matrix_bindings[] =
+{
+    D2D_FILTER_BINDING("ColorMatrix", color_matrix),
+    D2D_FILTER_BINDING("AlphaMode", alpha_mode),
+    D2D_FILTER_BINDING("ClampOutput", clamp_output),
+};
+
+static HRESULT STDMETHODCALLTYPE d2d_morphology_factory(IUnknown **effect_impl)
+{
+    return d2d_filter_effect_create(D2D_FILTER_MORPHOLOGY, effect_impl);
+}
+
+static const WCHAR morphology_description[] =
+L"<?xml version='1.0'?>                                                            \
+  <Effect>                                                                         \
+    <Property name='DisplayName' type='string' value='Morphology'/>                \
+    <Property name='Author'      type='string' value='The Wine Project'/>          \
+    <Property name='Category'    type='string' value='Filter'/>                    \
+    <Property name='Description' type='string' value='Morphology'/>                \
+    <Inputs>                                                                       \
+      <Input name='Source'/>                                                       \
+    </Inputs>                                                                      \
+    <Property name='Mode'   type='enum'   value='0'/>                              \
+    <Property name='Width'  type='uint32' value='1'/>                              \
+    <Property name='Height' type='uint32' value='1'/>                              \
+  </Effect>";
+
+static const D2D1_PROPERTY_BINDING morphology_bindings[] =
+{
+    D2D_FILTER_BINDING("Mode", morphology_mode),
+    D2D_FILTER_BINDING("Width", width),
+    D2D_FILTER_BINDING("Height", height),
+};
+
+#undef D2D_FILTER_BINDING
+
+void d2d_effects_init_filters(struct d2d_factory *factory)
+{
+    static const struct filter_description
+    {
+        const CLSID *clsid;
+        const WCHAR *description;
+        const D2D1_PROPERTY_BINDING *bindings;
+        UINT32 binding_count;
+        PD2D1_EFFECT_FACTORY factory;
+    }
+    filter_effects[] =
+    {
+        {&CLSID_D2D1GaussianBlur, gaussian_blur_description, gaussian_blur_bindings,
+                ARRAY_SIZE(gaussian_blur_bindings), d2d_gaussian_blur_factory},
+        {&CLSID_D2D1DirectionalBlur, directional_blur_description, directional_blur_bindings,
+                ARRAY_SIZE(directional_blur_bindings), d2d_directional_blur_factory},
+        {&CLSID_D2D1Shadow, shadow_description, shadow_bindings,
+                ARRAY_SIZE(shadow_bindings), d2d_shadow_factory},
+        {&CLSID_D2D1ColorMatrix, color_matrix_description, color_matrix_bindings,
+                ARRAY_SIZE(color_matrix_bindings), d2d_color_matrix_factory},
+        {&CLSID_D2D1Morphology, morphology_description, morphology_bindings,
+                ARRAY_SIZE(morphology_bindings), d2d_morphology_factory},
+    };
+    unsigned int i;
+    HRESULT hr;
+
+    for (i = 0; i < ARRAY_SIZE(filter_effects); ++i)
+    {
+        if (FAILED(hr = d2d_factory_register_builtin_effect(factory, filter_effects[i].clsid,
+                filter_effects[i].description, filter_effects[i].bindings, filter_effects[i].binding_count,
+                filter_effects[i].factory)))
+        {
+            WARN("Failed to register the effect %s, hr %#lx.\n", wine_dbgstr_guid(filter_effects[i].clsid), hr);
+        }
+    }
+}
@@ -0,0 +1,1071 @@
+/*
+ * Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include "d2d1_private.h"
+#include <d3dcompiler.h>
+
+WINE_DEFAULT_DEBUG_CHANNEL(d2d);
+
+/* Effect graphs are rendered on the GPU, one transform node at a time.
+ * Starting from the output node, the requested output rectangle is mapped
+ * to rectangles of the node inputs, which are rendered first. Each draw
+ * transform then renders exactly its output rectangle into an intermediate
+ * texture taken from a per-context pool. Offset and bounds adjustment
+ * transforms usually only change where the data of their input is, and
+ * don't need to be rendered at all. */
+
+#define D2D_EFFECT_MAX_INPUTS 8
+#define D2D_EFFECT_MAX_DEPTH 32
+#define D2D_EFFECT_MAX_INTERMEDIATE_SIZE 8192
+#define D2D_EFFECT_MAX_FREE_INTERMEDIATES 8
+
+enum d2d_effect_extend_mode
+{
+    D2D_EFFECT_EXTEND_MODE_CLAMP = D2D1_EXTEND_MODE_CLAMP,
+    D2D_EFFECT_EXTEND_MODE_WRAP = D2D1_EXTEND_MODE_WRAP,
+    D2D_EFFECT_EXTEND_MODE_MIRROR = D2D1_EXTEND_MODE_MIRROR,
+    D2D_EFFECT_EXTEND_MODE_NONE,
+};
+
+/* {6b4e7bd6-2f4b-4a53-9a36-5c03a5a41a50} */
+static const GUID d2d_effect_vs_id = {0x6b4e7bd6, 0x2f4b, 0x4a53, {0x9a, 0x36, 0x5c, 0x03, 0xa5, 0xa4, 0x1a, 0x50}};
+/* {6b4e7bd6-2f4b-4a53-9a36-5c03a5a41a51} */
+static const GUID d2d_effect_copy_ps_id = {0x6b4e7bd6, 0x2f4b, 0x4a53, {0x9a, 0x36, 0x5c, 0x03, 0xa5, 0xa4, 0x1a, 0x51}};
+
+struct d2d_effect_vs_cb
+{
+    struct d2d_vec4 output_rect;
+    struct d2d_vec4 target;
+    struct d2d_vec4 inputs[D2D_EFFECT_MAX_INPUTS];
+};
+
+/* Bound to the second pixel shader constant buffer slot, where it's not
+ * visible to custom effects. Only used by built-in shaders. */
+struct d2d_effect_input_cb
+{
+    /* Valid data of each input, in scene coordinates. */
+    struct d2d_vec4 bounds[D2D_EFFECT_MAX_INPUTS];
+};
+
+struct d2d_effect_copy_ps_cb
+{
+    struct d2d_vec4 bounds;
+    unsigned int extend[4];
+};
+
+struct d2d_effect_render_context
+{
+    struct d2d_device_context *context;
+    struct d2d_effect_renderer *renderer;
+    ID3D11DeviceContext1 *d3d_context;
+    ID3D11VertexShader *vs;
+    ID3D11PixelShader *copy_ps;
+    unsigned int depth;
+};
+
+static const D2D1_RECT_L d2d_empty_rect;
+
+static bool d2d_rect_l_is_empty(const D2D1_RECT_L *rect)
+{
+    return rect->left >= rect->right || rect->top >= rect->bottom;
+}
+
+static void d2d_rect_l_intersect(D2D1_RECT_L *dst, const D2D1_RECT_L *src)
+{
+    dst->left = max(dst->left, src->left);
+    dst->top = max(dst->top, src->top);
+    dst->right = min(dst->right, src->right);
+    dst->bottom = min(dst->bottom, src->bottom);
+    if (d2d_rect_l_is_empty(dst))
+        *dst = d2d_empty_rect;
+}
+
+static void d2d_rect_l_union(D2D1_RECT_L *dst, const D2D1_RECT_L *src)
+{
+    if (d2d_rect_l_is_empty(src))
+        return;
+    if (d2d_rect_l_is_empty(dst))
+    {
+        *dst = *src;
+        return;
+    }
+    dst->left = min(dst->left, src->left);
+    dst->top = min(dst->top, src->top);
+    dst->right = max(dst->right, src->right);
+    dst->bottom = max(dst->bottom, src->bottom);
+}
+
+static void d2d_rect_l_offset(D2D1_RECT_L *rect, const D2D1_POINT_2L *offset)
+{
+    rect->left += offset->x;
+    rect->top += offset->y;
+    rect->right += offset->x;
+    rect->bottom += offset->y;
+}
+
+static HRESULT d2d_effect_renderer_compile_shader(struct d2d_device_context *context, const GUID *id,
+        const char *code, size_t code_size, const char *profile)
+{
+    struct d2d_device *device = context->device;
+    ID3D10Blob *compiled;
+    IUnknown *shader;
+    HRESULT hr;
+
+    if (d2d_device_get_indexed_object(&device->shaders, id, NULL))
+        return S_OK;
+
+    if (FAILED(hr = D3DCompile(code, code_size, profile, NULL, NULL, "main", profile, 0, 0, &compiled, NULL)))
+    {
+        WARN("Failed to compile %s shader, hr %#lx.\n", profile, hr);
+        return hr;
+    }
+
+    if (profile[0] == 'v')
+        hr = ID3D11Device1_CreateVertexShader(context->d3d_device, ID3D10Blob_GetBufferPointer(compiled),
+                ID3D10Blob_GetBufferSize(compiled), NULL, (ID3D11VertexShader **)&shader);
+    else
+        hr = ID3D11Device1_CreatePixelShader(context->d3d_device, ID3D10Blob_GetBufferPointer(compiled),
+                ID3D10Blob_GetBufferSize(compiled), NULL, (ID3D11PixelShader **)&shader);
+    ID3D10Blob_Release(compiled);
+    if (FAILED(hr))
+    {
+        WARN("Failed to create %s shader, hr %#lx.\n", profile, hr);
+        return hr;
+    }
+
+    hr = d2d_device_add_indexed_object(&device->shaders, id, shader);
+    IUnknown_Release(shader);
+
+    return hr;
+}
+
+/* The vertex shader output layout follows the one expected by pixel shaders
+ * of custom effects: scene position followed by one texture coordinate per
+ * input, with the size of a texel in texture space in zw. */
+static HRESULT d2d_effect_renderer_init_shaders(struct d2d_device_context *context)
+{
+    static const char vs_code[] =
+        "#define MAX_INPUTS 8\n"
+        "cbuffer cb : register(b0)\n"
+        "{\n"
+        "    float4 output_rect;\n"
+        "    float4 target;\n"
+        "    float4 inputs[MAX_INPUTS];\n"
+        "};\n"
+        "\n"
+        "struct vs_out\n"
+        "{\n"
+        "    float4 position : SV_POSITION;\n"
+        "    float4 scene : SCENE_POSITION;\n"
+        "    float4 t0 : TEXCOORD0;\n"
+        "    float4 t1 : TEXCOORD1;\n"
+        "    float4 t2 : TEXCOORD2;\n"
+        "    float4 t3 : TEXCOORD3;\n"
+        "    float4 t4 : TEXCOORD4;\n"
+        "    float4 t5 : TEXCOORD5;\n"
+        "    float4 t6 : TEXCOORD6;\n"
+        "    float4 t7 : TEXCOORD7;\n"
+        "};\n"
+        "\n"
+        "float4 texcoord(float2 p, float4 input)\n"
+        "{\n"
+        "    return float4((p - input.xy) * input.zw, input.zw);\n"
+        "}\n"
+        "\n"
+        "void main(uint id : SV_VertexID, out vs_out o)\n"
+        "{\n"
+        "    float2 p;\n"
+        "\n"
+        "    p.x = (id & 1) ? output_rect.z : output_rect.x;\n"
+        "    p.y = (id & 2) ? output_rect.w : output_rect.y;\n"
+        "    o.position = float4(float2(2.0f, -2.0f) * (p - target.xy) * target.zw + float2(-1.0f, 1.0f), 0.0f, 1.0f);\n"
+        "    o.scene = float4(p, 0.0f, 1.0f);\n"
+        "    o.t0 = texcoord(p, inputs[0]);\n"
+        "    o.t1 = texcoord(p, inputs[1]);\n"
+        "    o.t2 = texcoord(p, inputs[2]);\n"
+        "    o.t3 = texcoord(p, inputs[3]);\n"
+        "    o.t4 = texcoord(p, inputs[4]);\n"
+        "    o.t5 = texcoord(p, inputs[5]);\n"
+        "    o.t6 = texcoord(p, inputs[6]);\n"
+        "    o.t7 = texcoord(p, inputs[7]);\n"
+        "}\n";
+    /* Copies the input, optionally extending its edges the way border
+     * transforms do. "bounds" is the valid input data in texture space. */
+    static const char copy_ps_code[] =
+        "cbuffer cb : register(b0)\n"
+        "{\n"
+        "    float4 bounds;\n"
+        "    uint4 extend;\n"
+        "};\n"
+        "\n"
+        "Texture2D t : register(t0);\n"
+        "SamplerState s : register(s0);\n"
+        "\n"
+        "float extend_coord(float c, float lo, float hi, float texel, uint mode)\n"
+        "{\n"
+        "    float size = hi - lo, f;\n"
+        "\n"
+        "    if (mode == 0)\n"
+        "        return clamp(c, lo + 0.5f * texel, hi - 0.5f * texel);\n"
+        "    if (mode == 1)\n"
+        "        return lo + frac((c - lo) / size) * size;\n"
+        "    if (mode == 2)\n"
+        "    {\n"
+        "        f = frac((c - lo) / (2.0f * size)) * 2.0f;\n"
+        "        return lo + (f > 1.0f ? 2.0f - f : f) * size;\n"
+        "    }\n"
+        "    return c;\n"
+        "}\n"
+        "\n"
+        "float4 main(float4 position : SV_POSITION, float4 scene : SCENE_POSITION,\n"
+        "        float4 uv : TEXCOORD0) : SV_Target\n"
+        "{\n"
+        "    float2 c;\n"
+        "\n"
+        "    c.x = extend_coord(uv.x, bounds.x, bounds.z, uv.z, extend.x);\n"
+        "    c.y = extend_coord(uv.y, bounds.y, bounds.w, uv.w, extend.y);\n"
+        "    return t.Sample(s, c);\n"
+        "}\n";
+    HRESULT hr;
+
+    if (FAILED(hr = d2d_effect_renderer_compile_shader(context, &d2d_effect_vs_id,
+            vs_code, sizeof(vs_code) - 1, "vs_4_0")))
+        return hr;
+    return d2d_effect_renderer_compile_shader(context, &d2d_effect_copy_ps_id,
+            copy_ps_code, sizeof(copy_ps_code) - 1, "ps_4_0");
+}
+
+static HRESULT d2d_effect_renderer_create_sampler(struct d2d_device_context *context,
+        D3D11_FILTER filter, ID3D11SamplerState **sampler)
+{
+    D3D11_SAMPLER_DESC sampler_desc;
+
+    /* Everything outside of an input is transparent. */
+    sampler_desc.Filter = filter;
+    sampler_desc.AddressU = D3D11_TEXTURE_ADDRESS_BORDER;
+    sampler_desc.AddressV = D3D11_TEXTURE_ADDRESS_BORDER;
+    sampler_desc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+    sampler_desc.MipLODBias = 0.0f;
+    sampler_desc.MaxAnisotropy = 0;
+    sampler_desc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+    sampler_desc.BorderColor[0] = 0.0f;
+    sampler_desc.BorderColor[1] = 0.0f;
+    sampler_desc.BorderColor[2] = 0.0f;
+    sampler_desc.BorderColor[3] = 0.0f;
+    sampler_desc.MinLOD = 0.0f;
+    sampler_desc.MaxLOD = 0.0f;
+
+    return ID3D11Device1_CreateSamplerState(context->d3d_device, &sampler_desc, sampler);
+}
+
+static HRESULT d2d_effect_renderer_create_buffer(struct d2d_device_context *context,
+        unsigned int size, ID3D11Buffer **buffer)
+{
+    D3D11_BUFFER_DESC buffer_desc;
+
+    buffer_desc.ByteWidth = size;
+    buffer_desc.Usage = D3D11_USAGE_DYNAMIC;
+    buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+    buffer_desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    buffer_desc.MiscFlags = 0;
+    buffer_desc.StructureByteStride = 0;
+
+    return ID3D11Device1_CreateBuffer(context->d3d_device, &buffer_desc, NULL, buffer);
+}
+
+static HRESULT d2d_effect_renderer_init(struct d2d_device_context *context)
+{
+    struct d2d_effect_renderer *renderer = &context->effect_renderer;
+    HRESULT hr;
+
+    if (renderer->vs_cb)
+        return S_OK;
+
+    if (FAILED(hr = d2d_effect_renderer_init_shaders(context)))
+        return hr;
+
+    if (FAILED(hr = d2d_effect_renderer_create_sampler(context, D3D11_FILTER_MIN_MAG_MIP_POINT,
+            &renderer->point_sampler)))
+        goto fail;
+    if (FAILED(hr = d2d_effect_renderer_create_sampler(context, D3D11_FILTER_MIN_MAG_MIP_LINEAR,
+            &renderer->linear_sampler)))
+        goto fail;
+    if (FAILED(hr = d2d_effect_renderer_create_buffer(context, sizeof(struct d2d_effect_copy_ps_cb),
+            &renderer->ps_cb)))
+        goto fail;
+    if (FAILED(hr = d2d_effect_renderer_create_buffer(context, sizeof(struct d2d_effect_vs_cb),
+            &renderer->vs_cb)))
+        goto fail;
+    if (FAILED(hr = d2d_effect_renderer_create_buffer(context, sizeof(struct d2d_effect_input_cb),
+            &renderer->input_cb)))
+        goto fail;
+
+    return S_OK;
+
+fail:
+    WARN("Failed to initialize the effect renderer, hr %#lx.\n", hr);
+    d2d_effect_renderer_cleanup(renderer);
+    return hr;
+}
+
+void d2d_effect_renderer_cleanup(struct d2d_effect_renderer *renderer)
+{
+    size_t i;
+
+    for (i = 0; i < renderer->intermediate_count; ++i)
+    {
+        ID2D1Bitmap1_Release(&renderer->intermediates[i]->bitmap->ID2D1Bitmap1_iface);
+        free(renderer->intermediates[i]);
+    }
+    free(renderer->intermediates);
+    for (i = 0; i < renderer->blend_state_count; ++i)
+        ID3D11BlendState_Release(renderer->blend_states[i].state);
+    free(renderer->blend_states);
+    if (renderer->vs_cb)
+        ID3D11Buffer_Release(renderer->vs_cb);
+    if (renderer->ps_cb)
+        ID3D11Buffer_Release(renderer->ps_cb);
+    if (renderer->input_cb)
+        ID3D11Buffer_Release(renderer->input_cb);
+    if (renderer->point_sampler)
+        ID3D11SamplerState_Release(renderer->point_sampler);
+    if (renderer->linear_sampler)
+        ID3D11SamplerState_Release(renderer->linear_sampler);
+    memset(renderer, 0, sizeof(*renderer));
+}
+
+/* Intermediates are pooled, and sized in steps of 256 pixels so that they
+ * can be reused for slightly different rectangles. Find the smallest free
+ * one that is large enough, or create a new one. */
+static struct d2d_effect_intermediate *d2d_effect_renderer_get_intermediate(
+        struct d2d_device_context *context, unsigned int width, unsigned int height)
+{
+    struct d2d_effect_renderer *renderer = &context->effect_renderer;
+    struct d2d_effect_intermediate *intermediate = NULL;
+    D2D1_BITMAP_PROPERTIES1 bitmap_desc;
+    struct d2d_bitmap *bitmap;
+    D2D1_SIZE_U size;
+    size_t i;
+
+    for (i = 0; i < renderer->intermediate_count; ++i)
+    {
+        struct d2d_effect_intermediate *current = renderer->intermediates[i];
+
+        if (current->in_use || current->bitmap->pixel_size.width < width
+                || current->bitmap->pixel_size.height < height)
+            continue;
+
+        if (!intermediate || current->bitmap->pixel_size.width * current->bitmap->pixel_size.height
+                < intermediate->bitmap->pixel_size.width * intermediate->bitmap->pixel_size.height)
+            intermediate = current;
+    }
+
+    if (intermediate)
+    {
+        intermediate->in_use = true;
+        return intermediate;
+    }
+
+    if (!d2d_array_reserve((void **)&renderer->intermediates, &renderer->intermediates_size,
+            renderer->intermediate_count + 1, sizeof(*renderer->intermediates)))
+        return NULL;
+    if (!(intermediate = calloc(1, sizeof(*intermediate))))
+        return NULL;
+
+    size.width = min((width + 255) & ~255u, D2D_EFFECT_MAX_INTERMEDIATE_SIZE);
+    size.height = min((height + 255) & ~255u, D2D_EFFECT_MAX_INTERMEDIATE_SIZE);
+    bitmap_desc.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    bitmap_desc.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
+    bitmap_desc.dpiX = 96.0f;
+    bitmap_desc.dpiY = 96.0f;
+    bitmap_desc.bitmapOptions = D2D1_BITMAP_OPTIONS_TARGET;
+    bitmap_desc.colorContext = NULL;
+    if (FAILED(d2d_bitmap_create(context, size, NULL, 0, &bitmap_desc, &bitmap)))
+    {
+        WARN("Failed to create a %ux%u intermediate.\n", size.width, size.height);
+        free(intermediate);
+        return NULL;
+    }
+
+    TRACE("Created a %ux%u intermediate.\n", size.width, size.height);
+
+    renderer->intermediates[renderer->intermediate_count++] = intermediate;
+    intermediate->bitmap = bitmap;
+    intermediate->in_use = true;
+    return intermediate;
+}
+
+static void d2d_effect_renderer_put_intermediate(struct d2d_device_context *context,
+        struct d2d_effect_intermediate *intermediate)
+{
+    struct d2d_effect_renderer *renderer = &context->effect_renderer;
+    size_t i, free_count = 0;
+
+    intermediate->in_use = false;
+
+    for (i = 0; i < renderer->intermediate_count; ++i)
+    {
+        if (!renderer->intermediates[i]->in_use)
+            ++free_count;
+    }
+    if (free_count <= D2D_EFFECT_MAX_FREE_INTERMEDIATES)
+        return;
+
+    /* Drop the one that was just released, keeping the pool bounded. */
+    for (i = 0; i < renderer->intermediate_count; ++i)
+    {
+        if (renderer->intermediates[i] == intermediate)
+            break;
+    }
+    renderer->intermediates[i] = renderer->intermediates[--renderer->intermediate_count];
+    ID2D1Bitmap1_Release(&intermediate->bitmap->ID2D1Bitmap1_iface);
+    free(intermediate);
+}
+
+void d2d_effect_source_release(struct d2d_device_context *context, struct d2d_effect_source *source)
+{
+    if (source->intermediate)
+        d2d_effect_renderer_put_intermediate(context, source->intermediate);
+    else if (source->bitmap)
+        ID2D1Bitmap1_Release(&source->bitmap->ID2D1Bitmap1_iface);
+    memset(source, 0, sizeof(*source));
+}
+
+static void d2d_effect_source_get_texcoords(const struct d2d_effect_source *source, struct d2d_vec4 *v)
+{
+    v->x = source->origin.x;
+    v->y = source->origin.y;
+    v->z = 1.0f / source->bitmap->pixel_size.width;
+    v->w = 1.0f / source->bitmap->pixel_size.height;
+}
+
+static HRESULT d2d_effect_renderer_update_buffer(struct d2d_effect_render_context *ctx,
+        ID3D11Buffer *buffer, const void *data, size_t size)
+{
+    D3D11_MAPPED_SUBRESOURCE map_desc;
+    HRESULT hr;
+
+    if (FAILED(hr = ID3D11DeviceContext1_Map(ctx->d3d_context, (ID3D11Resource *)buffer,
+            0, D3D11_MAP_WRITE_DISCARD, 0, &map_desc)))
+    {
+        WARN("Failed to map constant buffer, hr %#lx.\n", hr);
+        return hr;
+    }
+    memcpy(map_desc.pData, data, size);
+    ID3D11DeviceContext1_Unmap(ctx->d3d_context, (ID3D11Resource *)buffer, 0);
+
+    return S_OK;
+}
+
+static HRESULT d2d_effect_renderer_draw(struct d2d_effect_render_context *ctx, const D2D1_RECT_L *rect,
+        const struct d2d_effect_source *sources, unsigned int source_count, ID3D11PixelShader *ps,
+        ID3D11Buffer *ps_cb, ID3D11SamplerState **samplers, struct d2d_effect_source *output)
+{
+    ID3D11ShaderResourceView *views[D2D_EFFECT_MAX_INPUTS] = {0};
+    struct d2d_effect_intermediate *intermediate;
+    struct d2d_effect_input_cb input_cb;
+    struct d2d_effect_vs_cb vs_cb;
+    struct d2d_bitmap *target;
+    static const float clear_colour[4];
+    D3D11_VIEWPORT vp;
+    unsigned int i;
+    HRESULT hr;
+
+    /* Inner nodes may need more than the requested rectangle, e.g. for
+     * blur padding, and are limited the same way. */
+    if (rect->right - rect->left > D2D_EFFECT_MAX_INTERMEDIATE_SIZE
+            || rect->bottom - rect->top > D2D_EFFECT_MAX_INTERMEDIATE_SIZE)
+    {
+        WARN("Intermediate %s exceeds the maximum texture size.\n", debug_d2d_rect_l(rect));
+        return D2DERR_MAX_TEXTURE_SIZE_EXCEEDED;
+    }
+
+    if (!(intermediate = d2d_effect_renderer_get_intermediate(ctx->context,
+            rect->right - rect->left, rect->bottom - rect->top)))
+        return E_OUTOFMEMORY;
+    target = intermediate->bitmap;
+
+    memset(&vs_cb, 0, sizeof(vs_cb));
+    memset(&input_cb, 0, sizeof(input_cb));
+    vs_cb.output_rect.x = rect->left;
+    vs_cb.output_rect.y = rect->top;
+    vs_cb.output_rect.z = rect->right;
+    vs_cb.output_rect.w = rect->bottom;
+    vs_cb.target.x = rect->left;
+    vs_cb.target.y = rect->top;
+    vs_cb.target.z = 1.0f / target->pixel_size.width;
+    vs_cb.target.w = 1.0f / target->pixel_size.height;
+    for (i = 0; i < source_count; ++i)
+    {
+        if (!sources[i].bitmap)
+            continue;
+        d2d_effect_source_get_texcoords(&sources[i], &vs_cb.inputs[i]);
+        input_cb.bounds[i].x = sources[i].rect.left;
+        input_cb.bounds[i].y = sources[i].rect.top;
+        input_cb.bounds[i].z = sources[i].rect.right;
+        input_cb.bounds[i].w = sources[i].rect.bottom;
+        views[i] = sources[i].bitmap->srv;
+    }
+    if (FAILED(hr = d2d_effect_renderer_update_buffer(ctx, ctx->renderer->vs_cb, &vs_cb, sizeof(vs_cb)))
+            || FAILED(hr = d2d_effect_renderer_update_buffer(ctx, ctx->renderer->input_cb,
+            &input_cb, sizeof(input_cb))))
+    {
+        d2d_effect_renderer_put_intermediate(ctx->context, intermediate);
+        return hr;
+    }
+
+    vp.TopLeftX = 0.0f;
+    vp.TopLeftY = 0.0f;
+    vp.Width = target->pixel_size.width;
+    vp.Height = target->pixel_size.height;
+    vp.MinDepth = 0.0f;
+    vp.MaxDepth = 1.0f;
+
+    /* Texels outside of the output rectangle may get sampled by filtering. */
+    ID3D11DeviceContext1_ClearRenderTargetView(ctx->d3d_context, target->rtv, clear_colour);
+    ID3D11DeviceContext1_OMSetRenderTargets(ctx->d3d_context, 1, &target->rtv, NULL);
+    ID3D11DeviceContext1_RSSetViewports(ctx->d3d_context, 1, &vp);
+    ID3D11DeviceContext1_VSSetConstantBuffers(ctx->d3d_context, 0, 1, &ctx->renderer->vs_cb);
+    ID3D11DeviceContext1_PSSetShader(ctx->d3d_context, ps, NULL, 0);
+    ID3D11DeviceContext1_PSSetConstantBuffers(ctx->d3d_context, 0, 1, &ps_cb);
+    ID3D11DeviceContext1_PSSetConstantBuffers(ctx->d3d_context, 1, 1, &ctx->renderer->input_cb);
+    ID3D11DeviceContext1_PSSetShaderResources(ctx->d3d_context, 0, source_count, views);
+    ID3D11DeviceContext1_PSSetSamplers(ctx->d3d_context, 0, source_count, samplers);
+
+    ID3D11DeviceContext1_Draw(ctx->d3d_context, 4, 0);
+
+    memset(views, 0, sizeof(views));
+    ID3D11DeviceContext1_PSSetShaderResources(ctx->d3d_context, 0, source_count, views);
+    ID3D11DeviceContext1_OMSetRenderTargets(ctx->d3d_context, 0, NULL, NULL);
+
+    output->bitmap = target;
+    output->intermediate = intermediate;
+    output->origin.x = rect->left;
+    output->origin.y = rect->top;
+    output->rect = *rect;
+
+    return S_OK;
+}
+
+/* Copy "source" to a new intermediate covering "rect", extending its edges
+ * if requested. */
+static HRESULT d2d_effect_renderer_copy(struct d2d_effect_render_context *ctx, const D2D1_RECT_L *rect,
+        const struct d2d_effect_source *source, enum d2d_effect_extend_mode mode_x,
+        enum d2d_effect_extend_mode mode_y, struct d2d_effect_source *output)
+{
+    ID3D11SamplerState *sampler = ctx->renderer->linear_sampler;
+    struct d2d_effect_copy_ps_cb ps_cb;
+    struct d2d_vec4 texcoords;
+    HRESULT hr;
+
+    d2d_effect_source_get_texcoords(source, &texcoords);
+    ps_cb.bounds.x = (source->rect.left - source->origin.x) * texcoords.z;
+    ps_cb.bounds.y = (source->rect.top - source->origin.y) * texcoords.w;
+    ps_cb.bounds.z = (source->rect.right - source->origin.x) * texcoords.z;
+    ps_cb.bounds.w = (source->rect.bottom - source->origin.y) * texcoords.w;
+    ps_cb.extend[0] = mode_x;
+    ps_cb.extend[1] = mode_y;
+    ps_cb.extend[2] = ps_cb.extend[3] = 0;
+    if (FAILED(hr = d2d_effect_renderer_update_buffer(ctx, ctx->renderer->ps_cb, &ps_cb, sizeof(ps_cb))))
+        return hr;
+
+    return d2d_effect_renderer_draw(ctx, rect, source, 1, ctx->copy_ps, ctx->renderer->ps_cb, &sampler, output);
+}
+
+static HRESULT d2d_effect_render_image(struct d2d_effect_render_context *ctx, ID2D1Image *image,
+        const D2D1_RECT_L *rect, struct d2d_effect_source *output);
+
+static HRESULT d2d_effect_render_node(struct d2d_effect_render_context *ctx, struct d2d_effect *effect,
+        struct d2d_transform_node *node, const D2D1_RECT_L *rect, struct d2d_effect_source *output);
+
+static HRESULT d2d_effect_render_node_input(struct d2d_effect_render_context *ctx, struct d2d_effect *effect,
+        struct d2d_transform_node *node, unsigned int index, const D2D1_RECT_L *rect,
+        struct d2d_effect_source *output)
+{
+    struct d2d_transform_graph *graph = effect->graph;
+    unsigned int i;
+
+    memset(output, 0, sizeof(*output));
+
+    if (node->inputs[index])
+        return d2d_effect_render_node(ctx, effect, node->inputs[index], rect, output);
+
+    for (i = 0; i < graph->input_count; ++i)
+    {
+        if (graph->inputs[i].node == node && graph->inputs[i].index == index)
+            return i < effect->input_count ? d2d_effect_render_image(ctx, effect->inputs[i], rect, output) : S_OK;
+    }
+
+    WARN("Input %u of node %p is not connected.\n", index, node);
+    return S_OK;
+}
+
+static HRESULT d2d_effect_render_draw_node(struct d2d_effect_render_context *ctx, struct d2d_transform_node *node,
+        const D2D1_RECT_L *rect, struct d2d_effect_source *sources, D2D1_RECT_L *input_rects,
+        struct d2d_effect_source *output)
+{
+    ID3D11SamplerState *samplers[D2D_EFFECT_MAX_INPUTS];
+    struct d2d_render_info *render_info = node->render_info;
+    D2D1_RECT_L opaque_rects[D2D_EFFECT_MAX_INPUTS];
+    ID3D11Device1 *d3d_device = ctx->context->d3d_device;
+    D2D1_RECT_L output_rect, opaque_rect;
+    ID3D11PixelShader *ps;
+    ID2D1Transform *transform;
+    unsigned int i;
+    HRESULT hr;
+
+    ID2D1TransformNode_QueryInterface(node->object, &IID_ID2D1Transform, (void **)&transform);
+    memset(opaque_rects, 0, sizeof(opaque_rects));
+    for (i = 0; i < node->input_count; ++i)
+        input_rects[i] = sources[i].bitmap ? sources[i].rect : d2d_empty_rect;
+    hr = ID2D1Transform_MapInputRectsToOutputRect(transform, input_rects, opaque_rects,
+            node->input_count, &output_rect, &opaque_rect);
+    ID2D1Transform_Release(transform);
+    if (FAILED(hr))
+    {
+        WARN("Failed to map input rectangles, hr %#lx.\n", hr);
+        return hr;
+    }
+
+    d2d_rect_l_intersect(&output_rect, rect);
+    if (d2d_rect_l_is_empty(&output_rect))
+        return S_OK;
+
+    if (!(render_info->mask & D2D_RENDER_INFO_PIXEL_SHADER))
+    {
+        FIXME("Node %p has no pixel shader.\n", node);
+        return S_OK;
+    }
+    if (!d2d_device_get_indexed_object(&ctx->context->device->shaders, &render_info->pixel_shader,
+            (IUnknown **)&ps))
+    {
+        WARN("Pixel shader %s is not loaded.\n", debugstr_guid(&render_info->pixel_shader));
+        return D2DERR_SHADER_COMPILE_FAILED;
+    }
+
+    if (render_info->ps_cb_dirty)
+    {
+        D3D11_SUBRESOURCE_DATA buffer_data;
+        D3D11_BUFFER_DESC buffer_desc;
+
+        if (render_info->ps_cb)
+            ID3D11Buffer_Release(render_info->ps_cb);
+        render_info->ps_cb = NULL;
+
+        buffer_desc.ByteWidth = render_info->ps_cb_size;
+        buffer_desc.Usage = D3D11_USAGE_IMMUTABLE;
+        buffer_desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+        buffer_desc.CPUAccessFlags = 0;
+        buffer_desc.MiscFlags = 0;
+        buffer_desc.StructureByteStride = 0;
+        buffer_data.pSysMem = render_info->ps_cb_data;
+        buffer_data.SysMemPitch = 0;
+        buffer_data.SysMemSlicePitch = 0;
+        if (FAILED(hr = ID3D11Device1_CreateBuffer(d3d_device, &buffer_desc, &buffer_data, &render_info->ps_cb)))
+            WARN("Failed to create constant buffer, hr %#lx.\n", hr);
+        render_info->ps_cb_dirty = false;
+    }
+
+    for (i = 0; i < node->input_count; ++i)
+    {
+        if (i < render_info->input_filter_count
+                && render_info->input_filters[i] == D2D1_FILTER_MIN_MAG_MIP_POINT)
+            samplers[i] = ctx->renderer->point_sampler;
+        else
+            samplers[i] = ctx->renderer->linear_sampler;
+    }
+
+    hr = d2d_effect_renderer_draw(ctx, &output_rect, sources, node->input_count, ps,
+            render_info->ps_cb, samplers, output);
+    ID3D11PixelShader_Release(ps);
+
+    return hr;
+}
+
+/* Blend states are created once per renderer for each blend description.
+ * The blend factor is set along with the state, and isn't part of it. */
+static HRESULT d2d_effect_renderer_get_blend_state(struct d2d_device_context *context,
+        const D2D1_BLEND_DESCRIPTION *desc, ID3D11BlendState **state)
+{
+    struct d2d_effect_renderer *renderer = &context->effect_renderer;
+    struct d2d_effect_blend_state *entry;
+    D3D11_BLEND_DESC blend_desc;
+    size_t i;
+    HRESULT hr;
+
+    /* D2D1_BLEND and D2D1_BLEND_OPERATION match their D3D11 counterparts. */
+    memset(&blend_desc, 0, sizeof(blend_desc));
+    blend_desc.RenderTarget[0].BlendEnable = TRUE;
+    blend_desc.RenderTarget[0].SrcBlend = desc->sourceBlend;
+    blend_desc.RenderTarget[0].DestBlend = desc->destinationBlend;
+    blend_desc.RenderTarget[0].BlendOp = desc->blendOperation;
+    blend_desc.RenderTarget[0].SrcBlendAlpha = desc->sourceBlendAlpha;
+    blend_desc.RenderTarget[0].DestBlendAlpha = desc->destinationBlendAlpha;
+    blend_desc.RenderTarget[0].BlendOpAlpha = desc->blendOperationAlpha;
+    blend_desc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+    for (i = 0; i < renderer->blend_state_count; ++i)
+    {
+        entry = &renderer->blend_states[i];
+        if (!memcmp(&entry->desc, &blend_desc.RenderTarget[0], sizeof(entry->desc)))
+        {
+            *state = entry->state;
+            return S_OK;
+        }
+    }
+
+    if (!d2d_array_reserve((void **)&renderer->blend_states, &renderer->blend_states_size,
+            renderer->blend_state_count + 1, sizeof(*renderer->blend_states)))
+        return E_OUTOFMEMORY;
+
+    if (FAILED(hr = ID3D11Device1_CreateBlendState(context->d3d_device, &blend_desc, state)))
+    {
+        WARN("Failed to create blend state, hr %#lx.\n", hr);
+        return hr;
+    }
+
+    entry = &renderer->blend_states[renderer->blend_state_count++];
+    memcpy(&entry->desc, &blend_desc.RenderTarget[0], sizeof(entry->desc));
+    entry->state = *state;
+    return S_OK;
+}
+
+static HRESULT d2d_effect_render_blend_node(struct d2d_effect_render_context *ctx, struct d2d_transform_node *node,
+        const D2D1_RECT_L *rect, struct d2d_effect_source *sources, struct d2d_effect_source *output)
+{
+    struct d2d_transform *transform = CONTAINING_RECORD(node->object, struct d2d_transform, ID2D1TransformNode_iface);
+    const D2D1_BLEND_DESCRIPTION *desc = &transform->blend_desc;
+    struct d2d_effect_source blended;
+    ID3D11BlendState *bs;
+    D2D1_RECT_L output_rect;
+    unsigned int i;
+    HRESULT hr;
+
+    output_rect = d2d_empty_rect;
+    for (i = 0; i < node->input_count; ++i)
+    {
+        if (sources[i].bitmap)
+            d2d_rect_l_union(&output_rect, &sources[i].rect);
+    }
+    d2d_rect_l_intersect(&output_rect, rect);
+    if (d2d_rect_l_is_empty(&output_rect))
+        return S_OK;
+
+    if (FAILED(hr = d2d_effect_renderer_get_blend_state(ctx->context, desc, &bs)))
+        return hr;
+
+    memset(&blended, 0, sizeof(blended));
+    for (i = 0; i < node->input_count && SUCCEEDED(hr); ++i)
+    {
+        if (!sources[i].bitmap)
+            continue;
+
+        if (!blended.bitmap)
+        {
+            /* The first input initializes the target, blended with transparent black. */
+            ID3D11DeviceContext1_OMSetBlendState(ctx->d3d_context, bs, desc->blendFactor, D3D11_DEFAULT_SAMPLE_MASK);
+            hr = d2d_effect_renderer_copy(ctx, &output_rect, &sources[i], D2D_EFFECT_EXTEND_MODE_NONE,
+                    D2D_EFFECT_EXTEND_MODE_NONE, &blended);
+            continue;
+        }
+
+        /* Draw on top of the previous result. */
+        ID3D11DeviceContext1_OMSetRenderTargets(ctx->d3d_context, 1, &blended.bitmap->rtv, NULL);
+        {
+            ID3D11SamplerState *sampler = ctx->renderer->linear_sampler;
+            ID3D11ShaderResourceView *view = sources[i].bitmap->srv, *null_view = NULL;
+            struct d2d_effect_copy_ps_cb ps_cb;
+            struct d2d_effect_vs_cb vs_cb;
+
+            memset(&vs_cb, 0, sizeof(vs_cb));
+            vs_cb.output_rect.x = output_rect.left;
+            vs_cb.output_rect.y = output_rect.top;
+            vs_cb.output_rect.z = output_rect.right;
+            vs_cb.output_rect.w = output_rect.bottom;
+            d2d_effect_source_get_texcoords(&blended, &vs_cb.target);
+            d2d_effect_source_get_texcoords(&sources[i], &vs_cb.inputs[0]);
+            memset(&ps_cb, 0, sizeof(ps_cb));
+            ps_cb.extend[0] = ps_cb.extend[1] = D2D_EFFECT_EXTEND_MODE_NONE;
+            if (FAILED(hr = d2d_effect_renderer_update_buffer(ctx, ctx->renderer->vs_cb, &vs_cb, sizeof(vs_cb)))
+                    || FAILED(hr = d2d_effect_renderer_update_buffer(ctx, ctx->renderer->ps_cb,
+                    &ps_cb, sizeof(ps_cb))))
+                break;
+
+            ID3D11DeviceContext1_PSSetShader(ctx->d3d_context, ctx->copy_ps, NULL, 0);
+            ID3D11DeviceContext1_PSSetConstantBuffers(ctx->d3d_context, 0, 1, &ctx->renderer->ps_cb);
+            ID3D11DeviceContext1_PSSetShaderResources(ctx->d3d_context, 0, 1, &view);
+            ID3D11DeviceContext1_PSSetSamplers(ctx->d3d_context, 0, 1, &sampler);
+            ID3D11DeviceContext1_Draw(ctx->d3d_context, 4, 0);
+            ID3D11DeviceContext1_PSSetShaderResources(ctx->d3d_context, 0, 1, &null_view);
+            ID3D11DeviceContext1_OMSetRenderTargets(ctx->d3d_context, 0, NULL, NULL);
+        }
+    }
+
+    ID3D11DeviceContext1_OMSetBlendState(ctx->d3d_context, NULL, NULL, D3D11_DEFAULT_SAMPLE_MASK);
+
+    if (FAILED(hr))
+    {
+        d2d_effect_source_release(ctx->context, &blended);
+        return hr;
+    }
+
+    *output = blended;
+    return S_OK;
+}
+
+static HRESULT d2d_effect_render_node(struct d2d_effect_render_context *ctx, struct d2d_effect *effect,
+        struct d2d_transform_node *node, const D2D1_RECT_L *rect, struct d2d_effect_source *output)
+{
+    struct d2d_effect_source sources[D2D_EFFECT_MAX_INPUTS];
+    D2D1_RECT_L input_rects[D2D_EFFECT_MAX_INPUTS];
+    struct d2d_transform *transform;
+    ID2D1Transform *draw_transform;
+    D2D1_RECT_L input_rect;
+    D2D1_POINT_2L offset;
+    HRESULT hr = S_OK;
+    unsigned int i;
+
+    memset(output, 0, sizeof(*output));
+
+    if (node->input_count > D2D_EFFECT_MAX_INPUTS)
+    {
+        FIXME("Unsupported input count %u.\n", node->input_count);
+        return E_NOTIMPL;
+    }
+
+    if (FAILED(hr = d2d_transform_node_initialize(node)))
+        return hr;
+
+    transform = CONTAINING_RECORD(node->object, struct d2d_transform, ID2D1TransformNode_iface);
+    memset(sources, 0, sizeof(sources));
+
+    switch (node->type)
+    {
+        case D2D_TRANSFORM_TYPE_DRAW:
+            ID2D1TransformNode_QueryInterface(node->object, &IID_ID2D1Transform, (void **)&draw_transform);
+            hr = ID2D1Transform_MapOutputRectToInputRects(draw_transform, rect, input_rects, node->input_count);
+            ID2D1Transform_Release(draw_transform);
+            if (FAILED(hr))
+            {
+                WARN("Failed to map output rectangle, hr %#lx.\n", hr);
+                return hr;
+            }
+            for (i = 0; i < node->input_count && SUCCEEDED(hr); ++i)
+                hr = d2d_effect_render_node_input(ctx, effect, node, i, &input_rects[i], &sources[i]);
+            if (SUCCEEDED(hr))
+                hr = d2d_effect_render_draw_node(ctx, node, rect, sources, input_rects, output);
+            break;
+
+        case D2D_TRANSFORM_TYPE_OFFSET:
+            /* Offsetting only moves the data of the input. */
+            offset = transform->offset;
+            input_rect = *rect;
+            offset.x = -offset.x;
+            offset.y = -offset.y;
+            d2d_rect_l_offset(&input_rect, &offset);
+            if (SUCCEEDED(hr = d2d_effect_render_node_input(ctx, effect, node, 0, &input_rect, output))
+                    && output->bitmap)
+            {
+                output->origin.x += transform->offset.x;
+                output->origin.y += transform->offset.y;
+                d2d_rect_l_offset(&output->rect, &transform->offset);
+            }
+            return hr;
+
+        case D2D_TRANSFORM_TYPE_BOUNDS_ADJUSTMENT:
+            input_rect = *rect;
+            d2d_rect_l_intersect(&input_rect, &transform->bounds);
+            if (FAILED(hr = d2d_effect_render_node_input(ctx, effect, node, 0, &input_rect, &sources[0]))
+                    || !sources[0].bitmap)
+                break;
+            input_rect = sources[0].rect;
+            d2d_rect_l_intersect(&input_rect, &transform->bounds);
+            if (!memcmp(&input_rect, &sources[0].rect, sizeof(input_rect)))
+            {
+                /* Nothing to cut off. */
+                *output = sources[0];
+                return S_OK;
+            }
+            if (!d2d_rect_l_is_empty(&input_rect))
+                hr = d2d_effect_renderer_copy(ctx, &input_rect, &sources[0], D2D_EFFECT_EXTEND_MODE_NONE,
+                        D2D_EFFECT_EXTEND_MODE_NONE, output);
+            break;
+
+        case D2D_TRANSFORM_TYPE_BORDER:
+            if (FAILED(hr = d2d_effect_render_node_input(ctx, effect, node, 0, rect, &sources[0]))
+                    || !sources[0].bitmap)
+                break;
+            hr = d2d_effect_renderer_copy(ctx, rect, &sources[0], transform->border.mode_x,
+                    transform->border.mode_y, output);
+            break;
+
+        case D2D_TRANSFORM_TYPE_BLEND:
+            for (i = 0; i < node->input_count && SUCCEEDED(hr); ++i)
+                hr = d2d_effect_render_node_input(ctx, effect, node, i, rect, &sources[i]);
+            if (SUCCEEDED(hr))
+                hr = d2d_effect_render_blend_node(ctx, node, rect, sources, output);
+            break;
+
+        default:
+            FIXME("Unhandled node type %#x.\n", node->type);
+            hr = E_NOTIMPL;
+            break;
+    }
+
+    for (i = 0; i < node->input_count; ++i)
+        d2d_effect_source_release(ctx->context, &sources[i]);
+
+    return hr;
+}
+
+static HRESULT d2d_effect_render_graph(struct d2d_effect_render_context *ctx, struct d2d_effect *effect,
+        const D2D1_RECT_L *rect, struct d2d_effect_source *output)
+{
+    struct d2d_transform_graph *graph;
+    HRESULT hr;
+
+    memset(output, 0, sizeof(*output));
+
+    if (ctx->depth >= D2D_EFFECT_MAX_DEPTH)
+    {
+        WARN("Effect graph is too deep.\n");
+        return D2DERR_CYCLIC_GRAPH;
+    }
+
+    if (effect->changes != D2D1_CHANGE_TYPE_NONE)
+    {
+        D2D1_CHANGE_TYPE changes = effect->changes;
+
+        effect->changes = D2D1_CHANGE_TYPE_NONE;
+        if (FAILED(hr = ID2D1EffectImpl_PrepareForRender(effect->impl, changes)))
+        {
+            WARN("Failed to prepare effect %p for rendering, hr %#lx.\n", effect, hr);
+            return hr;
+        }
+    }
+
+    graph = effect->graph;
+    if (graph->passthrough)
+        return graph->passthrough_input < effect->input_count
+                ? d2d_effect_render_image(ctx, effect->inputs[graph->passthrough_input], rect, output) : S_OK;
+
+    if (!graph->output)
+    {
+        FIXME("Effect %p has no output node.\n", effect);
+        return S_OK;
+    }
+
+    ++ctx->depth;
+    hr = d2d_effect_render_node(ctx, effect, graph->output, rect, output);
+    --ctx->depth;
+
+    return hr;
+}
+
+static HRESULT d2d_effect_render_image(struct d2d_effect_render_context *ctx, ID2D1Image *image,
+        const D2D1_RECT_L *rect, struct d2d_effect_source *output)
+{
+    struct d2d_effect *effect;
+    struct d2d_bitmap *bitmap;
+    ID2D1Bitmap *bitmap_iface;
+
+    memset(output, 0, sizeof(*output));
+
+    if (!image)
+        return S_OK;
+
+    if ((effect = d2d_effect_from_image(image)))
+        return d2d_effect_render_graph(ctx, effect, rect, output);
+
+    if (SUCCEEDED(ID2D1Image_QueryInterface(image, &IID_ID2D1Bitmap, (void **)&bitmap_iface)))
+    {
+        bitmap = unsafe_impl_from_ID2D1Bitmap(bitmap_iface);
+        if (!bitmap->srv)
+        {
+            WARN("Bitmap %p can't be used as an effect input.\n", bitmap);
+            ID2D1Bitmap_Release(bitmap_iface);
+            return D2DERR_BITMAP_CANNOT_DRAW;
+        }
+
+        output->bitmap = bitmap;
+        output->rect.right = bitmap->pixel_size.width;
+        output->rect.bottom = bitmap->pixel_size.height;
+        return S_OK;
+    }
+
+    FIXME("Unhandled image %p.\n", image);
+    return S_OK;
+}
+
+/* Render the part of "effect" within "rect". The result may cover less than
+ * the requested rectangle, or be empty. */
+HRESULT d2d_effect_render(struct d2d_device_context *context, struct d2d_effect *effect,
+        const D2D1_RECT_L *rect, struct d2d_effect_source *output)
+{
+    struct d2d_effect_render_context ctx;
+    ID3DDeviceContextState *prev_state;
+    HRESULT hr;
+
+    memset(output, 0, sizeof(*output));
+
+    if (rect->right - rect->left > D2D_EFFECT_MAX_INTERMEDIATE_SIZE
+            || rect->bottom - rect->top > D2D_EFFECT_MAX_INTERMEDIATE_SIZE)
+    {
+        FIXME("Rendering of %s is not supported.\n", debug_d2d_rect_l(rect));
+        return E_NOTIMPL;
+    }
+
+    if (context->cs)
+        EnterCriticalSection(context->cs);
+
+    if (FAILED(hr = d2d_effect_renderer_init(context)))
+        goto done;
+
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.context = context;
+    ctx.renderer = &context->effect_renderer;
+    d2d_device_get_indexed_object(&context->device->shaders, &d2d_effect_vs_id, (IUnknown **)&ctx.vs);
+    d2d_device_get_indexed_object(&context->device->shaders, &d2d_effect_copy_ps_id, (IUnknown **)&ctx.copy_ps);
+
+    ID3D11Device1_GetImmediateContext1(context->d3d_device, &ctx.d3d_context);
+    ID3D11DeviceContext1_SwapDeviceContextState(ctx.d3d_context, context->d3d_state, &prev_state);
+
+    ID3D11DeviceContext1_IASetInputLayout(ctx.d3d_context, NULL);
+    ID3D11DeviceContext1_IASetPrimitiveTopology(ctx.d3d_context, D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    ID3D11DeviceContext1_VSSetShader(ctx.d3d_context, ctx.vs, NULL, 0);
+    ID3D11DeviceContext1_RSSetState(ctx.d3d_context, context->rs);
+    ID3D11DeviceContext1_RSSetScissorRects(ctx.d3d_context, 0, NULL);
+    ID3D11DeviceContext1_OMSetBlendState(ctx.d3d_context, NULL, NULL, D3D11_DEFAULT_SAMPLE_MASK);
+
+    hr = d2d_effect_render_graph(&ctx, effect, rect, output);
+
+    ID3D11DeviceContext1_SwapDeviceContextState(ctx.d3d_context, prev_state, NULL);
+    ID3DDeviceContextState_Release(prev_state);
+    ID3D11DeviceContext1_Release(ctx.d3d_context);
+    ID3D11VertexShader_Release(ctx.vs);
+    ID3D11PixelShader_Release(ctx.copy_ps);
+
+    if (FAILED(hr))
+        d2d_effect_source_release(context, output);
+
+done:
+    if (context->cs)
+        LeaveCriticalSection(context->cs);
+
+    return hr;
+}
@@ -1371,6 +1371,8 @@ static void d2d_factory_init(struct d2d_factory *factory, D2D1_FACTORY_TYPE fact
     d2d_factory_reload_sysmetrics(factory);
     list_init(&factory->effects);
     InitializeCriticalSection(&factory->cs);
+    InitializeSRWLock(&factory->mesh_lock);
+    list_init(&factory->meshes);
     InitOnceInitialize(&factory->init_builtins);
 }
 
@@ -2716,8 +2716,29 @@ static BOOL d2d_geometry_fill_add_arc_triangle(struct d2d_geometry *geometry,
     return TRUE;
 }
 
+static void d2d_geometry_mesh_destroy(struct d2d_geometry_mesh *mesh)
+{
+    list_remove(&mesh->geometry_entry);
+    list_remove(&mesh->entry);
+    d2d_geometry_mesh_cleanup(mesh);
+    free(mesh);
+}
+
 static void d2d_geometry_cleanup(struct d2d_geometry *geometry)
 {
+    struct d2d_factory *factory = unsafe_impl_from_ID2D1Factory(geometry->factory);
+    struct d2d_geometry_mesh *mesh, *next;
+
+    if (!list_empty(&geometry->meshes))
+    {
+        AcquireSRWLockExclusive(&factory->mesh_lock);
+        LIST_FOR_EACH_ENTRY_SAFE(mesh, next, &geometry->meshes, struct d2d_geometry_mesh, geometry_entry)
+        {
+            d2d_geometry_mesh_destroy(mesh);
+        }
+        ReleaseSRWLockExclusive(&factory->mesh_lock);
+    }
+
     free(geometry->outline.arc_faces);
     free(geometry->outline.arcs);
     free(geometry->outline.bezier_faces);
@@ -2738,6 +2759,7 @@ static void d2d_geometry_init(struct d2d_geometry *geometry, ID2D1Factory *facto
     geometry->refcount = 1;
     ID2D1Factory_AddRef(geometry->factory = factory);
     geometry->transform = *transform;
+    list_init(&geometry->meshes);
 }
 
 static inline struct d2d_geometry *impl_from_ID2D1GeometrySink(ID2D1GeometrySink *iface)
@@ -5529,3 +5551,394 @@ struct d2d_geometry *unsafe_impl_from_ID2D1Geometry(ID2D1Geometry *iface)
             || iface->lpVtbl == (const ID2D1GeometryVtbl *)&d2d_geometry_group_vtbl);
     return CONTAINING_RECORD(iface, struct d2d_geometry, ID2D1Geometry_iface);
 }
+
+static HRESULT d2d_geometry_mesh_create_buffer(ID3D11Device1 *device, unsigned int bind_flags,
+        const void *data, size_t size, ID3D11Buffer **buffer)
+{
+    D3D11_SUBRESOURCE_DATA buffer_data;
+    D3D11_BUFFER_DESC buffer_desc;
+
+    buffer_desc.ByteWidth = size;
+    buffer_desc.Usage = D3D11_USAGE_IMMUTABLE;
+    buffer_desc.BindFlags = bind_flags;
+    buffer_desc.CPUAccessFlags = 0;
+    buffer_desc.MiscFlags = 0;
+    buffer_desc.StructureByteStride = 0;
+
+    buffer_data.pSysMem = data;
+    buffer_data.SysMemPitch = 0;
+    buffer_data.SysMemSlicePitch = 0;
+
+    return ID3D11Device1_CreateBuffer(device, &buffer_desc, &buffer_data, buffer);
+}
+
+static void d2d_geometry_mesh_release_buffer(ID3D11Buffer **buffer)
+{
+    if (!*buffer)
+        return;
+    ID3D11Buffer_Release(*buffer);
+    *buffer = NULL;
+}
+
+static void d2d_geometry_mesh_cleanup_fill(struct d2d_geometry_mesh *mesh)
+{
+    d2d_geometry_mesh_release_buffer(&mesh->fill.arc_vb);
+    d2d_geometry_mesh_release_buffer(&mesh->fill.bezier_vb);
+    d2d_geometry_mesh_release_buffer(&mesh->fill.vb);
+    d2d_geometry_mesh_release_buffer(&mesh->fill.ib);
+    mesh->fill.uploaded = FALSE;
+}
+
+static void d2d_geometry_mesh_cleanup_outline(struct d2d_geometry_mesh *mesh)
+{
+    d2d_geometry_mesh_release_buffer(&mesh->outline.arc_vb);
+    d2d_geometry_mesh_release_buffer(&mesh->outline.arc_ib);
+    d2d_geometry_mesh_release_buffer(&mesh->outline.bezier_vb);
+    d2d_geometry_mesh_release_buffer(&mesh->outline.bezier_ib);
+    d2d_geometry_mesh_release_buffer(&mesh->outline.vb);
+    d2d_geometry_mesh_release_buffer(&mesh->outline.ib);
+    mesh->outline.uploaded = FALSE;
+}
+
+void d2d_geometry_mesh_cleanup(struct d2d_geometry_mesh *mesh)
+{
+    d2d_geometry_mesh_cleanup_outline(mesh);
+    d2d_geometry_mesh_cleanup_fill(mesh);
+}
+
+HRESULT d2d_geometry_mesh_upload_fill(struct d2d_geometry_mesh *mesh,
+        const struct d2d_geometry *geometry, ID3D11Device1 *device)
+{
+    HRESULT hr;
+
+    if (geometry->fill.face_count)
+    {
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_INDEX_BUFFER, geometry->fill.faces,
+                geometry->fill.face_count * sizeof(*geometry->fill.faces), &mesh->fill.ib)))
+        {
+            WARN("Failed to create index buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_VERTEX_BUFFER, geometry->fill.vertices,
+                geometry->fill.vertex_count * sizeof(*geometry->fill.vertices), &mesh->fill.vb)))
+        {
+            ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+    }
+
+    if (geometry->fill.bezier_vertex_count)
+    {
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_VERTEX_BUFFER,
+                geometry->fill.bezier_vertices,
+                geometry->fill.bezier_vertex_count * sizeof(*geometry->fill.bezier_vertices),
+                &mesh->fill.bezier_vb)))
+        {
+            ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+    }
+
+    if (geometry->fill.arc_vertex_count)
+    {
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_VERTEX_BUFFER,
+                geometry->fill.arc_vertices,
+                geometry->fill.arc_vertex_count * sizeof(*geometry->fill.arc_vertices),
+                &mesh->fill.arc_vb)))
+        {
+            ERR("Failed to create arc vertex buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+    }
+
+    mesh->fill.uploaded = TRUE;
+
+    return S_OK;
+
+fail:
+    d2d_geometry_mesh_cleanup_fill(mesh);
+    return hr;
+}
+
+HRESULT d2d_geometry_mesh_upload_outline(struct d2d_geometry_mesh *mesh,
+        const struct d2d_geometry *geometry, ID3D11Device1 *device)
+{
+    HRESULT hr;
+
+    if (geometry->outline.face_count)
+    {
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_INDEX_BUFFER, geometry->outline.faces,
+                geometry->outline.face_count * sizeof(*geometry->outline.faces), &mesh->outline.ib)))
+        {
+            WARN("Failed to create index buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_VERTEX_BUFFER,
+                geometry->outline.vertices,
+                geometry->outline.vertex_count * sizeof(*geometry->outline.vertices), &mesh->outline.vb)))
+        {
+            ERR("Failed to create vertex buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+    }
+
+    if (geometry->outline.bezier_face_count)
+    {
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_INDEX_BUFFER,
+                geometry->outline.bezier_faces,
+                geometry->outline.bezier_face_count * sizeof(*geometry->outline.bezier_faces),
+                &mesh->outline.bezier_ib)))
+        {
+            WARN("Failed to create curves index buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_VERTEX_BUFFER,
+                geometry->outline.beziers,
+                geometry->outline.bezier_count * sizeof(*geometry->outline.beziers), &mesh->outline.bezier_vb)))
+        {
+            ERR("Failed to create curves vertex buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+    }
+
+    if (geometry->outline.arc_face_count)
+    {
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_INDEX_BUFFER,
+                geometry->outline.arc_faces,
+                geometry->outline.arc_face_count * sizeof(*geometry->outline.arc_faces), &mesh->outline.arc_ib)))
+        {
+            WARN("Failed to create arcs index buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+
+        if (FAILED(hr = d2d_geometry_mesh_create_buffer(device, D3D11_BIND_VERTEX_BUFFER,
+                geometry->outline.arcs,
+                geometry->outline.arc_count * sizeof(*geometry->outline.arcs), &mesh->outline.arc_vb)))
+        {
+            ERR("Failed to create arcs vertex buffer, hr %#lx.\n", hr);
+            goto fail;
+        }
+    }
+
+    mesh->outline.uploaded = TRUE;
+
+    return S_OK;
+
+fail:
+    d2d_geometry_mesh_cleanup_outline(mesh);
+    return hr;
+}
+
+/* Transformed geometries share the tessellation of their source geometry,
+ * so cached meshes are attached to the geometry that owns the data. */
+static struct d2d_geometry *d2d_geometry_get_mesh_owner(struct d2d_geometry *geometry)
+{
+    while (geometry->ID2D1Geometry_iface.lpVtbl == (ID2D1GeometryVtbl *)&d2d_transformed_geometry_vtbl)
+        geometry = unsafe_impl_from_ID2D1Geometry(geometry->u.transformed.src_geometry);
+
+    if (geometry->ID2D1Geometry_iface.lpVtbl == (ID2D1GeometryVtbl *)&d2d_path_geometry_vtbl
+            && geometry->u.path.state != D2D_GEOMETRY_STATE_CLOSED)
+        return NULL;
+
+    return geometry;
+}
+
+struct d2d_geometry_mesh *d2d_geometry_get_mesh(struct d2d_geometry *geometry,
+        const struct d2d_device *device, ID3D11Device1 *d3d_device, BOOL outline)
+{
+    struct d2d_geometry_mesh *mesh = NULL, *entry;
+    struct d2d_factory *factory;
+    HRESULT hr;
+
+    if (!(geometry = d2d_geometry_get_mesh_owner(geometry)))
+        return NULL;
+
+    /* Meshes are purged through the device's factory. */
+    if (geometry->factory != (ID2D1Factory *)device->factory)
+        return NULL;
+    factory = unsafe_impl_from_ID2D1Factory(geometry->factory);
+
+    AcquireSRWLockExclusive(&factory->mesh_lock);
+
+    LIST_FOR_EACH_ENTRY(entry, &geometry->meshes, struct d2d_geometry_mesh, geometry_entry)
+    {
+        if (entry->device == device)
+        {
+            mesh = entry;
+            break;
+        }
+    }
+
+    if (!mesh)
+    {
+        /* Geometries created by e.g. DrawRectangle() are only drawn once,
+         * don't bother caching anything until the second draw. */
+        if (++geometry->draw_count < 2 || !(mesh = calloc(1, sizeof(*mesh))))
+        {
+            ReleaseSRWLockExclusive(&factory->mesh_lock);
+            return NULL;
+        }
+
+        mesh->device = device;
+        list_add_head(&geometry->meshes, &mesh->geometry_entry);
+        list_add_head(&factory->meshes, &mesh->entry);
+    }
+
+    if (outline && !mesh->outline.uploaded)
+    {
+        if (FAILED(hr = d2d_geometry_mesh_upload_outline(mesh, geometry, d3d_device)))
+        {
+            WARN("Failed to upload outline mesh, hr %#lx.\n", hr);
+            mesh = NULL;
+        }
+    }
+    else if (!outline && !mesh->fill.uploaded)
+    {
+        if (FAILED(hr = d2d_geometry_mesh_upload_fill(mesh, geometry, d3d_device)))
+        {
+            WARN("Failed to upload fill mesh, hr %#lx.\n", hr);
+            mesh = NULL;
+        }
+    }
+
+    ReleaseSRWLockExclusive(&factory->mesh_lock);
+
+    return mesh;
+}
+
+void d2d_geometry_purge_meshes(ID2D1Factory *iface, const struct d2d_device *device)
+{
+    struct d2d_factory *factory = unsafe_impl_from_ID2D1Factory(iface);
+    struct d2d_geometry_mesh *mesh, *next;
+
+    AcquireSRWLockExclusive(&factory->mesh_lock);
+    LIST_FOR_EACH_ENTRY_SAFE(mesh, next, &factory->meshes, struct d2d_geometry_mesh, entry)
+    {
+        if (mesh->device == device)
+            d2d_geometry_mesh_destroy(mesh);
+    }
+    ReleaseSRWLockExclusive(&factory->mesh_lock);
+}
+
+static inline struct d2d_geometry_realization *impl_from_ID2D1GeometryRealization(ID2D1GeometryRealization *iface)
+{
+    return CONTAINING_RECORD(iface, struct d2d_geometry_realization, ID2D1GeometryRealization_iface);
+}
+
+static HRESULT STDMETHODCALLTYPE d2d_geometry_realization_QueryInterface(ID2D1GeometryRealization *iface,
+        REFIID iid, void **out)
+{
+    TRACE("iface %p, iid %s, out %p.\n", iface, debugstr_guid(iid), out);
+
+    if (IsEqualGUID(iid, &IID_ID2D1GeometryRealization)
+            || IsEqualGUID(iid, &IID_ID2D1Resource)
+            || IsEqualGUID(iid, &IID_IUnknown))
+    {
+        ID2D1GeometryRealization_AddRef(iface);
+        *out = iface;
+        return S_OK;
+    }
+
+    WARN("%s not implemented, returning E_NOINTERFACE.\n", debugstr_guid(iid));
+
+    *out = NULL;
+    return E_NOINTERFACE;
+}
+
+static ULONG STDMETHODCALLTYPE d2d_geometry_realization_AddRef(ID2D1GeometryRealization *iface)
+{
+    struct d2d_geometry_realization *realization = impl_from_ID2D1GeometryRealization(iface);
+    ULONG refcount = InterlockedIncrement(&realization->refcount);
+
+    TRACE("%p increasing refcount to %lu.\n", iface, refcount);
+
+    return refcount;
+}
+
+static ULONG STDMETHODCALLTYPE d2d_geometry_realization_Release(ID2D1GeometryRealization *iface)
+{
+    struct d2d_geometry_realization *realization = impl_from_ID2D1GeometryRealization(iface);
+    ULONG refcount = InterlockedDecrement(&realization->refcount);
+
+    TRACE("%p decreasing refcount to %lu.\n", iface, refcount);
+
+    if (!refcount)
+    {
+        d2d_geometry_mesh_cleanup(&realization->mesh);
+        if (realization->stroke_style)
+            ID2D1StrokeStyle_Release(realization->stroke_style);
+        ID2D1Geometry_Release(realization->geometry);
+        ID3D11Device1_Release(realization->device);
+        ID2D1Factory_Release(realization->factory);
+        free(realization);
+    }
+
+    return refcount;
+}
+
+static void STDMETHODCALLTYPE d2d_geometry_realization_GetFactory(ID2D1GeometryRealization *iface,
+        ID2D1Factory **factory)
+{
+    struct d2d_geometry_realization *realization = impl_from_ID2D1GeometryRealization(iface);
+
+    TRACE("iface %p, factory %p.\n", iface, factory);
+
+    ID2D1Factory_AddRef(*factory = realization->factory);
+}
+
+static const struct ID2D1GeometryRealizationVtbl d2d_geometry_realization_vtbl =
+{
+    d2d_geometry_realization_QueryInterface,
+    d2d_geometry_realization_AddRef,
+    d2d_geometry_realization_Release,
+    d2d_geometry_realization_GetFactory,
+};
+
+HRESULT d2d_geometry_realization_create(ID2D1Factory *factory, ID3D11Device1 *device,
+        ID2D1Geometry *geometry, BOOL stroked, float stroke_width, ID2D1StrokeStyle *stroke_style,
+        struct d2d_geometry_realization **realization)
+{
+    const struct d2d_geometry *geometry_impl = unsafe_impl_from_ID2D1Geometry(geometry);
+    struct d2d_geometry_realization *object;
+    HRESULT hr;
+
+    if (!(object = calloc(1, sizeof(*object))))
+        return E_OUTOFMEMORY;
+
+    if (stroked)
+        hr = d2d_geometry_mesh_upload_outline(&object->mesh, geometry_impl, device);
+    else
+        hr = d2d_geometry_mesh_upload_fill(&object->mesh, geometry_impl, device);
+    if (FAILED(hr))
+    {
+        WARN("Failed to upload geometry mesh, hr %#lx.\n", hr);
+        free(object);
+        return hr;
+    }
+
+    object->ID2D1GeometryRealization_iface.lpVtbl = &d2d_geometry_realization_vtbl;
+    object->refcount = 1;
+    ID2D1Factory_AddRef(object->factory = factory);
+    ID2D1Geometry_AddRef(object->geometry = geometry);
+    ID3D11Device1_AddRef(object->device = device);
+    object->stroked = stroked;
+    object->stroke_width = stroke_width;
+    if ((object->stroke_style = stroke_style))
+        ID2D1StrokeStyle_AddRef(stroke_style);
+
+    TRACE("Created geometry realization %p.\n", object);
+    *realization = object;
+
+    return S_OK;
+}
+
+struct d2d_geometry_realization *unsafe_impl_from_ID2D1GeometryRealization(ID2D1GeometryRealization *iface)
+{
+    if (!iface)
+        return NULL;
+    assert(iface->lpVtbl == &d2d_geometry_realization_vtbl);
+    return CONTAINING_RECORD(iface, struct d2d_geometry_realization, ID2D1GeometryRealization_iface);
+}
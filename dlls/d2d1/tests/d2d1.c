@@ -10767,6 +10767,102 @@ static DWORD WINAPI mt_factory_test_thread_draw_func(void *param)
     return 0;
 }
 
+static void test_geometry_realization(BOOL d3d11)
+{
+    ID2D1GeometryRealization *realization;
+    ID2D1RectangleGeometry *geometry;
+    ID2D1DeviceContext1 *context;
+    struct d2d1_test_context ctx;
+    struct resource_readback rb;
+    ID2D1SolidColorBrush *brush;
+    D2D1_MATRIX_3X2_F matrix;
+    unsigned int i;
+    D2D1_COLOR_F c;
+    D2D1_RECT_F r;
+    DWORD colour;
+    HRESULT hr;
+
+    if (!init_test_context(&ctx, d3d11))
+        return;
+
+    if (!ctx.context || FAILED(ID2D1DeviceContext_QueryInterface(ctx.context,
+            &IID_ID2D1DeviceContext1, (void **)&context)))
+    {
+        win_skip("ID2D1DeviceContext1 is not supported.\n");
+        release_test_context(&ctx);
+        return;
+    }
+
+    set_rect(&r, 10.0f, 10.0f, 50.0f, 50.0f);
+    hr = ID2D1Factory_CreateRectangleGeometry(ctx.factory, &r, &geometry);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    set_color(&c, 1.0f, 0.0f, 0.0f, 1.0f);
+    hr = ID2D1DeviceContext1_CreateSolidColorBrush(context, &c, NULL, &brush);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    hr = ID2D1DeviceContext1_CreateFilledGeometryRealization(context, (ID2D1Geometry *)geometry,
+            D2D1_DEFAULT_FLATTENING_TOLERANCE, &realization);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    /* The realization is drawn with the current transform. */
+    ID2D1DeviceContext1_BeginDraw(context);
+    ID2D1DeviceContext1_Clear(context, NULL);
+    set_matrix_identity(&matrix);
+    translate_matrix(&matrix, 100.0f, 0.0f);
+    ID2D1DeviceContext1_SetTransform(context, &matrix);
+    ID2D1DeviceContext1_DrawGeometryRealization(context, realization, (ID2D1Brush *)brush);
+    set_matrix_identity(&matrix);
+    ID2D1DeviceContext1_SetTransform(context, &matrix);
+    hr = ID2D1DeviceContext1_EndDraw(context, NULL, NULL);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    get_surface_readback(&ctx, &rb);
+    colour = get_readback_colour(&rb, 130, 30);
+    ok(compare_colour(colour, 0xffff0000, 0), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 30, 30);
+    ok(!colour, "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+    ID2D1GeometryRealization_Release(realization);
+
+    hr = ID2D1DeviceContext1_CreateStrokedGeometryRealization(context, (ID2D1Geometry *)geometry,
+            D2D1_DEFAULT_FLATTENING_TOLERANCE, 4.0f, NULL, &realization);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    ID2D1DeviceContext1_BeginDraw(context);
+    ID2D1DeviceContext1_Clear(context, NULL);
+    ID2D1DeviceContext1_DrawGeometryRealization(context, realization, (ID2D1Brush *)brush);
+    hr = ID2D1DeviceContext1_EndDraw(context, NULL, NULL);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    get_surface_readback(&ctx, &rb);
+    colour = get_readback_colour(&rb, 10, 30);
+    ok(compare_colour(colour, 0xffff0000, 0), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 30, 30);
+    ok(!colour, "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+    ID2D1GeometryRealization_Release(realization);
+
+    /* Repeated draws of the same geometry. */
+    for (i = 0; i < 3; ++i)
+    {
+        ID2D1DeviceContext1_BeginDraw(context);
+        ID2D1DeviceContext1_Clear(context, NULL);
+        ID2D1DeviceContext1_FillGeometry(context, (ID2D1Geometry *)geometry, (ID2D1Brush *)brush, NULL);
+        hr = ID2D1DeviceContext1_EndDraw(context, NULL, NULL);
+        ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+        get_surface_readback(&ctx, &rb);
+        colour = get_readback_colour(&rb, 30, 30);
+        ok(compare_colour(colour, 0xffff0000, 0), "Got unexpected colour %#lx, draw %u.\n", colour, i);
+        release_resource_readback(&rb);
+    }
+
+    ID2D1SolidColorBrush_Release(brush);
+    ID2D1RectangleGeometry_Release(geometry);
+    ID2D1DeviceContext1_Release(context);
+    release_test_context(&ctx);
+}
+
 static void test_mt_factory(BOOL d3d11)
 {
     struct d2d1_test_context ctx;
@@ -10981,6 +11077,10 @@ static void test_builtin_effect(BOOL d3d11)
         {&CLSID_D2D1Composite,               1, 2, 1, 0xffffffff},
         {&CLSID_D2D1Crop,                    1, 1, 1, 1},
         {&CLSID_D2D1Shadow,                  1, 1, 1, 1},
+        {&CLSID_D2D1GaussianBlur,            1, 1, 1, 1},
+        {&CLSID_D2D1DirectionalBlur,         1, 1, 1, 1},
+        {&CLSID_D2D1ColorMatrix,             1, 1, 1, 1},
+        {&CLSID_D2D1Morphology,              1, 1, 1, 1},
         {&CLSID_D2D1Grayscale,               3, 1, 1, 1},
     };
 
@@ -12709,6 +12809,588 @@ static void test_effect_grayscale(BOOL d3d11)
     release_test_context(&ctx);
 }
 
+static void test_effect_color_matrix(BOOL d3d11)
+{
+    D2D1_BITMAP_PROPERTIES1 bitmap_desc;
+    struct d2d1_test_context ctx;
+    struct resource_readback rb;
+    ID2D1DeviceContext *context;
+    D2D_MATRIX_5X4_F matrix;
+    D2D1_SIZE_U input_size;
+    DWORD colour, pixel;
+    ID2D1Bitmap1 *bitmap;
+    ID2D1Effect *effect;
+    ID2D1Image *output;
+    unsigned int count;
+    UINT32 mode;
+    BOOL clamp;
+    HRESULT hr;
+
+    if (!init_test_context(&ctx, d3d11))
+        return;
+
+    if (!ctx.factory1)
+    {
+        win_skip("ID2D1Factory1 is not supported.\n");
+        release_test_context(&ctx);
+        return;
+    }
+
+    context = ctx.context;
+
+    hr = ID2D1DeviceContext_CreateEffect(context, &CLSID_D2D1ColorMatrix, &effect);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    check_system_properties(effect);
+
+    count = ID2D1Effect_GetPropertyCount(effect);
+    ok(count == 3, "Got unexpected property count %u.\n", count);
+
+    hr = ID2D1Effect_GetValue(effect, D2D1_COLORMATRIX_PROP_COLOR_MATRIX, D2D1_PROPERTY_TYPE_MATRIX_5X4,
+            (BYTE *)&matrix, sizeof(matrix));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ok(matrix._11 == 1.0f && matrix._22 == 1.0f && matrix._33 == 1.0f && matrix._44 == 1.0f
+            && !matrix._12 && !matrix._51, "Got unexpected matrix.\n");
+    hr = ID2D1Effect_GetValue(effect, D2D1_COLORMATRIX_PROP_ALPHA_MODE, D2D1_PROPERTY_TYPE_ENUM,
+            (BYTE *)&mode, sizeof(mode));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ok(mode == D2D1_COLORMATRIX_ALPHA_MODE_PREMULTIPLIED, "Got unexpected alpha mode %u.\n", mode);
+    hr = ID2D1Effect_GetValue(effect, D2D1_COLORMATRIX_PROP_CLAMP_OUTPUT, D2D1_PROPERTY_TYPE_BOOL,
+            (BYTE *)&clamp, sizeof(clamp));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ok(!clamp, "Got unexpected clamp output %d.\n", clamp);
+
+    /* Swap the red and blue channels. */
+    memset(&matrix, 0, sizeof(matrix));
+    matrix._13 = matrix._22 = matrix._31 = matrix._44 = 1.0f;
+    hr = ID2D1Effect_SetValue(effect, D2D1_COLORMATRIX_PROP_COLOR_MATRIX, D2D1_PROPERTY_TYPE_MATRIX_5X4,
+            (BYTE *)&matrix, sizeof(matrix));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    pixel = 0xff102030;
+    set_size_u(&input_size, 1, 1);
+    bitmap_desc.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    bitmap_desc.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
+    bitmap_desc.dpiX = 96.0f;
+    bitmap_desc.dpiY = 96.0f;
+    bitmap_desc.bitmapOptions = D2D1_BITMAP_OPTIONS_NONE;
+    bitmap_desc.colorContext = NULL;
+    hr = ID2D1DeviceContext_CreateBitmap(context, input_size, &pixel, sizeof(pixel), &bitmap_desc, &bitmap);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    ID2D1Effect_SetInput(effect, 0, (ID2D1Image *)bitmap, FALSE);
+    ID2D1Effect_GetOutput(effect, &output);
+
+    ID2D1DeviceContext_BeginDraw(context);
+    ID2D1DeviceContext_Clear(context, 0);
+    ID2D1DeviceContext_DrawImage(context, output, NULL, NULL, 0, 0);
+    hr = ID2D1DeviceContext_EndDraw(context, NULL, NULL);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    get_surface_readback(&ctx, &rb);
+    colour = get_readback_colour(&rb, 0, 0);
+    ok(compare_colour(colour, 0xff302010, 1), "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+
+    ID2D1Image_Release(output);
+    ID2D1Bitmap1_Release(bitmap);
+    ID2D1Effect_Release(effect);
+    release_test_context(&ctx);
+}
+
+static void test_effect_draw_image_dpi(BOOL d3d11)
+{
+    static const struct
+    {
+        float dpi;
+        unsigned int x, y;
+    }
+    tests[] =
+    {
+        {48.0f, 5, 3},
+        {96.0f, 10, 5},
+        {192.0f, 20, 10},
+    };
+    D2D1_BITMAP_PROPERTIES1 bitmap_desc;
+    ID2D1CommandList *command_list;
+    struct d2d1_test_context ctx;
+    struct resource_readback rb;
+    ID2D1DeviceContext *context;
+    D2D_MATRIX_5X4_F matrix;
+    D2D1_MATRIX_3X2_F transform;
+    ULONG refcount, refcount2;
+    D2D1_SIZE_U input_size;
+    ID2D1Image *output, *target;
+    ID2D1Bitmap1 *bitmap;
+    ID2D1Effect *effect;
+    unsigned int i;
+    DWORD *pixels;
+    DWORD colour;
+    HRESULT hr;
+
+    if (!init_test_context(&ctx, d3d11))
+        return;
+
+    if (!ctx.factory1)
+    {
+        win_skip("ID2D1Factory1 is not supported.\n");
+        release_test_context(&ctx);
+        return;
+    }
+
+    context = ctx.context;
+
+    hr = ID2D1DeviceContext_CreateEffect(context, &CLSID_D2D1ColorMatrix, &effect);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    /* Swap the red and blue channels. */
+    memset(&matrix, 0, sizeof(matrix));
+    matrix._13 = matrix._22 = matrix._31 = matrix._44 = 1.0f;
+    hr = ID2D1Effect_SetValue(effect, D2D1_COLORMATRIX_PROP_COLOR_MATRIX, D2D1_PROPERTY_TYPE_MATRIX_5X4,
+            (BYTE *)&matrix, sizeof(matrix));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    /* Large enough to cover the target at any of the tested DPIs. */
+    set_size_u(&input_size, 1280, 960);
+    pixels = malloc(input_size.width * input_size.height * sizeof(*pixels));
+    for (i = 0; i < input_size.width * input_size.height; ++i)
+        pixels[i] = 0xff102030;
+    bitmap_desc.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    bitmap_desc.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
+    bitmap_desc.dpiX = 96.0f;
+    bitmap_desc.dpiY = 96.0f;
+    bitmap_desc.bitmapOptions = D2D1_BITMAP_OPTIONS_NONE;
+    bitmap_desc.colorContext = NULL;
+    hr = ID2D1DeviceContext_CreateBitmap(context, input_size, pixels, input_size.width * sizeof(*pixels),
+            &bitmap_desc, &bitmap);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    free(pixels);
+
+    ID2D1Effect_SetInput(effect, 0, (ID2D1Image *)bitmap, FALSE);
+    ID2D1Effect_GetOutput(effect, &output);
+
+    /* The translation is in DIPs, and the visible part of the image has to be
+     * mapped back through both the transform and the DPI scale. */
+    for (i = 0; i < ARRAY_SIZE(tests); ++i)
+    {
+        winetest_push_context("Test %u", i);
+
+        ID2D1DeviceContext_SetDpi(context, tests[i].dpi, tests[i].dpi);
+        set_matrix_identity(&transform);
+        translate_matrix(&transform, 10.0f, 5.0f);
+
+        ID2D1DeviceContext_BeginDraw(context);
+        ID2D1DeviceContext_Clear(context, 0);
+        ID2D1DeviceContext_SetTransform(context, &transform);
+        ID2D1DeviceContext_DrawImage(context, output, NULL, NULL, 0, 0);
+        hr = ID2D1DeviceContext_EndDraw(context, NULL, NULL);
+        ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+        get_surface_readback(&ctx, &rb);
+        colour = get_readback_colour(&rb, tests[i].x - 1, tests[i].y);
+        ok(!colour, "Got unexpected colour %#lx.\n", colour);
+        colour = get_readback_colour(&rb, tests[i].x, tests[i].y);
+        ok(compare_colour(colour, 0xff302010, 1), "Got unexpected colour %#lx.\n", colour);
+        colour = get_readback_colour(&rb, 639, 479);
+        ok(compare_colour(colour, 0xff302010, 1), "Got unexpected colour %#lx.\n", colour);
+        release_resource_readback(&rb);
+
+        winetest_pop_context();
+    }
+
+    set_matrix_identity(&transform);
+    ID2D1DeviceContext_SetTransform(context, &transform);
+    ID2D1DeviceContext_SetDpi(context, 96.0f, 96.0f);
+
+    /* Effect output drawn to a command list is recorded, not rendered. */
+    hr = ID2D1DeviceContext_CreateCommandList(context, &command_list);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ID2D1DeviceContext_GetTarget(context, &target);
+    ID2D1DeviceContext_SetTarget(context, (ID2D1Image *)command_list);
+
+    ID2D1Image_AddRef(output);
+    refcount = ID2D1Image_Release(output);
+    ID2D1DeviceContext_BeginDraw(context);
+    ID2D1DeviceContext_DrawImage(context, output, NULL, NULL, 0, 0);
+    hr = ID2D1DeviceContext_EndDraw(context, NULL, NULL);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ID2D1Image_AddRef(output);
+    refcount2 = ID2D1Image_Release(output);
+    ok(refcount2 == refcount + 1, "Got unexpected refcount %lu, expected %lu.\n", refcount2, refcount + 1);
+
+    hr = ID2D1CommandList_Close(command_list);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ID2D1DeviceContext_SetTarget(context, target);
+    ID2D1Image_Release(target);
+    ID2D1CommandList_Release(command_list);
+
+    ID2D1Image_Release(output);
+    ID2D1Bitmap1_Release(bitmap);
+    ID2D1Effect_Release(effect);
+    release_test_context(&ctx);
+}
+
+static ID2D1Bitmap1 *create_square_bitmap(ID2D1DeviceContext *context, unsigned int size)
+{
+    D2D1_BITMAP_PROPERTIES1 bitmap_desc;
+    D2D1_SIZE_U bitmap_size;
+    ID2D1Bitmap1 *bitmap;
+    unsigned int i;
+    DWORD *pixels;
+    HRESULT hr;
+
+    set_size_u(&bitmap_size, size, size);
+    pixels = malloc(size * size * sizeof(*pixels));
+    for (i = 0; i < size * size; ++i)
+        pixels[i] = 0xffffffff;
+    bitmap_desc.pixelFormat.format = DXGI_FORMAT_B8G8R8A8_UNORM;
+    bitmap_desc.pixelFormat.alphaMode = D2D1_ALPHA_MODE_PREMULTIPLIED;
+    bitmap_desc.dpiX = 96.0f;
+    bitmap_desc.dpiY = 96.0f;
+    bitmap_desc.bitmapOptions = D2D1_BITMAP_OPTIONS_NONE;
+    bitmap_desc.colorContext = NULL;
+    hr = ID2D1DeviceContext_CreateBitmap(context, bitmap_size, pixels, size * sizeof(*pixels),
+            &bitmap_desc, &bitmap);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    free(pixels);
+
+    return bitmap;
+}
+
+/* The effect input is placed at (100, 100). */
+static void draw_effect_output(struct d2d1_test_context *ctx, ID2D1Effect *effect, struct resource_readback *rb)
+{
+    ID2D1DeviceContext *context = ctx->context;
+    D2D1_POINT_2F offset = {100.0f, 100.0f};
+    ID2D1Image *output;
+    HRESULT hr;
+
+    ID2D1Effect_GetOutput(effect, &output);
+    ID2D1DeviceContext_BeginDraw(context);
+    ID2D1DeviceContext_Clear(context, 0);
+    ID2D1DeviceContext_DrawImage(context, output, &offset, NULL, 0, 0);
+    hr = ID2D1DeviceContext_EndDraw(context, NULL, NULL);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ID2D1Image_Release(output);
+
+    get_surface_readback(ctx, rb);
+}
+
+/* Partially covered pixel of an opaque colour, premultiplied. */
+static BOOL compare_partial_colour(DWORD colour, DWORD opaque, BYTE min_alpha, BYTE max_alpha)
+{
+    unsigned int alpha = colour >> 24, i;
+    DWORD expected = 0;
+
+    if (alpha < min_alpha || alpha > max_alpha)
+        return FALSE;
+    for (i = 0; i < 24; i += 8)
+        expected |= (((opaque >> i) & 0xff) * alpha / 255) << i;
+    return compare_colour(colour, expected | (alpha << 24), 2);
+}
+
+static void test_effect_gaussian_blur(BOOL d3d11)
+{
+    struct d2d1_test_context ctx;
+    struct resource_readback rb;
+    ID2D1DeviceContext *context;
+    ID2D1Bitmap1 *bitmap;
+    ID2D1Effect *effect;
+    float sigma;
+    DWORD colour;
+    UINT32 mode;
+    HRESULT hr;
+
+    if (!init_test_context(&ctx, d3d11))
+        return;
+
+    if (!ctx.factory1)
+    {
+        win_skip("ID2D1Factory1 is not supported.\n");
+        release_test_context(&ctx);
+        return;
+    }
+
+    context = ctx.context;
+
+    hr = ID2D1DeviceContext_CreateEffect(context, &CLSID_D2D1GaussianBlur, &effect);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    hr = ID2D1Effect_GetValue(effect, D2D1_GAUSSIANBLUR_PROP_STANDARD_DEVIATION, D2D1_PROPERTY_TYPE_FLOAT,
+            (BYTE *)&sigma, sizeof(sigma));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ok(sigma == 3.0f, "Got unexpected standard deviation %.8e.\n", sigma);
+    hr = ID2D1Effect_GetValue(effect, D2D1_GAUSSIANBLUR_PROP_BORDER_MODE, D2D1_PROPERTY_TYPE_ENUM,
+            (BYTE *)&mode, sizeof(mode));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ok(mode == D2D1_BORDER_MODE_SOFT, "Got unexpected border mode %u.\n", mode);
+
+    bitmap = create_square_bitmap(context, 64);
+    ID2D1Effect_SetInput(effect, 0, (ID2D1Image *)bitmap, FALSE);
+
+    /* Soft border, the output is larger than the input. */
+    draw_effect_output(&ctx, effect, &rb);
+    colour = get_readback_colour(&rb, 132, 132);
+    ok(compare_colour(colour, 0xffffffff, 2), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 100, 132);
+    ok(compare_partial_colour(colour, 0xffffffff, 0x70, 0xb0), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 98, 132);
+    ok(compare_partial_colour(colour, 0xffffffff, 0x30, 0x70), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 132, 98);
+    ok(compare_partial_colour(colour, 0xffffffff, 0x30, 0x70), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 80, 132);
+    ok(!colour, "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+
+    /* Hard border, edges are extended and the output is clipped to the input. */
+    mode = D2D1_BORDER_MODE_HARD;
+    hr = ID2D1Effect_SetValue(effect, D2D1_GAUSSIANBLUR_PROP_BORDER_MODE, D2D1_PROPERTY_TYPE_ENUM,
+            (BYTE *)&mode, sizeof(mode));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    draw_effect_output(&ctx, effect, &rb);
+    colour = get_readback_colour(&rb, 100, 132);
+    ok(compare_colour(colour, 0xffffffff, 2), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 163, 163);
+    ok(compare_colour(colour, 0xffffffff, 2), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 99, 132);
+    ok(!colour, "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+
+    ID2D1Bitmap1_Release(bitmap);
+
+    /* Large deviation. */
+    mode = D2D1_BORDER_MODE_SOFT;
+    hr = ID2D1Effect_SetValue(effect, D2D1_GAUSSIANBLUR_PROP_BORDER_MODE, D2D1_PROPERTY_TYPE_ENUM,
+            (BYTE *)&mode, sizeof(mode));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    sigma = 20.0f;
+    hr = ID2D1Effect_SetValue(effect, D2D1_GAUSSIANBLUR_PROP_STANDARD_DEVIATION, D2D1_PROPERTY_TYPE_FLOAT,
+            (BYTE *)&sigma, sizeof(sigma));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    bitmap = create_square_bitmap(context, 256);
+    ID2D1Effect_SetInput(effect, 0, (ID2D1Image *)bitmap, FALSE);
+
+    draw_effect_output(&ctx, effect, &rb);
+    colour = get_readback_colour(&rb, 228, 228);
+    ok(compare_colour(colour, 0xffffffff, 2), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 100, 228);
+    ok(compare_partial_colour(colour, 0xffffffff, 0x60, 0xa0), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 80, 228);
+    ok(compare_partial_colour(colour, 0xffffffff, 0x18, 0x48), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 20, 228);
+    ok(compare_colour(colour, 0, 2), "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+
+    ID2D1Bitmap1_Release(bitmap);
+    ID2D1Effect_Release(effect);
+    release_test_context(&ctx);
+}
+
+static void test_effect_directional_blur(BOOL d3d11)
+{
+    struct d2d1_test_context ctx;
+    struct resource_readback rb;
+    ID2D1DeviceContext *context;
+    ID2D1Bitmap1 *bitmap;
+    ID2D1Effect *effect;
+    DWORD colour;
+    float angle;
+    HRESULT hr;
+
+    if (!init_test_context(&ctx, d3d11))
+        return;
+
+    if (!ctx.factory1)
+    {
+        win_skip("ID2D1Factory1 is not supported.\n");
+        release_test_context(&ctx);
+        return;
+    }
+
+    context = ctx.context;
+
+    hr = ID2D1DeviceContext_CreateEffect(context, &CLSID_D2D1DirectionalBlur, &effect);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    hr = ID2D1Effect_GetValue(effect, D2D1_DIRECTIONALBLUR_PROP_ANGLE, D2D1_PROPERTY_TYPE_FLOAT,
+            (BYTE *)&angle, sizeof(angle));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ok(angle == 0.0f, "Got unexpected angle %.8e.\n", angle);
+
+    bitmap = create_square_bitmap(context, 64);
+    ID2D1Effect_SetInput(effect, 0, (ID2D1Image *)bitmap, FALSE);
+
+    /* Horizontal. */
+    draw_effect_output(&ctx, effect, &rb);
+    colour = get_readback_colour(&rb, 132, 132);
+    ok(compare_colour(colour, 0xffffffff, 2), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 98, 132);
+    ok(compare_partial_colour(colour, 0xffffffff, 0x30, 0x70), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 132, 100);
+    ok(compare_colour(colour, 0xffffffff, 2), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 132, 98);
+    ok(!colour, "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+
+    /* Vertical. */
+    angle = 90.0f;
+    hr = ID2D1Effect_SetValue(effect, D2D1_DIRECTIONALBLUR_PROP_ANGLE, D2D1_PROPERTY_TYPE_FLOAT,
+            (BYTE *)&angle, sizeof(angle));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    draw_effect_output(&ctx, effect, &rb);
+    colour = get_readback_colour(&rb, 132, 98);
+    ok(compare_partial_colour(colour, 0xffffffff, 0x30, 0x70), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 100, 132);
+    ok(compare_colour(colour, 0xffffffff, 2), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 98, 132);
+    ok(!colour, "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+
+    ID2D1Bitmap1_Release(bitmap);
+    ID2D1Effect_Release(effect);
+    release_test_context(&ctx);
+}
+
+static void test_effect_shadow(BOOL d3d11)
+{
+    static const D2D_VECTOR_4F blue = {0.0f, 0.0f, 1.0f, 1.0f};
+    struct d2d1_test_context ctx;
+    struct resource_readback rb;
+    ID2D1DeviceContext *context;
+    ID2D1Bitmap1 *bitmap;
+    ID2D1Effect *effect;
+    D2D_VECTOR_4F color;
+    DWORD colour;
+    HRESULT hr;
+
+    if (!init_test_context(&ctx, d3d11))
+        return;
+
+    if (!ctx.factory1)
+    {
+        win_skip("ID2D1Factory1 is not supported.\n");
+        release_test_context(&ctx);
+        return;
+    }
+
+    context = ctx.context;
+
+    hr = ID2D1DeviceContext_CreateEffect(context, &CLSID_D2D1Shadow, &effect);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    hr = ID2D1Effect_GetValue(effect, D2D1_SHADOW_PROP_COLOR, D2D1_PROPERTY_TYPE_VECTOR4,
+            (BYTE *)&color, sizeof(color));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    ok(!color.x && !color.y && !color.z && color.w == 1.0f, "Got unexpected colour {%.8e, %.8e, %.8e, %.8e}.\n",
+            color.x, color.y, color.z, color.w);
+
+    bitmap = create_square_bitmap(context, 64);
+    ID2D1Effect_SetInput(effect, 0, (ID2D1Image *)bitmap, FALSE);
+
+    /* The input alpha, blurred and filled with the shadow colour. */
+    draw_effect_output(&ctx, effect, &rb);
+    colour = get_readback_colour(&rb, 132, 132);
+    ok(compare_colour(colour, 0xff000000, 2), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 98, 132);
+    ok(compare_partial_colour(colour, 0xff000000, 0x30, 0x70), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 80, 132);
+    ok(!colour, "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+
+    hr = ID2D1Effect_SetValue(effect, D2D1_SHADOW_PROP_COLOR, D2D1_PROPERTY_TYPE_VECTOR4,
+            (const BYTE *)&blue, sizeof(blue));
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+    draw_effect_output(&ctx, effect, &rb);
+    colour = get_readback_colour(&rb, 132, 132);
+    ok(compare_colour(colour, 0xff0000ff, 2), "Got unexpected colour %#lx.\n", colour);
+    colour = get_readback_colour(&rb, 132, 98);
+    ok(compare_partial_colour(colour, 0xff0000ff, 0x30, 0x70), "Got unexpected colour %#lx.\n", colour);
+    release_resource_readback(&rb);
+
+    ID2D1Bitmap1_Release(bitmap);
+    ID2D1Effect_Release(effect);
+    release_test_context(&ctx);
+}
+
+static void test_effect_morphology(BOOL d3d11)
+{
+    static const struct
+    {
+        UINT32 mode, width, height;
+        struct
+        {
+            unsigned int x, y;
+            DWORD colour;
+        }
+        pixels[4];
+    }
+    tests[] =
+    {
+        {D2D1_MORPHOLOGY_MODE_ERODE, 1, 1, {{100, 100, 0xffffffff}, {99, 100, 0}, {131, 131, 0xffffffff}, {132, 131, 0}}},
+        {D2D1_MORPHOLOGY_MODE_ERODE, 5, 1, {{101, 116, 0}, {102, 116, 0xffffffff}, {129, 116, 0xffffffff}, {116, 100, 0xffffffff}}},
+        {D2D1_MORPHOLOGY_MODE_ERODE, 5, 5, {{116, 101, 0}, {116, 102, 0xffffffff}, {116, 129, 0xffffffff}, {116, 130, 0}}},
+        {D2D1_MORPHOLOGY_MODE_DILATE, 5, 1, {{98, 116, 0xffffffff}, {97, 116, 0}, {133, 116, 0xffffffff}, {116, 99, 0}}},
+        {D2D1_MORPHOLOGY_MODE_DILATE, 1, 3, {{116, 99, 0xffffffff}, {116, 98, 0}, {116, 132, 0xffffffff}, {99, 116, 0}}},
+    };
+    struct d2d1_test_context ctx;
+    struct resource_readback rb;
+    ID2D1DeviceContext *context;
+    ID2D1Bitmap1 *bitmap;
+    ID2D1Effect *effect;
+    unsigned int i, j;
+    DWORD colour;
+    HRESULT hr;
+
+    if (!init_test_context(&ctx, d3d11))
+        return;
+
+    if (!ctx.factory1)
+    {
+        win_skip("ID2D1Factory1 is not supported.\n");
+        release_test_context(&ctx);
+        return;
+    }
+
+    context = ctx.context;
+
+    hr = ID2D1DeviceContext_CreateEffect(context, &CLSID_D2D1Morphology, &effect);
+    ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+    bitmap = create_square_bitmap(context, 32);
+    ID2D1Effect_SetInput(effect, 0, (ID2D1Image *)bitmap, FALSE);
+
+    for (i = 0; i < ARRAY_SIZE(tests); ++i)
+    {
+        winetest_push_context("Test %u", i);
+
+        hr = ID2D1Effect_SetValue(effect, D2D1_MORPHOLOGY_PROP_MODE, D2D1_PROPERTY_TYPE_ENUM,
+                (const BYTE *)&tests[i].mode, sizeof(tests[i].mode));
+        ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+        hr = ID2D1Effect_SetValue(effect, D2D1_MORPHOLOGY_PROP_WIDTH, D2D1_PROPERTY_TYPE_UINT32,
+                (const BYTE *)&tests[i].width, sizeof(tests[i].width));
+        ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+        hr = ID2D1Effect_SetValue(effect, D2D1_MORPHOLOGY_PROP_HEIGHT, D2D1_PROPERTY_TYPE_UINT32,
+                (const BYTE *)&tests[i].height, sizeof(tests[i].height));
+        ok(hr == S_OK, "Got unexpected hr %#lx.\n", hr);
+
+        draw_effect_output(&ctx, effect, &rb);
+        for (j = 0; j < ARRAY_SIZE(tests[i].pixels); ++j)
+        {
+            colour = get_readback_colour(&rb, tests[i].pixels[j].x, tests[i].pixels[j].y);
+            ok(compare_colour(colour, tests[i].pixels[j].colour, 1), "Got unexpected colour %#lx at (%u, %u).\n",
+                    colour, tests[i].pixels[j].x, tests[i].pixels[j].y);
+        }
+        release_resource_readback(&rb);
+
+        winetest_pop_context();
+    }
+
+    ID2D1Bitmap1_Release(bitmap);
+    ID2D1Effect_Release(effect);
+    release_test_context(&ctx);
+}
+
 static void test_registered_effects(BOOL d3d11)
 {
     UINT32 ret, count, count2, count3;
@@ -15175,6 +15857,7 @@ START_TEST(d2d1)
     queue_d3d10_test(test_math);
     queue_d3d10_test(test_colour_space);
     queue_test(test_geometry_group);
+    queue_test(test_geometry_realization);
     queue_test(test_mt_factory);
     queue_test(test_effect_register);
     queue_test(test_effect_context);
@@ -15183,6 +15866,12 @@ START_TEST(d2d1)
     queue_test(test_effect_2d_affine);
     queue_test(test_effect_crop);
     queue_test(test_effect_grayscale);
+    queue_test(test_effect_color_matrix);
+    queue_test(test_effect_draw_image_dpi);
+    queue_test(test_effect_gaussian_blur);
+    queue_test(test_effect_directional_blur);
+    queue_test(test_effect_shadow);
+    queue_test(test_effect_morphology);
     queue_test(test_registered_effects);
     queue_test(test_transform_graph);
     queue_test(test_offset_transform);
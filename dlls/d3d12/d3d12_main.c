@@ -32,6 +32,7 @@
 #include "wine/wined3d.h"
 #include "wine/winedxgi.h"
 #include "wine/debug.h"
+#include "wine/list.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(d3d12);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
@@ -238,6 +239,285 @@ done:
     return vk_physical_device;
 }
 
+/* Persistent pipeline cache. vkd3d creates one VkPipelineCache per device and destroys
+ * it along with the device. When WINE_D3D12_PIPELINE_CACHE_PATH names a directory, the
+ * Vulkan entry points given to vkd3d are wrapped so that this cache is seeded from a
+ * file in that directory, and the file is replaced with its contents when it's destroyed. */
+
+struct d3d12_vk_device
+{
+    struct list entry;
+    VkDevice vk_device;
+    VkPipelineCache vk_pipeline_cache;
+    VkPipelineCacheHeaderVersionOne header;
+    WCHAR path[MAX_PATH];
+};
+
+static SRWLOCK vk_devices_lock = SRWLOCK_INIT;
+static struct list vk_devices = LIST_INIT(vk_devices);
+static WCHAR pipeline_cache_dir[MAX_PATH];
+
+/* winevulkan entry points don't depend on the instance or device they were queried for */
+static PFN_vkGetInstanceProcAddr pfn_vkGetInstanceProcAddr_next;
+static PFN_vkGetDeviceProcAddr pfn_vkGetDeviceProcAddr_next;
+static PFN_vkCreateDevice pfn_vkCreateDevice_next;
+static PFN_vkGetPhysicalDeviceProperties pfn_vkGetPhysicalDeviceProperties_next;
+static PFN_vkDestroyDevice pfn_vkDestroyDevice_next;
+static PFN_vkCreatePipelineCache pfn_vkCreatePipelineCache_next;
+static PFN_vkDestroyPipelineCache pfn_vkDestroyPipelineCache_next;
+static PFN_vkGetPipelineCacheData pfn_vkGetPipelineCacheData_next;
+
+static BOOL WINAPI init_pipeline_cache_once(INIT_ONCE *once, void *param, void **context)
+{
+    DWORD len = GetEnvironmentVariableW(L"WINE_D3D12_PIPELINE_CACHE_PATH",
+            pipeline_cache_dir, ARRAY_SIZE(pipeline_cache_dir));
+
+    if (!len || len >= ARRAY_SIZE(pipeline_cache_dir))
+        pipeline_cache_dir[0] = 0;
+    else
+        TRACE("Using pipeline cache directory %s.\n", debugstr_w(pipeline_cache_dir));
+    return TRUE;
+}
+
+static BOOL use_pipeline_cache(void)
+{
+    static INIT_ONCE init_once = INIT_ONCE_STATIC_INIT;
+
+    InitOnceExecuteOnce(&init_once, init_pipeline_cache_once, NULL, NULL);
+    return !!pipeline_cache_dir[0];
+}
+
+static struct d3d12_vk_device *d3d12_find_vk_device(VkDevice vk_device)
+{
+    struct d3d12_vk_device *device;
+
+    LIST_FOR_EACH_ENTRY(device, &vk_devices, struct d3d12_vk_device, entry)
+    {
+        if (device->vk_device == vk_device)
+            return device;
+    }
+    return NULL;
+}
+
+static void *d3d12_load_pipeline_cache(const struct d3d12_vk_device *device, size_t *size)
+{
+    const VkPipelineCacheHeaderVersionOne *header;
+    LARGE_INTEGER file_size;
+    void *data = NULL;
+    HANDLE file;
+    DWORD read;
+
+    file = CreateFileW(device->path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, 0, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart >= sizeof(*header)
+            && file_size.QuadPart <= MAXDWORD && (data = malloc(file_size.QuadPart)))
+    {
+        header = data;
+        /* drivers are supposed to check the header themselves, but some don't */
+        if (!ReadFile(file, data, file_size.QuadPart, &read, NULL) || read != file_size.QuadPart
+                || header->headerSize < sizeof(*header) || header->headerVersion != device->header.headerVersion
+                || header->vendorID != device->header.vendorID || header->deviceID != device->header.deviceID
+                || memcmp(header->pipelineCacheUUID, device->header.pipelineCacheUUID, VK_UUID_SIZE))
+        {
+            WARN("Ignoring stale pipeline cache %s.\n", debugstr_w(device->path));
+            free(data);
+            data = NULL;
+        }
+        else
+        {
+            *size = read;
+        }
+    }
+
+    CloseHandle(file);
+    return data;
+}
+
+static void d3d12_save_pipeline_cache(const struct d3d12_vk_device *device)
+{
+    WCHAR tmp_path[MAX_PATH];
+    size_t size;
+    void *data;
+    DWORD written;
+    HANDLE file;
+    BOOL ret;
+
+    if (pfn_vkGetPipelineCacheData_next(device->vk_device, device->vk_pipeline_cache, &size, NULL) < 0
+            || !size || size > MAXDWORD || !(data = malloc(size)))
+        return;
+
+    if (pfn_vkGetPipelineCacheData_next(device->vk_device, device->vk_pipeline_cache, &size, data) < 0)
+    {
+        free(data);
+        return;
+    }
+
+    /* write a new file and move it over the old one, other processes may be reading it */
+    swprintf(tmp_path, ARRAY_SIZE(tmp_path), L"%s.%lx", device->path, GetCurrentProcessId());
+    file = CreateFileW(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        ret = WriteFile(file, data, size, &written, NULL) && written == size;
+        CloseHandle(file);
+        if (ret && MoveFileExW(tmp_path, device->path, MOVEFILE_REPLACE_EXISTING))
+            TRACE("Saved %#Ix bytes to %s.\n", size, debugstr_w(device->path));
+        else
+            DeleteFileW(tmp_path);
+    }
+
+    free(data);
+}
+
+static VkResult VKAPI_CALL d3d12_vkCreatePipelineCache(VkDevice vk_device,
+        const VkPipelineCacheCreateInfo *create_info, const VkAllocationCallbacks *allocator,
+        VkPipelineCache *vk_pipeline_cache)
+{
+    VkPipelineCacheCreateInfo cache_info = *create_info;
+    struct d3d12_vk_device *device;
+    void *data = NULL;
+    size_t size = 0;
+    VkResult vr;
+
+    AcquireSRWLockExclusive(&vk_devices_lock);
+
+    if (!(device = d3d12_find_vk_device(vk_device)) || device->vk_pipeline_cache || create_info->initialDataSize)
+    {
+        ReleaseSRWLockExclusive(&vk_devices_lock);
+        return pfn_vkCreatePipelineCache_next(vk_device, create_info, allocator, vk_pipeline_cache);
+    }
+
+    if ((data = d3d12_load_pipeline_cache(device, &size)))
+    {
+        TRACE("Loading %#Ix bytes from %s.\n", size, debugstr_w(device->path));
+        cache_info.initialDataSize = size;
+        cache_info.pInitialData = data;
+    }
+    if ((vr = pfn_vkCreatePipelineCache_next(vk_device, &cache_info, allocator, vk_pipeline_cache)) < 0 && data)
+    {
+        WARN("Failed to create pipeline cache from %s, vr %d.\n", debugstr_w(device->path), vr);
+        vr = pfn_vkCreatePipelineCache_next(vk_device, create_info, allocator, vk_pipeline_cache);
+    }
+    if (vr >= 0)
+        device->vk_pipeline_cache = *vk_pipeline_cache;
+
+    ReleaseSRWLockExclusive(&vk_devices_lock);
+
+    free(data);
+    return vr;
+}
+
+static void VKAPI_CALL d3d12_vkDestroyPipelineCache(VkDevice vk_device, VkPipelineCache vk_pipeline_cache,
+        const VkAllocationCallbacks *allocator)
+{
+    struct d3d12_vk_device *device;
+
+    AcquireSRWLockExclusive(&vk_devices_lock);
+    if (vk_pipeline_cache && (device = d3d12_find_vk_device(vk_device))
+            && device->vk_pipeline_cache == vk_pipeline_cache)
+    {
+        d3d12_save_pipeline_cache(device);
+        device->vk_pipeline_cache = VK_NULL_HANDLE;
+    }
+    ReleaseSRWLockExclusive(&vk_devices_lock);
+
+    pfn_vkDestroyPipelineCache_next(vk_device, vk_pipeline_cache, allocator);
+}
+
+static void VKAPI_CALL d3d12_vkDestroyDevice(VkDevice vk_device, const VkAllocationCallbacks *allocator)
+{
+    struct d3d12_vk_device *device;
+
+    AcquireSRWLockExclusive(&vk_devices_lock);
+    if ((device = d3d12_find_vk_device(vk_device)))
+    {
+        list_remove(&device->entry);
+        free(device);
+    }
+    ReleaseSRWLockExclusive(&vk_devices_lock);
+
+    pfn_vkDestroyDevice_next(vk_device, allocator);
+}
+
+static PFN_vkVoidFunction VKAPI_CALL d3d12_vkGetDeviceProcAddr(VkDevice vk_device, const char *name)
+{
+    PFN_vkVoidFunction func = pfn_vkGetDeviceProcAddr_next(vk_device, name);
+
+    if (!func)
+        return NULL;
+    if (!strcmp(name, "vkCreatePipelineCache"))
+    {
+        pfn_vkCreatePipelineCache_next = (void *)func;
+        return (PFN_vkVoidFunction)d3d12_vkCreatePipelineCache;
+    }
+    if (!strcmp(name, "vkDestroyPipelineCache"))
+    {
+        pfn_vkDestroyPipelineCache_next = (void *)func;
+        pfn_vkGetPipelineCacheData_next = (void *)pfn_vkGetDeviceProcAddr_next(vk_device, "vkGetPipelineCacheData");
+        return pfn_vkGetPipelineCacheData_next ? (PFN_vkVoidFunction)d3d12_vkDestroyPipelineCache : func;
+    }
+    if (!strcmp(name, "vkDestroyDevice"))
+    {
+        pfn_vkDestroyDevice_next = (void *)func;
+        return (PFN_vkVoidFunction)d3d12_vkDestroyDevice;
+    }
+    return func;
+}
+
+static VkResult VKAPI_CALL d3d12_vkCreateDevice(VkPhysicalDevice vk_physical_device,
+        const VkDeviceCreateInfo *create_info, const VkAllocationCallbacks *allocator, VkDevice *vk_device)
+{
+    VkPhysicalDeviceProperties properties;
+    struct d3d12_vk_device *device;
+    VkResult vr;
+
+    if ((vr = pfn_vkCreateDevice_next(vk_physical_device, create_info, allocator, vk_device)) < 0)
+        return vr;
+
+    if (!(device = calloc(1, sizeof(*device))))
+        return vr;
+
+    pfn_vkGetPhysicalDeviceProperties_next(vk_physical_device, &properties);
+    device->vk_device = *vk_device;
+    device->header.headerSize = sizeof(device->header);
+    device->header.headerVersion = VK_PIPELINE_CACHE_HEADER_VERSION_ONE;
+    device->header.vendorID = properties.vendorID;
+    device->header.deviceID = properties.deviceID;
+    memcpy(device->header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+    swprintf(device->path, ARRAY_SIZE(device->path), L"%s\\pipelines-%04x-%04x.cache",
+            pipeline_cache_dir, properties.vendorID, properties.deviceID);
+
+    AcquireSRWLockExclusive(&vk_devices_lock);
+    list_add_tail(&vk_devices, &device->entry);
+    ReleaseSRWLockExclusive(&vk_devices_lock);
+
+    return vr;
+}
+
+static PFN_vkVoidFunction VKAPI_CALL d3d12_vkGetInstanceProcAddr(VkInstance vk_instance, const char *name)
+{
+    PFN_vkVoidFunction func = pfn_vkGetInstanceProcAddr_next(vk_instance, name);
+
+    if (!func || !vk_instance)
+        return func;
+    if (!strcmp(name, "vkGetDeviceProcAddr"))
+    {
+        pfn_vkGetDeviceProcAddr_next = (void *)func;
+        return (PFN_vkVoidFunction)d3d12_vkGetDeviceProcAddr;
+    }
+    if (!strcmp(name, "vkCreateDevice"))
+    {
+        pfn_vkCreateDevice_next = (void *)func;
+        if (!(pfn_vkGetPhysicalDeviceProperties_next
+                = (void *)pfn_vkGetInstanceProcAddr_next(vk_instance, "vkGetPhysicalDeviceProperties")))
+            return func;
+        return (PFN_vkVoidFunction)d3d12_vkCreateDevice;
+    }
+    return func;
+}
+
 HRESULT WINAPI D3D12CreateDevice(IUnknown *adapter, D3D_FEATURE_LEVEL minimum_feature_level,
         REFIID iid, void **device)
 {
@@ -300,6 +580,11 @@ HRESULT WINAPI D3D12CreateDevice(IUnknown *adapter, D3D_FEATURE_LEVEL minimum_fe
     instance_create_info.pfn_join_thread = NULL;
     instance_create_info.wchar_size = sizeof(WCHAR);
     instance_create_info.pfn_vkGetInstanceProcAddr = pfn_vkGetInstanceProcAddr;
+    if (use_pipeline_cache())
+    {
+        pfn_vkGetInstanceProcAddr_next = pfn_vkGetInstanceProcAddr;
+        instance_create_info.pfn_vkGetInstanceProcAddr = d3d12_vkGetInstanceProcAddr;
+    }
     instance_create_info.instance_extensions = instance_extensions;
     instance_create_info.instance_extension_count = ARRAY_SIZE(instance_extensions);
 
@@ -28824,11 +28824,185 @@ static void test_format_conversion(void)
     release_test_context(&context);
 }
 
+static void draw_program_cache_quad(void)
+{
+    IDirect3DVertexShader9 *vs;
+    IDirect3DPixelShader9 *ps;
+    IDirect3DDevice9 *device;
+    unsigned int color;
+    IDirect3D9 *d3d;
+    ULONG refcount;
+    D3DCAPS9 caps;
+    HWND window;
+    HRESULT hr;
+
+    static const DWORD vs_code[] =
+    {
+        0xfffe0200,                                                             /* vs_2_0               */
+        0x0200001f, 0x80000000, 0x900f0000,                                     /* dcl_position v0      */
+        0x02000001, 0xc00f0000, 0x90e40000,                                     /* mov oPos, v0         */
+        0x0000ffff,                                                             /* end                  */
+    };
+    static const DWORD ps_code[] =
+    {
+        0xffff0200,                                                             /* ps_2_0               */
+        0x05000051, 0xa00f0000, 0x3f800000, 0x3f000000, 0x00000000, 0x3f800000, /* def c0, 1, 0.5, 0, 1 */
+        0x02000001, 0x800f0800, 0xa0e40000,                                     /* mov oC0, c0          */
+        0x0000ffff,                                                             /* end                  */
+    };
+    static const float quad[] =
+    {
+        -1.0f, -1.0f, 0.1f,
+        -1.0f,  1.0f, 0.1f,
+         1.0f, -1.0f, 0.1f,
+         1.0f,  1.0f, 0.1f,
+    };
+
+    window = create_window();
+    d3d = Direct3DCreate9(D3D_SDK_VERSION);
+    ok(!!d3d, "Failed to create a D3D object.\n");
+    if (!(device = create_device(d3d, window, window, TRUE)))
+    {
+        skip("Failed to create a D3D device, skipping tests.\n");
+        goto done;
+    }
+
+    hr = IDirect3DDevice9_GetDeviceCaps(device, &caps);
+    ok(SUCCEEDED(hr), "Failed to get device caps, hr %#lx.\n", hr);
+    if (caps.PixelShaderVersion < D3DPS_VERSION(2, 0) || caps.VertexShaderVersion < D3DVS_VERSION(2, 0))
+    {
+        skip("No shader model 2 support, skipping tests.\n");
+        IDirect3DDevice9_Release(device);
+        goto done;
+    }
+
+    hr = IDirect3DDevice9_CreateVertexShader(device, vs_code, &vs);
+    ok(hr == S_OK, "Got hr %#lx.\n", hr);
+    hr = IDirect3DDevice9_SetVertexShader(device, vs);
+    ok(hr == S_OK, "Got hr %#lx.\n", hr);
+    hr = IDirect3DDevice9_CreatePixelShader(device, ps_code, &ps);
+    ok(hr == S_OK, "Got hr %#lx.\n", hr);
+    hr = IDirect3DDevice9_SetPixelShader(device, ps);
+    ok(hr == S_OK, "Got hr %#lx.\n", hr);
+    hr = IDirect3DDevice9_SetFVF(device, D3DFVF_XYZ);
+    ok(hr == S_OK, "Got hr %#lx.\n", hr);
+    hr = IDirect3DDevice9_Clear(device, 0, NULL, D3DCLEAR_TARGET, 0xff0000ff, 1.0f, 0);
+    ok(hr == S_OK, "Got hr %#lx.\n", hr);
+
+    hr = IDirect3DDevice9_BeginScene(device);
+    ok(SUCCEEDED(hr), "Failed to begin scene, hr %#lx.\n", hr);
+    hr = IDirect3DDevice9_DrawPrimitiveUP(device, D3DPT_TRIANGLESTRIP, 2, quad, 3 * sizeof(float));
+    ok(SUCCEEDED(hr), "Failed to draw, hr %#lx.\n", hr);
+    hr = IDirect3DDevice9_EndScene(device);
+    ok(SUCCEEDED(hr), "Failed to end scene, hr %#lx.\n", hr);
+
+    color = getPixelColor(device, 320, 240);
+    ok(color_match(color, 0x00ff8000, 1), "Got unexpected color 0x%08x.\n", color);
+
+    IDirect3DPixelShader9_Release(ps);
+    IDirect3DVertexShader9_Release(vs);
+    refcount = IDirect3DDevice9_Release(device);
+    ok(!refcount, "Device has %lu references left.\n", refcount);
+done:
+    IDirect3D9_Release(d3d);
+    DestroyWindow(window);
+}
+
+static BOOL run_program_cache_child(const char *cache_dir)
+{
+    char cmdline[MAX_PATH + 32], config[MAX_PATH + 32], **argv;
+    PROCESS_INFORMATION pi;
+    STARTUPINFOA si = {0};
+    BOOL ret;
+
+    winetest_get_mainargs(&argv);
+    sprintf(cmdline, "\"%s\" visual program_cache", argv[0]);
+    sprintf(config, "shader_cache_path=%s", cache_dir);
+    SetEnvironmentVariableA("WINE_D3D_CONFIG", config);
+
+    si.cb = sizeof(si);
+    ret = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
+    ok(ret, "Failed to create process, error %lu.\n", GetLastError());
+    SetEnvironmentVariableA("WINE_D3D_CONFIG", NULL);
+    if (!ret)
+        return FALSE;
+
+    wait_child_process(pi.hProcess);
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+    return TRUE;
+}
+
+static BOOL get_program_cache_file_id(const char *path, BY_HANDLE_FILE_INFORMATION *info)
+{
+    HANDLE file;
+    BOOL ret;
+
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, 0, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return FALSE;
+    ret = GetFileInformationByHandle(file, info);
+    ok(ret, "Failed to get file information, error %lu.\n", GetLastError());
+    CloseHandle(file);
+    return ret;
+}
+
+/* The wined3d program cache is written back only when something was added to
+ * it, so a second run that hits for every program leaves the file alone. */
+static void test_program_cache(void)
+{
+    BY_HANDLE_FILE_INFORMATION first, second;
+    char cache_dir[MAX_PATH], path[MAX_PATH];
+
+    if (!GetModuleHandleA("wined3d.dll"))
+    {
+        skip("Not running on wined3d.\n");
+        return;
+    }
+
+    GetTempPathA(ARRAY_SIZE(cache_dir), cache_dir);
+    strcat(cache_dir, "d3d9_program_cache");
+    CreateDirectoryA(cache_dir, NULL);
+    sprintf(path, "%s\\glsl.cache", cache_dir);
+    DeleteFileA(path);
+
+    if (!run_program_cache_child(cache_dir))
+        goto done;
+    if (!get_program_cache_file_id(path, &first))
+    {
+        skip("No program cache was written.\n");
+        goto done;
+    }
+
+    if (!run_program_cache_child(cache_dir))
+        goto done;
+    if (!get_program_cache_file_id(path, &second))
+    {
+        ok(0, "Program cache was deleted.\n");
+        goto done;
+    }
+    ok(first.nFileIndexLow == second.nFileIndexLow && first.nFileIndexHigh == second.nFileIndexHigh,
+            "Program cache was rewritten.\n");
+
+done:
+    DeleteFileA(path);
+    RemoveDirectoryA(cache_dir);
+}
+
 START_TEST(visual)
 {
     D3DADAPTER_IDENTIFIER9 identifier;
     IDirect3D9 *d3d;
+    char **argv;
     HRESULT hr;
+    int argc;
+
+    argc = winetest_get_mainargs(&argv);
+    if (argc >= 3 && !strcmp(argv[2], "program_cache"))
+    {
+        draw_program_cache_quad();
+        return;
+    }
 
     if (!(d3d = Direct3DCreate9(D3D_SDK_VERSION)))
     {
@@ -28981,4 +29155,5 @@ START_TEST(visual)
     test_default_diffuse();
     test_default_attribute_components();
     test_format_conversion();
+    test_program_cache();
 }
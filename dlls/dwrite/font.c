@@ -4646,6 +4646,653 @@ static void fontcollection_add_replacements(struct dwrite_fontcollection *collec
     RegCloseKey(hkey);
 }
 
+static HRESULT collection_add_font_data(struct dwrite_fontcollection *collection, struct dwrite_font_data *font_data)
+{
+    WCHAR familyW[255];
+    UINT32 index;
+    HRESULT hr;
+
+    fontstrings_get_en_string(font_data->family_names, familyW, ARRAY_SIZE(familyW));
+
+    /* ignore dot named faces */
+    if (familyW[0] == '.')
+    {
+        WARN("Ignoring face %s\n", debugstr_w(familyW));
+        release_font_data(font_data);
+        return S_OK;
+    }
+
+    index = collection_find_family(collection, familyW);
+    if (index != ~0u)
+        hr = fontfamily_add_font(collection->family_data[index], font_data);
+    else
+    {
+        struct dwrite_fontfamily_data *family_data;
+
+        /* Create and initialize new family */
+        hr = init_fontfamily_data(font_data->family_names, &family_data);
+        if (hr == S_OK)
+        {
+            /* add font to family, family - to collection */
+            hr = fontfamily_add_font(family_data, font_data);
+            if (hr == S_OK)
+                hr = fontcollection_add_family(collection, family_data);
+
+            if (FAILED(hr))
+                release_fontfamily_data(family_data);
+        }
+    }
+
+    if (FAILED(hr))
+        release_font_data(font_data);
+
+    return hr;
+}
+
+/* Persistent index of system font files, shared by all processes using the same prefix. It's mapped
+   read-only while system collection is built, so that font files that didn't change since they were
+   indexed don't have to be parsed again. Files are matched by path, size and last write time. Index
+   written by a different build is discarded, since the way properties are extracted might have changed. */
+
+#define FONTCACHE_MAGIC   0x63667764 /* 'dwfc' */
+#define FONTCACHE_VERSION 1
+
+#define FONTCACHE_FACE_INVALID 0x1
+
+struct fontcache_header
+{
+    UINT32 magic;
+    UINT32 version;
+    UINT32 build;       /* see fontcache_get_build() */
+    UINT32 size;
+    UINT32 count;
+    UINT32 reserved;
+    /* followed by 'count' fontcache_file entries sorted by path hash */
+};
+
+struct fontcache_file
+{
+    UINT64 size;
+    FILETIME writetime;
+    UINT32 hash;
+    UINT32 path;        /* offset of null-terminated path */
+    UINT32 path_length;
+    UINT32 face_type;
+    UINT32 face_count;  /* unsupported files are indexed without faces */
+    UINT32 data;        /* offset of 'face_count' fontcache_face entries, followed by strings they use */
+    UINT32 data_size;
+    UINT32 reserved;
+};
+
+struct fontcache_face
+{
+    UINT32 flags;
+    DWRITE_FONT_STYLE style;
+    DWRITE_FONT_STRETCH stretch;
+    DWRITE_FONT_WEIGHT weight;
+    DWRITE_PANOSE panose;
+    FONTSIGNATURE fontsig;
+    UINT32 font_flags;
+    DWRITE_FONT_AXIS_VALUE axis[3];
+    DWRITE_FONT_METRICS1 metrics;
+    LOGFONTW lf;
+    UINT32 family_names; /* offsets of string lists within file data, ~0u if not set */
+    UINT32 names;
+};
+
+struct fontcache_buffer
+{
+    BYTE *data;
+    size_t size;
+    size_t count;
+};
+
+struct fontcache_entry
+{
+    struct fontcache_file file;
+    WCHAR *path;
+    const BYTE *data;
+    BYTE *own_data;
+};
+
+struct system_fontcache
+{
+    const BYTE *view;
+    UINT32 view_size;
+    UINT32 reused;
+    BOOL dirty;
+
+    struct fontcache_entry *entries;
+    size_t size;
+    size_t count;
+};
+
+static void fontcache_get_path(WCHAR *path)
+{
+    GetWindowsDirectoryW(path, MAX_PATH);
+    wcscat(path, L"\\dwritefontcache.dat");
+}
+
+static UINT32 fontcache_hash_path(const WCHAR *path)
+{
+    UINT32 hash = 2166136261u;
+
+    while (*path)
+    {
+        hash ^= *path++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static UINT32 fontcache_get_build(void)
+{
+    const IMAGE_DOS_HEADER *dos = (const IMAGE_DOS_HEADER *)dwrite_module;
+    const IMAGE_NT_HEADERS *nt = (const IMAGE_NT_HEADERS *)((const BYTE *)dos + dos->e_lfanew);
+    const char *(CDECL *wine_get_build_id)(void);
+    UINT32 hash = nt->FileHeader.TimeDateStamp;
+    const char *build_id;
+
+    wine_get_build_id = (void *)GetProcAddress(GetModuleHandleW(L"ntdll.dll"), "wine_get_build_id");
+    if (wine_get_build_id && (build_id = wine_get_build_id()))
+    {
+        while (*build_id)
+        {
+            hash ^= (BYTE)*build_id++;
+            hash *= 16777619u;
+        }
+    }
+
+    return hash;
+}
+
+static void fontcache_open(struct system_fontcache *cache)
+{
+    const struct fontcache_header *header;
+    WCHAR path[MAX_PATH];
+    HANDLE file, mapping;
+    LARGE_INTEGER size;
+
+    memset(cache, 0, sizeof(*cache));
+    cache->dirty = TRUE;
+
+    fontcache_get_path(path);
+    file = CreateFileW(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+            OPEN_EXISTING, 0, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        TRACE("Font cache %s is not available.\n", debugstr_w(path));
+        return;
+    }
+
+    if (GetFileSizeEx(file, &size) && size.QuadPart >= sizeof(*header) && size.QuadPart <= MAXDWORD
+            && (mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL)))
+    {
+        cache->view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+
+    if (!cache->view)
+        return;
+
+    header = (const struct fontcache_header *)cache->view;
+    if (header->magic != FONTCACHE_MAGIC || header->version != FONTCACHE_VERSION
+            || header->build != fontcache_get_build() || header->size != size.QuadPart
+            || header->count > (header->size - sizeof(*header)) / sizeof(struct fontcache_file))
+    {
+        WARN("Ignoring invalid font cache %s.\n", debugstr_w(path));
+        UnmapViewOfFile(cache->view);
+        cache->view = NULL;
+        return;
+    }
+
+    cache->view_size = header->size;
+    cache->dirty = FALSE;
+}
+
+static const struct fontcache_file *fontcache_find_file(const struct system_fontcache *cache, const WCHAR *path,
+        const WIN32_FILE_ATTRIBUTE_DATA *info)
+{
+    const struct fontcache_header *header = (const struct fontcache_header *)cache->view;
+    UINT32 hash, length, low = 0, high, i;
+    const struct fontcache_file *files;
+
+    if (!header)
+        return NULL;
+
+    files = (const struct fontcache_file *)(header + 1);
+    hash = fontcache_hash_path(path);
+    length = wcslen(path);
+
+    high = header->count;
+    while (low < high)
+    {
+        UINT32 mid = low + (high - low) / 2;
+
+        if (files[mid].hash < hash)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    for (i = low; i < header->count && files[i].hash == hash; ++i)
+    {
+        const struct fontcache_file *file = &files[i];
+
+        if (file->path_length != length || file->path & 1 || file->path > cache->view_size
+                || (length + 1) * sizeof(WCHAR) > cache->view_size - file->path)
+        {
+            continue;
+        }
+
+        if (memcmp(cache->view + file->path, path, (length + 1) * sizeof(WCHAR)))
+            continue;
+
+        if (file->size != ((UINT64)info->nFileSizeHigh << 32 | info->nFileSizeLow)
+                || CompareFileTime(&file->writetime, &info->ftLastWriteTime))
+        {
+            TRACE("Font file %s was modified.\n", debugstr_w(path));
+            return NULL;
+        }
+
+        if (file->data & 7 || file->data > cache->view_size || file->data_size > cache->view_size - file->data
+                || file->face_count > file->data_size / sizeof(struct fontcache_face))
+        {
+            return NULL;
+        }
+
+        return file;
+    }
+
+    return NULL;
+}
+
+static BOOL fontcache_buffer_append(struct fontcache_buffer *buffer, const void *data, size_t size)
+{
+    if (!dwrite_array_reserve((void **)&buffer->data, &buffer->size, buffer->count + size, 1))
+        return FALSE;
+
+    if (data)
+        memcpy(buffer->data + buffer->count, data, size);
+    else
+        memset(buffer->data + buffer->count, 0, size);
+    buffer->count += size;
+
+    return TRUE;
+}
+
+static BOOL fontcache_buffer_align(struct fontcache_buffer *buffer, size_t alignment)
+{
+    return fontcache_buffer_append(buffer, NULL, ((buffer->count + alignment - 1) & ~(alignment - 1)) - buffer->count);
+}
+
+static BOOL fontcache_append_strings(struct fontcache_buffer *buffer, IDWriteLocalizedStrings *strings, UINT32 *offset)
+{
+    UINT32 i, count, length;
+    WCHAR *ptr;
+
+    *offset = ~0u;
+
+    if (!strings)
+        return TRUE;
+
+    if (!fontcache_buffer_align(buffer, sizeof(count)))
+        return FALSE;
+
+    *offset = buffer->count;
+    count = IDWriteLocalizedStrings_GetCount(strings);
+    if (!fontcache_buffer_append(buffer, &count, sizeof(count)))
+        return FALSE;
+
+    for (i = 0; i < count; ++i)
+    {
+        if (FAILED(IDWriteLocalizedStrings_GetLocaleNameLength(strings, i, &length)))
+            return FALSE;
+        if (!fontcache_buffer_append(buffer, NULL, (length + 1) * sizeof(WCHAR)))
+            return FALSE;
+        ptr = (WCHAR *)(buffer->data + buffer->count) - (length + 1);
+        if (FAILED(IDWriteLocalizedStrings_GetLocaleName(strings, i, ptr, length + 1)))
+            return FALSE;
+
+        if (FAILED(IDWriteLocalizedStrings_GetStringLength(strings, i, &length)))
+            return FALSE;
+        if (!fontcache_buffer_append(buffer, NULL, (length + 1) * sizeof(WCHAR)))
+            return FALSE;
+        ptr = (WCHAR *)(buffer->data + buffer->count) - (length + 1);
+        if (FAILED(IDWriteLocalizedStrings_GetString(strings, i, ptr, length + 1)))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/* Face entries are allocated in advance, followed by strings as they are added. */
+static BOOL fontcache_append_face(struct fontcache_buffer *buffer, UINT32 index, const struct dwrite_font_data *data)
+{
+    struct fontcache_face *face;
+    UINT32 family_names, names;
+
+    if (!fontcache_append_strings(buffer, data->family_names, &family_names))
+        return FALSE;
+    if (!fontcache_append_strings(buffer, data->names, &names))
+        return FALSE;
+
+    face = (struct fontcache_face *)buffer->data + index;
+    face->flags = 0;
+    face->style = data->style;
+    face->stretch = data->stretch;
+    face->weight = data->weight;
+    face->panose = data->panose;
+    face->fontsig = data->fontsig;
+    face->font_flags = data->flags;
+    memcpy(face->axis, data->axis, sizeof(face->axis));
+    face->metrics = data->metrics;
+    face->lf = data->lf;
+    face->family_names = family_names;
+    face->names = names;
+
+    return TRUE;
+}
+
+static const WCHAR *fontcache_skip_string(const WCHAR *ptr, const WCHAR *end)
+{
+    while (ptr < end && *ptr) ptr++;
+    return ptr < end ? ptr + 1 : NULL;
+}
+
+static HRESULT fontcache_get_strings(const BYTE *data, UINT32 data_size, UINT32 offset,
+        IDWriteLocalizedStrings **ret)
+{
+    const WCHAR *ptr, *end, *locale, *string;
+    UINT32 count;
+    HRESULT hr;
+
+    *ret = NULL;
+
+    if (offset == ~0u)
+        return S_OK;
+
+    if (offset & 3 || data_size < sizeof(count) || offset > data_size - sizeof(count))
+        return E_FAIL;
+
+    count = *(const UINT32 *)(data + offset);
+    ptr = (const WCHAR *)(data + offset + sizeof(count));
+    end = ptr + (data_size - offset - sizeof(count)) / sizeof(WCHAR);
+
+    if (FAILED(hr = create_localizedstrings(ret)))
+        return hr;
+
+    while (count--)
+    {
+        locale = ptr;
+        if (!(string = fontcache_skip_string(locale, end)) || !(ptr = fontcache_skip_string(string, end)))
+            hr = E_FAIL;
+        else
+            hr = add_localizedstring(*ret, locale, string);
+
+        if (FAILED(hr))
+        {
+            IDWriteLocalizedStrings_Release(*ret);
+            *ret = NULL;
+            return hr;
+        }
+    }
+
+    return S_OK;
+}
+
+static HRESULT init_font_data_from_cache(const struct fontcache_file *file, const BYTE *data, UINT32 index,
+        IDWriteFontFile *fontfile, struct dwrite_font_data **ret)
+{
+    const struct fontcache_face *face = (const struct fontcache_face *)data + index;
+    struct dwrite_font_data *font_data;
+    HRESULT hr;
+
+    *ret = NULL;
+
+    if (face->flags & FONTCACHE_FACE_INVALID)
+        return S_FALSE;
+
+    if (face->style > DWRITE_FONT_STYLE_ITALIC || face->stretch > DWRITE_FONT_STRETCH_ULTRA_EXPANDED)
+        return E_FAIL;
+
+    if (!(font_data = calloc(1, sizeof(*font_data))))
+        return E_OUTOFMEMORY;
+
+    font_data->refcount = 1;
+    font_data->file = fontfile;
+    font_data->face_index = index;
+    font_data->face_type = file->face_type;
+    IDWriteFontFile_AddRef(font_data->file);
+
+    font_data->style = face->style;
+    font_data->stretch = face->stretch;
+    font_data->weight = face->weight;
+    font_data->panose = face->panose;
+    font_data->fontsig = face->fontsig;
+    font_data->flags = face->font_flags;
+    font_data->metrics = face->metrics;
+    font_data->lf = face->lf;
+    memcpy(font_data->axis, face->axis, sizeof(font_data->axis));
+
+    if (FAILED(hr = fontcache_get_strings(data, file->data_size, face->family_names, &font_data->family_names))
+            || FAILED(hr = fontcache_get_strings(data, file->data_size, face->names, &font_data->names))
+            || (!font_data->family_names && (hr = E_FAIL)))
+    {
+        release_font_data(font_data);
+        return hr;
+    }
+
+    init_font_prop_vec(font_data->weight, font_data->stretch, font_data->style, &font_data->propvec);
+
+    *ret = font_data;
+    return S_OK;
+}
+
+/* Returns S_FALSE if cached data can't be used, nothing is added in this case. */
+static HRESULT collection_add_cached_file(struct dwrite_fontcollection *collection, const struct system_fontcache *cache,
+        const struct fontcache_file *file, IDWriteFontFile *fontfile)
+{
+    const BYTE *data = cache->view + file->data;
+    struct dwrite_font_data **fonts;
+    HRESULT hr = S_OK;
+    UINT32 i;
+
+    if (!file->face_count)
+        return S_OK;
+
+    if (!(fonts = calloc(file->face_count, sizeof(*fonts))))
+        return E_OUTOFMEMORY;
+
+    for (i = 0; i < file->face_count; ++i)
+    {
+        if (FAILED(init_font_data_from_cache(file, data, i, fontfile, &fonts[i])))
+        {
+            WARN("Invalid font cache entry for face %u.\n", i);
+            hr = S_FALSE;
+            break;
+        }
+    }
+
+    for (i = 0; i < file->face_count; ++i)
+    {
+        if (!fonts[i])
+            continue;
+
+        if (hr == S_OK)
+            hr = collection_add_font_data(collection, fonts[i]);
+        else
+            release_font_data(fonts[i]);
+    }
+
+    free(fonts);
+    return hr;
+}
+
+/* Takes ownership of the path, and of the data unless it's mapped from existing index. */
+static void fontcache_add_file(struct system_fontcache *cache, WCHAR *path, const WIN32_FILE_ATTRIBUTE_DATA *info,
+        UINT32 face_type, UINT32 face_count, const BYTE *data, UINT32 data_size, BOOL mapped)
+{
+    struct fontcache_entry *entry;
+
+    if (!dwrite_array_reserve((void **)&cache->entries, &cache->size, cache->count + 1, sizeof(*cache->entries)))
+    {
+        free(path);
+        if (!mapped) free((void *)data);
+        return;
+    }
+
+    entry = &cache->entries[cache->count++];
+    memset(entry, 0, sizeof(*entry));
+    entry->file.size = (UINT64)info->nFileSizeHigh << 32 | info->nFileSizeLow;
+    entry->file.writetime = info->ftLastWriteTime;
+    entry->file.hash = fontcache_hash_path(path);
+    entry->file.path_length = wcslen(path);
+    entry->file.face_type = face_type;
+    entry->file.face_count = face_count;
+    entry->file.data_size = data_size;
+    entry->path = path;
+    entry->data = data;
+    if (!mapped) entry->own_data = (BYTE *)data;
+
+    if (mapped)
+        cache->reused++;
+    else
+        cache->dirty = TRUE;
+}
+
+static int __cdecl fontcache_compare_entries(const void *left, const void *right)
+{
+    const struct fontcache_entry *_l = left, *_r = right;
+
+    if (_l->file.hash == _r->file.hash) return 0;
+    return _l->file.hash < _r->file.hash ? -1 : 1;
+}
+
+static void fontcache_write(struct system_fontcache *cache)
+{
+    struct fontcache_buffer buffer = { 0 };
+    WCHAR path[MAX_PATH], dir[MAX_PATH], tmppath[MAX_PATH];
+    struct fontcache_header *header;
+    struct fontcache_file *files;
+    DWORD written;
+    HANDLE file;
+    BOOL ret;
+    size_t i;
+
+    qsort(cache->entries, cache->count, sizeof(*cache->entries), fontcache_compare_entries);
+
+    if (!fontcache_buffer_append(&buffer, NULL, sizeof(*header) + cache->count * sizeof(*files)))
+        return;
+
+    for (i = 0; i < cache->count; ++i)
+    {
+        struct fontcache_entry *entry = &cache->entries[i];
+
+        if (!fontcache_buffer_align(&buffer, 8))
+            goto failed;
+        entry->file.path = buffer.count;
+        if (!fontcache_buffer_append(&buffer, entry->path, (entry->file.path_length + 1) * sizeof(WCHAR)))
+            goto failed;
+
+        if (!fontcache_buffer_align(&buffer, 8))
+            goto failed;
+        entry->file.data = buffer.count;
+        if (!fontcache_buffer_append(&buffer, entry->data, entry->file.data_size))
+            goto failed;
+    }
+
+    if (buffer.count > MAXDWORD)
+        goto failed;
+
+    header = (struct fontcache_header *)buffer.data;
+    header->magic = FONTCACHE_MAGIC;
+    header->version = FONTCACHE_VERSION;
+    header->build = fontcache_get_build();
+    header->size = buffer.count;
+    header->count = cache->count;
+    files = (struct fontcache_file *)(header + 1);
+    for (i = 0; i < cache->count; ++i)
+        files[i] = cache->entries[i].file;
+
+    /* New index replaces existing one at once, processes that have it mapped keep using old contents. */
+    GetWindowsDirectoryW(dir, ARRAY_SIZE(dir));
+    if (!GetTempFileNameW(dir, L"dwf", 0, tmppath))
+        goto failed;
+
+    file = CreateFileW(tmppath, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        DeleteFileW(tmppath);
+        goto failed;
+    }
+    ret = WriteFile(file, buffer.data, buffer.count, &written, NULL) && written == buffer.count;
+    CloseHandle(file);
+
+    fontcache_get_path(path);
+    if (!ret || !MoveFileExW(tmppath, path, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write font cache %s, error %lu.\n", debugstr_w(path), GetLastError());
+        DeleteFileW(tmppath);
+    }
+    else
+        TRACE("Written font cache %s, %Iu files.\n", debugstr_w(path), cache->count);
+
+failed:
+    free(buffer.data);
+}
+
+static void fontcache_close(struct system_fontcache *cache, BOOL update)
+{
+    const struct fontcache_header *header = (const struct fontcache_header *)cache->view;
+    size_t i;
+
+    /* Index is rewritten when files were added, modified or removed. */
+    if (update && (cache->dirty || !header || cache->reused != header->count))
+        fontcache_write(cache);
+
+    for (i = 0; i < cache->count; ++i)
+    {
+        free(cache->entries[i].path);
+        free(cache->entries[i].own_data);
+    }
+    free(cache->entries);
+
+    if (cache->view)
+        UnmapViewOfFile(cache->view);
+}
+
+static WCHAR *get_local_font_file_path(IDWriteFontFile *file)
+{
+    IDWriteLocalFontFileLoader *local_loader;
+    IDWriteFontFileLoader *loader;
+    UINT32 key_size, length;
+    WCHAR *path = NULL;
+    const void *key;
+
+    if (FAILED(IDWriteFontFile_GetLoader(file, &loader)))
+        return NULL;
+
+    if (SUCCEEDED(IDWriteFontFileLoader_QueryInterface(loader, &IID_IDWriteLocalFontFileLoader, (void **)&local_loader)))
+    {
+        if (SUCCEEDED(IDWriteFontFile_GetReferenceKey(file, &key, &key_size))
+                && SUCCEEDED(IDWriteLocalFontFileLoader_GetFilePathLengthFromKey(local_loader, key, key_size, &length))
+                && (path = malloc((length + 1) * sizeof(*path)))
+                && FAILED(IDWriteLocalFontFileLoader_GetFilePathFromKey(local_loader, key, key_size, path, length + 1)))
+        {
+            free(path);
+            path = NULL;
+        }
+        IDWriteLocalFontFileLoader_Release(local_loader);
+    }
+
+    IDWriteFontFileLoader_Release(loader);
+
+    return path;
+}
+
 HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerator *enumerator, BOOL is_system,
     IDWriteFontCollection3 **ret)
 {
@@ -4655,6 +5302,7 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
     };
     struct fontfile_enum *fileenum, *fileenum2;
     struct dwrite_fontcollection *collection;
+    struct system_fontcache cache;
     struct list scannedfiles;
     BOOL current = FALSE;
     HRESULT hr = S_OK;
@@ -4676,13 +5324,23 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
 
     TRACE("building font collection:\n");
 
+    if (is_system)
+        fontcache_open(&cache);
+    else
+        memset(&cache, 0, sizeof(cache));
+
     list_init(&scannedfiles);
     while (hr == S_OK) {
+        struct fontcache_buffer buffer = { 0 };
+        const struct fontcache_file *cached;
+        WIN32_FILE_ATTRIBUTE_DATA info;
         DWRITE_FONT_FACE_TYPE face_type;
         DWRITE_FONT_FILE_TYPE file_type;
         BOOL supported, same = FALSE;
         IDWriteFontFileStream *stream;
         IDWriteFontFile *file;
+        BOOL indexed = FALSE;
+        WCHAR *path = NULL;
         UINT32 face_count;
 
         current = FALSE;
@@ -4705,8 +5363,39 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
             continue;
         }
 
+        /* Local files that didn't change since they were indexed are not parsed again. */
+        if (is_system && (path = get_local_font_file_path(file)))
+            indexed = GetFileAttributesExW(path, GetFileExInfoStandard, &info);
+
+        if (indexed && (cached = fontcache_find_file(&cache, path, &info)))
+        {
+            hr = collection_add_cached_file(collection, &cache, cached, file);
+            if (hr != S_FALSE)
+            {
+                if (SUCCEEDED(hr))
+                {
+                    fontcache_add_file(&cache, path, &info, cached->face_type, cached->face_count,
+                            cache.view + cached->data, cached->data_size, TRUE);
+                    path = NULL;
+                }
+                free(path);
+
+                if (cached->face_count)
+                {
+                    fileenum = malloc(sizeof(*fileenum));
+                    fileenum->file = file;
+                    list_add_tail(&scannedfiles, &fileenum->entry);
+                }
+                else
+                    IDWriteFontFile_Release(file);
+                continue;
+            }
+            hr = S_OK;
+        }
+
         if (FAILED(get_filestream_from_file(file, &stream))) {
             IDWriteFontFile_Release(file);
+            free(path);
             continue;
         }
 
@@ -4714,6 +5403,12 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
         hr = opentype_analyze_font(stream, &supported, &file_type, &face_type, &face_count);
         if (FAILED(hr) || !supported || face_count == 0) {
             TRACE("Unsupported font (%p, 0x%08lx, %d, %u)\n", file, hr, supported, face_count);
+            if (SUCCEEDED(hr) && indexed)
+            {
+                fontcache_add_file(&cache, path, &info, DWRITE_FONT_FACE_TYPE_UNKNOWN, 0, NULL, 0, FALSE);
+                path = NULL;
+            }
+            free(path);
             IDWriteFontFileStream_Release(stream);
             IDWriteFontFile_Release(file);
             hr = S_OK;
@@ -4725,12 +5420,13 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
         fileenum->file = file;
         list_add_tail(&scannedfiles, &fileenum->entry);
 
+        if (indexed)
+            indexed = fontcache_buffer_append(&buffer, NULL, face_count * sizeof(struct fontcache_face));
+
         for (i = 0; i < face_count; ++i)
         {
             struct dwrite_font_data *font_data;
             struct fontface_desc desc;
-            WCHAR familyW[255];
-            UINT32 index;
 
             desc.factory = factory;
             desc.face_type = face_type;
@@ -4744,50 +5440,34 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
             hr = init_font_data(&desc, DWRITE_FONT_FAMILY_MODEL_WEIGHT_STRETCH_STYLE, &font_data);
             if (FAILED(hr))
             {
+                if (indexed)
+                    ((struct fontcache_face *)buffer.data)[i].flags = FONTCACHE_FACE_INVALID;
                 /* move to next one */
                 hr = S_OK;
                 continue;
             }
 
-            fontstrings_get_en_string(font_data->family_names, familyW, ARRAY_SIZE(familyW));
-
-            /* ignore dot named faces */
-            if (familyW[0] == '.')
-            {
-                WARN("Ignoring face %s\n", debugstr_w(familyW));
-                release_font_data(font_data);
-                continue;
-            }
-
-            index = collection_find_family(collection, familyW);
-            if (index != ~0u)
-                hr = fontfamily_add_font(collection->family_data[index], font_data);
-            else {
-                struct dwrite_fontfamily_data *family_data;
-
-                /* create and init new family */
-                hr = init_fontfamily_data(font_data->family_names, &family_data);
-                if (hr == S_OK) {
-                    /* add font to family, family - to collection */
-                    hr = fontfamily_add_font(family_data, font_data);
-                    if (hr == S_OK)
-                        hr = fontcollection_add_family(collection, family_data);
+            if (indexed)
+                indexed = fontcache_append_face(&buffer, i, font_data);
 
-                    if (FAILED(hr))
-                        release_fontfamily_data(family_data);
-                }
-            }
-
-            if (FAILED(hr))
-            {
-                release_font_data(font_data);
+            if (FAILED(hr = collection_add_font_data(collection, font_data)))
                 break;
-            }
         }
 
+        if (indexed && SUCCEEDED(hr))
+        {
+            fontcache_add_file(&cache, path, &info, face_type, face_count, buffer.data, buffer.count, FALSE);
+            path = NULL;
+        }
+        else
+            free(buffer.data);
+        free(path);
+
         IDWriteFontFileStream_Release(stream);
     }
 
+    fontcache_close(&cache, is_system && SUCCEEDED(hr));
+
     LIST_FOR_EACH_ENTRY_SAFE(fileenum, fileenum2, &scannedfiles, struct fontfile_enum, entry)
     {
         IDWriteFontFile_Release(fileenum->file);
@@ -4810,48 +5490,12 @@ HRESULT create_font_collection(IDWriteFactory7 *factory, IDWriteFontFileEnumerat
 static HRESULT collection_add_font_entry(struct dwrite_fontcollection *collection, const struct fontface_desc *desc)
 {
     struct dwrite_font_data *font_data;
-    WCHAR familyW[255];
-    UINT32 index;
     HRESULT hr;
 
     if (FAILED(hr = init_font_data(desc, collection->family_model, &font_data)))
         return hr;
 
-    fontstrings_get_en_string(font_data->family_names, familyW, ARRAY_SIZE(familyW));
-
-    /* ignore dot named faces */
-    if (familyW[0] == '.')
-    {
-        WARN("Ignoring face %s\n", debugstr_w(familyW));
-        release_font_data(font_data);
-        return S_OK;
-    }
-
-    index = collection_find_family(collection, familyW);
-    if (index != ~0u)
-        hr = fontfamily_add_font(collection->family_data[index], font_data);
-    else
-    {
-        struct dwrite_fontfamily_data *family_data;
-
-        /* Create and initialize new family */
-        hr = init_fontfamily_data(font_data->family_names, &family_data);
-        if (hr == S_OK)
-        {
-            /* add font to family, family - to collection */
-            hr = fontfamily_add_font(family_data, font_data);
-            if (hr == S_OK)
-                hr = fontcollection_add_family(collection, family_data);
-
-            if (FAILED(hr))
-                release_fontfamily_data(family_data);
-        }
-    }
-
-    if (FAILED(hr))
-        release_font_data(font_data);
-
-    return hr;
+    return collection_add_font_data(collection, font_data);
 }
 
 HRESULT create_font_collection_from_set(IDWriteFactory7 *factory, IDWriteFontSet *fontset,
@@ -135,6 +135,7 @@ struct regular_layout_run {
     FLOAT  *advances;
     DWRITE_GLYPH_OFFSET *offsets;
     UINT32 glyphcount; /* actual glyph count after shaping, not necessarily the same as reported to Draw() */
+    BOOL shaped;       /* set when shaping succeeded, results could be reused on next recompute */
 };
 
 struct layout_run
@@ -201,6 +202,10 @@ struct layout_line
 {
     float height;   /* height based on content */
     float baseline; /* baseline based on content */
+    float width;    /* width not including trailing whitespace */
+    float trailing_width;
+    UINT32 first_cluster;
+    UINT32 last_breaking_point; /* line breaking state this line was started with */
     DWRITE_LINE_METRICS1 metrics;
 };
 
@@ -209,7 +214,10 @@ enum layout_recompute_mask {
     RECOMPUTE_MINIMAL_WIDTH       = 1 << 1,
     RECOMPUTE_LINES               = 1 << 2,
     RECOMPUTE_OVERHANGS           = 1 << 3,
-    RECOMPUTE_LINES_AND_OVERHANGS = RECOMPUTE_LINES | RECOMPUTE_OVERHANGS,
+    RECOMPUTE_ALL_RUNS            = 1 << 4, /* shaping results of existing runs can't be reused */
+    RECOMPUTE_ALL_LINES           = 1 << 5, /* existing lines can't be reused */
+    RECOMPUTE_TEXT_RANGE          = RECOMPUTE_CLUSTERS | RECOMPUTE_MINIMAL_WIDTH | RECOMPUTE_LINES | RECOMPUTE_OVERHANGS,
+    RECOMPUTE_LINES_AND_OVERHANGS = RECOMPUTE_LINES | RECOMPUTE_ALL_LINES | RECOMPUTE_OVERHANGS,
     RECOMPUTE_EVERYTHING          = 0xffff
 };
 
@@ -248,6 +256,15 @@ struct dwrite_textlayout
     struct list strikethrough;
     USHORT recompute;
 
+    /* Text positions invalidated by range attribute changes since last recompute, runs and lines
+       that come before them are reused. */
+    struct
+    {
+        UINT32 reshape_start;
+        UINT32 reshape_end;
+        UINT32 relayout_start;
+    } dirty;
+
     DWRITE_LINE_BREAKPOINT *nominal_breakpoints;
     DWRITE_LINE_BREAKPOINT *actual_breakpoints;
 
@@ -330,34 +347,58 @@ static HRESULT alloc_layout_run(enum layout_run_kind kind, unsigned int start_po
     return S_OK;
 }
 
-static void free_layout_runs(struct dwrite_textlayout *layout)
+static void free_layout_run(struct layout_run *run)
 {
-    struct layout_run *cur, *cur2;
-    LIST_FOR_EACH_ENTRY_SAFE(cur, cur2, &layout->runs, struct layout_run, entry)
+    list_remove(&run->entry);
+    if (run->kind == LAYOUT_RUN_REGULAR)
     {
-        list_remove(&cur->entry);
-        if (cur->kind == LAYOUT_RUN_REGULAR)
-        {
-            if (cur->u.regular.run.fontFace)
-                IDWriteFontFace_Release(cur->u.regular.run.fontFace);
-            free(cur->u.regular.glyphs);
-            free(cur->u.regular.clustermap);
-            free(cur->u.regular.advances);
-            free(cur->u.regular.offsets);
-        }
-        free(cur);
+        if (run->u.regular.run.fontFace)
+            IDWriteFontFace_Release(run->u.regular.run.fontFace);
+        free(run->u.regular.glyphs);
+        free(run->u.regular.clustermap);
+        free(run->u.regular.advances);
+        free(run->u.regular.offsets);
     }
+    free(run);
 }
 
-static void free_layout_eruns(struct dwrite_textlayout *layout)
+static void free_layout_run_list(struct list *runs)
+{
+    struct layout_run *cur, *cur2;
+
+    LIST_FOR_EACH_ENTRY_SAFE(cur, cur2, runs, struct layout_run, entry)
+        free_layout_run(cur);
+}
+
+static void free_layout_runs(struct dwrite_textlayout *layout)
+{
+    free_layout_run_list(&layout->runs);
+}
+
+/* Releases effective runs, inline objects and strikethroughs starting from given line,
+   underlines could span lines and are always released. */
+static void free_layout_eruns_from_line(struct dwrite_textlayout *layout, UINT32 line)
 {
     struct layout_effective_inline *in, *in2;
     struct layout_effective_run *cur, *cur2;
     struct layout_strikethrough *s, *s2;
     struct layout_underline *u, *u2;
 
+    LIST_FOR_EACH_ENTRY_SAFE(s, s2, &layout->strikethrough, struct layout_strikethrough, entry)
+    {
+        if (s->run->line < line)
+        {
+            /* Range data this was pointing to could be gone already. */
+            s->s.localeName = s->run->run->u.regular.descr.localeName;
+            continue;
+        }
+        list_remove(&s->entry);
+        free(s);
+    }
+
     LIST_FOR_EACH_ENTRY_SAFE(cur, cur2, &layout->eruns, struct layout_effective_run, entry)
     {
+        if (cur->line < line) continue;
         list_remove(&cur->entry);
         free(cur->clustermap);
         free(cur);
@@ -365,6 +406,7 @@ static void free_layout_eruns(struct dwrite_textlayout *layout)
 
     LIST_FOR_EACH_ENTRY_SAFE(in, in2, &layout->inlineobjects, struct layout_effective_inline, entry)
     {
+        if (in->line < line) continue;
         list_remove(&in->entry);
         free(in);
     }
@@ -374,12 +416,11 @@ static void free_layout_eruns(struct dwrite_textlayout *layout)
         list_remove(&u->entry);
         free(u);
     }
+}
 
-    LIST_FOR_EACH_ENTRY_SAFE(s, s2, &layout->strikethrough, struct layout_strikethrough, entry)
-    {
-        list_remove(&s->entry);
-        free(s);
-    }
+static void free_layout_eruns(struct dwrite_textlayout *layout)
+{
+    free_layout_eruns_from_line(layout, 0);
 }
 
 /* Used to resolve break condition by forcing stronger condition over weaker. */
@@ -1136,6 +1177,8 @@ static HRESULT layout_shape_run(struct dwrite_textlayout *layout, struct regular
 
     layout_shape_clear_context(&context);
 
+    run->shaped = SUCCEEDED(hr);
+
     /* Special treatment for runs that don't produce visual output, shaping code adds normal glyphs for them,
        with valid cluster map and potentially with non-zero advances; layout code exposes those as zero
        width clusters. */
@@ -1147,15 +1190,79 @@ static HRESULT layout_shape_run(struct dwrite_textlayout *layout, struct regular
     return hr;
 }
 
+static BOOL is_same_shaping_run(const struct layout_run *left, const struct layout_run *right)
+{
+    const struct regular_layout_run *l = &left->u.regular, *r = &right->u.regular;
+
+    if (left->kind != right->kind || left->start_position != right->start_position)
+        return FALSE;
+
+    if (left->kind == LAYOUT_RUN_INLINE)
+        return left->u.object.object == right->u.object.object && left->u.object.length == right->u.object.length;
+
+    return l->descr.stringLength == r->descr.stringLength &&
+            l->run.fontFace == r->run.fontFace &&
+            l->run.fontEmSize == r->run.fontEmSize &&
+            l->run.isSideways == r->run.isSideways &&
+            l->run.bidiLevel == r->run.bidiLevel &&
+            l->sa.script == r->sa.script &&
+            l->sa.shapes == r->sa.shapes;
+}
+
+/* Replaces newly itemized runs with already shaped ones from previous computation, if they are
+   not affected by changed ranges. Returns text position of the first run that is not reused. */
+static UINT32 layout_reuse_shaped_runs(struct dwrite_textlayout *layout, struct list *old_runs)
+{
+    struct list *e = list_head(old_runs);
+    struct layout_run *r, *r2, *old;
+    UINT32 first_shaped = ~0u;
+
+    LIST_FOR_EACH_ENTRY_SAFE(r, r2, &layout->runs, struct layout_run, entry)
+    {
+        UINT32 length = r->kind == LAYOUT_RUN_INLINE ? r->u.object.length : r->u.regular.descr.stringLength;
+
+        /* Both lists are in logical order. */
+        old = NULL;
+        while (e)
+        {
+            old = LIST_ENTRY(e, struct layout_run, entry);
+            if (old->start_position >= r->start_position)
+                break;
+            e = list_next(old_runs, e);
+            old = NULL;
+        }
+
+        if (!old || !is_same_shaping_run(old, r) ||
+                (r->start_position < layout->dirty.reshape_end && layout->dirty.reshape_start < r->start_position + length) ||
+                (old->kind == LAYOUT_RUN_REGULAR && !old->u.regular.shaped))
+        {
+            first_shaped = min(first_shaped, r->start_position);
+            continue;
+        }
+
+        e = list_next(old_runs, e);
+
+        /* Nothing to reuse for inline objects, new run is equivalent. */
+        if (r->kind == LAYOUT_RUN_INLINE)
+            continue;
+
+        /* Keep previous run object, effective runs reused for unaffected lines are pointing to it. */
+        old->u.regular.descr.localeName = get_layout_range_by_pos(layout, old->u.regular.descr.textPosition)->locale;
+        list_remove(&old->entry);
+        list_add_before(&r->entry, &old->entry);
+        free_layout_run(r);
+    }
+
+    return first_shaped;
+}
+
 static HRESULT layout_compute_runs(struct dwrite_textlayout *layout)
 {
+    UINT32 cluster = 0, first_shaped = 0;
+    struct list old_runs;
     struct layout_run *r;
-    UINT32 cluster = 0;
     HRESULT hr;
 
-    free_layout_eruns(layout);
-    free_layout_runs(layout);
-
     /* Cluster data arrays are allocated once, assuming one text position per cluster. */
     if (!layout->clustermetrics && layout->len)
     {
@@ -1170,16 +1277,24 @@ static HRESULT layout_compute_runs(struct dwrite_textlayout *layout)
     }
     layout->cluster_count = 0;
 
+    /* Previously shaped runs are kept until new ones are resolved. */
+    list_init(&old_runs);
+    list_move_tail(&old_runs, &layout->runs);
+    if (layout->recompute & RECOMPUTE_ALL_RUNS)
+        free_layout_run_list(&old_runs);
+
     if (FAILED(hr = layout_itemize(layout))) {
         WARN("Itemization failed, hr %#lx.\n", hr);
-        return hr;
+        goto done;
     }
 
     if (FAILED(hr = layout_resolve_fonts(layout))) {
         WARN("Failed to resolve layout fonts, hr %#lx.\n", hr);
-        return hr;
+        goto done;
     }
 
+    first_shaped = layout_reuse_shaped_runs(layout, &old_runs);
+
     /* fill run info */
     LIST_FOR_EACH_ENTRY(r, &layout->runs, struct layout_run, entry) {
         struct regular_layout_run *run = &r->u.regular;
@@ -1218,7 +1333,9 @@ static HRESULT layout_compute_runs(struct dwrite_textlayout *layout)
             continue;
         }
 
-        if (FAILED(hr = layout_shape_run(layout, run)))
+        if (run->shaped)
+            hr = S_OK;
+        else if (FAILED(hr = layout_shape_run(layout, run)))
             WARN("%s: shaping failed, hr %#lx.\n", debugstr_rundescr(&run->descr), hr);
 
         /* baseline derived from font metrics */
@@ -1234,6 +1351,14 @@ static HRESULT layout_compute_runs(struct dwrite_textlayout *layout)
             layout->clustermetrics[cluster-1].canWrapLineAfter = 1;
     }
 
+done:
+    free_layout_run_list(&old_runs);
+
+    /* Lines have to be broken again starting from first reshaped run. */
+    layout->dirty.reshape_start = ~0u;
+    layout->dirty.reshape_end = 0;
+    layout->dirty.relayout_start = min(layout->dirty.relayout_start, first_shaped);
+
     return hr;
 }
 
@@ -1278,7 +1403,7 @@ static HRESULT layout_compute(struct dwrite_textlayout *layout)
         }
     }
 
-    layout->recompute &= ~RECOMPUTE_CLUSTERS;
+    layout->recompute &= ~(RECOMPUTE_CLUSTERS | RECOMPUTE_ALL_RUNS);
     return hr;
 }
 
@@ -1497,6 +1622,7 @@ static HRESULT layout_set_line_metrics(struct dwrite_textlayout *layout, DWRITE_
         return E_OUTOFMEMORY;
     }
 
+    memset(&layout->lines[i], 0, sizeof(layout->lines[i]));
     layout->lines[i].metrics = *metrics;
     layout->lines[i].height = metrics->height;
     layout->lines[i].baseline = metrics->baseline;
@@ -2079,7 +2205,11 @@ static void layout_add_line(struct dwrite_textlayout *layout, UINT32 first_clust
 
     metrics.height = descent + metrics.baseline;
     metrics.isTrimmed = append_trimming_run || width > layout->metrics.layoutWidth;
-    layout_set_line_metrics(layout, &metrics);
+    if (SUCCEEDED(layout_set_line_metrics(layout, &metrics)))
+    {
+        layout->lines[line].width = width;
+        layout->lines[line].trailing_width = trailingspacewidth;
+    }
 
     *textpos += metrics.length;
 }
@@ -2129,12 +2259,36 @@ static BOOL layout_can_wrap_after(const struct dwrite_textlayout *layout, UINT32
     return layout->clustermetrics[cluster].canWrapLineAfter;
 }
 
+/* Returns first line that has to be built again. Lines are reused up to the paragraph that contains
+   first invalidated text position, paragraphs are broken into lines independently. */
+static UINT32 layout_get_first_dirty_line(const struct dwrite_textlayout *layout)
+{
+    UINT32 line, first = 0, pos = 0;
+
+    if (layout->recompute & RECOMPUTE_ALL_LINES)
+        return 0;
+
+    for (line = 0; line + 1 < layout->metrics.lineCount; line++)
+    {
+        const struct layout_line *next = &layout->lines[line + 1];
+
+        pos += layout->lines[line].metrics.length;
+        /* Dummy line, or any other empty one, is always added again. */
+        if (pos > layout->dirty.relayout_start || !next->metrics.length)
+            break;
+
+        if (layout->clustermetrics[next->first_cluster - 1].isNewline)
+            first = line + 1;
+    }
+
+    return first;
+}
+
 static HRESULT layout_compute_effective_runs(struct dwrite_textlayout *layout)
 {
     BOOL is_rtl = layout->format.readingdir == DWRITE_READING_DIRECTION_RIGHT_TO_LEFT;
+    UINT32 i, start, textpos, last_breaking_point, first_line;
     struct layout_effective_run *erun, *first_underlined;
-    UINT32 i, start, textpos, last_breaking_point;
-    DWRITE_LINE_METRICS1 metrics;
     FLOAT width;
     UINT32 line;
     HRESULT hr;
@@ -2142,22 +2296,47 @@ static HRESULT layout_compute_effective_runs(struct dwrite_textlayout *layout)
     if (!(layout->recompute & RECOMPUTE_LINES))
         return S_OK;
 
-    free_layout_eruns(layout);
-
     hr = layout_compute(layout);
     if (FAILED(hr))
+    {
+        free_layout_eruns(layout);
+        layout->recompute |= RECOMPUTE_ALL_LINES;
         return hr;
+    }
 
-    layout->metrics.lineCount = 0;
-    memset(&metrics, 0, sizeof(metrics));
+    first_line = layout_get_first_dirty_line(layout);
+    free_layout_eruns_from_line(layout, first_line);
 
+    layout->metrics.lineCount = first_line;
     layout->metrics.height = 0.0f;
     layout->metrics.width = 0.0f;
     layout->metrics.widthIncludingTrailingWhitespace = 0.0f;
 
-    last_breaking_point = ~0u;
+    /* Reused lines only need their spacing updated, it could have changed in the meantime. */
+    for (line = 0, textpos = 0; line < first_line; line++)
+    {
+        const struct layout_line *l = &layout->lines[line];
+
+        layout->metrics.width = max(l->width, layout->metrics.width);
+        layout->metrics.widthIncludingTrailingWhitespace = max(l->width + l->trailing_width,
+                layout->metrics.widthIncludingTrailingWhitespace);
+        layout_apply_line_spacing(layout, line);
+        textpos += l->metrics.length;
+    }
 
-    for (i = 0, start = 0, width = 0.0f, textpos = 0; i < layout->cluster_count; i++) {
+    if (first_line)
+    {
+        start = layout->lines[first_line].first_cluster;
+        last_breaking_point = layout->lines[first_line].last_breaking_point;
+    }
+    else
+    {
+        start = 0;
+        last_breaking_point = ~0u;
+    }
+
+    for (i = start, width = 0.0f; i < layout->cluster_count; i++) {
+        UINT32 line_breaking_point = last_breaking_point;
         BOOL overflow = FALSE;
 
         while (i < layout->cluster_count && !layout->clustermetrics[i].isNewline) {
@@ -2190,7 +2369,13 @@ static HRESULT layout_compute_effective_runs(struct dwrite_textlayout *layout)
         }
         i = min(i, layout->cluster_count - 1);
 
+        line = layout->metrics.lineCount;
         layout_add_line(layout, start, i, &textpos);
+        if (line < layout->metrics.lineCount)
+        {
+            layout->lines[line].first_cluster = start;
+            layout->lines[line].last_breaking_point = line_breaking_point;
+        }
         start = i + 1;
         width = 0.0f;
     }
@@ -2221,11 +2406,12 @@ static HRESULT layout_compute_effective_runs(struct dwrite_textlayout *layout)
     /* Position runs in flow direction */
     layout_set_line_positions(layout);
 
-    /* Initial alignment is always leading */
-    if (layout->format.textalignment != DWRITE_TEXT_ALIGNMENT_LEADING)
+    /* Initial alignment is always leading, reused lines could still be aligned differently */
+    if (first_line || layout->format.textalignment != DWRITE_TEXT_ALIGNMENT_LEADING)
         layout_apply_text_alignment(layout);
 
-    layout->recompute &= ~RECOMPUTE_LINES;
+    layout->dirty.relayout_start = ~0u;
+    layout->recompute &= ~(RECOMPUTE_LINES | RECOMPUTE_ALL_LINES);
     return hr;
 }
 
@@ -2665,6 +2851,33 @@ static inline HRESULT return_range(const struct layout_range_header *h, DWRITE_T
     return S_OK;
 }
 
+/* Records text positions affected by range attribute change. Break conditions next to the range
+   could change too, so it's extended by one position on both sides. */
+static void layout_invalidate_range(struct dwrite_textlayout *layout, enum layout_range_attr_kind attr,
+        const DWRITE_TEXT_RANGE *range)
+{
+    UINT32 start = range->startPosition, end = range->startPosition + range->length;
+
+    if (start) start--;
+    if (end != ~0u) end++;
+
+    switch (attr)
+    {
+    /* These only split effective runs, shaping is not affected. */
+    case LAYOUT_RANGE_ATTR_EFFECT:
+    case LAYOUT_RANGE_ATTR_UNDERLINE:
+    case LAYOUT_RANGE_ATTR_STRIKETHROUGH:
+        layout->recompute |= RECOMPUTE_LINES | RECOMPUTE_OVERHANGS;
+        break;
+    default:
+        layout->recompute |= RECOMPUTE_TEXT_RANGE;
+        layout->dirty.reshape_start = min(layout->dirty.reshape_start, start);
+        layout->dirty.reshape_end = max(layout->dirty.reshape_end, end);
+    }
+
+    layout->dirty.relayout_start = min(layout->dirty.relayout_start, start);
+}
+
 /* Sets attribute value for given range, does all needed splitting/merging of existing ranges. */
 static HRESULT set_layout_range_attr(struct dwrite_textlayout *layout, enum layout_range_attr_kind attr, struct layout_range_attr_value *value)
 {
@@ -2772,7 +2985,7 @@ static HRESULT set_layout_range_attr(struct dwrite_textlayout *layout, enum layo
         list_add_after(&outer->entry, &cur->entry);
         list_add_after(&cur->entry, &right->entry);
 
-        layout->recompute = RECOMPUTE_EVERYTHING;
+        layout_invalidate_range(layout, attr, &value->range);
         return S_OK;
     }
 
@@ -2812,7 +3025,7 @@ done:
     if (changed) {
         struct list *next, *i;
 
-        layout->recompute = RECOMPUTE_EVERYTHING;
+        layout_invalidate_range(layout, attr, &value->range);
         i = list_head(ranges);
         while ((next = list_next(ranges, i))) {
             struct layout_range_header *next_range = LIST_ENTRY(next, struct layout_range_header, entry);
@@ -5275,6 +5488,8 @@ static HRESULT init_textlayout(const struct textlayout_desc *desc, struct dwrite
     layout->refcount = 1;
     layout->len = desc->length;
     layout->recompute = RECOMPUTE_EVERYTHING;
+    layout->dirty.reshape_start = ~0u;
+    layout->dirty.relayout_start = ~0u;
     list_init(&layout->eruns);
     list_init(&layout->inlineobjects);
     list_init(&layout->underlines);
@@ -2677,6 +2677,187 @@ static void test_system_fontcollection(void)
     ok(!ref, "Factory wasn't released, %lu.\n", ref);
 }
 
+static void compare_font_collections(IDWriteFontCollection *collection, IDWriteFontCollection *collection2)
+{
+    IDWriteLocalizedStrings *names, *names2;
+    DWRITE_FONT_METRICS metrics, metrics2;
+    IDWriteFontFamily *family, *family2;
+    WCHAR name[256], name2[256];
+    IDWriteFont *font, *font2;
+    UINT32 count, i, j;
+    HRESULT hr;
+
+    count = IDWriteFontCollection_GetFontFamilyCount(collection);
+    ok(count == IDWriteFontCollection_GetFontFamilyCount(collection2), "Unexpected family count %u.\n", count);
+    count = min(count, IDWriteFontCollection_GetFontFamilyCount(collection2));
+
+    for (i = 0; i < count; ++i)
+    {
+        winetest_push_context("family %u", i);
+
+        hr = IDWriteFontCollection_GetFontFamily(collection, i, &family);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+        hr = IDWriteFontCollection_GetFontFamily(collection2, i, &family2);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+        hr = IDWriteFontFamily_GetFamilyNames(family, &names);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+        hr = IDWriteFontFamily_GetFamilyNames(family2, &names2);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+        ok(IDWriteLocalizedStrings_GetCount(names) == IDWriteLocalizedStrings_GetCount(names2),
+                "Unexpected name count.\n");
+        get_enus_string(names, name, ARRAY_SIZE(name));
+        get_enus_string(names2, name2, ARRAY_SIZE(name2));
+        ok(!wcscmp(name, name2), "Unexpected family name %s, expected %s.\n", wine_dbgstr_w(name2), wine_dbgstr_w(name));
+        IDWriteLocalizedStrings_Release(names2);
+        IDWriteLocalizedStrings_Release(names);
+
+        ok(IDWriteFontFamily_GetFontCount(family) == IDWriteFontFamily_GetFontCount(family2),
+                "Unexpected font count.\n");
+
+        for (j = 0; j < min(IDWriteFontFamily_GetFontCount(family), IDWriteFontFamily_GetFontCount(family2)); ++j)
+        {
+            winetest_push_context("font %u", j);
+
+            hr = IDWriteFontFamily_GetFont(family, j, &font);
+            ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+            hr = IDWriteFontFamily_GetFont(family2, j, &font2);
+            ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+            ok(IDWriteFont_GetWeight(font) == IDWriteFont_GetWeight(font2), "Unexpected weight.\n");
+            ok(IDWriteFont_GetStretch(font) == IDWriteFont_GetStretch(font2), "Unexpected stretch.\n");
+            ok(IDWriteFont_GetStyle(font) == IDWriteFont_GetStyle(font2), "Unexpected style.\n");
+            ok(IDWriteFont_GetSimulations(font) == IDWriteFont_GetSimulations(font2), "Unexpected simulations.\n");
+            ok(IDWriteFont_IsSymbolFont(font) == IDWriteFont_IsSymbolFont(font2), "Unexpected symbol flag.\n");
+
+            IDWriteFont_GetMetrics(font, &metrics);
+            IDWriteFont_GetMetrics(font2, &metrics2);
+            ok(!memcmp(&metrics, &metrics2, sizeof(metrics)), "Unexpected metrics.\n");
+
+            hr = IDWriteFont_GetFaceNames(font, &names);
+            ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+            hr = IDWriteFont_GetFaceNames(font2, &names2);
+            ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+            get_enus_string(names, name, ARRAY_SIZE(name));
+            get_enus_string(names2, name2, ARRAY_SIZE(name2));
+            ok(!wcscmp(name, name2), "Unexpected face name %s, expected %s.\n", wine_dbgstr_w(name2), wine_dbgstr_w(name));
+            IDWriteLocalizedStrings_Release(names2);
+            IDWriteLocalizedStrings_Release(names);
+
+            IDWriteFont_Release(font2);
+            IDWriteFont_Release(font);
+
+            winetest_pop_context();
+        }
+
+        IDWriteFontFamily_Release(family2);
+        IDWriteFontFamily_Release(family);
+
+        winetest_pop_context();
+    }
+}
+
+static BOOL system_collection_has_family(const WCHAR *name)
+{
+    IDWriteFontCollection *collection;
+    IDWriteFactory *factory;
+    BOOL exists = FALSE;
+    UINT32 index;
+    HRESULT hr;
+
+    factory = create_factory();
+    hr = IDWriteFactory_GetSystemFontCollection(factory, &collection, FALSE);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteFontCollection_FindFamilyName(collection, name, &index, &exists);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    IDWriteFontCollection_Release(collection);
+    IDWriteFactory_Release(factory);
+
+    return exists;
+}
+
+static void test_system_fontcollection_cache(void)
+{
+    static const WCHAR fontname[] = L"wine_test_cache (TrueType)";
+    IDWriteFontCollection *collection, *collection2;
+    IDWriteFactory *factory, *factory2;
+    WCHAR cache_path[MAX_PATH], *path;
+    LARGE_INTEGER size;
+    FILETIME writetime;
+    DWORD written;
+    HANDLE file;
+    void *data;
+    HKEY hkey;
+    HRESULT hr;
+    LONG ret;
+
+    /* Wine keeps an index of system font files, collection built from it has to be the same. */
+    GetWindowsDirectoryW(cache_path, ARRAY_SIZE(cache_path));
+    lstrcatW(cache_path, L"\\dwritefontcache.dat");
+    DeleteFileW(cache_path);
+
+    factory = create_factory();
+    hr = IDWriteFactory_GetSystemFontCollection(factory, &collection, FALSE);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    factory2 = create_factory();
+    hr = IDWriteFactory_GetSystemFontCollection(factory2, &collection2, FALSE);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    compare_font_collections(collection, collection2);
+
+    IDWriteFontCollection_Release(collection2);
+    IDWriteFactory_Release(factory2);
+    IDWriteFontCollection_Release(collection);
+    IDWriteFactory_Release(factory);
+
+    if (!winetest_platform_is_wine)
+    {
+        skip("Font file index is Wine specific.\n");
+        return;
+    }
+
+    ret = RegOpenKeyExW(HKEY_LOCAL_MACHINE, L"Software\\Microsoft\\Windows NT\\CurrentVersion\\Fonts", 0,
+            KEY_SET_VALUE, &hkey);
+    if (ret)
+    {
+        skip("Failed to open fonts key, error %ld.\n", ret);
+        return;
+    }
+
+    path = create_testfontfile(L"wine_test_cache.ttf");
+    ret = RegSetValueExW(hkey, fontname, 0, REG_SZ, (const BYTE *)path, (lstrlenW(path) + 1) * sizeof(*path));
+    ok(!ret, "Failed to register font file, error %ld.\n", ret);
+
+    /* Indexed on first use, then used from the index. */
+    ok(system_collection_has_family(L"wine_test"), "Expected test family.\n");
+    ok(system_collection_has_family(L"wine_test"), "Expected test family.\n");
+
+    /* Same size, different contents and last write time. */
+    file = CreateFileW(path, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
+    ok(file != INVALID_HANDLE_VALUE, "Failed to open file, error %ld.\n", GetLastError());
+    GetFileSizeEx(file, &size);
+    GetFileTime(file, NULL, NULL, &writetime);
+    data = calloc(1, size.QuadPart);
+    ok(WriteFile(file, data, size.QuadPart, &written, NULL) && written == size.QuadPart, "Failed to write file.\n");
+    free(data);
+    writetime.dwHighDateTime--;
+    SetFileTime(file, NULL, NULL, &writetime);
+    CloseHandle(file);
+
+    ok(!system_collection_has_family(L"wine_test"), "Unexpected test family.\n");
+    ok(!system_collection_has_family(L"wine_test"), "Unexpected test family.\n");
+
+    create_testfontfile(L"wine_test_cache.ttf");
+
+    ok(system_collection_has_family(L"wine_test"), "Expected test family.\n");
+    ok(system_collection_has_family(L"wine_test"), "Expected test family.\n");
+
+    RegDeleteValueW(hkey, fontname);
+    RegCloseKey(hkey);
+    DELETE_FONTFILE(path);
+}
+
 static void get_logfont_from_font(IDWriteFont *font, LOGFONTW *logfont)
 {
     void *os2_context, *head_context;
@@ -10495,6 +10676,7 @@ START_TEST(font)
     test_CreateFontFace();
     test_GetMetrics();
     test_system_fontcollection();
+    test_system_fontcollection_cache();
     test_ConvertFontFaceToLOGFONT();
     test_CustomFontCollection();
     test_CreateCustomFontFileReference();
@@ -7065,6 +7065,97 @@ if (SUCCEEDED(hr))
     IDWriteFactory_Release(factory);
 }
 
+static void check_same_layout_metrics_(unsigned int line, IDWriteTextLayout *layout, IDWriteTextLayout *expected)
+{
+    DWRITE_LINE_METRICS lines[16], expected_lines[16];
+    DWRITE_TEXT_METRICS metrics, expected_metrics;
+    UINT32 count, expected_count, i;
+    HRESULT hr;
+
+    hr = IDWriteTextLayout_GetMetrics(layout, &metrics);
+    ok_(__FILE__, line)(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteTextLayout_GetMetrics(expected, &expected_metrics);
+    ok_(__FILE__, line)(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok_(__FILE__, line)(!memcmp(&metrics, &expected_metrics, sizeof(metrics)),
+            "Unexpected metrics: width %.2f, %.2f, height %.2f, %.2f, line count %u, %u.\n",
+            metrics.width, expected_metrics.width, metrics.height, expected_metrics.height,
+            metrics.lineCount, expected_metrics.lineCount);
+
+    hr = IDWriteTextLayout_GetLineMetrics(layout, lines, ARRAY_SIZE(lines), &count);
+    ok_(__FILE__, line)(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteTextLayout_GetLineMetrics(expected, expected_lines, ARRAY_SIZE(expected_lines), &expected_count);
+    ok_(__FILE__, line)(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok_(__FILE__, line)(count == expected_count, "Unexpected line count %u, expected %u.\n", count, expected_count);
+    for (i = 0; i < count && i < expected_count; ++i)
+    {
+        ok_(__FILE__, line)(!memcmp(&lines[i], &expected_lines[i], sizeof(lines[i])),
+                "%u: unexpected length %u, expected %u, height %.2f, expected %.2f.\n", i, lines[i].length,
+                expected_lines[i].length, lines[i].height, expected_lines[i].height);
+    }
+}
+#define check_same_layout_metrics(a, b) check_same_layout_metrics_(__LINE__, a, b)
+
+static void test_relayout(void)
+{
+    static const WCHAR strW[] = L"one two three four five\r\nsix seven eight nine ten\r\neleven twelve thirteen";
+    DWRITE_TEXT_RANGE range, range2;
+    IDWriteTextLayout *layout, *layout2;
+    IDWriteTextFormat *format;
+    DWRITE_TEXT_METRICS metrics;
+    IDWriteFactory *factory;
+    HRESULT hr;
+
+    factory = create_factory();
+
+    hr = IDWriteFactory_CreateTextFormat(factory, L"Tahoma", NULL, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL,
+            DWRITE_FONT_STRETCH_NORMAL, 10.0f, L"en-us", &format);
+    ok(hr == S_OK, "Failed to create text format, hr %#lx.\n", hr);
+
+    hr = IDWriteFactory_CreateTextLayout(factory, strW, wcslen(strW), format, 60.0f, 1000.0f, &layout);
+    ok(hr == S_OK, "Failed to create text layout, hr %#lx.\n", hr);
+
+    hr = IDWriteTextLayout_GetMetrics(layout, &metrics);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(metrics.lineCount > 3, "Unexpected line count %u.\n", metrics.lineCount);
+
+    /* Changes in the middle of already computed layout, result should match layout created from scratch. */
+    range.startPosition = 29;
+    range.length = 5;
+    hr = IDWriteTextLayout_SetFontSize(layout, 20.0f, range);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    range2.startPosition = 52;
+    range2.length = 6;
+    hr = IDWriteTextLayout_SetUnderline(layout, TRUE, range2);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    hr = IDWriteFactory_CreateTextLayout(factory, strW, wcslen(strW), format, 60.0f, 1000.0f, &layout2);
+    ok(hr == S_OK, "Failed to create text layout, hr %#lx.\n", hr);
+    hr = IDWriteTextLayout_SetFontSize(layout2, 20.0f, range);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteTextLayout_SetUnderline(layout2, TRUE, range2);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    check_same_layout_metrics(layout, layout2);
+    IDWriteTextLayout_Release(layout2);
+
+    /* Restore original size, last paragraph only changes its underline. */
+    hr = IDWriteTextLayout_SetFontSize(layout, 10.0f, range);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    hr = IDWriteTextLayout_SetUnderline(layout, FALSE, range2);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    hr = IDWriteFactory_CreateTextLayout(factory, strW, wcslen(strW), format, 60.0f, 1000.0f, &layout2);
+    ok(hr == S_OK, "Failed to create text layout, hr %#lx.\n", hr);
+
+    check_same_layout_metrics(layout, layout2);
+    IDWriteTextLayout_Release(layout2);
+
+    IDWriteTextLayout_Release(layout);
+    IDWriteTextFormat_Release(format);
+    IDWriteFactory_Release(factory);
+}
+
 START_TEST(layout)
 {
     IDWriteFactory *factory;
@@ -7121,6 +7212,7 @@ START_TEST(layout)
     test_text_format_axes();
     test_layout_range_length();
     test_HitTestTextRange();
+    test_relayout();
 
     IDWriteFactory_Release(factory);
 }
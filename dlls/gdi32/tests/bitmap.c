@@ -3856,6 +3856,110 @@ static void test_GdiAlphaBlend(void)
     free(bmi);
 }
 
+static BYTE blend_channel( BYTE dst, BYTE src, DWORD alpha )
+{
+    return (src * alpha + dst * (255 - alpha) + 127) / 255;
+}
+
+static DWORD blend_pixel( DWORD dst, DWORD src, BLENDFUNCTION blend )
+{
+    DWORD ret = 0, alpha = blend.SourceConstantAlpha;
+    int i;
+
+    if (blend.AlphaFormat & AC_SRC_ALPHA)
+    {
+        for (i = 0; i < 32; i += 8)
+            src = (src & ~(0xffu << i)) | ((((src >> i) & 0xff) * alpha + 127) / 255) << i;
+        alpha = src >> 24;
+        for (i = 0; i < 32; i += 8)
+            ret |= (((src >> i) & 0xff) + (((dst >> i) & 0xff) * (255 - alpha) + 127) / 255) << i;
+        return ret;
+    }
+    for (i = 0; i < 32; i += 8)
+        ret |= (DWORD)blend_channel( dst >> i, src >> i, alpha ) << i;
+    return ret;
+}
+
+static void test_32bpp_lines(void)
+{
+    static const int widths[] = { 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 100, 248 };
+    static const BYTE alphas[] = { 255, 254, 128, 1 };
+    BITMAPINFO bmi = {{ sizeof(BITMAPINFOHEADER), 256, -4, 1, 32, BI_RGB }};
+    DWORD *src_bits, *dst_bits, expect[256], orig[256];
+    HBITMAP src_bmp, dst_bmp;
+    HDC src_dc, dst_dc;
+    BLENDFUNCTION blend = { AC_SRC_OVER };
+    int i, j, k, x, off, width;
+    BOOL ret;
+
+    src_dc = CreateCompatibleDC( NULL );
+    dst_dc = CreateCompatibleDC( NULL );
+    src_bmp = CreateDIBSection( src_dc, &bmi, DIB_RGB_COLORS, (void **)&src_bits, NULL, 0 );
+    dst_bmp = CreateDIBSection( dst_dc, &bmi, DIB_RGB_COLORS, (void **)&dst_bits, NULL, 0 );
+    SelectObject( src_dc, src_bmp );
+    SelectObject( dst_dc, dst_bmp );
+
+    /* premultiplied source covering every alpha value, varied destination */
+    for (x = 0; x < 256; x++)
+    {
+        src_bits[x] = x << 24 | (x * 3 / 4) << 16 | (x / 3) << 8 | (x * 7 / 8);
+        orig[x] = (x * 0x9e3779b9) ^ (x << 13);
+    }
+
+    for (i = 0; i < ARRAY_SIZE(alphas); i++)
+    {
+        for (k = 0; k < 2; k++)
+        {
+            blend.SourceConstantAlpha = alphas[i];
+            blend.AlphaFormat = k ? AC_SRC_ALPHA : 0;
+            for (j = 0; j < ARRAY_SIZE(widths); j++)
+            {
+                for (off = 0; off < 8; off++)
+                {
+                    width = widths[j];
+                    memcpy( dst_bits, orig, sizeof(orig) );
+                    memcpy( expect, orig, sizeof(orig) );
+                    for (x = off; x < off + width; x++) expect[x] = blend_pixel( orig[x], src_bits[x], blend );
+
+                    ret = pGdiAlphaBlend( dst_dc, off, 0, width, 1, src_dc, off, 0, width, 1, blend );
+                    ok( ret, "GdiAlphaBlend failed err %lu\n", GetLastError() );
+                    for (x = 0; x < 256; x++)
+                        if (dst_bits[x] != expect[x]) break;
+                    ok( x == 256, "alpha %u format %u width %d off %d: pixel %d got %08lx expected %08lx\n",
+                        alphas[i], blend.AlphaFormat, width, off, x, x < 256 ? dst_bits[x] : 0,
+                        x < 256 ? expect[x] : 0 );
+                }
+            }
+        }
+    }
+
+    for (j = 0; j < ARRAY_SIZE(widths); j++)
+    {
+        for (off = 0; off < 8; off++)
+        {
+            width = widths[j];
+            memcpy( dst_bits, orig, sizeof(orig) );
+            memcpy( expect, orig, sizeof(orig) );
+            for (x = off; x < off + width; x++) expect[x] = ~orig[x];
+            PatBlt( dst_dc, off, 0, width, 1, DSTINVERT );
+            for (x = 0; x < 256; x++)
+                if (dst_bits[x] != expect[x]) break;
+            ok( x == 256, "DSTINVERT width %d off %d: pixel %d differs\n", width, off, x );
+
+            for (x = off; x < off + width; x++) expect[x] ^= src_bits[x];
+            BitBlt( dst_dc, off, 0, width, 1, src_dc, off, 0, SRCINVERT );
+            for (x = 0; x < 256; x++)
+                if (dst_bits[x] != expect[x]) break;
+            ok( x == 256, "SRCINVERT width %d off %d: pixel %d differs\n", width, off, x );
+        }
+    }
+
+    DeleteDC( src_dc );
+    DeleteDC( dst_dc );
+    DeleteObject( src_bmp );
+    DeleteObject( dst_bmp );
+}
+
 static void test_GdiGradientFill(void)
 {
     HDC hdc;
@@ -6011,6 +6115,7 @@ START_TEST(bitmap)
     test_StretchBlt();
     test_StretchDIBits();
     test_GdiAlphaBlend();
+    test_32bpp_lines();
     test_GdiGradientFill();
     test_32bit_ddb();
     test_bitmapinfoheadersize();
@@ -4939,6 +4939,97 @@ static void test_GetGlyphOutline(void)
     DeleteDC(hdc);
 }
 
+/* Bitmaps are shared between the processes of the session once rasterized,
+ * so the second query of each glyph is served from a warm cache on Wine. */
+static void test_GetGlyphOutline_cache(void)
+{
+    static const UINT formats[] = { GGO_BITMAP, GGO_GRAY2_BITMAP, GGO_GRAY4_BITMAP,
+                                    GGO_GRAY8_BITMAP, GGO_GRAY8_BITMAP | GGO_UNHINTED };
+    static const WCHAR chars[] = { 'A', 'g', '@' };
+    GLYPHMETRICS gm_cold, gm_warm;
+    DWORD size, ret, ret_cold, ret_warm;
+    BYTE *cold, *warm;
+    HFONT hfont, old_hfont;
+    LOGFONTA lf;
+    UINT i, j;
+    HDC hdc;
+
+    if (!is_truetype_font_installed("Tahoma"))
+    {
+        skip("Tahoma is not installed\n");
+        return;
+    }
+
+    hdc = CreateCompatibleDC(0);
+    memset(&lf, 0, sizeof(lf));
+    /* the cache lives as long as the session, use a size earlier runs are unlikely to have used */
+    lf.lfHeight = -(100 + (GetTickCount() + GetCurrentProcessId()) % 300);
+    lstrcpyA(lf.lfFaceName, "Tahoma");
+    hfont = CreateFontIndirectA(&lf);
+    ok(hfont != 0, "CreateFontIndirectA error %lu\n", GetLastError());
+    old_hfont = SelectObject(hdc, hfont);
+
+    for (i = 0; i < ARRAY_SIZE(formats); ++i)
+    {
+        for (j = 0; j < ARRAY_SIZE(chars); ++j)
+        {
+            winetest_push_context("format %#x, char %c", formats[i], chars[j]);
+
+            /* the size query doesn't fill the cache */
+            memset(&gm_cold, 0xab, sizeof(gm_cold));
+            size = GetGlyphOutlineW(hdc, chars[j], formats[i], &gm_cold, 0, NULL, &mat);
+            ok(size != GDI_ERROR && size, "Got size %#lx.\n", size);
+            if (size == GDI_ERROR || !size)
+            {
+                winetest_pop_context();
+                continue;
+            }
+            cold = malloc(size);
+            warm = malloc(size);
+
+            memset(cold, 0xcc, size);
+            ret_cold = GetGlyphOutlineW(hdc, chars[j], formats[i], &gm_warm, size - 1, cold, &mat);
+
+            memset(cold, 0xcc, size);
+            memset(&gm_warm, 0xab, sizeof(gm_warm));
+            ret = GetGlyphOutlineW(hdc, chars[j], formats[i], &gm_warm, size, cold, &mat);
+            ok(ret == size, "Got %#lx, expected %#lx.\n", ret, size);
+            ok(!memcmp(&gm_cold, &gm_warm, sizeof(gm_cold)), "Got different metrics.\n");
+
+            memset(warm, 0xcc, size);
+            memset(&gm_warm, 0xab, sizeof(gm_warm));
+            ret = GetGlyphOutlineW(hdc, chars[j], formats[i], &gm_warm, size, warm, &mat);
+            ok(ret == size, "Got %#lx, expected %#lx.\n", ret, size);
+            ok(!memcmp(&gm_cold, &gm_warm, sizeof(gm_cold)), "Got different metrics.\n");
+            ok(!memcmp(cold, warm, size), "Got different bits.\n");
+
+            memset(&gm_warm, 0xab, sizeof(gm_warm));
+            ret = GetGlyphOutlineW(hdc, chars[j], formats[i], &gm_warm, 0, NULL, &mat);
+            ok(ret == size, "Got %#lx, expected %#lx.\n", ret, size);
+            ok(!memcmp(&gm_cold, &gm_warm, sizeof(gm_cold)), "Got different metrics.\n");
+
+            memset(&gm_warm, 0xab, sizeof(gm_warm));
+            ret = GetGlyphOutlineW(hdc, chars[j], formats[i], &gm_warm, 0, warm, &mat);
+            ok(ret == size, "Got %#lx, expected %#lx.\n", ret, size);
+            ok(!memcmp(&gm_cold, &gm_warm, sizeof(gm_cold)), "Got different metrics.\n");
+            ok(!memcmp(cold, warm, size), "Buffer was modified.\n");
+
+            /* a cached glyph must not be returned into a buffer that is too small */
+            memset(warm, 0xcc, size);
+            ret_warm = GetGlyphOutlineW(hdc, chars[j], formats[i], &gm_warm, size - 1, warm, &mat);
+            ok(ret_warm == ret_cold, "Got %#lx, expected %#lx.\n", ret_warm, ret_cold);
+
+            free(cold);
+            free(warm);
+            winetest_pop_context();
+        }
+    }
+
+    SelectObject(hdc, old_hfont);
+    DeleteObject(hfont);
+    DeleteDC(hdc);
+}
+
 /* bug #9995: there is a limit to the character width that can be specified */
 static void test_GetTextMetrics2(const char *fontname, int font_height)
 {
@@ -7830,6 +7921,7 @@ START_TEST(font)
     test_RealizationInfo();
     test_GetTextFace();
     test_GetGlyphOutline();
+    test_GetGlyphOutline_cache();
     test_GetTextMetrics2("Tahoma", -11);
     test_GetTextMetrics2("Tahoma", -55);
     test_GetTextMetrics2("Tahoma", -110);
@@ -1259,6 +1259,186 @@ static void test_HeapCreate(void)
 }
 
 
+#define LFH_TEST_SIZE  32
+#define LFH_TEST_COUNT 64
+
+struct lfh_thread_params
+{
+    HANDLE ready_event;
+    HANDLE start_event;
+
+    HANDLE heap;
+    void *ptrs[LFH_TEST_COUNT];
+    BOOL alloc;
+};
+
+static DWORD WINAPI lfh_thread_proc( void *arg )
+{
+    struct lfh_thread_params *params = arg;
+    DWORD res;
+    BOOL ret;
+    UINT i;
+
+    /* free the blocks of another thread, or allocate and free some, leaving them in our cache */
+    if (params->alloc)
+    {
+        for (i = 0; i < LFH_TEST_COUNT; i++)
+        {
+            params->ptrs[i] = HeapAlloc( params->heap, 0, LFH_TEST_SIZE );
+            ok( !!params->ptrs[i], "HeapAlloc failed, error %lu\n", GetLastError() );
+        }
+    }
+    for (i = 0; i < LFH_TEST_COUNT; i++)
+    {
+        ret = HeapFree( params->heap, 0, params->ptrs[i] );
+        ok( ret, "HeapFree failed, error %lu\n", GetLastError() );
+    }
+
+    if (params->ready_event)
+    {
+        SetEvent( params->ready_event );
+        res = WaitForSingleObject( params->start_event, INFINITE );
+        ok( !res, "WaitForSingleObject returned %#lx, error %lu\n", res, GetLastError() );
+    }
+
+    return 0;
+}
+
+static HANDLE create_lfh_heap(void)
+{
+    ULONG compat_info;
+    HANDLE heap;
+    void *ptr;
+    BOOL ret;
+    UINT i;
+
+    heap = HeapCreate( 0, 0, 0 );
+    ok( !!heap, "HeapCreate failed, error %lu\n", GetLastError() );
+
+    /* allocation pattern enabling the LFH for the test block size */
+    for (i = 0; i < 0x1000; i++)
+    {
+        ptr = HeapAlloc( heap, 0, LFH_TEST_SIZE );
+        HeapFree( heap, 0, ptr );
+    }
+
+    ret = pHeapQueryInformation( heap, HeapCompatibilityInformation, &compat_info, sizeof(compat_info), NULL );
+    ok( ret, "HeapQueryInformation failed, error %lu\n", GetLastError() );
+    ok( compat_info == 2, "got HeapCompatibilityInformation %lu\n", compat_info );
+
+    return heap;
+}
+
+static void check_lfh_blocks( HANDLE heap )
+{
+    void *ptrs[LFH_TEST_COUNT * 2];
+    UINT i, j;
+    BOOL ret;
+
+    ret = HeapValidate( heap, 0, NULL );
+    ok( ret, "HeapValidate failed\n" );
+
+    for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+    {
+        ptrs[i] = HeapAlloc( heap, 0, LFH_TEST_SIZE );
+        ok( !!ptrs[i], "HeapAlloc failed, error %lu\n", GetLastError() );
+        memset( ptrs[i], i, LFH_TEST_SIZE );
+        for (j = 0; j < i; j++) ok( ptrs[i] != ptrs[j], "%u: got block %p twice\n", i, ptrs[i] );
+    }
+    for (i = 0; i < ARRAY_SIZE(ptrs); i++)
+    {
+        ok( *(BYTE *)ptrs[i] == (BYTE)i, "%u: block %p was overwritten\n", i, ptrs[i] );
+        ret = HeapFree( heap, 0, ptrs[i] );
+        ok( ret, "HeapFree failed, error %lu\n", GetLastError() );
+    }
+}
+
+static void test_lfh_thread_caches(void)
+{
+    struct lfh_thread_params params = {0};
+    HANDLE heap, heap1, thread;
+    void *ptr, *ptr1;
+    DWORD res;
+    BOOL ret;
+    UINT i;
+
+    /* blocks freed from another thread than the allocating one */
+
+    heap = create_lfh_heap();
+    params.heap = heap;
+    for (i = 0; i < LFH_TEST_COUNT; i++)
+    {
+        params.ptrs[i] = HeapAlloc( heap, 0, LFH_TEST_SIZE );
+        ok( !!params.ptrs[i], "HeapAlloc failed, error %lu\n", GetLastError() );
+    }
+    thread = CreateThread( NULL, 0, lfh_thread_proc, &params, 0, NULL );
+    ok( !!thread, "CreateThread failed, error %lu\n", GetLastError() );
+    res = WaitForSingleObject( thread, INFINITE );
+    ok( !res, "WaitForSingleObject returned %#lx, error %lu\n", res, GetLastError() );
+    CloseHandle( thread );
+    check_lfh_blocks( heap );
+
+    /* double free of a block kept in the thread cache */
+
+    ptr = HeapAlloc( heap, 0, LFH_TEST_SIZE );
+    ok( !!ptr, "HeapAlloc failed, error %lu\n", GetLastError() );
+    ret = HeapFree( heap, 0, ptr );
+    ok( ret, "HeapFree failed, error %lu\n", GetLastError() );
+    if (winetest_platform_is_wine) /* heap corruption terminates the process on Windows */
+    {
+        SetLastError( 0xdeadbeef );
+        ret = HeapFree( heap, 0, ptr );
+        ok( !ret, "HeapFree succeeded\n" );
+        ok( GetLastError() == ERROR_INVALID_PARAMETER, "got error %lu\n", GetLastError() );
+    }
+    ptr = HeapAlloc( heap, 0, LFH_TEST_SIZE );
+    ok( !!ptr, "HeapAlloc failed, error %lu\n", GetLastError() );
+    ptr1 = HeapAlloc( heap, 0, LFH_TEST_SIZE );
+    ok( !!ptr1, "HeapAlloc failed, error %lu\n", GetLastError() );
+    ok( ptr != ptr1, "got block %p twice\n", ptr );
+    HeapFree( heap, 0, ptr1 );
+    HeapFree( heap, 0, ptr );
+    check_lfh_blocks( heap );
+
+    /* thread exiting with blocks left in its cache */
+
+    params.alloc = TRUE;
+    thread = CreateThread( NULL, 0, lfh_thread_proc, &params, 0, NULL );
+    ok( !!thread, "CreateThread failed, error %lu\n", GetLastError() );
+    res = WaitForSingleObject( thread, INFINITE );
+    ok( !res, "WaitForSingleObject returned %#lx, error %lu\n", res, GetLastError() );
+    CloseHandle( thread );
+    check_lfh_blocks( heap );
+
+    /* heap destroyed while another thread still has cached blocks */
+
+    params.ready_event = CreateEventW( NULL, FALSE, FALSE, NULL );
+    ok( !!params.ready_event, "CreateEventW failed, error %lu\n", GetLastError() );
+    params.start_event = CreateEventW( NULL, FALSE, FALSE, NULL );
+    ok( !!params.start_event, "CreateEventW failed, error %lu\n", GetLastError() );
+    thread = CreateThread( NULL, 0, lfh_thread_proc, &params, 0, NULL );
+    ok( !!thread, "CreateThread failed, error %lu\n", GetLastError() );
+    res = WaitForSingleObject( params.ready_event, INFINITE );
+    ok( !res, "WaitForSingleObject returned %#lx, error %lu\n", res, GetLastError() );
+
+    ret = HeapDestroy( heap );
+    ok( ret, "HeapDestroy failed, error %lu\n", GetLastError() );
+    heap1 = create_lfh_heap();
+    check_lfh_blocks( heap1 );
+
+    SetEvent( params.start_event );
+    res = WaitForSingleObject( thread, INFINITE );
+    ok( !res, "WaitForSingleObject returned %#lx, error %lu\n", res, GetLastError() );
+    CloseHandle( thread );
+    check_lfh_blocks( heap1 );
+
+    ret = HeapDestroy( heap1 );
+    ok( ret, "HeapDestroy failed, error %lu\n", GetLastError() );
+    CloseHandle( params.start_event );
+    CloseHandle( params.ready_event );
+}
+
+
 struct mem_entry
 {
     UINT_PTR flags;
@@ -3742,6 +3922,7 @@ START_TEST(heap)
     }
 
     test_HeapCreate();
+    test_lfh_thread_caches();
     test_GlobalAlloc();
     test_LocalAlloc();
 
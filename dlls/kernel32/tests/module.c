@@ -1627,6 +1627,53 @@ static void test_ddag_node(void)
     ok( se == node->Dependencies.Tail, "Expected end of the list.\n" );
 }
 
+static void test_module_lookup(void)
+{
+    const IMAGE_EXPORT_DIRECTORY *exports;
+    const DWORD *names, *functions;
+    const WORD *ordinals;
+    LDR_DATA_TABLE_ENTRY *mod;
+    HMODULE module;
+    NTSTATUS status;
+    ULONG i, size, hash;
+    void *proc;
+
+    module = GetModuleHandleW( L"kernel32.dll" );
+    status = LdrFindEntryForAddress( module, &mod );
+    ok( !status, "Got unexpected status %#lx.\n", status );
+
+    if (!mod->DdagNode)
+        win_skip( "Old LDR_DATA_TABLE_ENTRY structure, skipping hash tests.\n" );
+    else
+    {
+        hash = 0;
+        RtlHashUnicodeString( &mod->BaseDllName, TRUE, HASH_STRING_ALGORITHM_X65599, &hash );
+        ok( mod->BaseNameHashValue == hash, "Got hash %#lx, expected %#lx.\n", mod->BaseNameHashValue, hash );
+        ok( mod->HashLinks.Flink->Blink == &mod->HashLinks, "Got unexpected hash links.\n" );
+    }
+
+    ok( GetModuleHandleW( L"KERNEL32.DLL" ) == module, "Got unexpected module.\n" );
+    ok( GetModuleHandleW( mod->FullDllName.Buffer ) == module, "Got unexpected module.\n" );
+
+    /* every named export, looked up by name, matches the export table entry */
+    module = GetModuleHandleW( L"ntdll.dll" );
+    exports = RtlImageDirectoryEntryToData( module, TRUE, IMAGE_DIRECTORY_ENTRY_EXPORT, &size );
+    ok( !!exports, "Got NULL exports.\n" );
+    names = (const DWORD *)((const char *)module + exports->AddressOfNames);
+    ordinals = (const WORD *)((const char *)module + exports->AddressOfNameOrdinals);
+    functions = (const DWORD *)((const char *)module + exports->AddressOfFunctions);
+    for (i = 0; i < exports->NumberOfNames; i++)
+    {
+        const char *name = (const char *)module + names[i];
+
+        if (!functions[ordinals[i]]) continue;
+        proc = (char *)module + functions[ordinals[i]];
+        if ((char *)proc >= (char *)exports && (char *)proc < (char *)exports + size) continue;
+        ok( (void *)GetProcAddress( module, name ) == proc, "Got unexpected address for %s.\n", name );
+    }
+    ok( !GetProcAddress( module, "NtDoesNotExist" ), "Got unexpected address.\n" );
+}
+
 START_TEST(module)
 {
     WCHAR filenameW[MAX_PATH];
@@ -1663,4 +1710,5 @@ START_TEST(module)
     test_LdrGetDllFullName();
     test_apisets();
     test_ddag_node();
+    test_module_lookup();
 }
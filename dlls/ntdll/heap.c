@@ -276,6 +276,43 @@ static inline struct group **bin_get_affinity_group( struct bin *bin, BYTE affin
     return bin->affinity_group_base + affinity * BLOCK_SIZE_BIN_COUNT;
 }
 
+/* per-thread LFH block caches, for the bins of blocks up to BIN_SIZE_MIN_3 */
+
+#define THREAD_CACHE_BIN_COUNT   0x30
+#define THREAD_CACHE_DEPTH       16
+#define THREAD_CACHE_MAX_HEAPS   4
+#define THREAD_CACHE_SLOT_COUNT  0x10000
+#define THREAD_CACHE_SLOT_NONE   0xffff  /* TEB slot of detached threads */
+
+C_ASSERT( BLOCK_BIN_SIZE( THREAD_CACHE_BIN_COUNT - 1 ) == BIN_SIZE_MIN_3 );
+
+/* freed blocks of a bin, still marked as used in their group free_bits */
+struct bin_cache
+{
+    UINT          count;
+    struct block *blocks[THREAD_CACHE_DEPTH];
+    SIZE_T        hits;
+    SIZE_T        misses;
+    SIZE_T        flushed;
+};
+
+/* blocks cached by a thread for a heap, only used by the owning thread */
+struct thread_cache
+{
+    /* list of caches of the same thread, locked via process_heap->cs */
+    struct thread_cache *next;
+    struct heap         *heap;
+    LONG                 serial;  /* heap serial, as heap addresses may be reused */
+    struct bin_cache     bins[THREAD_CACHE_BIN_COUNT];
+};
+
+/* thread cache lists, indexed by TEB LowFragHeapDataSlot, locked via process_heap->cs */
+static struct thread_cache **thread_caches;
+static RTL_BITMAP thread_cache_slots;
+static ULONG thread_cache_slots_bits[THREAD_CACHE_SLOT_COUNT / 32];
+static SIZE_T thread_caches_commit;  /* committed size of the thread_caches array */
+static LONG next_heap_serial;
+
 struct heap
 {                                  /* win32/win64 */
     DWORD_PTR        unknown1[2];   /* 0000/0000 */
@@ -289,6 +326,8 @@ struct heap
     /* end of the Windows 10 compatible struct layout */
 
     LONG             compat_info;   /* HeapCompatibilityInformation / heap frontend type */
+    LONG             serial;        /* Unique heap serial for the thread caches */
+    LONG             cache_flushes; /* Number of thread caches being flushed into the heap */
     struct list      entry;         /* Entry in process heap list */
     struct list      subheap_list;  /* Sub-heap list */
     struct list      large_list;    /* Large blocks list */
@@ -1520,6 +1559,7 @@ HANDLE WINAPI RtlCreateHeap( ULONG flags, void *addr, SIZE_T total_size, SIZE_T
     heap->auto_flags    = (flags & HEAP_GROWABLE);
     heap->flags         = (flags & ~HEAP_SHARED);
     heap->compat_info   = HEAP_STD;
+    heap->serial        = InterlockedIncrement( &next_heap_serial );
     heap->magic         = HEAP_MAGIC;
     heap->grow_size     = HEAP_INITIAL_GROW_SIZE;
     heap->min_size      = commit_size;
@@ -1645,6 +1685,9 @@ HANDLE WINAPI RtlDestroyHeap( HANDLE handle )
     list_remove( &heap->entry );
     RtlLeaveCriticalSection( &process_heap->cs );
 
+    /* wait for the threads which started flushing their caches before the heap was removed */
+    while (ReadAcquire( &heap->cache_flushes )) NtYieldExecution();
+
     heap->cs.DebugInfo->Spare[0] = 0;
     RtlDeleteCriticalSection( &heap->cs );
 
@@ -1887,7 +1930,8 @@ static NTSTATUS heap_release_bin_group( struct heap *heap, ULONG flags, struct b
     return group_release( heap, flags, bin, group );
 }
 
-static struct block *find_free_bin_block( struct heap *heap, ULONG flags, SIZE_T block_size, struct bin *bin )
+static struct block *find_free_bin_block( struct heap *heap, ULONG flags, SIZE_T block_size, struct bin *bin,
+                                          struct bin_cache *cache )
 {
     ULONG affinity = heap_current_thread_affinity();
     struct block *block;
@@ -1901,7 +1945,11 @@ static struct block *find_free_bin_block( struct heap *heap, ULONG flags, SIZE_T
 
     block = group_find_free_block( group, block_size );
 
-    /* serialize with heap_free_block_lfh: atomically set GROUP_FLAG_FREE when the free bits are all 0. */
+    /* refill the thread cache while we own the group, blocks in the cache stay marked as free */
+    while (cache && cache->count < THREAD_CACHE_DEPTH / 2 && ReadNoFence( &group->free_bits ))
+        cache->blocks[cache->count++] = group_find_free_block( group, block_size );
+
+    /* serialize with group_free_block: atomically set GROUP_FLAG_FREE when the free bits are all 0. */
     if (ReadNoFence( &group->free_bits ) || InterlockedCompareExchange( &group->free_bits, GROUP_FLAG_FREE, 0 ))
     {
         /* if GROUP_FLAG_FREE isn't set, thread is responsible for putting it back into group list. */
@@ -1912,10 +1960,182 @@ static struct block *find_free_bin_block( struct heap *heap, ULONG flags, SIZE_T
     return block;
 }
 
+/* check whether a thread cache belongs to a heap which wasn't destroyed, process_heap->cs must be held */
+static BOOL thread_cache_heap_alive( const struct thread_cache *cache )
+{
+    struct heap *heap;
+
+    if (cache->heap == process_heap) return cache->serial == process_heap->serial;
+    LIST_FOR_EACH_ENTRY( heap, &process_heap->entry, struct heap, entry )
+        if (heap == cache->heap) return cache->serial == heap->serial;
+    return FALSE;
+}
+
+/* return a freed LFH block to its group */
+static NTSTATUS group_free_block( struct heap *heap, ULONG flags, struct bin *bin, struct block *block )
+{
+    struct group *group = block_get_group( block );
+    SIZE_T i = block_get_group_index( block );
+
+    /* if this was the last used block in a group and GROUP_FLAG_FREE was set */
+    if (InterlockedOr( &group->free_bits, 1 << i ) == ~(1 << i))
+    {
+        /* thread now owns the group, and can release it to its bin */
+        group->free_bits = ~GROUP_FLAG_FREE;
+        return heap_release_bin_group( heap, flags, bin, group );
+    }
+
+    return STATUS_SUCCESS;
+}
+
+/* return the oldest cached blocks of a bin to their groups */
+static void bin_cache_flush( struct heap *heap, ULONG flags, struct bin *bin, struct bin_cache *cache, UINT count )
+{
+    UINT i;
+
+    for (i = 0; i < count; ++i) group_free_block( heap, flags, bin, cache->blocks[i] );
+    memmove( cache->blocks, cache->blocks + count, (cache->count - count) * sizeof(*cache->blocks) );
+    cache->count -= count;
+    cache->flushed += count;
+}
+
+/* unlink a thread cache from its thread list, and prepare it for flushing, process_heap->cs must be held
+ *
+ * The caches are flushed outside of process_heap->cs, as releasing groups takes the heap locks, and
+ * RtlDestroyHeap waits for the pending flushes after removing the heap from the process heap list.
+ */
+static void thread_cache_detach( struct thread_cache *cache )
+{
+    if (!thread_cache_heap_alive( cache )) cache->heap = NULL;
+    else InterlockedIncrement( &cache->heap->cache_flushes );
+}
+
+/* flush all the blocks of a detached thread cache */
+static void thread_cache_flush( struct thread_cache *cache )
+{
+    struct heap *heap = cache->heap;
+    UINT i;
+
+    if (!heap) return;
+
+    for (i = 0; i < THREAD_CACHE_BIN_COUNT; ++i)
+    {
+        struct bin_cache *bin_cache = cache->bins + i;
+
+        bin_cache_flush( heap, heap->flags, heap->bins + i, bin_cache, bin_cache->count );
+        if (bin_cache->hits || bin_cache->misses)
+            TRACE( "heap %p, bin %#x, block size %#Ix, hits %Iu, misses %Iu, flushed %Iu\n", heap, i,
+                   (SIZE_T)BLOCK_BIN_SIZE( i ), bin_cache->hits, bin_cache->misses, bin_cache->flushed );
+    }
+
+    InterlockedDecrement( &heap->cache_flushes );
+}
+
+/* make sure the thread_caches entry of a slot is committed, process_heap->cs must be held */
+static BOOL thread_caches_commit_slot( USHORT slot )
+{
+    SIZE_T size = (slot + 1) * sizeof(*thread_caches);
+    void *addr;
+
+    if (!thread_caches)
+    {
+        size = THREAD_CACHE_SLOT_COUNT * sizeof(*thread_caches);
+        if (NtAllocateVirtualMemory( NtCurrentProcess(), (void **)&thread_caches, 0, &size,
+                                     MEM_RESERVE, PAGE_READWRITE ))
+            return FALSE;
+        size = (slot + 1) * sizeof(*thread_caches);
+    }
+    if (size <= thread_caches_commit) return TRUE;
+
+    addr = (char *)thread_caches + thread_caches_commit;
+    size -= thread_caches_commit;
+    if (NtAllocateVirtualMemory( NtCurrentProcess(), &addr, 0, &size, MEM_COMMIT, PAGE_READWRITE ))
+        return FALSE;
+    thread_caches_commit = (char *)addr + size - (char *)thread_caches;
+    return TRUE;
+}
+
+/* allocate a thread cache for the current thread and a heap */
+static struct thread_cache *heap_create_thread_cache( struct heap *heap )
+{
+    USHORT slot = NtCurrentTeb()->LowFragHeapDataSlot;
+    struct thread_cache *cache = NULL, *tmp, **prev;
+    UINT count = 0;
+
+    RtlEnterCriticalSection( &process_heap->cs );
+
+    if (!thread_cache_slots.Buffer)
+    {
+        RtlInitializeBitMap( &thread_cache_slots, thread_cache_slots_bits, THREAD_CACHE_SLOT_COUNT );
+        RtlSetBits( &thread_cache_slots, 0, 1 );
+        RtlSetBits( &thread_cache_slots, THREAD_CACHE_SLOT_NONE, 1 );
+    }
+
+    if (!slot)
+    {
+        if ((slot = RtlFindClearBitsAndSet( &thread_cache_slots, 1, 1 )) == (USHORT)~0) goto failed;
+        if (!thread_caches_commit_slot( slot ))
+        {
+            RtlClearBits( &thread_cache_slots, slot, 1 );
+            goto failed;
+        }
+        NtCurrentTeb()->LowFragHeapDataSlot = slot;
+    }
+
+    /* reuse the cache of a destroyed heap, or flush the least recently created one */
+    for (prev = &thread_caches[slot]; (tmp = *prev); prev = &tmp->next, count++)
+    {
+        if (!thread_cache_heap_alive( tmp ) || (count + 1 >= THREAD_CACHE_MAX_HEAPS && !tmp->next))
+        {
+            thread_cache_detach( tmp );
+            *prev = tmp->next;
+            cache = tmp;
+            break;
+        }
+    }
+
+    RtlLeaveCriticalSection( &process_heap->cs );
+
+    if (cache) thread_cache_flush( cache );
+    else if (!(cache = RtlAllocateHeap( process_heap, 0, sizeof(*cache) ))) return NULL;
+
+    memset( cache, 0, sizeof(*cache) );
+    cache->heap = heap;
+    cache->serial = heap->serial;
+
+    RtlEnterCriticalSection( &process_heap->cs );
+    cache->next = thread_caches[slot];
+    thread_caches[slot] = cache;
+    RtlLeaveCriticalSection( &process_heap->cs );
+    return cache;
+
+failed:
+    RtlLeaveCriticalSection( &process_heap->cs );
+    return NULL;
+}
+
+/* lookup the current thread cache of a bin, if the bin is cached */
+static inline struct bin_cache *heap_get_bin_cache( struct heap *heap, struct bin *bin )
+{
+    SIZE_T index = bin - heap->bins;
+    struct thread_cache *cache;
+    USHORT slot;
+
+    if (index >= THREAD_CACHE_BIN_COUNT) return NULL;
+    if ((slot = NtCurrentTeb()->LowFragHeapDataSlot) == THREAD_CACHE_SLOT_NONE) return NULL;
+
+    for (cache = slot ? thread_caches[slot] : NULL; cache; cache = cache->next)
+        if (cache->heap == heap && cache->serial == heap->serial) break;
+
+    if (!cache && !(cache = heap_create_thread_cache( heap ))) return NULL;
+    return cache->bins + index;
+}
+
 static NTSTATUS heap_allocate_block_lfh( struct heap *heap, ULONG flags, SIZE_T block_size,
                                          SIZE_T size, void **ret )
 {
     struct bin *bin, *last = heap->bins + BLOCK_SIZE_BIN_COUNT - 1;
+    struct bin_cache *cache;
     struct block *block;
 
     bin = heap->bins + BLOCK_SIZE_BIN( block_size );
@@ -1926,7 +2146,18 @@ static NTSTATUS heap_allocate_block_lfh( struct heap *heap, ULONG flags, SIZE_T
 
     block_size = BLOCK_BIN_SIZE( BLOCK_SIZE_BIN( block_size ) );
 
-    if ((block = find_free_bin_block( heap, flags, block_size, bin )))
+    if ((cache = heap_get_bin_cache( heap, bin )) && cache->count)
+    {
+        block = cache->blocks[--cache->count];
+        cache->hits++;
+    }
+    else
+    {
+        if (cache) cache->misses++;
+        block = find_free_bin_block( heap, flags, block_size, bin, cache );
+    }
+
+    if (block)
     {
         block_set_type( block, BLOCK_TYPE_USED );
         block_set_flags( block, (BYTE)~BLOCK_FLAG_LFH, BLOCK_USER_FLAGS( flags ) );
@@ -1942,30 +2173,26 @@ static NTSTATUS heap_allocate_block_lfh( struct heap *heap, ULONG flags, SIZE_T
 static NTSTATUS heap_free_block_lfh( struct heap *heap, ULONG flags, struct block *block )
 {
     struct bin *bin, *last = heap->bins + BLOCK_SIZE_BIN_COUNT - 1;
-    SIZE_T i, block_size = block_get_size( block );
-    struct group *group = block_get_group( block );
-    NTSTATUS status = STATUS_SUCCESS;
+    SIZE_T block_size = block_get_size( block );
+    struct bin_cache *cache;
 
     if (!(block_get_flags( block ) & BLOCK_FLAG_LFH)) return STATUS_UNSUCCESSFUL;
 
     bin = heap->bins + BLOCK_SIZE_BIN( block_size );
     if (bin == last) return STATUS_UNSUCCESSFUL;
 
-    i = block_get_group_index( block );
     valgrind_make_writable( block, sizeof(*block) );
     block_set_type( block, BLOCK_TYPE_FREE );
     block_set_flags( block, (BYTE)~BLOCK_FLAG_LFH, BLOCK_FLAG_FREE );
     mark_block_free( block + 1, (char *)block + block_size - (char *)(block + 1), flags );
 
-    /* if this was the last used block in a group and GROUP_FLAG_FREE was set */
-    if (InterlockedOr( &group->free_bits, 1 << i ) == ~(1 << i))
-    {
-        /* thread now owns the group, and can release it to its bin */
-        group->free_bits = ~GROUP_FLAG_FREE;
-        status = heap_release_bin_group( heap, flags, bin, group );
-    }
-
-    return status;
+    /* keep the block in the thread cache, blocks freed by other threads than the group
+     * owner are returned in batches when the cache is full.
+     */
+    if (!(cache = heap_get_bin_cache( heap, bin ))) return group_free_block( heap, flags, bin, block );
+    if (cache->count == THREAD_CACHE_DEPTH) bin_cache_flush( heap, flags, bin, cache, THREAD_CACHE_DEPTH / 2 );
+    cache->blocks[cache->count++] = block;
+    return STATUS_SUCCESS;
 }
 
 static void bin_try_enable( struct heap *heap, struct bin *bin )
@@ -2012,10 +2239,35 @@ static void heap_thread_detach_bin_groups( struct heap *heap )
     }
 }
 
+static void heap_thread_detach_caches(void)
+{
+    USHORT slot = NtCurrentTeb()->LowFragHeapDataSlot;
+    struct thread_cache *cache, *next;
+
+    NtCurrentTeb()->LowFragHeapDataSlot = THREAD_CACHE_SLOT_NONE;
+    if (!slot || slot == THREAD_CACHE_SLOT_NONE) return;
+
+    RtlEnterCriticalSection( &process_heap->cs );
+    cache = thread_caches[slot];
+    thread_caches[slot] = NULL;
+    for (next = cache; next; next = next->next) thread_cache_detach( next );
+    RtlClearBits( &thread_cache_slots, slot, 1 );
+    RtlLeaveCriticalSection( &process_heap->cs );
+
+    for (; cache; cache = next)
+    {
+        next = cache->next;
+        thread_cache_flush( cache );
+        RtlFreeHeap( process_heap, 0, cache );
+    }
+}
+
 void heap_thread_detach(void)
 {
     struct heap *heap;
 
+    heap_thread_detach_caches();
+
     RtlEnterCriticalSection( &process_heap->cs );
 
     LIST_FOR_EACH_ENTRY( heap, &process_heap->entry, struct heap, entry )
@@ -135,8 +135,20 @@ typedef struct _wine_modref
     struct file_id        id;
     ULONG                 CheckSum;
     BOOL                  system;
+    struct list           base_entry;      /* entry in module_base_hash */
+    struct list           fullname_entry;  /* entry in module_fullname_hash */
+    struct list           fileid_entry;    /* entry in module_fileid_hash */
+    DWORD                *export_hash;     /* export name indices + 1, built on first lookup */
+    DWORD                 export_hash_mask;
 } WINE_MODREF;
 
+/* module lookup tables, locked via loader_section, basename uses the LDR_DATA_TABLE_ENTRY HashLinks */
+#define MODULE_HASH_SIZE 64
+static LIST_ENTRY module_basename_hash[MODULE_HASH_SIZE];
+static struct list module_fullname_hash[MODULE_HASH_SIZE];
+static struct list module_fileid_hash[MODULE_HASH_SIZE];
+static struct list module_base_hash[MODULE_HASH_SIZE];
+
 static UINT tls_module_count;      /* number of modules with TLS directory */
 static IMAGE_TLS_DIRECTORY *tls_dirs;  /* array of TLS directories */
 static LIST_ENTRY tls_links = { &tls_links, &tls_links };
@@ -557,6 +569,83 @@ static void call_ldr_notifications( ULONG reason, LDR_DATA_TABLE_ENTRY *module )
     }
 }
 
+/*************************************************************************
+ *		init_module_hash_tables
+ */
+static void init_module_hash_tables(void)
+{
+    UINT i;
+
+    for (i = 0; i < MODULE_HASH_SIZE; i++)
+    {
+        InitializeListHead( &module_basename_hash[i] );
+        list_init( &module_fullname_hash[i] );
+        list_init( &module_fileid_hash[i] );
+        list_init( &module_base_hash[i] );
+    }
+}
+
+static inline ULONG hash_module_name( const UNICODE_STRING *name )
+{
+    ULONG hash = 0;
+    RtlHashUnicodeString( name, TRUE, HASH_STRING_ALGORITHM_X65599, &hash );
+    return hash;
+}
+
+static inline ULONG hash_module_base( const void *base )
+{
+    ULONG_PTR val = (ULONG_PTR)base >> 16;
+    return (ULONG)(val ^ (val >> 6)) % MODULE_HASH_SIZE;
+}
+
+static inline ULONG hash_file_id( const struct file_id *id )
+{
+    ULONG i, hash = 0;
+    for (i = 0; i < sizeof(id->ObjectId); i++) hash = hash * 31 + id->ObjectId[i];
+    return hash % MODULE_HASH_SIZE;
+}
+
+/*************************************************************************
+ *		insert_module_hash
+ *
+ * Add a module to the lookup tables, in load order within each bucket.
+ * The loader_section must be locked while calling this function.
+ */
+static void insert_module_hash( WINE_MODREF *wm )
+{
+    wm->ldr.BaseNameHashValue = hash_module_name( &wm->ldr.BaseDllName );
+    InsertTailList( &module_basename_hash[wm->ldr.BaseNameHashValue % MODULE_HASH_SIZE], &wm->ldr.HashLinks );
+    list_add_tail( &module_fullname_hash[hash_module_name( &wm->ldr.FullDllName ) % MODULE_HASH_SIZE],
+                   &wm->fullname_entry );
+    list_add_tail( &module_fileid_hash[hash_file_id( &wm->id )], &wm->fileid_entry );
+    list_add_tail( &module_base_hash[hash_module_base( wm->ldr.DllBase )], &wm->base_entry );
+}
+
+/*************************************************************************
+ *		remove_module_hash
+ *
+ * The loader_section must be locked while calling this function.
+ */
+static void remove_module_hash( WINE_MODREF *wm )
+{
+    RemoveEntryList( &wm->ldr.HashLinks );
+    list_remove( &wm->fullname_entry );
+    list_remove( &wm->fileid_entry );
+    list_remove( &wm->base_entry );
+}
+
+/*************************************************************************
+ *		set_module_file_id
+ *
+ * The loader_section must be locked while calling this function.
+ */
+static void set_module_file_id( WINE_MODREF *wm, const struct file_id *id )
+{
+    wm->id = *id;
+    list_remove( &wm->fileid_entry );
+    list_add_tail( &module_fileid_hash[hash_file_id( id )], &wm->fileid_entry );
+}
+
 /*************************************************************************
  *		get_modref
  *
@@ -565,18 +654,12 @@ static void call_ldr_notifications( ULONG reason, LDR_DATA_TABLE_ENTRY *module )
  */
 static WINE_MODREF *get_modref( HMODULE hmod )
 {
-    PLIST_ENTRY mark, entry;
-    PLDR_DATA_TABLE_ENTRY mod;
+    WINE_MODREF *wm;
 
     if (cached_modref && cached_modref->ldr.DllBase == hmod) return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
-    {
-        mod = CONTAINING_RECORD(entry, LDR_DATA_TABLE_ENTRY, InMemoryOrderLinks);
-        if (mod->DllBase == hmod)
-            return cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
-    }
+    LIST_FOR_EACH_ENTRY( wm, &module_base_hash[hash_module_base( hmod )], WINE_MODREF, base_entry )
+        if (wm->ldr.DllBase == hmod) return cached_modref = wm;
     return NULL;
 }
 
@@ -591,19 +674,22 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
 {
     PLIST_ENTRY mark, entry;
     UNICODE_STRING name_str;
+    ULONG hash;
 
     RtlInitUnicodeString( &name_str, name );
 
     if (cached_modref && RtlEqualUnicodeString( &name_str, &cached_modref->ldr.BaseDllName, TRUE ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
+    hash = hash_module_name( &name_str );
+    mark = &module_basename_hash[hash % MODULE_HASH_SIZE];
     for (entry = mark->Flink; entry != mark; entry = entry->Flink)
     {
-        WINE_MODREF *mod = CONTAINING_RECORD(entry, WINE_MODREF, ldr.InLoadOrderLinks);
-        if (RtlEqualUnicodeString( &name_str, &mod->ldr.BaseDllName, TRUE ) && !mod->system)
+        WINE_MODREF *mod = CONTAINING_RECORD(entry, WINE_MODREF, ldr.HashLinks);
+        if (mod->ldr.BaseNameHashValue == hash && !mod->system &&
+            RtlEqualUnicodeString( &name_str, &mod->ldr.BaseDllName, TRUE ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = mod;
             return cached_modref;
         }
     }
@@ -619,8 +705,8 @@ static WINE_MODREF *find_basename_module( LPCWSTR name )
  */
 static WINE_MODREF *find_fullname_module( const UNICODE_STRING *nt_name )
 {
-    PLIST_ENTRY mark, entry;
     UNICODE_STRING name = *nt_name;
+    WINE_MODREF *wm;
 
     if (name.Length <= 4 * sizeof(WCHAR)) return NULL;
     name.Length -= 4 * sizeof(WCHAR);  /* for \??\ prefix */
@@ -629,13 +715,12 @@ static WINE_MODREF *find_fullname_module( const UNICODE_STRING *nt_name )
     if (cached_modref && RtlEqualUnicodeString( &name, &cached_modref->ldr.FullDllName, TRUE ))
         return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
+    LIST_FOR_EACH_ENTRY( wm, &module_fullname_hash[hash_module_name( &name ) % MODULE_HASH_SIZE],
+                         WINE_MODREF, fullname_entry )
     {
-        LDR_DATA_TABLE_ENTRY *mod = CONTAINING_RECORD(entry, LDR_DATA_TABLE_ENTRY, InLoadOrderLinks);
-        if (RtlEqualUnicodeString( &name, &mod->FullDllName, TRUE ))
+        if (RtlEqualUnicodeString( &name, &wm->ldr.FullDllName, TRUE ))
         {
-            cached_modref = CONTAINING_RECORD(mod, WINE_MODREF, ldr);
+            cached_modref = wm;
             return cached_modref;
         }
     }
@@ -651,16 +736,12 @@ static WINE_MODREF *find_fullname_module( const UNICODE_STRING *nt_name )
  */
 static WINE_MODREF *find_fileid_module( const struct file_id *id )
 {
-    LIST_ENTRY *mark, *entry;
+    WINE_MODREF *wm;
 
     if (cached_modref && !memcmp( &cached_modref->id, id, sizeof(*id) )) return cached_modref;
 
-    mark = &NtCurrentTeb()->Peb->LdrData->InLoadOrderModuleList;
-    for (entry = mark->Flink; entry != mark; entry = entry->Flink)
+    LIST_FOR_EACH_ENTRY( wm, &module_fileid_hash[hash_file_id( id )], WINE_MODREF, fileid_entry )
     {
-        LDR_DATA_TABLE_ENTRY *mod = CONTAINING_RECORD( entry, LDR_DATA_TABLE_ENTRY, InLoadOrderLinks );
-        WINE_MODREF *wm = CONTAINING_RECORD( mod, WINE_MODREF, ldr );
-
         if (!memcmp( &wm->id, id, sizeof(*id) ))
         {
             cached_modref = wm;
@@ -1039,6 +1120,62 @@ static int find_name_in_exports( HMODULE module, const IMAGE_EXPORT_DIRECTORY *e
 }
 
 
+static inline DWORD hash_export_name( const char *name )
+{
+    DWORD hash = 0x811c9dc5;
+    while (*name) hash = (hash ^ (BYTE)*name++) * 0x01000193;
+    return hash;
+}
+
+/*************************************************************************
+ *		build_export_hash
+ *
+ * Build the export name hash table of a module.
+ * The loader_section must be locked while calling this function.
+ */
+static BOOL build_export_hash( WINE_MODREF *wm, const IMAGE_EXPORT_DIRECTORY *exports )
+{
+    const DWORD *names = get_rva( wm->ldr.DllBase, exports->AddressOfNames );
+    DWORD i, pos, size = 16;
+
+    while (size < exports->NumberOfNames * 2) size *= 2;
+    if (!(wm->export_hash = RtlAllocateHeap( GetProcessHeap(), HEAP_ZERO_MEMORY, size * sizeof(DWORD) )))
+        return FALSE;
+    wm->export_hash_mask = size - 1;
+
+    for (i = 0; i < exports->NumberOfNames; i++)
+    {
+        pos = hash_export_name( get_rva( wm->ldr.DllBase, names[i] ) ) & wm->export_hash_mask;
+        while (wm->export_hash[pos]) pos = (pos + 1) & wm->export_hash_mask;
+        wm->export_hash[pos] = i + 1;
+    }
+    return TRUE;
+}
+
+/*************************************************************************
+ *		find_name_in_export_hash
+ *
+ * Helper for find_named_export, falls back to a binary search when the hash table can't be built.
+ * The loader_section must be locked while calling this function.
+ */
+static int find_name_in_export_hash( WINE_MODREF *wm, const IMAGE_EXPORT_DIRECTORY *exports, const char *name )
+{
+    const WORD *ordinals = get_rva( wm->ldr.DllBase, exports->AddressOfNameOrdinals );
+    const DWORD *names = get_rva( wm->ldr.DllBase, exports->AddressOfNames );
+    DWORD pos, index;
+
+    if (!wm->export_hash && !build_export_hash( wm, exports ))
+        return find_name_in_exports( wm->ldr.DllBase, exports, name );
+
+    pos = hash_export_name( name ) & wm->export_hash_mask;
+    while ((index = wm->export_hash[pos]))
+    {
+        if (!strcmp( get_rva( wm->ldr.DllBase, names[index - 1] ), name )) return ordinals[index - 1];
+        pos = (pos + 1) & wm->export_hash_mask;
+    }
+    return -1;
+}
+
 /*************************************************************************
  *		find_named_export
  *
@@ -1050,6 +1187,7 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
 {
     const WORD *ordinals = get_rva( module, exports->AddressOfNameOrdinals );
     const DWORD *names = get_rva( module, exports->AddressOfNames );
+    WINE_MODREF *wm;
     int ordinal;
 
     /* first check the hint */
@@ -1060,8 +1198,10 @@ static FARPROC find_named_export( HMODULE module, const IMAGE_EXPORT_DIRECTORY *
             return find_ordinal_export( module, exports, exp_size, ordinals[hint], load_path );
     }
 
-    /* then do a binary search */
-    if ((ordinal = find_name_in_exports( module, exports, name )) == -1) return NULL;
+    /* then use the module hash table, or do a binary search */
+    if ((wm = get_modref( module ))) ordinal = find_name_in_export_hash( wm, exports, name );
+    else ordinal = find_name_in_exports( module, exports, name );
+    if (ordinal == -1) return NULL;
     return find_ordinal_export( module, exports, exp_size, ordinal, load_path );
 
 }
@@ -1546,6 +1686,7 @@ static WINE_MODREF *alloc_module( HMODULE hModule, const UNICODE_STRING *nt_name
                    &wm->ldr.InLoadOrderLinks);
     InsertTailList(&NtCurrentTeb()->Peb->LdrData->InMemoryOrderModuleList,
                    &wm->ldr.InMemoryOrderLinks);
+    insert_module_hash( wm );
     /* wait until init is called for inserting into InInitializationOrderModuleList */
 
     if (!(nt->OptionalHeader.DllCharacteristics & IMAGE_DLLCHARACTERISTICS_NX_COMPAT))
@@ -2222,7 +2363,7 @@ static NTSTATUS build_module( LPCWSTR load_path, const UNICODE_STRING *nt_name,
 
     if (!(wm = alloc_module( *module, nt_name, is_builtin ))) return STATUS_NO_MEMORY;
 
-    if (id) wm->id = *id;
+    if (id) set_module_file_id( wm, id );
     if (image_info->LoaderFlags) wm->ldr.Flags |= LDR_COR_IMAGE;
     if (image_info->ComPlusILOnly) wm->ldr.Flags |= LDR_COR_ILONLY;
     wm->system = system;
@@ -2244,6 +2385,7 @@ static NTSTATUS build_module( LPCWSTR load_path, const UNICODE_STRING *nt_name,
             /* the module has only be inserted in the load & memory order lists */
             RemoveEntryList(&wm->ldr.InLoadOrderLinks);
             RemoveEntryList(&wm->ldr.InMemoryOrderLinks);
+            remove_module_hash( wm );
 
             /* FIXME: there are several more dangling references
              * left. Including dlls loaded by this dll before the
@@ -3907,6 +4049,7 @@ static void free_modref( WINE_MODREF *wm )
 
     RemoveEntryList(&wm->ldr.InLoadOrderLinks);
     RemoveEntryList(&wm->ldr.InMemoryOrderLinks);
+    remove_module_hash( wm );
     if (wm->ldr.InInitializationOrderLinks.Flink)
         RemoveEntryList(&wm->ldr.InInitializationOrderLinks);
 
@@ -3939,6 +4082,7 @@ static void free_modref( WINE_MODREF *wm )
     NtUnmapViewOfSection( NtCurrentProcess(), wm->ldr.DllBase );
     if (cached_modref == wm) cached_modref = NULL;
     RtlFreeUnicodeString( &wm->ldr.FullDllName );
+    RtlFreeHeap( GetProcessHeap(), 0, wm->export_hash );
     RtlFreeHeap( GetProcessHeap(), 0, wm );
 }
 
@@ -4345,6 +4489,7 @@ void loader_init( CONTEXT *context, void **entry )
         /* TLS index 0 is always reserved, and wow64 reserves extra TLS entries */
         RtlSetBits( peb->TlsBitmap, 0, NtCurrentTeb()->WowTebOffset ? WOW64_TLS_MAX_NUMBER : 1 );
         RtlSetBits( peb->TlsBitmap, NTDLL_TLS_ERRNO, 1 );
+        init_module_hash_tables();
 
         init_user_process_params();
         load_global_options();
@@ -5891,6 +5891,99 @@ static void test_reparse_points(void)
     CloseHandle( handle );
 }
 
+/* Directories that haven't been modified for two seconds have their contents cached on Wine,
+ * wait for that so that the following lookups go through the cache. */
+static void wait_lookup_cache( const char *dir, const char *name )
+{
+    char path[MAX_PATH];
+    DWORD attrs;
+
+    Sleep( 2500 );
+    sprintf( path, "%s\\%s", dir, name );
+    nt_get_file_attrs( path, &attrs );
+}
+
+static void check_lookup_( int line, const char *dir, const char *name, NTSTATUS expect )
+{
+    char path[MAX_PATH];
+    NTSTATUS status;
+    DWORD attrs;
+
+    sprintf( path, "%s\\%s", dir, name );
+    status = nt_get_file_attrs( path, &attrs );
+    ok_(__FILE__, line)( status == expect, "%s: got %#lx, expected %#lx\n", name, status, expect );
+}
+
+#define check_lookup(a, b, c) check_lookup_( __LINE__, a, b, c )
+
+static void create_lookup_file( const char *dir, const char *name )
+{
+    char path[MAX_PATH];
+    HANDLE handle;
+
+    sprintf( path, "%s\\%s", dir, name );
+    handle = CreateFileA( path, GENERIC_WRITE, 0, NULL, CREATE_NEW, 0, 0 );
+    ok( handle != INVALID_HANDLE_VALUE, "failed to create %s, error %lu\n", name, GetLastError() );
+    CloseHandle( handle );
+}
+
+static void test_case_insensitive_lookup(void)
+{
+    char dir[MAX_PATH], path[MAX_PATH], path2[MAX_PATH];
+    BOOL ret;
+
+    GetTempPathA( MAX_PATH, dir );
+    strcat( dir, "ntlookupcache" );
+    ret = CreateDirectoryA( dir, NULL );
+    ok( ret, "failed to create directory, error %lu\n", GetLastError() );
+    create_lookup_file( dir, "MixedCase.txt" );
+
+    /* a failed lookup followed by creating the file */
+    wait_lookup_cache( dir, "mixedcase.txt" );
+    check_lookup( dir, "MIXEDCASE.TXT", STATUS_SUCCESS );
+    check_lookup( dir, "later.txt", STATUS_OBJECT_NAME_NOT_FOUND );
+    check_lookup( dir, "LATER.TXT", STATUS_OBJECT_NAME_NOT_FOUND );
+    create_lookup_file( dir, "Later.txt" );
+    check_lookup( dir, "later.txt", STATUS_SUCCESS );
+    check_lookup( dir, "LATER.TXT", STATUS_SUCCESS );
+    check_lookup( dir, "mixedcase.TXT", STATUS_SUCCESS );
+
+    /* deleting a file */
+    wait_lookup_cache( dir, "later.txt" );
+    check_lookup( dir, "LATER.txt", STATUS_SUCCESS );
+    sprintf( path, "%s\\Later.txt", dir );
+    ret = DeleteFileA( path );
+    ok( ret, "failed to delete file, error %lu\n", GetLastError() );
+    check_lookup( dir, "later.txt", STATUS_OBJECT_NAME_NOT_FOUND );
+    check_lookup( dir, "LATER.TXT", STATUS_OBJECT_NAME_NOT_FOUND );
+    check_lookup( dir, "mixedcase.txt", STATUS_SUCCESS );
+
+    /* renaming a file */
+    wait_lookup_cache( dir, "mixedcase.txt" );
+    check_lookup( dir, "MIXEDCASE.txt", STATUS_SUCCESS );
+    sprintf( path, "%s\\MixedCase.txt", dir );
+    sprintf( path2, "%s\\Renamed.txt", dir );
+    ret = MoveFileA( path, path2 );
+    ok( ret, "failed to rename file, error %lu\n", GetLastError() );
+    check_lookup( dir, "mixedcase.txt", STATUS_OBJECT_NAME_NOT_FOUND );
+    check_lookup( dir, "renamed.txt", STATUS_SUCCESS );
+    check_lookup( dir, "RENAMED.TXT", STATUS_SUCCESS );
+
+    /* renaming a file to a name only differing by case */
+    wait_lookup_cache( dir, "renamed.txt" );
+    check_lookup( dir, "Renamed.TXT", STATUS_SUCCESS );
+    sprintf( path, "%s\\RENAMED.TXT", dir );
+    ret = MoveFileA( path2, path );
+    ok( ret, "failed to rename file, error %lu\n", GetLastError() );
+    check_lookup( dir, "renamed.txt", STATUS_SUCCESS );
+    check_lookup( dir, "Renamed.txt", STATUS_SUCCESS );
+
+    ret = DeleteFileA( path );
+    ok( ret, "failed to delete file, error %lu\n", GetLastError() );
+    ret = RemoveDirectoryA( dir );
+    ok( ret, "failed to remove directory, error %lu\n", GetLastError() );
+}
+
 START_TEST(file)
 {
     HMODULE hkernel32 = GetModuleHandleA("kernel32.dll");
@@ -5971,4 +6064,5 @@ START_TEST(file)
     test_flush_buffers_file();
     test_mailslot_name();
     test_reparse_points();
+    test_case_insensitive_lookup();
 }
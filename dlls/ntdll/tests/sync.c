@@ -27,11 +27,14 @@
 #include "wine/test.h"
 
 static NTSTATUS (WINAPI *pNtAlertThreadByThreadId)( HANDLE );
+static NTSTATUS (WINAPI *pNtAssociateWaitCompletionPacket)( HANDLE, HANDLE, HANDLE, void *, void *, NTSTATUS, ULONG_PTR, BOOLEAN * );
+static NTSTATUS (WINAPI *pNtCancelWaitCompletionPacket)( HANDLE, BOOLEAN );
 static NTSTATUS (WINAPI *pNtClose)( HANDLE );
 static NTSTATUS (WINAPI *pNtCreateEvent) ( PHANDLE, ACCESS_MASK, const OBJECT_ATTRIBUTES *, EVENT_TYPE, BOOLEAN);
 static NTSTATUS (WINAPI *pNtCreateKeyedEvent)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES *, ULONG );
 static NTSTATUS (WINAPI *pNtCreateMutant)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES *, BOOLEAN );
 static NTSTATUS (WINAPI *pNtCreateSemaphore)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES *, LONG, LONG );
+static NTSTATUS (WINAPI *pNtCreateWaitCompletionPacket)( HANDLE *, ACCESS_MASK, OBJECT_ATTRIBUTES * );
 static NTSTATUS (WINAPI *pNtOpenEvent)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES * );
 static NTSTATUS (WINAPI *pNtOpenKeyedEvent)( HANDLE *, ACCESS_MASK, const OBJECT_ATTRIBUTES * );
 static NTSTATUS (WINAPI *pNtPulseEvent)( HANDLE, LONG * );
@@ -529,6 +532,239 @@ static void test_semaphore(void)
     NtClose( semaphore );
 }
 
+struct contention_params
+{
+    HANDLE object;
+    HANDLE event;
+    LONG *inside;
+    LONG count;
+};
+
+static DWORD WINAPI mutant_contention_thread( void *arg )
+{
+    struct contention_params *params = arg;
+    MUTANT_BASIC_INFORMATION info;
+    HANDLE handles[2];
+    NTSTATUS status;
+    DWORD ret;
+    LONG i;
+
+    handles[0] = params->object;
+    handles[1] = params->event;
+    for (i = 0; i < 500; i++)
+    {
+        /* mix client waits with server waits on the same mutant */
+        if (i % 2) ret = WaitForSingleObject( params->object, 5000 );
+        else ret = WaitForMultipleObjects( 2, handles, FALSE, 5000 );
+        ok( ret == WAIT_OBJECT_0, "wait failed %08lx\n", ret );
+        if (ret) break;
+
+        ok( InterlockedIncrement( params->inside ) == 1, "mutant owned by several threads\n" );
+        status = pNtQueryMutant( params->object, MutantBasicInformation, &info, sizeof(info), NULL );
+        ok( status == STATUS_SUCCESS, "NtQueryMutant failed %08lx\n", status );
+        ok( info.OwnedByCaller == TRUE, "expected TRUE, got %d\n", info.OwnedByCaller );
+        ok( info.CurrentCount == 0, "expected 0, got %ld\n", info.CurrentCount );
+        InterlockedIncrement( &params->count );
+        InterlockedDecrement( params->inside );
+
+        status = pNtReleaseMutant( params->object, NULL );
+        ok( status == STATUS_SUCCESS, "NtReleaseMutant failed %08lx\n", status );
+    }
+    return 0;
+}
+
+/* wait on the object, either on the client side or through the server */
+static DWORD WINAPI wait_contention_thread( void *arg )
+{
+    struct contention_params *params = arg;
+    HANDLE handles[2];
+    DWORD ret;
+
+    handles[0] = params->object;
+    handles[1] = params->event;
+    if (InterlockedIncrement( params->inside ) % 2) ret = WaitForSingleObject( params->object, 1000 );
+    else ret = WaitForMultipleObjects( 2, handles, FALSE, 1000 );
+    ok( ret == WAIT_OBJECT_0 || ret == WAIT_TIMEOUT, "wait failed %08lx\n", ret );
+    if (!ret) InterlockedIncrement( &params->count );
+    return 0;
+}
+
+static DWORD WINAPI abandon_thread( void *arg )
+{
+    struct contention_params *params = arg;
+    HANDLE *mutants = params->object;
+    DWORD ret;
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        ret = WaitForSingleObject( mutants[i], 1000 );
+        ok( ret == WAIT_OBJECT_0, "WaitForSingleObject failed %08lx\n", ret );
+    }
+    /* take the first one recursively */
+    ret = WaitForSingleObject( mutants[0], 1000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForSingleObject failed %08lx\n", ret );
+    SetEvent( params->event );
+    Sleep( 100 );
+    return 0;
+}
+
+static void run_contention_threads( LPTHREAD_START_ROUTINE proc, struct contention_params *params,
+                                    unsigned int count, HANDLE *threads )
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++) threads[i] = CreateThread( NULL, 0, proc, params, 0, NULL );
+}
+
+static void wait_contention_threads( HANDLE *threads, unsigned int count )
+{
+    unsigned int i;
+    DWORD ret;
+
+    ret = WaitForMultipleObjects( count, threads, TRUE, 10000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForMultipleObjects failed %08lx\n", ret );
+    for (i = 0; i < count; i++) CloseHandle( threads[i] );
+}
+
+static void test_contention(void)
+{
+    struct contention_params params;
+    MUTANT_BASIC_INFORMATION mutant_info;
+    SEMAPHORE_BASIC_INFORMATION sem_info;
+    EVENT_BASIC_INFORMATION event_info;
+    HANDLE threads[4], mutants[3];
+    HANDLE thread, other;
+    NTSTATUS status;
+    LONG inside = 0;
+    ULONG prev;
+    DWORD ret;
+    int i;
+
+    /* never signaled, only used to force waits through the server */
+    status = pNtCreateEvent( &other, EVENT_ALL_ACCESS, NULL, NotificationEvent, FALSE );
+    ok( status == STATUS_SUCCESS, "NtCreateEvent failed %08lx\n", status );
+
+    /* contended mutant */
+    params.event = other;
+    params.inside = &inside;
+    params.count = 0;
+    status = pNtCreateMutant( &params.object, MUTANT_ALL_ACCESS, NULL, FALSE );
+    ok( status == STATUS_SUCCESS, "NtCreateMutant failed %08lx\n", status );
+    run_contention_threads( mutant_contention_thread, &params, ARRAY_SIZE(threads), threads );
+    wait_contention_threads( threads, ARRAY_SIZE(threads) );
+    ok( params.count == 500 * ARRAY_SIZE(threads), "got %ld acquisitions\n", params.count );
+
+    status = pNtQueryMutant( params.object, MutantBasicInformation, &mutant_info, sizeof(mutant_info), NULL );
+    ok( status == STATUS_SUCCESS, "NtQueryMutant failed %08lx\n", status );
+    ok( mutant_info.CurrentCount == 1, "expected 1, got %ld\n", mutant_info.CurrentCount );
+    ok( mutant_info.AbandonedState == FALSE, "expected FALSE, got %d\n", mutant_info.AbandonedState );
+    NtClose( params.object );
+
+    /* semaphore released while more threads are waiting than its count allows */
+    inside = 0;
+    params.count = 0;
+    status = pNtCreateSemaphore( &params.object, SEMAPHORE_ALL_ACCESS, NULL, 0, 2 );
+    ok( status == STATUS_SUCCESS, "NtCreateSemaphore failed %08lx\n", status );
+    run_contention_threads( wait_contention_thread, &params, ARRAY_SIZE(threads), threads );
+    while (inside < ARRAY_SIZE(threads)) Sleep( 10 );
+    Sleep( 100 );
+    status = pNtReleaseSemaphore( params.object, 3, &prev );
+    ok( status == STATUS_SEMAPHORE_LIMIT_EXCEEDED, "NtReleaseSemaphore failed %08lx\n", status );
+    status = pNtReleaseSemaphore( params.object, 2, &prev );
+    ok( status == STATUS_SUCCESS, "NtReleaseSemaphore failed %08lx\n", status );
+    ok( prev == 0, "expected 0, got %lu\n", prev );
+    wait_contention_threads( threads, ARRAY_SIZE(threads) );
+    ok( params.count == 2, "got %ld acquisitions\n", params.count );
+
+    status = pNtQuerySemaphore( params.object, SemaphoreBasicInformation, &sem_info, sizeof(sem_info), NULL );
+    ok( status == STATUS_SUCCESS, "NtQuerySemaphore failed %08lx\n", status );
+    ok( sem_info.CurrentCount == 0, "expected 0, got %ld\n", sem_info.CurrentCount );
+    ok( sem_info.MaximumCount == 2, "expected 2, got %ld\n", sem_info.MaximumCount );
+    NtClose( params.object );
+
+    /* pulsing a manual reset event releases all the waiters */
+    inside = 0;
+    params.count = 0;
+    status = pNtCreateEvent( &params.object, EVENT_ALL_ACCESS, NULL, NotificationEvent, FALSE );
+    ok( status == STATUS_SUCCESS, "NtCreateEvent failed %08lx\n", status );
+    run_contention_threads( wait_contention_thread, &params, ARRAY_SIZE(threads), threads );
+    while (inside < ARRAY_SIZE(threads)) Sleep( 10 );
+    Sleep( 100 );
+    status = pNtPulseEvent( params.object, NULL );
+    ok( status == STATUS_SUCCESS, "NtPulseEvent failed %08lx\n", status );
+    wait_contention_threads( threads, ARRAY_SIZE(threads) );
+    ok( params.count == ARRAY_SIZE(threads), "got %ld threads woken\n", params.count );
+
+    status = pNtQueryEvent( params.object, EventBasicInformation, &event_info, sizeof(event_info), NULL );
+    ok( status == STATUS_SUCCESS, "NtQueryEvent failed %08lx\n", status );
+    ok( event_info.EventState == 0, "expected 0, got %ld\n", event_info.EventState );
+    NtClose( params.object );
+
+    /* pulsing an auto reset event releases a single waiter */
+    inside = 0;
+    params.count = 0;
+    status = pNtCreateEvent( &params.object, EVENT_ALL_ACCESS, NULL, SynchronizationEvent, FALSE );
+    ok( status == STATUS_SUCCESS, "NtCreateEvent failed %08lx\n", status );
+    run_contention_threads( wait_contention_thread, &params, ARRAY_SIZE(threads), threads );
+    while (inside < ARRAY_SIZE(threads)) Sleep( 10 );
+    Sleep( 100 );
+    status = pNtPulseEvent( params.object, NULL );
+    ok( status == STATUS_SUCCESS, "NtPulseEvent failed %08lx\n", status );
+    wait_contention_threads( threads, ARRAY_SIZE(threads) );
+    ok( params.count == 1, "got %ld threads woken\n", params.count );
+
+    status = pNtQueryEvent( params.object, EventBasicInformation, &event_info, sizeof(event_info), NULL );
+    ok( status == STATUS_SUCCESS, "NtQueryEvent failed %08lx\n", status );
+    ok( event_info.EventState == 0, "expected 0, got %ld\n", event_info.EventState );
+
+    /* a pulse without waiters is lost */
+    status = pNtPulseEvent( params.object, NULL );
+    ok( status == STATUS_SUCCESS, "NtPulseEvent failed %08lx\n", status );
+    ret = WaitForSingleObject( params.object, 0 );
+    ok( ret == WAIT_TIMEOUT, "WaitForSingleObject returned %08lx\n", ret );
+    NtClose( params.object );
+
+    /* mutants owned by a dying thread are abandoned, waking up a waiter */
+    for (i = 0; i < ARRAY_SIZE(mutants); i++)
+    {
+        status = pNtCreateMutant( &mutants[i], MUTANT_ALL_ACCESS, NULL, FALSE );
+        ok( status == STATUS_SUCCESS, "NtCreateMutant failed %08lx\n", status );
+    }
+    params.object = mutants;
+    params.event = CreateEventW( NULL, FALSE, FALSE, NULL );
+    thread = CreateThread( NULL, 0, abandon_thread, &params, 0, NULL );
+    ret = WaitForSingleObject( params.event, 1000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForSingleObject failed %08lx\n", ret );
+    threads[0] = mutants[2];
+    threads[1] = other;
+    ret = WaitForMultipleObjects( 2, threads, FALSE, 5000 );
+    ok( ret == WAIT_ABANDONED_0, "WaitForMultipleObjects returned %08lx\n", ret );
+    ret = WaitForSingleObject( thread, 1000 );
+    ok( ret == WAIT_OBJECT_0, "WaitForSingleObject failed %08lx\n", ret );
+    CloseHandle( thread );
+    CloseHandle( params.event );
+
+    for (i = 0; i < 2; i++)
+    {
+        status = pNtQueryMutant( mutants[i], MutantBasicInformation, &mutant_info, sizeof(mutant_info), NULL );
+        ok( status == STATUS_SUCCESS, "NtQueryMutant failed %08lx\n", status );
+        ok( mutant_info.CurrentCount == 1, "%d: expected 1, got %ld\n", i, mutant_info.CurrentCount );
+        ok( mutant_info.OwnedByCaller == FALSE, "%d: expected FALSE, got %d\n", i, mutant_info.OwnedByCaller );
+        ok( mutant_info.AbandonedState == TRUE, "%d: expected TRUE, got %d\n", i, mutant_info.AbandonedState );
+
+        ret = WaitForSingleObject( mutants[i], 0 );
+        ok( ret == WAIT_ABANDONED_0, "%d: WaitForSingleObject returned %08lx\n", i, ret );
+        status = pNtReleaseMutant( mutants[i], NULL );
+        ok( status == STATUS_SUCCESS, "NtReleaseMutant failed %08lx\n", status );
+    }
+    status = pNtReleaseMutant( mutants[2], NULL );
+    ok( status == STATUS_SUCCESS, "NtReleaseMutant failed %08lx\n", status );
+    for (i = 0; i < ARRAY_SIZE(mutants); i++) NtClose( mutants[i] );
+
+    NtClose( other );
+}
+
 static void test_wait_on_address(void)
 {
     SIZE_T size;
@@ -837,6 +1073,90 @@ static void test_tid_alert( char **argv )
     CloseHandle( pi.hThread );
 }
 
+static void test_wait_completion_packet(void)
+{
+    ULONG_PTR key, value;
+    IO_STATUS_BLOCK iosb;
+    LARGE_INTEGER timeout;
+    HANDLE packet, port, event;
+    BOOLEAN signaled;
+    NTSTATUS status;
+
+    if (!pNtCreateWaitCompletionPacket)
+    {
+        win_skip( "NtCreateWaitCompletionPacket is not available\n" );
+        return;
+    }
+
+    status = pNtCreateWaitCompletionPacket( &packet, GENERIC_ALL, NULL );
+    ok( !status, "NtCreateWaitCompletionPacket failed %lx\n", status );
+    status = NtCreateIoCompletion( &port, IO_COMPLETION_ALL_ACCESS, NULL, 0 );
+    ok( !status, "NtCreateIoCompletion failed %lx\n", status );
+    status = pNtCreateEvent( &event, EVENT_ALL_ACCESS, NULL, SynchronizationEvent, FALSE );
+    ok( !status, "NtCreateEvent failed %lx\n", status );
+    timeout.QuadPart = 0;
+
+    status = pNtCancelWaitCompletionPacket( packet, FALSE );
+    ok( status == STATUS_NOT_FOUND, "NtCancelWaitCompletionPacket returned %lx\n", status );
+
+    /* the packet is queued once the object is signaled, the wait satisfies it */
+    signaled = 0xcc;
+    status = pNtAssociateWaitCompletionPacket( packet, port, event, (void *)1, (void *)2, STATUS_SUCCESS, 3, &signaled );
+    ok( !status, "NtAssociateWaitCompletionPacket failed %lx\n", status );
+    ok( !signaled, "got signaled %u\n", signaled );
+    status = pNtAssociateWaitCompletionPacket( packet, port, event, (void *)1, (void *)2, STATUS_SUCCESS, 3, NULL );
+    ok( status == STATUS_INVALID_PARAMETER_1, "NtAssociateWaitCompletionPacket returned %lx\n", status );
+    status = NtRemoveIoCompletion( port, &key, &value, &iosb, &timeout );
+    ok( status == STATUS_TIMEOUT, "NtRemoveIoCompletion returned %lx\n", status );
+
+    pNtSetEvent( event, NULL );
+    key = value = 0xdeadbeef;
+    status = NtRemoveIoCompletion( port, &key, &value, &iosb, &timeout );
+    ok( !status, "NtRemoveIoCompletion failed %lx\n", status );
+    ok( key == 1, "got key %Ix\n", key );
+    ok( value == 2, "got value %Ix\n", value );
+    ok( iosb.Status == STATUS_SUCCESS, "got status %lx\n", iosb.Status );
+    ok( iosb.Information == 3, "got information %Iu\n", iosb.Information );
+    status = WaitForSingleObject( event, 0 );
+    ok( status == WAIT_TIMEOUT, "event is signaled\n" );
+
+    status = pNtCancelWaitCompletionPacket( packet, TRUE );
+    ok( status == STATUS_NOT_FOUND, "NtCancelWaitCompletionPacket returned %lx\n", status );
+
+    /* cancelling a pending wait */
+    status = pNtAssociateWaitCompletionPacket( packet, port, event, (void *)1, (void *)2, STATUS_SUCCESS, 3, NULL );
+    ok( !status, "NtAssociateWaitCompletionPacket failed %lx\n", status );
+    status = pNtCancelWaitCompletionPacket( packet, FALSE );
+    ok( !status, "NtCancelWaitCompletionPacket failed %lx\n", status );
+    pNtSetEvent( event, NULL );
+    status = NtRemoveIoCompletion( port, &key, &value, &iosb, &timeout );
+    ok( status == STATUS_TIMEOUT, "NtRemoveIoCompletion returned %lx\n", status );
+
+    /* the event is still signaled, so the packet is queued right away */
+    signaled = 0xcc;
+    status = pNtAssociateWaitCompletionPacket( packet, port, event, (void *)4, (void *)5, STATUS_SUCCESS, 6, &signaled );
+    ok( !status, "NtAssociateWaitCompletionPacket failed %lx\n", status );
+    ok( signaled == TRUE, "got signaled %u\n", signaled );
+    status = pNtCancelWaitCompletionPacket( packet, FALSE );
+    ok( status == STATUS_PENDING, "NtCancelWaitCompletionPacket returned %lx\n", status );
+    status = pNtCancelWaitCompletionPacket( packet, TRUE );
+    ok( status == STATUS_CANCELLED, "NtCancelWaitCompletionPacket returned %lx\n", status );
+    status = NtRemoveIoCompletion( port, &key, &value, &iosb, &timeout );
+    ok( status == STATUS_TIMEOUT, "NtRemoveIoCompletion returned %lx\n", status );
+
+    /* a queued packet is still delivered after closing it */
+    pNtSetEvent( event, NULL );
+    status = pNtAssociateWaitCompletionPacket( packet, port, event, (void *)7, (void *)8, STATUS_SUCCESS, 9, NULL );
+    ok( !status, "NtAssociateWaitCompletionPacket failed %lx\n", status );
+    NtClose( packet );
+    status = NtRemoveIoCompletion( port, &key, &value, &iosb, &timeout );
+    ok( !status, "NtRemoveIoCompletion failed %lx\n", status );
+    ok( key == 7, "got key %Ix\n", key );
+
+    NtClose( event );
+    NtClose( port );
+}
+
 START_TEST(sync)
 {
     HMODULE module = GetModuleHandleA("ntdll.dll");
@@ -848,11 +1168,14 @@ START_TEST(sync)
     if (argc > 2) return;
 
     pNtAlertThreadByThreadId        = (void *)GetProcAddress(module, "NtAlertThreadByThreadId");
+    pNtAssociateWaitCompletionPacket = (void *)GetProcAddress(module, "NtAssociateWaitCompletionPacket");
+    pNtCancelWaitCompletionPacket   = (void *)GetProcAddress(module, "NtCancelWaitCompletionPacket");
     pNtClose                        = (void *)GetProcAddress(module, "NtClose");
     pNtCreateEvent                  = (void *)GetProcAddress(module, "NtCreateEvent");
     pNtCreateKeyedEvent             = (void *)GetProcAddress(module, "NtCreateKeyedEvent");
     pNtCreateMutant                 = (void *)GetProcAddress(module, "NtCreateMutant");
     pNtCreateSemaphore              = (void *)GetProcAddress(module, "NtCreateSemaphore");
+    pNtCreateWaitCompletionPacket   = (void *)GetProcAddress(module, "NtCreateWaitCompletionPacket");
     pNtOpenEvent                    = (void *)GetProcAddress(module, "NtOpenEvent");
     pNtOpenKeyedEvent               = (void *)GetProcAddress(module, "NtOpenKeyedEvent");
     pNtPulseEvent                   = (void *)GetProcAddress(module, "NtPulseEvent");
@@ -881,7 +1204,9 @@ START_TEST(sync)
     test_event();
     test_mutant();
     test_semaphore();
+    test_contention();
     test_keyed_events();
     test_resource();
     test_tid_alert( argv );
+    test_wait_completion_packet();
 }
@@ -838,6 +838,116 @@ static void test_tp_work_scheduler(void)
     pTpReleasePool(pool);
 }
 
+struct nested_work_info
+{
+    TP_WORK *work[2];
+    LONG count[2];
+    LONG order;
+};
+
+static void CALLBACK nested_work_cb(TP_CALLBACK_INSTANCE *instance, void *userdata, TP_WORK *work)
+{
+    struct nested_work_info *info = userdata;
+    int i;
+
+    if (work == info->work[0])
+    {
+        for (i = 0; i < 10; i++)
+            pTpPostWork(info->work[1]);
+        InterlockedIncrement(&info->count[0]);
+    }
+    else
+        InterlockedIncrement(&info->count[1]);
+}
+
+static void CALLBACK nested_prio_cb(TP_CALLBACK_INSTANCE *instance, void *userdata, TP_WORK *work)
+{
+    struct nested_work_info *info = userdata;
+
+    if (work == info->work[0])
+        InterlockedExchange(&info->count[0], InterlockedIncrement(&info->order));
+    else
+        InterlockedExchange(&info->count[1], InterlockedIncrement(&info->order));
+}
+
+static void CALLBACK nested_post_cb(TP_CALLBACK_INSTANCE *instance, void *userdata, TP_WORK *work)
+{
+    struct nested_work_info *info = userdata;
+
+    pTpPostWork(info->work[1]);
+    pTpPostWork(info->work[0]);
+}
+
+static void test_tp_work_nested(void)
+{
+    TP_CALLBACK_ENVIRON_V3 environment;
+    struct nested_work_info info;
+    TP_WORK *work;
+    TP_POOL *pool;
+    NTSTATUS status;
+    int i;
+
+    pool = NULL;
+    status = pTpAllocPool(&pool, NULL);
+    ok(!status, "TpAllocPool failed with status %lx\n", status);
+    ok(pool != NULL, "expected pool != NULL\n");
+    pTpSetPoolMaxThreads(pool, 4);
+
+    /* work posted from within callbacks is executed as well */
+    memset(&environment, 0, sizeof(environment));
+    environment.Version = 3;
+    environment.Pool = pool;
+    environment.CallbackPriority = TP_CALLBACK_PRIORITY_NORMAL;
+    environment.Size = sizeof(environment);
+    memset(&info, 0, sizeof(info));
+    for (i = 0; i < 2; i++)
+    {
+        status = pTpAllocWork(&info.work[i], nested_work_cb, &info, (TP_CALLBACK_ENVIRON *)&environment);
+        ok(!status, "TpAllocWork failed with status %lx\n", status);
+    }
+    for (i = 0; i < 20; i++)
+        pTpPostWork(info.work[0]);
+    pTpWaitForWork(info.work[0], FALSE);
+    pTpWaitForWork(info.work[1], FALSE);
+    ok(info.count[0] == 20, "expected 20 callbacks, got %lu\n", info.count[0]);
+    ok(info.count[1] == 200, "expected 200 callbacks, got %lu\n", info.count[1]);
+    for (i = 0; i < 2; i++)
+        pTpReleaseWork(info.work[i]);
+
+    pTpReleasePool(pool);
+
+    /* priorities are respected for work posted from within a callback */
+    pool = NULL;
+    status = pTpAllocPool(&pool, NULL);
+    ok(!status, "TpAllocPool failed with status %lx\n", status);
+    ok(pool != NULL, "expected pool != NULL\n");
+    pTpSetPoolMaxThreads(pool, 1);
+
+    environment.Pool = pool;
+    memset(&info, 0, sizeof(info));
+    environment.CallbackPriority = TP_CALLBACK_PRIORITY_HIGH;
+    status = pTpAllocWork(&info.work[0], nested_prio_cb, &info, (TP_CALLBACK_ENVIRON *)&environment);
+    ok(!status, "TpAllocWork failed with status %lx\n", status);
+    environment.CallbackPriority = TP_CALLBACK_PRIORITY_LOW;
+    status = pTpAllocWork(&info.work[1], nested_prio_cb, &info, (TP_CALLBACK_ENVIRON *)&environment);
+    ok(!status, "TpAllocWork failed with status %lx\n", status);
+    environment.CallbackPriority = TP_CALLBACK_PRIORITY_NORMAL;
+    status = pTpAllocWork(&work, nested_post_cb, &info, (TP_CALLBACK_ENVIRON *)&environment);
+    ok(!status, "TpAllocWork failed with status %lx\n", status);
+
+    pTpPostWork(work);
+    pTpWaitForWork(work, FALSE);
+    pTpWaitForWork(info.work[0], FALSE);
+    pTpWaitForWork(info.work[1], FALSE);
+    ok(info.count[0] == 1, "expected high priority callback to run first, got %lu\n", info.count[0]);
+    ok(info.count[1] == 2, "expected low priority callback to run last, got %lu\n", info.count[1]);
+
+    pTpReleaseWork(work);
+    for (i = 0; i < 2; i++)
+        pTpReleaseWork(info.work[i]);
+    pTpReleasePool(pool);
+}
+
 static void CALLBACK simple_release_cb(TP_CALLBACK_INSTANCE *instance, void *userdata)
 {
     HANDLE *semaphores = userdata;
@@ -2398,6 +2508,7 @@ START_TEST(threadpool)
     test_tp_simple();
     test_tp_work();
     test_tp_work_scheduler();
+    test_tp_work_nested();
     test_tp_group_wait();
     test_tp_group_cancel();
     test_tp_instance();
@@ -97,8 +97,29 @@ struct timer_queue
  */
 
 #define THREADPOOL_WORKER_TIMEOUT 5000
+#define THREADPOOL_MIN_SPIN_COUNT 64
+#define THREADPOOL_MAX_SPIN_COUNT 4096
 #define MAXIMUM_WAITQUEUE_OBJECTS (MAXIMUM_WAIT_OBJECTS - 1)
 
+/* queue of objects with pending callbacks */
+struct threadpool_queue
+{
+    RTL_SRWLOCK             lock;
+    /* locked via .lock, order matches TP_CALLBACK_PRIORITY - high, normal, low */
+    struct list             objects[3];
+};
+
+/* internal worker thread representation */
+struct threadpool_worker
+{
+    struct threadpool_worker *next;     /* workers are only freed with the pool */
+    struct threadpool       *pool;
+    BOOL                    running;    /* locked via .pool->cs */
+    unsigned int            spin_count; /* adjusted depending on whether spinning found work */
+    /* objects submitted from this thread, other workers steal from it when idle */
+    struct threadpool_queue queue;
+};
+
 /* internal threadpool representation */
 struct threadpool
 {
@@ -106,14 +127,19 @@ struct threadpool
     LONG                    objcount;
     BOOL                    shutdown;
     CRITICAL_SECTION        cs;
-    /* Pools of work items, locked via .cs, order matches TP_CALLBACK_PRIORITY - high, normal, low. */
-    struct list             pools[3];
-    RTL_CONDITION_VARIABLE  update_event;
+    /* objects submitted from threads which aren't workers of this pool */
+    struct threadpool_queue queue;
+    struct threadpool_worker *workers;
+    /* number of queued objects for each priority, an upper bound of the actual count */
+    LONG                    num_queued[3];
+    /* idle workers wait for work_serial to change */
+    LONG                    num_idle_workers;
+    LONG                    work_serial;
     /* information about worker threads, locked via .cs */
     int                     max_workers;
     int                     min_workers;
     int                     num_workers;
-    int                     num_busy_workers;
+    LONG                    num_busy_workers;
     HANDLE                  compl_port;
     TP_POOL_STACK_INFORMATION stack_info;
 };
@@ -152,14 +178,18 @@ struct threadpool_object
     /* information about the group, locked via .group->cs */
     struct list             group_entry;
     BOOL                    is_group_member;
-    /* information about the pool, locked via .pool->cs */
+    /* information about the pool, locked via .queue->lock */
     struct list             pool_entry;
+    struct threadpool_queue *queue;
+    /* callback counters are updated atomically, waiting for them
+     * to drop to zero is done with .pool->cs held */
     RTL_CONDITION_VARIABLE  finished_event;
     RTL_CONDITION_VARIABLE  group_finished_event;
     HANDLE                  completed_event;
     LONG                    num_pending_callbacks;
     LONG                    num_running_callbacks;
     LONG                    num_associated_callbacks;
+    LONG                    num_waiters;
     LONG                    update_serial;
     /* arguments for callback */
     union
@@ -190,6 +220,8 @@ struct threadpool_object
             LONG            signaled;
             /* information about the wait object, locked via waitqueue.cs */
             struct waitqueue_bucket *bucket;
+            HANDLE          packet;
+            BOOL            packet_armed;
             BOOL            wait_pending;
             struct list     wait_entry;
             ULONGLONG       timeout;
@@ -271,12 +303,23 @@ static struct
     CRITICAL_SECTION        cs;
     LONG                    num_buckets;
     struct list             buckets;
+    /* one-shot waits are multiplexed through wait completion packets on a single port */
+    HANDLE                  port;
+    LONG                    port_objcount;
+    BOOL                    port_thread_running;
+    struct list             port_reserved;
+    struct list             port_waiting;
 }
 waitqueue =
 {
     { &waitqueue_debug, -1, 0, 0, 0, 0 },       /* cs */
     0,                                          /* num_buckets */
-    LIST_INIT( waitqueue.buckets )              /* buckets */
+    LIST_INIT( waitqueue.buckets ),             /* buckets */
+    NULL,                                       /* port */
+    0,                                          /* port_objcount */
+    FALSE,                                      /* port_thread_running */
+    LIST_INIT( waitqueue.port_reserved ),       /* port_reserved */
+    LIST_INIT( waitqueue.port_waiting )         /* port_waiting */
 };
 
 static RTL_CRITICAL_SECTION_DEBUG waitqueue_debug =
@@ -1142,6 +1185,15 @@ static void CALLBACK timerqueue_thread_proc( void *param )
     RtlExitUserThread( 0 );
 }
 
+static void tp_queue_init( struct threadpool_queue *queue )
+{
+    unsigned int i;
+
+    RtlInitializeSRWLock( &queue->lock );
+    for (i = 0; i < ARRAY_SIZE(queue->objects); i++)
+        list_init( &queue->objects[i] );
+}
+
 /***********************************************************************
  *           tp_new_worker_thread    (internal)
  *
@@ -1149,14 +1201,34 @@ static void CALLBACK timerqueue_thread_proc( void *param )
  */
 static NTSTATUS tp_new_worker_thread( struct threadpool *pool )
 {
+    struct threadpool_worker *worker;
     HANDLE thread;
     NTSTATUS status;
 
+    /* Worker structures stay in the list until the pool is destroyed, idle
+     * workers walk it without locking to steal objects from the queues. */
+    for (worker = pool->workers; worker; worker = worker->next)
+        if (!worker->running) break;
+
+    if (!worker)
+    {
+        if (!(worker = RtlAllocateHeap( GetProcessHeap(), 0, sizeof(*worker) )))
+            return STATUS_NO_MEMORY;
+
+        worker->pool        = pool;
+        worker->running     = FALSE;
+        worker->spin_count  = THREADPOOL_MIN_SPIN_COUNT;
+        tp_queue_init( &worker->queue );
+        worker->next        = pool->workers;
+        InterlockedExchangePointer( (void **)&pool->workers, worker );
+    }
+
     status = RtlCreateUserThread( GetCurrentProcess(), NULL, FALSE, 0,
                                   pool->stack_info.StackReserve, pool->stack_info.StackCommit,
-                                  threadpool_worker_proc, pool, &thread, NULL );
+                                  threadpool_worker_proc, worker, &thread, NULL );
     if (status == STATUS_SUCCESS)
     {
+        worker->running = TRUE;
         InterlockedIncrement( &pool->refcount );
         pool->num_workers++;
         NtClose( thread );
@@ -1280,10 +1352,7 @@ static void CALLBACK waitqueue_thread_proc( void *param )
                 if ((wait->u.wait.flags & (WT_EXECUTEINWAITTHREAD | WT_EXECUTEINIOTHREAD)))
                 {
                     InterlockedIncrement( &wait->refcount );
-                    wait->num_pending_callbacks++;
-                    RtlEnterCriticalSection( &wait->pool->cs );
                     tp_object_execute( wait, TRUE );
-                    RtlLeaveCriticalSection( &wait->pool->cs );
                     tp_object_release( wait );
                 }
                 else tp_object_submit( wait, FALSE );
@@ -1338,11 +1407,8 @@ static void CALLBACK waitqueue_thread_proc( void *param )
                     }
                     if ((wait->u.wait.flags & (WT_EXECUTEINWAITTHREAD | WT_EXECUTEINIOTHREAD)))
                     {
-                        wait->u.wait.signaled++;
-                        wait->num_pending_callbacks++;
-                        RtlEnterCriticalSection( &wait->pool->cs );
+                        InterlockedIncrement( &wait->u.wait.signaled );
                         tp_object_execute( wait, TRUE );
-                        RtlLeaveCriticalSection( &wait->pool->cs );
                     }
                     else tp_object_submit( wait, TRUE );
                 }
@@ -1421,6 +1487,238 @@ static void CALLBACK waitqueue_thread_proc( void *param )
     RtlExitUserThread( 0 );
 }
 
+/***********************************************************************
+ *           tp_waitqueue_disarm    (internal)
+ *
+ * Cancels the wait completion packet of a wait object. Returns STATUS_CANCELLED
+ * if the object was already signaled, STATUS_PENDING if the port thread is about
+ * to process the packet and STATUS_SUCCESS otherwise.
+ */
+static NTSTATUS tp_waitqueue_disarm( struct threadpool_object *wait )
+{
+    NTSTATUS status;
+
+    if (!wait->u.wait.packet_armed)
+        return STATUS_SUCCESS;
+
+    wait->u.wait.packet_armed = FALSE;
+    status = NtCancelWaitCompletionPacket( wait->u.wait.packet, TRUE );
+    if (status != STATUS_SUCCESS && status != STATUS_CANCELLED)
+        return STATUS_PENDING;
+
+    /* Release the reference held by the association. */
+    tp_object_release( wait );
+    return status;
+}
+
+/***********************************************************************
+ *           tp_waitqueue_fire    (internal)
+ */
+static void tp_waitqueue_fire( struct threadpool_object *wait, BOOL signaled )
+{
+    list_remove( &wait->u.wait.wait_entry );
+    list_add_tail( &waitqueue.port_reserved, &wait->u.wait.wait_entry );
+    wait->u.wait.wait_pending = FALSE;
+    tp_object_submit( wait, signaled );
+}
+
+/***********************************************************************
+ *           waitqueue_port_thread_proc    (internal)
+ */
+static void CALLBACK waitqueue_port_thread_proc( void *param )
+{
+    struct threadpool_object *wait, *next;
+    LARGE_INTEGER now, timeout;
+    IO_STATUS_BLOCK iosb;
+    ULONG_PTR key, value;
+    NTSTATUS status;
+
+    TRACE( "starting wait queue port thread\n" );
+    set_thread_name(L"wine_threadpool_waitport");
+
+    RtlEnterCriticalSection( &waitqueue.cs );
+
+    for (;;)
+    {
+        NtQuerySystemTime( &now );
+        timeout.QuadPart = MAXLONGLONG;
+
+        /* Waits are sorted by timeout, fire the ones which timed out. */
+        LIST_FOR_EACH_ENTRY_SAFE( wait, next, &waitqueue.port_waiting, struct threadpool_object,
+                                  u.wait.wait_entry )
+        {
+            assert( wait->type == TP_OBJECT_TYPE_WAIT );
+            assert( wait->u.wait.wait_pending );
+            if (wait->u.wait.timeout > now.QuadPart)
+            {
+                timeout.QuadPart = wait->u.wait.timeout;
+                break;
+            }
+            /* The object might have been signaled in the meantime. */
+            status = tp_waitqueue_disarm( wait );
+            tp_waitqueue_fire( wait, status != STATUS_SUCCESS );
+        }
+
+        if (!waitqueue.port_objcount)
+        {
+            /* All wait objects have been destroyed, if no new wait objects are created
+             * within some amount of time, then we can shutdown this thread. */
+            RtlLeaveCriticalSection( &waitqueue.cs );
+            timeout.QuadPart = (ULONGLONG)THREADPOOL_WORKER_TIMEOUT * -10000;
+            status = NtRemoveIoCompletion( waitqueue.port, &key, &value, &iosb, &timeout );
+            RtlEnterCriticalSection( &waitqueue.cs );
+
+            if (status == STATUS_TIMEOUT && !waitqueue.port_objcount)
+                break;
+        }
+        else
+        {
+            RtlLeaveCriticalSection( &waitqueue.cs );
+            status = NtRemoveIoCompletion( waitqueue.port, &key, &value, &iosb,
+                                           timeout.QuadPart == MAXLONGLONG ? NULL : &timeout );
+            RtlEnterCriticalSection( &waitqueue.cs );
+        }
+
+        /* Packets with a zero key only wake up the thread. */
+        if (status != STATUS_SUCCESS || !key)
+            continue;
+
+        wait = (struct threadpool_object *)key;
+        assert( wait->type == TP_OBJECT_TYPE_WAIT );
+        if (wait->u.wait.packet_armed && (ULONG)wait->update_serial == value)
+        {
+            /* Wait object signaled. */
+            wait->u.wait.packet_armed = FALSE;
+            tp_waitqueue_fire( wait, TRUE );
+        }
+        else
+        {
+            WARN( "wait object %p triggered while object was %s.\n",
+                  wait, wait->u.wait.packet ? "updated" : "destroyed" );
+        }
+
+        /* Release the reference held by the association. */
+        tp_object_release( wait );
+    }
+
+    waitqueue.port_thread_running = FALSE;
+    RtlLeaveCriticalSection( &waitqueue.cs );
+
+    TRACE( "terminating wait queue port thread\n" );
+    RtlExitUserThread( 0 );
+}
+
+/***********************************************************************
+ *           tp_waitqueue_port_lock    (internal)
+ *
+ * Sets up a wait completion packet for a one-shot wait object.
+ */
+static NTSTATUS tp_waitqueue_port_lock( struct threadpool_object *wait )
+{
+    NTSTATUS status;
+    HANDLE thread;
+
+    if (!waitqueue.port && (status = NtCreateIoCompletion( &waitqueue.port, IO_COMPLETION_ALL_ACCESS, NULL, 0 )))
+    {
+        waitqueue.port = NULL;
+        return status;
+    }
+
+    if ((status = NtCreateWaitCompletionPacket( &wait->u.wait.packet, GENERIC_ALL, NULL )))
+    {
+        wait->u.wait.packet = NULL;
+        return status;
+    }
+
+    if (!waitqueue.port_thread_running)
+    {
+        if ((status = RtlCreateUserThread( GetCurrentProcess(), NULL, FALSE, 0, 0, 0,
+                                           waitqueue_port_thread_proc, NULL, &thread, NULL )))
+        {
+            NtClose( wait->u.wait.packet );
+            wait->u.wait.packet = NULL;
+            return status;
+        }
+        waitqueue.port_thread_running = TRUE;
+        NtClose( thread );
+    }
+
+    list_add_tail( &waitqueue.port_reserved, &wait->u.wait.wait_entry );
+    waitqueue.port_objcount++;
+    return STATUS_SUCCESS;
+}
+
+/***********************************************************************
+ *           tp_waitqueue_port_set    (internal)
+ *
+ * Updates the wait completion packet of a wait object after TpSetWait.
+ */
+static void tp_waitqueue_port_set( struct threadpool_object *wait, HANDLE handle,
+                                   BOOL same_handle, ULONGLONG timestamp )
+{
+    struct threadpool_object *other;
+    struct list *entry;
+    NTSTATUS status;
+
+    if (!handle && !wait->u.wait.wait_pending)
+        return;
+
+    status = tp_waitqueue_disarm( wait );
+    list_remove( &wait->u.wait.wait_entry );
+    list_add_tail( &waitqueue.port_reserved, &wait->u.wait.wait_entry );
+    wait->u.wait.wait_pending = FALSE;
+
+    if (!handle)
+        return;
+
+    if (same_handle && status == STATUS_CANCELLED)
+    {
+        /* The object was signaled before the wait was updated, don't lose the signal. */
+        tp_object_submit( wait, TRUE );
+        return;
+    }
+
+    if (same_handle && status == STATUS_PENDING)
+    {
+        /* The port thread is about to process the signal, let it fire the new wait. */
+        wait->u.wait.packet_armed = TRUE;
+    }
+    else
+    {
+        InterlockedIncrement( &wait->refcount );
+        status = NtAssociateWaitCompletionPacket( wait->u.wait.packet, waitqueue.port, handle, wait,
+                                                  ULongToPtr( ++wait->update_serial ), STATUS_SUCCESS,
+                                                  0, NULL );
+        if (status)
+        {
+            /* Only the timeout can fire the wait. */
+            WARN( "failed to wait for %p, status %#lx\n", handle, status );
+            tp_object_release( wait );
+        }
+        else wait->u.wait.packet_armed = TRUE;
+    }
+
+    /* Keep the waiting list sorted by timeout, infinite waits go to the end. */
+    if (timestamp == MAXLONGLONG)
+        entry = &waitqueue.port_waiting;
+    else
+    {
+        LIST_FOR_EACH( entry, &waitqueue.port_waiting )
+        {
+            other = LIST_ENTRY( entry, struct threadpool_object, u.wait.wait_entry );
+            if (other->u.wait.timeout > timestamp) break;
+        }
+    }
+    list_remove( &wait->u.wait.wait_entry );
+    list_add_before( entry, &wait->u.wait.wait_entry );
+    wait->u.wait.wait_pending = TRUE;
+    wait->u.wait.timeout = timestamp;
+
+    /* Wake up the port thread when the timeout has to be updated. */
+    if (timestamp != MAXLONGLONG && list_head( &waitqueue.port_waiting ) == &wait->u.wait.wait_entry)
+        NtSetIoCompletion( waitqueue.port, 0, 0, STATUS_SUCCESS, 0 );
+}
+
 /***********************************************************************
  *           tp_waitqueue_lock    (internal)
  */
@@ -1434,12 +1732,23 @@ static NTSTATUS tp_waitqueue_lock( struct threadpool_object *wait )
 
     wait->u.wait.signaled       = 0;
     wait->u.wait.bucket         = NULL;
+    wait->u.wait.packet         = NULL;
+    wait->u.wait.packet_armed   = FALSE;
     wait->u.wait.wait_pending   = FALSE;
     wait->u.wait.timeout        = 0;
     wait->u.wait.handle         = INVALID_HANDLE_VALUE;
 
     RtlEnterCriticalSection( &waitqueue.cs );
 
+    /* One-shot waits executed in a worker thread don't need a wait thread of
+     * their own, fall back to the buckets if the packet can't be created. */
+    if ((wait->u.wait.flags & (WT_EXECUTEONLYONCE | WT_EXECUTEINWAITTHREAD | WT_EXECUTEINIOTHREAD))
+            == WT_EXECUTEONLYONCE && !tp_waitqueue_port_lock( wait ))
+    {
+        status = STATUS_SUCCESS;
+        goto out;
+    }
+
     /* Try to assign to existing bucket if possible. */
     LIST_FOR_EACH_ENTRY( bucket, &waitqueue.buckets, struct waitqueue_bucket, bucket_entry )
     {
@@ -1507,7 +1816,20 @@ static void tp_waitqueue_unlock( struct threadpool_object *wait )
     assert( wait->type == TP_OBJECT_TYPE_WAIT );
 
     RtlEnterCriticalSection( &waitqueue.cs );
-    if (wait->u.wait.bucket)
+    if (wait->u.wait.packet)
+    {
+        assert( waitqueue.port_objcount > 0 );
+
+        tp_waitqueue_disarm( wait );
+        list_remove( &wait->u.wait.wait_entry );
+        NtClose( wait->u.wait.packet );
+        wait->u.wait.packet = NULL;
+
+        /* Wake up the port thread, so it can shut down when idle. */
+        if (!--waitqueue.port_objcount)
+            NtSetIoCompletion( waitqueue.port, 0, 0, STATUS_SUCCESS, 0 );
+    }
+    else if (wait->u.wait.bucket)
     {
         struct waitqueue_bucket *bucket = wait->u.wait.bucket;
         assert( bucket->objcount > 0 );
@@ -1687,9 +2009,12 @@ static NTSTATUS tp_threadpool_alloc( struct threadpool **out )
     RtlInitializeCriticalSectionEx( &pool->cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO );
     pool->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": threadpool.cs");
 
-    for (i = 0; i < ARRAY_SIZE(pool->pools); ++i)
-        list_init( &pool->pools[i] );
-    RtlInitializeConditionVariable( &pool->update_event );
+    tp_queue_init( &pool->queue );
+    pool->workers               = NULL;
+    for (i = 0; i < ARRAY_SIZE(pool->num_queued); ++i)
+        pool->num_queued[i] = 0;
+    pool->num_idle_workers      = 0;
+    pool->work_serial           = 0;
 
     pool->max_workers             = 500;
     pool->min_workers             = 0;
@@ -1716,7 +2041,8 @@ static void tp_threadpool_shutdown( struct threadpool *pool )
     assert( pool != default_threadpool );
 
     pool->shutdown = TRUE;
-    RtlWakeAllConditionVariable( &pool->update_event );
+    InterlockedIncrement( &pool->work_serial );
+    RtlWakeAddressAll( &pool->work_serial );
 }
 
 /***********************************************************************
@@ -1726,6 +2052,7 @@ static void tp_threadpool_shutdown( struct threadpool *pool )
  */
 static BOOL tp_threadpool_release( struct threadpool *pool )
 {
+    struct threadpool_worker *worker, *next;
     unsigned int i;
 
     if (InterlockedDecrement( &pool->refcount ))
@@ -1735,8 +2062,17 @@ static BOOL tp_threadpool_release( struct threadpool *pool )
 
     assert( pool->shutdown );
     assert( !pool->objcount );
-    for (i = 0; i < ARRAY_SIZE(pool->pools); ++i)
-        assert( list_empty( &pool->pools[i] ) );
+    for (i = 0; i < ARRAY_SIZE(pool->queue.objects); ++i)
+        assert( list_empty( &pool->queue.objects[i] ) );
+
+    for (worker = pool->workers; worker; worker = next)
+    {
+        next = worker->next;
+        assert( !worker->running );
+        for (i = 0; i < ARRAY_SIZE(worker->queue.objects); ++i)
+            assert( list_empty( &worker->queue.objects[i] ) );
+        RtlFreeHeap( GetProcessHeap(), 0, worker );
+    }
 
     pool->cs.DebugInfo->Spare[0] = 0;
     RtlDeleteCriticalSection( &pool->cs );
@@ -1917,12 +2253,14 @@ static void tp_object_initialize( struct threadpool_object *object, struct threa
     object->is_group_member         = FALSE;
 
     memset( &object->pool_entry, 0, sizeof(object->pool_entry) );
+    object->queue                   = NULL;
     RtlInitializeConditionVariable( &object->finished_event );
     RtlInitializeConditionVariable( &object->group_finished_event );
     object->completed_event         = NULL;
     object->num_pending_callbacks   = 0;
     object->num_running_callbacks   = 0;
     object->num_associated_callbacks = 0;
+    object->num_waiters             = 0;
     object->update_serial           = 0;
 
     if (environment)
@@ -1940,7 +2278,7 @@ static void tp_object_initialize( struct threadpool_object *object, struct threa
             TP_CALLBACK_ENVIRON_V3 *environment_v3 = (TP_CALLBACK_ENVIRON_V3 *)environment;
 
             object->priority = environment_v3->CallbackPriority;
-            assert( object->priority < ARRAY_SIZE(pool->pools) );
+            assert( object->priority < ARRAY_SIZE(pool->num_queued) );
         }
 
         if (environment->ActivationContext)
@@ -1977,50 +2315,163 @@ static void tp_object_initialize( struct threadpool_object *object, struct threa
         tp_object_release( object );
 }
 
-static void tp_object_prio_queue( struct threadpool_object *object )
+static BOOL threadpool_has_work( struct threadpool *pool )
 {
-    ++object->pool->num_busy_workers;
-    list_add_tail( &object->pool->pools[object->priority], &object->pool_entry );
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(pool->num_queued); ++i)
+        if (ReadNoFence( &pool->num_queued[i] )) return TRUE;
+    return FALSE;
 }
 
 /***********************************************************************
- *           tp_object_submit    (internal)
+ *           tp_object_prio_queue    (internal)
  *
- * Submits a threadpool object to the associated threadpool. This
- * function has to be VOID because TpPostWork can never fail on Windows.
+ * Queues an object with pending callbacks. Worker threads queue objects
+ * to their own queue, everyone else to the shared queue of the pool.
  */
-static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
+static void tp_object_prio_queue( struct threadpool_object *object )
 {
+    struct threadpool_worker *worker = NtCurrentTeb()->ThreadPoolData;
     struct threadpool *pool = object->pool;
-    NTSTATUS status = STATUS_UNSUCCESSFUL;
+    struct threadpool_queue *queue = &pool->queue;
 
-    assert( !object->shutdown );
-    assert( !pool->shutdown );
+    if (worker && worker->pool == pool) queue = &worker->queue;
 
-    RtlEnterCriticalSection( &pool->cs );
+    InterlockedIncrement( &pool->num_busy_workers );
+    InterlockedIncrement( &pool->num_queued[object->priority] );
 
-    /* Start new worker threads if required. */
-    if (pool->num_busy_workers >= pool->num_workers &&
-        pool->num_workers < pool->max_workers)
-        status = tp_new_worker_thread( pool );
+    RtlAcquireSRWLockExclusive( &queue->lock );
+    list_add_tail( &queue->objects[object->priority], &object->pool_entry );
+    object->queue = queue;
+    RtlReleaseSRWLockExclusive( &queue->lock );
 
-    /* Queue work item and increment refcount. */
-    InterlockedIncrement( &object->refcount );
-    if (!object->num_pending_callbacks++)
-        tp_object_prio_queue( object );
+    /* Wake up an idle worker thread, or start a new one if all are busy. */
+    if (ReadNoFence( &pool->num_idle_workers ))
+    {
+        InterlockedIncrement( &pool->work_serial );
+        RtlWakeAddressSingle( &pool->work_serial );
+    }
+    else if (ReadNoFence( &pool->num_busy_workers ) > pool->num_workers &&
+             pool->num_workers < pool->max_workers)
+    {
+        RtlEnterCriticalSection( &pool->cs );
+        if (pool->num_busy_workers > pool->num_workers &&
+            pool->num_workers < pool->max_workers)
+            tp_new_worker_thread( pool );
+        RtlLeaveCriticalSection( &pool->cs );
+    }
+}
 
-    /* Count how often the object was signaled. */
-    if (object->type == TP_OBJECT_TYPE_WAIT && signaled)
-        object->u.wait.signaled++;
+/***********************************************************************
+ *           tp_queue_pop    (internal)
+ *
+ * Removes the first object with the given priority from a queue.
+ */
+static struct threadpool_object *tp_queue_pop( struct threadpool *pool, struct threadpool_queue *queue,
+                                               unsigned int priority )
+{
+    struct threadpool_object *object = NULL;
+    struct list *ptr;
 
-    /* No new thread started - wake up one existing thread. */
-    if (status != STATUS_SUCCESS)
+    /* Avoid taking the lock of other workers' queues when there's nothing to steal. */
+    if (list_empty( &queue->objects[priority] ))
+        return NULL;
+
+    RtlAcquireSRWLockExclusive( &queue->lock );
+    if ((ptr = list_head( &queue->objects[priority] )))
     {
-        assert( pool->num_workers > 0 );
-        RtlWakeConditionVariable( &pool->update_event );
+        object = LIST_ENTRY( ptr, struct threadpool_object, pool_entry );
+        list_remove( &object->pool_entry );
+        object->queue = NULL;
     }
+    RtlReleaseSRWLockExclusive( &queue->lock );
 
-    RtlLeaveCriticalSection( &pool->cs );
+    if (object) InterlockedDecrement( &pool->num_queued[priority] );
+    return object;
+}
+
+/***********************************************************************
+ *           tp_object_dequeue    (internal)
+ *
+ * Removes an object from the queue it is in, if any.
+ */
+static BOOL tp_object_dequeue( struct threadpool_object *object )
+{
+    struct threadpool_queue *queue = object->queue;
+    BOOL ret = FALSE;
+
+    if (!queue) return FALSE;
+
+    RtlAcquireSRWLockExclusive( &queue->lock );
+    if (object->queue == queue)
+    {
+        list_remove( &object->pool_entry );
+        object->queue = NULL;
+        ret = TRUE;
+    }
+    RtlReleaseSRWLockExclusive( &queue->lock );
+
+    if (ret)
+    {
+        InterlockedDecrement( &object->pool->num_queued[object->priority] );
+        InterlockedDecrement( &object->pool->num_busy_workers );
+    }
+    return ret;
+}
+
+/***********************************************************************
+ *           threadpool_get_next_object    (internal)
+ *
+ * Returns the next object to execute in order of priority. Objects in the
+ * worker's own queue come first, then the shared queue, then the queues
+ * of other workers.
+ */
+static struct threadpool_object *threadpool_get_next_object( struct threadpool_worker *worker )
+{
+    struct threadpool *pool = worker->pool;
+    struct threadpool_worker *other;
+    struct threadpool_object *object;
+    unsigned int i;
+
+    for (i = 0; i < ARRAY_SIZE(pool->num_queued); ++i)
+    {
+        if (!ReadNoFence( &pool->num_queued[i] )) continue;
+
+        if ((object = tp_queue_pop( pool, &worker->queue, i ))) return object;
+        if ((object = tp_queue_pop( pool, &pool->queue, i ))) return object;
+
+        /* Start with the worker after this one, so that stealing spreads
+         * over the queues. */
+        for (other = worker->next; other; other = other->next)
+            if ((object = tp_queue_pop( pool, &other->queue, i ))) return object;
+        for (other = pool->workers; other != worker; other = other->next)
+            if ((object = tp_queue_pop( pool, &other->queue, i ))) return object;
+    }
+
+    return NULL;
+}
+
+/***********************************************************************
+ *           tp_object_submit    (internal)
+ *
+ * Submits a threadpool object to the associated threadpool. This
+ * function has to be VOID because TpPostWork can never fail on Windows.
+ */
+static void tp_object_submit( struct threadpool_object *object, BOOL signaled )
+{
+    assert( !object->shutdown );
+    assert( !object->pool->shutdown );
+
+    /* Count how often the object was signaled. */
+    if (object->type == TP_OBJECT_TYPE_WAIT && signaled)
+        InterlockedIncrement( &object->u.wait.signaled );
+
+    /* Queue work item and increment refcount. Objects are queued only once,
+     * workers queue them again while further callbacks are pending. */
+    InterlockedIncrement( &object->refcount );
+    if (InterlockedIncrement( &object->num_pending_callbacks ) == 1)
+        tp_object_prio_queue( object );
 }
 
 /***********************************************************************
@@ -2033,22 +2484,27 @@ static void tp_object_cancel( struct threadpool_object *object )
     struct threadpool *pool = object->pool;
     LONG pending_callbacks = 0;
 
-    RtlEnterCriticalSection( &pool->cs );
-    if (object->num_pending_callbacks)
+    /* Once the object is out of its queue nobody else can queue it again. While
+     * it is in no queue with callbacks pending, a worker is about to execute it. */
+    while (ReadAcquire( &object->num_pending_callbacks ))
     {
-        pending_callbacks = object->num_pending_callbacks;
-        object->num_pending_callbacks = 0;
-        list_remove( &object->pool_entry );
-
-        if (object->type == TP_OBJECT_TYPE_WAIT)
-            object->u.wait.signaled = 0;
+        if (tp_object_dequeue( object ))
+        {
+            pending_callbacks = InterlockedExchange( &object->num_pending_callbacks, 0 );
+            if (object->type == TP_OBJECT_TYPE_WAIT)
+                InterlockedExchange( &object->u.wait.signaled, 0 );
+            break;
+        }
+        NtYieldExecution();
     }
+
     if (object->type == TP_OBJECT_TYPE_IO)
     {
+        RtlEnterCriticalSection( &pool->cs );
         object->u.io.skipped_count += object->u.io.pending_count;
         object->u.io.pending_count = 0;
+        RtlLeaveCriticalSection( &pool->cs );
     }
-    RtlLeaveCriticalSection( &pool->cs );
 
     while (pending_callbacks--)
         tp_object_release( object );
@@ -2056,15 +2512,36 @@ static void tp_object_cancel( struct threadpool_object *object )
 
 static BOOL object_is_finished( struct threadpool_object *object, BOOL group )
 {
-    if (object->num_pending_callbacks)
+    /* Callbacks are accounted as running before they stop being pending. */
+    if (ReadAcquire( &object->num_pending_callbacks ))
         return FALSE;
     if (object->type == TP_OBJECT_TYPE_IO && object->u.io.pending_count)
         return FALSE;
 
     if (group)
-        return !object->num_running_callbacks;
+        return !ReadAcquire( &object->num_running_callbacks );
     else
-        return !object->num_associated_callbacks;
+        return !ReadAcquire( &object->num_associated_callbacks );
+}
+
+/***********************************************************************
+ *           tp_object_wake_waiters    (internal)
+ *
+ * Wakes up threads in tp_object_wait after a callback counter dropped to zero.
+ */
+static void tp_object_wake_waiters( struct threadpool_object *object )
+{
+    struct threadpool *pool = object->pool;
+
+    if (!ReadAcquire( &object->num_waiters ))
+        return;
+
+    RtlEnterCriticalSection( &pool->cs );
+    if (object_is_finished( object, TRUE ))
+        RtlWakeAllConditionVariable( &object->group_finished_event );
+    if (object_is_finished( object, FALSE ))
+        RtlWakeAllConditionVariable( &object->finished_event );
+    RtlLeaveCriticalSection( &pool->cs );
 }
 
 /***********************************************************************
@@ -2078,6 +2555,7 @@ static void tp_object_wait( struct threadpool_object *object, BOOL group_wait )
     struct threadpool *pool = object->pool;
 
     RtlEnterCriticalSection( &pool->cs );
+    InterlockedIncrement( &object->num_waiters );
     while (!object_is_finished( object, group_wait ))
     {
         if (group_wait)
@@ -2085,6 +2563,7 @@ static void tp_object_wait( struct threadpool_object *object, BOOL group_wait )
         else
             RtlSleepConditionVariableCS( &object->finished_event, &pool->cs, NULL );
     }
+    InterlockedDecrement( &object->num_waiters );
     RtlLeaveCriticalSection( &pool->cs );
 }
 
@@ -2162,25 +2641,12 @@ static BOOL tp_object_release( struct threadpool_object *object )
     return TRUE;
 }
 
-static struct list *threadpool_get_next_item( const struct threadpool *pool )
-{
-    struct list *ptr;
-    unsigned int i;
-
-    for (i = 0; i < ARRAY_SIZE(pool->pools); ++i)
-    {
-        if ((ptr = list_head( &pool->pools[i] )))
-            break;
-    }
-
-    return ptr;
-}
-
 /***********************************************************************
  *           tp_object_execute    (internal)
  *
- * Executes a threadpool object callback, object->pool->cs has to be
- * held.
+ * Executes a threadpool object callback. Unless called from the wait
+ * thread, this claims one of the pending callbacks of an object taken
+ * from its queue.
  */
 static void tp_object_execute( struct threadpool_object *object, BOOL wait_thread )
 {
@@ -2189,26 +2655,41 @@ static void tp_object_execute( struct threadpool_object *object, BOOL wait_threa
     struct io_completion completion;
     struct threadpool *pool = object->pool;
     TP_WAIT_RESULT wait_result = 0;
+    BOOL finished;
     NTSTATUS status;
+    LONG signaled;
+
+    /* Account the callback as running before it stops being pending, so that
+     * tp_object_wait never sees neither. */
+    InterlockedIncrement( &object->num_associated_callbacks );
+    InterlockedIncrement( &object->num_running_callbacks );
 
-    object->num_pending_callbacks--;
+    /* If further pending callbacks are queued, queue the object again. */
+    if (!wait_thread && InterlockedDecrement( &object->num_pending_callbacks ))
+        tp_object_prio_queue( object );
 
     /* For wait objects check if they were signaled or have timed out. */
     if (object->type == TP_OBJECT_TYPE_WAIT)
     {
-        wait_result = object->u.wait.signaled ? WAIT_OBJECT_0 : WAIT_TIMEOUT;
-        if (wait_result == WAIT_OBJECT_0) object->u.wait.signaled--;
+        wait_result = WAIT_TIMEOUT;
+        while ((signaled = ReadAcquire( &object->u.wait.signaled )))
+        {
+            if (InterlockedCompareExchange( &object->u.wait.signaled, signaled - 1, signaled ) == signaled)
+            {
+                wait_result = WAIT_OBJECT_0;
+                break;
+            }
+        }
     }
     else if (object->type == TP_OBJECT_TYPE_IO)
     {
+        RtlEnterCriticalSection( &pool->cs );
         assert( object->u.io.completion_count );
         completion = object->u.io.completions[--object->u.io.completion_count];
+        RtlLeaveCriticalSection( &pool->cs );
     }
 
-    /* Leave critical section and do the actual callback. */
-    object->num_associated_callbacks++;
-    object->num_running_callbacks++;
-    RtlLeaveCriticalSection( &pool->cs );
+    /* Do the actual callback. */
     if (wait_thread) RtlLeaveCriticalSection( &waitqueue.cs );
 
     /* Initialize threadpool instance struct. */
@@ -2314,7 +2795,6 @@ static void tp_object_execute( struct threadpool_object *object, BOOL wait_threa
 
 skip_cleanup:
     if (wait_thread) RtlEnterCriticalSection( &waitqueue.cs );
-    RtlEnterCriticalSection( &pool->cs );
 
     /* Simple callbacks are automatically shutdown after execution. */
     if (object->type == TP_OBJECT_TYPE_SIMPLE)
@@ -2323,16 +2803,10 @@ skip_cleanup:
         object->shutdown = TRUE;
     }
 
-    object->num_running_callbacks--;
-    if (object_is_finished( object, TRUE ))
-        RtlWakeAllConditionVariable( &object->group_finished_event );
-
-    if (instance.associated)
-    {
-        object->num_associated_callbacks--;
-        if (object_is_finished( object, FALSE ))
-            RtlWakeAllConditionVariable( &object->finished_event );
-    }
+    finished = !InterlockedDecrement( &object->num_running_callbacks );
+    if (instance.associated && !InterlockedDecrement( &object->num_associated_callbacks ))
+        finished = TRUE;
+    if (finished) tp_object_wake_waiters( object );
 }
 
 /***********************************************************************
@@ -2340,56 +2814,90 @@ skip_cleanup:
  */
 static void CALLBACK threadpool_worker_proc( void *param )
 {
-    struct threadpool *pool = param;
+    struct threadpool_worker *worker = param;
+    struct threadpool *pool = worker->pool;
+    struct threadpool_object *object;
     LARGE_INTEGER timeout;
-    struct list *ptr;
+    NTSTATUS status;
+    unsigned int i;
+    LONG serial;
 
     TRACE( "starting worker thread for pool %p\n", pool );
     set_thread_name(L"wine_threadpool_worker");
+    NtCurrentTeb()->ThreadPoolData = worker;
 
-    RtlEnterCriticalSection( &pool->cs );
     for (;;)
     {
-        while ((ptr = threadpool_get_next_item( pool )))
+        if ((object = threadpool_get_next_object( worker )))
         {
-            struct threadpool_object *object = LIST_ENTRY( ptr, struct threadpool_object, pool_entry );
-            assert( object->num_pending_callbacks > 0 );
-
-            /* If further pending callbacks are queued, move the work item to
-             * the end of the pool list. Otherwise remove it from the pool. */
-            list_remove( &object->pool_entry );
-            if (object->num_pending_callbacks > 1)
-                tp_object_prio_queue( object );
-
             tp_object_execute( object, FALSE );
 
-            assert(pool->num_busy_workers);
-            pool->num_busy_workers--;
+            assert( pool->num_busy_workers );
+            InterlockedDecrement( &pool->num_busy_workers );
 
             tp_object_release( object );
+            continue;
+        }
+
+        /* Objects are counted before they are queued, keep looking. */
+        if (threadpool_has_work( pool ))
+        {
+            YieldProcessor();
+            continue;
         }
 
         /* Shutdown worker thread if requested. */
         if (pool->shutdown)
+        {
+            RtlEnterCriticalSection( &pool->cs );
             break;
+        }
 
-        /* Wait for new tasks or until the timeout expires. A thread only terminates
-         * when no new tasks are available, and the number of threads can be
-         * decreased without violating the min_workers limit. An exception is when
-         * min_workers == 0, then objcount is used to detect if the last thread
-         * can be terminated. */
-        timeout.QuadPart = (ULONGLONG)THREADPOOL_WORKER_TIMEOUT * -10000;
-        if (RtlSleepConditionVariableCS( &pool->update_event, &pool->cs, &timeout ) == STATUS_TIMEOUT &&
-            !threadpool_get_next_item( pool ) && (pool->num_workers > max( pool->min_workers, 1 ) ||
+        /* Spin for a while before going to sleep, new work is often submitted
+         * shortly after. Spin longer if that paid off last time. */
+        for (i = 0; i < worker->spin_count; ++i)
+        {
+            if (threadpool_has_work( pool )) break;
+            YieldProcessor();
+        }
+        if (i < worker->spin_count)
+        {
+            worker->spin_count = min( worker->spin_count * 2, THREADPOOL_MAX_SPIN_COUNT );
+            continue;
+        }
+        worker->spin_count = max( worker->spin_count / 2, THREADPOOL_MIN_SPIN_COUNT );
+
+        /* Wait for new tasks or until the timeout expires. Submitters see the
+         * idle count, or the worker sees their objects before going to sleep. */
+        status = STATUS_SUCCESS;
+        InterlockedIncrement( &pool->num_idle_workers );
+        serial = ReadAcquire( &pool->work_serial );
+        if (!threadpool_has_work( pool ) && !pool->shutdown)
+        {
+            timeout.QuadPart = (ULONGLONG)THREADPOOL_WORKER_TIMEOUT * -10000;
+            status = RtlWaitOnAddress( &pool->work_serial, &serial, sizeof(serial), &timeout );
+        }
+        InterlockedDecrement( &pool->num_idle_workers );
+        if (status != STATUS_TIMEOUT) continue;
+
+        /* A thread only terminates when no new tasks are available, and the number
+         * of threads can be decreased without violating the min_workers limit. An
+         * exception is when min_workers == 0, then objcount is used to detect if
+         * the last thread can be terminated. */
+        RtlEnterCriticalSection( &pool->cs );
+        if (!threadpool_has_work( pool ) && (pool->num_workers > max( pool->min_workers, 1 ) ||
             (!pool->min_workers && !pool->objcount)))
         {
             break;
         }
+        RtlLeaveCriticalSection( &pool->cs );
     }
     pool->num_workers--;
+    worker->running = FALSE;
     RtlLeaveCriticalSection( &pool->cs );
 
     TRACE( "terminating worker thread for pool %p\n", pool );
+    NtCurrentTeb()->ThreadPoolData = NULL;
     tp_threadpool_release( pool );
     RtlExitUserThread( 0 );
 }
@@ -2733,7 +3241,7 @@ VOID WINAPI TpDisassociateCallback( TP_CALLBACK_INSTANCE *instance )
     pool = object->pool;
     RtlEnterCriticalSection( &pool->cs );
 
-    object->num_associated_callbacks--;
+    InterlockedDecrement( &object->num_associated_callbacks );
     if (object_is_finished( object, FALSE ))
         RtlWakeAllConditionVariable( &object->finished_event );
 
@@ -3062,30 +3570,32 @@ VOID WINAPI TpSetWait( TP_WAIT *wait, HANDLE handle, LARGE_INTEGER *timeout )
 
     TRACE( "%p %p %p\n", wait, handle, timeout );
 
+    /* Convert relative timeout to absolute timestamp. */
+    if (handle && timeout)
+    {
+        timestamp = timeout->QuadPart;
+        if ((LONGLONG)timestamp < 0)
+        {
+            LARGE_INTEGER now;
+            NtQuerySystemTime( &now );
+            timestamp = now.QuadPart - timestamp;
+        }
+    }
+
     RtlEnterCriticalSection( &waitqueue.cs );
 
-    assert( this->u.wait.bucket );
+    assert( this->u.wait.bucket || this->u.wait.packet );
 
     same_handle = this->u.wait.handle == handle;
     this->u.wait.handle = handle;
 
-    if (handle || this->u.wait.wait_pending)
+    if (this->u.wait.packet)
+        tp_waitqueue_port_set( this, handle, same_handle, timestamp );
+    else if (handle || this->u.wait.wait_pending)
     {
         struct waitqueue_bucket *bucket = this->u.wait.bucket;
         list_remove( &this->u.wait.wait_entry );
 
-        /* Convert relative timeout to absolute timestamp. */
-        if (handle && timeout)
-        {
-            timestamp = timeout->QuadPart;
-            if ((LONGLONG)timestamp < 0)
-            {
-                LARGE_INTEGER now;
-                NtQuerySystemTime( &now );
-                timestamp = now.QuadPart - timestamp;
-            }
-        }
-
         /* Add wait object back into one of the queues. */
         if (handle)
         {
@@ -127,6 +127,7 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(file);
 WINE_DECLARE_DEBUG_CHANNEL(winediag);
+WINE_DECLARE_DEBUG_CHANNEL(dircache);
 
 #define MAX_DOS_DRIVES 26
 
@@ -237,6 +238,26 @@ static const unsigned int dir_data_names_initial_size  = 64;
 static struct dir_data **dir_data_cache;
 static unsigned int dir_data_cache_size;
 
+/* directory contents cached for case-insensitive lookups in find_file_in_dir */
+struct lookup_dir
+{
+    struct list      entry;           /* entry in lookup_dirs list, most recently used first */
+    struct dir_data *data;            /* directory file names, not sorted */
+    LARGE_INTEGER    mtime;           /* directory modification time when it was read */
+    LARGE_INTEGER    ctime;           /* directory change time when it was read */
+    unsigned int     mask;            /* size of the hash tables - 1 */
+    unsigned int    *long_names;      /* long name hash table, names index + 1 */
+    unsigned int    *short_names;     /* short name hash table, names index + 1 */
+};
+
+static const unsigned int lookup_dirs_max_count = 64;
+static const unsigned int lookup_dir_max_names = 16384;
+
+static struct list lookup_dirs = LIST_INIT( lookup_dirs );
+static unsigned int lookup_dirs_count;
+static unsigned int lookup_hits, lookup_misses, lookup_stale;
+static pthread_mutex_t lookup_mutex = PTHREAD_MUTEX_INITIALIZER;
+
 static BOOL show_dot_files;
 static mode_t start_umask;
 
@@ -2780,6 +2801,193 @@ NTSTATUS WINAPI NtQueryDirectoryFile( HANDLE handle, HANDLE event, PIO_APC_ROUTI
 }
 
 
+/* case-insensitive hash of a file name, for the lookup_dir hash tables */
+static unsigned int hash_lookup_name( const WCHAR *name, int length )
+{
+    unsigned int hash = 0;
+    while (length--) hash = hash * 65599 + towupper( *name++ );
+    return hash;
+}
+
+static void free_lookup_dir( struct lookup_dir *dir )
+{
+    free_dir_data( dir->data );
+    free( dir->long_names );
+    free( dir->short_names );
+    free( dir );
+}
+
+static void add_lookup_dir_hash( unsigned int *table, unsigned int mask, const WCHAR *name, unsigned int index )
+{
+    unsigned int pos = hash_lookup_name( name, wcslen( name ) ) & mask;
+    while (table[pos]) pos = (pos + 1) & mask;
+    table[pos] = index + 1;
+}
+
+/***********************************************************************
+ *           read_lookup_dir
+ *
+ * Read the names of a directory into a new lookup cache entry.
+ */
+static struct lookup_dir *read_lookup_dir( const char *unix_name, const struct stat *st )
+{
+    WCHAR long_nameW[MAX_DIR_ENTRY_LEN + 1], short_nameW[13];
+    LARGE_INTEGER atime, creation;
+    struct lookup_dir *dir;
+    struct dirent *de;
+    unsigned int i, size;
+    int long_len, short_len;
+    DIR *unix_dir;
+
+#ifdef VFAT_IOCTL_READDIR_BOTH
+    /* don't cache vfat directories, short names are retrieved from the file system there */
+    int fd = open( unix_name, O_RDONLY | O_DIRECTORY );
+    if (fd != -1)
+    {
+        KERNEL_DIRENT kde[2];
+        BOOL is_vfat = ioctl( fd, VFAT_IOCTL_READDIR_BOTH, (long)kde ) != -1;
+        close( fd );
+        if (is_vfat) return NULL;
+    }
+#endif
+
+    if (!(dir = calloc( 1, sizeof(*dir) ))) return NULL;
+    if (!(dir->data = calloc( 1, sizeof(*dir->data) ))) goto failed;
+    dir->data->id.dev = st->st_dev;
+    dir->data->id.ino = st->st_ino;
+    get_file_times( st, &dir->mtime, &dir->ctime, &atime, &creation );
+
+    if (!(unix_dir = opendir( unix_name ))) goto failed;
+    while ((de = readdir( unix_dir )))
+    {
+        if (!strcmp( de->d_name, "." ) || !strcmp( de->d_name, ".." )) continue;
+        if (dir->data->count >= lookup_dir_max_names) break;
+
+        long_len = ntdll_umbstowcs( de->d_name, strlen(de->d_name), long_nameW, ARRAY_SIZE(long_nameW) );
+        if (long_len == ARRAY_SIZE(long_nameW)) continue;
+        long_nameW[long_len] = 0;
+        short_len = 0;
+        if (!is_legal_8dot3_name( long_nameW, long_len ))
+            short_len = hash_short_file_name( long_nameW, long_len, short_nameW );
+        short_nameW[short_len] = 0;
+        if (!add_dir_data_names( dir->data, long_nameW, short_nameW, de->d_name )) break;
+    }
+    closedir( unix_dir );
+    if (de) goto failed;  /* too many names, or out of memory */
+
+    for (size = 16; size < dir->data->count * 2; size *= 2) ;
+    if (!(dir->long_names = calloc( size, sizeof(*dir->long_names) ))) goto failed;
+    if (!(dir->short_names = calloc( size, sizeof(*dir->short_names) ))) goto failed;
+    dir->mask = size - 1;
+
+    for (i = 0; i < dir->data->count; i++)
+    {
+        add_lookup_dir_hash( dir->long_names, dir->mask, dir->data->names[i].long_name, i );
+        if (dir->data->names[i].short_name[0])
+            add_lookup_dir_hash( dir->short_names, dir->mask, dir->data->names[i].short_name, i );
+    }
+    return dir;
+
+failed:
+    free_lookup_dir( dir );
+    return NULL;
+}
+
+/* find a name in a lookup cache entry, lookup_mutex must be held */
+static const char *find_lookup_dir_name( const struct lookup_dir *dir, const unsigned int *table,
+                                         const WCHAR *name, int length, BOOL short_name )
+{
+    unsigned int pos = hash_lookup_name( name, length ) & dir->mask, index;
+
+    while ((index = table[pos]))
+    {
+        const struct dir_data_names *names = dir->data->names + index - 1;
+        const WCHAR *str = short_name ? names->short_name : names->long_name;
+
+        if (!wcsnicmp( str, name, length ) && !str[length]) return names->unix_name;
+        pos = (pos + 1) & dir->mask;
+    }
+    return NULL;
+}
+
+/***********************************************************************
+ *           find_file_in_lookup_cache
+ *
+ * Look for a file name in the cached contents of a directory, reading them if necessary.
+ * Returns STATUS_NOT_SUPPORTED when the directory contents can't be cached.
+ */
+static NTSTATUS find_file_in_lookup_cache( char *unix_name, int pos, const WCHAR *name, int length,
+                                           BOOLEAN is_name_8_dot_3 )
+{
+    LARGE_INTEGER mtime, ctime, atime, creation;
+    struct lookup_dir *iter, *dir = NULL, *new_dir = NULL;
+    const char *found = NULL;
+    struct stat st;
+
+    if (stat( unix_name, &st ) || !S_ISDIR( st.st_mode )) return STATUS_NOT_SUPPORTED;
+    get_file_times( &st, &mtime, &ctime, &atime, &creation );
+
+    for (;;)
+    {
+        mutex_lock( &lookup_mutex );
+
+        LIST_FOR_EACH_ENTRY( iter, &lookup_dirs, struct lookup_dir, entry )
+        {
+            if (iter->data->id.dev != st.st_dev || iter->data->id.ino != st.st_ino) continue;
+            list_remove( &iter->entry );
+            if (!new_dir && iter->mtime.QuadPart == mtime.QuadPart && iter->ctime.QuadPart == ctime.QuadPart)
+            {
+                dir = iter;
+                lookup_hits++;
+                break;
+            }
+            /* the directory changed since it was read, or we just read it again */
+            if (!new_dir) lookup_stale++;
+            lookup_dirs_count--;
+            free_lookup_dir( iter );
+            break;
+        }
+
+        if (new_dir)
+        {
+            dir = new_dir;
+            lookup_dirs_count++;
+        }
+
+        if (dir)
+        {
+            list_add_head( &lookup_dirs, &dir->entry );
+            if (lookup_dirs_count > lookup_dirs_max_count)
+            {
+                struct lookup_dir *last = LIST_ENTRY( list_tail( &lookup_dirs ), struct lookup_dir, entry );
+                list_remove( &last->entry );
+                lookup_dirs_count--;
+                free_lookup_dir( last );
+            }
+
+            if (!(found = find_lookup_dir_name( dir, dir->long_names, name, length, FALSE )) && is_name_8_dot_3)
+                found = find_lookup_dir_name( dir, dir->short_names, name, length, TRUE );
+            if (found)
+            {
+                unix_name[pos - 1] = '/';
+                strcpy( unix_name + pos, found );
+            }
+            mutex_unlock( &lookup_mutex );
+            return found ? STATUS_SUCCESS : STATUS_OBJECT_NAME_NOT_FOUND;
+        }
+
+        lookup_misses++;
+        TRACE_( dircache )( "reading %s, hits %u misses %u stale %u\n", debugstr_a(unix_name),
+                            lookup_hits, lookup_misses, lookup_stale );
+        mutex_unlock( &lookup_mutex );
+
+        /* don't cache directories modified too recently, their timestamps may not change on the next update */
+        if (time( NULL ) - max( st.st_mtime, st.st_ctime ) < 2) return STATUS_NOT_SUPPORTED;
+        if (!(new_dir = read_lookup_dir( unix_name, &st ))) return STATUS_NOT_SUPPORTED;
+    }
+}
+
+
 /***********************************************************************
  *           find_file_in_dir
  *
@@ -2820,6 +3028,14 @@ static NTSTATUS find_file_in_dir( char *unix_name, int pos, const WCHAR *name, i
 
     if (!is_name_8_dot_3 && !get_dir_case_sensitivity( unix_name )) goto not_found;
 
+    /* check the cached directory contents */
+
+    if ((ret = find_file_in_lookup_cache( unix_name, pos, name, length, is_name_8_dot_3 )) != STATUS_NOT_SUPPORTED)
+    {
+        if (ret == STATUS_SUCCESS) return STATUS_SUCCESS;
+        goto not_found;
+    }
+
     /* now look for it through the directory */
 
 #ifdef VFAT_IOCTL_READDIR_BOTH
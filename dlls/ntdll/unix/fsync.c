@@ -0,0 +1,547 @@
+/*
+ * Fast in-process synchronization
+ *
+ * Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#if 0
+#pragma makedep unix
+#endif
+
+#include "config.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+# include <linux/futex.h>
+#endif
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winternl.h"
+#include "wine/server.h"
+#include "wine/debug.h"
+#include "unix_private.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(fsync);
+
+/*
+ * When the server was started with WINEFSYNC=1, events, mutexes and
+ * semaphores keep their state in a file shared with the server (see
+ * server/fsync.c). Simple waits and signal operations on such objects are
+ * done here with futexes; everything else falls back to the server by
+ * returning STATUS_NOT_IMPLEMENTED.
+ */
+
+#ifdef __linux__
+
+#ifndef __NR_futex_waitv
+#define __NR_futex_waitv 449
+#endif
+#ifndef FUTEX_32
+#define FUTEX_32 2
+#endif
+
+struct fsync_futex_waitv
+{
+    UINT64 val;
+    UINT64 uaddr;
+    UINT   flags;
+    UINT   reserved;
+};
+
+#define FSYNC_OBJS_PER_BLOCK (FSYNC_BLOCK_SIZE / sizeof(fsync_shm_t))
+
+static int fsync_fd = -1;
+static void *fsync_blocks[FSYNC_MAX_BLOCKS];
+static BOOL futex_waitv_supported = TRUE;
+
+struct fsync_object
+{
+    enum fsync_type  type;
+    unsigned int     access;
+    unsigned int     idx;    /* index of the shared state */
+    fsync_shm_t     *shm;
+    int              start;  /* event state when the wait started, for pulses */
+};
+
+static int futex_wait_shared( const int *addr, int val, const struct timespec *timeout )
+{
+    return syscall( __NR_futex, addr, FUTEX_WAIT, val, timeout, 0, 0 );
+}
+
+static int futex_wake_shared( const int *addr, int count )
+{
+    return syscall( __NR_futex, addr, FUTEX_WAKE, count, NULL, 0, 0 );
+}
+
+static int futex_waitv( const struct fsync_futex_waitv *futexes, unsigned int count,
+                        const struct timespec *end )
+{
+    return syscall( __NR_futex_waitv, futexes, count, 0, end, CLOCK_MONOTONIC );
+}
+
+
+/***********************************************************************
+ *           fsync_init
+ */
+void fsync_init( const char *server_dir )
+{
+    const char *env = getenv( "WINEFSYNC" );
+    char *path;
+
+    if (!env || !atoi( env ) || !server_dir) return;
+
+    if (asprintf( &path, "%s/fsync", server_dir ) == -1) return;
+    if ((fsync_fd = open( path, O_RDWR | O_CLOEXEC )) == -1)
+        WARN( "cannot open %s: %s, fast synchronization disabled\n", path, strerror( errno ));
+    else
+        TRACE( "using fast synchronization\n" );
+    free( path );
+}
+
+
+/***********************************************************************
+ *           do_fsync
+ */
+BOOL do_fsync(void)
+{
+    return fsync_fd != -1;
+}
+
+
+static fsync_shm_t *get_fsync_shm( unsigned int idx )
+{
+    unsigned int block = idx / FSYNC_OBJS_PER_BLOCK;
+    void *ptr;
+
+    if (block >= FSYNC_MAX_BLOCKS) return NULL;
+
+    if (!(ptr = __atomic_load_n( &fsync_blocks[block], __ATOMIC_ACQUIRE )))
+    {
+        ptr = mmap( NULL, FSYNC_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fsync_fd,
+                    (off_t)block * FSYNC_BLOCK_SIZE );
+        if (ptr == MAP_FAILED)
+        {
+            ERR( "failed to map block %u: %s\n", block, strerror( errno ));
+            return NULL;
+        }
+        if (InterlockedCompareExchangePointer( &fsync_blocks[block], ptr, NULL ))
+        {
+            munmap( ptr, FSYNC_BLOCK_SIZE );
+            ptr = fsync_blocks[block];
+        }
+    }
+    return (fsync_shm_t *)ptr + idx % FSYNC_OBJS_PER_BLOCK;
+}
+
+static BOOL get_fsync_object( HANDLE handle, struct fsync_object *obj )
+{
+    if (server_get_fsync_idx( handle, &obj->type, &obj->idx, &obj->access )) return FALSE;
+    return (obj->shm = get_fsync_shm( obj->idx )) != NULL;
+}
+
+/* get the record of the mutexes owned by the current thread, which the server reads to
+ * abandon them when the thread dies */
+static fsync_thread_t *get_fsync_thread(void)
+{
+    struct ntdll_thread_data *thread_data = ntdll_get_thread_data();
+    unsigned int idx = 0;
+
+    if (thread_data->fsync_idx == -1) return NULL;
+    if (!thread_data->fsync_idx)
+    {
+        SERVER_START_REQ( get_fsync_thread_idx )
+        {
+            if (!wine_server_call( req )) idx = reply->shm_idx;
+        }
+        SERVER_END_REQ;
+        thread_data->fsync_idx = idx ? idx : -1;
+        if (!idx) return NULL;
+    }
+    return (fsync_thread_t *)get_fsync_shm( thread_data->fsync_idx );
+}
+
+/* find a free entry in the owned mutexes record, dropping those which were
+ * released behind our back by the server */
+static int get_free_mutex_slot( fsync_thread_t *record )
+{
+    int i, idx, tid = GetCurrentThreadId();
+    fsync_shm_t *shm;
+
+    for (i = 0; i < FSYNC_THREAD_MUTEXES; i++)
+    {
+        if (!(idx = __atomic_load_n( &record->mutexes[i], __ATOMIC_SEQ_CST ))) return i;
+        if (!(shm = get_fsync_shm( idx ))) continue;
+        if (__atomic_load_n( &shm->state, __ATOMIC_SEQ_CST ) == tid) continue;
+        __atomic_store_n( &record->mutexes[i], 0, __ATOMIC_SEQ_CST );
+        return i;
+    }
+    return -1;
+}
+
+static void remove_owned_mutex( fsync_thread_t *record, unsigned int idx )
+{
+    int i;
+
+    for (i = 0; i < FSYNC_THREAD_MUTEXES; i++)
+        if (record->mutexes[i] == idx) __atomic_store_n( &record->mutexes[i], 0, __ATOMIC_SEQ_CST );
+}
+
+/* the server only needs to be told about state changes if some of its threads are waiting */
+static void notify_server( HANDLE handle, fsync_shm_t *shm )
+{
+    if (!__atomic_load_n( &shm->waiters, __ATOMIC_SEQ_CST )) return;
+
+    SERVER_START_REQ( fsync_wake )
+    {
+        req->handle = wine_server_obj_handle( handle );
+        wine_server_call( req );
+    }
+    SERVER_END_REQ;
+}
+
+/* check whether the event was pulsed since the wait started */
+static inline BOOL event_pulsed( const struct fsync_object *obj, int state )
+{
+    return (state & ~(FSYNC_EVENT_SIGNALED | FSYNC_EVENT_PULSED)) !=
+           (obj->start & ~(FSYNC_EVENT_SIGNALED | FSYNC_EVENT_PULSED));
+}
+
+/* try to acquire the object; on failure, return the value to wait for a change of */
+static NTSTATUS try_acquire( struct fsync_object *obj, int *wait_value )
+{
+    fsync_shm_t *shm = obj->shm;
+    fsync_thread_t *record;
+    int current, tid, slot;
+
+    switch (obj->type)
+    {
+    case FSYNC_EVENT:
+        current = __atomic_load_n( &shm->state, __ATOMIC_SEQ_CST );
+        if (shm->count)  /* manual reset, a pulse releases all waiters */
+        {
+            if ((current & FSYNC_EVENT_SIGNALED) || event_pulsed( obj, current )) return STATUS_WAIT_0;
+        }
+        else for (;;)  /* auto reset, a pulse releases a single waiter */
+        {
+            int new_state;
+
+            if (current & FSYNC_EVENT_SIGNALED) new_state = current & ~FSYNC_EVENT_SIGNALED;
+            else if ((current & FSYNC_EVENT_PULSED) && event_pulsed( obj, current ))
+                new_state = current & ~FSYNC_EVENT_PULSED;
+            else break;
+            if (__atomic_compare_exchange_n( &shm->state, &current, new_state, 0,
+                                             __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ))
+                return STATUS_WAIT_0;
+        }
+        *wait_value = current;
+        return STATUS_PENDING;
+
+    case FSYNC_SEMAPHORE:
+        while ((current = __atomic_load_n( &shm->state, __ATOMIC_SEQ_CST )))
+            if (InterlockedCompareExchange( (LONG *)&shm->state, current - 1, current ) == current)
+                return STATUS_WAIT_0;
+        *wait_value = 0;
+        return STATUS_PENDING;
+
+    case FSYNC_MUTEX:
+        tid = GetCurrentThreadId();
+        current = __atomic_load_n( &shm->state, __ATOMIC_SEQ_CST );
+        if (current == tid)
+        {
+            if (shm->count == INT_MAX) return STATUS_MUTANT_LIMIT_EXCEEDED;
+            shm->count++;
+            return STATUS_WAIT_0;
+        }
+        if (!current)
+        {
+            /* the server has to be able to find the mutex if we die holding it */
+            if (!(record = get_fsync_thread()) || (slot = get_free_mutex_slot( record )) == -1)
+                return STATUS_NOT_IMPLEMENTED;
+            __atomic_store_n( &record->pending, obj->idx, __ATOMIC_SEQ_CST );
+            current = InterlockedCompareExchange( (LONG *)&shm->state, tid, 0 );
+            if (!current) __atomic_store_n( &record->mutexes[slot], obj->idx, __ATOMIC_SEQ_CST );
+            __atomic_store_n( &record->pending, 0, __ATOMIC_SEQ_CST );
+        }
+        if (!current)
+        {
+            shm->count = 1;
+            if (!shm->abandoned) return STATUS_WAIT_0;
+            shm->abandoned = 0;
+            return STATUS_ABANDONED_WAIT_0;
+        }
+        *wait_value = current;
+        return STATUS_PENDING;
+
+    default:
+        assert( 0 );
+        return STATUS_INVALID_HANDLE;
+    }
+}
+
+static void get_wait_end( const LARGE_INTEGER *timeout, struct timespec *end )
+{
+    LONGLONG rel = timeout->QuadPart;
+
+    if (rel > 0)  /* absolute system time */
+    {
+        LARGE_INTEGER now;
+        NtQuerySystemTime( &now );
+        rel = max( 0, rel - now.QuadPart );
+    }
+    else rel = -rel;
+
+    clock_gettime( CLOCK_MONOTONIC, end );
+    end->tv_sec += rel / TICKSPERSEC;
+    end->tv_nsec += (rel % TICKSPERSEC) * 100;
+    if (end->tv_nsec >= 1000000000)
+    {
+        end->tv_sec++;
+        end->tv_nsec -= 1000000000;
+    }
+}
+
+/* compute the time left until end; return FALSE if it has already passed */
+static BOOL get_time_left( const struct timespec *end, struct timespec *left )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    left->tv_sec = end->tv_sec - now.tv_sec;
+    left->tv_nsec = end->tv_nsec - now.tv_nsec;
+    if (left->tv_nsec < 0)
+    {
+        left->tv_sec--;
+        left->tv_nsec += 1000000000;
+    }
+    return left->tv_sec >= 0;
+}
+
+
+/***********************************************************************
+ *           fsync_wait_objects
+ */
+NTSTATUS fsync_wait_objects( DWORD count, const HANDLE *handles, BOOLEAN wait_any,
+                             BOOLEAN alertable, const LARGE_INTEGER *timeout )
+{
+    struct fsync_object objs[MAXIMUM_WAIT_OBJECTS];
+    struct fsync_futex_waitv futexes[MAXIMUM_WAIT_OBJECTS];
+    struct timespec end, left;
+    NTSTATUS ret;
+    DWORD i;
+    int value = 0;
+
+    /* alertable and wait-all waits need the server */
+    if (alertable || (!wait_any && count > 1)) return STATUS_NOT_IMPLEMENTED;
+    if (count > 1 && !futex_waitv_supported) return STATUS_NOT_IMPLEMENTED;
+
+    for (i = 0; i < count; i++)
+    {
+        if (!get_fsync_object( handles[i], &objs[i] )) return STATUS_NOT_IMPLEMENTED;
+        if (!(objs[i].access & SYNCHRONIZE)) return STATUS_NOT_IMPLEMENTED;
+        objs[i].start = __atomic_load_n( &objs[i].shm->state, __ATOMIC_SEQ_CST );
+    }
+
+    if (timeout) get_wait_end( timeout, &end );
+
+    TRACE( "waiting for %u objects, timeout %s\n", (int)count,
+           timeout ? wine_dbgstr_longlong( timeout->QuadPart ) : "(infinite)" );
+
+    for (;;)
+    {
+        for (i = 0; i < count; i++)
+        {
+            if ((ret = try_acquire( &objs[i], &value )) != STATUS_PENDING)
+            {
+                if (ret == STATUS_WAIT_0 || ret == STATUS_ABANDONED_WAIT_0) ret += i;
+                TRACE( "acquired %p, status %#x\n", handles[i], (int)ret );
+                return ret;
+            }
+            futexes[i].val = value;
+            futexes[i].uaddr = (ULONG_PTR)&objs[i].shm->state;
+            futexes[i].flags = FUTEX_32;
+            futexes[i].reserved = 0;
+        }
+
+        if (timeout && !get_time_left( &end, &left )) return STATUS_TIMEOUT;
+
+        if (count == 1)
+            ret = futex_wait_shared( (const int *)&objs[0].shm->state, value, timeout ? &left : NULL );
+        else if ((ret = futex_waitv( futexes, count, timeout ? &end : NULL )) == -1 && errno == ENOSYS)
+        {
+            WARN( "futex_waitv not supported, falling back to server waits\n" );
+            futex_waitv_supported = FALSE;
+            return STATUS_NOT_IMPLEMENTED;
+        }
+
+        if (ret == -1 && errno == ETIMEDOUT) return STATUS_TIMEOUT;
+        /* EAGAIN, EINTR and wake-ups all go back to trying to acquire */
+    }
+}
+
+
+/***********************************************************************
+ *           fsync_set_event
+ */
+NTSTATUS fsync_set_event( HANDLE handle, LONG *prev_state )
+{
+    struct fsync_object obj;
+    LONG prev;
+
+    if (!get_fsync_object( handle, &obj ) || obj.type != FSYNC_EVENT) return STATUS_NOT_IMPLEMENTED;
+    if (!(obj.access & EVENT_MODIFY_STATE)) return STATUS_ACCESS_DENIED;
+
+    if (!(prev = __atomic_fetch_or( &obj.shm->state, FSYNC_EVENT_SIGNALED, __ATOMIC_SEQ_CST ) & FSYNC_EVENT_SIGNALED))
+    {
+        futex_wake_shared( (const int *)&obj.shm->state, INT_MAX );
+        notify_server( handle, obj.shm );
+    }
+    if (prev_state) *prev_state = prev;
+    return STATUS_SUCCESS;
+}
+
+
+/***********************************************************************
+ *           fsync_reset_event
+ */
+NTSTATUS fsync_reset_event( HANDLE handle, LONG *prev_state )
+{
+    struct fsync_object obj;
+    LONG prev;
+
+    if (!get_fsync_object( handle, &obj ) || obj.type != FSYNC_EVENT) return STATUS_NOT_IMPLEMENTED;
+    if (!(obj.access & EVENT_MODIFY_STATE)) return STATUS_ACCESS_DENIED;
+
+    prev = __atomic_fetch_and( &obj.shm->state, ~FSYNC_EVENT_SIGNALED, __ATOMIC_SEQ_CST ) & FSYNC_EVENT_SIGNALED;
+    if (prev_state) *prev_state = prev;
+    return STATUS_SUCCESS;
+}
+
+
+/***********************************************************************
+ *           fsync_release_semaphore
+ */
+NTSTATUS fsync_release_semaphore( HANDLE handle, ULONG count, ULONG *previous )
+{
+    struct fsync_object obj;
+    ULONG current, new_count;
+
+    if (!get_fsync_object( handle, &obj ) || obj.type != FSYNC_SEMAPHORE) return STATUS_NOT_IMPLEMENTED;
+    if (!(obj.access & SEMAPHORE_MODIFY_STATE)) return STATUS_ACCESS_DENIED;
+
+    do
+    {
+        current = __atomic_load_n( &obj.shm->state, __ATOMIC_SEQ_CST );
+        new_count = current + count;
+        if (new_count < current || new_count > (ULONG)obj.shm->count)
+            return STATUS_SEMAPHORE_LIMIT_EXCEEDED;
+    } while (InterlockedCompareExchange( (LONG *)&obj.shm->state, new_count, current ) != current);
+
+    if (!current)
+    {
+        futex_wake_shared( (const int *)&obj.shm->state, INT_MAX );
+        notify_server( handle, obj.shm );
+    }
+    if (previous) *previous = current;
+    return STATUS_SUCCESS;
+}
+
+
+/***********************************************************************
+ *           fsync_release_mutex
+ */
+NTSTATUS fsync_release_mutex( HANDLE handle, LONG *prev_count )
+{
+    struct fsync_object obj;
+    fsync_thread_t *record;
+    int count;
+
+    if (!get_fsync_object( handle, &obj ) || obj.type != FSYNC_MUTEX) return STATUS_NOT_IMPLEMENTED;
+
+    if (__atomic_load_n( &obj.shm->state, __ATOMIC_SEQ_CST ) != GetCurrentThreadId())
+        return STATUS_MUTANT_NOT_OWNED;
+
+    count = obj.shm->count--;
+    if (count == 1)
+    {
+        /* keep it visible to the server until it's really released */
+        if ((record = get_fsync_thread()))
+        {
+            __atomic_store_n( &record->pending, obj.idx, __ATOMIC_SEQ_CST );
+            remove_owned_mutex( record, obj.idx );
+        }
+        InterlockedExchange( (LONG *)&obj.shm->state, 0 );
+        if (record) __atomic_store_n( &record->pending, 0, __ATOMIC_SEQ_CST );
+        futex_wake_shared( (const int *)&obj.shm->state, INT_MAX );
+        notify_server( handle, obj.shm );
+    }
+    if (prev_count) *prev_count = 1 - count;
+    return STATUS_SUCCESS;
+}
+
+#else  /* __linux__ */
+
+void fsync_init( const char *server_dir )
+{
+}
+
+BOOL do_fsync(void)
+{
+    return FALSE;
+}
+
+NTSTATUS fsync_wait_objects( DWORD count, const HANDLE *handles, BOOLEAN wait_any,
+                             BOOLEAN alertable, const LARGE_INTEGER *timeout )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+NTSTATUS fsync_set_event( HANDLE handle, LONG *prev_state )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+NTSTATUS fsync_reset_event( HANDLE handle, LONG *prev_state )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+NTSTATUS fsync_release_semaphore( HANDLE handle, ULONG count, ULONG *previous )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+NTSTATUS fsync_release_mutex( HANDLE handle, LONG *prev_count )
+{
+    return STATUS_NOT_IMPLEMENTED;
+}
+
+#endif  /* __linux__ */
@@ -1080,6 +1080,128 @@ static int remove_fd_from_cache( HANDLE handle )
 }
 
 
+/***********************************************************************/
+/* fsync index cache support */
+
+union fsync_cache_entry
+{
+    LONG64 data;
+    struct
+    {
+        unsigned int     shm_idx;
+        enum fsync_type  type : 8;
+        unsigned int     cached : 1;
+        unsigned int     access : 23;
+    } s;
+};
+
+C_ASSERT( sizeof(union fsync_cache_entry) == sizeof(LONG64) );
+
+static union fsync_cache_entry *fsync_cache[FD_CACHE_ENTRIES];
+
+
+/***********************************************************************
+ *           add_fsync_idx_to_cache
+ *
+ * Caller must hold fd_cache_mutex.
+ */
+static void add_fsync_idx_to_cache( HANDLE handle, enum fsync_type type, unsigned int shm_idx,
+                                    unsigned int access )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    union fsync_cache_entry cache;
+
+    if (entry >= FD_CACHE_ENTRIES) return;
+
+    if (!fsync_cache[entry])  /* do we need to allocate a new block of entries? */
+    {
+        void *ptr = anon_mmap_alloc( FD_CACHE_BLOCK_SIZE * sizeof(union fsync_cache_entry),
+                                     PROT_READ | PROT_WRITE );
+        if (ptr == MAP_FAILED) return;
+        fsync_cache[entry] = ptr;
+    }
+
+    cache.s.shm_idx = shm_idx;
+    cache.s.type = type;
+    cache.s.cached = 1;
+    cache.s.access = access;
+    interlocked_xchg64( &fsync_cache[entry][idx].data, cache.data );
+}
+
+
+/***********************************************************************
+ *           get_cached_fsync_idx
+ */
+static inline BOOL get_cached_fsync_idx( HANDLE handle, enum fsync_type *type, unsigned int *shm_idx,
+                                         unsigned int *access )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+    union fsync_cache_entry cache;
+
+    if (entry >= FD_CACHE_ENTRIES || !fsync_cache[entry]) return FALSE;
+
+    cache.data = InterlockedCompareExchange64( &fsync_cache[entry][idx].data, 0, 0 );
+    if (!cache.s.cached) return FALSE;
+
+    *type = cache.s.type;
+    *shm_idx = cache.s.shm_idx;
+    *access = cache.s.access;
+    return TRUE;
+}
+
+
+/***********************************************************************
+ *           remove_fsync_idx_from_cache
+ */
+static void remove_fsync_idx_from_cache( HANDLE handle )
+{
+    unsigned int entry, idx = handle_to_index( handle, &entry );
+
+    if (entry < FD_CACHE_ENTRIES && fsync_cache[entry])
+        interlocked_xchg64( &fsync_cache[entry][idx].data, 0 );
+}
+
+
+/***********************************************************************
+ *           server_get_fsync_idx
+ *
+ * Retrieve the fsync shared memory index of an object, caching the result.
+ * Returns STATUS_NOT_IMPLEMENTED for objects that don't support fsync.
+ */
+NTSTATUS server_get_fsync_idx( HANDLE handle, enum fsync_type *type, unsigned int *shm_idx,
+                               unsigned int *access )
+{
+    sigset_t sigset;
+    unsigned int ret = STATUS_SUCCESS;
+
+    if (!handle || HandleToLong( handle ) < 0) return STATUS_NOT_IMPLEMENTED;
+
+    if (!get_cached_fsync_idx( handle, type, shm_idx, access ))
+    {
+        server_enter_uninterrupted_section( &fd_cache_mutex, &sigset );
+        if (!get_cached_fsync_idx( handle, type, shm_idx, access ))
+        {
+            SERVER_START_REQ( get_fsync_idx )
+            {
+                req->handle = wine_server_obj_handle( handle );
+                ret = wine_server_call( req );
+                *type    = reply->type;
+                *shm_idx = reply->shm_idx;
+                *access  = reply->access & 0x7fffff;
+            }
+            SERVER_END_REQ;
+
+            if (!ret) add_fsync_idx_to_cache( handle, *type, *shm_idx, *access );
+            else if (ret == STATUS_NOT_IMPLEMENTED) add_fsync_idx_to_cache( handle, FSYNC_NONE, 0, 0 );
+        }
+        server_leave_uninterrupted_section( &fd_cache_mutex, &sigset );
+    }
+
+    if (!ret && *type == FSYNC_NONE) ret = STATUS_NOT_IMPLEMENTED;
+    return ret;
+}
+
+
 /***********************************************************************
  *           server_get_unix_fd
  *
@@ -1616,6 +1738,8 @@ size_t server_init_process(void)
 
     if (ret) server_protocol_error( "init_first_thread failed with status %x\n", ret );
 
+    fsync_init( server_dir );
+
     if (!supported_machines_count)
         fatal_error( "'%s' is a 64-bit installation, it cannot be used with a 32-bit wineserver.\n",
                      config_dir );
@@ -1758,7 +1882,10 @@ NTSTATUS WINAPI NtDuplicateObject( HANDLE source_process, HANDLE source, HANDLE
     /* always remove the cached fd; if the server request fails we'll just
      * retrieve it again */
     if (options & DUPLICATE_CLOSE_SOURCE)
+    {
         fd = remove_fd_from_cache( source );
+        remove_fsync_idx_from_cache( source );
+    }
 
     SERVER_START_REQ( dup_handle )
     {
@@ -1829,6 +1956,7 @@ NTSTATUS WINAPI NtClose( HANDLE handle )
     /* always remove the cached fd; if the server request fails we'll just
      * retrieve it again */
     fd = remove_fd_from_cache( handle );
+    remove_fsync_idx_from_cache( handle );
 
     SERVER_START_REQ( close_handle )
     {
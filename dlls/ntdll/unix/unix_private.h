@@ -111,6 +111,7 @@ struct ntdll_thread_data
     PRTL_THREAD_START_ROUTINE start;  /* thread entry point */
     void              *param;         /* thread entry point parameter */
     void              *jmp_buf;       /* setjmp buffer for exception handling */
+    int                fsync_idx;     /* fsync owned mutexes record, -1 if unavailable */
 };
 
 C_ASSERT( sizeof(struct ntdll_thread_data) <= sizeof(((TEB *)0)->GdiTebBatch) );
@@ -215,6 +216,8 @@ extern unsigned int server_queue_process_apc( HANDLE process, const apc_call_t *
                                               apc_result_t *result );
 extern int server_get_unix_fd( HANDLE handle, unsigned int wanted_access, int *unix_fd,
                                int *needs_close, enum server_fd_type *type, unsigned int *options );
+extern NTSTATUS server_get_fsync_idx( HANDLE handle, enum fsync_type *type, unsigned int *shm_idx,
+                                      unsigned int *access );
 extern void wine_server_send_fd( int fd );
 extern void process_exit_wrapper( int status ) DECLSPEC_NORETURN;
 extern size_t server_init_process(void);
@@ -222,6 +225,15 @@ extern void server_init_process_done(void);
 extern void server_init_thread( void *entry_point, BOOL *suspend );
 extern int server_pipe( int fd[2] );
 
+extern void fsync_init( const char *server_dir );
+extern BOOL do_fsync(void);
+extern NTSTATUS fsync_wait_objects( DWORD count, const HANDLE *handles, BOOLEAN wait_any,
+                                    BOOLEAN alertable, const LARGE_INTEGER *timeout );
+extern NTSTATUS fsync_set_event( HANDLE handle, LONG *prev_state );
+extern NTSTATUS fsync_reset_event( HANDLE handle, LONG *prev_state );
+extern NTSTATUS fsync_release_semaphore( HANDLE handle, ULONG count, ULONG *previous );
+extern NTSTATUS fsync_release_mutex( HANDLE handle, LONG *prev_count );
+
 extern void fpux_to_fpu( I386_FLOATING_SAVE_AREA *fpu, const XSAVE_FORMAT *fpux );
 extern void fpu_to_fpux( XSAVE_FORMAT *fpux, const I386_FLOATING_SAVE_AREA *fpu );
 
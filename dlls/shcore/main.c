@@ -540,6 +540,11 @@ struct shstream
             HANDLE handle;
             DWORD mode;
             WCHAR *path;
+
+            /* read-only view of the whole file, see filestream_map() */
+            const BYTE *view;
+            ULONGLONG size;
+            ULONGLONG position;
         } file;
     } u;
 };
@@ -887,6 +892,8 @@ static ULONG WINAPI filestream_Release(IStream *iface)
 
     if (!refcount)
     {
+        if (stream->u.file.view)
+            UnmapViewOfFile(stream->u.file.view);
         CloseHandle(stream->u.file.handle);
         free(stream->u.file.path);
         free(stream);
@@ -1089,6 +1096,164 @@ static const IStreamVtbl filestreamvtbl =
     shstream_Clone,
 };
 
+static HRESULT WINAPI mappedstream_Read(IStream *iface, void *buff, ULONG size, ULONG *read_len)
+{
+    struct shstream *stream = impl_from_IStream(iface);
+    ULONG length = 0;
+
+    TRACE("%p, %p, %lu, %p.\n", iface, buff, size, read_len);
+
+    if (stream->u.file.position < stream->u.file.size)
+        length = min(size, stream->u.file.size - stream->u.file.position);
+
+    if (length)
+    {
+        memcpy(buff, stream->u.file.view + stream->u.file.position, length);
+        stream->u.file.position += length;
+    }
+
+    if (read_len)
+        *read_len = length;
+
+    return length == size ? S_OK : S_FALSE;
+}
+
+static HRESULT WINAPI mappedstream_Seek(IStream *iface, LARGE_INTEGER move, DWORD origin, ULARGE_INTEGER *new_pos)
+{
+    struct shstream *stream = impl_from_IStream(iface);
+    LONGLONG position;
+
+    TRACE("%p, %s, %ld, %p.\n", iface, wine_dbgstr_longlong(move.QuadPart), origin, new_pos);
+
+    switch (origin)
+    {
+        case STREAM_SEEK_SET:
+            position = move.QuadPart;
+            break;
+        case STREAM_SEEK_CUR:
+            position = stream->u.file.position + move.QuadPart;
+            break;
+        case STREAM_SEEK_END:
+            position = stream->u.file.size + move.QuadPart;
+            break;
+        default:
+            return HRESULT_FROM_WIN32(ERROR_INVALID_PARAMETER);
+    }
+
+    if (position < 0)
+        return HRESULT_FROM_WIN32(ERROR_NEGATIVE_SEEK);
+
+    stream->u.file.position = position;
+
+    if (new_pos)
+        new_pos->QuadPart = position;
+
+    return S_OK;
+}
+
+static HRESULT WINAPI mappedstream_SetSize(IStream *iface, ULARGE_INTEGER size)
+{
+    struct shstream *stream = impl_from_IStream(iface);
+
+    TRACE("(%p, %s)\n", stream, wine_dbgstr_longlong(size.QuadPart));
+
+    /* The file can't be resized through a read-only stream, but like for
+     * unmapped streams the position is moved to the requested size. */
+    stream->u.file.position = size.QuadPart;
+
+    return S_OK;
+}
+
+static HRESULT WINAPI mappedstream_CopyTo(IStream *iface, IStream *dest, ULARGE_INTEGER size,
+        ULARGE_INTEGER *read_len, ULARGE_INTEGER *written)
+{
+    struct shstream *stream = impl_from_IStream(iface);
+    HRESULT hr = S_OK;
+
+    TRACE("(%p, %p, %s, %p, %p)\n", stream, dest, wine_dbgstr_longlong(size.QuadPart), read_len, written);
+
+    if (read_len)
+        read_len->QuadPart = 0;
+    if (written)
+        written->QuadPart = 0;
+
+    if (!dest)
+        return S_OK;
+
+    if (stream->u.file.position >= stream->u.file.size)
+        return S_OK;
+    size.QuadPart = min(size.QuadPart, stream->u.file.size - stream->u.file.position);
+
+    /* Write straight from the view instead of bouncing through a buffer. */
+    while (size.QuadPart)
+    {
+        ULONG chunk = min(size.QuadPart, 0x40000000), written_chunk = 0;
+
+        hr = IStream_Write(dest, stream->u.file.view + stream->u.file.position, chunk, &written_chunk);
+        stream->u.file.position += chunk;
+        if (read_len)
+            read_len->QuadPart += chunk;
+        if (written)
+            written->QuadPart += written_chunk;
+        if (FAILED(hr) || written_chunk != chunk)
+            break;
+
+        size.QuadPart -= chunk;
+    }
+
+    return hr;
+}
+
+static const IStreamVtbl mappedstreamvtbl =
+{
+    shstream_QueryInterface,
+    shstream_AddRef,
+    filestream_Release,
+    mappedstream_Read,
+    filestream_Write,
+    mappedstream_Seek,
+    mappedstream_SetSize,
+    mappedstream_CopyTo,
+    filestream_Commit,
+    shstream_Revert,
+    shstream_LockRegion,
+    shstream_UnlockRegion,
+    filestream_Stat,
+    shstream_Clone,
+};
+
+/* Read-only streams on files nobody can write to in the meantime are served
+ * from a view of the whole file, so that reading and seeking don't need a
+ * server round trip each. Streams that can't be mapped (e.g. empty files)
+ * keep using the file handle. */
+static void filestream_map(struct shstream *stream)
+{
+    LARGE_INTEGER size;
+    HANDLE mapping;
+    void *view;
+
+    if (!GetFileSizeEx(stream->u.file.handle, &size) || !size.QuadPart)
+        return;
+
+    if (!(mapping = CreateFileMappingW(stream->u.file.handle, NULL, PAGE_READONLY, 0, 0, NULL)))
+    {
+        WARN("Failed to create mapping, error %lu.\n", GetLastError());
+        return;
+    }
+    view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view)
+    {
+        WARN("Failed to map %s bytes, error %lu.\n", wine_dbgstr_longlong(size.QuadPart), GetLastError());
+        return;
+    }
+
+    stream->IStream_iface.lpVtbl = &mappedstreamvtbl;
+    stream->u.file.view = view;
+    stream->u.file.size = size.QuadPart;
+    stream->u.file.position = 0;
+}
+
 /*************************************************************************
  * SHCreateStreamOnFileEx   [SHCORE.@]
  */
@@ -1162,6 +1327,10 @@ HRESULT WINAPI SHCreateStreamOnFileEx(const WCHAR *path, DWORD mode, DWORD attri
     stream->refcount = 1;
     stream->u.file.handle = hFile;
     stream->u.file.mode = mode;
+    stream->u.file.view = NULL;
+
+    if (access == GENERIC_READ && !(share & FILE_SHARE_WRITE))
+        filestream_map(stream);
 
     len = lstrlenW(path);
     stream->u.file.path = malloc((len + 1) * sizeof(WCHAR));
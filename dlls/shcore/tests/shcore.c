@@ -42,6 +42,7 @@ static DWORD (WINAPI *pSHQueryValueExA)(HKEY, const char *, DWORD *, DWORD *, vo
 static DWORD (WINAPI *pSHRegGetPathA)(HKEY, const char *, const char *, char *, DWORD);
 static DWORD (WINAPI *pSHCopyKeyA)(HKEY, const char *, HKEY, DWORD);
 static HRESULT (WINAPI *pSHCreateStreamOnFileA)(const char *path, DWORD mode, IStream **stream);
+static IStream * (WINAPI *pSHCreateMemStream)(const BYTE *data, UINT data_len);
 static HRESULT (WINAPI *pIStream_Size)(IStream *stream, ULARGE_INTEGER *size);
 
 /* Keys used for testing */
@@ -76,6 +77,7 @@ static void init(HMODULE hshcore)
     X(SHRegGetPathA);
     X(SHCopyKeyA);
     X(SHCreateStreamOnFileA);
+    X(SHCreateMemStream);
     X(IStream_Size);
 #undef X
 }
@@ -783,6 +785,95 @@ static void test_stream_size(void)
     DeleteFileA(filename);
 }
 
+static void test_stream_read_only(void)
+{
+    static const CHAR filename[] = "test_file";
+    BYTE data[3000], buff[4000];
+    ULARGE_INTEGER pos, size, read, written;
+    IStream *stream, *dest;
+    LARGE_INTEGER move;
+    HANDLE handle;
+    DWORD count;
+    unsigned int i;
+    HRESULT hr;
+
+    for (i = 0; i < sizeof(data); i++)
+        data[i] = i * 7;
+
+    handle = CreateFileA(filename, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, 0, 0);
+    ok(handle != INVALID_HANDLE_VALUE, "File creation failed: %lu.\n", GetLastError());
+    WriteFile(handle, data, sizeof(data), &count, NULL);
+    ok(count == sizeof(data), "Failed to write data into file.\n");
+    CloseHandle(handle);
+
+    hr = pSHCreateStreamOnFileA(filename, STGM_FAILIFTHERE | STGM_READ | STGM_SHARE_DENY_WRITE, &stream);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+
+    handle = CreateFileA(filename, GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, 0);
+    ok(handle == INVALID_HANDLE_VALUE, "Expected a sharing violation.\n");
+    ok(GetLastError() == ERROR_SHARING_VIOLATION, "Unexpected error %lu.\n", GetLastError());
+
+    count = 0xdeadbeef;
+    hr = IStream_Read(stream, buff, 1000, &count);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(count == 1000, "Unexpected count %lu.\n", count);
+    ok(!memcmp(buff, data, 1000), "Unexpected data.\n");
+
+    move.QuadPart = 500;
+    hr = IStream_Seek(stream, move, STREAM_SEEK_CUR, &pos);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(pos.QuadPart == 1500, "Unexpected position %s.\n", wine_dbgstr_longlong(pos.QuadPart));
+
+    count = 0xdeadbeef;
+    hr = IStream_Read(stream, buff, sizeof(buff), &count);
+    ok(hr == S_FALSE, "Unexpected hr %#lx.\n", hr);
+    ok(count == 1500, "Unexpected count %lu.\n", count);
+    ok(!memcmp(buff, data + 1500, 1500), "Unexpected data.\n");
+
+    count = 0xdeadbeef;
+    hr = IStream_Read(stream, buff, sizeof(buff), &count);
+    ok(hr == S_FALSE, "Unexpected hr %#lx.\n", hr);
+    ok(!count, "Unexpected count %lu.\n", count);
+
+    move.QuadPart = -100;
+    hr = IStream_Seek(stream, move, STREAM_SEEK_END, &pos);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(pos.QuadPart == 2900, "Unexpected position %s.\n", wine_dbgstr_longlong(pos.QuadPart));
+
+    move.QuadPart = -3000;
+    hr = IStream_Seek(stream, move, STREAM_SEEK_CUR, &pos);
+    ok(FAILED(hr), "Unexpected hr %#lx.\n", hr);
+    CHECK_STREAM_POS(stream, 2900);
+
+    hr = IStream_Write(stream, data, 1, &count);
+    ok(hr == STG_E_ACCESSDENIED, "Unexpected hr %#lx.\n", hr);
+
+    dest = pSHCreateMemStream(NULL, 0);
+    ok(dest != NULL, "Failed to create a stream.\n");
+
+    move.QuadPart = 100;
+    hr = IStream_Seek(stream, move, STREAM_SEEK_SET, NULL);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    size.QuadPart = 5000;
+    hr = IStream_CopyTo(stream, dest, size, &read, &written);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    ok(read.QuadPart == 2900, "Unexpected read size %s.\n", wine_dbgstr_longlong(read.QuadPart));
+    ok(written.QuadPart == 2900, "Unexpected written size %s.\n", wine_dbgstr_longlong(written.QuadPart));
+    CHECK_STREAM_POS(stream, 3000);
+
+    move.QuadPart = 0;
+    hr = IStream_Seek(dest, move, STREAM_SEEK_SET, NULL);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    count = 0xdeadbeef;
+    hr = IStream_Read(dest, buff, sizeof(buff), &count);
+    ok(count == 2900, "Unexpected count %lu.\n", count);
+    ok(!memcmp(buff, data + 100, 2900), "Unexpected data.\n");
+
+    IStream_Release(dest);
+    IStream_Release(stream);
+    DeleteFileA(filename);
+}
+
 START_TEST(shcore)
 {
     HMODULE hshcore = LoadLibraryA("shcore.dll");
@@ -808,4 +899,5 @@ START_TEST(shcore)
     test_SHRegGetPath();
     test_SHCopyKey();
     test_stream_size();
+    test_stream_read_only();
 }
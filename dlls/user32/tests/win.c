@@ -61,6 +61,7 @@ static BOOL (WINAPI *pSetWindowDisplayAffinity)(HWND hwnd, DWORD affinity);
 static BOOL (WINAPI *pAdjustWindowRectExForDpi)(LPRECT,DWORD,BOOL,DWORD,UINT);
 static BOOL (WINAPI *pSystemParametersInfoForDpi)(UINT,UINT,void*,UINT,UINT);
 static HICON (WINAPI *pInternalGetWindowIcon)(HWND window, UINT type);
+static DPI_AWARENESS_CONTEXT (WINAPI *pSetThreadDpiAwarenessContext)(DPI_AWARENESS_CONTEXT);
 
 static BOOL test_lbuttondown_flag;
 static DWORD num_gettext_msgs;
@@ -12854,6 +12855,191 @@ static void test_other_process_window(const char *argv0)
     DestroyWindow(hwnd);
 }
 
+/* window state as seen by the process owning the window */
+struct window_state
+{
+    HWND hwnd;
+    BOOL destroyed;
+    LONG_PTR style, ex_style, id, instance, user_data;
+    RECT client[2], window[2];  /* for the DPI unaware and system aware contexts */
+};
+
+static void get_window_state(struct window_state *state)
+{
+    static const DPI_AWARENESS_CONTEXT contexts[] = {DPI_AWARENESS_CONTEXT_UNAWARE, DPI_AWARENESS_CONTEXT_SYSTEM_AWARE};
+    DPI_AWARENESS_CONTEXT old_context;
+    UINT i;
+
+    state->style = GetWindowLongPtrA(state->hwnd, GWL_STYLE);
+    state->ex_style = GetWindowLongPtrA(state->hwnd, GWL_EXSTYLE);
+    state->id = GetWindowLongPtrA(state->hwnd, GWLP_ID);
+    state->instance = GetWindowLongPtrA(state->hwnd, GWLP_HINSTANCE);
+    state->user_data = GetWindowLongPtrA(state->hwnd, GWLP_USERDATA);
+
+    for (i = 0; i < ARRAY_SIZE(contexts); ++i)
+    {
+        old_context = pSetThreadDpiAwarenessContext(contexts[i]);
+        GetClientRect(state->hwnd, &state->client[i]);
+        GetWindowRect(state->hwnd, &state->window[i]);
+        pSetThreadDpiAwarenessContext(old_context);
+    }
+}
+
+static void other_process_window_state_proc(void)
+{
+    HANDLE mapping, window_ready_event, test_done_event;
+    struct window_state *expect, state;
+    unsigned int step;
+    DWORD ret;
+
+    mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, "test_opw_state");
+    ok(!!mapping, "OpenFileMapping failed.\n");
+    expect = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    ok(!!expect, "MapViewOfFile failed.\n");
+    window_ready_event = OpenEventA(EVENT_ALL_ACCESS, FALSE, "test_opw_state_window");
+    ok(!!window_ready_event, "OpenEvent failed.\n");
+    test_done_event = OpenEventA(EVENT_ALL_ACCESS, FALSE, "test_opw_state_test");
+    ok(!!test_done_event, "OpenEvent failed.\n");
+
+    for (step = 0;; ++step)
+    {
+        ret = WaitForSingleObject(window_ready_event, 5000);
+        ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+        if (ret != WAIT_OBJECT_0) break;
+        winetest_push_context("step %u", step);
+
+        state.hwnd = expect->hwnd;
+        if (expect->destroyed)
+        {
+            SetLastError(0xdeadbeef);
+            ret = GetWindowLongPtrA(state.hwnd, GWL_STYLE);
+            ok(!ret, "Unexpected style %#lx.\n", ret);
+            ok(GetLastError() == ERROR_INVALID_WINDOW_HANDLE, "Unexpected error %lu.\n", GetLastError());
+            ret = GetClientRect(state.hwnd, &state.client[0]);
+            ok(!ret, "Unexpected ret %#lx.\n", ret);
+            winetest_pop_context();
+            SetEvent(test_done_event);
+            break;
+        }
+
+        get_window_state(&state);
+        ok(state.style == expect->style, "Got style %#Ix, expected %#Ix.\n", state.style, expect->style);
+        ok(state.ex_style == expect->ex_style, "Got ex_style %#Ix, expected %#Ix.\n",
+                state.ex_style, expect->ex_style);
+        ok(state.id == expect->id, "Got id %#Ix, expected %#Ix.\n", state.id, expect->id);
+        ok(state.instance == expect->instance, "Got instance %#Ix, expected %#Ix.\n",
+                state.instance, expect->instance);
+        ok(state.user_data == expect->user_data, "Got user data %#Ix, expected %#Ix.\n",
+                state.user_data, expect->user_data);
+        ok(EqualRect(&state.client[0], &expect->client[0]), "Got unaware client %s, expected %s.\n",
+                wine_dbgstr_rect(&state.client[0]), wine_dbgstr_rect(&expect->client[0]));
+        ok(EqualRect(&state.window[0], &expect->window[0]), "Got unaware window %s, expected %s.\n",
+                wine_dbgstr_rect(&state.window[0]), wine_dbgstr_rect(&expect->window[0]));
+        ok(EqualRect(&state.client[1], &expect->client[1]), "Got aware client %s, expected %s.\n",
+                wine_dbgstr_rect(&state.client[1]), wine_dbgstr_rect(&expect->client[1]));
+        ok(EqualRect(&state.window[1], &expect->window[1]), "Got aware window %s, expected %s.\n",
+                wine_dbgstr_rect(&state.window[1]), wine_dbgstr_rect(&expect->window[1]));
+
+        winetest_pop_context();
+        SetEvent(test_done_event);
+    }
+
+    CloseHandle(window_ready_event);
+    CloseHandle(test_done_event);
+    UnmapViewOfFile(expect);
+    CloseHandle(mapping);
+}
+
+static void check_other_process_window_state(struct window_state *state, HANDLE window_ready_event,
+        HANDLE test_done_event)
+{
+    DWORD ret;
+
+    if (!state->destroyed) get_window_state(state);
+    SetEvent(window_ready_event);
+    ret = WaitForSingleObject(test_done_event, 5000);
+    ok(ret == WAIT_OBJECT_0, "Unexpected ret %lx.\n", ret);
+}
+
+/* Other processes read the state of a window from memory shared with the server on Wine,
+ * check that they see every change made by the owner. */
+static void test_other_process_window_state(const char *argv0)
+{
+    HANDLE mapping, window_ready_event, test_done_event;
+    DPI_AWARENESS_CONTEXT old_context;
+    HWND unaware, aware, child;
+    struct window_state *state;
+    PROCESS_INFORMATION info;
+    STARTUPINFOA startup;
+    char cmd[MAX_PATH];
+
+    if (!pSetThreadDpiAwarenessContext)
+    {
+        win_skip("SetThreadDpiAwarenessContext is not available.\n");
+        return;
+    }
+
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(*state), "test_opw_state");
+    ok(!!mapping, "CreateFileMapping failed.\n");
+    state = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, 0);
+    ok(!!state, "MapViewOfFile failed.\n");
+    window_ready_event = CreateEventA(NULL, FALSE, FALSE, "test_opw_state_window");
+    ok(!!window_ready_event, "CreateEvent failed.\n");
+    test_done_event = CreateEventA(NULL, FALSE, FALSE, "test_opw_state_test");
+    ok(!!test_done_event, "CreateEvent failed.\n");
+
+    old_context = pSetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_UNAWARE);
+    unaware = CreateWindowExA(0, "static", NULL, WS_POPUP, 100, 100, 200, 200, 0, 0, NULL, NULL);
+    ok(!!unaware, "CreateWindowEx failed.\n");
+    pSetThreadDpiAwarenessContext(DPI_AWARENESS_CONTEXT_SYSTEM_AWARE);
+    aware = CreateWindowExA(0, "static", NULL, WS_POPUP, 100, 100, 200, 200, 0, 0, NULL, NULL);
+    ok(!!aware, "CreateWindowEx failed.\n");
+    child = CreateWindowExA(0, "static", NULL, WS_CHILD | WS_VISIBLE, 10, 10, 50, 50, aware, 0,
+            GetModuleHandleA(NULL), NULL);
+    ok(!!child, "CreateWindowEx failed.\n");
+
+    memset(state, 0, sizeof(*state));
+    state->hwnd = child;
+    get_window_state(state);
+
+    sprintf(cmd, "%s win other_process_window_state", argv0);
+    memset(&startup, 0, sizeof(startup));
+    startup.cb = sizeof(startup);
+    ok(CreateProcessA(NULL, cmd, NULL, NULL, FALSE, 0, NULL, NULL,
+            &startup, &info), "CreateProcess failed.\n");
+
+    check_other_process_window_state(state, window_ready_event, test_done_event);
+
+    SetWindowLongPtrA(child, GWL_STYLE, WS_CHILD | WS_VISIBLE | WS_BORDER);
+    SetWindowLongPtrA(child, GWL_EXSTYLE, WS_EX_CLIENTEDGE);
+    SetWindowLongPtrA(child, GWLP_ID, 0x1234);
+    SetWindowLongPtrA(child, GWLP_USERDATA, 0xdeadbeef);
+    SetWindowPos(child, 0, 20, 30, 60, 40, SWP_NOZORDER | SWP_NOACTIVATE | SWP_FRAMECHANGED);
+    check_other_process_window_state(state, window_ready_event, test_done_event);
+
+    /* the DPI of the window changes with its parent */
+    SetParent(child, unaware);
+    check_other_process_window_state(state, window_ready_event, test_done_event);
+
+    SetWindowPos(child, 0, 5, 5, 30, 20, SWP_NOZORDER | SWP_NOACTIVATE);
+    check_other_process_window_state(state, window_ready_event, test_done_event);
+
+    DestroyWindow(child);
+    state->destroyed = TRUE;
+    check_other_process_window_state(state, window_ready_event, test_done_event);
+
+    wait_child_process(info.hProcess);
+    CloseHandle(info.hProcess);
+    CloseHandle(info.hThread);
+    DestroyWindow(aware);
+    DestroyWindow(unaware);
+    pSetThreadDpiAwarenessContext(old_context);
+    CloseHandle(window_ready_event);
+    CloseHandle(test_done_event);
+    UnmapViewOfFile(state);
+    CloseHandle(mapping);
+}
+
 static void test_cancel_mode(void)
 {
     HWND hwnd1, hwnd2, child;
@@ -13162,6 +13348,7 @@ START_TEST(win)
     pAdjustWindowRectExForDpi = (void *)GetProcAddress( user32, "AdjustWindowRectExForDpi" );
     pSystemParametersInfoForDpi = (void *)GetProcAddress( user32, "SystemParametersInfoForDpi" );
     pInternalGetWindowIcon = (void *)GetProcAddress( user32, "InternalGetWindowIcon" );
+    pSetThreadDpiAwarenessContext = (void *)GetProcAddress( user32, "SetThreadDpiAwarenessContext" );
 
     if (argc == 4)
     {
@@ -13180,6 +13367,12 @@ START_TEST(win)
         }
     }
 
+    if (argc == 3 && !strcmp(argv[2], "other_process_window_state"))
+    {
+        other_process_window_state_proc();
+        return;
+    }
+
     if (argc == 3 && !strcmp(argv[2], "winproc_limit"))
     {
         test_winproc_limit();
@@ -13316,6 +13509,7 @@ START_TEST(win)
     test_window_placement();
     test_arrange_iconic_windows();
     test_other_process_window(argv[0]);
+    test_other_process_window_state(argv[0]);
     test_SC_SIZE();
     test_cancel_mode();
     test_DragDetect();
@@ -356,6 +356,7 @@ W32KAPI BOOL window_surface_init( struct window_surface *surface, const struct w
     surface->alpha_mask = 0;
     pthread_mutex_init( &surface->mutex, NULL );
     reset_bounds( &surface->bounds );
+    surface->damage_count = 0;
 
     if (!bitmap) bitmap = NtGdiCreateDIBSection( 0, NULL, 0, info, DIB_RGB_COLORS, 0, 0, 0, NULL );
     if (!(surface->color_bitmap = bitmap)) return FALSE;
@@ -416,6 +417,83 @@ void *window_surface_get_color( struct window_surface *surface, BITMAPINFO *info
     return gdi_bits.ptr;
 }
 
+static LONGLONG get_rect_area( const RECT *rect )
+{
+    return (LONGLONG)(rect->right - rect->left) * (rect->bottom - rect->top);
+}
+
+/* mark the whole surface as dirty */
+static void set_full_damage( struct window_surface *surface )
+{
+    surface->bounds = surface->rect;
+    surface->damage_count = 0;
+}
+
+/* add a rectangle to the list of dirty rectangles of the surface */
+static void add_damage_rect( struct window_surface *surface, const RECT *rect )
+{
+    LONGLONG growth, min_growth = -1;
+    RECT merged = *rect, tmp;
+    UINT i, best = 0;
+
+    /* merge with the rectangles for which the union doesn't cover more than the two of them */
+    for (i = 0; i < surface->damage_count;)
+    {
+        union_rect( &tmp, &merged, &surface->damage[i] );
+        if (get_rect_area( &tmp ) > get_rect_area( &merged ) + get_rect_area( &surface->damage[i] ))
+        {
+            i++;
+            continue;
+        }
+        merged = tmp;
+        surface->damage[i] = surface->damage[--surface->damage_count];
+        i = 0;  /* the merged rectangle may now overlap the previous ones */
+    }
+
+    if (surface->damage_count < WINDOW_SURFACE_MAX_DAMAGE)
+    {
+        surface->damage[surface->damage_count++] = merged;
+        return;
+    }
+
+    /* the list is full, grow the rectangle that needs it the least */
+    for (i = 0; i < surface->damage_count; i++)
+    {
+        union_rect( &tmp, &merged, &surface->damage[i] );
+        growth = get_rect_area( &tmp ) - get_rect_area( &surface->damage[i] );
+        if (min_growth != -1 && growth >= min_growth) continue;
+        min_growth = growth;
+        best = i;
+    }
+    union_rect( &surface->damage[best], &surface->damage[best], &merged );
+}
+
+/* add a dirty rectangle, in surface coordinates, to the surface; must be called with the surface locked */
+W32KAPI void window_surface_add_damage( struct window_surface *surface, const RECT *rect )
+{
+    if (surface == &dummy_surface || IsRectEmpty( rect )) return;
+    /* once some area has been marked dirty without a rectangle list, only the bounds are tracked */
+    if (surface->damage_count || IsRectEmpty( &surface->bounds )) add_damage_rect( surface, rect );
+    add_bounds_rect( &surface->bounds, rect );
+}
+
+/* clip and align the dirty rectangles to the flushed area, and drop the empty ones */
+static void clip_damage_rects( struct window_surface *surface, const RECT *dirty )
+{
+    UINT i, count = 0;
+    RECT rect;
+
+    for (i = 0; i < surface->damage_count; i++)
+    {
+        rect.left = surface->damage[i].left & ~7;
+        rect.top = surface->damage[i].top;
+        rect.right = (surface->damage[i].right + 7) & ~7;
+        rect.bottom = surface->damage[i].bottom;
+        if (intersect_rect( &rect, &rect, dirty )) surface->damage[count++] = rect;
+    }
+    surface->damage_count = count;
+}
+
 W32KAPI void window_surface_flush( struct window_surface *surface )
 {
     char color_buf[FIELD_OFFSET( BITMAPINFO, bmiColors[256] )];
@@ -440,12 +518,18 @@ W32KAPI void window_surface_flush( struct window_surface *surface )
         BOOL shape_changed = update_surface_shape( surface, &surface->rect, &dirty, color_info, color_bits );
         void *shape_bits = window_surface_get_shape( surface, shape_info );
 
-        TRACE( "Flushing hwnd %p, surface %p %s, bounds %s, dirty %s\n", surface->hwnd, surface,
-               wine_dbgstr_rect( &surface->rect ), wine_dbgstr_rect( &surface->bounds ), wine_dbgstr_rect( &dirty ) );
+        clip_damage_rects( surface, &dirty );
+
+        TRACE( "Flushing hwnd %p, surface %p %s, bounds %s, dirty %s, %u rects\n", surface->hwnd, surface,
+               wine_dbgstr_rect( &surface->rect ), wine_dbgstr_rect( &surface->bounds ), wine_dbgstr_rect( &dirty ),
+               surface->damage_count );
 
         if (surface->funcs->flush( surface, &surface->rect, &dirty, color_info, color_bits,
                                    shape_changed, shape_info, shape_bits ))
+        {
             reset_bounds( &surface->bounds );
+            surface->damage_count = 0;
+        }
     }
 
     window_surface_unlock( surface );
@@ -464,17 +548,17 @@ W32KAPI void window_surface_set_layered( struct window_surface *surface, COLORRE
         if (color_key != surface->color_key)
         {
             surface->color_key = color_key;
-            surface->bounds = surface->rect;
+            set_full_damage( surface );
         }
         if (alpha_bits != surface->alpha_bits)
         {
             surface->alpha_bits = alpha_bits;
-            surface->bounds = surface->rect;
+            set_full_damage( surface );
         }
         if (alpha_mask != surface->alpha_mask)
         {
             surface->alpha_mask = alpha_mask;
-            surface->bounds = surface->rect;
+            set_full_damage( surface );
         }
     }
     window_surface_unlock( surface );
@@ -521,13 +605,13 @@ W32KAPI void window_surface_set_shape( struct window_surface *surface, HRGN shap
     {
         NtGdiDeleteObjectApp( surface->shape_region );
         surface->shape_region = 0;
-        surface->bounds = surface->rect;
+        set_full_damage( surface );
     }
     else if (shape_region && !NtGdiEqualRgn( shape_region, surface->shape_region ))
     {
         if (!surface->shape_region) surface->shape_region = NtGdiCreateRectRgn( 0, 0, 0, 0 );
         NtGdiCombineRgn( surface->shape_region, shape_region, 0, RGN_COPY );
-        surface->bounds = surface->rect;
+        set_full_damage( surface );
     }
 
     window_surface_unlock( surface );
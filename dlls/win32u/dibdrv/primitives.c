@@ -24,6 +24,12 @@
 
 #include <assert.h>
 
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+    (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__))
+#define USE_X86_SIMD
+#include <immintrin.h>
+#endif
+
 #include "ntgdi_private.h"
 #include "dibdrv.h"
 
@@ -268,10 +274,114 @@ static inline void memset_16( WORD *start, WORD val, DWORD size )
 #endif
 }
 
+#ifdef USE_X86_SIMD
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+enum simd_level
+{
+    SIMD_NONE,
+    SIMD_SSE2,
+    SIMD_AVX2
+};
+
+static enum simd_level get_simd_level(void)
+{
+    static int cached = -1;
+    SYSTEM_PROCESSOR_FEATURES_INFORMATION info;
+    const ULONGLONG avx2 = CPU_FEATURE_XSAVE | CPU_FEATURE_AVX | CPU_FEATURE_AVX2;
+    int level = SIMD_NONE;
+
+    if (cached != -1) return cached;
+
+    if (!NtQuerySystemInformation( SystemProcessorFeaturesInformation, &info, sizeof(info), NULL ))
+    {
+        if ((info.ProcessorFeatureBits & avx2) == avx2) level = SIMD_AVX2;
+        else if (info.ProcessorFeatureBits & CPU_FEATURE_SSE2) level = SIMD_SSE2;
+    }
+    TRACE( "using simd level %u\n", level );
+    return cached = level;
+}
+
+static void SSE2_TARGET do_rop_line_32_sse2( DWORD *ptr, DWORD and, DWORD xor, int len )
+{
+    const __m128i vand = _mm_set1_epi32( and ), vxor = _mm_set1_epi32( xor );
+
+    for (; len >= 4; len -= 4, ptr += 4)
+    {
+        __m128i d = _mm_loadu_si128( (const __m128i *)ptr );
+        _mm_storeu_si128( (__m128i *)ptr, _mm_xor_si128( _mm_and_si128( d, vand ), vxor ));
+    }
+    while (len--) do_rop_32( ptr++, and, xor );
+}
+
+static void AVX2_TARGET do_rop_line_32_avx2( DWORD *ptr, DWORD and, DWORD xor, int len )
+{
+    const __m256i vand = _mm256_set1_epi32( and ), vxor = _mm256_set1_epi32( xor );
+
+    for (; len >= 8; len -= 8, ptr += 8)
+    {
+        __m256i d = _mm256_loadu_si256( (const __m256i *)ptr );
+        _mm256_storeu_si256( (__m256i *)ptr, _mm256_xor_si256( _mm256_and_si256( d, vand ), vxor ));
+    }
+    do_rop_line_32_sse2( ptr, and, xor, len );
+}
+
+/* dst = (dst & ((src & a1) ^ a2)) ^ ((src & x1) ^ x2), see do_rop_codes_32 */
+static void SSE2_TARGET do_rop_codes_line_32_sse2( DWORD *dst, const DWORD *src,
+                                                   struct rop_codes *codes, int len )
+{
+    const __m128i a1 = _mm_set1_epi32( codes->a1 ), a2 = _mm_set1_epi32( codes->a2 );
+    const __m128i x1 = _mm_set1_epi32( codes->x1 ), x2 = _mm_set1_epi32( codes->x2 );
+
+    for (; len >= 4; len -= 4, dst += 4, src += 4)
+    {
+        __m128i s = _mm_loadu_si128( (const __m128i *)src );
+        __m128i d = _mm_loadu_si128( (const __m128i *)dst );
+        d = _mm_and_si128( d, _mm_xor_si128( _mm_and_si128( s, a1 ), a2 ));
+        d = _mm_xor_si128( d, _mm_xor_si128( _mm_and_si128( s, x1 ), x2 ));
+        _mm_storeu_si128( (__m128i *)dst, d );
+    }
+    while (len--) do_rop_codes_32( dst++, *src++, codes );
+}
+
+static void AVX2_TARGET do_rop_codes_line_32_avx2( DWORD *dst, const DWORD *src,
+                                                   struct rop_codes *codes, int len )
+{
+    const __m256i a1 = _mm256_set1_epi32( codes->a1 ), a2 = _mm256_set1_epi32( codes->a2 );
+    const __m256i x1 = _mm256_set1_epi32( codes->x1 ), x2 = _mm256_set1_epi32( codes->x2 );
+
+    for (; len >= 8; len -= 8, dst += 8, src += 8)
+    {
+        __m256i s = _mm256_loadu_si256( (const __m256i *)src );
+        __m256i d = _mm256_loadu_si256( (const __m256i *)dst );
+        d = _mm256_and_si256( d, _mm256_xor_si256( _mm256_and_si256( s, a1 ), a2 ));
+        d = _mm256_xor_si256( d, _mm256_xor_si256( _mm256_and_si256( s, x1 ), x2 ));
+        _mm256_storeu_si256( (__m256i *)dst, d );
+    }
+    do_rop_codes_line_32_sse2( dst, src, codes, len );
+}
+
+#endif /* USE_X86_SIMD */
+
+static void do_rop_line_32( DWORD *ptr, DWORD and, DWORD xor, int len )
+{
+#ifdef USE_X86_SIMD
+    switch (get_simd_level())
+    {
+    case SIMD_AVX2: do_rop_line_32_avx2( ptr, and, xor, len ); return;
+    case SIMD_SSE2: do_rop_line_32_sse2( ptr, and, xor, len ); return;
+    case SIMD_NONE: break;
+    }
+#endif
+    while (len--) do_rop_32( ptr++, and, xor );
+}
+
 static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD and, DWORD xor)
 {
-    DWORD *ptr, *start;
-    int x, y, i;
+    DWORD *start;
+    int y, i;
 
     for(i = 0; i < num; i++, rc++)
     {
@@ -280,8 +390,7 @@ static void solid_rects_32(const dib_info *dib, int num, const RECT *rc, DWORD a
         start = get_pixel_ptr_32(dib, rc->left, rc->top);
         if (and)
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
-                for(x = rc->left, ptr = start; x < rc->right; x++)
-                    do_rop_32(ptr++, and, xor);
+                do_rop_line_32( start, and, xor, rc->right - rc->left );
         else
             for(y = rc->top; y < rc->bottom; y++, start += dib->stride / 4)
                 memset_32( start, xor, rc->right - rc->left );
@@ -1411,6 +1520,23 @@ static void copy_rect_32(const dib_info *dst, const RECT *rc,
     size.cx = rc->right - rc->left;
     size.cy = rc->bottom - rc->top;
 
+#ifdef USE_X86_SIMD
+    if (!(overlap & OVERLAP_RIGHT) && get_simd_level() != SIMD_NONE)
+    {
+        struct rop_codes codes;
+
+        get_rop_codes( rop2, &codes );
+        for (y = 0; y < size.cy; y++, dst_start += dst_stride, src_start += src_stride)
+        {
+            if (get_simd_level() == SIMD_AVX2)
+                do_rop_codes_line_32_avx2( dst_start, src_start, &codes, size.cx );
+            else
+                do_rop_codes_line_32_sse2( dst_start, src_start, &codes, size.cx );
+        }
+        return;
+    }
+#endif
+
     if (overlap & OVERLAP_RIGHT)
         copy_rect_bits_rev_32( dst_start, src_start, &size, dst_stride, src_stride, rop2 );
     else
@@ -4682,35 +4808,195 @@ static inline DWORD blend_rgb( BYTE dst_r, BYTE dst_g, BYTE dst_b, DWORD src, BL
             blend_color( dst_r, src >> 16, blend.SourceConstantAlpha ) << 16);
 }
 
+enum blend_8888_op
+{
+    BLEND_ARGB,               /* per-pixel alpha */
+    BLEND_ARGB_ALPHA,         /* per-pixel and constant alpha */
+    BLEND_CONSTANT_ALPHA,     /* constant alpha, source alpha channel is blended */
+    BLEND_NO_SRC_ALPHA,       /* constant alpha, source alpha channel is 255 */
+};
+
+static inline DWORD blend_pixel_8888( DWORD dst, DWORD src, enum blend_8888_op op, DWORD alpha )
+{
+    switch (op)
+    {
+    case BLEND_ARGB:           return blend_argb( dst, src );
+    case BLEND_ARGB_ALPHA:     return blend_argb_alpha( dst, src, alpha );
+    case BLEND_CONSTANT_ALPHA: return blend_argb_constant_alpha( dst, src, alpha );
+    case BLEND_NO_SRC_ALPHA:   return blend_argb_no_src_alpha( dst, src, alpha );
+    }
+    return dst;
+}
+
+#ifdef USE_X86_SIMD
+
+/* The vector versions work on 16-bit lanes and give exactly the same results as the
+ * scalar helpers above: (x + 127) / 255 is computed as (t + 1 + (t >> 8)) >> 8 with
+ * t = x + 127, which is exact for all x <= 255 * 255. Pixels where the per-pixel
+ * alpha variants overflow a channel (invalid premultiplied data) are redone with
+ * the scalar helpers, since those let the overflow bleed into the next channel. */
+
+static inline __m128i SSE2_TARGET div255_round_sse2( __m128i x )
+{
+    __m128i t = _mm_add_epi16( x, _mm_set1_epi16( 127 ));
+    t = _mm_add_epi16( _mm_add_epi16( t, _mm_set1_epi16( 1 )), _mm_srli_epi16( t, 8 ));
+    return _mm_srli_epi16( t, 8 );
+}
+
+static inline __m128i SSE2_TARGET blend_channels_sse2( __m128i d, __m128i s, enum blend_8888_op op,
+                                                       __m128i alpha, __m128i *overflow )
+{
+    const __m128i max = _mm_set1_epi16( 255 );
+    __m128i a;
+
+    switch (op)
+    {
+    case BLEND_ARGB_ALPHA:
+        s = div255_round_sse2( _mm_mullo_epi16( s, alpha ));
+        /* fall through */
+    case BLEND_ARGB:
+        a = _mm_shufflehi_epi16( _mm_shufflelo_epi16( s, 0xff ), 0xff );
+        d = _mm_add_epi16( s, div255_round_sse2( _mm_mullo_epi16( d, _mm_sub_epi16( max, a ))));
+        *overflow = _mm_or_si128( *overflow, _mm_cmpgt_epi16( d, max ));
+        return d;
+    default:
+        return div255_round_sse2( _mm_add_epi16( _mm_mullo_epi16( s, alpha ),
+                                                 _mm_mullo_epi16( d, _mm_sub_epi16( max, alpha ))));
+    }
+}
+
+static void SSE2_TARGET blend_line_8888_sse2( DWORD *dst, const DWORD *src, int len,
+                                              enum blend_8888_op op, DWORD alpha )
+{
+    const __m128i zero = _mm_setzero_si128(), valpha = _mm_set1_epi16( alpha );
+    const __m128i src_or = _mm_set1_epi32( op == BLEND_NO_SRC_ALPHA ? 0xff000000 : 0 );
+    int i;
+
+    for (; len >= 4; len -= 4, dst += 4, src += 4)
+    {
+        __m128i s = _mm_or_si128( _mm_loadu_si128( (const __m128i *)src ), src_or );
+        __m128i d = _mm_loadu_si128( (const __m128i *)dst );
+        __m128i overflow = zero, lo, hi;
+
+        lo = blend_channels_sse2( _mm_unpacklo_epi8( d, zero ), _mm_unpacklo_epi8( s, zero ),
+                                  op, valpha, &overflow );
+        hi = blend_channels_sse2( _mm_unpackhi_epi8( d, zero ), _mm_unpackhi_epi8( s, zero ),
+                                  op, valpha, &overflow );
+        if (_mm_movemask_epi8( overflow ))
+            for (i = 0; i < 4; i++) dst[i] = blend_pixel_8888( dst[i], src[i], op, alpha );
+        else
+            _mm_storeu_si128( (__m128i *)dst, _mm_packus_epi16( lo, hi ));
+    }
+    for (i = 0; i < len; i++) dst[i] = blend_pixel_8888( dst[i], src[i], op, alpha );
+}
+
+static inline __m256i AVX2_TARGET div255_round_avx2( __m256i x )
+{
+    __m256i t = _mm256_add_epi16( x, _mm256_set1_epi16( 127 ));
+    t = _mm256_add_epi16( _mm256_add_epi16( t, _mm256_set1_epi16( 1 )), _mm256_srli_epi16( t, 8 ));
+    return _mm256_srli_epi16( t, 8 );
+}
+
+static inline __m256i AVX2_TARGET blend_channels_avx2( __m256i d, __m256i s, enum blend_8888_op op,
+                                                       __m256i alpha, __m256i *overflow )
+{
+    const __m256i max = _mm256_set1_epi16( 255 );
+    __m256i a;
+
+    switch (op)
+    {
+    case BLEND_ARGB_ALPHA:
+        s = div255_round_avx2( _mm256_mullo_epi16( s, alpha ));
+        /* fall through */
+    case BLEND_ARGB:
+        a = _mm256_shufflehi_epi16( _mm256_shufflelo_epi16( s, 0xff ), 0xff );
+        d = _mm256_add_epi16( s, div255_round_avx2( _mm256_mullo_epi16( d, _mm256_sub_epi16( max, a ))));
+        *overflow = _mm256_or_si256( *overflow, _mm256_cmpgt_epi16( d, max ));
+        return d;
+    default:
+        return div255_round_avx2( _mm256_add_epi16( _mm256_mullo_epi16( s, alpha ),
+                                                    _mm256_mullo_epi16( d, _mm256_sub_epi16( max, alpha ))));
+    }
+}
+
+static void AVX2_TARGET blend_line_8888_avx2( DWORD *dst, const DWORD *src, int len,
+                                              enum blend_8888_op op, DWORD alpha )
+{
+    const __m256i zero = _mm256_setzero_si256(), valpha = _mm256_set1_epi16( alpha );
+    const __m256i src_or = _mm256_set1_epi32( op == BLEND_NO_SRC_ALPHA ? 0xff000000 : 0 );
+    int i;
+
+    for (; len >= 8; len -= 8, dst += 8, src += 8)
+    {
+        __m256i s = _mm256_or_si256( _mm256_loadu_si256( (const __m256i *)src ), src_or );
+        __m256i d = _mm256_loadu_si256( (const __m256i *)dst );
+        __m256i overflow = zero, lo, hi;
+
+        /* unpack and pack both work within 128-bit lanes, so the pixel order is preserved */
+        lo = blend_channels_avx2( _mm256_unpacklo_epi8( d, zero ), _mm256_unpacklo_epi8( s, zero ),
+                                  op, valpha, &overflow );
+        hi = blend_channels_avx2( _mm256_unpackhi_epi8( d, zero ), _mm256_unpackhi_epi8( s, zero ),
+                                  op, valpha, &overflow );
+        if (_mm256_movemask_epi8( overflow ))
+            for (i = 0; i < 8; i++) dst[i] = blend_pixel_8888( dst[i], src[i], op, alpha );
+        else
+            _mm256_storeu_si256( (__m256i *)dst, _mm256_packus_epi16( lo, hi ));
+    }
+    blend_line_8888_sse2( dst, src, len, op, alpha );
+}
+
+#endif /* USE_X86_SIMD */
+
+static void blend_line_8888( DWORD *dst, const DWORD *src, int len, enum blend_8888_op op, DWORD alpha )
+{
+    int x;
+
+#ifdef USE_X86_SIMD
+    switch (get_simd_level())
+    {
+    case SIMD_AVX2: blend_line_8888_avx2( dst, src, len, op, alpha ); return;
+    case SIMD_SSE2: blend_line_8888_sse2( dst, src, len, op, alpha ); return;
+    case SIMD_NONE: break;
+    }
+#endif
+
+    switch (op)
+    {
+    case BLEND_ARGB:
+        for (x = 0; x < len; x++) dst[x] = blend_argb( dst[x], src[x] );
+        break;
+    case BLEND_ARGB_ALPHA:
+        for (x = 0; x < len; x++) dst[x] = blend_argb_alpha( dst[x], src[x], alpha );
+        break;
+    case BLEND_CONSTANT_ALPHA:
+        for (x = 0; x < len; x++) dst[x] = blend_argb_constant_alpha( dst[x], src[x], alpha );
+        break;
+    case BLEND_NO_SRC_ALPHA:
+        for (x = 0; x < len; x++) dst[x] = blend_argb_no_src_alpha( dst[x], src[x], alpha );
+        break;
+    }
+}
+
 static void blend_rects_8888(const dib_info *dst, int num, const RECT *rc,
                              const dib_info *src, const POINT *offset, BLENDFUNCTION blend)
 {
-    int i, x, y;
+    enum blend_8888_op op;
+    int i, y;
+
+    if (blend.AlphaFormat & AC_SRC_ALPHA)
+        op = blend.SourceConstantAlpha == 255 ? BLEND_ARGB : BLEND_ARGB_ALPHA;
+    else if (src->compression == BI_RGB)
+        op = BLEND_CONSTANT_ALPHA;
+    else
+        op = BLEND_NO_SRC_ALPHA;
 
     for (i = 0; i < num; i++, rc++)
     {
         DWORD *src_ptr = get_pixel_ptr_32( src, rc->left + offset->x, rc->top + offset->y );
         DWORD *dst_ptr = get_pixel_ptr_32( dst, rc->left, rc->top );
 
-        if (blend.AlphaFormat & AC_SRC_ALPHA)
-        {
-            if (blend.SourceConstantAlpha == 255)
-                for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                    for (x = 0; x < rc->right - rc->left; x++)
-                        dst_ptr[x] = blend_argb( dst_ptr[x], src_ptr[x] );
-            else
-                for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                    for (x = 0; x < rc->right - rc->left; x++)
-                        dst_ptr[x] = blend_argb_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
-        }
-        else if (src->compression == BI_RGB)
-            for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                for (x = 0; x < rc->right - rc->left; x++)
-                    dst_ptr[x] = blend_argb_constant_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
-        else
-            for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
-                for (x = 0; x < rc->right - rc->left; x++)
-                    dst_ptr[x] = blend_argb_no_src_alpha( dst_ptr[x], src_ptr[x], blend.SourceConstantAlpha );
+        for (y = rc->top; y < rc->bottom; y++, dst_ptr += dst->stride / 4, src_ptr += src->stride / 4)
+            blend_line_8888( dst_ptr, src_ptr, rc->right - rc->left, op, blend.SourceConstantAlpha );
     }
 }
 
@@ -3867,11 +3867,16 @@ static DWORD get_glyph_outline( struct gdi_font *font, UINT glyph, UINT format,
     if (format == GGO_METRICS && !mat && get_gdi_font_glyph_metrics( font, index, &gm, &abc ))
         goto done;
 
+    if (!mat && get_shared_glyph( font, index, format, tategaki, &gm, &abc, buflen, buf, &ret ))
+        goto done;
+
     ret = font_funcs->get_glyph_outline( font, index, format, &gm, &abc, buflen, buf, mat, tategaki );
     if (ret == GDI_ERROR) return ret;
 
     if (format == GGO_METRICS && !mat)
         set_gdi_font_glyph_metrics( font, index, &gm, &abc );
+    else if (!mat && buf && buflen && ret)
+        add_shared_glyph( font, index, format, tategaki, &gm, &abc, ret, buf );
 
 done:
     if (gm_ret) *gm_ret = gm;
@@ -0,0 +1,430 @@
+/*
+ * Session-wide glyph bitmap cache
+ *
+ * Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/*
+ * Rasterized glyph bitmaps are stored in a section shared by all the
+ * processes of the session, so that a glyph only goes through FreeType once.
+ *
+ * The section holds a set-associative hash table followed by a ring buffer
+ * of entries. Ring positions are 64-bit and never wrap; an entry stored at
+ * position pos is overwritten once the allocation position goes past
+ * pos + GLYPH_CACHE_RING_SIZE, which makes the ring a FIFO eviction policy.
+ * Entries that are hit while close to being overwritten are copied to the
+ * head of the ring, so frequently used glyphs stay in the cache.
+ *
+ * Writers reserve ring space with a compare-and-swap on the allocation
+ * position, fill the entry, then publish its position in a hash table slot.
+ * Readers take no lock: they copy the entry and check afterwards that the
+ * allocation position didn't reach it in the meantime. A writer that got
+ * delayed long enough for the ring to wrap may still be scribbling over a
+ * newer entry, so entries also carry a checksum that readers verify.
+ */
+
+#if 0
+#pragma makedep unix
+#endif
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winbase.h"
+#include "winternl.h"
+#include "ntgdi_private.h"
+
+#include "wine/debug.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(font);
+
+#define GLYPH_CACHE_VERSION     1
+#define GLYPH_CACHE_BUCKETS     16384
+#define GLYPH_CACHE_WAYS        4
+#define GLYPH_CACHE_RING_SIZE   (16 * 1024 * 1024)
+#define GLYPH_CACHE_MAX_BITS    (64 * 1024)
+#define GLYPH_CACHE_ALIGN       16
+
+struct glyph_cache_key
+{
+    ULONGLONG font_id;      /* hash of the font file name, write time and face index */
+    FMAT2     matrix;
+    INT       ppem;
+    INT       scale_y;
+    INT       ave_width;
+    INT       height;
+    INT       width;
+    INT       escapement;
+    INT       orientation;
+    INT       weight;
+    UINT      glyph;
+    UINT      format;
+    BYTE      italic;
+    BYTE      fake_bold;
+    BYTE      fake_italic;
+    BYTE      tategaki;
+    BYTE      can_use_bitmap;
+    BYTE      pad[3];
+};
+
+struct glyph_cache_entry
+{
+    struct glyph_cache_key key;
+    GLYPHMETRICS           gm;
+    ABC                    abc;
+    UINT                   size;     /* size of the bitmap bits */
+    UINT                   pad;
+    ULONGLONG              checksum; /* checksum of the fields above and the bits */
+    BYTE                   bits[];
+};
+
+struct glyph_cache_header
+{
+    LONG         version;
+    LONG         pad;
+    LONG64       alloc_pos;    /* end of the last reserved ring entry */
+    LONG64       slots[GLYPH_CACHE_BUCKETS][GLYPH_CACHE_WAYS];  /* entry position + 1, 0 if empty */
+};
+
+struct glyph_cache_stats
+{
+    LONG lookups;
+    LONG hits;
+    LONG inserts;
+    LONG promotions;
+};
+
+static struct glyph_cache_header *glyph_cache;
+static BYTE *glyph_cache_ring;
+static struct glyph_cache_stats glyph_cache_stats;  /* per-process counters */
+
+static inline LONG64 read_pos( LONG64 volatile *pos )
+{
+#ifdef _WIN64
+    return ReadNoFence64( pos );
+#else
+    return InterlockedCompareExchange64( pos, 0, 0 );
+#endif
+}
+
+static inline ULONGLONG hash_bytes( ULONGLONG hash, const void *data, SIZE_T size )
+{
+    const BYTE *ptr = data;
+
+    while (size--) hash = (hash ^ *ptr++) * 0x100000001b3ull;  /* FNV-1a */
+    return hash;
+}
+
+static ULONGLONG checksum_bytes( ULONGLONG hash, const void *data, SIZE_T size )
+{
+    const BYTE *ptr = data;
+    ULONGLONG val;
+
+    for (; size >= sizeof(val); size -= sizeof(val), ptr += sizeof(val))
+    {
+        memcpy( &val, ptr, sizeof(val) );
+        hash = (hash ^ val) * 0x9e3779b97f4a7c15ull;
+        hash ^= hash >> 32;
+    }
+    val = size;
+    memcpy( &val, ptr, size );
+    hash = (hash ^ val ^ ((ULONGLONG)size << 56)) * 0x9e3779b97f4a7c15ull;
+    return hash ^ (hash >> 32);
+}
+
+static ULONGLONG checksum_entry( const struct glyph_cache_entry *entry, const void *bits )
+{
+    ULONGLONG hash = checksum_bytes( 0, entry, offsetof( struct glyph_cache_entry, checksum ));
+    return checksum_bytes( hash, bits, entry->size );
+}
+
+static void init_glyph_cache(void)
+{
+    static const LARGE_INTEGER size = {.QuadPart = sizeof(struct glyph_cache_header) + GLYPH_CACHE_RING_SIZE};
+    WCHAR bufferW[256];
+    UNICODE_STRING name = {.Buffer = bufferW};
+    OBJECT_ATTRIBUTES attr;
+    SIZE_T view_size = 0;
+    char buffer[256];
+    void *ptr = NULL;
+    NTSTATUS status;
+    HANDLE handle;
+    LONG version;
+
+    snprintf( buffer, ARRAY_SIZE(buffer), "\\Sessions\\%u\\BaseNamedObjects\\__wine_glyph_cache",
+              (int)NtCurrentTeb()->Peb->SessionId );
+    name.MaximumLength = asciiz_to_unicode( bufferW, buffer );
+    name.Length = name.MaximumLength - sizeof(WCHAR);
+
+    InitializeObjectAttributes( &attr, &name, OBJ_OPENIF, NULL, NULL );
+    if ((status = NtCreateSection( &handle, SECTION_MAP_READ | SECTION_MAP_WRITE | SECTION_QUERY, &attr,
+                                   &size, PAGE_READWRITE, SEC_COMMIT, 0 )) < 0)
+    {
+        WARN( "Failed to create glyph cache section, status %#x\n", (int)status );
+        return;
+    }
+    if ((status = NtMapViewOfSection( handle, GetCurrentProcess(), &ptr, 0, 0, NULL, &view_size,
+                                      ViewShare, 0, PAGE_READWRITE )))
+    {
+        WARN( "Failed to map glyph cache section, status %#x\n", (int)status );
+        NtClose( handle );
+        return;
+    }
+    /* keep the handle open so that the section stays around for the whole session */
+
+    /* the section is zero-initialized, which is a valid empty cache */
+    version = InterlockedCompareExchange( &((struct glyph_cache_header *)ptr)->version,
+                                          GLYPH_CACHE_VERSION, 0 );
+    if (version && version != GLYPH_CACHE_VERSION)
+    {
+        WARN( "Incompatible glyph cache version %d\n", (int)version );
+        return;
+    }
+
+    glyph_cache = ptr;
+    glyph_cache_ring = (BYTE *)(glyph_cache + 1);
+    TRACE( "mapped glyph cache at %p\n", glyph_cache );
+}
+
+static BOOL get_glyph_cache(void)
+{
+    static pthread_once_t init_once = PTHREAD_ONCE_INIT;
+
+    pthread_once( &init_once, init_glyph_cache );
+    return glyph_cache != NULL;
+}
+
+static BOOL is_cached_format( UINT format )
+{
+    switch (format & ~GGO_UNHINTED)
+    {
+    case GGO_BITMAP:
+    case GGO_GRAY2_BITMAP:
+    case GGO_GRAY4_BITMAP:
+    case GGO_GRAY8_BITMAP:
+    case WINE_GGO_GRAY16_BITMAP:
+    case WINE_GGO_HRGB_BITMAP:
+    case WINE_GGO_HBGR_BITMAP:
+    case WINE_GGO_VRGB_BITMAP:
+    case WINE_GGO_VBGR_BITMAP:
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static BOOL init_glyph_cache_key( struct gdi_font *font, UINT glyph, UINT format, BOOL tategaki,
+                                  struct glyph_cache_key *key )
+{
+    ULONGLONG id;
+
+    if (!is_cached_format( format )) return FALSE;
+    if (!font->file[0]) return FALSE;  /* memory fonts aren't shared between processes */
+    if (!get_glyph_cache()) return FALSE;
+
+    if (!(id = font->glyph_cache_id))
+    {
+        id = hash_bytes( 0xcbf29ce484222325ull, font->file, wcslen( font->file ) * sizeof(WCHAR) );
+        id = hash_bytes( id, &font->writetime, sizeof(font->writetime) );
+        id = hash_bytes( id, &font->face_index, sizeof(font->face_index) );
+        id = hash_bytes( id, &font->ttc_item_offset, sizeof(font->ttc_item_offset) );
+        font->glyph_cache_id = id;
+    }
+
+    memset( key, 0, sizeof(*key) );
+    key->font_id        = id;
+    key->matrix         = font->matrix;
+    key->ppem           = font->ppem;
+    key->scale_y        = font->scale_y;
+    key->ave_width      = font->aveWidth;
+    key->height         = font->lf.lfHeight;
+    key->width          = font->lf.lfWidth;
+    key->escapement     = font->lf.lfEscapement;
+    key->orientation    = font->lf.lfOrientation;
+    key->weight         = font->lf.lfWeight;
+    key->glyph          = glyph;
+    key->format         = format;
+    key->italic         = font->lf.lfItalic;
+    key->fake_bold      = font->fake_bold;
+    key->fake_italic    = font->fake_italic;
+    key->tategaki       = tategaki;
+    key->can_use_bitmap = font->can_use_bitmap;
+    return TRUE;
+}
+
+static inline LONG64 *get_bucket( const struct glyph_cache_key *key )
+{
+    return glyph_cache->slots[hash_bytes( 0xcbf29ce484222325ull, key, sizeof(*key) ) % GLYPH_CACHE_BUCKETS];
+}
+
+static inline UINT get_entry_len( UINT size )
+{
+    return (offsetof( struct glyph_cache_entry, bits[size] ) + GLYPH_CACHE_ALIGN - 1) & ~(GLYPH_CACHE_ALIGN - 1);
+}
+
+/* check that the entry at pos hasn't been (partly) overwritten by a more recent one */
+static inline BOOL is_entry_valid( LONG64 pos )
+{
+    return read_pos( &glyph_cache->alloc_pos ) <= pos + GLYPH_CACHE_RING_SIZE;
+}
+
+static inline struct glyph_cache_entry *get_entry( LONG64 pos )
+{
+    return (struct glyph_cache_entry *)(glyph_cache_ring + pos % GLYPH_CACHE_RING_SIZE);
+}
+
+static void store_entry( LONG64 *bucket, const struct glyph_cache_key *key, const GLYPHMETRICS *gm,
+                         const ABC *abc, UINT size, const void *bits, LONG64 replace )
+{
+    UINT len = get_entry_len( size );
+    struct glyph_cache_entry header, *entry;
+    LONG64 pos, start, end, oldest, slot;
+    int i, way;
+
+    /* reserve ring space, entries never straddle the end of the ring */
+    do
+    {
+        pos = read_pos( &glyph_cache->alloc_pos );
+        start = pos;
+        if (start % GLYPH_CACHE_RING_SIZE + len > GLYPH_CACHE_RING_SIZE)
+            start += GLYPH_CACHE_RING_SIZE - start % GLYPH_CACHE_RING_SIZE;
+        end = start + len;
+    } while (InterlockedCompareExchange64( &glyph_cache->alloc_pos, end, pos ) != pos);
+
+    /* don't bother if other writers already went all around the ring */
+    if (!is_entry_valid( start )) return;
+
+    memset( &header, 0, sizeof(header) );
+    header.key  = *key;
+    header.gm   = *gm;
+    header.abc  = *abc;
+    header.size = size;
+    header.checksum = checksum_entry( &header, bits );
+
+    entry = get_entry( start );
+    memcpy( entry, &header, sizeof(header) );
+    memcpy( entry->bits, bits, size );
+    MemoryBarrier();
+
+    /* replace the requested slot, or else an empty or the oldest one */
+    way = 0;
+    oldest = -1;
+    for (i = 0; i < GLYPH_CACHE_WAYS; i++)
+    {
+        slot = read_pos( &bucket[i] );
+        if (replace && slot == replace)
+        {
+            way = i;
+            break;
+        }
+        if (oldest == -1 || slot < oldest)
+        {
+            oldest = slot;
+            way = i;
+        }
+    }
+    slot = read_pos( &bucket[way] );
+    /* losing the race against another writer only means that one of the entries isn't published */
+    InterlockedCompareExchange64( &bucket[way], start + 1, slot );
+}
+
+static void trace_glyph_cache_stats(void)
+{
+    TRACE( "%d lookups, %d hits, %d inserts, %d promotions\n",
+           (int)glyph_cache_stats.lookups, (int)glyph_cache_stats.hits,
+           (int)glyph_cache_stats.inserts, (int)glyph_cache_stats.promotions );
+}
+
+/***********************************************************************
+ *              get_shared_glyph
+ *
+ * Look up a glyph bitmap in the session-wide cache, following the
+ * GetGlyphOutline conventions for buf and buflen. Returns FALSE on a miss.
+ */
+BOOL get_shared_glyph( struct gdi_font *font, UINT glyph, UINT format, BOOL tategaki,
+                       GLYPHMETRICS *gm, ABC *abc, DWORD buflen, void *buf, DWORD *ret )
+{
+    struct glyph_cache_key key;
+    struct glyph_cache_entry header, *entry;
+    LONG64 *bucket, slot, pos;
+    int i;
+
+    if (!init_glyph_cache_key( font, glyph, format, tategaki, &key )) return FALSE;
+
+    if (!(InterlockedIncrement( &glyph_cache_stats.lookups ) % 4096) && TRACE_ON(font))
+        trace_glyph_cache_stats();
+
+    bucket = get_bucket( &key );
+    for (i = 0; i < GLYPH_CACHE_WAYS; i++)
+    {
+        if (!(slot = read_pos( &bucket[i] ))) continue;
+        MemoryBarrier();
+        pos = slot - 1;
+        if (!is_entry_valid( pos )) continue;
+
+        entry = get_entry( pos );
+        memcpy( &header, entry, sizeof(header) );
+        if (memcmp( &header.key, &key, sizeof(key) )) continue;
+        if (header.size > GLYPH_CACHE_MAX_BITS) continue;
+        if (pos % GLYPH_CACHE_RING_SIZE + get_entry_len( header.size ) > GLYPH_CACHE_RING_SIZE) continue;
+        if (buf && buflen)
+        {
+            if (header.size > buflen) continue;  /* let the backend report the error */
+            memcpy( buf, entry->bits, header.size );
+            if (checksum_entry( &header, buf ) != header.checksum) continue;
+        }
+        else if (checksum_entry( &header, entry->bits ) != header.checksum) continue;
+        MemoryBarrier();
+        if (!is_entry_valid( pos )) continue;
+
+        *gm = header.gm;
+        *abc = header.abc;
+        *ret = header.size;
+        InterlockedIncrement( &glyph_cache_stats.hits );
+
+        /* give entries that are about to be overwritten a second chance */
+        if (buf && buflen && read_pos( &glyph_cache->alloc_pos ) - pos > GLYPH_CACHE_RING_SIZE / 4 * 3)
+        {
+            store_entry( bucket, &key, gm, abc, header.size, buf, slot );
+            InterlockedIncrement( &glyph_cache_stats.promotions );
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+/***********************************************************************
+ *              add_shared_glyph
+ *
+ * Add a glyph bitmap returned by the font backend to the session-wide cache.
+ */
+void add_shared_glyph( struct gdi_font *font, UINT glyph, UINT format, BOOL tategaki,
+                       const GLYPHMETRICS *gm, const ABC *abc, DWORD size, const void *bits )
+{
+    struct glyph_cache_key key;
+
+    if (size > GLYPH_CACHE_MAX_BITS) return;
+    if (!init_glyph_cache_key( font, glyph, format, tategaki, &key )) return;
+
+    store_entry( get_bucket( &key ), &key, gm, abc, size, bits, 0 );
+    InterlockedIncrement( &glyph_cache_stats.inserts );
+}
@@ -265,6 +265,7 @@ struct gdi_font
     DWORD                  handle;
     DWORD                  cache_num;
     DWORD                  hash;
+    ULONGLONG              glyph_cache_id;  /* shared glyph cache font id, 0 if not computed yet */
     UINT                   charset;
     UINT                   codepage;
     FONTSIGNATURE          fs;
@@ -344,6 +345,12 @@ extern int add_gdi_face( const WCHAR *family_name, const WCHAR *second_name,
 extern UINT font_init(void);
 extern const struct font_backend_funcs *init_freetype_lib(void);
 
+/* glyphcache.c */
+extern BOOL get_shared_glyph( struct gdi_font *font, UINT glyph, UINT format, BOOL tategaki,
+                              GLYPHMETRICS *gm, ABC *abc, DWORD buflen, void *buf, DWORD *ret );
+extern void add_shared_glyph( struct gdi_font *font, UINT glyph, UINT format, BOOL tategaki,
+                              const GLYPHMETRICS *gm, const ABC *abc, DWORD size, const void *bits );
+
 /* opentype.c */
 
 struct ttc_sfnt_v1;
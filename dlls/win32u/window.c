@@ -1025,6 +1025,28 @@ static LONG_PTR get_window_long_size( HWND hwnd, INT offset, UINT size, BOOL ans
             RtlSetLastWin32Error( ERROR_ACCESS_DENIED );
             return 0;
         }
+        if (offset == GWL_STYLE || offset == GWL_EXSTYLE || offset == GWLP_ID ||
+            offset == GWLP_HINSTANCE || offset == GWLP_USERDATA)
+        {
+            /* read the window state from shared memory, without a server round trip */
+            struct object_lock lock = OBJECT_LOCK_INIT;
+            const window_shm_t *window_shm;
+            NTSTATUS status;
+
+            while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+            {
+                switch (offset)
+                {
+                case GWL_STYLE:      retval = window_shm->style; break;
+                case GWL_EXSTYLE:    retval = window_shm->ex_style; break;
+                case GWLP_ID:        retval = window_shm->id; break;
+                case GWLP_HINSTANCE: retval = (ULONG_PTR)wine_server_get_ptr( window_shm->instance ); break;
+                case GWLP_USERDATA:  retval = window_shm->user_data; break;
+                }
+            }
+            if (!status) return retval;
+            retval = 0;
+        }
         SERVER_START_REQ( set_window_info )
         {
             req->handle = wine_server_user_handle( hwnd );
@@ -1668,6 +1690,45 @@ BOOL get_window_rects( HWND hwnd, enum coords_relative relative, RECT *window_re
     }
 
 other_process:
+    if (dpi && (relative == COORDS_CLIENT || relative == COORDS_WINDOW))
+    {
+        /* rectangles relative to the window itself don't need the parent chain */
+        struct object_lock lock = OBJECT_LOCK_INIT;
+        const window_shm_t *window_shm;
+        RECT window = {0}, client = {0};
+        UINT window_dpi = 0;
+        NTSTATUS status;
+
+        while ((status = get_shared_window( hwnd, &lock, &window_shm )) == STATUS_PENDING)
+        {
+            RECT rect;
+
+            window = wine_server_get_rect( window_shm->window_rect );
+            client = wine_server_get_rect( window_shm->client_rect );
+            window_dpi = window_shm->dpi;
+            if (relative == COORDS_CLIENT)
+            {
+                rect = client;
+                OffsetRect( &window, -rect.left, -rect.top );
+                OffsetRect( &client, -rect.left, -rect.top );
+                if (window_shm->ex_style & WS_EX_LAYOUTRTL) mirror_rect( &rect, &window );
+            }
+            else
+            {
+                rect = window;
+                OffsetRect( &window, -rect.left, -rect.top );
+                OffsetRect( &client, -rect.left, -rect.top );
+                if (window_shm->ex_style & WS_EX_LAYOUTRTL) mirror_rect( &rect, &client );
+            }
+        }
+        if (!status)
+        {
+            if (window_rect) *window_rect = map_dpi_rect( window, window_dpi, dpi );
+            if (client_rect) *client_rect = map_dpi_rect( client, window_dpi, dpi );
+            return TRUE;
+        }
+    }
+
     SERVER_START_REQ( get_window_rectangles )
     {
         req->handle = wine_server_user_handle( hwnd );
@@ -2268,7 +2329,7 @@ BOOL WINAPI NtUserUpdateLayeredWindow( HWND hwnd, HDC hdc_dst, const POINT *pts_
         ret = NtGdiAlphaBlend( hdc, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top,
                                hdc_src, src_rect.left, src_rect.top, src_rect.right - src_rect.left, src_rect.bottom - src_rect.top,
                                *(DWORD *)&src_blend, 0 );
-        if (ret) add_bounds_rect( &surface->bounds, &rect );
+        if (ret) window_surface_add_damage( surface, &rect );
 
         NtGdiDeleteObjectApp( hdc );
         window_surface_unlock( surface );
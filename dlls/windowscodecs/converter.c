@@ -79,17 +79,13 @@ typedef struct FormatConverter {
     WICBitmapDitherType dither;
     double alpha_threshold;
     IWICPalette *palette;
+    UINT dst_bpp;
     CRITICAL_SECTION lock; /* must be held when initialized */
+    CRITICAL_SECTION source_lock; /* serializes source access from concurrent bands */
 } FormatConverter;
 
-/* https://www.w3.org/Graphics/Color/srgb */
-static inline float to_sRGB_component(float f)
-{
-    if (f <= 0.0031308f) return 12.92f * f;
-    return 1.055f * powf(f, 1.0f/2.4f) - 0.055f;
-}
-
 #if 0 /* FIXME: enable once needed */
+/* https://www.w3.org/Graphics/Color/srgb */
 static inline float from_sRGB_component(float f)
 {
     if (f <= 0.04045f) return f / 12.92f;
@@ -112,33 +108,41 @@ static void from_sRGB(BYTE *bgr)
     bgr[1] = (BYTE)(g * 255.0f);
     bgr[0] = (BYTE)(b * 255.0f);
 }
+#endif
 
-static void to_sRGB(BYTE *bgr)
+static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter *iface)
 {
-    float r, g, b;
+    return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
+}
 
-    r = bgr[2] / 255.0f;
-    g = bgr[1] / 255.0f;
-    b = bgr[0] / 255.0f;
+static HRESULT copy_source_pixels(struct FormatConverter *This, const WICRect *prc,
+    UINT stride, UINT size, BYTE *buffer)
+{
+    HRESULT hr;
 
-    r = to_sRGB_component(r);
-    g = to_sRGB_component(g);
-    b = to_sRGB_component(b);
+    EnterCriticalSection(&This->source_lock);
+    hr = IWICBitmapSource_CopyPixels(This->source, prc, stride, size, buffer);
+    LeaveCriticalSection(&This->source_lock);
 
-    bgr[2] = (BYTE)(r * 255.0f);
-    bgr[1] = (BYTE)(g * 255.0f);
-    bgr[0] = (BYTE)(b * 255.0f);
+    return hr;
 }
-#endif
 
-static inline FormatConverter *impl_from_IWICFormatConverter(IWICFormatConverter *iface)
+static HRESULT copy_source_palette(struct FormatConverter *This, IWICPalette *palette)
 {
-    return CONTAINING_RECORD(iface, FormatConverter, IWICFormatConverter_iface);
+    HRESULT hr;
+
+    EnterCriticalSection(&This->source_lock);
+    hr = IWICBitmapSource_CopyPalette(This->source, palette);
+    LeaveCriticalSection(&This->source_lock);
+
+    return hr;
 }
 
 static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRect *prc,
     UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer, enum pixelformat source_format)
 {
+    const struct pixel_kernels *kernels = get_pixel_kernels();
+
     switch (source_format)
     {
     case format_1bppIndexed:
@@ -161,7 +165,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             if (FAILED(res)) return res;
 
             if (source_format == format_1bppIndexed)
-                res = IWICBitmapSource_CopyPalette(This->source, palette);
+                res = copy_source_palette(This, palette);
             else
                 res = IWICPalette_InitializePredefined(palette, WICBitmapPaletteTypeFixedBW, FALSE);
 
@@ -177,7 +181,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -228,7 +232,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             if (FAILED(res)) return res;
 
             if (source_format == format_2bppIndexed)
-                res = IWICBitmapSource_CopyPalette(This->source, palette);
+                res = copy_source_palette(This, palette);
             else
                 res = IWICPalette_InitializePredefined(palette, WICBitmapPaletteTypeFixedGray4, FALSE);
 
@@ -244,7 +248,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -291,7 +295,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             if (FAILED(res)) return res;
 
             if (source_format == format_4bppIndexed)
-                res = IWICBitmapSource_CopyPalette(This->source, palette);
+                res = copy_source_palette(This, palette);
             else
                 res = IWICPalette_InitializePredefined(palette, WICBitmapPaletteTypeFixedGray16, FALSE);
 
@@ -307,7 +311,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -350,7 +354,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -392,7 +396,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             res = PaletteImpl_Create(&palette);
             if (FAILED(res)) return res;
 
-            res = IWICBitmapSource_CopyPalette(This->source, palette);
+            res = copy_source_palette(This, palette);
             if (SUCCEEDED(res))
                 res = IWICPalette_GetColors(palette, 256, colors, &actualcolors);
 
@@ -406,7 +410,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -445,7 +449,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -488,7 +492,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -536,7 +540,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -584,7 +588,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -618,13 +622,11 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            INT x, y;
+            INT y;
             BYTE *srcdata;
             UINT srcstride, srcdatasize;
             const BYTE *srcrow;
-            const BYTE *srcpixel;
             BYTE *dstrow;
-            BYTE *dstpixel;
 
             srcstride = 3 * prc->Width;
             srcdatasize = srcstride * prc->Height;
@@ -632,21 +634,14 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
                 srcrow = srcdata;
                 dstrow = pbBuffer;
                 for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        *dstpixel++=*srcpixel++; /* blue */
-                        *dstpixel++=*srcpixel++; /* green */
-                        *dstpixel++=*srcpixel++; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
+                    kernels->bgr24_to_bgra32(srcrow, dstrow, prc->Width);
                     srcrow += srcstride;
                     dstrow += cbStride;
                 }
@@ -661,14 +656,11 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            INT x, y;
+            INT y;
             BYTE *srcdata;
             UINT srcstride, srcdatasize;
             const BYTE *srcrow;
-            const BYTE *srcpixel;
             BYTE *dstrow;
-            BYTE *dstpixel;
-            BYTE tmppixel[3];
 
             srcstride = 3 * prc->Width;
             srcdatasize = srcstride * prc->Height;
@@ -676,25 +668,14 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
                 srcrow = srcdata;
                 dstrow = pbBuffer;
                 for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        tmppixel[0]=*srcpixel++; /* red */
-                        tmppixel[1]=*srcpixel++; /* green */
-                        tmppixel[2]=*srcpixel++; /* blue */
-
-                        *dstpixel++=tmppixel[2]; /* blue */
-                        *dstpixel++=tmppixel[1]; /* green */
-                        *dstpixel++=tmppixel[0]; /* red */
-                        *dstpixel++=255; /* alpha */
-                    }
+                    kernels->rgb24_to_bgra32(srcrow, dstrow, prc->Width);
                     srcrow += srcstride;
                     dstrow += cbStride;
                 }
@@ -711,7 +692,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             HRESULT res;
             INT x, y;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            res = copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
             /* set all alpha values to 255 */
@@ -724,48 +705,37 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            res = copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
             reverse_bgr8(4, pbBuffer, prc->Width, prc->Height, cbStride);
         }
         return S_OK;
     case format_32bppBGRA:
         if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            return copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
     case format_32bppPBGRA:
         if (prc)
         {
             HRESULT res;
-            INT x, y;
+            INT y;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            res = copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
             for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 0 && alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = pbBuffer[cbStride*y+4*x] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+1] = pbBuffer[cbStride*y+4*x+1] * 255 / alpha;
-                        pbBuffer[cbStride*y+4*x+2] = pbBuffer[cbStride*y+4*x+2] * 255 / alpha;
-                    }
-                }
+                kernels->unpremultiply32(pbBuffer + cbStride * y, prc->Width);
         }
         return S_OK;
     case format_48bppRGB:
         if (prc)
         {
             HRESULT res;
-            INT x, y;
+            INT y;
             BYTE *srcdata;
             UINT srcstride, srcdatasize;
             const BYTE *srcrow;
-            const BYTE *srcpixel;
             BYTE *dstrow;
-            DWORD *dstpixel;
 
             srcstride = 6 * prc->Width;
             srcdatasize = srcstride * prc->Height;
@@ -773,22 +743,14 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
                 srcrow = srcdata;
                 dstrow = pbBuffer;
                 for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue;
-                        srcpixel++; red = *srcpixel++;
-                        srcpixel++; green = *srcpixel++;
-                        srcpixel++; blue = *srcpixel++;
-                        *dstpixel++=0xff000000|red<<16|green<<8|blue;
-                    }
+                    kernels->rgb48_to_bgra32(srcrow, dstrow, prc->Width);
                     srcrow += srcstride;
                     dstrow += cbStride;
                 }
@@ -803,13 +765,11 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
         if (prc)
         {
             HRESULT res;
-            INT x, y;
+            INT y;
             BYTE *srcdata;
             UINT srcstride, srcdatasize;
             const BYTE *srcrow;
-            const BYTE *srcpixel;
             BYTE *dstrow;
-            DWORD *dstpixel;
 
             srcstride = 8 * prc->Width;
             srcdatasize = srcstride * prc->Height;
@@ -817,23 +777,14 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
                 srcrow = srcdata;
                 dstrow = pbBuffer;
                 for (y=0; y<prc->Height; y++) {
-                    srcpixel=srcrow;
-                    dstpixel=(DWORD*)dstrow;
-                    for (x=0; x<prc->Width; x++) {
-                        BYTE red, green, blue, alpha;
-                        srcpixel++; red = *srcpixel++;
-                        srcpixel++; green = *srcpixel++;
-                        srcpixel++; blue = *srcpixel++;
-                        srcpixel++; alpha = *srcpixel++;
-                        *dstpixel++=alpha<<24|red<<16|green<<8|blue;
-                    }
+                    kernels->rgba64_to_bgra32(srcrow, dstrow, prc->Width);
                     srcrow += srcstride;
                     dstrow += cbStride;
                 }
@@ -850,7 +801,7 @@ static HRESULT copypixels_to_32bppBGRA(struct FormatConverter *This, const WICRe
             HRESULT res;
             UINT x, y;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            res = copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(res)) return res;
 
             for (y=0; y<prc->Height; y++)
@@ -883,7 +834,7 @@ static HRESULT copypixels_to_32bppRGBA(struct FormatConverter *This, const WICRe
         {
             INT x, y;
 
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            hr = copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(hr)) return hr;
 
             /* set all alpha values to 255 */
@@ -895,7 +846,7 @@ static HRESULT copypixels_to_32bppRGBA(struct FormatConverter *This, const WICRe
 
     case format_32bppRGBA:
         if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            return copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
 
     case format_32bppPRGBA:
@@ -903,7 +854,7 @@ static HRESULT copypixels_to_32bppRGBA(struct FormatConverter *This, const WICRe
         {
             INT x, y;
 
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            hr = copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
             if (FAILED(hr)) return hr;
 
             for (y=0; y<prc->Height; y++)
@@ -937,7 +888,7 @@ static HRESULT copypixels_to_32bppBGR(struct FormatConverter *This, const WICRec
     case format_32bppBGRA:
     case format_32bppPBGRA:
         if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            return copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
     default:
         return copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
@@ -953,7 +904,7 @@ static HRESULT copypixels_to_32bppRGB(struct FormatConverter *This, const WICRec
     case format_32bppRGBA:
     case format_32bppPRGBA:
         if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            return copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
     default:
         return copypixels_to_32bppRGBA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
@@ -969,25 +920,17 @@ static HRESULT copypixels_to_32bppPBGRA(struct FormatConverter *This, const WICR
     {
     case format_32bppPBGRA:
         if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            return copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
     default:
         hr = copypixels_to_32bppBGRA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
         {
-            INT x, y;
+            const struct pixel_kernels *kernels = get_pixel_kernels();
+            INT y;
 
             for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = (pbBuffer[cbStride*y+4*x] * alpha + 127) / 255;
-                        pbBuffer[cbStride*y+4*x+1] = (pbBuffer[cbStride*y+4*x+1] * alpha + 127) / 255;
-                        pbBuffer[cbStride*y+4*x+2] = (pbBuffer[cbStride*y+4*x+2] * alpha + 127) / 255;
-                    }
-                }
+                kernels->premultiply32(pbBuffer + cbStride * y, prc->Width);
         }
         return hr;
     }
@@ -1002,25 +945,17 @@ static HRESULT copypixels_to_32bppPRGBA(struct FormatConverter *This, const WICR
     {
     case format_32bppPRGBA:
         if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            return copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
     default:
         hr = copypixels_to_32bppRGBA(This, prc, cbStride, cbBufferSize, pbBuffer, source_format);
         if (SUCCEEDED(hr) && prc)
         {
-            INT x, y;
+            const struct pixel_kernels *kernels = get_pixel_kernels();
+            INT y;
 
             for (y=0; y<prc->Height; y++)
-                for (x=0; x<prc->Width; x++)
-                {
-                    BYTE alpha = pbBuffer[cbStride*y+4*x+3];
-                    if (alpha != 255)
-                    {
-                        pbBuffer[cbStride*y+4*x] = (pbBuffer[cbStride*y+4*x] * alpha + 127) / 255;
-                        pbBuffer[cbStride*y+4*x+1] = (pbBuffer[cbStride*y+4*x+1] * alpha + 127) / 255;
-                        pbBuffer[cbStride*y+4*x+2] = (pbBuffer[cbStride*y+4*x+2] * alpha + 127) / 255;
-                    }
-                }
+                kernels->premultiply32(pbBuffer + cbStride * y, prc->Width);
         }
         return hr;
     }
@@ -1037,7 +972,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
     case format_24bppRGB:
         if (prc)
         {
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            hr = copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
             if (SUCCEEDED(hr) && source_format == format_24bppRGB)
               reverse_bgr8(3, pbBuffer, prc->Width, prc->Height, cbStride);
             return hr;
@@ -1050,13 +985,12 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
         if (prc)
         {
             HRESULT res;
-            INT x, y;
+            INT y;
             BYTE *srcdata;
             UINT srcstride, srcdatasize;
             const BYTE *srcrow;
-            const BYTE *srcpixel;
             BYTE *dstrow;
-            BYTE *dstpixel;
+            void (*convert_row)(const BYTE *src, BYTE *dst, UINT width);
 
             srcstride = 4 * prc->Width;
             srcdatasize = srcstride * prc->Height;
@@ -1064,44 +998,24 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
-                srcrow = srcdata;
-                dstrow = pbBuffer;
+                const struct pixel_kernels *kernels = get_pixel_kernels();
 
                 if (source_format == format_32bppRGBA)
-                {
-                    for (y = 0; y < prc->Height; y++)
-                    {
-                        srcpixel = srcrow;
-                        dstpixel = dstrow;
-                        for (x = 0; x < prc->Width; x++) {
-                            *dstpixel++ = srcpixel[2]; /* blue */
-                            *dstpixel++ = srcpixel[1]; /* green */
-                            *dstpixel++ = srcpixel[0]; /* red */
-                            srcpixel += 4;
-                        }
-                        srcrow += srcstride;
-                        dstrow += cbStride;
-                    }
-                }
+                    convert_row = kernels->rgba32_to_bgr24;
                 else
+                    convert_row = kernels->bgra32_to_bgr24;
+
+                srcrow = srcdata;
+                dstrow = pbBuffer;
+                for (y = 0; y < prc->Height; y++)
                 {
-                    for (y = 0; y < prc->Height; y++)
-                    {
-                        srcpixel = srcrow;
-                        dstpixel = dstrow;
-                        for (x = 0; x < prc->Width; x++) {
-                            *dstpixel++ = *srcpixel++; /* blue */
-                            *dstpixel++ = *srcpixel++; /* green */
-                            *dstpixel++ = *srcpixel++; /* red */
-                            srcpixel++; /* alpha */
-                        }
-                        srcrow += srcstride;
-                        dstrow += cbStride;
-                    }
+                    convert_row(srcrow, dstrow, prc->Width);
+                    srcrow += srcstride;
+                    dstrow += cbStride;
                 }
             }
 
@@ -1123,7 +1037,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            hr = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(hr))
             {
@@ -1137,7 +1051,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
 
                     for (x = 0; x < prc->Width; x++)
                     {
-                        BYTE gray = (BYTE)floorf(to_sRGB_component(gray_float[x]) * 255.0f + 0.51f);
+                        BYTE gray = float_to_srgb8(gray_float[x]);
                         *bgr++ = gray;
                         *bgr++ = gray;
                         *bgr++ = gray;
@@ -1165,7 +1079,7 @@ static HRESULT copypixels_to_24bppBGR(struct FormatConverter *This, const WICRec
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            hr = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
             if (SUCCEEDED(hr))
             {
                 INT x, y;
@@ -1212,7 +1126,7 @@ static HRESULT copypixels_to_24bppRGB(struct FormatConverter *This, const WICRec
     case format_24bppRGB:
         if (prc)
         {
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            hr = copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
             if (SUCCEEDED(hr) && source_format == format_24bppBGR)
               reverse_bgr8(3, pbBuffer, prc->Width, prc->Height, cbStride);
             return hr;
@@ -1239,7 +1153,7 @@ static HRESULT copypixels_to_24bppRGB(struct FormatConverter *This, const WICRec
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
 
             if (SUCCEEDED(res))
             {
@@ -1287,7 +1201,7 @@ static HRESULT copypixels_to_32bppGrayFloat(struct FormatConverter *This, const
     case format_32bppGrayFloat:
         if (prc)
         {
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            hr = copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
             break;
         }
         return S_OK;
@@ -1327,7 +1241,7 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
     if (source_format == format_8bppGray)
     {
         if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            return copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
 
         return S_OK;
     }
@@ -1344,20 +1258,16 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            hr = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            hr = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
             if (SUCCEEDED(hr))
             {
-                INT x, y;
+                const struct pixel_kernels *kernels = get_pixel_kernels();
+                INT y;
                 BYTE *src = srcdata, *dst = pbBuffer;
 
                 for (y=0; y < prc->Height; y++)
                 {
-                    float *srcpixel = (float*)src;
-                    BYTE *dstpixel = dst;
-
-                    for (x=0; x < prc->Width; x++)
-                        *dstpixel++ = (BYTE)floorf(to_sRGB_component(*srcpixel++) * 255.0f + 0.51f);
-
+                    kernels->float_to_srgb8((const float *)src, dst, prc->Width);
                     src += srcstride;
                     dst += cbStride;
                 }
@@ -1392,8 +1302,7 @@ static HRESULT copypixels_to_8bppGray(struct FormatConverter *This, const WICRec
             {
                 float gray = (bgr[2] * 0.2126f + bgr[1] * 0.7152f + bgr[0] * 0.0722f) / 255.0f;
 
-                gray = to_sRGB_component(gray) * 255.0f;
-                dst[x] = (BYTE)floorf(gray + 0.51f);
+                dst[x] = float_to_srgb8(gray);
                 bgr += 3;
             }
             src += srcstride;
@@ -1449,7 +1358,7 @@ static HRESULT copypixels_to_8bppIndexed(struct FormatConverter *This, const WIC
     if (source_format == format_8bppIndexed)
     {
         if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            return copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
 
         return S_OK;
     }
@@ -1499,7 +1408,7 @@ static HRESULT copypixels_to_16bppBGRA5551(struct FormatConverter *This, const W
     {
     case format_16bppBGRA5551:
         if (prc)
-            return IWICBitmapSource_CopyPixels(This->source, prc, cbStride, cbBufferSize, pbBuffer);
+            return copy_source_pixels(This, prc, cbStride, cbBufferSize, pbBuffer);
         return S_OK;
     case format_32bppBGRA:
         if(prc)
@@ -1522,7 +1431,7 @@ static HRESULT copypixels_to_16bppBGRA5551(struct FormatConverter *This, const W
             srcdata = malloc(srcdatasize);
             if (!srcdata) return E_OUTOFMEMORY;
 
-            res = IWICBitmapSource_CopyPixels(This->source, prc, srcstride, srcdatasize, srcdata);
+            res = copy_source_pixels(This, prc, srcstride, srcdatasize, srcdata);
             if(SUCCEEDED(res))
             {
                 srcrow = srcdata;
@@ -1638,6 +1547,8 @@ static ULONG WINAPI FormatConverter_Release(IWICFormatConverter *iface)
     {
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
+        This->source_lock.DebugInfo->Spare[0] = 0;
+        DeleteCriticalSection(&This->source_lock);
         if (This->source) IWICBitmapSource_Release(This->source);
         if (This->palette) IWICPalette_Release(This->palette);
         free(This);
@@ -1706,6 +1617,56 @@ static HRESULT WINAPI FormatConverter_CopyPalette(IWICFormatConverter *iface,
     return IWICPalette_InitializeFromPalette(palette, This->palette);
 }
 
+struct convert_bands_context
+{
+    FormatConverter *converter;
+    const WICRect *rect;
+    UINT stride;
+    UINT buffer_size;
+    BYTE *buffer;
+};
+
+static HRESULT convert_band(void *ctx, UINT y, UINT height)
+{
+    struct convert_bands_context *context = ctx;
+    FormatConverter *This = context->converter;
+    UINT offset = context->stride * y;
+    WICRect rc;
+
+    rc.X = context->rect->X;
+    rc.Y = context->rect->Y + y;
+    rc.Width = context->rect->Width;
+    rc.Height = height;
+
+    return This->dst_format->copy_function(This, &rc, context->stride,
+        min(context->buffer_size - offset, context->stride * height),
+        context->buffer + offset, This->src_format->format);
+}
+
+/* Conversions are independent per pixel, so a request can be split into
+ * row bands with identical results. Only do so for well-formed requests,
+ * so that errors are reported exactly as in the serial case, and for
+ * sources which don't have to be read from top to bottom. */
+static BOOL can_process_bands(FormatConverter *This, const WICRect *prc,
+    UINT stride, UINT buffer_size)
+{
+    UINT width, height, row_size;
+
+    if (!This->dst_bpp || prc->X < 0 || prc->Y < 0 || prc->Width <= 1 || prc->Height <= 1)
+        return FALSE;
+
+    if (bitmap_source_is_sequential(This->source))
+        return FALSE;
+
+    if (FAILED(IWICBitmapSource_GetSize(This->source, &width, &height))
+        || (UINT)(prc->X + prc->Width) > width || (UINT)(prc->Y + prc->Height) > height)
+        return FALSE;
+
+    row_size = ((ULONGLONG)This->dst_bpp * prc->Width + 7) / 8;
+    return stride >= row_size
+        && (ULONGLONG)stride * (prc->Height - 1) + row_size <= buffer_size;
+}
+
 static HRESULT WINAPI FormatConverter_CopyPixels(IWICFormatConverter *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -1728,6 +1689,18 @@ static HRESULT WINAPI FormatConverter_CopyPixels(IWICFormatConverter *iface,
             prc = &rc;
         }
 
+        if (can_process_bands(This, prc, cbStride, cbBufferSize))
+        {
+            struct convert_bands_context context;
+
+            context.converter = This;
+            context.rect = prc;
+            context.stride = cbStride;
+            context.buffer_size = cbBufferSize;
+            context.buffer = pbBuffer;
+            return process_bands(prc->Width, prc->Height, convert_band, &context);
+        }
+
         return This->dst_format->copy_function(This, prc, cbStride, cbBufferSize,
             pbBuffer, This->src_format->format);
     }
@@ -1817,6 +1790,9 @@ static HRESULT WINAPI FormatConverter_Initialize(IWICFormatConverter *iface,
 
     if (dstinfo->copy_function)
     {
+        if (FAILED(get_pixelformat_bpp(dstFormat, &This->dst_bpp)))
+            This->dst_bpp = 0;
+
         IWICBitmapSource_AddRef(source);
         This->src_format = srcinfo;
         This->dst_format = dstinfo;
@@ -1908,6 +1884,8 @@ HRESULT FormatConverter_CreateInstance(REFIID iid, void** ppv)
     This->palette = NULL;
     InitializeCriticalSectionEx(&This->lock, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": FormatConverter.lock");
+    InitializeCriticalSectionEx(&This->source_lock, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
+    This->source_lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": FormatConverter.source_lock");
 
     ret = IWICFormatConverter_QueryInterface(&This->IWICFormatConverter_iface, iid, ppv);
     IWICFormatConverter_Release(&This->IWICFormatConverter_iface);
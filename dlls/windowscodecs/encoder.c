@@ -180,6 +180,14 @@ static HRESULT WINAPI CommonEncoderFrame_Initialize(IWICBitmapFrameEncode *iface
                     options.filter = WICPngFilterUnspecified;
                 }
                 break;
+            case ENCODER_OPTION_COMPRESSION_METHOD:
+                options.compression = V_UI1(val);
+                if (options.compression > WICTiffCompressionLZWHDifferencing)
+                {
+                    WARN("Unrecognized compression option value %lu.\n", options.compression);
+                    options.compression = WICTiffCompressionDontCare;
+                }
+                break;
             default:
                 break;
             }
@@ -189,6 +197,7 @@ static HRESULT WINAPI CommonEncoderFrame_Initialize(IWICBitmapFrameEncode *iface
     {
         options.interlace = FALSE;
         options.filter = WICPngFilterUnspecified;
+        options.compression = WICTiffCompressionDontCare;
     }
 
     EnterCriticalSection(&This->parent->lock);
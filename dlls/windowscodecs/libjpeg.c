@@ -73,13 +73,22 @@ struct jpeg_decoder {
     struct decoder decoder;
     struct decoder_frame frame;
     BOOL cinfo_initialized;
+    BOOL decompressing; /* jpeg_start_decompress() was called */
+    BOOL need_header; /* the header has to be read again before decompressing */
+    UINT scale_denom; /* IDCT scaling of the current pass */
+    UINT scaled_width[4], scaled_height[4]; /* output sizes for 1/1, 1/2, 1/4 and 1/8 */
+    J_COLOR_SPACE out_color_space;
     IStream *stream;
+    ULONGLONG stream_pos;
+    const BYTE *stream_data; /* set if the stream can be read in place */
+    ULONGLONG stream_size;
     struct jpeg_decompress_struct cinfo;
     struct jpeg_error_mgr jerr;
     struct jpeg_source_mgr source_mgr;
     BYTE source_buffer[1024];
     UINT stride;
-    BYTE *image_data;
+    BYTE *image_data; /* whole frame, only decoded after non-sequential access */
+    BYTE *scanline;
 };
 
 static inline struct jpeg_decoder *impl_from_decoder(struct decoder* iface)
@@ -98,6 +107,7 @@ static void CDECL jpeg_decoder_destroy(struct decoder* iface)
 
     if (This->cinfo_initialized) jpeg_destroy_decompress(&This->cinfo);
     free(This->image_data);
+    free(This->scanline);
     free(This);
 }
 
@@ -105,13 +115,27 @@ static void source_mgr_init_source(j_decompress_ptr cinfo)
 {
 }
 
+/* Pixels are decoded lazily, and the stream may be used by others (e.g. the
+ * metadata readers) in the meantime, so always read from our own position. */
 static boolean source_mgr_fill_input_buffer(j_decompress_ptr cinfo)
 {
     struct jpeg_decoder *This = decoder_from_decompress(cinfo);
     HRESULT hr;
     ULONG bytesread;
 
-    hr = stream_read(This->stream, This->source_buffer, 1024, &bytesread);
+    if (This->stream_data)
+    {
+        if (This->stream_pos >= This->stream_size)
+            return FALSE;
+        This->source_mgr.next_input_byte = This->stream_data + This->stream_pos;
+        This->source_mgr.bytes_in_buffer = This->stream_size - This->stream_pos;
+        This->stream_pos = This->stream_size;
+        return TRUE;
+    }
+
+    hr = stream_seek(This->stream, This->stream_pos, STREAM_SEEK_SET, NULL);
+    if (SUCCEEDED(hr))
+        hr = stream_read(This->stream, This->source_buffer, 1024, &bytesread);
 
     if (FAILED(hr) || bytesread == 0)
     {
@@ -119,6 +143,7 @@ static boolean source_mgr_fill_input_buffer(j_decompress_ptr cinfo)
     }
     else
     {
+        This->stream_pos += bytesread;
         This->source_mgr.next_input_byte = This->source_buffer;
         This->source_mgr.bytes_in_buffer = bytesread;
         return TRUE;
@@ -131,7 +156,7 @@ static void source_mgr_skip_input_data(j_decompress_ptr cinfo, long num_bytes)
 
     if (num_bytes > This->source_mgr.bytes_in_buffer)
     {
-        stream_seek(This->stream, num_bytes - This->source_mgr.bytes_in_buffer, STREAM_SEEK_CUR, NULL);
+        This->stream_pos += num_bytes - This->source_mgr.bytes_in_buffer;
         This->source_mgr.bytes_in_buffer = 0;
     }
     else if (num_bytes > 0)
@@ -145,44 +170,13 @@ static void source_mgr_term_source(j_decompress_ptr cinfo)
 {
 }
 
-static HRESULT CDECL jpeg_decoder_initialize(struct decoder* iface, IStream *stream, struct decoder_stat *st)
+/* Must be called with the error handler jump buffer set up. */
+static HRESULT jpeg_decoder_read_header(struct jpeg_decoder *This)
 {
-    struct jpeg_decoder *This = impl_from_decoder(iface);
     int ret;
-    jmp_buf jmpbuf;
-    UINT data_size, i;
-
-    if (This->cinfo_initialized)
-        return WINCODEC_ERR_WRONGSTATE;
-
-    jpeg_std_error(&This->jerr);
-
-    This->jerr.error_exit = error_exit_fn;
-    This->jerr.emit_message = emit_message_fn;
-
-    This->cinfo.err = &This->jerr;
-
-    This->cinfo.client_data = jmpbuf;
-
-    if (setjmp(jmpbuf))
-        return E_FAIL;
-
-    jpeg_CreateDecompress(&This->cinfo, JPEG_LIB_VERSION, sizeof(struct jpeg_decompress_struct));
-
-    This->cinfo_initialized = TRUE;
-
-    This->stream = stream;
-
-    stream_seek(This->stream, 0, STREAM_SEEK_SET, NULL);
 
+    This->stream_pos = 0;
     This->source_mgr.bytes_in_buffer = 0;
-    This->source_mgr.init_source = source_mgr_init_source;
-    This->source_mgr.fill_input_buffer = source_mgr_fill_input_buffer;
-    This->source_mgr.skip_input_data = source_mgr_skip_input_data;
-    This->source_mgr.resync_to_restart = jpeg_resync_to_restart;
-    This->source_mgr.term_source = source_mgr_term_source;
-
-    This->cinfo.src = &This->source_mgr;
 
     ret = jpeg_read_header(&This->cinfo, TRUE);
 
@@ -191,22 +185,30 @@ static HRESULT CDECL jpeg_decoder_initialize(struct decoder* iface, IStream *str
         return E_FAIL;
     }
 
+    This->need_header = FALSE;
+    return S_OK;
+}
+
+static HRESULT jpeg_decoder_initialize_frame(struct jpeg_decoder *This)
+{
+    UINT i;
+
     switch (This->cinfo.jpeg_color_space)
     {
     case JCS_GRAYSCALE:
-        This->cinfo.out_color_space = JCS_GRAYSCALE;
+        This->out_color_space = JCS_GRAYSCALE;
         This->frame.bpp = 8;
         This->frame.pixel_format = GUID_WICPixelFormat8bppGray;
         break;
     case JCS_RGB:
     case JCS_YCbCr:
-        This->cinfo.out_color_space = JCS_RGB;
+        This->out_color_space = JCS_RGB;
         This->frame.bpp = 24;
         This->frame.pixel_format = GUID_WICPixelFormat24bppBGR;
         break;
     case JCS_CMYK:
     case JCS_YCCK:
-        This->cinfo.out_color_space = JCS_CMYK;
+        This->out_color_space = JCS_CMYK;
         This->frame.bpp = 32;
         This->frame.pixel_format = GUID_WICPixelFormat32bppCMYK;
         break;
@@ -215,14 +217,19 @@ static HRESULT CDECL jpeg_decoder_initialize(struct decoder* iface, IStream *str
         return E_FAIL;
     }
 
-    if (!jpeg_start_decompress(&This->cinfo))
+    This->cinfo.out_color_space = This->out_color_space;
+
+    for (i = 0; i < ARRAY_SIZE(This->scaled_width); i++)
     {
-        ERR("jpeg_start_decompress failed\n");
-        return E_FAIL;
+        This->cinfo.scale_num = 1;
+        This->cinfo.scale_denom = 1 << i;
+        jpeg_calc_output_dimensions(&This->cinfo);
+        This->scaled_width[i] = This->cinfo.output_width;
+        This->scaled_height[i] = This->cinfo.output_height;
     }
 
-    This->frame.width = This->cinfo.output_width;
-    This->frame.height = This->cinfo.output_height;
+    This->frame.width = This->scaled_width[0];
+    This->frame.height = This->scaled_height[0];
 
     switch (This->cinfo.density_unit)
     {
@@ -245,73 +252,306 @@ static HRESULT CDECL jpeg_decoder_initialize(struct decoder* iface, IStream *str
     This->frame.num_color_contexts = 0;
     This->frame.num_colors = 0;
 
-    This->stride = (This->frame.bpp * This->cinfo.output_width + 7) / 8;
-    data_size = This->stride * This->cinfo.output_height;
+    This->stride = (This->frame.bpp * This->frame.width + 7) / 8;
+    if (This->stride / (This->frame.bpp / 8) < This->frame.width)
+        return E_OUTOFMEMORY;
+
+    if (!(This->scanline = malloc(This->stride)))
+        return E_OUTOFMEMORY;
+
+    return S_OK;
+}
+
+static HRESULT CDECL jpeg_decoder_initialize(struct decoder* iface, IStream *stream, struct decoder_stat *st)
+{
+    struct jpeg_decoder *This = impl_from_decoder(iface);
+    jmp_buf jmpbuf;
+    HRESULT hr;
+
+    if (This->cinfo_initialized)
+        return WINCODEC_ERR_WRONGSTATE;
+
+    jpeg_std_error(&This->jerr);
+
+    This->jerr.error_exit = error_exit_fn;
+    This->jerr.emit_message = emit_message_fn;
+
+    This->cinfo.err = &This->jerr;
+
+    This->cinfo.client_data = jmpbuf;
+
+    if (setjmp(jmpbuf))
+        return E_FAIL;
+
+    jpeg_CreateDecompress(&This->cinfo, JPEG_LIB_VERSION, sizeof(struct jpeg_decompress_struct));
+
+    This->cinfo_initialized = TRUE;
+
+    This->stream = stream;
+    if (!stream_get_buffer(stream, &This->stream_data, &This->stream_size))
+        This->stream_data = NULL;
 
-    if (data_size / This->stride < This->cinfo.output_height)
+    This->source_mgr.init_source = source_mgr_init_source;
+    This->source_mgr.fill_input_buffer = source_mgr_fill_input_buffer;
+    This->source_mgr.skip_input_data = source_mgr_skip_input_data;
+    This->source_mgr.resync_to_restart = jpeg_resync_to_restart;
+    This->source_mgr.term_source = source_mgr_term_source;
+
+    This->cinfo.src = &This->source_mgr;
+
+    if (FAILED(hr = jpeg_decoder_read_header(This)))
+        return hr;
+
+    /* Pixel data is decoded on demand in copy_pixels. */
+    if (FAILED(hr = jpeg_decoder_initialize_frame(This)))
+        return hr;
+
+    st->frame_count = 1;
+    st->flags = WICBitmapDecoderCapabilityCanDecodeAllImages |
+                WICBitmapDecoderCapabilityCanDecodeSomeImages |
+                WICBitmapDecoderCapabilityCanEnumerateMetadata |
+                DECODER_FLAGS_SEQUENTIAL |
+                DECODER_FLAGS_UNSUPPORTED_COLOR_CONTEXT;
+    return S_OK;
+}
+
+static HRESULT CDECL jpeg_decoder_get_frame_info(struct decoder* iface, UINT frame, struct decoder_frame *info)
+{
+    struct jpeg_decoder *This = impl_from_decoder(iface);
+    *info = This->frame;
+    return S_OK;
+}
+
+/* Starts a decoding pass with the given IDCT scaling, rewinding the stream
+ * if a pass was already in progress. Must be called with the error handler
+ * jump buffer set up. */
+static HRESULT jpeg_decoder_start(struct jpeg_decoder *This, UINT scale_denom)
+{
+    HRESULT hr;
+
+    if (This->decompressing)
+    {
+        TRACE("Restarting decompression.\n");
+        jpeg_abort_decompress(&This->cinfo);
+        This->decompressing = FALSE;
+        This->need_header = TRUE;
+    }
+
+    if (This->need_header && FAILED(hr = jpeg_decoder_read_header(This)))
+        return hr;
+
+    This->cinfo.out_color_space = This->out_color_space;
+    This->cinfo.scale_num = 1;
+    This->cinfo.scale_denom = scale_denom;
+
+    if (!jpeg_start_decompress(&This->cinfo))
+    {
+        ERR("jpeg_start_decompress failed\n");
+        return E_FAIL;
+    }
+
+    This->decompressing = TRUE;
+    This->scale_denom = scale_denom;
+    return S_OK;
+}
+
+static void jpeg_decoder_convert_row(struct jpeg_decoder *This, BYTE *row, UINT width)
+{
+    UINT i;
+
+    if (This->frame.bpp == 24)
+    {
+        /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
+        reverse_bgr8(3, row, width, 1, 0);
+    }
+
+    if (This->out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
+    {
+        /* Adobe JPEG's have inverted CMYK data. */
+        for (i=0; i<width * 4; i++)
+            row[i] ^= 0xff;
+    }
+}
+
+static HRESULT jpeg_decoder_read_row(struct jpeg_decoder *This, BYTE *row)
+{
+    JSAMPROW out_row = row;
+
+    if (!jpeg_read_scanlines(&This->cinfo, &out_row, 1))
+    {
+        ERR("read_scanlines failed\n");
+        return E_FAIL;
+    }
+    return S_OK;
+}
+
+/* Decodes the whole frame into image_data; used once requests stop being
+ * sequential, so that random access does not restart decoding every time. */
+static HRESULT jpeg_decoder_decode_frame(struct jpeg_decoder *This)
+{
+    UINT data_size, y;
+    HRESULT hr;
+
+    data_size = This->stride * This->frame.height;
+
+    if (data_size / This->stride < This->frame.height)
         /* overflow in multiplication */
         return E_OUTOFMEMORY;
 
-    This->image_data = malloc(data_size);
-    if (!This->image_data)
+    if (FAILED(hr = jpeg_decoder_start(This, 1)))
+        return hr;
+
+    if (!(This->image_data = malloc(data_size)))
         return E_OUTOFMEMORY;
 
-    while (This->cinfo.output_scanline < This->cinfo.output_height)
+    for (y = 0; y < This->frame.height; y++)
     {
-        UINT first_scanline = This->cinfo.output_scanline;
-        UINT max_rows;
-        JSAMPROW out_rows[4];
-        JDIMENSION ret;
+        BYTE *row = This->image_data + This->stride * y;
 
-        max_rows = min(This->cinfo.output_height-first_scanline, 4);
-        for (i=0; i<max_rows; i++)
-            out_rows[i] = This->image_data + This->stride * (first_scanline+i);
+        if (FAILED(hr = jpeg_decoder_read_row(This, row)))
+        {
+            free(This->image_data);
+            This->image_data = NULL;
+            return hr;
+        }
+        jpeg_decoder_convert_row(This, row, This->frame.width);
+    }
+
+    return S_OK;
+}
+
+/* Decodes the rows of prc, continuing the current pass when possible. */
+static HRESULT jpeg_decoder_decode_rows(struct jpeg_decoder *This, UINT scale_denom,
+    const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer)
+{
+    UINT bytesperpixel = This->frame.bpp / 8;
+    UINT bytesperrow = prc->Width * bytesperpixel;
+    jmp_buf jmpbuf;
+    HRESULT hr;
+    UINT y;
 
-        ret = jpeg_read_scanlines(&This->cinfo, out_rows, max_rows);
-        if (ret == 0)
+    This->cinfo.client_data = jmpbuf;
+
+    if (setjmp(jmpbuf))
+    {
+        /* libjpeg state is undefined now, start over next time. */
+        jpeg_abort_decompress(&This->cinfo);
+        This->decompressing = FALSE;
+        This->need_header = TRUE;
+        free(This->image_data);
+        This->image_data = NULL;
+        return E_FAIL;
+    }
+
+    if (scale_denom == 1 && This->image_data)
+        return copy_pixels(This->frame.bpp, This->image_data, This->frame.width, This->frame.height,
+            This->stride, prc, stride, buffersize, buffer);
+
+    if (!This->decompressing || This->scale_denom != scale_denom || This->cinfo.output_scanline > prc->Y)
+    {
+        /* Going back to the top is no more expensive than decoding the whole
+         * frame, otherwise keep the frame around for further random access. */
+        if (scale_denom == 1 && This->decompressing && This->scale_denom == 1 && prc->Y)
         {
-            ERR("read_scanlines failed\n");
-            return E_FAIL;
+            TRACE("Non-sequential access, decoding the whole frame.\n");
+            if (FAILED(hr = jpeg_decoder_decode_frame(This)))
+                return hr;
+            return copy_pixels(This->frame.bpp, This->image_data, This->frame.width, This->frame.height,
+                This->stride, prc, stride, buffersize, buffer);
         }
+
+        if (FAILED(hr = jpeg_decoder_start(This, scale_denom)))
+            return hr;
     }
 
-    if (This->frame.bpp == 24)
+    while (This->cinfo.output_scanline < prc->Y)
     {
-        /* libjpeg gives us RGB data and we want BGR, so byteswap the data */
-        reverse_bgr8(3, This->image_data,
-            This->cinfo.output_width, This->cinfo.output_height,
-            This->stride);
+        if (FAILED(hr = jpeg_decoder_read_row(This, This->scanline)))
+            return hr;
     }
 
-    if (This->cinfo.out_color_space == JCS_CMYK && This->cinfo.saw_Adobe_marker)
+    for (y = 0; y < prc->Height; y++)
     {
-        /* Adobe JPEG's have inverted CMYK data. */
-        for (i=0; i<data_size; i++)
-            This->image_data[i] ^= 0xff;
+        BYTE *row = buffer + stride * y;
+
+        if (prc->X == 0 && prc->Width == This->cinfo.output_width)
+        {
+            if (FAILED(hr = jpeg_decoder_read_row(This, row)))
+                return hr;
+        }
+        else
+        {
+            if (FAILED(hr = jpeg_decoder_read_row(This, This->scanline)))
+                return hr;
+            memcpy(row, This->scanline + prc->X * bytesperpixel, bytesperrow);
+        }
+        jpeg_decoder_convert_row(This, row, prc->Width);
     }
 
-    st->frame_count = 1;
-    st->flags = WICBitmapDecoderCapabilityCanDecodeAllImages |
-                WICBitmapDecoderCapabilityCanDecodeSomeImages |
-                WICBitmapDecoderCapabilityCanEnumerateMetadata |
-                DECODER_FLAGS_UNSUPPORTED_COLOR_CONTEXT;
     return S_OK;
 }
 
-static HRESULT CDECL jpeg_decoder_get_frame_info(struct decoder* iface, UINT frame, struct decoder_frame *info)
+static HRESULT CDECL jpeg_decoder_copy_pixels(struct decoder* iface, UINT frame,
+    const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer)
 {
     struct jpeg_decoder *This = impl_from_decoder(iface);
-    *info = This->frame;
+    WICRect rect;
+
+    if (!prc)
+    {
+        rect.X = 0;
+        rect.Y = 0;
+        rect.Width = This->frame.width;
+        rect.Height = This->frame.height;
+        prc = &rect;
+    }
+
+    return jpeg_decoder_decode_rows(This, 1, prc, stride, buffersize, buffer);
+}
+
+/* libjpeg can scale the IDCT by 1/2, 1/4 and 1/8, which is much cheaper
+ * than decoding the full size image. */
+static HRESULT CDECL jpeg_decoder_get_closest_size(struct decoder* iface, UINT frame, UINT *width, UINT *height)
+{
+    struct jpeg_decoder *This = impl_from_decoder(iface);
+    UINT i;
+
+    for (i = ARRAY_SIZE(This->scaled_width) - 1; i > 0; i--)
+    {
+        if (This->scaled_width[i] >= *width && This->scaled_height[i] >= *height)
+            break;
+    }
+
+    *width = This->scaled_width[i];
+    *height = This->scaled_height[i];
     return S_OK;
 }
 
-static HRESULT CDECL jpeg_decoder_copy_pixels(struct decoder* iface, UINT frame,
+static HRESULT CDECL jpeg_decoder_copy_pixels_scaled(struct decoder* iface, UINT frame, UINT width, UINT height,
     const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer)
 {
     struct jpeg_decoder *This = impl_from_decoder(iface);
-    return copy_pixels(This->frame.bpp, This->image_data,
-        This->frame.width, This->frame.height, This->stride,
-        prc, stride, buffersize, buffer);
+    WICRect rect;
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(This->scaled_width); i++)
+    {
+        if (This->scaled_width[i] == width && This->scaled_height[i] == height)
+            break;
+    }
+    if (i == ARRAY_SIZE(This->scaled_width))
+        return E_INVALIDARG;
+
+    if (!prc)
+    {
+        rect.X = 0;
+        rect.Y = 0;
+        rect.Width = width;
+        rect.Height = height;
+        prc = &rect;
+    }
+
+    return jpeg_decoder_decode_rows(This, 1 << i, prc, stride, buffersize, buffer);
 }
 
 static HRESULT CDECL jpeg_decoder_get_metadata_blocks(struct decoder* iface, UINT frame,
@@ -337,7 +577,9 @@ static const struct decoder_funcs jpeg_decoder_vtable = {
     jpeg_decoder_copy_pixels,
     jpeg_decoder_get_metadata_blocks,
     jpeg_decoder_get_color_context,
-    jpeg_decoder_destroy
+    jpeg_decoder_destroy,
+    jpeg_decoder_get_closest_size,
+    jpeg_decoder_copy_pixels_scaled,
 };
 
 HRESULT CDECL jpeg_decoder_create(struct decoder_info *info, struct decoder **result)
@@ -349,8 +591,12 @@ HRESULT CDECL jpeg_decoder_create(struct decoder_info *info, struct decoder **re
 
     This->decoder.vtable = &jpeg_decoder_vtable;
     This->cinfo_initialized = FALSE;
+    This->decompressing = FALSE;
+    This->need_header = FALSE;
     This->stream = NULL;
+    This->stream_data = NULL;
     This->image_data = NULL;
+    This->scanline = NULL;
     *result = &This->decoder;
 
     info->container_format = GUID_ContainerFormatJpeg;
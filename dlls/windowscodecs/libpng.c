@@ -19,6 +19,7 @@
 
 #include <stdarg.h>
 #include <png.h>
+#include <zlib.h>
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -37,9 +38,15 @@ struct png_decoder
 {
     struct decoder decoder;
     IStream *stream;
+    ULONGLONG stream_pos;
+    png_structp png_ptr;
+    png_infop info_ptr;
+    BOOL interlaced;
     struct decoder_frame decoder_frame;
     UINT stride;
-    BYTE *image_bits;
+    UINT next_row; /* next row returned by png_read_row() */
+    BYTE *image_bits; /* whole frame, only decoded for interlaced images or after non-sequential access */
+    BYTE *scanline;
     BYTE *color_profile;
     DWORD color_profile_len;
 };
@@ -49,22 +56,28 @@ static inline struct png_decoder *impl_from_decoder(struct decoder* iface)
     return CONTAINING_RECORD(iface, struct png_decoder, decoder);
 }
 
+/* Rows are decoded lazily, and the stream may be used by others (e.g. the
+ * metadata readers) in the meantime, so always read from our own position. */
 static void user_read_data(png_structp png_ptr, png_bytep data, png_size_t length)
 {
-    IStream *stream = png_get_io_ptr(png_ptr);
+    struct png_decoder *This = png_get_io_ptr(png_ptr);
     HRESULT hr;
     ULONG bytesread;
 
-    hr = stream_read(stream, data, length, &bytesread);
+    hr = stream_seek(This->stream, This->stream_pos, STREAM_SEEK_SET, NULL);
+    if (SUCCEEDED(hr))
+        hr = stream_read(This->stream, data, length, &bytesread);
     if (FAILED(hr) || bytesread != length)
     {
         png_error(png_ptr, "failed reading data");
     }
+    This->stream_pos += bytesread;
 }
 
-static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stream, struct decoder_stat *st)
+/* Reads the header, which also has to be done to start decoding over from
+ * the top; libpng can't rewind. */
+static HRESULT png_decoder_read_header(struct png_decoder *This)
 {
-    struct png_decoder *This = impl_from_decoder(iface);
     png_structp png_ptr;
     png_infop info_ptr;
     HRESULT hr = E_FAIL;
@@ -78,13 +91,14 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     png_colorp png_palette;
     int num_palette;
     int i;
-    UINT image_size;
-    png_bytep *row_pointers=NULL;
     png_charp cp_name;
     png_bytep cp_profile;
     png_uint_32 cp_len;
     int cp_compression;
 
+    if (This->png_ptr)
+        png_destroy_read_struct(&This->png_ptr, &This->info_ptr, NULL);
+
     png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
     if (!png_ptr)
     {
@@ -107,15 +121,12 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     png_set_crc_action(png_ptr, PNG_CRC_QUIET_USE, PNG_CRC_QUIET_USE);
     png_set_chunk_malloc_max(png_ptr, 0);
 
-    /* seek to the start of the stream */
-    hr = stream_seek(stream, 0, STREAM_SEEK_SET, NULL);
-    if (FAILED(hr))
-    {
-        goto end;
-    }
+    /* start reading at the beginning of the stream */
+    This->stream_pos = 0;
+    This->next_row = 0;
 
     /* set up custom i/o handling */
-    png_set_read_fn(png_ptr, stream, user_read_data);
+    png_set_read_fn(png_ptr, This, user_read_data);
 
     /* read the header */
     png_read_info(png_ptr, info_ptr);
@@ -220,6 +231,7 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
 
     This->decoder_frame.width = png_get_image_width(png_ptr, info_ptr);
     This->decoder_frame.height = png_get_image_height(png_ptr, info_ptr);
+    This->interlaced = png_get_interlace_type(png_ptr, info_ptr) != PNG_INTERLACE_NONE;
 
     ret = png_get_pHYs(png_ptr, info_ptr, &xres, &yres, &unit_type);
 
@@ -238,14 +250,17 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     if (ret)
     {
         This->decoder_frame.num_color_contexts = 1;
-        This->color_profile_len = cp_len;
-        This->color_profile = malloc(cp_len);
         if (!This->color_profile)
         {
-            hr = E_OUTOFMEMORY;
-            goto end;
+            This->color_profile_len = cp_len;
+            This->color_profile = malloc(cp_len);
+            if (!This->color_profile)
+            {
+                hr = E_OUTOFMEMORY;
+                goto end;
+            }
+            memcpy(This->color_profile, cp_profile, cp_len);
         }
-        memcpy(This->color_profile, cp_profile, cp_len);
     }
     else
         This->decoder_frame.num_color_contexts = 0;
@@ -294,58 +309,139 @@ static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stre
     }
 
     This->stride = (This->decoder_frame.width * This->decoder_frame.bpp + 7) / 8;
+
+    This->png_ptr = png_ptr;
+    This->info_ptr = info_ptr;
+    return S_OK;
+
+end:
+    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+    return hr;
+}
+
+static HRESULT CDECL png_decoder_initialize(struct decoder *iface, IStream *stream, struct decoder_stat *st)
+{
+    struct png_decoder *This = impl_from_decoder(iface);
+    HRESULT hr;
+
+    This->stream = stream;
+
+    hr = png_decoder_read_header(This);
+    if (FAILED(hr))
+    {
+        This->stream = NULL;
+        return hr;
+    }
+
+    This->scanline = malloc(This->stride);
+    if (!This->scanline)
+    {
+        png_destroy_read_struct(&This->png_ptr, &This->info_ptr, NULL);
+        This->stream = NULL;
+        return E_OUTOFMEMORY;
+    }
+
+    st->flags = WICBitmapDecoderCapabilityCanDecodeAllImages |
+                WICBitmapDecoderCapabilityCanDecodeSomeImages |
+                WICBitmapDecoderCapabilityCanEnumerateMetadata |
+                DECODER_FLAGS_SEQUENTIAL;
+    st->frame_count = 1;
+
+    return S_OK;
+}
+
+static HRESULT CDECL png_decoder_get_frame_info(struct decoder *iface, UINT frame, struct decoder_frame *info)
+{
+    struct png_decoder *This = impl_from_decoder(iface);
+    *info = This->decoder_frame;
+    return S_OK;
+}
+
+/* Decodes the whole frame into image_bits; used for interlaced images and
+ * once requests stop being sequential, so that random access does not
+ * restart decoding every time. */
+static HRESULT png_decoder_decode_frame(struct png_decoder *This)
+{
+    png_bytep *row_pointers;
+    UINT image_size, i;
+
     image_size = This->stride * This->decoder_frame.height;
+    if (image_size / This->stride < This->decoder_frame.height)
+        /* overflow in multiplication */
+        return E_OUTOFMEMORY;
 
     This->image_bits = malloc(image_size);
-    if (!This->image_bits)
+    row_pointers = malloc(sizeof(png_bytep) * This->decoder_frame.height);
+    if (!This->image_bits || !row_pointers)
     {
-        hr = E_OUTOFMEMORY;
-        goto end;
+        free(This->image_bits);
+        This->image_bits = NULL;
+        free(row_pointers);
+        return E_OUTOFMEMORY;
     }
 
-    row_pointers = malloc(sizeof(png_bytep)*This->decoder_frame.height);
-    if (!row_pointers)
+    /* set up setjmp/longjmp error handling */
+    if (setjmp(png_jmpbuf(This->png_ptr)))
     {
-        hr = E_OUTOFMEMORY;
-        goto end;
+        /* libpng state is undefined now, start over next time. */
+        png_destroy_read_struct(&This->png_ptr, &This->info_ptr, NULL);
+        free(This->image_bits);
+        This->image_bits = NULL;
+        free(row_pointers);
+        return E_FAIL;
     }
 
-    for (i=0; i<This->decoder_frame.height; i++)
+    for (i = 0; i < This->decoder_frame.height; i++)
         row_pointers[i] = This->image_bits + i * This->stride;
 
-    png_read_image(png_ptr, row_pointers);
+    png_read_image(This->png_ptr, row_pointers);
 
     free(row_pointers);
-    row_pointers = NULL;
 
     /* png_read_end intentionally not called to not seek to the end of the file */
+    png_destroy_read_struct(&This->png_ptr, &This->info_ptr, NULL);
 
-    st->flags = WICBitmapDecoderCapabilityCanDecodeAllImages |
-                WICBitmapDecoderCapabilityCanDecodeSomeImages |
-                WICBitmapDecoderCapabilityCanEnumerateMetadata;
-    st->frame_count = 1;
+    return S_OK;
+}
 
-    This->stream = stream;
+/* Decodes the rows of prc, continuing from the current row. */
+static HRESULT png_decoder_decode_rows(struct png_decoder *This, const WICRect *prc,
+    UINT stride, UINT buffersize, BYTE *buffer)
+{
+    WICRect rect = { prc->X, 0, prc->Width, 1 };
+    BYTE *row;
+    HRESULT hr;
+    UINT y;
 
-    hr = S_OK;
+    /* set up setjmp/longjmp error handling */
+    if (setjmp(png_jmpbuf(This->png_ptr)))
+    {
+        /* libpng state is undefined now, start over next time. */
+        png_destroy_read_struct(&This->png_ptr, &This->info_ptr, NULL);
+        return E_FAIL;
+    }
 
-end:
-    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
-    free(row_pointers);
-    if (FAILED(hr))
+    for (; This->next_row < prc->Y; This->next_row++)
+        png_read_row(This->png_ptr, This->scanline, NULL);
+
+    for (y = 0; y < prc->Height; y++, This->next_row++)
     {
-        free(This->image_bits);
-        This->image_bits = NULL;
-        free(This->color_profile);
-        This->color_profile = NULL;
+        row = buffer + stride * y;
+
+        if (prc->X == 0 && prc->Width == This->decoder_frame.width)
+        {
+            png_read_row(This->png_ptr, row, NULL);
+            continue;
+        }
+
+        png_read_row(This->png_ptr, This->scanline, NULL);
+
+        hr = copy_pixels(This->decoder_frame.bpp, This->scanline, This->decoder_frame.width, 1,
+            This->stride, &rect, stride, buffersize - stride * y, row);
+        if (FAILED(hr))
+            return hr;
     }
-    return hr;
-}
 
-static HRESULT CDECL png_decoder_get_frame_info(struct decoder *iface, UINT frame, struct decoder_frame *info)
-{
-    struct png_decoder *This = impl_from_decoder(iface);
-    *info = This->decoder_frame;
     return S_OK;
 }
 
@@ -353,6 +449,38 @@ static HRESULT CDECL png_decoder_copy_pixels(struct decoder *iface, UINT frame,
     const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer)
 {
     struct png_decoder *This = impl_from_decoder(iface);
+    BOOL whole_frame;
+    WICRect rect;
+    HRESULT hr;
+
+    if (!prc)
+    {
+        rect.X = 0;
+        rect.Y = 0;
+        rect.Width = This->decoder_frame.width;
+        rect.Height = This->decoder_frame.height;
+        prc = &rect;
+    }
+
+    if (!This->image_bits)
+    {
+        /* Going back to the top is no more expensive than decoding the whole
+         * frame, otherwise keep the frame around for further random access. */
+        whole_frame = This->interlaced || (prc->Y < This->next_row && prc->Y);
+
+        if (!This->png_ptr || This->next_row > (whole_frame ? 0 : prc->Y))
+        {
+            if (FAILED(hr = png_decoder_read_header(This)))
+                return hr;
+        }
+
+        if (!whole_frame)
+            return png_decoder_decode_rows(This, prc, stride, buffersize, buffer);
+
+        TRACE("Decoding the whole frame.\n");
+        if (FAILED(hr = png_decoder_decode_frame(This)))
+            return hr;
+    }
 
     return copy_pixels(This->decoder_frame.bpp, This->image_bits,
         This->decoder_frame.width, This->decoder_frame.height, This->stride,
@@ -451,7 +579,10 @@ static void CDECL png_decoder_destroy(struct decoder* iface)
 {
     struct png_decoder *This = impl_from_decoder(iface);
 
+    if (This->png_ptr)
+        png_destroy_read_struct(&This->png_ptr, &This->info_ptr, NULL);
     free(This->image_bits);
+    free(This->scanline);
     free(This->color_profile);
     free(This);
 }
@@ -477,7 +608,11 @@ HRESULT CDECL png_decoder_create(struct decoder_info *info, struct decoder **res
     }
 
     This->decoder.vtable = &png_decoder_vtable;
+    This->png_ptr = NULL;
+    This->info_ptr = NULL;
+    This->next_row = 0;
     This->image_bits = NULL;
+    This->scanline = NULL;
     This->color_profile = NULL;
     *result = &This->decoder;
 
@@ -515,6 +650,22 @@ static const struct png_pixelformat formats[] = {
     {NULL},
 };
 
+/* Non-interlaced frames are filtered and deflated by us rather than libpng,
+ * so that the image data can be compressed in parallel: it is split into
+ * segments that are deflated independently, each primed with the tail of the
+ * previous one, and concatenated into a single zlib stream. */
+#define PNG_SEGMENT_SIZE (128 * 1024)
+#define PNG_BATCH_SIZE (32 * PNG_SEGMENT_SIZE)
+#define PNG_WINDOW_SIZE 32768
+/* more than deflateBound() plus the sync flush marker */
+#define PNG_SEGMENT_BOUND (PNG_SEGMENT_SIZE + PNG_SEGMENT_SIZE / 256)
+
+struct png_segment
+{
+    ULONG size;
+    uLong adler;
+};
+
 struct png_encoder
 {
     struct encoder encoder;
@@ -527,6 +678,20 @@ struct png_encoder
     UINT stride;
     UINT passes;
     UINT lines_written;
+    int filters; /* PNG_FILTER_* mask */
+    UINT pixel_size; /* in bytes, rounded up */
+    UINT row_size; /* packed row, without the filter type byte */
+    UINT batch_rows;
+    UINT pending_rows;
+    BYTE *batch; /* packed rows waiting to be compressed */
+    BYTE *prev_row; /* last packed row of the previous batch */
+    BYTE *filtered; /* filtered rows of the batch */
+    struct png_segment *segments;
+    BYTE *segment_data;
+    BYTE *window; /* the last filtered bytes of the previous batch */
+    UINT window_size;
+    uLong adler;
+    BOOL idat_written;
 };
 
 static inline struct png_encoder *impl_from_encoder(struct encoder* iface)
@@ -607,8 +772,340 @@ static HRESULT CDECL png_encoder_get_supported_format(struct encoder* iface, GUI
     return S_OK;
 }
 
+/* Converts a row to the byte order of the PNG file. */
+static void png_encoder_pack_row(struct png_encoder *This, BYTE *dst, const BYTE *src)
+{
+    UINT i, width = This->encoder_frame.width;
+
+    if (This->format->remove_filler)
+    {
+        for (i = 0; i < width; i++, src += 4, dst += 3)
+        {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+        }
+    }
+    else if (This->format->swap_rgb)
+    {
+        UINT pixel_size = This->pixel_size;
+
+        for (i = 0; i < width; i++, src += pixel_size, dst += pixel_size)
+        {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+            if (pixel_size == 4)
+                dst[3] = src[3];
+        }
+    }
+    else if (This->format->bit_depth > 8)
+    {
+        for (i = 0; i < This->row_size; i += 2)
+        {
+            dst[i] = src[i + 1];
+            dst[i + 1] = src[i];
+        }
+    }
+    else
+        memcpy(dst, src, This->row_size);
+}
+
+static inline BYTE paeth_predictor(BYTE a, BYTE b, BYTE c)
+{
+    int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+
+    if (pa <= pb && pa <= pc)
+        return a;
+    if (pb <= pc)
+        return b;
+    return c;
+}
+
+static void filter_row(int type, BYTE *dst, const BYTE *row, const BYTE *prev, UINT size, UINT bpp)
+{
+    UINT i;
+
+    switch (type)
+    {
+    case PNG_FILTER_VALUE_NONE:
+        memcpy(dst, row, size);
+        break;
+    case PNG_FILTER_VALUE_SUB:
+        for (i = 0; i < bpp; i++)
+            dst[i] = row[i];
+        for (; i < size; i++)
+            dst[i] = row[i] - row[i - bpp];
+        break;
+    case PNG_FILTER_VALUE_UP:
+        for (i = 0; i < size; i++)
+            dst[i] = row[i] - prev[i];
+        break;
+    case PNG_FILTER_VALUE_AVG:
+        for (i = 0; i < bpp; i++)
+            dst[i] = row[i] - (prev[i] >> 1);
+        for (; i < size; i++)
+            dst[i] = row[i] - ((row[i - bpp] + prev[i]) >> 1);
+        break;
+    case PNG_FILTER_VALUE_PAETH:
+        for (i = 0; i < bpp; i++)
+            dst[i] = row[i] - prev[i];
+        for (; i < size; i++)
+            dst[i] = row[i] - paeth_predictor(row[i - bpp], prev[i], prev[i - bpp]);
+        break;
+    }
+}
+
+static UINT filtered_row_cost(const BYTE *row, UINT size)
+{
+    UINT i, cost = 0;
+
+    for (i = 0; i < size; i++)
+        cost += row[i] < 128 ? row[i] : 256 - row[i];
+    return cost;
+}
+
+/* Picks the filter type like libpng does, by the minimum sum of absolute
+ * differences, if more than one is allowed. */
+static void png_encoder_filter_row(struct png_encoder *This, BYTE *dst, const BYTE *row,
+    const BYTE *prev, BYTE *scratch)
+{
+    BYTE *best = scratch, *candidate = scratch + This->row_size, *tmp;
+    UINT cost, best_cost = ~0u;
+    int type, best_type = -1;
+
+    for (type = PNG_FILTER_VALUE_NONE; type < PNG_FILTER_VALUE_LAST; type++)
+    {
+        if (!(This->filters & (PNG_FILTER_NONE << type)))
+            continue;
+
+        if (This->filters == (PNG_FILTER_NONE << type))
+        {
+            dst[0] = type;
+            filter_row(type, dst + 1, row, prev, This->row_size, This->pixel_size);
+            return;
+        }
+
+        filter_row(type, candidate, row, prev, This->row_size, This->pixel_size);
+        cost = filtered_row_cost(candidate, This->row_size);
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best_type = type;
+            tmp = best;
+            best = candidate;
+            candidate = tmp;
+        }
+    }
+
+    dst[0] = best_type;
+    memcpy(dst + 1, best, This->row_size);
+}
+
+static HRESULT png_encoder_filter_rows(void *context, UINT y, UINT height)
+{
+    struct png_encoder *This = context;
+    const BYTE *prev;
+    BYTE *scratch;
+    UINT i;
+
+    if (!(scratch = malloc(This->row_size * 2)))
+        return E_OUTOFMEMORY;
+
+    for (i = y; i < y + height; i++)
+    {
+        prev = i ? This->batch + (i - 1) * This->row_size : This->prev_row;
+        png_encoder_filter_row(This, This->filtered + i * (This->row_size + 1),
+            This->batch + i * This->row_size, prev, scratch);
+    }
+
+    free(scratch);
+    return S_OK;
+}
+
+struct png_batch
+{
+    struct png_encoder *encoder;
+    UINT size;
+    UINT segment_count;
+    BOOL last;
+};
+
+static void *zalloc(void *opaque, unsigned int items, unsigned int size)
+{
+    return malloc(items * size);
+}
+
+static void zfree(void *opaque, void *ptr)
+{
+    free(ptr);
+}
+
+static HRESULT png_encoder_deflate_segments(void *context, UINT first, UINT count)
+{
+    struct png_batch *batch = context;
+    struct png_encoder *This = batch->encoder;
+    struct png_segment *segment;
+    UINT i, offset, size;
+    z_stream strm;
+    int flush, ret;
+
+    for (i = first; i < first + count; i++)
+    {
+        segment = &This->segments[i];
+        offset = i * PNG_SEGMENT_SIZE;
+        size = min(PNG_SEGMENT_SIZE, batch->size - offset);
+        flush = (batch->last && i == batch->segment_count - 1) ? Z_FINISH : Z_SYNC_FLUSH;
+
+        memset(&strm, 0, sizeof(strm));
+        strm.zalloc = zalloc;
+        strm.zfree = zfree;
+        /* same strategy as libpng */
+        if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                This->filters == PNG_FILTER_NONE ? Z_DEFAULT_STRATEGY : Z_FILTERED) != Z_OK)
+            return E_OUTOFMEMORY;
+
+        if (offset)
+            ret = deflateSetDictionary(&strm, This->filtered + offset - PNG_WINDOW_SIZE, PNG_WINDOW_SIZE);
+        else if (This->window_size)
+            ret = deflateSetDictionary(&strm, This->window, This->window_size);
+        else
+            ret = Z_OK;
+
+        if (ret == Z_OK)
+        {
+            strm.next_in = This->filtered + offset;
+            strm.avail_in = size;
+            strm.next_out = This->segment_data + i * PNG_SEGMENT_BOUND;
+            strm.avail_out = PNG_SEGMENT_BOUND;
+            ret = deflate(&strm, flush);
+        }
+        segment->size = PNG_SEGMENT_BOUND - strm.avail_out;
+        deflateEnd(&strm);
+
+        if (flush == Z_FINISH ? ret != Z_STREAM_END : (ret != Z_OK || strm.avail_in || !strm.avail_out))
+        {
+            ERR("deflate failed, ret %d.\n", ret);
+            return E_FAIL;
+        }
+
+        segment->adler = adler32(adler32(0, NULL, 0), This->filtered + offset, size);
+    }
+
+    return S_OK;
+}
+
+/* Compresses the pending rows and writes them out as IDAT chunks, one for
+ * each segment. */
+static HRESULT png_encoder_flush_batch(struct png_encoder *This, BOOL last)
+{
+    UINT filtered_size = This->row_size + 1, i, keep;
+    struct png_segment *segment;
+    struct png_batch batch;
+    BYTE header[2], trailer[4];
+    BOOL first, final;
+    HRESULT hr;
+
+    batch.encoder = This;
+    batch.size = This->pending_rows * filtered_size;
+    batch.segment_count = (batch.size + PNG_SEGMENT_SIZE - 1) / PNG_SEGMENT_SIZE;
+    batch.last = last;
+
+    hr = process_bands(filtered_size, This->pending_rows, png_encoder_filter_rows, This);
+    if (SUCCEEDED(hr))
+        hr = process_bands(PNG_SEGMENT_SIZE, batch.segment_count, png_encoder_deflate_segments, &batch);
+    if (FAILED(hr))
+        return hr;
+
+    /* zlib header, the same as deflateInit() writes for the default level */
+    header[0] = 0x78;
+    header[1] = 0x9c;
+
+    for (i = 0; i < batch.segment_count; i++)
+    {
+        segment = &This->segments[i];
+        first = !This->idat_written;
+        final = last && i == batch.segment_count - 1;
+
+        This->adler = adler32_combine(This->adler, segment->adler,
+            min(PNG_SEGMENT_SIZE, batch.size - i * PNG_SEGMENT_SIZE));
+
+        png_write_chunk_start(This->png_ptr, (png_const_bytep)"IDAT",
+            segment->size + (first ? sizeof(header) : 0) + (final ? sizeof(trailer) : 0));
+        if (first)
+            png_write_chunk_data(This->png_ptr, header, sizeof(header));
+        png_write_chunk_data(This->png_ptr, This->segment_data + i * PNG_SEGMENT_BOUND, segment->size);
+        if (final)
+        {
+            png_save_uint_32(trailer, This->adler);
+            png_write_chunk_data(This->png_ptr, trailer, sizeof(trailer));
+        }
+        png_write_chunk_end(This->png_ptr);
+
+        This->idat_written = TRUE;
+    }
+
+    /* keep the window for priming the first segment of the next batch */
+    if (batch.size >= PNG_WINDOW_SIZE)
+    {
+        memcpy(This->window, This->filtered + batch.size - PNG_WINDOW_SIZE, PNG_WINDOW_SIZE);
+        This->window_size = PNG_WINDOW_SIZE;
+    }
+    else
+    {
+        keep = min(This->window_size, PNG_WINDOW_SIZE - batch.size);
+        memmove(This->window, This->window + This->window_size - keep, keep);
+        memcpy(This->window + keep, This->filtered, batch.size);
+        This->window_size = keep + batch.size;
+    }
+
+    memcpy(This->prev_row, This->batch + (This->pending_rows - 1) * This->row_size, This->row_size);
+    This->pending_rows = 0;
+
+    return S_OK;
+}
+
+static HRESULT png_encoder_init_batch(struct png_encoder *This)
+{
+    UINT bits = This->format->remove_filler ? 24 : This->format->bpp;
+    UINT segment_count;
+
+    This->pixel_size = max(bits / 8, 1);
+    This->row_size = (bits * This->encoder_frame.width + 7) / 8;
+    This->batch_rows = min(max(PNG_BATCH_SIZE / (This->row_size + 1), 1), This->encoder_frame.height);
+    This->pending_rows = 0;
+    This->window_size = 0;
+    This->adler = adler32(0, NULL, 0);
+    This->idat_written = FALSE;
+
+    segment_count = ((ULONGLONG)This->batch_rows * (This->row_size + 1) + PNG_SEGMENT_SIZE - 1) / PNG_SEGMENT_SIZE;
+
+    This->batch = malloc((SIZE_T)This->batch_rows * This->row_size);
+    This->prev_row = calloc(1, This->row_size);
+    This->filtered = malloc((SIZE_T)This->batch_rows * (This->row_size + 1));
+    This->segments = calloc(segment_count, sizeof(*This->segments));
+    This->segment_data = malloc((SIZE_T)segment_count * PNG_SEGMENT_BOUND);
+    This->window = malloc(PNG_WINDOW_SIZE);
+
+    if (!This->batch || !This->prev_row || !This->filtered || !This->segments ||
+        !This->segment_data || !This->window)
+        return E_OUTOFMEMORY;
+
+    return S_OK;
+}
+
 static HRESULT CDECL png_encoder_create_frame(struct encoder *encoder, const struct encoder_frame *encoder_frame)
 {
+    static const int png_filter_map[] =
+    {
+        /* WICPngFilterUnspecified */ PNG_NO_FILTERS,
+        /* WICPngFilterNone */        PNG_FILTER_NONE,
+        /* WICPngFilterSub */         PNG_FILTER_SUB,
+        /* WICPngFilterUp */          PNG_FILTER_UP,
+        /* WICPngFilterAverage */     PNG_FILTER_AVG,
+        /* WICPngFilterPaeth */       PNG_FILTER_PAETH,
+        /* WICPngFilterAdaptive */    PNG_ALL_FILTERS,
+    };
     struct png_encoder *This = impl_from_encoder(encoder);
     int i;
 
@@ -643,10 +1140,6 @@ static HRESULT CDECL png_encoder_create_frame(struct encoder *encoder, const str
             return E_OUTOFMEMORY;
     }
 
-    /* Tell PNG we need to byte swap if writing a >8-bpp image */
-    if (This->format->bit_depth > 8)
-        png_set_swap(This->png_ptr);
-
     png_set_IHDR(This->png_ptr, This->info_ptr, encoder_frame->width, encoder_frame->height,
         This->format->bit_depth, This->format->color_type,
         encoder_frame->interlace ? PNG_INTERLACE_ADAM7 : PNG_INTERLACE_NONE,
@@ -687,30 +1180,31 @@ static HRESULT CDECL png_encoder_create_frame(struct encoder *encoder, const str
 
     png_write_info(This->png_ptr, This->info_ptr);
 
+    if (encoder_frame->filter != WICPngFilterUnspecified)
+        This->filters = png_filter_map[encoder_frame->filter];
+    else if (This->format->color_type == PNG_COLOR_TYPE_PALETTE || This->format->bit_depth < 8)
+        This->filters = PNG_FILTER_NONE;
+    else
+        This->filters = PNG_ALL_FILTERS;
+
+    if (!encoder_frame->interlace)
+        return png_encoder_init_batch(This);
+
+    /* Tell PNG we need to byte swap if writing a >8-bpp image; this only
+     * has an effect once the bit depth is known, after png_write_info(). */
+    if (This->format->bit_depth > 8)
+        png_set_swap(This->png_ptr);
+
     if (This->format->remove_filler)
         png_set_filler(This->png_ptr, 0, PNG_FILLER_AFTER);
 
     if (This->format->swap_rgb)
         png_set_bgr(This->png_ptr);
 
-    if (encoder_frame->interlace)
-        This->passes = png_set_interlace_handling(This->png_ptr);
+    This->passes = png_set_interlace_handling(This->png_ptr);
 
     if (encoder_frame->filter != WICPngFilterUnspecified)
-    {
-        static const int png_filter_map[] =
-        {
-            /* WICPngFilterUnspecified */ PNG_NO_FILTERS,
-            /* WICPngFilterNone */        PNG_FILTER_NONE,
-            /* WICPngFilterSub */         PNG_FILTER_SUB,
-            /* WICPngFilterUp */          PNG_FILTER_UP,
-            /* WICPngFilterAverage */     PNG_FILTER_AVG,
-            /* WICPngFilterPaeth */       PNG_FILTER_PAETH,
-            /* WICPngFilterAdaptive */    PNG_ALL_FILTERS,
-        };
-
-        png_set_filter(This->png_ptr, 0, png_filter_map[encoder_frame->filter]);
-    }
+        png_set_filter(This->png_ptr, 0, This->filters);
 
     return S_OK;
 }
@@ -718,7 +1212,7 @@ static HRESULT CDECL png_encoder_create_frame(struct encoder *encoder, const str
 static HRESULT CDECL png_encoder_write_lines(struct encoder* encoder, BYTE *data, DWORD line_count, DWORD stride)
 {
     struct png_encoder *This = impl_from_encoder(encoder);
-    png_byte **row_pointers=NULL;
+    HRESULT hr;
     UINT i;
 
     if (This->encoder_frame.interlace)
@@ -736,22 +1230,21 @@ static HRESULT CDECL png_encoder_write_lines(struct encoder* encoder, BYTE *data
 
     /* set up setjmp/longjmp error handling */
     if (setjmp(png_jmpbuf(This->png_ptr)))
-    {
-        free(row_pointers);
         return E_FAIL;
-    }
-
-    row_pointers = malloc(line_count * sizeof(png_byte*));
-    if (!row_pointers)
-        return E_OUTOFMEMORY;
 
     for (i=0; i<line_count; i++)
-        row_pointers[i] = data + stride * i;
-
-    png_write_rows(This->png_ptr, row_pointers, line_count);
-    This->lines_written += line_count;
+    {
+        png_encoder_pack_row(This, This->batch + This->pending_rows * This->row_size, data + stride * i);
+        This->pending_rows++;
+        This->lines_written++;
 
-    free(row_pointers);
+        if (This->pending_rows == This->batch_rows || This->lines_written == This->encoder_frame.height)
+        {
+            hr = png_encoder_flush_batch(This, This->lines_written == This->encoder_frame.height);
+            if (FAILED(hr))
+                return hr;
+        }
+    }
 
     return S_OK;
 }
@@ -781,9 +1274,14 @@ static HRESULT CDECL png_encoder_commit_frame(struct encoder *encoder)
 
         for (i=0; i<This->passes; i++)
             png_write_rows(This->png_ptr, row_pointers, This->encoder_frame.height);
-    }
 
-    png_write_end(This->png_ptr, This->info_ptr);
+        png_write_end(This->png_ptr, This->info_ptr);
+    }
+    else
+    {
+        /* libpng doesn't know about the IDAT chunks we wrote */
+        png_write_chunk(This->png_ptr, (png_const_bytep)"IEND", NULL, 0);
+    }
 
     free(row_pointers);
 
@@ -801,6 +1299,12 @@ static void CDECL png_encoder_destroy(struct encoder *encoder)
     if (This->png_ptr)
         png_destroy_write_struct(&This->png_ptr, &This->info_ptr);
     free(This->data);
+    free(This->batch);
+    free(This->prev_row);
+    free(This->filtered);
+    free(This->segments);
+    free(This->segment_data);
+    free(This->window);
     free(This);
 }
 
@@ -829,6 +1333,12 @@ HRESULT CDECL png_encoder_create(struct encoder_info *info, struct encoder **res
     This->png_ptr = NULL;
     This->info_ptr = NULL;
     This->data = NULL;
+    This->batch = NULL;
+    This->prev_row = NULL;
+    This->filtered = NULL;
+    This->segments = NULL;
+    This->segment_data = NULL;
+    This->window = NULL;
     *result = &This->encoder;
 
     info->flags = ENCODER_FLAGS_SUPPORTS_METADATA;
@@ -18,9 +18,11 @@
  */
 
 #include <stdarg.h>
+#include <limits.h>
 #include <math.h>
 #include <sys/types.h>
 #include <tiffio.h>
+#include <zlib.h>
 
 #include "ntstatus.h"
 #define WIN32_NO_STATUS
@@ -32,6 +34,7 @@
 #include "wincodecs_private.h"
 
 #include "wine/debug.h"
+#include "wine/list.h"
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 WINE_DECLARE_DEBUG_CHANNEL(tiff);
@@ -120,13 +123,21 @@ static toff_t tiff_stream_size(thandle_t client_data)
 
 static int tiff_stream_map(thandle_t client_data, tdata_t *addr, toff_t *size)
 {
-    /* Cannot mmap streams */
-    return 0;
+    IStream *stream = (IStream*)client_data;
+    const BYTE *data;
+    ULONGLONG data_size;
+
+    /* Streams on memory or on a mapped file are read in place. */
+    if (!stream_get_buffer(stream, &data, &data_size)) return 0;
+
+    *addr = (tdata_t)data;
+    *size = data_size;
+    return 1;
 }
 
 static void tiff_stream_unmap(thandle_t client_data, tdata_t addr, toff_t size)
 {
-    /* No need to ever do this, since we can't map things. */
+    /* The memory belongs to the stream. */
 }
 
 static TIFF* tiff_open_stream(IStream *stream, const char *mode)
@@ -138,6 +149,92 @@ static TIFF* tiff_open_stream(IStream *stream, const char *mode)
         (void *)tiff_stream_size, (void *)tiff_stream_map, (void *)tiff_stream_unmap);
 }
 
+/* A read-only view of a stream with its own position, so that several TIFF
+ * handles can decode from the same stream on different threads. */
+struct tiff_stream_view
+{
+    IStream *stream;
+    CRITICAL_SECTION *cs;
+    ULONGLONG pos;
+};
+
+static tsize_t tiff_view_read(thandle_t client_data, tdata_t data, tsize_t size)
+{
+    struct tiff_stream_view *view = client_data;
+    ULONG bytes_read = 0;
+    HRESULT hr;
+
+    EnterCriticalSection(view->cs);
+    hr = stream_seek(view->stream, view->pos, STREAM_SEEK_SET, NULL);
+    if (SUCCEEDED(hr))
+        hr = stream_read(view->stream, data, size, &bytes_read);
+    LeaveCriticalSection(view->cs);
+
+    if (FAILED(hr)) return 0;
+    view->pos += bytes_read;
+    return bytes_read;
+}
+
+static tsize_t tiff_view_write(thandle_t client_data, tdata_t data, tsize_t size)
+{
+    return 0;
+}
+
+static toff_t tiff_view_size(thandle_t client_data)
+{
+    struct tiff_stream_view *view = client_data;
+    ULONGLONG size;
+    HRESULT hr;
+
+    EnterCriticalSection(view->cs);
+    hr = stream_getsize(view->stream, &size);
+    LeaveCriticalSection(view->cs);
+
+    if (SUCCEEDED(hr)) return size;
+    else return -1;
+}
+
+static toff_t tiff_view_seek(thandle_t client_data, toff_t offset, int whence)
+{
+    struct tiff_stream_view *view = client_data;
+    toff_t size;
+
+    switch (whence)
+    {
+        case SEEK_SET:
+            view->pos = offset;
+            break;
+        case SEEK_CUR:
+            view->pos += offset;
+            break;
+        case SEEK_END:
+            if ((size = tiff_view_size(client_data)) == (toff_t)-1)
+                return -1;
+            view->pos = size + offset;
+            break;
+        default:
+            ERR("unknown whence value %i\n", whence);
+            return -1;
+    }
+
+    return view->pos;
+}
+
+/* Mapped streams don't need the lock at all, libtiff reads them in place. */
+static int tiff_view_map(thandle_t client_data, tdata_t *addr, toff_t *size)
+{
+    struct tiff_stream_view *view = client_data;
+
+    return tiff_stream_map(view->stream, addr, size);
+}
+
+static TIFF *tiff_open_view(struct tiff_stream_view *view)
+{
+    return TIFFClientOpen("<IStream object>", "r", view, tiff_view_read,
+        tiff_view_write, (void *)tiff_view_seek, tiff_stream_close,
+        (void *)tiff_view_size, (void *)tiff_view_map, (void *)tiff_stream_unmap);
+}
+
 typedef struct {
     struct decoder_frame frame;
     int bps;
@@ -152,8 +249,21 @@ typedef struct {
     UINT tile_size;
     int tiled;
     UINT tiles_across;
+    int deflate;
+    int predictor;
 } tiff_decode_info;
 
+/* Upper bound for the memory used by decoded tiles or strips kept around for
+ * subsequent requests; at least one tile is always cached. */
+#define TILE_CACHE_SIZE (32 * 1024 * 1024)
+
+struct tiff_tile
+{
+    struct list entry;
+    UINT x, y;
+    BYTE *data;
+};
+
 struct tiff_decoder
 {
     struct decoder decoder;
@@ -162,8 +272,10 @@ struct tiff_decoder
     DWORD frame_count;
     DWORD cached_frame;
     tiff_decode_info cached_decode_info;
-    INT cached_tile_x, cached_tile_y;
-    BYTE *cached_tile;
+    struct list tile_cache; /* most recently used first */
+    UINT tile_cache_count;
+    CRITICAL_SECTION cache_cs; /* protects the tile cache while decoding bands */
+    CRITICAL_SECTION stream_cs; /* serializes stream access from band decoders */
 };
 
 static inline struct tiff_decoder *impl_from_decoder(struct decoder* iface)
@@ -173,7 +285,7 @@ static inline struct tiff_decoder *impl_from_decoder(struct decoder* iface)
 
 static HRESULT tiff_get_decode_info(TIFF *tiff, tiff_decode_info *decode_info)
 {
-    uint16_t photometric, bps, samples, planar;
+    uint16_t photometric, bps, samples, planar, compression, predictor;
     uint16_t extra_sample_count, extra_sample, *extra_samples;
     uint16_t *red, *green, *blue;
     UINT resolution_unit;
@@ -187,6 +299,16 @@ static HRESULT tiff_get_decode_info(TIFF *tiff, tiff_decode_info *decode_info)
     decode_info->invert_grayscale = 0;
     decode_info->tiled = 0;
     decode_info->source_bpp = 0;
+    decode_info->deflate = 0;
+    decode_info->predictor = PREDICTOR_NONE;
+
+    if (TIFFGetField(tiff, TIFFTAG_COMPRESSION, &compression) &&
+        (compression == COMPRESSION_ADOBE_DEFLATE || compression == COMPRESSION_DEFLATE))
+    {
+        decode_info->deflate = 1;
+        if (TIFFGetField(tiff, TIFFTAG_PREDICTOR, &predictor))
+            decode_info->predictor = predictor;
+    }
 
     ret = TIFFGetField(tiff, TIFFTAG_PHOTOMETRIC, &photometric);
     if (!ret)
@@ -576,6 +698,8 @@ static HRESULT CDECL tiff_decoder_initialize(struct decoder* iface, IStream *str
     if (!This->tiff)
         return E_FAIL;
 
+    This->stream = stream;
+
     This->frame_count = TIFFNumberOfDirectories(This->tiff);
     This->cached_frame = 0;
     hr = tiff_get_decode_info(This->tiff, &This->cached_decode_info);
@@ -594,10 +718,22 @@ fail:
     return hr;
 }
 
+static void tiff_decoder_flush_tiles(struct tiff_decoder *This)
+{
+    struct tiff_tile *tile, *next;
+
+    LIST_FOR_EACH_ENTRY_SAFE(tile, next, &This->tile_cache, struct tiff_tile, entry)
+    {
+        list_remove(&tile->entry);
+        free(tile->data);
+        free(tile);
+    }
+    This->tile_cache_count = 0;
+}
+
 static HRESULT tiff_decoder_select_frame(struct tiff_decoder* This, DWORD frame)
 {
     HRESULT hr;
-    UINT prev_tile_size;
     int res;
 
     if (frame >= This->frame_count)
@@ -606,32 +742,19 @@ static HRESULT tiff_decoder_select_frame(struct tiff_decoder* This, DWORD frame)
     if (This->cached_frame == frame)
         return S_OK;
 
-    prev_tile_size = This->cached_tile ? This->cached_decode_info.tile_size : 0;
-
     res = TIFFSetDirectory(This->tiff, frame);
     if (!res)
         return E_INVALIDARG;
 
     hr = tiff_get_decode_info(This->tiff, &This->cached_decode_info);
 
-    This->cached_tile_x = -1;
+    tiff_decoder_flush_tiles(This);
 
     if (SUCCEEDED(hr))
-    {
         This->cached_frame = frame;
-        if (This->cached_decode_info.tile_size > prev_tile_size)
-        {
-            free(This->cached_tile);
-            This->cached_tile = NULL;
-        }
-    }
     else
-    {
         /* Set an invalid value to ensure we'll refresh cached_decode_info before using it. */
         This->cached_frame = This->frame_count;
-        free(This->cached_tile);
-        This->cached_tile = NULL;
-    }
 
     return hr;
 }
@@ -650,18 +773,108 @@ static HRESULT CDECL tiff_decoder_get_frame_info(struct decoder* iface, UINT fra
     return hr;
 }
 
-static HRESULT tiff_decoder_read_tile(struct tiff_decoder *This, UINT tile_x, UINT tile_y)
+static void *zalloc(void *opaque, unsigned int items, unsigned int size)
+{
+    return malloc(items * size);
+}
+
+static void zfree(void *opaque, void *ptr)
+{
+    free(ptr);
+}
+
+/* The bundled zlib is built without default allocators, which libtiff's
+ * deflate codec relies on, so deflate compressed data is inflated here.
+ * The result is the same as what TIFFReadEncodedTile() returns. */
+static tsize_t tiff_inflate_tile(TIFF *tiff, const tiff_decode_info *info, UINT index, BYTE *tile)
+{
+    UINT row_size, rows, row, i, samples_per_row;
+    uint64_t raw_size;
+    tsize_t ret = -1;
+    z_stream strm;
+    BYTE *raw;
+
+    raw_size = TIFFGetStrileByteCount(tiff, index);
+    if (!raw_size || raw_size > UINT_MAX || !(raw = malloc(raw_size)))
+        return -1;
+
+    if (info->tiled)
+        raw_size = TIFFReadRawTile(tiff, index, raw, raw_size);
+    else
+        raw_size = TIFFReadRawStrip(tiff, index, raw, raw_size);
+
+    memset(&strm, 0, sizeof(strm));
+    strm.zalloc = zalloc;
+    strm.zfree = zfree;
+    if (raw_size != (uint64_t)-1 && inflateInit(&strm) == Z_OK)
+    {
+        strm.next_in = raw;
+        strm.avail_in = raw_size;
+        strm.next_out = tile;
+        strm.avail_out = info->tile_size;
+        if (inflate(&strm, Z_FINISH) != Z_STREAM_ERROR)
+            ret = strm.total_out;
+        inflateEnd(&strm);
+    }
+    free(raw);
+    if (ret == -1) return -1;
+
+    samples_per_row = info->tile_width * info->samples;
+    row_size = (samples_per_row * info->bps + 7) / 8;
+    rows = ret / row_size;
+
+    /* libtiff returns 16-bit samples in host byte order */
+    if (info->bps == 16 && TIFFIsByteSwapped(tiff))
+        TIFFSwabArrayOfShort((uint16_t *)tile, ret / 2);
+
+    if (info->predictor == PREDICTOR_HORIZONTAL)
+    {
+        for (row = 0; row < rows; row++)
+        {
+            if (info->bps == 8)
+            {
+                BYTE *sample = tile + row * row_size;
+                for (i = info->samples; i < samples_per_row; i++)
+                    sample[i] += sample[i - info->samples];
+            }
+            else if (info->bps == 16)
+            {
+                uint16_t *sample = (uint16_t *)(tile + row * row_size);
+                for (i = info->samples; i < samples_per_row; i++)
+                    sample[i] += sample[i - info->samples];
+            }
+            else
+            {
+                FIXME("unsupported predictor for %u bps\n", info->bps);
+                return -1;
+            }
+        }
+    }
+    else if (info->predictor != PREDICTOR_NONE)
+    {
+        FIXME("unsupported predictor %u\n", info->predictor);
+        return -1;
+    }
+
+    return ret;
+}
+
+/* Decodes a tile or strip; this only depends on the handle, so it can be
+ * used concurrently with separate handles. */
+static HRESULT tiff_read_tile(TIFF *tiff, const tiff_decode_info *info, UINT tile_x, UINT tile_y, BYTE *tile)
 {
+    UINT index = info->tiled ? tile_x + tile_y * info->tiles_across : tile_y;
     tsize_t ret;
     int swap_bytes;
-    tiff_decode_info *info = &This->cached_decode_info;
 
-    swap_bytes = TIFFIsByteSwapped(This->tiff);
+    swap_bytes = TIFFIsByteSwapped(tiff);
 
-    if (info->tiled)
-        ret = TIFFReadEncodedTile(This->tiff, tile_x + tile_y * info->tiles_across, This->cached_tile, info->tile_size);
+    if (info->deflate)
+        ret = tiff_inflate_tile(tiff, info, index, tile);
+    else if (info->tiled)
+        ret = TIFFReadEncodedTile(tiff, index, tile, info->tile_size);
     else
-        ret = TIFFReadEncodedStrip(This->tiff, tile_y, This->cached_tile, info->tile_size);
+        ret = TIFFReadEncodedStrip(tiff, index, tile, info->tile_size);
 
     if (ret == -1)
         return E_FAIL;
@@ -676,12 +889,12 @@ static HRESULT tiff_decoder_read_tile(struct tiff_decoder *This, UINT tile_x, UI
 
         srcdata = malloc(count);
         if (!srcdata) return E_OUTOFMEMORY;
-        memcpy(srcdata, This->cached_tile, count);
+        memcpy(srcdata, tile, count);
 
         for (y = 0; y < info->tile_height; y++)
         {
             src = srcdata + y * width_bytes;
-            dst = This->cached_tile + y * info->tile_width * 3;
+            dst = tile + y * info->tile_width * 3;
 
             for (x = 0; x < info->tile_width; x += 8)
             {
@@ -747,12 +960,12 @@ static HRESULT tiff_decoder_read_tile(struct tiff_decoder *This, UINT tile_x, UI
 
         srcdata = malloc(count);
         if (!srcdata) return E_OUTOFMEMORY;
-        memcpy(srcdata, This->cached_tile, count);
+        memcpy(srcdata, tile, count);
 
         for (y = 0; y < info->tile_height; y++)
         {
             src = srcdata + y * width_bytes;
-            dst = This->cached_tile + y * info->tile_width * 3;
+            dst = tile + y * info->tile_width * 3;
 
             for (x = 0; x < info->tile_width; x += 2)
             {
@@ -782,12 +995,12 @@ static HRESULT tiff_decoder_read_tile(struct tiff_decoder *This, UINT tile_x, UI
 
         srcdata = malloc(count);
         if (!srcdata) return E_OUTOFMEMORY;
-        memcpy(srcdata, This->cached_tile, count);
+        memcpy(srcdata, tile, count);
 
         for (y = 0; y < info->tile_height; y++)
         {
             src = srcdata + y * width_bytes;
-            dst = This->cached_tile + y * info->tile_width * 4;
+            dst = tile + y * info->tile_width * 4;
 
             /* 1 source byte expands to 2 BGRA samples */
 
@@ -821,12 +1034,12 @@ static HRESULT tiff_decoder_read_tile(struct tiff_decoder *This, UINT tile_x, UI
 
         srcdata = malloc(count);
         if (!srcdata) return E_OUTOFMEMORY;
-        memcpy(srcdata, This->cached_tile, count);
+        memcpy(srcdata, tile, count);
 
         for (y = 0; y < info->tile_height; y++)
         {
             src = srcdata + y * width_bytes;
-            dst = This->cached_tile + y * info->tile_width * 4;
+            dst = tile + y * info->tile_width * 4;
 
             for (x = 0; x < info->tile_width; x++)
             {
@@ -847,8 +1060,8 @@ static HRESULT tiff_decoder_read_tile(struct tiff_decoder *This, UINT tile_x, UI
         BYTE *src;
         DWORD *dst, count = info->tile_width * info->tile_height;
 
-        src = This->cached_tile + info->tile_width * info->tile_height * 2 - 2;
-        dst = (DWORD *)(This->cached_tile + info->tile_size - 4);
+        src = tile + info->tile_width * info->tile_height * 2 - 2;
+        dst = (DWORD *)(tile + info->tile_size - 4);
 
         while (count--)
         {
@@ -863,7 +1076,7 @@ static HRESULT tiff_decoder_read_tile(struct tiff_decoder *This, UINT tile_x, UI
         {
             UINT sample_count = info->samples;
 
-            reverse_bgr8(sample_count, This->cached_tile, info->tile_width,
+            reverse_bgr8(sample_count, tile, info->tile_width,
                 info->tile_height, info->tile_width * sample_count);
         }
     }
@@ -880,7 +1093,7 @@ static HRESULT tiff_decoder_read_tile(struct tiff_decoder *This, UINT tile_x, UI
         case 16:
             for (row=0; row<info->tile_height; row++)
             {
-                sample = This->cached_tile + row * info->tile_stride;
+                sample = tile + row * info->tile_stride;
                 for (i=0; i<samples_per_row; i++)
                 {
                     temp = sample[1];
@@ -906,97 +1119,246 @@ static HRESULT tiff_decoder_read_tile(struct tiff_decoder *This, UINT tile_x, UI
             return E_FAIL;
         }
 
-        end = This->cached_tile+info->tile_size;
+        end = tile+info->tile_size;
 
-        for (byte = This->cached_tile; byte != end; byte++)
+        for (byte = tile; byte != end; byte++)
             *byte = ~(*byte);
     }
 
-    This->cached_tile_x = tile_x;
-    This->cached_tile_y = tile_y;
+    return S_OK;
+}
+
+static struct tiff_tile *tiff_decoder_find_tile(struct tiff_decoder *This, UINT tile_x, UINT tile_y)
+{
+    struct tiff_tile *tile;
+
+    LIST_FOR_EACH_ENTRY(tile, &This->tile_cache, struct tiff_tile, entry)
+    {
+        if (tile->x == tile_x && tile->y == tile_y)
+            return tile;
+    }
+
+    return NULL;
+}
+
+/* Returns a tile entry which isn't in the cache list, evicting the least
+ * recently used tile if the cache is full. */
+static struct tiff_tile *tiff_decoder_alloc_tile(struct tiff_decoder *This)
+{
+    tiff_decode_info *info = &This->cached_decode_info;
+    struct tiff_tile *tile;
+
+    if (This->tile_cache_count && This->tile_cache_count >= TILE_CACHE_SIZE / info->tile_size)
+    {
+        tile = LIST_ENTRY(list_tail(&This->tile_cache), struct tiff_tile, entry);
+        list_remove(&tile->entry);
+        return tile;
+    }
+
+    if (!(tile = malloc(sizeof(*tile))))
+        return NULL;
+    if (!(tile->data = malloc(info->tile_size)))
+    {
+        free(tile);
+        return NULL;
+    }
+    This->tile_cache_count++;
+    return tile;
+}
 
+/* Adds a copy of a tile decoded by a band decoder to the cache. */
+static void tiff_decoder_cache_tile(struct tiff_decoder *This, UINT tile_x, UINT tile_y, const BYTE *data)
+{
+    struct tiff_tile *tile;
+
+    EnterCriticalSection(&This->cache_cs);
+    if (!tiff_decoder_find_tile(This, tile_x, tile_y) && (tile = tiff_decoder_alloc_tile(This)))
+    {
+        memcpy(tile->data, data, This->cached_decode_info.tile_size);
+        tile->x = tile_x;
+        tile->y = tile_y;
+        list_add_head(&This->tile_cache, &tile->entry);
+    }
+    LeaveCriticalSection(&This->cache_cs);
+}
+
+static HRESULT tiff_decoder_get_tile(struct tiff_decoder *This, UINT tile_x, UINT tile_y, BYTE **data)
+{
+    tiff_decode_info *info = &This->cached_decode_info;
+    struct tiff_tile *tile;
+    HRESULT hr;
+
+    if ((tile = tiff_decoder_find_tile(This, tile_x, tile_y)))
+    {
+        list_remove(&tile->entry);
+        list_add_head(&This->tile_cache, &tile->entry);
+        *data = tile->data;
+        return S_OK;
+    }
+
+    if (!(tile = tiff_decoder_alloc_tile(This)))
+        return E_OUTOFMEMORY;
+
+    if (FAILED(hr = tiff_read_tile(This->tiff, info, tile_x, tile_y, tile->data)))
+    {
+        This->tile_cache_count--;
+        free(tile->data);
+        free(tile);
+        return hr;
+    }
+
+    tile->x = tile_x;
+    tile->y = tile_y;
+    list_add_head(&This->tile_cache, &tile->entry);
+    *data = tile->data;
     return S_OK;
 }
 
-static HRESULT CDECL tiff_decoder_copy_pixels(struct decoder* iface, UINT frame,
+/* Copies the part of a decoded tile that intersects prc to the buffer. */
+static HRESULT tiff_copy_tile(const tiff_decode_info *info, const BYTE *tile, UINT tile_x, UINT tile_y,
     const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer)
 {
-    struct tiff_decoder *This = impl_from_decoder(iface);
-    HRESULT hr;
-    UINT min_tile_x, max_tile_x, min_tile_y, max_tile_y;
-    UINT tile_x, tile_y;
     BYTE *dst_tilepos;
     WICRect rc;
-    tiff_decode_info *info = &This->cached_decode_info;
 
-    hr = tiff_decoder_select_frame(This, frame);
-    if (FAILED(hr))
-        return hr;
+    if (prc->X < tile_x * info->tile_width)
+        rc.X = 0;
+    else
+        rc.X = prc->X - tile_x * info->tile_width;
+
+    if (prc->Y < tile_y * info->tile_height)
+        rc.Y = 0;
+    else
+        rc.Y = prc->Y - tile_y * info->tile_height;
+
+    if (prc->X+prc->Width > (tile_x+1) * info->tile_width)
+        rc.Width = info->tile_width - rc.X;
+    else if (prc->X < tile_x * info->tile_width)
+        rc.Width = prc->Width + prc->X - tile_x * info->tile_width;
+    else
+        rc.Width = prc->Width;
+
+    if (prc->Y+prc->Height > (tile_y+1) * info->tile_height)
+        rc.Height = info->tile_height - rc.Y;
+    else if (prc->Y < tile_y * info->tile_height)
+        rc.Height = prc->Height + prc->Y - tile_y * info->tile_height;
+    else
+        rc.Height = prc->Height;
+
+    dst_tilepos = buffer + (stride * ((rc.Y + tile_y * info->tile_height) - prc->Y)) +
+        ((info->frame.bpp * ((rc.X + tile_x * info->tile_width) - prc->X) + 7) / 8);
+
+    return copy_pixels(info->frame.bpp, tile,
+        info->tile_width, info->tile_height, info->tile_stride,
+        &rc, stride, buffersize, dst_tilepos);
+}
+
+struct tiff_tiles_context
+{
+    struct tiff_decoder *decoder;
+    UINT frame;
+    const WICRect *prc;
+    UINT stride;
+    UINT buffersize;
+    BYTE *buffer;
+    UINT min_tile_x, min_tile_y;
+    UINT tiles_x, tiles_y;
+};
+
+/* Decodes the tiles [first, first + count) of the requested rectangle, in
+ * row-major order. Partial ranges run concurrently, each with its own TIFF
+ * handle and scratch buffer, and add the tiles they decode to the cache; the
+ * whole range is read through the tile cache. */
+static HRESULT tiff_decoder_decode_tiles(void *context, UINT first, UINT count)
+{
+    struct tiff_tiles_context *ctx = context;
+    struct tiff_decoder *This = ctx->decoder;
+    tiff_decode_info *info = &This->cached_decode_info;
+    struct tiff_stream_view view;
+    TIFF *tiff = NULL;
+    BYTE *tile = NULL;
+    UINT i, tile_x, tile_y;
+    HRESULT hr = S_OK;
 
-    if (!This->cached_tile)
+    if (count != ctx->tiles_x * ctx->tiles_y)
     {
-        This->cached_tile = malloc(info->tile_size);
-        if (!This->cached_tile)
-            return E_OUTOFMEMORY;
-    }
+        view.stream = This->stream;
+        view.cs = &This->stream_cs;
+        view.pos = 0;
 
-    min_tile_x = prc->X / info->tile_width;
-    min_tile_y = prc->Y / info->tile_height;
-    max_tile_x = (prc->X+prc->Width-1) / info->tile_width;
-    max_tile_y = (prc->Y+prc->Height-1) / info->tile_height;
+        if (!(tiff = tiff_open_view(&view)))
+            return E_FAIL;
 
-    for (tile_x=min_tile_x; tile_x <= max_tile_x; tile_x++)
+        if (!TIFFSetDirectory(tiff, ctx->frame))
+            hr = E_FAIL;
+        else if (!(tile = malloc(info->tile_size)))
+            hr = E_OUTOFMEMORY;
+    }
+
+    for (i = first; SUCCEEDED(hr) && i < first + count; i++)
     {
-        for (tile_y=min_tile_y; tile_y <= max_tile_y; tile_y++)
+        tile_x = ctx->min_tile_x + i % ctx->tiles_x;
+        tile_y = ctx->min_tile_y + i / ctx->tiles_x;
+
+        if (tiff)
         {
-            if (tile_x != This->cached_tile_x || tile_y != This->cached_tile_y)
-            {
-                hr = tiff_decoder_read_tile(This, tile_x, tile_y);
-            }
+            if (SUCCEEDED(hr = tiff_read_tile(tiff, info, tile_x, tile_y, tile)))
+                tiff_decoder_cache_tile(This, tile_x, tile_y, tile);
+        }
+        else
+            hr = tiff_decoder_get_tile(This, tile_x, tile_y, &tile);
 
-            if (SUCCEEDED(hr))
-            {
-                if (prc->X < tile_x * info->tile_width)
-                    rc.X = 0;
-                else
-                    rc.X = prc->X - tile_x * info->tile_width;
-
-                if (prc->Y < tile_y * info->tile_height)
-                    rc.Y = 0;
-                else
-                    rc.Y = prc->Y - tile_y * info->tile_height;
-
-                if (prc->X+prc->Width > (tile_x+1) * info->tile_width)
-                    rc.Width = info->tile_width - rc.X;
-                else if (prc->X < tile_x * info->tile_width)
-                    rc.Width = prc->Width + prc->X - tile_x * info->tile_width;
-                else
-                    rc.Width = prc->Width;
-
-                if (prc->Y+prc->Height > (tile_y+1) * info->tile_height)
-                    rc.Height = info->tile_height - rc.Y;
-                else if (prc->Y < tile_y * info->tile_height)
-                    rc.Height = prc->Height + prc->Y - tile_y * info->tile_height;
-                else
-                    rc.Height = prc->Height;
-
-                dst_tilepos = buffer + (stride * ((rc.Y + tile_y * info->tile_height) - prc->Y)) +
-                    ((info->frame.bpp * ((rc.X + tile_x * info->tile_width) - prc->X) + 7) / 8);
-
-                hr = copy_pixels(info->frame.bpp, This->cached_tile,
-                    info->tile_width, info->tile_height, info->tile_stride,
-                    &rc, stride, buffersize, dst_tilepos);
-            }
+        if (SUCCEEDED(hr))
+            hr = tiff_copy_tile(info, tile, tile_x, tile_y, ctx->prc, ctx->stride, ctx->buffersize, ctx->buffer);
+    }
 
-            if (FAILED(hr))
-            {
-                TRACE("<-- 0x%lx\n", hr);
-                return hr;
-            }
-        }
+    if (tiff)
+    {
+        free(tile);
+        TIFFClose(tiff);
     }
 
-    return S_OK;
+    return hr;
+}
+
+static HRESULT CDECL tiff_decoder_copy_pixels(struct decoder* iface, UINT frame,
+    const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer)
+{
+    struct tiff_decoder *This = impl_from_decoder(iface);
+    struct tiff_tiles_context ctx;
+    tiff_decode_info *info;
+    UINT count;
+    HRESULT hr;
+
+    hr = tiff_decoder_select_frame(This, frame);
+    if (FAILED(hr))
+        return hr;
+
+    info = &This->cached_decode_info;
+
+    ctx.decoder = This;
+    ctx.frame = frame;
+    ctx.prc = prc;
+    ctx.stride = stride;
+    ctx.buffersize = buffersize;
+    ctx.buffer = buffer;
+    ctx.min_tile_x = prc->X / info->tile_width;
+    ctx.min_tile_y = prc->Y / info->tile_height;
+    ctx.tiles_x = (prc->X+prc->Width-1) / info->tile_width - ctx.min_tile_x + 1;
+    ctx.tiles_y = (prc->Y+prc->Height-1) / info->tile_height - ctx.min_tile_y + 1;
+    count = ctx.tiles_x * ctx.tiles_y;
+
+    /* Requests walking through the image in small bands are served from the
+     * cache, large ones are decoded in parallel. */
+    if (count > 1 && !tiff_decoder_find_tile(This, ctx.min_tile_x, ctx.min_tile_y))
+        hr = process_bands(info->tile_width * info->tile_height, count, tiff_decoder_decode_tiles, &ctx);
+    else
+        hr = tiff_decoder_decode_tiles(&ctx, 0, count);
+
+    if (FAILED(hr))
+        TRACE("<-- 0x%lx\n", hr);
+
+    return hr;
 }
 
 static HRESULT CDECL tiff_decoder_get_color_context(struct decoder *iface,
@@ -1062,7 +1424,11 @@ static void CDECL tiff_decoder_destroy(struct decoder* iface)
 {
     struct tiff_decoder *This = impl_from_decoder(iface);
     if (This->tiff) TIFFClose(This->tiff);
-    free(This->cached_tile);
+    tiff_decoder_flush_tiles(This);
+    This->cache_cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&This->cache_cs);
+    This->stream_cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&This->stream_cs);
     free(This);
 }
 
@@ -1084,8 +1450,13 @@ HRESULT CDECL tiff_decoder_create(struct decoder_info *info, struct decoder **re
 
     This->decoder.vtable = &tiff_decoder_vtable;
     This->tiff = NULL;
-    This->cached_tile = NULL;
-    This->cached_tile_x = -1;
+    This->stream = NULL;
+    list_init(&This->tile_cache);
+    This->tile_cache_count = 0;
+    InitializeCriticalSectionEx(&This->cache_cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
+    This->cache_cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": tiff_decoder.cache_cs");
+    InitializeCriticalSectionEx(&This->stream_cs, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
+    This->stream_cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": tiff_decoder.stream_cs");
     *result = &This->decoder;
 
     info->container_format = GUID_ContainerFormatTiff;
@@ -1126,6 +1497,11 @@ static const struct tiff_encode_format formats[] = {
     {0}
 };
 
+/* Deflate compressed frames are written in strips of about this size; a
+ * batch of strips is compressed in parallel and written out raw. */
+#define DEFLATE_STRIP_SIZE (256 * 1024)
+#define DEFLATE_BATCH_STRIPS 32
+
 typedef struct tiff_encoder {
     struct encoder encoder;
     TIFF *tiff;
@@ -1133,6 +1509,11 @@ typedef struct tiff_encoder {
     struct encoder_frame encoder_frame;
     DWORD num_frames;
     DWORD lines_written;
+    UINT line_size;
+    BYTE *strip_data; /* pending rows of the current batch of deflate strips */
+    UINT rows_per_strip;
+    UINT pending_rows;
+    UINT next_strip;
 } tiff_encoder;
 
 static inline struct tiff_encoder *impl_from_encoder(struct encoder* iface)
@@ -1189,6 +1570,10 @@ static HRESULT CDECL tiff_encoder_create_frame(struct encoder* iface, const stru
     This->num_frames++;
     This->lines_written = 0;
     This->encoder_frame = *frame;
+    This->pending_rows = 0;
+    This->next_strip = 0;
+    free(This->strip_data);
+    This->strip_data = NULL;
 
     for (i=0; formats[i].guid; i++)
     {
@@ -1236,19 +1621,134 @@ static HRESULT CDECL tiff_encoder_create_frame(struct encoder* iface, const stru
         TIFFSetField(This->tiff, TIFFTAG_COLORMAP, red, green, blue);
     }
 
+    This->line_size = ((frame->width * This->format->bpp)+7)/8;
+
+    switch (frame->compression)
+    {
+    case WICTiffCompressionDontCare:
+    case WICTiffCompressionNone:
+        break;
+    case WICTiffCompressionLZW:
+        TIFFSetField(This->tiff, TIFFTAG_COMPRESSION, (uint16_t)COMPRESSION_LZW);
+        break;
+    case WICTiffCompressionLZWHDifferencing:
+        TIFFSetField(This->tiff, TIFFTAG_COMPRESSION, (uint16_t)COMPRESSION_LZW);
+        if (This->format->bps == 8 || This->format->bps == 16)
+            TIFFSetField(This->tiff, TIFFTAG_PREDICTOR, (uint16_t)PREDICTOR_HORIZONTAL);
+        break;
+    case WICTiffCompressionRLE:
+        TIFFSetField(This->tiff, TIFFTAG_COMPRESSION, (uint16_t)COMPRESSION_PACKBITS);
+        break;
+    case WICTiffCompressionZIP:
+        This->rows_per_strip = max(1, DEFLATE_STRIP_SIZE / This->line_size);
+        This->rows_per_strip = min(This->rows_per_strip, frame->height);
+        if (!(This->strip_data = malloc((SIZE_T)This->rows_per_strip * DEFLATE_BATCH_STRIPS * This->line_size)))
+            return E_OUTOFMEMORY;
+        TIFFSetField(This->tiff, TIFFTAG_COMPRESSION, (uint16_t)COMPRESSION_ADOBE_DEFLATE);
+        TIFFSetField(This->tiff, TIFFTAG_ROWSPERSTRIP, (uint32_t)This->rows_per_strip);
+        break;
+    default:
+        FIXME("unsupported compression %lu\n", frame->compression);
+        break;
+    }
+
     return S_OK;
 }
 
+struct tiff_strips_context
+{
+    struct tiff_encoder *encoder;
+    UINT rows;
+    BYTE **data;
+    uLongf *size;
+};
+
+static HRESULT tiff_encoder_compress_strips(void *context, UINT first, UINT count)
+{
+    struct tiff_strips_context *ctx = context;
+    struct tiff_encoder *This = ctx->encoder;
+    z_stream strm;
+    UINT i, rows;
+    int ret;
+
+    for (i = first; i < first + count; i++)
+    {
+        rows = min(This->rows_per_strip, ctx->rows - i * This->rows_per_strip);
+
+        memset(&strm, 0, sizeof(strm));
+        strm.zalloc = zalloc;
+        strm.zfree = zfree;
+        if (deflateInit(&strm, Z_DEFAULT_COMPRESSION) != Z_OK)
+            return E_OUTOFMEMORY;
+
+        strm.next_in = This->strip_data + (SIZE_T)i * This->rows_per_strip * This->line_size;
+        strm.avail_in = rows * This->line_size;
+        strm.avail_out = deflateBound(&strm, strm.avail_in);
+        if (!(ctx->data[i] = strm.next_out = malloc(strm.avail_out)))
+        {
+            deflateEnd(&strm);
+            return E_OUTOFMEMORY;
+        }
+
+        ret = deflate(&strm, Z_FINISH);
+        ctx->size[i] = strm.total_out;
+        deflateEnd(&strm);
+
+        if (ret != Z_STREAM_END)
+            return E_FAIL;
+    }
+
+    return S_OK;
+}
+
+static HRESULT tiff_encoder_flush_strips(struct tiff_encoder *This)
+{
+    struct tiff_strips_context ctx;
+    UINT i, count;
+    HRESULT hr;
+
+    if (!This->pending_rows)
+        return S_OK;
+
+    count = (This->pending_rows + This->rows_per_strip - 1) / This->rows_per_strip;
+
+    ctx.encoder = This;
+    ctx.rows = This->pending_rows;
+    ctx.data = calloc(count, sizeof(*ctx.data));
+    ctx.size = calloc(count, sizeof(*ctx.size));
+
+    if (!ctx.data || !ctx.size)
+        hr = E_OUTOFMEMORY;
+    else
+        hr = process_bands(This->encoder_frame.width * This->rows_per_strip, count,
+                tiff_encoder_compress_strips, &ctx);
+
+    for (i = 0; i < count && SUCCEEDED(hr); i++)
+    {
+        if (TIFFWriteRawStrip(This->tiff, This->next_strip++, ctx.data[i], ctx.size[i]) == -1)
+            hr = E_FAIL;
+    }
+
+    for (i = 0; ctx.data && i < count; i++)
+        free(ctx.data[i]);
+    free(ctx.data);
+    free(ctx.size);
+
+    This->pending_rows = 0;
+    return hr;
+}
+
 static HRESULT CDECL tiff_encoder_write_lines(struct encoder* iface,
     BYTE *data, DWORD line_count, DWORD stride)
 {
     struct tiff_encoder* This = impl_from_encoder(iface);
     BYTE *row_data, *swapped_data = NULL;
     UINT i, j, line_size;
+    HRESULT hr = S_OK;
 
-    line_size = ((This->encoder_frame.width * This->format->bpp)+7)/8;
+    line_size = This->line_size;
 
-    if (This->format->reverse_bgr)
+    if (This->format->reverse_bgr && !This->strip_data)
     {
         swapped_data = malloc(line_size);
         if (!swapped_data)
@@ -1259,30 +1759,56 @@ static HRESULT CDECL tiff_encoder_write_lines(struct encoder* iface,
     {
         row_data = data + i * stride;
 
+        if (This->strip_data)
+        {
+            /* Buffer the row, any byte swapping is done in place. */
+            memcpy(This->strip_data + (SIZE_T)This->pending_rows * This->line_size, row_data, line_size);
+            row_data = This->strip_data + (SIZE_T)This->pending_rows * This->line_size;
+        }
+
         if (This->format->reverse_bgr && This->format->bps == 8)
         {
-            memcpy(swapped_data, row_data, line_size);
+            if (!This->strip_data)
+            {
+                memcpy(swapped_data, row_data, line_size);
+                row_data = swapped_data;
+            }
             for (j=0; j<line_size; j += This->format->samples)
             {
                 BYTE temp;
-                temp = swapped_data[j];
-                swapped_data[j] = swapped_data[j+2];
-                swapped_data[j+2] = temp;
+                temp = row_data[j];
+                row_data[j] = row_data[j+2];
+                row_data[j+2] = temp;
             }
-            row_data = swapped_data;
         }
 
-        TIFFWriteScanline(This->tiff, (tdata_t)row_data, i+This->lines_written, 0);
+        if (!This->strip_data)
+            TIFFWriteScanline(This->tiff, (tdata_t)row_data, i+This->lines_written, 0);
+        else if (++This->pending_rows == This->rows_per_strip * DEFLATE_BATCH_STRIPS &&
+                 FAILED(hr = tiff_encoder_flush_strips(This)))
+            break;
     }
 
-    This->lines_written += line_count;
+    This->lines_written += i;
 
-    return S_OK;
+    free(swapped_data);
+
+    return hr;
 }
 
 static HRESULT CDECL tiff_encoder_commit_frame(struct encoder* iface)
 {
-    return S_OK;
+    struct tiff_encoder* This = impl_from_encoder(iface);
+    HRESULT hr = S_OK;
+
+    if (This->strip_data)
+    {
+        hr = tiff_encoder_flush_strips(This);
+        free(This->strip_data);
+        This->strip_data = NULL;
+    }
+
+    return hr;
 }
 
 static HRESULT CDECL tiff_encoder_commit_file(struct encoder* iface)
@@ -1300,6 +1826,7 @@ static void CDECL tiff_encoder_destroy(struct encoder* iface)
     struct tiff_encoder *This = impl_from_encoder(iface);
 
     if (This->tiff) TIFFClose(This->tiff);
+    free(This->strip_data);
     free(This);
 }
 
@@ -1323,6 +1850,7 @@ HRESULT CDECL tiff_encoder_create(struct encoder_info *info, struct encoder **re
     This->encoder.vtable = &tiff_encoder_vtable;
     This->tiff = NULL;
     This->num_frames = 0;
+    This->strip_data = NULL;
 
     info->flags = ENCODER_FLAGS_MULTI_FRAME | ENCODER_FLAGS_SUPPORTS_METADATA;
     info->container_format = GUID_ContainerFormatTiff;
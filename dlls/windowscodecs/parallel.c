@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdarg.h>
+
+#define COBJMACROS
+
+#include "windef.h"
+#include "winbase.h"
+#include "winreg.h"
+#include "objbase.h"
+
+#include "wincodecs_private.h"
+
+#include "wine/debug.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
+
+/* Splitting a request into bands only pays off once every band has a
+ * reasonable amount of work; this is the default minimum number of pixels
+ * per band, configurable through HKCU\Software\Wine\WindowsCodecs. */
+#define DEFAULT_MIN_BAND_PIXELS (256 * 1024)
+
+static INIT_ONCE band_config_once = INIT_ONCE_STATIC_INIT;
+static DWORD min_band_pixels = DEFAULT_MIN_BAND_PIXELS;
+static DWORD max_band_threads;
+
+static DWORD get_config_dword(HKEY key, const WCHAR *name, DWORD def)
+{
+    DWORD type, value, size = sizeof(value);
+
+    if (!RegQueryValueExW(key, name, NULL, &type, (BYTE *)&value, &size) && type == REG_DWORD)
+        return value;
+    return def;
+}
+
+static BOOL WINAPI init_band_config(INIT_ONCE *once, void *param, void **context)
+{
+    SYSTEM_INFO info;
+    HKEY key;
+
+    GetSystemInfo(&info);
+    max_band_threads = info.dwNumberOfProcessors;
+
+    if (!RegOpenKeyExW(HKEY_CURRENT_USER, L"Software\\Wine\\WindowsCodecs", 0, KEY_READ, &key))
+    {
+        min_band_pixels = get_config_dword(key, L"MinBandPixels", min_band_pixels);
+        max_band_threads = get_config_dword(key, L"MaxBandThreads", max_band_threads);
+        RegCloseKey(key);
+    }
+
+    TRACE("min_band_pixels %lu, max_band_threads %lu.\n", min_band_pixels, max_band_threads);
+
+    return TRUE;
+}
+
+struct band_job
+{
+    band_func func;
+    void *context;
+    UINT height;
+    UINT band_height;
+    UINT band_count;
+    LONG next_band;
+    LONG hr;
+};
+
+static void run_bands(struct band_job *job)
+{
+    UINT band, y;
+    HRESULT hr;
+
+    while ((band = InterlockedIncrement(&job->next_band) - 1) < job->band_count)
+    {
+        if (FAILED(ReadNoFence(&job->hr)))
+            break;
+
+        y = band * job->band_height;
+        if (FAILED(hr = job->func(job->context, y, min(job->band_height, job->height - y))))
+            InterlockedCompareExchange(&job->hr, hr, S_OK);
+    }
+}
+
+static void CALLBACK band_work_callback(TP_CALLBACK_INSTANCE *instance, void *context, TP_WORK *work)
+{
+    run_bands(context);
+}
+
+HRESULT process_bands(UINT width, UINT height, band_func func, void *context)
+{
+    struct band_job job;
+    UINT band_count, i;
+    TP_WORK *work;
+
+    InitOnceExecuteOnce(&band_config_once, init_band_config, NULL, NULL);
+
+    if (!min_band_pixels || max_band_threads < 2 || !width)
+        return func(context, 0, height);
+
+    band_count = min((ULONGLONG)width * height / min_band_pixels, max_band_threads);
+    if (band_count < 2)
+        return func(context, 0, height);
+
+    job.func = func;
+    job.context = context;
+    job.height = height;
+    job.band_height = (height + band_count - 1) / band_count;
+    job.band_count = (height + job.band_height - 1) / job.band_height;
+    job.next_band = 0;
+    job.hr = S_OK;
+
+    if (!(work = CreateThreadpoolWork(band_work_callback, &job, NULL)))
+    {
+        WARN("Failed to create threadpool work, error %lu.\n", GetLastError());
+        return func(context, 0, height);
+    }
+
+    TRACE("Processing %u rows in %u bands of %u rows.\n", height, job.band_count, job.band_height);
+
+    /* The calling thread processes bands as well. */
+    for (i = 1; i < job.band_count; ++i)
+        SubmitThreadpoolWork(work);
+    run_bands(&job);
+
+    /* All bands are done, callbacks which didn't start yet have nothing left to do. */
+    WaitForThreadpoolWorkCallbacks(work, TRUE);
+    CloseThreadpoolWork(work);
+
+    return job.hr;
+}
@@ -0,0 +1,699 @@
+/*
+ * Row conversion kernels for the format converter
+ *
+ * Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+#include <stdarg.h>
+#include <math.h>
+
+#define COBJMACROS
+
+#include "windef.h"
+#include "winbase.h"
+#include "objbase.h"
+
+#include "wincodecs_private.h"
+
+#include "wine/debug.h"
+
+#if (defined(__i386__) || defined(__x86_64__)) && !defined(__arm64ec__) && defined(__GNUC__)
+#include <intrin.h>
+#define HAVE_X86_KERNELS
+#define TARGET(x) __attribute__((target(x)))
+#endif
+
+WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
+
+/* All kernels produce exactly the same output as the scalar versions, which
+ * in turn match the conversions previously done inline in converter.c. */
+
+static void bgr24_to_bgra32_c(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 3, dst += 4)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+        dst[3] = 0xff;
+    }
+}
+
+static void rgb24_to_bgra32_c(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 3, dst += 4)
+    {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+        dst[3] = 0xff;
+    }
+}
+
+static void bgra32_to_bgr24_c(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 3)
+    {
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+}
+
+static void rgba32_to_bgr24_c(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 4, dst += 3)
+    {
+        dst[0] = src[2];
+        dst[1] = src[1];
+        dst[2] = src[0];
+    }
+}
+
+static void rgb48_to_bgra32_c(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    /* Only the high byte of each little-endian component is used. */
+    for (x = 0; x < width; x++, src += 6, dst += 4)
+    {
+        dst[0] = src[5];
+        dst[1] = src[3];
+        dst[2] = src[1];
+        dst[3] = 0xff;
+    }
+}
+
+static void rgba64_to_bgra32_c(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, src += 8, dst += 4)
+    {
+        dst[0] = src[5];
+        dst[1] = src[3];
+        dst[2] = src[1];
+        dst[3] = src[7];
+    }
+}
+
+static void premultiply32_c(BYTE *row, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, row += 4)
+    {
+        BYTE alpha = row[3];
+
+        if (alpha != 255)
+        {
+            row[0] = (row[0] * alpha + 127) / 255;
+            row[1] = (row[1] * alpha + 127) / 255;
+            row[2] = (row[2] * alpha + 127) / 255;
+        }
+    }
+}
+
+static void unpremultiply32_c(BYTE *row, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, row += 4)
+    {
+        BYTE alpha = row[3];
+
+        if (alpha != 0 && alpha != 255)
+        {
+            row[0] = row[0] * 255 / alpha;
+            row[1] = row[1] * 255 / alpha;
+            row[2] = row[2] * 255 / alpha;
+        }
+    }
+}
+
+/* sRGB encoding of linear floats.
+ *
+ * The result of floor(to_sRGB(f) * 255 + 0.51) is monotonic on [0, 1], so it
+ * is fully described by the smallest input producing each output value.
+ * Inputs are bucketed by f * SRGB_LUT_SIZE, which is exact; the buckets are
+ * narrow enough that at most one threshold falls into any of them, checked
+ * when the tables are built. Values outside [0, 1] and NaNs take the slow
+ * path. */
+
+#define SRGB_LUT_SIZE 8192
+
+static INIT_ONCE srgb_once = INIT_ONCE_STATIC_INIT;
+static BOOL srgb_lut_valid;
+static int srgb_lut[SRGB_LUT_SIZE + 1];
+static float srgb_thresholds[257];
+
+/* https://www.w3.org/Graphics/Color/srgb */
+static BYTE float_to_srgb8_slow(float f)
+{
+    if (f <= 0.0031308f) f = 12.92f * f;
+    else f = 1.055f * powf(f, 1.0f/2.4f) - 0.055f;
+    return (BYTE)floorf(f * 255.0f + 0.51f);
+}
+
+static inline float float_from_bits(UINT bits)
+{
+    union { UINT i; float f; } u = { bits };
+    return u.f;
+}
+
+static inline UINT float_to_bits(float f)
+{
+    union { float f; UINT i; } u = { f };
+    return u.i;
+}
+
+static BOOL WINAPI init_srgb_tables(INIT_ONCE *once, void *param, void **context)
+{
+    UINT value, lo, hi, mid, i;
+
+    srgb_thresholds[0] = -INFINITY;
+    for (value = 1; value < 256; value++)
+    {
+        /* Positive floats sort like their bit patterns. */
+        lo = 0;
+        hi = 0x3f800000;
+        while (lo < hi)
+        {
+            mid = lo + (hi - lo) / 2;
+            if (float_to_srgb8_slow(float_from_bits(mid)) >= value) hi = mid;
+            else lo = mid + 1;
+        }
+        srgb_thresholds[value] = float_from_bits(lo);
+    }
+    srgb_thresholds[256] = INFINITY;
+
+    srgb_lut_valid = TRUE;
+    for (i = 0; i <= SRGB_LUT_SIZE; i++)
+    {
+        float start = (float)i / SRGB_LUT_SIZE, end;
+
+        srgb_lut[i] = float_to_srgb8_slow(start);
+        if (i == SRGB_LUT_SIZE) break;
+
+        end = float_from_bits(float_to_bits((float)(i + 1) / SRGB_LUT_SIZE) - 1);
+        if (float_to_srgb8_slow(end) > srgb_lut[i] + 1
+                || (srgb_lut[i] < 255 && end >= srgb_thresholds[srgb_lut[i] + 2]))
+            srgb_lut_valid = FALSE;
+    }
+
+    TRACE("sRGB lookup tables %s.\n", srgb_lut_valid ? "valid" : "not usable");
+
+    return TRUE;
+}
+
+static inline BYTE float_to_srgb8_lut(float f)
+{
+    int value = srgb_lut[(int)(f * SRGB_LUT_SIZE)];
+
+    return value + (f >= srgb_thresholds[value + 1]);
+}
+
+BYTE float_to_srgb8(float f)
+{
+    InitOnceExecuteOnce(&srgb_once, init_srgb_tables, NULL, NULL);
+
+    if (srgb_lut_valid && f >= 0.0f && f <= 1.0f)
+        return float_to_srgb8_lut(f);
+    return float_to_srgb8_slow(f);
+}
+
+static void float_to_srgb8_c(const float *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++)
+        dst[x] = float_to_srgb8(src[x]);
+}
+
+static inline BYTE clamp_filtered(int sum)
+{
+    sum = (sum + (1 << (FILTER_BITS - 1))) >> FILTER_BITS;
+    return sum < 0 ? 0 : sum > 255 ? 255 : sum;
+}
+
+static void filter_rows_range(const BYTE * const *rows, const short *weights, UINT taps,
+        BYTE *dst, UINT x, UINT size)
+{
+    UINT k;
+
+    for (; x < size; x++)
+    {
+        int sum = 0;
+
+        for (k = 0; k < taps; k++)
+            sum += rows[k][x] * weights[k];
+        dst[x] = clamp_filtered(sum);
+    }
+}
+
+static void filter_rows_c(const BYTE * const *rows, const short *weights, UINT taps, BYTE *dst, UINT size)
+{
+    filter_rows_range(rows, weights, taps, dst, 0, size);
+}
+
+static void filter_row32_c(const BYTE *src, UINT origin, const UINT *start, const short *weights,
+        UINT taps, BYTE *dst, UINT count)
+{
+    UINT i, k;
+
+    for (i = 0; i < count; i++, weights += taps, dst += 4)
+    {
+        const BYTE *p = src + (start[i] - origin) * 4;
+        int b = 0, g = 0, r = 0, a = 0;
+
+        for (k = 0; k < taps; k++, p += 4)
+        {
+            b += p[0] * weights[k];
+            g += p[1] * weights[k];
+            r += p[2] * weights[k];
+            a += p[3] * weights[k];
+        }
+        dst[0] = clamp_filtered(b);
+        dst[1] = clamp_filtered(g);
+        dst[2] = clamp_filtered(r);
+        dst[3] = clamp_filtered(a);
+    }
+}
+
+#ifdef HAVE_X86_KERNELS
+
+static void TARGET("ssse3") bgr24_to_bgra32_ssse3(const BYTE *src, BYTE *dst, UINT width)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    UINT x;
+
+    for (x = 0; x + 6 <= width; x += 4, src += 12, dst += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+    }
+    bgr24_to_bgra32_c(src, dst, width - x);
+}
+
+static void TARGET("ssse3") rgb24_to_bgra32_ssse3(const BYTE *src, BYTE *dst, UINT width)
+{
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    UINT x;
+
+    for (x = 0; x + 6 <= width; x += 4, src += 12, dst += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_shuffle_epi8(v, shuffle), alpha));
+    }
+    rgb24_to_bgra32_c(src, dst, width - x);
+}
+
+/* The 16 byte store covers the next pixel as well, which is rewritten by
+ * the next iteration; stop early enough to stay inside the row. */
+static void TARGET("ssse3") bgra32_to_bgr24_ssse3(const BYTE *src, BYTE *dst, UINT width)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    UINT x;
+
+    for (x = 0; x + 6 <= width; x += 4, src += 16, dst += 12)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(v, shuffle));
+    }
+    bgra32_to_bgr24_c(src, dst, width - x);
+}
+
+static void TARGET("ssse3") rgba32_to_bgr24_ssse3(const BYTE *src, BYTE *dst, UINT width)
+{
+    const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    UINT x;
+
+    for (x = 0; x + 6 <= width; x += 4, src += 16, dst += 12)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)src);
+        _mm_storeu_si128((__m128i *)dst, _mm_shuffle_epi8(v, shuffle));
+    }
+    rgba32_to_bgr24_c(src, dst, width - x);
+}
+
+static void TARGET("ssse3") rgb48_to_bgra32_ssse3(const BYTE *src, BYTE *dst, UINT width)
+{
+    const __m128i shuffle = _mm_setr_epi8(5, 3, 1, -1, 11, 9, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    UINT x;
+
+    /* The second load reads 28 bytes into the 24 consumed per iteration. */
+    for (x = 0; x + 5 <= width; x += 4, src += 24, dst += 16)
+    {
+        __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)src), shuffle);
+        __m128i b = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(src + 12)), shuffle);
+        _mm_storeu_si128((__m128i *)dst, _mm_or_si128(_mm_unpacklo_epi64(a, b), alpha));
+    }
+    rgb48_to_bgra32_c(src, dst, width - x);
+}
+
+static void TARGET("sse2") rgba64_to_bgra32_sse2(const BYTE *src, BYTE *dst, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x + 4 <= width; x += 4, src += 32, dst += 16)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)src);
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + 16));
+
+        a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+        b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+        a = _mm_srli_epi16(a, 8);
+        b = _mm_srli_epi16(b, 8);
+        _mm_storeu_si128((__m128i *)dst, _mm_packus_epi16(a, b));
+    }
+    rgba64_to_bgra32_c(src, dst, width - x);
+}
+
+/* (c * a + 127) / 255 for 16-bit v = c * a + 127 is (v + 1 + (v >> 8)) >> 8;
+ * for a == 255 this gives back c, so opaque pixels need no special case. */
+static inline __m128i TARGET("sse2") premultiply_epi16_sse2(__m128i v)
+{
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+    v = _mm_add_epi16(_mm_mullo_epi16(v, a), _mm_set1_epi16(127));
+    return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(v, _mm_set1_epi16(1)), _mm_srli_epi16(v, 8)), 8);
+}
+
+static void TARGET("sse2") premultiply32_sse2(BYTE *row, UINT width)
+{
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    const __m128i zero = _mm_setzero_si128();
+    UINT x;
+
+    for (x = 0; x + 4 <= width; x += 4, row += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)row);
+        __m128i lo = premultiply_epi16_sse2(_mm_unpacklo_epi8(v, zero));
+        __m128i hi = premultiply_epi16_sse2(_mm_unpackhi_epi8(v, zero));
+        __m128i r = _mm_packus_epi16(lo, hi);
+
+        _mm_storeu_si128((__m128i *)row, _mm_or_si128(_mm_and_si128(v, alpha_mask),
+                _mm_andnot_si128(alpha_mask, r)));
+    }
+    premultiply32_c(row, width - x);
+}
+
+static inline __m256i TARGET("avx2") premultiply_epi16_avx2(__m256i v)
+{
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+
+    v = _mm256_add_epi16(_mm256_mullo_epi16(v, a), _mm256_set1_epi16(127));
+    return _mm256_srli_epi16(_mm256_add_epi16(_mm256_add_epi16(v, _mm256_set1_epi16(1)),
+            _mm256_srli_epi16(v, 8)), 8);
+}
+
+static void TARGET("avx2") premultiply32_avx2(BYTE *row, UINT width)
+{
+    const __m256i alpha_mask = _mm256_set1_epi32(0xff000000);
+    const __m256i zero = _mm256_setzero_si256();
+    UINT x;
+
+    /* Unpacking and packing both work within 128-bit lanes, so pixel order
+     * is preserved. */
+    for (x = 0; x + 8 <= width; x += 8, row += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)row);
+        __m256i lo = premultiply_epi16_avx2(_mm256_unpacklo_epi8(v, zero));
+        __m256i hi = premultiply_epi16_avx2(_mm256_unpackhi_epi8(v, zero));
+        __m256i r = _mm256_packus_epi16(lo, hi);
+
+        _mm256_storeu_si256((__m256i *)row, _mm256_or_si256(_mm256_and_si256(v, alpha_mask),
+                _mm256_andnot_si256(alpha_mask, r)));
+    }
+    premultiply32_sse2(row, width - x);
+}
+
+/* The quotient c * 255 / a is computed in single precision. Both operands
+ * are exact, and a non-integer quotient is at least 1/255 away from the next
+ * integer, which is more than the rounding error for quotients below 65536,
+ * so truncating gives the integer result. The low byte is kept, like the
+ * implicit conversion to BYTE in the scalar version. Transparent pixels are
+ * divided by 1 and restored afterwards. */
+static inline __m128i TARGET("sse2") unpremultiply_pixel_sse2(__m128i v)
+{
+    __m128 f = _mm_cvtepi32_ps(v);
+    __m128 a = _mm_max_ps(_mm_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3)), _mm_set1_ps(1.0f));
+
+    return _mm_cvttps_epi32(_mm_div_ps(_mm_mul_ps(f, _mm_set1_ps(255.0f)), a));
+}
+
+static void TARGET("sse2") unpremultiply32_sse2(BYTE *row, UINT width)
+{
+    const __m128i alpha_mask = _mm_set1_epi32(0xff000000);
+    const __m128i byte_mask = _mm_set1_epi32(0xff);
+    const __m128i zero = _mm_setzero_si128();
+    UINT x;
+
+    for (x = 0; x + 4 <= width; x += 4, row += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)row);
+        __m128i lo = _mm_unpacklo_epi8(v, zero), hi = _mm_unpackhi_epi8(v, zero);
+        __m128i p0, p1, p2, p3, keep;
+
+        p0 = _mm_and_si128(unpremultiply_pixel_sse2(_mm_unpacklo_epi16(lo, zero)), byte_mask);
+        p1 = _mm_and_si128(unpremultiply_pixel_sse2(_mm_unpackhi_epi16(lo, zero)), byte_mask);
+        p2 = _mm_and_si128(unpremultiply_pixel_sse2(_mm_unpacklo_epi16(hi, zero)), byte_mask);
+        p3 = _mm_and_si128(unpremultiply_pixel_sse2(_mm_unpackhi_epi16(hi, zero)), byte_mask);
+        p0 = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+
+        /* Transparent pixels and the alpha channel are left alone. */
+        keep = _mm_or_si128(_mm_cmpeq_epi32(_mm_and_si128(v, alpha_mask), zero), alpha_mask);
+        _mm_storeu_si128((__m128i *)row, _mm_or_si128(_mm_and_si128(keep, v), _mm_andnot_si128(keep, p0)));
+    }
+    unpremultiply32_c(row, width - x);
+}
+
+static inline __m256i TARGET("avx2") unpremultiply_pixels_avx2(const BYTE *row)
+{
+    __m256 f = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)row)));
+    __m256 a = _mm256_max_ps(_mm256_shuffle_ps(f, f, _MM_SHUFFLE(3, 3, 3, 3)), _mm256_set1_ps(1.0f));
+
+    return _mm256_and_si256(_mm256_cvttps_epi32(_mm256_div_ps(_mm256_mul_ps(f, _mm256_set1_ps(255.0f)), a)),
+            _mm256_set1_epi32(0xff));
+}
+
+static void TARGET("avx2") unpremultiply32_avx2(BYTE *row, UINT width)
+{
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    const __m256i alpha_mask = _mm256_set1_epi32(0xff000000);
+    const __m256i zero = _mm256_setzero_si256();
+    UINT x;
+
+    for (x = 0; x + 8 <= width; x += 8, row += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)row);
+        __m256i p01 = unpremultiply_pixels_avx2(row);
+        __m256i p23 = unpremultiply_pixels_avx2(row + 8);
+        __m256i p45 = unpremultiply_pixels_avx2(row + 16);
+        __m256i p67 = unpremultiply_pixels_avx2(row + 24);
+        __m256i r, keep;
+
+        /* Every lane holds one pixel of each pair, the packs leave pixels
+         * 0, 2, 4, 6 in the low lane and 1, 3, 5, 7 in the high lane. */
+        r = _mm256_packus_epi16(_mm256_packs_epi32(p01, p23), _mm256_packs_epi32(p45, p67));
+        r = _mm256_permutevar8x32_epi32(r, order);
+
+        keep = _mm256_or_si256(_mm256_cmpeq_epi32(_mm256_and_si256(v, alpha_mask), zero), alpha_mask);
+        _mm256_storeu_si256((__m256i *)row, _mm256_or_si256(_mm256_and_si256(keep, v),
+                _mm256_andnot_si256(keep, r)));
+    }
+    unpremultiply32_sse2(row, width - x);
+}
+
+static void TARGET("avx2") float_to_srgb8_avx2(const float *src, BYTE *dst, UINT width)
+{
+    const __m256 scale = _mm256_set1_ps(SRGB_LUT_SIZE);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 zero = _mm256_setzero_ps();
+    UINT x;
+
+    InitOnceExecuteOnce(&srgb_once, init_srgb_tables, NULL, NULL);
+
+    if (!srgb_lut_valid)
+    {
+        float_to_srgb8_c(src, dst, width);
+        return;
+    }
+
+    for (x = 0; x + 8 <= width; x += 8)
+    {
+        __m256 f = _mm256_loadu_ps(src + x);
+        __m256 in_range = _mm256_and_ps(_mm256_cmp_ps(f, zero, _CMP_GE_OQ), _mm256_cmp_ps(f, one, _CMP_LE_OQ));
+        __m256i value, next;
+        __m128i packed;
+
+        if (_mm256_movemask_ps(in_range) != 0xff)
+        {
+            float_to_srgb8_c(src + x, dst + x, 8);
+            continue;
+        }
+
+        value = _mm256_i32gather_epi32(srgb_lut, _mm256_cvttps_epi32(_mm256_mul_ps(f, scale)), 4);
+        next = _mm256_castps_si256(_mm256_cmp_ps(f, _mm256_i32gather_ps(srgb_thresholds + 1, value, 4),
+                _CMP_GE_OQ));
+        value = _mm256_sub_epi32(value, next);
+
+        packed = _mm_packs_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+        _mm_storel_epi64((__m128i *)(dst + x), _mm_packus_epi16(packed, packed));
+    }
+    float_to_srgb8_c(src + x, dst + x, width - x);
+}
+
+/* Two taps are interleaved per 16-bit lane pair, so that pmaddwd applies a
+ * pair of weights at once. */
+static inline __m128i TARGET("sse2") weight_pair_sse2(const short *weights, UINT k, UINT taps)
+{
+    UINT pair = (USHORT)weights[k];
+
+    if (k + 1 < taps)
+        pair |= (UINT)(USHORT)weights[k + 1] << 16;
+    return _mm_set1_epi32(pair);
+}
+
+static void TARGET("sse2") filter_rows_sse2(const BYTE * const *rows, const short *weights, UINT taps,
+        BYTE *dst, UINT size)
+{
+    const __m128i round = _mm_set1_epi32(1 << (FILTER_BITS - 1));
+    const __m128i zero = _mm_setzero_si128();
+    UINT x, k;
+
+    for (x = 0; x + 16 <= size; x += 16)
+    {
+        __m128i acc0 = round, acc1 = round, acc2 = round, acc3 = round;
+
+        for (k = 0; k < taps; k += 2)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i *)(rows[k] + x));
+            __m128i b = k + 1 < taps ? _mm_loadu_si128((const __m128i *)(rows[k + 1] + x)) : zero;
+            __m128i w = weight_pair_sse2(weights, k, taps);
+            __m128i lo = _mm_unpacklo_epi8(a, b), hi = _mm_unpackhi_epi8(a, b);
+
+            acc0 = _mm_add_epi32(acc0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), w));
+            acc1 = _mm_add_epi32(acc1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), w));
+            acc2 = _mm_add_epi32(acc2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), w));
+            acc3 = _mm_add_epi32(acc3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), w));
+        }
+
+        acc0 = _mm_packs_epi32(_mm_srai_epi32(acc0, FILTER_BITS), _mm_srai_epi32(acc1, FILTER_BITS));
+        acc2 = _mm_packs_epi32(_mm_srai_epi32(acc2, FILTER_BITS), _mm_srai_epi32(acc3, FILTER_BITS));
+        _mm_storeu_si128((__m128i *)(dst + x), _mm_packus_epi16(acc0, acc2));
+    }
+    filter_rows_range(rows, weights, taps, dst, x, size);
+}
+
+static void TARGET("sse2") filter_row32_sse2(const BYTE *src, UINT origin, const UINT *start,
+        const short *weights, UINT taps, BYTE *dst, UINT count)
+{
+    const __m128i round = _mm_set1_epi32(1 << (FILTER_BITS - 1));
+    const __m128i zero = _mm_setzero_si128();
+    UINT i, k;
+
+    for (i = 0; i < count; i++, weights += taps, dst += 4)
+    {
+        const BYTE *p = src + (start[i] - origin) * 4;
+        __m128i acc = round, v;
+
+        for (k = 0; k + 2 <= taps; k += 2)
+        {
+            v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(p + k * 4)), zero);
+            v = _mm_unpacklo_epi16(v, _mm_srli_si128(v, 8));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(v, weight_pair_sse2(weights, k, taps)));
+        }
+        if (k < taps)
+        {
+            v = _mm_unpacklo_epi8(_mm_cvtsi32_si128(*(const int *)(p + k * 4)), zero);
+            v = _mm_unpacklo_epi16(v, zero);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(v, weight_pair_sse2(weights, k, taps)));
+        }
+
+        acc = _mm_packs_epi32(_mm_srai_epi32(acc, FILTER_BITS), zero);
+        *(DWORD *)dst = _mm_cvtsi128_si32(_mm_packus_epi16(acc, zero));
+    }
+}
+
+#endif /* HAVE_X86_KERNELS */
+
+static struct pixel_kernels kernels =
+{
+    bgr24_to_bgra32_c,
+    rgb24_to_bgra32_c,
+    bgra32_to_bgr24_c,
+    rgba32_to_bgr24_c,
+    rgb48_to_bgra32_c,
+    rgba64_to_bgra32_c,
+    premultiply32_c,
+    unpremultiply32_c,
+    float_to_srgb8_c,
+    filter_rows_c,
+    filter_row32_c,
+};
+
+static INIT_ONCE kernels_once = INIT_ONCE_STATIC_INIT;
+
+static BOOL WINAPI init_kernels(INIT_ONCE *once, void *param, void **context)
+{
+#ifdef HAVE_X86_KERNELS
+    if (IsProcessorFeaturePresent(PF_XMMI64_INSTRUCTIONS_AVAILABLE))
+    {
+        TRACE("Using SSE2 kernels.\n");
+        kernels.rgba64_to_bgra32 = rgba64_to_bgra32_sse2;
+        kernels.premultiply32 = premultiply32_sse2;
+        kernels.unpremultiply32 = unpremultiply32_sse2;
+        kernels.filter_rows = filter_rows_sse2;
+        kernels.filter_row32 = filter_row32_sse2;
+    }
+    if (IsProcessorFeaturePresent(PF_SSSE3_INSTRUCTIONS_AVAILABLE))
+    {
+        TRACE("Using SSSE3 kernels.\n");
+        kernels.bgr24_to_bgra32 = bgr24_to_bgra32_ssse3;
+        kernels.rgb24_to_bgra32 = rgb24_to_bgra32_ssse3;
+        kernels.bgra32_to_bgr24 = bgra32_to_bgr24_ssse3;
+        kernels.rgba32_to_bgr24 = rgba32_to_bgr24_ssse3;
+        kernels.rgb48_to_bgra32 = rgb48_to_bgra32_ssse3;
+    }
+    if (IsProcessorFeaturePresent(PF_AVX2_INSTRUCTIONS_AVAILABLE))
+    {
+        TRACE("Using AVX2 kernels.\n");
+        kernels.premultiply32 = premultiply32_avx2;
+        kernels.unpremultiply32 = unpremultiply32_avx2;
+        kernels.float_to_srgb8 = float_to_srgb8_avx2;
+    }
+#endif
+    return TRUE;
+}
+
+const struct pixel_kernels *get_pixel_kernels(void)
+{
+    InitOnceExecuteOnce(&kernels_once, init_kernels, NULL, NULL);
+    return &kernels;
+}
@@ -18,6 +18,7 @@
  */
 
 #include <stdarg.h>
+#include <math.h>
 
 #define COBJMACROS
 
@@ -31,6 +32,15 @@
 
 WINE_DEFAULT_DEBUG_CHANNEL(wincodecs);
 
+/* Resampling weights for one dimension: output position i is the weighted
+ * sum of source positions start[i] .. start[i] + taps - 1. */
+struct filter_bank
+{
+    UINT taps;
+    UINT *start;
+    short *weights;
+};
+
 typedef struct BitmapScaler {
     IWICBitmapScaler IWICBitmapScaler_iface;
     LONG ref;
@@ -40,9 +50,12 @@ typedef struct BitmapScaler {
     UINT src_width, src_height;
     WICBitmapInterpolationMode mode;
     UINT bpp;
+    BOOL straight_alpha; /* filtered premultiplied, see filter_band() */
     void (*fn_get_required_source_rect)(struct BitmapScaler*,UINT,UINT,WICRect*);
     void (*fn_copy_scanline)(struct BitmapScaler*,UINT,UINT,UINT,BYTE**,UINT,UINT,BYTE*);
+    struct filter_bank filter_x, filter_y;
     CRITICAL_SECTION lock; /* must be held when initialized */
+    CRITICAL_SECTION source_lock; /* serializes source access from concurrent bands */
 } BitmapScaler;
 
 static inline BitmapScaler *impl_from_IWICBitmapScaler(IWICBitmapScaler *iface)
@@ -55,6 +68,152 @@ static inline BitmapScaler *impl_from_IMILBitmapScaler(IMILBitmapScaler *iface)
     return CONTAINING_RECORD(iface, BitmapScaler, IMILBitmapScaler_iface);
 }
 
+static void free_filter_bank(struct filter_bank *bank)
+{
+    free(bank->start);
+    free(bank->weights);
+    memset(bank, 0, sizeof(*bank));
+}
+
+static float linear_filter(float x)
+{
+    x = fabsf(x);
+    return x < 1.0f ? 1.0f - x : 0.0f;
+}
+
+/* Keys cubic convolution with a = -0.5 (Catmull-Rom). */
+static float cubic_filter(float x)
+{
+    x = fabsf(x);
+    if (x < 1.0f) return (1.5f * x - 2.5f) * x * x + 1.0f;
+    if (x < 2.0f) return ((-0.5f * x + 2.5f) * x - 4.0f) * x + 2.0f;
+    return 0.0f;
+}
+
+/* Computes the source taps and weights for every destination position along
+ * one dimension. Samples are taken at pixel centres. Linear and Cubic
+ * interpolate between the nearest source pixels. HighQualityCubic widens the
+ * cubic kernel by the reduction factor when downscaling. Fant averages the
+ * source area covered by each destination pixel. Taps beyond the edges are
+ * folded onto the edge pixels, so every window lies within the source. */
+static HRESULT build_filter_bank(struct filter_bank *bank, UINT dst_size, UINT src_size,
+    WICBitmapInterpolationMode mode)
+{
+    double scale = (double)src_size / dst_size;
+    float (*filter)(float) = NULL;
+    double filter_scale = 1.0, support;
+    float *tmp;
+    UINT i, k;
+
+    switch (mode)
+    {
+    case WICBitmapInterpolationModeLinear:
+        filter = linear_filter;
+        support = 1.0;
+        break;
+    case WICBitmapInterpolationModeCubic:
+        filter = cubic_filter;
+        support = 2.0;
+        break;
+    case WICBitmapInterpolationModeHighQualityCubic:
+        filter = cubic_filter;
+        if (scale > 1.0) filter_scale = scale;
+        support = 2.0 * filter_scale;
+        break;
+    default: /* Fant */
+        support = scale / 2.0 + 0.5;
+        break;
+    }
+
+    bank->taps = min((UINT)ceil(support * 2.0) + 1, src_size);
+    bank->start = malloc(dst_size * sizeof(*bank->start));
+    bank->weights = malloc(dst_size * bank->taps * sizeof(*bank->weights));
+    tmp = malloc(bank->taps * sizeof(*tmp));
+    if (!bank->start || !bank->weights || !tmp)
+    {
+        free(tmp);
+        free_filter_bank(bank);
+        return E_OUTOFMEMORY;
+    }
+
+    for (i = 0; i < dst_size; i++)
+    {
+        double center = (i + 0.5) * scale;
+        int j, first = floor(center - support) - 1, last = ceil(center + support) + 1;
+        int base = max(0, min((int)floor(center - support), (int)(src_size - bank->taps)));
+        short *weights = bank->weights + i * bank->taps;
+        float sum = 0.0f, w;
+        int total = 0;
+        UINT largest = 0;
+
+        memset(tmp, 0, bank->taps * sizeof(*tmp));
+
+        for (j = first; j <= last; j++)
+        {
+            if (filter)
+                w = filter((j + 0.5 - center) / filter_scale);
+            else
+                w = max(0.0, min(j + 1.0, center + scale / 2.0) - max((double)j, center - scale / 2.0));
+            if (w == 0.0f) continue;
+
+            /* Windows are placed so that the clamped taps always fit. */
+            k = max(0, min(j, (int)src_size - 1)) - base;
+            if (k >= bank->taps)
+            {
+                ERR("Tap %d outside of window %d+%u.\n", j, base, bank->taps);
+                continue;
+            }
+            tmp[k] += w;
+            sum += w;
+        }
+
+        bank->start[i] = base;
+        for (k = 0; k < bank->taps; k++)
+        {
+            weights[k] = sum != 0.0f ? floorf(tmp[k] / sum * (1 << FILTER_BITS) + 0.5f) : 0;
+            total += weights[k];
+            if (weights[k] > weights[largest]) largest = k;
+        }
+        /* Make the weights add up to exactly one, so that flat areas stay flat. */
+        weights[largest] += (1 << FILTER_BITS) - total;
+    }
+
+    free(tmp);
+    return S_OK;
+}
+
+static HRESULT init_filter_banks(BitmapScaler *This, WICBitmapInterpolationMode mode)
+{
+    HRESULT hr;
+
+    if (SUCCEEDED(hr = build_filter_bank(&This->filter_x, This->width, This->src_width, mode))
+            && FAILED(hr = build_filter_bank(&This->filter_y, This->height, This->src_height, mode)))
+        free_filter_bank(&This->filter_x);
+    return hr;
+}
+
+/* Formats with one byte per channel, which can be filtered channel by channel. */
+static BOOL is_filterable_format(const WICPixelFormatGUID *format)
+{
+    static const WICPixelFormatGUID *formats[] =
+    {
+        &GUID_WICPixelFormat8bppGray,
+        &GUID_WICPixelFormat24bppBGR,
+        &GUID_WICPixelFormat24bppRGB,
+        &GUID_WICPixelFormat32bppBGR,
+        &GUID_WICPixelFormat32bppBGRA,
+        &GUID_WICPixelFormat32bppPBGRA,
+        &GUID_WICPixelFormat32bppRGB,
+        &GUID_WICPixelFormat32bppRGBA,
+        &GUID_WICPixelFormat32bppPRGBA,
+    };
+    UINT i;
+
+    for (i = 0; i < ARRAY_SIZE(formats); i++)
+        if (IsEqualGUID(format, formats[i])) return TRUE;
+    return FALSE;
+}
+
 static HRESULT WINAPI BitmapScaler_QueryInterface(IWICBitmapScaler *iface, REFIID iid,
     void **ppv)
 {
@@ -105,7 +264,11 @@ static ULONG WINAPI BitmapScaler_Release(IWICBitmapScaler *iface)
     {
         This->lock.DebugInfo->Spare[0] = 0;
         DeleteCriticalSection(&This->lock);
+        This->source_lock.DebugInfo->Spare[0] = 0;
+        DeleteCriticalSection(&This->source_lock);
         if (This->source) IWICBitmapSource_Release(This->source);
+        free_filter_bank(&This->filter_x);
+        free_filter_bank(&This->filter_y);
         free(This);
     }
 
@@ -203,6 +366,169 @@ static void NearestNeighbor_CopyScanline(BitmapScaler *This,
     }
 }
 
+/* Number of source rows requested from the source at once. */
+#define FILTER_CHUNK_ROWS 16
+
+struct filter_bands_context
+{
+    BitmapScaler *scaler;
+    const WICRect *dest_rect;
+    UINT stride;
+    BYTE *buffer;
+};
+
+static void filter_row(BitmapScaler *This, const BYTE *src, UINT origin, UINT first, UINT count, BYTE *dst)
+{
+    const struct filter_bank *bank = &This->filter_x;
+    const short *weights = bank->weights + first * bank->taps;
+    UINT bytesperpixel = This->bpp / 8;
+    UINT i, k, c;
+
+    if (bytesperpixel == 4)
+    {
+        get_pixel_kernels()->filter_row32(src, origin, bank->start + first, weights, bank->taps, dst, count);
+        return;
+    }
+
+    for (i = 0; i < count; i++, weights += bank->taps)
+    {
+        const BYTE *p = src + (bank->start[first + i] - origin) * bytesperpixel;
+
+        for (c = 0; c < bytesperpixel; c++)
+        {
+            int sum = 1 << (FILTER_BITS - 1);
+
+            for (k = 0; k < bank->taps; k++)
+                sum += p[k * bytesperpixel + c] * weights[k];
+            sum >>= FILTER_BITS;
+            *dst++ = sum < 0 ? 0 : sum > 255 ? 255 : sum;
+        }
+    }
+}
+
+/* Cubic filters overshoot, so a filtered premultiplied colour may exceed its
+ * alpha, which unpremultiply32 doesn't expect. */
+static void clamp_to_alpha(BYTE *row, UINT width)
+{
+    UINT x;
+
+    for (x = 0; x < width; x++, row += 4)
+    {
+        row[0] = min(row[0], row[3]);
+        row[1] = min(row[1], row[3]);
+        row[2] = min(row[2], row[3]);
+    }
+}
+
+/* Produces destination rows [y, y + height) of the requested rectangle.
+ * Horizontally filtered source rows are kept in a ring of taps +
+ * FILTER_CHUNK_ROWS rows, and only the source rows that contribute to the band
+ * are requested from the source. Straight alpha is premultiplied before
+ * filtering, so transparent pixels don't bleed their colour into the
+ * result. */
+static HRESULT filter_band(void *ctx, UINT y, UINT height)
+{
+    struct filter_bands_context *context = ctx;
+    BitmapScaler *This = context->scaler;
+    const struct pixel_kernels *kernels = get_pixel_kernels();
+    const struct filter_bank *bank_x = &This->filter_x, *bank_y = &This->filter_y;
+    UINT dst_x = context->dest_rect->X, dst_y = context->dest_rect->Y + y;
+    UINT width = context->dest_rect->Width;
+    UINT bytesperpixel = This->bpp / 8;
+    UINT ring_stride = width * bytesperpixel, ring_rows = bank_y->taps + FILTER_CHUNK_ROWS;
+    UINT src_end, loaded, i, k;
+    UINT src_stride;
+    const BYTE **rows;
+    BYTE *ring, *chunk, *dst;
+    WICRect src_rect;
+    HRESULT hr = S_OK;
+
+    src_rect.X = bank_x->start[dst_x];
+    src_rect.Width = bank_x->start[dst_x + width - 1] + bank_x->taps - src_rect.X;
+    src_stride = src_rect.Width * bytesperpixel;
+    src_end = bank_y->start[dst_y + height - 1] + bank_y->taps;
+
+    ring = malloc(ring_rows * ring_stride);
+    chunk = malloc(FILTER_CHUNK_ROWS * src_stride);
+    rows = malloc(bank_y->taps * sizeof(*rows));
+    if (!ring || !chunk || !rows)
+    {
+        hr = E_OUTOFMEMORY;
+        goto done;
+    }
+
+    loaded = bank_y->start[dst_y];
+    for (i = 0; i < height; i++)
+    {
+        UINT first = bank_y->start[dst_y + i];
+
+        if (loaded < first)
+            loaded = first;
+
+        while (loaded < first + bank_y->taps)
+        {
+            UINT count = min(min(FILTER_CHUNK_ROWS, src_end - loaded), ring_rows - (loaded - first));
+
+            src_rect.Y = loaded;
+            src_rect.Height = count;
+            EnterCriticalSection(&This->source_lock);
+            hr = IWICBitmapSource_CopyPixels(This->source, &src_rect, src_stride, count * src_stride, chunk);
+            LeaveCriticalSection(&This->source_lock);
+            if (FAILED(hr))
+                goto done;
+            if (This->straight_alpha)
+                kernels->premultiply32(chunk, src_rect.Width * count);
+
+            for (k = 0; k < count; k++, loaded++)
+                filter_row(This, chunk + k * src_stride, src_rect.X, dst_x, width,
+                        ring + (loaded % ring_rows) * ring_stride);
+        }
+
+        for (k = 0; k < bank_y->taps; k++)
+            rows[k] = ring + ((first + k) % ring_rows) * ring_stride;
+        dst = context->buffer + context->stride * (y + i);
+        kernels->filter_rows(rows, bank_y->weights + (dst_y + i) * bank_y->taps, bank_y->taps,
+                dst, ring_stride);
+        if (This->straight_alpha)
+        {
+            clamp_to_alpha(dst, width);
+            kernels->unpremultiply32(dst, width);
+        }
+    }
+
+done:
+    free(rows);
+    free(chunk);
+    free(ring);
+    return hr;
+}
+
+struct scale_bands_context
+{
+    BitmapScaler *scaler;
+    const WICRect *dest_rect;
+    const WICRect *src_rect;
+    BYTE **src_rows;
+    UINT stride;
+    BYTE *buffer;
+};
+
+static HRESULT scale_band(void *ctx, UINT y, UINT height)
+{
+    struct scale_bands_context *context = ctx;
+    BitmapScaler *This = context->scaler;
+    UINT i;
+
+    for (i = y; i < y + height; i++)
+    {
+        This->fn_copy_scanline(This, context->dest_rect->X, context->dest_rect->Y+i,
+            context->dest_rect->Width, context->src_rows, context->src_rect->X, context->src_rect->Y,
+            context->buffer + context->stride * i);
+    }
+
+    return S_OK;
+}
+
 static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
     const WICRect *prc, UINT cbStride, UINT cbBufferSize, BYTE *pbBuffer)
 {
@@ -257,6 +583,29 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
         goto end;
     }
 
+    if (This->filter_x.weights)
+    {
+        struct filter_bands_context context;
+
+        if (!dest_rect.Width || !dest_rect.Height)
+        {
+            hr = S_OK;
+            goto end;
+        }
+
+        /* Each band pulls only the source rows it needs, which would make
+         * sources decoded on demand restart or decode the whole frame. */
+        context.scaler = This;
+        context.dest_rect = &dest_rect;
+        context.stride = cbStride;
+        context.buffer = pbBuffer;
+        if (bitmap_source_is_sequential(This->source))
+            hr = filter_band(&context, 0, dest_rect.Height);
+        else
+            hr = process_bands(dest_rect.Width, dest_rect.Height, filter_band, &context);
+        goto end;
+    }
+
     /* MSDN recommends calling CopyPixels once for each scanline from top to
      * bottom, and claims codecs optimize for this. Ideally, when called in this
      * way, we should avoid requesting a scanline from the source more than
@@ -296,11 +645,15 @@ static HRESULT WINAPI BitmapScaler_CopyPixels(IWICBitmapScaler *iface,
 
     if (SUCCEEDED(hr))
     {
-        for (y=0; y < dest_rect.Height; y++)
-        {
-            This->fn_copy_scanline(This, dest_rect.X, dest_rect.Y+y, dest_rect.Width,
-                src_rows, src_rect.X, src_rect.Y, pbBuffer + cbStride * y);
-        }
+        struct scale_bands_context context;
+
+        context.scaler = This;
+        context.dest_rect = &dest_rect;
+        context.src_rect = &src_rect;
+        context.src_rows = src_rows;
+        context.stride = cbStride;
+        context.buffer = pbBuffer;
+        hr = process_bands(dest_rect.Width, dest_rect.Height, scale_band, &context);
     }
 
     free(src_rows);
@@ -347,14 +700,49 @@ static HRESULT WINAPI BitmapScaler_Initialize(IWICBitmapScaler *iface,
         hr = get_pixelformat_bpp(&src_pixelformat, &This->bpp);
     }
 
+    This->straight_alpha = FALSE;
+
     if (SUCCEEDED(hr))
     {
         switch (mode)
         {
+        case WICBitmapInterpolationModeLinear:
+        case WICBitmapInterpolationModeCubic:
+        case WICBitmapInterpolationModeFant:
+        case WICBitmapInterpolationModeHighQualityCubic:
+            if (is_filterable_format(&src_pixelformat))
+            {
+                IWICBitmapSource_AddRef(pISource);
+                This->source = pISource;
+                This->straight_alpha = IsEqualGUID(&src_pixelformat, &GUID_WICPixelFormat32bppBGRA) ||
+                        IsEqualGUID(&src_pixelformat, &GUID_WICPixelFormat32bppRGBA);
+            }
+            else if ((This->bpp % 8) != 0)
+            {
+                hr = WICConvertBitmapSource(&GUID_WICPixelFormat32bppBGRA,
+                    pISource, &This->source);
+                This->bpp = 32;
+                This->straight_alpha = TRUE;
+            }
+            else
+            {
+                FIXME("mode %i is not supported for %s, using nearest neighbor\n",
+                    mode, debugstr_guid(&src_pixelformat));
+                goto nearest_neighbor;
+            }
+            if (SUCCEEDED(hr))
+                hr = init_filter_banks(This, mode);
+            if (FAILED(hr) && This->source)
+            {
+                IWICBitmapSource_Release(This->source);
+                This->source = NULL;
+            }
+            break;
         default:
             FIXME("unsupported mode %i\n", mode);
             /* fall-through */
         case WICBitmapInterpolationModeNearestNeighbor:
+nearest_neighbor:
             if ((This->bpp % 8) == 0)
             {
                 IWICBitmapSource_AddRef(pISource);
@@ -527,8 +915,12 @@ HRESULT BitmapScaler_Create(IWICBitmapScaler **scaler)
     This->src_height = 0;
     This->mode = 0;
     This->bpp = 0;
+    memset(&This->filter_x, 0, sizeof(This->filter_x));
+    memset(&This->filter_y, 0, sizeof(This->filter_y));
     InitializeCriticalSectionEx(&This->lock, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
     This->lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.lock");
+    InitializeCriticalSectionEx(&This->source_lock, 0, RTL_CRITICAL_SECTION_FLAG_FORCE_DEBUG_INFO);
+    This->source_lock.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": BitmapScaler.source_lock");
 
     *scaler = &This->IWICBitmapScaler_iface;
 
@@ -274,6 +274,7 @@ typedef struct StreamOnFileHandle {
     IStream IStream_iface;
     LONG ref;
 
+    HANDLE file; /* only set if owned by the stream */
     HANDLE map;
     void *mem;
     IWICStream *stream;
@@ -326,6 +327,7 @@ static ULONG WINAPI StreamOnFileHandle_Release(IStream *iface)
         IWICStream_Release(This->stream);
         UnmapViewOfFile(This->mem);
         CloseHandle(This->map);
+        if (This->file) CloseHandle(This->file);
         free(This);
     }
     return ref;
@@ -934,6 +936,8 @@ static HRESULT WINAPI IWICStreamImpl_InitializeFromIStream(IWICStream *iface, IS
     return hr;
 }
 
+static HRESULT initialize_from_filehandle(IWICStreamImpl *This, HANDLE file, BOOL owned);
+
 static HRESULT WINAPI IWICStreamImpl_InitializeFromFilename(IWICStream *iface,
     LPCWSTR wzFileName, DWORD dwDesiredAccess)
 {
@@ -953,6 +957,24 @@ static HRESULT WINAPI IWICStreamImpl_InitializeFromFilename(IWICStream *iface,
     else
         return E_INVALIDARG;
 
+    if (!(dwDesiredAccess & GENERIC_WRITE))
+    {
+        /* Decoders seek and read in small pieces, serve them from a mapping
+         * of the file instead of going through the file handle each time. */
+        HANDLE file = CreateFileW(wzFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0, NULL);
+
+        if (file == INVALID_HANDLE_VALUE) return HRESULT_FROM_WIN32(GetLastError());
+
+        hr = initialize_from_filehandle(This, file, TRUE);
+        if (SUCCEEDED(hr)) return hr;
+
+        CloseHandle(file);
+        if (hr == WINCODEC_ERR_WRONGSTATE) return hr;
+
+        /* e.g. empty files can't be mapped */
+        TRACE("Failed to map file, hr %#lx.\n", hr);
+    }
+
     hr = SHCreateStreamOnFileW(wzFileName, dwMode, &stream);
 
     if (SUCCEEDED(hr))
@@ -1036,16 +1058,16 @@ static HRESULT map_file(HANDLE file, HANDLE *map, void **mem, LARGE_INTEGER *siz
     return S_OK;
 }
 
-HRESULT stream_initialize_from_filehandle(IWICStream *iface, HANDLE file)
+/* The file handle is only closed with the stream if owned is set and
+ * initialization succeeds. */
+static HRESULT initialize_from_filehandle(IWICStreamImpl *This, HANDLE file, BOOL owned)
 {
-    IWICStreamImpl *This = impl_from_IWICStream(iface);
     StreamOnFileHandle *pObject;
     IWICStream *stream = NULL;
     HANDLE map;
     void *mem;
     LARGE_INTEGER size;
     HRESULT hr;
-    TRACE("(%p,%p)\n", iface, file);
 
     if (This->pStream) return WINCODEC_ERR_WRONGSTATE;
 
@@ -1066,6 +1088,7 @@ HRESULT stream_initialize_from_filehandle(IWICStream *iface, HANDLE file)
     }
     pObject->IStream_iface.lpVtbl = &StreamOnFileHandle_Vtbl;
     pObject->ref = 1;
+    pObject->file = owned ? file : NULL;
     pObject->map = map;
     pObject->mem = mem;
     pObject->stream = stream;
@@ -1073,6 +1096,7 @@ HRESULT stream_initialize_from_filehandle(IWICStream *iface, HANDLE file)
     if (InterlockedCompareExchangePointer((void**)&This->pStream, pObject, NULL))
     {
         /* Some other thread set the stream first. */
+        pObject->file = NULL;
         IStream_Release(&pObject->IStream_iface);
         return WINCODEC_ERR_WRONGSTATE;
     }
@@ -1085,6 +1109,13 @@ error:
     return hr;
 }
 
+HRESULT stream_initialize_from_filehandle(IWICStream *iface, HANDLE file)
+{
+    TRACE("(%p,%p)\n", iface, file);
+
+    return initialize_from_filehandle(impl_from_IWICStream(iface), file, FALSE);
+}
+
 static HRESULT WINAPI IWICStreamImpl_InitializeFromIStreamRegion(IWICStream *iface,
     IStream *pIStream, ULARGE_INTEGER ulOffset, ULARGE_INTEGER ulMaxSize)
 {
@@ -1167,3 +1198,40 @@ HRESULT StreamImpl_Create(IWICStream **stream)
 
     return S_OK;
 }
+
+/* Returns the memory backing streams created on memory or on a mapped file,
+ * so that decoders can read it in place. It remains valid for the lifetime
+ * of the stream. */
+BOOL stream_get_buffer(IStream *iface, const BYTE **data, ULONGLONG *size)
+{
+    if (iface->lpVtbl == (const IStreamVtbl *)&WICStream_Vtbl)
+    {
+        IWICStreamImpl *This = impl_from_IWICStream((IWICStream *)iface);
+        return This->pStream && stream_get_buffer(This->pStream, data, size);
+    }
+    else if (iface->lpVtbl == &StreamOnMemory_Vtbl)
+    {
+        StreamOnMemory *This = StreamOnMemory_from_IStream(iface);
+        *data = This->pbMemory;
+        *size = This->dwMemsize;
+        return TRUE;
+    }
+    else if (iface->lpVtbl == &StreamOnFileHandle_Vtbl)
+    {
+        StreamOnFileHandle *This = StreamOnFileHandle_from_IStream(iface);
+        return stream_get_buffer((IStream *)This->stream, data, size);
+    }
+    else if (iface->lpVtbl == &StreamOnStreamRange_Vtbl)
+    {
+        StreamOnStreamRange *This = StreamOnStreamRange_from_IStream(iface);
+        ULONGLONG offset;
+
+        if (!stream_get_buffer(This->stream, data, size)) return FALSE;
+        offset = min(This->offset.QuadPart, *size);
+        *data += offset;
+        *size = min(*size - offset, This->max_size.QuadPart);
+        return TRUE;
+    }
+
+    return FALSE;
+}
@@ -1318,6 +1318,180 @@ static void test_bitmap_scaler(void)
     IWICBitmap_Release(bitmap);
 }
 
+static void test_bitmap_scaler_modes(void)
+{
+    static const WICBitmapInterpolationMode modes[] =
+    {
+        WICBitmapInterpolationModeNearestNeighbor,
+        WICBitmapInterpolationModeLinear,
+        WICBitmapInterpolationModeCubic,
+        WICBitmapInterpolationModeFant,
+    };
+    BYTE src[16 * 8 * 4], dst[8 * 4 * 4];
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    UINT i, j;
+    HRESULT hr;
+
+    for (i = 0; i < sizeof(src); i += 4)
+    {
+        src[i] = 0x20;
+        src[i + 1] = 0x40;
+        src[i + 2] = 0x80;
+        src[i + 3] = 0xff;
+    }
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 16, 8, &GUID_WICPixelFormat32bppBGRA,
+        16 * 4, sizeof(src), src, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    /* Filtering a single colour must not change it. */
+    for (i = 0; i < ARRAY_SIZE(modes); ++i)
+    {
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 5, 3, modes[i]);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+        memset(dst, 0, sizeof(dst));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 5 * 4, 5 * 3 * 4, dst);
+        ok(hr == S_OK, "Mode %u: unexpected hr %#lx.\n", modes[i], hr);
+        for (j = 0; j < 5 * 3 * 4; j += 4)
+        {
+            ok(dst[j] == 0x20 && dst[j + 1] == 0x40 && dst[j + 2] == 0x80 && dst[j + 3] == 0xff,
+                "Mode %u, pixel %u: got %02x%02x%02x%02x.\n", modes[i], j / 4,
+                dst[j + 3], dst[j + 2], dst[j + 1], dst[j]);
+        }
+
+        IWICBitmapScaler_Release(scaler);
+    }
+
+    IWICBitmap_Release(bitmap);
+
+    /* Fant averages the covered source area. */
+    for (i = 0; i < sizeof(src); i += 4)
+        src[i] = src[i + 1] = src[i + 2] = (i / 4) % 2 ? 0xff : 0x00;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, 16, 8, &GUID_WICPixelFormat32bppBGRA,
+        16 * 4, sizeof(src), src, &bitmap);
+    ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+
+    hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+    ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+
+    hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, 8, 4, WICBitmapInterpolationModeFant);
+    ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+    hr = IWICBitmapScaler_CopyPixels(scaler, NULL, 8 * 4, sizeof(dst), dst);
+    ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+    for (j = 0; j < sizeof(dst); j += 4)
+        ok(abs(dst[j] - 0x80) <= 1 && dst[j + 3] == 0xff, "Pixel %u: got %02x%02x%02x%02x.\n",
+            j / 4, dst[j + 3], dst[j + 2], dst[j + 1], dst[j]);
+
+    IWICBitmapScaler_Release(scaler);
+    IWICBitmap_Release(bitmap);
+}
+
+static void test_bitmap_scaler_filters(void)
+{
+    static const BYTE step4[] = {0x00, 0x00, 0xff, 0xff};
+    static const BYTE step8[] = {0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xff};
+    static const struct
+    {
+        WICBitmapInterpolationMode mode;
+        const BYTE *src;
+        UINT src_width, dst_width;
+        BYTE expected[8];
+    }
+    tests[] =
+    {
+        {WICBitmapInterpolationModeLinear,           step4, 4, 8, {0x00, 0x00, 0x00, 0x40, 0xbf, 0xff, 0xff, 0xff}},
+        {WICBitmapInterpolationModeCubic,            step4, 4, 8, {0x00, 0x00, 0x00, 0x34, 0xcb, 0xff, 0xff, 0xff}},
+        {WICBitmapInterpolationModeHighQualityCubic, step4, 4, 8, {0x00, 0x00, 0x00, 0x34, 0xcb, 0xff, 0xff, 0xff}},
+        {WICBitmapInterpolationModeLinear,           step8, 8, 4, {0x00, 0x00, 0xff, 0xff}},
+        {WICBitmapInterpolationModeCubic,            step8, 8, 4, {0x00, 0x00, 0xff, 0xff}},
+        /* The kernel is widened when downscaling. */
+        {WICBitmapInterpolationModeHighQualityCubic, step8, 8, 4, {0x00, 0x11, 0xee, 0xff}},
+    };
+    BYTE src[8 * 4], dst[8 * 4];
+    IWICBitmapScaler *scaler;
+    IWICBitmap *bitmap;
+    UINT i, j;
+    HRESULT hr;
+
+    for (i = 0; i < ARRAY_SIZE(tests); ++i)
+    {
+        winetest_push_context("Test %u", i);
+
+        for (j = 0; j < tests[i].src_width; ++j)
+        {
+            src[j * 4] = src[j * 4 + 1] = src[j * 4 + 2] = tests[i].src[j];
+            src[j * 4 + 3] = 0xff;
+        }
+        hr = IWICImagingFactory_CreateBitmapFromMemory(factory, tests[i].src_width, 1,
+            &GUID_WICPixelFormat32bppBGRA, tests[i].src_width * 4, tests[i].src_width * 4, src, &bitmap);
+        ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, tests[i].dst_width, 1, tests[i].mode);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+        memset(dst, 0xcc, sizeof(dst));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, tests[i].dst_width * 4, tests[i].dst_width * 4, dst);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+        for (j = 0; j < tests[i].dst_width; ++j)
+        {
+            BYTE expected = tests[i].expected[j];
+
+            ok(abs(dst[j * 4] - expected) <= 1 && abs(dst[j * 4 + 1] - expected) <= 1
+                && abs(dst[j * 4 + 2] - expected) <= 1 && dst[j * 4 + 3] == 0xff,
+                "Pixel %u: got %02x%02x%02x%02x, expected ff%02x%02x%02x.\n", j,
+                dst[j * 4 + 3], dst[j * 4 + 2], dst[j * 4 + 1], dst[j * 4], expected, expected, expected);
+        }
+
+        IWICBitmapScaler_Release(scaler);
+        IWICBitmap_Release(bitmap);
+
+        /* With an opaque red half and a transparent green half, alpha is
+         * filtered like the colour above, and the green of the transparent
+         * pixels doesn't bleed into the result. */
+        for (j = 0; j < tests[i].src_width; ++j)
+        {
+            src[j * 4] = 0x00;
+            src[j * 4 + 1] = tests[i].src[j];
+            src[j * 4 + 2] = 0xff - tests[i].src[j];
+            src[j * 4 + 3] = 0xff - tests[i].src[j];
+        }
+        hr = IWICImagingFactory_CreateBitmapFromMemory(factory, tests[i].src_width, 1,
+            &GUID_WICPixelFormat32bppBGRA, tests[i].src_width * 4, tests[i].src_width * 4, src, &bitmap);
+        ok(hr == S_OK, "Failed to create a bitmap, hr %#lx.\n", hr);
+        hr = IWICImagingFactory_CreateBitmapScaler(factory, &scaler);
+        ok(hr == S_OK, "Failed to create bitmap scaler, hr %#lx.\n", hr);
+        hr = IWICBitmapScaler_Initialize(scaler, (IWICBitmapSource *)bitmap, tests[i].dst_width, 1, tests[i].mode);
+        ok(hr == S_OK, "Failed to initialize bitmap scaler, hr %#lx.\n", hr);
+
+        memset(dst, 0xcc, sizeof(dst));
+        hr = IWICBitmapScaler_CopyPixels(scaler, NULL, tests[i].dst_width * 4, tests[i].dst_width * 4, dst);
+        ok(hr == S_OK, "Unexpected hr %#lx.\n", hr);
+        for (j = 0; j < tests[i].dst_width; ++j)
+        {
+            BYTE alpha = 0xff - tests[i].expected[j];
+
+            ok(abs(dst[j * 4 + 3] - alpha) <= 1, "Pixel %u: got alpha %02x, expected %02x.\n",
+                j, dst[j * 4 + 3], alpha);
+            if (!dst[j * 4 + 3]) continue;
+            ok(dst[j * 4] == 0x00 && dst[j * 4 + 1] == 0x00 && dst[j * 4 + 2] >= 0xfe,
+                "Pixel %u: got %02x%02x%02x%02x.\n", j, dst[j * 4 + 3], dst[j * 4 + 2], dst[j * 4 + 1], dst[j * 4]);
+        }
+
+        IWICBitmapScaler_Release(scaler);
+        IWICBitmap_Release(bitmap);
+
+        winetest_pop_context();
+    }
+}
+
 static LONG obj_refcount(void *obj)
 {
     IUnknown_AddRef((IUnknown *)obj);
@@ -1494,6 +1668,8 @@ START_TEST(bitmap)
     test_CreateBitmapFromHBITMAP();
     test_clipper();
     test_bitmap_scaler();
+    test_bitmap_scaler_modes();
+    test_bitmap_scaler_filters();
 
     IWICImagingFactory_Release(factory);
 
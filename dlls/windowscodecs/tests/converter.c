@@ -2020,6 +2020,214 @@ static void test_converter_8bppIndexed(void)
     DeleteTestBitmap(src_obj);
 }
 
+static void test_converter_large(void)
+{
+    static const UINT width = 1024, height = 768;
+    BYTE *src, *dst, *expected;
+    IWICFormatConverter *converter;
+    IWICBitmap *bitmap;
+    WICRect rc;
+    UINT i;
+    HRESULT hr;
+
+    src = malloc(width * height * 8);
+    dst = malloc(width * height * 4);
+    expected = malloc(width * height * 4);
+    for (i = 0; i < width * height * 8; ++i)
+        src[i] = i * 7 + i / 13;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, width, height, &GUID_WICPixelFormat64bppRGBA,
+            width * 8, width * height * 8, src, &bitmap);
+    ok(hr == S_OK, "CreateBitmapFromMemory error %#lx\n", hr);
+
+    hr = IWICImagingFactory_CreateFormatConverter(factory, &converter);
+    ok(hr == S_OK, "CreateFormatConverter error %#lx\n", hr);
+    hr = IWICFormatConverter_Initialize(converter, (IWICBitmapSource *)bitmap, &GUID_WICPixelFormat32bppPBGRA,
+            WICBitmapDitherTypeNone, NULL, 0.0, WICBitmapPaletteTypeCustom);
+    ok(hr == S_OK, "Initialize error %#lx\n", hr);
+
+    /* Large requests may be processed in parallel bands, the result should
+     * match converting one row at a time. */
+    rc.X = 0;
+    rc.Width = width;
+    rc.Height = 1;
+    for (rc.Y = 0; rc.Y < height; ++rc.Y)
+    {
+        hr = IWICFormatConverter_CopyPixels(converter, &rc, width * 4, width * 4, expected + rc.Y * width * 4);
+        ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+    }
+
+    memset(dst, 0xcc, width * height * 4);
+    hr = IWICFormatConverter_CopyPixels(converter, NULL, width * 4, width * height * 4, dst);
+    ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+    ok(!memcmp(dst, expected, width * height * 4), "Got unexpected data.\n");
+
+    IWICFormatConverter_Release(converter);
+    IWICBitmap_Release(bitmap);
+    free(expected);
+    free(dst);
+    free(src);
+}
+
+static void test_converter_odd_width(void)
+{
+    static const UINT width = 37, height = 3;
+    BYTE src[37 * 3 * 3], dst[37 * 3 * 4];
+    IWICFormatConverter *converter;
+    IWICBitmap *bitmap;
+    UINT i, x, y;
+    HRESULT hr;
+
+    for (i = 0; i < sizeof(src); ++i)
+        src[i] = i * 11 + 3;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, width, height, &GUID_WICPixelFormat24bppBGR,
+            width * 3, sizeof(src), src, &bitmap);
+    ok(hr == S_OK, "CreateBitmapFromMemory error %#lx\n", hr);
+
+    hr = IWICImagingFactory_CreateFormatConverter(factory, &converter);
+    ok(hr == S_OK, "CreateFormatConverter error %#lx\n", hr);
+    hr = IWICFormatConverter_Initialize(converter, (IWICBitmapSource *)bitmap, &GUID_WICPixelFormat32bppBGRA,
+            WICBitmapDitherTypeNone, NULL, 0.0, WICBitmapPaletteTypeCustom);
+    ok(hr == S_OK, "Initialize error %#lx\n", hr);
+
+    /* Rows that are not a multiple of the vector width are converted in
+     * several steps, make sure none of the pixels get lost. */
+    memset(dst, 0xcc, sizeof(dst));
+    hr = IWICFormatConverter_CopyPixels(converter, NULL, width * 4, sizeof(dst), dst);
+    ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+
+    for (y = 0; y < height; ++y)
+    {
+        for (x = 0; x < width; ++x)
+        {
+            const BYTE *s = src + y * width * 3 + x * 3, *d = dst + y * width * 4 + x * 4;
+
+            ok(d[0] == s[0] && d[1] == s[1] && d[2] == s[2] && d[3] == 0xff,
+               "%u,%u: got %02x%02x%02x%02x\n", x, y, d[3], d[2], d[1], d[0]);
+        }
+    }
+
+    IWICFormatConverter_Release(converter);
+    IWICBitmap_Release(bitmap);
+}
+
+static void convert_pixels(const GUID *src_format, const void *src, UINT src_bpp, const GUID *dst_format,
+        void *dst, UINT dst_bpp, UINT width, UINT height)
+{
+    IWICFormatConverter *converter;
+    IWICBitmap *bitmap;
+    HRESULT hr;
+
+    hr = IWICImagingFactory_CreateBitmapFromMemory(factory, width, height, src_format,
+            width * src_bpp / 8, width * height * src_bpp / 8, (BYTE *)src, &bitmap);
+    ok(hr == S_OK, "CreateBitmapFromMemory error %#lx\n", hr);
+
+    hr = IWICImagingFactory_CreateFormatConverter(factory, &converter);
+    ok(hr == S_OK, "CreateFormatConverter error %#lx\n", hr);
+    hr = IWICFormatConverter_Initialize(converter, (IWICBitmapSource *)bitmap, dst_format,
+            WICBitmapDitherTypeNone, NULL, 0.0, WICBitmapPaletteTypeCustom);
+    ok(hr == S_OK, "Initialize error %#lx\n", hr);
+
+    memset(dst, 0xcc, width * height * dst_bpp / 8);
+    hr = IWICFormatConverter_CopyPixels(converter, NULL, width * dst_bpp / 8, width * height * dst_bpp / 8, dst);
+    ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+
+    IWICFormatConverter_Release(converter);
+    IWICBitmap_Release(bitmap);
+}
+
+static BYTE float_to_srgb8(float f)
+{
+    if (f <= 0.0031308f) f = 12.92f * f;
+    else f = 1.055f * powf(f, 1.0f / 2.4f) - 0.055f;
+    return floorf(f * 255.0f + 0.51f);
+}
+
+static void test_converter_row_kernels(void)
+{
+    /* Odd width, so that both the vector loops and the remainder are used. */
+    static const UINT width = 67, height = 3, count = 67 * 3;
+    BYTE src[67 * 3 * 8], dst[67 * 3 * 4], expected[4];
+    float src_float[67 * 3];
+    UINT i, j;
+
+    for (i = 0; i < sizeof(src); ++i)
+        src[i] = i * 13 + i / 7;
+
+    /* Premultiplication. */
+    for (i = 0; i < count; ++i)
+    {
+        if (i % 11 == 0) src[i * 4 + 3] = 0;
+        else if (i % 11 == 1) src[i * 4 + 3] = 0xff;
+    }
+    convert_pixels(&GUID_WICPixelFormat32bppBGRA, src, 32, &GUID_WICPixelFormat32bppPBGRA, dst, 32, width, height);
+    for (i = 0; i < count; ++i)
+    {
+        const BYTE *s = src + i * 4, *d = dst + i * 4;
+
+        for (j = 0; j < 3; ++j)
+            expected[j] = s[3] == 0xff ? s[j] : (s[j] * s[3] + 127) / 255;
+        expected[3] = s[3];
+        ok(!memcmp(d, expected, 4) || broken(abs(d[0] - expected[0]) <= 1 && abs(d[1] - expected[1]) <= 1
+                && abs(d[2] - expected[2]) <= 1 && d[3] == expected[3]),
+                "%u: got %02x%02x%02x%02x, expected %02x%02x%02x%02x\n", i, d[3], d[2], d[1], d[0],
+                expected[3], expected[2], expected[1], expected[0]);
+    }
+
+    /* Unpremultiplication, colour components don't exceed alpha. */
+    for (i = 0; i < count; ++i)
+    {
+        for (j = 0; j < 3; ++j)
+            src[i * 4 + j] %= src[i * 4 + 3] + 1;
+    }
+    convert_pixels(&GUID_WICPixelFormat32bppPBGRA, src, 32, &GUID_WICPixelFormat32bppBGRA, dst, 32, width, height);
+    for (i = 0; i < count; ++i)
+    {
+        const BYTE *s = src + i * 4, *d = dst + i * 4;
+
+        for (j = 0; j < 3; ++j)
+            expected[j] = s[3] == 0 || s[3] == 0xff ? s[j] : s[j] * 255 / s[3];
+        expected[3] = s[3];
+        ok(!memcmp(d, expected, 4) || broken(abs(d[0] - expected[0]) <= 1 && abs(d[1] - expected[1]) <= 1
+                && abs(d[2] - expected[2]) <= 1 && d[3] == expected[3]),
+                "%u: got %02x%02x%02x%02x, expected %02x%02x%02x%02x\n", i, d[3], d[2], d[1], d[0],
+                expected[3], expected[2], expected[1], expected[0]);
+    }
+
+    /* 16 bits per component, only the high bytes are kept. */
+    convert_pixels(&GUID_WICPixelFormat48bppRGB, src, 48, &GUID_WICPixelFormat32bppBGRA, dst, 32, width, height);
+    for (i = 0; i < count; ++i)
+    {
+        const BYTE *s = src + i * 6, *d = dst + i * 4;
+
+        ok(d[0] == s[5] && d[1] == s[3] && d[2] == s[1] && d[3] == 0xff,
+                "%u: got %02x%02x%02x%02x, expected ff%02x%02x%02x\n", i, d[3], d[2], d[1], d[0], s[1], s[3], s[5]);
+    }
+
+    convert_pixels(&GUID_WICPixelFormat64bppRGBA, src, 64, &GUID_WICPixelFormat32bppBGRA, dst, 32, width, height);
+    for (i = 0; i < count; ++i)
+    {
+        const BYTE *s = src + i * 8, *d = dst + i * 4;
+
+        ok(d[0] == s[5] && d[1] == s[3] && d[2] == s[1] && d[3] == s[7],
+                "%u: got %02x%02x%02x%02x, expected %02x%02x%02x%02x\n", i, d[3], d[2], d[1], d[0],
+                s[7], s[1], s[3], s[5]);
+    }
+
+    /* Linear floats to sRGB, covering both segments of the curve. */
+    for (i = 0; i < count; ++i)
+        src_float[i] = i < 16 ? i * 0.0005f : (float)i / (count - 1);
+    convert_pixels(&GUID_WICPixelFormat32bppGrayFloat, src_float, 32, &GUID_WICPixelFormat8bppGray, dst, 8, width, height);
+    for (i = 0; i < count; ++i)
+    {
+        BYTE value = float_to_srgb8(src_float[i]);
+
+        ok(dst[i] == value || broken(abs(dst[i] - value) <= 1), "%u: got %#x, expected %#x for %f\n",
+                i, dst[i], value, src_float[i]);
+    }
+}
+
 START_TEST(converter)
 {
     HRESULT hr;
@@ -2081,6 +2289,9 @@ START_TEST(converter)
     test_converter_4bppGray();
     test_converter_8bppGray();
     test_converter_8bppIndexed();
+    test_converter_large();
+    test_converter_odd_width();
+    test_converter_row_kernels();
 
     test_encoder(&testdata_8bppIndexed, &CLSID_WICGifEncoder,
                  &testdata_8bppIndexed, &CLSID_WICGifDecoder, "GIF encoder 8bppIndexed");
@@ -154,12 +154,168 @@ static void test_decode_adobe_cmyk(void)
     IWICImagingFactory_Release(factory);
 }
 
+static IStream *create_jpeg_stream(IWICImagingFactory *factory, UINT width, UINT height)
+{
+    IWICBitmapFrameEncode *frameencode;
+    IWICBitmapEncoder *encoder;
+    WICPixelFormatGUID format;
+    LARGE_INTEGER zero;
+    IStream *stream;
+    BYTE *data;
+    UINT x, y;
+    HRESULT hr;
+
+    data = malloc(width * height * 3);
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            data[(y * width + x) * 3] = x * 255 / width;
+            data[(y * width + x) * 3 + 1] = y * 255 / height;
+            data[(y * width + x) * 3 + 2] = 0x80;
+        }
+    }
+
+    hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+    ok(hr == S_OK, "CreateStreamOnHGlobal failed, hr %#lx.\n", hr);
+
+    hr = IWICImagingFactory_CreateEncoder(factory, &GUID_ContainerFormatJpeg, NULL, &encoder);
+    ok(hr == S_OK, "CreateEncoder failed, hr %#lx.\n", hr);
+    hr = IWICBitmapEncoder_Initialize(encoder, stream, WICBitmapEncoderNoCache);
+    ok(hr == S_OK, "Initialize failed, hr %#lx.\n", hr);
+    hr = IWICBitmapEncoder_CreateNewFrame(encoder, &frameencode, NULL);
+    ok(hr == S_OK, "CreateNewFrame failed, hr %#lx.\n", hr);
+    hr = IWICBitmapFrameEncode_Initialize(frameencode, NULL);
+    ok(hr == S_OK, "Initialize failed, hr %#lx.\n", hr);
+    hr = IWICBitmapFrameEncode_SetSize(frameencode, width, height);
+    ok(hr == S_OK, "SetSize failed, hr %#lx.\n", hr);
+    format = GUID_WICPixelFormat24bppBGR;
+    hr = IWICBitmapFrameEncode_SetPixelFormat(frameencode, &format);
+    ok(hr == S_OK, "SetPixelFormat failed, hr %#lx.\n", hr);
+    ok(IsEqualGUID(&format, &GUID_WICPixelFormat24bppBGR), "Unexpected format %s.\n", wine_dbgstr_guid(&format));
+    hr = IWICBitmapFrameEncode_WritePixels(frameencode, height, width * 3, width * height * 3, data);
+    ok(hr == S_OK, "WritePixels failed, hr %#lx.\n", hr);
+    hr = IWICBitmapFrameEncode_Commit(frameencode);
+    ok(hr == S_OK, "Commit failed, hr %#lx.\n", hr);
+    hr = IWICBitmapEncoder_Commit(encoder);
+    ok(hr == S_OK, "Commit failed, hr %#lx.\n", hr);
+
+    IWICBitmapFrameEncode_Release(frameencode);
+    IWICBitmapEncoder_Release(encoder);
+    free(data);
+
+    zero.QuadPart = 0;
+    IStream_Seek(stream, zero, STREAM_SEEK_SET, NULL);
+    return stream;
+}
+
+static void test_decode_bands(void)
+{
+    static const UINT width = 64, height = 40, stride = 64 * 3;
+    IWICBitmapSourceTransform *transform;
+    IWICBitmapFrameDecode *framedecode;
+    IWICImagingFactory *factory;
+    IWICBitmapDecoder *decoder;
+    WICPixelFormatGUID format;
+    BYTE *full, *bands;
+    UINT w, h, y;
+    IStream *stream;
+    BOOL supported;
+    WICRect rect;
+    HRESULT hr;
+
+    hr = CoCreateInstance(&CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER,
+        &IID_IWICImagingFactory, (void **)&factory);
+    ok(hr == S_OK, "CoCreateInstance failed, hr %#lx.\n", hr);
+
+    stream = create_jpeg_stream(factory, width, height);
+
+    hr = IWICImagingFactory_CreateDecoderFromStream(factory, stream, NULL, WICDecodeMetadataCacheOnDemand, &decoder);
+    ok(hr == S_OK, "CreateDecoderFromStream failed, hr %#lx.\n", hr);
+    hr = IWICBitmapDecoder_GetFrame(decoder, 0, &framedecode);
+    ok(hr == S_OK, "GetFrame failed, hr %#lx.\n", hr);
+
+    full = malloc(stride * height);
+    bands = malloc(stride * height);
+
+    /* Sequential bands, then random access, must match a full copy. */
+    memset(bands, 0xcc, stride * height);
+    rect.X = 0;
+    rect.Width = width;
+    rect.Height = 7;
+    for (rect.Y = 0; rect.Y < height; rect.Y += rect.Height)
+    {
+        rect.Height = min(7, height - rect.Y);
+        hr = IWICBitmapFrameDecode_CopyPixels(framedecode, &rect, stride,
+                stride * rect.Height, bands + rect.Y * stride);
+        ok(hr == S_OK, "CopyPixels failed, hr %#lx.\n", hr);
+    }
+
+    hr = IWICBitmapFrameDecode_CopyPixels(framedecode, NULL, stride, stride * height, full);
+    ok(hr == S_OK, "CopyPixels failed, hr %#lx.\n", hr);
+    ok(!memcmp(full, bands, stride * height), "Band data doesn't match.\n");
+
+    memset(bands, 0xcc, stride * height);
+    rect.Height = 1;
+    for (y = height; y > 0; y--)
+    {
+        rect.Y = y - 1;
+        hr = IWICBitmapFrameDecode_CopyPixels(framedecode, &rect, stride, stride, bands + rect.Y * stride);
+        ok(hr == S_OK, "CopyPixels failed, hr %#lx.\n", hr);
+    }
+    ok(!memcmp(full, bands, stride * height), "Reversed row data doesn't match.\n");
+
+    hr = IWICBitmapFrameDecode_QueryInterface(framedecode, &IID_IWICBitmapSourceTransform, (void **)&transform);
+    ok(hr == S_OK, "QueryInterface failed, hr %#lx.\n", hr);
+    if (hr == S_OK)
+    {
+        hr = IWICBitmapSourceTransform_DoesSupportTransform(transform, WICBitmapTransformRotate0, &supported);
+        ok(hr == S_OK, "DoesSupportTransform failed, hr %#lx.\n", hr);
+        ok(supported, "Rotate0 is not supported.\n");
+
+        format = GUID_WICPixelFormat32bppBGRA;
+        hr = IWICBitmapSourceTransform_GetClosestPixelFormat(transform, &format);
+        ok(hr == S_OK, "GetClosestPixelFormat failed, hr %#lx.\n", hr);
+        ok(IsEqualGUID(&format, &GUID_WICPixelFormat24bppBGR), "Unexpected format %s.\n", wine_dbgstr_guid(&format));
+
+        w = width;
+        h = height;
+        hr = IWICBitmapSourceTransform_GetClosestSize(transform, &w, &h);
+        ok(hr == S_OK, "GetClosestSize failed, hr %#lx.\n", hr);
+        ok(w == width && h == height, "Unexpected size %ux%u.\n", w, h);
+
+        hr = IWICBitmapSourceTransform_CopyPixels(transform, NULL, w, h, &format, WICBitmapTransformRotate0,
+                stride, stride * height, bands);
+        ok(hr == S_OK, "CopyPixels failed, hr %#lx.\n", hr);
+        ok(!memcmp(full, bands, stride * height), "Transform data doesn't match.\n");
+
+        w = width / 2 - 1;
+        h = height / 2 - 1;
+        hr = IWICBitmapSourceTransform_GetClosestSize(transform, &w, &h);
+        ok(hr == S_OK, "GetClosestSize failed, hr %#lx.\n", hr);
+        ok(w == width / 2 && h == height / 2, "Unexpected size %ux%u.\n", w, h);
+
+        hr = IWICBitmapSourceTransform_CopyPixels(transform, NULL, w, h, NULL, WICBitmapTransformRotate0,
+                stride, stride * h, bands);
+        ok(hr == S_OK, "CopyPixels failed, hr %#lx.\n", hr);
+
+        IWICBitmapSourceTransform_Release(transform);
+    }
+
+    free(full);
+    free(bands);
+    IWICBitmapFrameDecode_Release(framedecode);
+    IWICBitmapDecoder_Release(decoder);
+    IStream_Release(stream);
+    IWICImagingFactory_Release(factory);
+}
 
 START_TEST(jpegformat)
 {
     CoInitializeEx(NULL, COINIT_APARTMENTTHREADED);
 
     test_decode_adobe_cmyk();
+    test_decode_bands();
 
     CoUninitialize();
 }
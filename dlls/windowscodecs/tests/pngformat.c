@@ -733,8 +733,6 @@ static void test_color_formats(void)
         const GUID *format;
         const GUID *format_PLTE;
         const GUID *format_PLTE_tRNS;
-        BOOL todo;
-        BOOL todo_load;
     } td[] =
     {
         /* 2 - PNG_COLOR_TYPE_RGB */
@@ -743,12 +741,8 @@ static void test_color_formats(void)
         { 4, PNG_COLOR_TYPE_RGB, NULL, NULL, NULL },
         { 8, PNG_COLOR_TYPE_RGB,
           &GUID_WICPixelFormat24bppBGR, &GUID_WICPixelFormat24bppBGR, &GUID_WICPixelFormat24bppBGR },
-        /* libpng refuses to load our test image complaining about extra compressed data,
-         * but libpng is still able to load the image with other combination of type/depth
-         * making RGB 16 bpp case special for some reason. Therefore todo = TRUE.
-         */
         { 16, PNG_COLOR_TYPE_RGB,
-          &GUID_WICPixelFormat48bppRGB, &GUID_WICPixelFormat48bppRGB, &GUID_WICPixelFormat48bppRGB, TRUE, TRUE },
+          &GUID_WICPixelFormat48bppRGB, &GUID_WICPixelFormat48bppRGB, &GUID_WICPixelFormat48bppRGB },
         { 24, PNG_COLOR_TYPE_RGB, NULL, NULL, NULL },
         { 32, PNG_COLOR_TYPE_RGB, NULL, NULL, NULL },
         /* 0 - PNG_COLOR_TYPE_GRAY */
@@ -815,7 +809,6 @@ static void test_color_formats(void)
         if (!is_valid_png_type_depth(td[i].color_type, td[i].bit_depth, TRUE))
             ok(hr == WINCODEC_ERR_UNKNOWNIMAGEFORMAT, "%d: wrong error %#lx\n", i, hr);
         else
-            todo_wine_if(td[i].todo_load)
             ok(hr == S_OK, "%d: Failed to load PNG image data (type %d, bpp %d) %#lx\n", i, td[i].color_type, td[i].bit_depth, hr);
         if (hr != S_OK) goto next_1;
 
@@ -824,7 +817,6 @@ static void test_color_formats(void)
 
         hr = IWICBitmapFrameDecode_GetPixelFormat(frame, &format);
         ok(hr == S_OK, "GetPixelFormat error %#lx\n", hr);
-        todo_wine_if(td[i].todo)
         ok(IsEqualGUID(&format, td[i].format_PLTE_tRNS),
            "PLTE+tRNS: expected %s, got %s (type %d, bpp %d)\n",
             wine_dbgstr_guid(td[i].format_PLTE_tRNS), wine_dbgstr_guid(&format), td[i].color_type, td[i].bit_depth);
@@ -843,7 +835,6 @@ next_1:
         if (!is_valid_png_type_depth(td[i].color_type, td[i].bit_depth, TRUE))
             ok(hr == WINCODEC_ERR_UNKNOWNIMAGEFORMAT, "%d: wrong error %#lx\n", i, hr);
         else
-            todo_wine_if(td[i].todo_load)
             ok(hr == S_OK, "%d: Failed to load PNG image data (type %d, bpp %d) %#lx\n", i, td[i].color_type, td[i].bit_depth, hr);
         if (hr != S_OK) goto next_2;
 
@@ -871,7 +862,6 @@ next_2:
         if (!is_valid_png_type_depth(td[i].color_type, td[i].bit_depth, FALSE))
             ok(hr == WINCODEC_ERR_UNKNOWNIMAGEFORMAT, "%d: wrong error %#lx\n", i, hr);
         else
-            todo_wine_if(td[i].todo_load)
             ok(hr == S_OK, "%d: Failed to load PNG image data (type %d, bpp %d) %#lx\n", i, td[i].color_type, td[i].bit_depth, hr);
         if (hr != S_OK) goto next_3;
 
@@ -898,7 +888,6 @@ next_3:
         if (!is_valid_png_type_depth(td[i].color_type, td[i].bit_depth, FALSE))
             ok(hr == WINCODEC_ERR_UNKNOWNIMAGEFORMAT, "%d: wrong error %#lx\n", i, hr);
         else
-            todo_wine_if(td[i].todo_load)
             ok(hr == S_OK, "%d: Failed to load PNG image data (type %d, bpp %d) %#lx\n", i, td[i].color_type, td[i].bit_depth, hr);
         if (hr != S_OK) continue;
 
@@ -907,7 +896,6 @@ next_3:
 
         hr = IWICBitmapFrameDecode_GetPixelFormat(frame, &format);
         ok(hr == S_OK, "GetPixelFormat error %#lx\n", hr);
-        todo_wine_if(td[i].todo)
         ok(IsEqualGUID(&format, td[i].format_PLTE_tRNS),
            "tRNS: expected %s, got %s (type %d, bpp %d)\n",
             wine_dbgstr_guid(td[i].format_PLTE_tRNS), wine_dbgstr_guid(&format), td[i].color_type, td[i].bit_depth);
@@ -950,6 +938,238 @@ static void test_chunk_size(void)
     IWICBitmapDecoder_Release(decoder);
 }
 
+static void test_png_encode_decode(void)
+{
+    static const struct
+    {
+        BOOL interlace;
+        WICPngFilterOption filter;
+    }
+    td[] =
+    {
+        { FALSE, WICPngFilterUnspecified },
+        { FALSE, WICPngFilterPaeth },
+        { TRUE, WICPngFilterUnspecified },
+    };
+    /* large enough to be compressed in more than one batch */
+    static const UINT width = 1031, height = 1400, stride = 1031 * 3;
+    IWICBitmapFrameEncode *frame_encode;
+    IWICBitmapFrameDecode *frame_decode;
+    IWICBitmapDecoder *decoder;
+    IWICBitmapEncoder *encoder;
+    IPropertyBag2 *encode_options;
+    WICPixelFormatGUID format;
+    LARGE_INTEGER zero;
+    BYTE *data, *buf;
+    PROPBAG2 propbag;
+    IStream *stream;
+    WICRect rect;
+    VARIANT var;
+    HRESULT hr;
+    UINT i, j;
+
+    data = malloc(stride * height);
+    buf = malloc(stride * height);
+    for (j = 0; j < stride * height; j++)
+        data[j] = (j * 7 + (j / stride) * 13 + (j % 5) * (j % 3)) & 0xff;
+
+    for (i = 0; i < ARRAY_SIZE(td); i++)
+    {
+        winetest_push_context("%u", i);
+
+        hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+        ok(hr == S_OK, "CreateStreamOnHGlobal error %#lx\n", hr);
+
+        hr = IWICImagingFactory_CreateEncoder(factory, &GUID_ContainerFormatPng, NULL, &encoder);
+        ok(hr == S_OK, "CreateEncoder error %#lx\n", hr);
+        hr = IWICBitmapEncoder_Initialize(encoder, stream, WICBitmapEncoderNoCache);
+        ok(hr == S_OK, "Initialize error %#lx\n", hr);
+        hr = IWICBitmapEncoder_CreateNewFrame(encoder, &frame_encode, &encode_options);
+        ok(hr == S_OK, "CreateNewFrame error %#lx\n", hr);
+
+        memset(&propbag, 0, sizeof(propbag));
+        propbag.pstrName = (LPOLESTR)L"InterlaceOption";
+        V_VT(&var) = VT_BOOL;
+        V_BOOL(&var) = td[i].interlace ? VARIANT_TRUE : VARIANT_FALSE;
+        hr = IPropertyBag2_Write(encode_options, 1, &propbag, &var);
+        ok(hr == S_OK, "Write error %#lx\n", hr);
+
+        propbag.pstrName = (LPOLESTR)L"FilterOption";
+        V_VT(&var) = VT_UI1;
+        V_UI1(&var) = td[i].filter;
+        hr = IPropertyBag2_Write(encode_options, 1, &propbag, &var);
+        ok(hr == S_OK, "Write error %#lx\n", hr);
+
+        hr = IWICBitmapFrameEncode_Initialize(frame_encode, encode_options);
+        ok(hr == S_OK, "Initialize error %#lx\n", hr);
+        hr = IWICBitmapFrameEncode_SetSize(frame_encode, width, height);
+        ok(hr == S_OK, "SetSize error %#lx\n", hr);
+        format = GUID_WICPixelFormat24bppBGR;
+        hr = IWICBitmapFrameEncode_SetPixelFormat(frame_encode, &format);
+        ok(hr == S_OK, "SetPixelFormat error %#lx\n", hr);
+        ok(IsEqualGUID(&format, &GUID_WICPixelFormat24bppBGR), "got wrong format %s\n", wine_dbgstr_guid(&format));
+        /* Write in uneven chunks. */
+        for (j = 0; j < height; j += 333)
+        {
+            hr = IWICBitmapFrameEncode_WritePixels(frame_encode, min(333, height - j), stride,
+                    stride * min(333, height - j), data + j * stride);
+            ok(hr == S_OK, "WritePixels error %#lx\n", hr);
+        }
+        hr = IWICBitmapFrameEncode_Commit(frame_encode);
+        ok(hr == S_OK, "Commit error %#lx\n", hr);
+        hr = IWICBitmapEncoder_Commit(encoder);
+        ok(hr == S_OK, "Commit error %#lx\n", hr);
+
+        IPropertyBag2_Release(encode_options);
+        IWICBitmapFrameEncode_Release(frame_encode);
+        IWICBitmapEncoder_Release(encoder);
+
+        zero.QuadPart = 0;
+        IStream_Seek(stream, zero, STREAM_SEEK_SET, NULL);
+
+        hr = IWICImagingFactory_CreateDecoderFromStream(factory, stream, NULL, 0, &decoder);
+        ok(hr == S_OK, "CreateDecoderFromStream error %#lx\n", hr);
+        hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame_decode);
+        ok(hr == S_OK, "GetFrame error %#lx\n", hr);
+
+        /* Read in bands first, then go back. */
+        memset(buf, 0xcc, stride * height);
+        rect.X = 0;
+        rect.Width = width;
+        for (rect.Y = 0; rect.Y < height; rect.Y += rect.Height)
+        {
+            rect.Height = min(16, height - rect.Y);
+            hr = IWICBitmapFrameDecode_CopyPixels(frame_decode, &rect, stride, stride * rect.Height, buf + rect.Y * stride);
+            ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+        }
+        ok(!memcmp(buf, data, stride * height), "band data doesn't match\n");
+
+        memset(buf, 0xcc, stride * height);
+        rect.X = 5;
+        rect.Y = 100;
+        rect.Width = 100;
+        rect.Height = 50;
+        hr = IWICBitmapFrameDecode_CopyPixels(frame_decode, &rect, stride, stride * rect.Height, buf);
+        ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+        for (j = 0; j < rect.Height; j++)
+            if (memcmp(buf + j * stride, data + (rect.Y + j) * stride + rect.X * 3, rect.Width * 3)) break;
+        ok(j == rect.Height, "row %u doesn't match\n", j);
+
+        memset(buf, 0xcc, stride * height);
+        hr = IWICBitmapFrameDecode_CopyPixels(frame_decode, NULL, stride, stride * height, buf);
+        ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+        ok(!memcmp(buf, data, stride * height), "image data doesn't match\n");
+
+        IWICBitmapFrameDecode_Release(frame_decode);
+        IWICBitmapDecoder_Release(decoder);
+        IStream_Release(stream);
+
+        winetest_pop_context();
+    }
+
+    free(data);
+    free(buf);
+}
+
+static void test_png_encode_decode_16bpc(void)
+{
+    static const struct
+    {
+        const GUID *format;
+        UINT bpp;
+        BOOL interlace;
+    }
+    td[] =
+    {
+        { &GUID_WICPixelFormat48bppRGB, 48, FALSE },
+        { &GUID_WICPixelFormat48bppRGB, 48, TRUE },
+        { &GUID_WICPixelFormat64bppRGBA, 64, FALSE },
+        { &GUID_WICPixelFormat64bppRGBA, 64, TRUE },
+    };
+    static const UINT width = 37, height = 29;
+    IWICBitmapFrameEncode *frame_encode;
+    IWICBitmapFrameDecode *frame_decode;
+    IWICBitmapDecoder *decoder;
+    IWICBitmapEncoder *encoder;
+    IPropertyBag2 *encode_options;
+    WICPixelFormatGUID format;
+    BYTE data[37 * 29 * 8], buf[37 * 29 * 8];
+    LARGE_INTEGER zero;
+    PROPBAG2 propbag;
+    IStream *stream;
+    UINT i, j, stride;
+    VARIANT var;
+    HRESULT hr;
+
+    for (j = 0; j < sizeof(data); j++)
+        data[j] = (j * 7 + (j / 3) * 13) & 0xff;
+
+    for (i = 0; i < ARRAY_SIZE(td); i++)
+    {
+        winetest_push_context("%u", i);
+
+        stride = width * td[i].bpp / 8;
+
+        hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+        ok(hr == S_OK, "CreateStreamOnHGlobal error %#lx\n", hr);
+
+        hr = IWICImagingFactory_CreateEncoder(factory, &GUID_ContainerFormatPng, NULL, &encoder);
+        ok(hr == S_OK, "CreateEncoder error %#lx\n", hr);
+        hr = IWICBitmapEncoder_Initialize(encoder, stream, WICBitmapEncoderNoCache);
+        ok(hr == S_OK, "Initialize error %#lx\n", hr);
+        hr = IWICBitmapEncoder_CreateNewFrame(encoder, &frame_encode, &encode_options);
+        ok(hr == S_OK, "CreateNewFrame error %#lx\n", hr);
+
+        memset(&propbag, 0, sizeof(propbag));
+        propbag.pstrName = (LPOLESTR)L"InterlaceOption";
+        V_VT(&var) = VT_BOOL;
+        V_BOOL(&var) = td[i].interlace ? VARIANT_TRUE : VARIANT_FALSE;
+        hr = IPropertyBag2_Write(encode_options, 1, &propbag, &var);
+        ok(hr == S_OK, "Write error %#lx\n", hr);
+
+        hr = IWICBitmapFrameEncode_Initialize(frame_encode, encode_options);
+        ok(hr == S_OK, "Initialize error %#lx\n", hr);
+        hr = IWICBitmapFrameEncode_SetSize(frame_encode, width, height);
+        ok(hr == S_OK, "SetSize error %#lx\n", hr);
+        format = *td[i].format;
+        hr = IWICBitmapFrameEncode_SetPixelFormat(frame_encode, &format);
+        ok(hr == S_OK, "SetPixelFormat error %#lx\n", hr);
+        ok(IsEqualGUID(&format, td[i].format), "got wrong format %s\n", wine_dbgstr_guid(&format));
+        hr = IWICBitmapFrameEncode_WritePixels(frame_encode, height, stride, stride * height, data);
+        ok(hr == S_OK, "WritePixels error %#lx\n", hr);
+        hr = IWICBitmapFrameEncode_Commit(frame_encode);
+        ok(hr == S_OK, "Commit error %#lx\n", hr);
+        hr = IWICBitmapEncoder_Commit(encoder);
+        ok(hr == S_OK, "Commit error %#lx\n", hr);
+
+        IPropertyBag2_Release(encode_options);
+        IWICBitmapFrameEncode_Release(frame_encode);
+        IWICBitmapEncoder_Release(encoder);
+
+        zero.QuadPart = 0;
+        IStream_Seek(stream, zero, STREAM_SEEK_SET, NULL);
+
+        hr = IWICImagingFactory_CreateDecoderFromStream(factory, stream, NULL, 0, &decoder);
+        ok(hr == S_OK, "CreateDecoderFromStream error %#lx\n", hr);
+        hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame_decode);
+        ok(hr == S_OK, "GetFrame error %#lx\n", hr);
+        hr = IWICBitmapFrameDecode_GetPixelFormat(frame_decode, &format);
+        ok(hr == S_OK, "GetPixelFormat error %#lx\n", hr);
+        ok(IsEqualGUID(&format, td[i].format), "got wrong format %s\n", wine_dbgstr_guid(&format));
+
+        memset(buf, 0xcc, sizeof(buf));
+        hr = IWICBitmapFrameDecode_CopyPixels(frame_decode, NULL, stride, stride * height, buf);
+        ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+        ok(!memcmp(buf, data, stride * height), "image data doesn't match\n");
+
+        IWICBitmapFrameDecode_Release(frame_decode);
+        IWICBitmapDecoder_Release(decoder);
+        IStream_Release(stream);
+
+        winetest_pop_context();
+    }
+}
+
 START_TEST(pngformat)
 {
     HRESULT hr;
@@ -964,6 +1184,8 @@ START_TEST(pngformat)
     test_png_palette();
     test_color_formats();
     test_chunk_size();
+    test_png_encode_decode();
+    test_png_encode_decode_16bpc();
 
     IWICImagingFactory_Release(factory);
     CoUninitialize();
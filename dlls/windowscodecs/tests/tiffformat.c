@@ -1324,6 +1324,268 @@ static void test_tiff_4bps_bgra(void)
     IWICBitmapDecoder_Release(decoder);
 }
 
+static void test_tiff_compression(void)
+{
+    static const WICTiffCompressionOption options[] = { WICTiffCompressionZIP, WICTiffCompressionLZW };
+    /* tall enough to be split into several strips */
+    static const UINT width = 257, height = 1000, stride = 257 * 3;
+    IWICBitmapFrameEncode *frame_encode;
+    IWICBitmapFrameDecode *frame_decode;
+    IWICBitmapDecoder *decoder;
+    IWICBitmapEncoder *encoder;
+    IPropertyBag2 *encode_options;
+    WICPixelFormatGUID format;
+    LARGE_INTEGER zero;
+    BYTE *data, *buf;
+    PROPBAG2 propbag;
+    IStream *stream;
+    WICRect rect;
+    VARIANT var;
+    HRESULT hr;
+    UINT i, j;
+
+    data = malloc(stride * height);
+    buf = malloc(stride * height);
+    for (j = 0; j < stride * height; j++)
+        data[j] = (j * 7 + (j / stride) * 13) & 0xff;
+
+    for (i = 0; i < ARRAY_SIZE(options); i++)
+    {
+        winetest_push_context("compression %u", options[i]);
+
+        hr = CreateStreamOnHGlobal(NULL, TRUE, &stream);
+        ok(hr == S_OK, "CreateStreamOnHGlobal error %#lx\n", hr);
+
+        hr = IWICImagingFactory_CreateEncoder(factory, &GUID_ContainerFormatTiff, NULL, &encoder);
+        ok(hr == S_OK, "CreateEncoder error %#lx\n", hr);
+        hr = IWICBitmapEncoder_Initialize(encoder, stream, WICBitmapEncoderNoCache);
+        ok(hr == S_OK, "Initialize error %#lx\n", hr);
+        hr = IWICBitmapEncoder_CreateNewFrame(encoder, &frame_encode, &encode_options);
+        ok(hr == S_OK, "CreateNewFrame error %#lx\n", hr);
+
+        memset(&propbag, 0, sizeof(propbag));
+        propbag.pstrName = (LPOLESTR)L"TiffCompressionMethod";
+        V_VT(&var) = VT_UI1;
+        V_UI1(&var) = options[i];
+        hr = IPropertyBag2_Write(encode_options, 1, &propbag, &var);
+        ok(hr == S_OK, "Write error %#lx\n", hr);
+
+        hr = IWICBitmapFrameEncode_Initialize(frame_encode, encode_options);
+        ok(hr == S_OK, "Initialize error %#lx\n", hr);
+        hr = IWICBitmapFrameEncode_SetSize(frame_encode, width, height);
+        ok(hr == S_OK, "SetSize error %#lx\n", hr);
+        format = GUID_WICPixelFormat24bppBGR;
+        hr = IWICBitmapFrameEncode_SetPixelFormat(frame_encode, &format);
+        ok(hr == S_OK, "SetPixelFormat error %#lx\n", hr);
+        ok(IsEqualGUID(&format, &GUID_WICPixelFormat24bppBGR), "got wrong format %s\n", wine_dbgstr_guid(&format));
+        /* Write in uneven chunks. */
+        for (j = 0; j < height; j += 50)
+        {
+            hr = IWICBitmapFrameEncode_WritePixels(frame_encode, min(50, height - j), stride,
+                    stride * min(50, height - j), data + j * stride);
+            ok(hr == S_OK, "WritePixels error %#lx\n", hr);
+        }
+        hr = IWICBitmapFrameEncode_Commit(frame_encode);
+        ok(hr == S_OK, "Commit error %#lx\n", hr);
+        hr = IWICBitmapEncoder_Commit(encoder);
+        ok(hr == S_OK, "Commit error %#lx\n", hr);
+
+        IPropertyBag2_Release(encode_options);
+        IWICBitmapFrameEncode_Release(frame_encode);
+        IWICBitmapEncoder_Release(encoder);
+
+        zero.QuadPart = 0;
+        IStream_Seek(stream, zero, STREAM_SEEK_SET, NULL);
+
+        hr = IWICImagingFactory_CreateDecoderFromStream(factory, stream, NULL, 0, &decoder);
+        ok(hr == S_OK, "CreateDecoderFromStream error %#lx\n", hr);
+        hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame_decode);
+        ok(hr == S_OK, "GetFrame error %#lx\n", hr);
+
+        memset(buf, 0xcc, stride * height);
+        hr = IWICBitmapFrameDecode_CopyPixels(frame_decode, NULL, stride, stride * height, buf);
+        ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+        ok(!memcmp(buf, data, stride * height), "image data doesn't match\n");
+
+        memset(buf, 0xcc, stride * height);
+        rect.X = 0;
+        rect.Width = width;
+        for (rect.Y = 0; rect.Y < height; rect.Y += rect.Height)
+        {
+            rect.Height = min(16, height - rect.Y);
+            hr = IWICBitmapFrameDecode_CopyPixels(frame_decode, &rect, stride, stride * rect.Height, buf + rect.Y * stride);
+            ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+        }
+        ok(!memcmp(buf, data, stride * height), "band data doesn't match\n");
+
+        IWICBitmapFrameDecode_Release(frame_decode);
+        IWICBitmapDecoder_Release(decoder);
+        IStream_Release(stream);
+
+        winetest_pop_context();
+    }
+
+    free(data);
+    free(buf);
+}
+
+static void put_le16(BYTE **ptr, WORD value)
+{
+    *(*ptr)++ = value & 0xff;
+    *(*ptr)++ = value >> 8;
+}
+
+static void put_le32(BYTE **ptr, DWORD value)
+{
+    put_le16(ptr, value & 0xffff);
+    put_le16(ptr, value >> 16);
+}
+
+static void put_ifd_entry(BYTE **ptr, WORD tag, WORD type, DWORD count, DWORD value)
+{
+    put_le16(ptr, tag);
+    put_le16(ptr, type);
+    put_le32(ptr, count);
+    if (type == IFD_SHORT && count == 1)
+    {
+        put_le16(ptr, value);
+        put_le16(ptr, 0);
+    }
+    else put_le32(ptr, value);
+}
+
+/* Stores data as a zlib stream made of a single uncompressed deflate block. */
+static UINT put_zlib_stored(BYTE *ptr, const BYTE *data, UINT size)
+{
+    DWORD a = 1, b = 0;
+    UINT i;
+
+    ptr[0] = 0x78;
+    ptr[1] = 0x01;
+    ptr[2] = 0x01; /* final block, no compression */
+    ptr += 3;
+    put_le16(&ptr, size);
+    put_le16(&ptr, ~size);
+    memcpy(ptr, data, size);
+    for (i = 0; i < size; i++)
+    {
+        a = (a + data[i]) % 65521;
+        b = (b + a) % 65521;
+    }
+    ptr += size;
+    *ptr++ = b >> 8;
+    *ptr++ = b;
+    *ptr++ = a >> 8;
+    *ptr++ = a;
+    return 3 + 4 + size + 4;
+}
+
+static void test_tiff_deflate_tiles(void)
+{
+    static const UINT width = 40, height = 40, tile_size = 16, tiles = 3, stride = 40 * 3;
+    static const UINT tile_bytes = 16 * 16 * 3, entries = 12;
+    IWICBitmapFrameDecode *frame;
+    IWICBitmapDecoder *decoder;
+    BYTE tile[16 * 16 * 3];
+    BYTE *tiff, *ptr, *buf, *expected;
+    UINT offsets[9], sizes[9];
+    UINT predictor, i, x, y, c, pos, data_offset;
+    WICRect rect;
+    HRESULT hr;
+
+    tiff = malloc(1024 + tiles * tiles * (tile_bytes + 16));
+    buf = malloc(stride * height);
+    expected = malloc(stride * height);
+
+    /* the decoder returns 24bppBGR from RGB samples */
+    for (y = 0; y < height; y++)
+        for (x = 0; x < width; x++)
+            for (c = 0; c < 3; c++)
+                expected[y * stride + x * 3 + 2 - c] = (x * 5 + y * 11 + c * 77) & 0xff;
+
+    for (predictor = 1; predictor <= 2; predictor++)
+    {
+        winetest_push_context("predictor %u", predictor);
+
+        /* header, IFD, then the bits per sample, tile offsets and sizes arrays */
+        data_offset = 8 + 2 + entries * 12 + 4 + 3 * 2 + 2 * tiles * tiles * 4;
+        pos = data_offset;
+        for (i = 0; i < tiles * tiles; i++)
+        {
+            for (y = 0; y < tile_size; y++)
+            {
+                for (x = 0; x < tile_size; x++)
+                    for (c = 0; c < 3; c++)
+                        tile[(y * tile_size + x) * 3 + c] = ((i % tiles) * tile_size + x) * 5
+                                + ((i / tiles) * tile_size + y) * 11 + c * 77;
+                if (predictor == 2)
+                    for (x = tile_size * 3 - 1; x >= 3; x--)
+                        tile[y * tile_size * 3 + x] -= tile[y * tile_size * 3 + x - 3];
+            }
+            offsets[i] = pos;
+            sizes[i] = put_zlib_stored(tiff + pos, tile, tile_bytes);
+            pos += sizes[i];
+        }
+
+        ptr = tiff;
+        put_le16(&ptr, 'I' | 'I' << 8);
+        put_le16(&ptr, 42);
+        put_le32(&ptr, 8);
+        put_le16(&ptr, entries);
+        put_ifd_entry(&ptr, 0x100, IFD_SHORT, 1, width);
+        put_ifd_entry(&ptr, 0x101, IFD_SHORT, 1, height);
+        put_ifd_entry(&ptr, 0x102, IFD_SHORT, 3, 8 + 2 + entries * 12 + 4);
+        put_ifd_entry(&ptr, 0x103, IFD_SHORT, 1, 8); /* adobe deflate */
+        put_ifd_entry(&ptr, 0x106, IFD_SHORT, 1, 2); /* RGB */
+        put_ifd_entry(&ptr, 0x115, IFD_SHORT, 1, 3);
+        put_ifd_entry(&ptr, 0x11c, IFD_SHORT, 1, 1);
+        put_ifd_entry(&ptr, 0x13d, IFD_SHORT, 1, predictor);
+        put_ifd_entry(&ptr, 0x142, IFD_SHORT, 1, tile_size);
+        put_ifd_entry(&ptr, 0x143, IFD_SHORT, 1, tile_size);
+        put_ifd_entry(&ptr, 0x144, IFD_LONG, tiles * tiles, 8 + 2 + entries * 12 + 4 + 3 * 2);
+        put_ifd_entry(&ptr, 0x145, IFD_LONG, tiles * tiles, 8 + 2 + entries * 12 + 4 + 3 * 2 + tiles * tiles * 4);
+        put_le32(&ptr, 0);
+        for (i = 0; i < 3; i++) put_le16(&ptr, 8);
+        for (i = 0; i < tiles * tiles; i++) put_le32(&ptr, offsets[i]);
+        for (i = 0; i < tiles * tiles; i++) put_le32(&ptr, sizes[i]);
+        ok(ptr - tiff == data_offset, "got %Iu\n", (SIZE_T)(ptr - tiff));
+
+        hr = create_decoder(tiff, pos, &decoder);
+        ok(hr == S_OK, "Failed to load TIFF image data %#lx\n", hr);
+        hr = IWICBitmapDecoder_GetFrame(decoder, 0, &frame);
+        ok(hr == S_OK, "GetFrame error %#lx\n", hr);
+
+        memset(buf, 0xcc, stride * height);
+        hr = IWICBitmapFrameDecode_CopyPixels(frame, NULL, stride, stride * height, buf);
+        ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+        ok(!memcmp(buf, expected, stride * height), "image data doesn't match\n");
+
+        /* rectangles straddling tile boundaries, partly served from the tile cache */
+        memset(buf, 0xcc, stride * height);
+        for (rect.Y = 0; rect.Y < height; rect.Y += rect.Height)
+        {
+            rect.Height = min(7, height - rect.Y);
+            for (rect.X = 0; rect.X < width; rect.X += rect.Width)
+            {
+                rect.Width = min(13, width - rect.X);
+                hr = IWICBitmapFrameDecode_CopyPixels(frame, &rect, stride, stride * rect.Height,
+                        buf + rect.Y * stride + rect.X * 3);
+                ok(hr == S_OK, "CopyPixels error %#lx\n", hr);
+            }
+        }
+        ok(!memcmp(buf, expected, stride * height), "rectangle data doesn't match\n");
+
+        IWICBitmapFrameDecode_Release(frame);
+        IWICBitmapDecoder_Release(decoder);
+
+        winetest_pop_context();
+    }
+
+    free(expected);
+    free(buf);
+    free(tiff);
+}
+
 START_TEST(tiffformat)
 {
     HRESULT hr;
@@ -1343,6 +1605,8 @@ START_TEST(tiffformat)
     test_tiff_8bpp_alpha();
     test_tiff_resolution();
     test_tiff_24bpp();
+    test_tiff_compression();
+    test_tiff_deflate_tiles();
 
     IWICImagingFactory_Release(factory);
     CoUninitialize();
@@ -48,6 +48,17 @@ void CDECL decoder_destroy(struct decoder *decoder)
     decoder->vtable->destroy(decoder);
 }
 
+HRESULT CDECL decoder_get_closest_size(struct decoder *decoder, UINT frame, UINT *width, UINT *height)
+{
+    return decoder->vtable->get_closest_size(decoder, frame, width, height);
+}
+
+HRESULT CDECL decoder_copy_pixels_scaled(struct decoder *decoder, UINT frame, UINT width, UINT height,
+    const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer)
+{
+    return decoder->vtable->copy_pixels_scaled(decoder, frame, width, height, prc, stride, buffersize, buffer);
+}
+
 HRESULT CDECL encoder_initialize(struct encoder *encoder, IStream *stream)
 {
     return encoder->vtable->initialize(encoder, stream);
@@ -180,6 +180,35 @@ extern void reverse_bgr8(UINT bytesperpixel, LPBYTE bits, UINT width, UINT heigh
 
 extern HRESULT get_pixelformat_bpp(const GUID *pixelformat, UINT *bpp);
 
+#define FILTER_BITS 14
+
+struct pixel_kernels
+{
+    void (*bgr24_to_bgra32)(const BYTE *src, BYTE *dst, UINT width);
+    void (*rgb24_to_bgra32)(const BYTE *src, BYTE *dst, UINT width);
+    void (*bgra32_to_bgr24)(const BYTE *src, BYTE *dst, UINT width);
+    void (*rgba32_to_bgr24)(const BYTE *src, BYTE *dst, UINT width);
+    void (*rgb48_to_bgra32)(const BYTE *src, BYTE *dst, UINT width);
+    void (*rgba64_to_bgra32)(const BYTE *src, BYTE *dst, UINT width);
+    void (*premultiply32)(BYTE *row, UINT width);
+    void (*unpremultiply32)(BYTE *row, UINT width);
+    void (*float_to_srgb8)(const float *src, BYTE *dst, UINT width);
+    /* Weighted sum of taps rows, weights in FILTER_BITS fixed point. */
+    void (*filter_rows)(const BYTE * const *rows, const short *weights, UINT taps, BYTE *dst, UINT size);
+    /* Horizontal filter of a 32bpp row whose first pixel is source column origin. */
+    void (*filter_row32)(const BYTE *src, UINT origin, const UINT *start, const short *weights,
+            UINT taps, BYTE *dst, UINT count);
+};
+
+extern const struct pixel_kernels *get_pixel_kernels(void);
+extern BYTE float_to_srgb8(float f);
+
+typedef HRESULT (*band_func)(void *context, UINT y, UINT height);
+
+/* Calls func for consecutive row bands covering [0, height), possibly
+ * concurrently on the thread pool. Returns the first failure. */
+extern HRESULT process_bands(UINT width, UINT height, band_func func, void *context);
+
 extern HRESULT CreatePropertyBag2(const PROPBAG2 *options, UINT count,
                                   IPropertyBag2 **property);
 
@@ -230,6 +259,7 @@ extern HRESULT GifCommentReader_CreateInstance(REFIID iid, void **ppv);
 extern HRESULT MetadataQueryReader_CreateInstance(IWICMetadataBlockReader *, const WCHAR *, IWICMetadataQueryReader **);
 extern HRESULT MetadataQueryWriter_CreateInstance(IWICMetadataBlockWriter *, const WCHAR *, IWICMetadataQueryWriter **);
 extern HRESULT stream_initialize_from_filehandle(IWICStream *iface, HANDLE hfile);
+extern BOOL stream_get_buffer(IStream *stream, const BYTE **data, ULONGLONG *size);
 
 static inline const char *debug_wic_rect(const WICRect *rect)
 {
@@ -251,6 +281,7 @@ struct decoder_info
 };
 
 #define DECODER_FLAGS_CAPABILITY_MASK 0x1f
+#define DECODER_FLAGS_SEQUENTIAL 0x40000000 /* pixels are decoded on demand, from top to bottom */
 #define DECODER_FLAGS_UNSUPPORTED_COLOR_CONTEXT 0x80000000
 
 struct decoder_stat
@@ -297,6 +328,10 @@ struct decoder_funcs
     HRESULT (CDECL *get_color_context)(struct decoder* This, UINT frame, UINT num,
         BYTE **data, DWORD *datasize);
     void (CDECL *destroy)(struct decoder* This);
+    /* Optional, for decoders that can produce reduced size images cheaply. */
+    HRESULT (CDECL *get_closest_size)(struct decoder* This, UINT frame, UINT *width, UINT *height);
+    HRESULT (CDECL *copy_pixels_scaled)(struct decoder* This, UINT frame, UINT width, UINT height,
+        const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer);
 };
 
 HRESULT CDECL stream_getsize(IStream *stream, ULONGLONG *size);
@@ -314,6 +349,9 @@ HRESULT CDECL decoder_get_metadata_blocks(struct decoder* This, UINT frame, UINT
 HRESULT CDECL decoder_get_color_context(struct decoder* This, UINT frame, UINT num,
     BYTE **data, DWORD *datasize);
 void CDECL decoder_destroy(struct decoder *This);
+HRESULT CDECL decoder_get_closest_size(struct decoder* This, UINT frame, UINT *width, UINT *height);
+HRESULT CDECL decoder_copy_pixels_scaled(struct decoder* This, UINT frame, UINT width, UINT height,
+    const WICRect *prc, UINT stride, UINT buffersize, BYTE *buffer);
 
 struct encoder_funcs;
 
@@ -357,6 +395,7 @@ struct encoder_frame
     /* encoder options */
     BOOL interlace;
     DWORD filter;
+    DWORD compression;
 };
 
 struct encoder
@@ -394,6 +433,7 @@ HRESULT CDECL icns_encoder_create(struct encoder_info *info, struct encoder **re
 
 extern HRESULT CommonDecoder_CreateInstance(struct decoder *decoder,
     const struct decoder_info *decoder_info, REFIID iid, void** ppv);
+extern BOOL bitmap_source_is_sequential(IWICBitmapSource *source);
 
 extern HRESULT CommonEncoder_CreateInstance(struct encoder *encoder,
     const struct encoder_info *encoder_info, REFIID iid, void** ppv);
@@ -1266,6 +1266,7 @@ LRESULT ANDROID_WindowMessage( HWND hwnd, UINT msg, WPARAM wp, LPARAM lp )
             {
                 window_surface_lock( surface );
                 surface->bounds = surface->rect;
+                surface->damage_count = 0;
                 window_surface_unlock( surface );
                 if (is_argb_surface( surface )) window_surface_flush( surface );
             }
@@ -140,6 +140,9 @@ struct shader_glsl_priv
     struct wine_rb_tree ffp_vertex_shaders;
     struct wine_rb_tree ffp_fragment_shaders;
     BOOL legacy_lighting;
+
+    struct wined3d_shader_cache *program_cache;
+    char *program_cache_identity;
 };
 
 struct glsl_vs_program
@@ -631,6 +634,178 @@ void shader_glsl_validate_link(const struct wined3d_gl_info *gl_info, GLuint pro
     print_glsl_info_log(gl_info, program, TRUE);
 }
 
+/* The cache is keyed by the GLSL source of the attached shader objects, which
+ * fully describes the translated shader bytecode and its compile arguments,
+ * and by the link state that isn't part of the sources. The driver identity is
+ * checked separately by the cache itself. Returns NULL if the program can't be
+ * cached. */
+static void *shader_glsl_get_program_cache_key(const struct wined3d_gl_info *gl_info,
+        GLuint program, uint64_t link_state, size_t *key_size)
+{
+    GLint lengths[8], i, j, shader_count;
+    GLuint shaders[ARRAY_SIZE(lengths)];
+    char *sources[ARRAY_SIZE(lengths)];
+    uint8_t *key = NULL, *ptr;
+    size_t size;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_ATTACHED_SHADERS, &shader_count));
+    if (shader_count <= 0 || shader_count > ARRAY_SIZE(shaders))
+        return NULL;
+
+    GL_EXTCALL(glGetAttachedShaders(program, shader_count, NULL, shaders));
+    size = sizeof(link_state);
+    for (i = 0; i < shader_count; ++i)
+    {
+        GLint length;
+
+        GL_EXTCALL(glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &length));
+        if (length <= 0 || !(sources[i] = malloc(length)))
+            goto done;
+        GL_EXTCALL(glGetShaderSource(shaders[i], length, &length, sources[i]));
+        size += sizeof(length) + length;
+
+        /* The order of attached shaders is up to the driver; sort them. */
+        for (j = i; j > 0 && (lengths[j - 1] > length || (lengths[j - 1] == length
+                && memcmp(sources[j - 1], sources[j], length) > 0)); --j)
+        {
+            char *tmp = sources[j];
+            sources[j] = sources[j - 1];
+            sources[j - 1] = tmp;
+            lengths[j] = lengths[j - 1];
+        }
+        lengths[j] = length;
+    }
+    checkGLcall("get program sources");
+
+    if (!(key = malloc(size)))
+        goto done;
+    memcpy(key, &link_state, sizeof(link_state));
+    ptr = key + sizeof(link_state);
+    for (j = 0; j < shader_count; ++j)
+    {
+        memcpy(ptr, &lengths[j], sizeof(lengths[j]));
+        ptr += sizeof(lengths[j]);
+        memcpy(ptr, sources[j], lengths[j]);
+        ptr += lengths[j];
+    }
+    *key_size = size;
+
+done:
+    while (i--)
+        free(sources[i]);
+    return key;
+}
+
+static const char *shader_glsl_get_program_cache_identity(const struct wined3d_gl_info *gl_info,
+        struct shader_glsl_priv *priv)
+{
+    const char *vendor, *renderer, *version;
+
+    if (priv->program_cache_identity)
+        return priv->program_cache_identity;
+
+    vendor = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VENDOR);
+    renderer = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_RENDERER);
+    version = (const char *)gl_info->gl_ops.gl.p_glGetString(GL_VERSION);
+    if (!vendor || !renderer || !version)
+        return NULL;
+
+    if ((priv->program_cache_identity = malloc(strlen(vendor) + strlen(renderer) + strlen(version) + 3)))
+        sprintf(priv->program_cache_identity, "%s\n%s\n%s", vendor, renderer, version);
+    return priv->program_cache_identity;
+}
+
+/* Context activation is done by the caller. */
+static bool shader_glsl_load_program_binary(const struct wined3d_gl_info *gl_info,
+        struct shader_glsl_priv *priv, const char *identity, GLuint program, const void *key, size_t key_size)
+{
+    GLint status = GL_FALSE;
+    size_t size;
+    GLenum format;
+    char *data;
+
+    if (!(data = wined3d_shader_cache_get(priv->program_cache, identity, key, key_size, &size)))
+        return false;
+
+    if (size > sizeof(format))
+    {
+        memcpy(&format, data, sizeof(format));
+        GL_EXTCALL(glProgramBinary(program, format, data + sizeof(format), size - sizeof(format)));
+        checkGLcall("glProgramBinary");
+        GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+    }
+    free(data);
+
+    /* The driver may reject binaries for any reason, e.g. after an update
+     * that didn't change its version string; just link normally then. */
+    if (!status)
+        WARN("Cached binary for program %u was rejected.\n", program);
+    else
+        TRACE("Loaded program %u from the program cache.\n", program);
+
+    return status;
+}
+
+/* Context activation is done by the caller. */
+static void shader_glsl_store_program_binary(const struct wined3d_gl_info *gl_info,
+        struct shader_glsl_priv *priv, const char *identity, GLuint program, const void *key, size_t key_size)
+{
+    GLint status, length;
+    GLsizei written;
+    GLenum format;
+    char *data;
+
+    GL_EXTCALL(glGetProgramiv(program, GL_LINK_STATUS, &status));
+    GL_EXTCALL(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (!status || length <= 0)
+        return;
+
+    if (!(data = malloc(sizeof(format) + length)))
+        return;
+    GL_EXTCALL(glGetProgramBinary(program, length, &written, &format, data + sizeof(format)));
+    checkGLcall("glGetProgramBinary");
+    if (written > 0)
+    {
+        memcpy(data, &format, sizeof(format));
+        wined3d_shader_cache_put(priv->program_cache, identity, key, key_size,
+                data, sizeof(format) + written);
+    }
+    free(data);
+}
+
+/* Link the program, or load it from the program cache when possible.
+ * "link_state" describes the state that affects linking but isn't part of
+ * the shader sources, e.g. attribute bindings.
+ *
+ * Context activation is done by the caller. */
+static void shader_glsl_link_program(const struct wined3d_gl_info *gl_info,
+        struct shader_glsl_priv *priv, GLuint program, uint64_t link_state, bool cacheable)
+{
+    const char *identity = NULL;
+    size_t key_size = 0;
+    void *key = NULL;
+
+    if (cacheable && priv->program_cache && gl_info->supported[ARB_GET_PROGRAM_BINARY]
+            && (identity = shader_glsl_get_program_cache_identity(gl_info, priv))
+            && (key = shader_glsl_get_program_cache_key(gl_info, program, link_state, &key_size)))
+    {
+        if (shader_glsl_load_program_binary(gl_info, priv, identity, program, key, key_size))
+        {
+            free(key);
+            return;
+        }
+        GL_EXTCALL(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+
+    TRACE("Linking GLSL shader program %u.\n", program);
+    GL_EXTCALL(glLinkProgram(program));
+    shader_glsl_validate_link(gl_info, program);
+
+    if (key)
+        shader_glsl_store_program_binary(gl_info, priv, identity, program, key, key_size);
+    free(key);
+}
+
 static struct vkd3d_shader_resource_binding *create_resource_bindings(const struct wined3d_gl_info *gl_info,
         enum wined3d_shader_type shader_type, unsigned int *count)
 {
@@ -10289,9 +10464,7 @@ static HRESULT shader_glsl_compile_compute_shader(struct shader_glsl_priv *priv,
 
     list_add_head(&shader->linked_programs, &entry->cs.shader_entry);
 
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    shader_glsl_link_program(gl_info, priv, program_id, 0, true);
 
     GL_EXTCALL(glUseProgram(program_id));
     checkGLcall("glUseProgram");
@@ -10364,6 +10537,7 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
     GLuint reorder_shader_id = 0;
     struct glsl_program_key key;
     uint32_t attribs_map;
+    uint64_t link_state;
     GLuint program_id;
     unsigned int i;
     GLuint vs_id = 0;
@@ -10535,6 +10709,12 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
         attribs_map = (1u << WINED3D_FFP_ATTRIBS_COUNT) - 1;
     }
 
+    link_state = attribs_map;
+    if (vshader && vshader->reg_maps.shader_version.major >= 4)
+        link_state |= (uint64_t)1 << 32;
+    if (state->blend_state && state->blend_state->dual_source)
+        link_state |= (uint64_t)1 << 33;
+
     if (!shader_glsl_use_explicit_attrib_location(gl_info))
     {
         /* Bind vertex attributes to a corresponding index number to match
@@ -10616,10 +10796,9 @@ static void set_glsl_shader_program(const struct wined3d_context_gl *context_gl,
         list_add_head(ps_list, &entry->ps.shader_entry);
     }
 
-    /* Link the program */
-    TRACE("Linking GLSL shader program %u.\n", program_id);
-    GL_EXTCALL(glLinkProgram(program_id));
-    shader_glsl_validate_link(gl_info, program_id);
+    /* Link the program. Stream output varyings aren't part of the cache key,
+     * so don't cache programs using them. */
+    shader_glsl_link_program(gl_info, priv, program_id, link_state, !(gshader && gshader->u.gs.so_desc));
 
     shader_glsl_init_vs_uniform_locations(gl_info, priv, program_id, &entry->vs,
             vshader ? vshader->limits->constant_float : 0);
@@ -11285,6 +11464,7 @@ static HRESULT shader_glsl_alloc(struct wined3d_device *device, const struct win
     }
 
     wine_rb_init(&priv->program_lookup, glsl_program_key_compare);
+    priv->program_cache = wined3d_shader_cache_create("glsl");
 
     priv->next_constant_version = 1;
     priv->vertex_pipe = vertex_pipe;
@@ -11314,6 +11494,8 @@ static void shader_glsl_free(struct wined3d_device *device, struct wined3d_conte
     struct shader_glsl_priv *priv = device->shader_priv;
 
     wine_rb_destroy(&priv->program_lookup, NULL, NULL);
+    wined3d_shader_cache_destroy(priv->program_cache);
+    free(priv->program_cache_identity);
     constant_free(&priv->pconst_heap);
     constant_free(&priv->vconst_heap);
     free(priv->stack);
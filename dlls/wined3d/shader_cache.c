@@ -0,0 +1,476 @@
+/*
+ * Persistent shader cache
+ *
+ * Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/*
+ * The cache is a single file per backend in the "shader_cache_path"
+ * directory. It is read in the background when the cache is created, and kept
+ * in memory as a tree of blobs indexed by a hash of their key. The full key is
+ * stored with each entry and compared on lookup, so a hash collision is just a
+ * miss. Entries are also kept on a list in order of use; the least recently
+ * used ones are evicted to keep the cache within "shader_cache_size" MiB, both
+ * in memory and on disk. The file is written back when the cache is destroyed
+ * if anything was added.
+ *
+ * The file starts with an identity string supplied by the backend (usually the
+ * driver and renderer names). If it doesn't match the identity of the running
+ * driver, the whole file is discarded. Entries follow, least recently used
+ * first.
+ */
+
+#include "wined3d_private.h"
+
+WINE_DEFAULT_DEBUG_CHANNEL(d3d_shader);
+
+#define WINED3D_SHADER_CACHE_MAGIC   0x43534457 /* "WDSC" */
+#define WINED3D_SHADER_CACHE_VERSION 2
+
+struct wined3d_shader_cache_header
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t identity_size;
+    uint32_t entry_count;
+};
+
+struct wined3d_shader_cache_file_entry
+{
+    uint32_t key_size;
+    uint32_t data_size;
+};
+
+struct wined3d_shader_cache_key
+{
+    uint64_t hash;
+    const void *data;
+    size_t size;
+};
+
+struct wined3d_shader_cache_entry
+{
+    struct wine_rb_entry entry;
+    struct list use_entry;
+    uint64_t hash;
+    size_t key_size;
+    size_t data_size;
+    uint8_t data[1]; /* The key, followed by the data. */
+};
+
+enum wined3d_shader_cache_state
+{
+    WINED3D_SHADER_CACHE_UNLOADED,
+    WINED3D_SHADER_CACHE_LOADED,
+    WINED3D_SHADER_CACHE_VALIDATED,
+};
+
+struct wined3d_shader_cache
+{
+    CRITICAL_SECTION cs;
+    LONG refcount;
+    enum wined3d_shader_cache_state state;
+    char *path;
+    char *identity;
+
+    struct wine_rb_tree entries;
+    struct list use_list; /* Most recently used first. */
+    size_t total_size;
+    size_t max_size;
+    bool dirty;
+};
+
+static uint64_t wined3d_shader_cache_hash(const void *data, size_t size)
+{
+    uint64_t hash = 0xcbf29ce484222325ull;
+    const uint8_t *ptr = data;
+
+    /* FNV-1a */
+    while (size--)
+    {
+        hash ^= *ptr++;
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+static size_t wined3d_shader_cache_entry_size(size_t key_size, size_t data_size)
+{
+    return sizeof(struct wined3d_shader_cache_file_entry) + key_size + data_size;
+}
+
+static int wined3d_shader_cache_entry_compare(const void *key, const struct wine_rb_entry *entry)
+{
+    const struct wined3d_shader_cache_entry *e = WINE_RB_ENTRY_VALUE(entry, struct wined3d_shader_cache_entry, entry);
+    const struct wined3d_shader_cache_key *k = key;
+
+    if (k->hash != e->hash)
+        return k->hash < e->hash ? -1 : 1;
+    if (k->size != e->key_size)
+        return k->size < e->key_size ? -1 : 1;
+    return memcmp(k->data, e->data, k->size);
+}
+
+static void wined3d_shader_cache_free_entry(struct wine_rb_entry *entry, void *context)
+{
+    free(WINE_RB_ENTRY_VALUE(entry, struct wined3d_shader_cache_entry, entry));
+}
+
+static void wined3d_shader_cache_clear(struct wined3d_shader_cache *cache)
+{
+    wine_rb_destroy(&cache->entries, wined3d_shader_cache_free_entry, NULL);
+    wine_rb_init(&cache->entries, wined3d_shader_cache_entry_compare);
+    list_init(&cache->use_list);
+    cache->total_size = 0;
+}
+
+static void wined3d_shader_cache_remove(struct wined3d_shader_cache *cache, struct wined3d_shader_cache_entry *entry)
+{
+    cache->total_size -= wined3d_shader_cache_entry_size(entry->key_size, entry->data_size);
+    wine_rb_remove(&cache->entries, &entry->entry);
+    list_remove(&entry->use_entry);
+    free(entry);
+}
+
+/* The new entry becomes the most recently used one. */
+static bool wined3d_shader_cache_insert(struct wined3d_shader_cache *cache,
+        const void *key, size_t key_size, const void *data, size_t data_size)
+{
+    struct wined3d_shader_cache_entry *entry;
+    struct wined3d_shader_cache_key k;
+    struct wine_rb_entry *old;
+    size_t size;
+
+    if ((size = wined3d_shader_cache_entry_size(key_size, data_size)) > cache->max_size)
+        return false;
+
+    k.hash = wined3d_shader_cache_hash(key, key_size);
+    k.data = key;
+    k.size = key_size;
+    if ((old = wine_rb_get(&cache->entries, &k)))
+        wined3d_shader_cache_remove(cache, WINE_RB_ENTRY_VALUE(old, struct wined3d_shader_cache_entry, entry));
+
+    while (cache->total_size + size > cache->max_size)
+    {
+        entry = LIST_ENTRY(list_tail(&cache->use_list), struct wined3d_shader_cache_entry, use_entry);
+        TRACE("Evicting entry %s.\n", wine_dbgstr_longlong(entry->hash));
+        wined3d_shader_cache_remove(cache, entry);
+    }
+
+    if (!(entry = malloc(offsetof(struct wined3d_shader_cache_entry, data[key_size + data_size]))))
+        return false;
+    entry->hash = k.hash;
+    entry->key_size = key_size;
+    entry->data_size = data_size;
+    memcpy(entry->data, key, key_size);
+    memcpy(entry->data + key_size, data, data_size);
+    k.data = entry->data;
+
+    wine_rb_put(&cache->entries, &k, &entry->entry);
+    list_add_head(&cache->use_list, &entry->use_entry);
+    cache->total_size += size;
+    return true;
+}
+/* Called with the cache lock held. */
+static void wined3d_shader_cache_load(struct wined3d_shader_cache *cache)
+{
+    const struct wined3d_shader_cache_header *header;
+    const uint8_t *ptr, *end;
+    LARGE_INTEGER file_size;
+    uint8_t *buffer = NULL;
+    unsigned int i;
+    DWORD read;
+    HANDLE file;
+
+    if (cache->state != WINED3D_SHADER_CACHE_UNLOADED)
+        return;
+    cache->state = WINED3D_SHADER_CACHE_LOADED;
+
+    file = CreateFileA(cache->path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        TRACE("No shader cache at %s.\n", debugstr_a(cache->path));
+        return;
+    }
+
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < sizeof(*header)
+            || file_size.QuadPart > (LONGLONG)cache->max_size * 2
+            || !(buffer = malloc(file_size.QuadPart))
+            || !ReadFile(file, buffer, file_size.QuadPart, &read, NULL) || read != file_size.QuadPart)
+    {
+        WARN("Failed to read shader cache %s.\n", debugstr_a(cache->path));
+        goto done;
+    }
+
+    header = (const struct wined3d_shader_cache_header *)buffer;
+    ptr = buffer + sizeof(*header);
+    end = buffer + read;
+    if (header->magic != WINED3D_SHADER_CACHE_MAGIC || header->version != WINED3D_SHADER_CACHE_VERSION
+            || header->identity_size > end - ptr || !(cache->identity = malloc(header->identity_size + 1)))
+    {
+        WARN("Ignoring invalid shader cache %s.\n", debugstr_a(cache->path));
+        goto done;
+    }
+    memcpy(cache->identity, ptr, header->identity_size);
+    cache->identity[header->identity_size] = 0;
+    ptr += header->identity_size;
+
+    for (i = 0; i < header->entry_count; ++i)
+    {
+        struct wined3d_shader_cache_file_entry file_entry;
+
+        if (end - ptr < sizeof(file_entry))
+            break;
+        memcpy(&file_entry, ptr, sizeof(file_entry));
+        ptr += sizeof(file_entry);
+        if (file_entry.key_size > end - ptr || file_entry.data_size > end - ptr - file_entry.key_size)
+            break;
+        wined3d_shader_cache_insert(cache, ptr, file_entry.key_size,
+                ptr + file_entry.key_size, file_entry.data_size);
+        ptr += file_entry.key_size + file_entry.data_size;
+    }
+    if (i != header->entry_count)
+        WARN("Shader cache %s is truncated, loaded %u of %u entries.\n",
+                debugstr_a(cache->path), i, header->entry_count);
+
+    TRACE("Loaded %u entries, %Iu bytes, from %s.\n", i, cache->total_size, debugstr_a(cache->path));
+
+done:
+    free(buffer);
+    CloseHandle(file);
+}
+
+/* Called with the cache lock held. */
+static bool wined3d_shader_cache_validate(struct wined3d_shader_cache *cache, const char *identity)
+{
+    wined3d_shader_cache_load(cache);
+
+    if (cache->state == WINED3D_SHADER_CACHE_VALIDATED)
+        return true;
+
+    if (!cache->identity || strcmp(cache->identity, identity))
+    {
+        if (cache->identity)
+            TRACE("Driver changed from %s, discarding shader cache.\n", debugstr_a(cache->identity));
+        free(cache->identity);
+        if (!(cache->identity = strdup(identity)))
+            return false;
+        wined3d_shader_cache_clear(cache);
+        cache->dirty = true;
+    }
+    cache->state = WINED3D_SHADER_CACHE_VALIDATED;
+    return true;
+}
+
+static bool wined3d_shader_cache_write_data(HANDLE file, const void *data, size_t size)
+{
+    DWORD written;
+
+    return WriteFile(file, data, size, &written, NULL) && written == size;
+}
+
+static void wined3d_shader_cache_save(struct wined3d_shader_cache *cache)
+{
+    struct wined3d_shader_cache_entry *entry, *first = NULL;
+    struct wined3d_shader_cache_header header;
+    size_t count = 0, size;
+    struct list *cursor;
+    char *tmp_path;
+    HANDLE file;
+    bool ret;
+
+    if (!cache->dirty || cache->state != WINED3D_SHADER_CACHE_VALIDATED)
+        return;
+
+    /* The entries already fit, but the header may not; skip the least
+     * recently used entries until it does. */
+    size = sizeof(header) + strlen(cache->identity);
+    LIST_FOR_EACH_ENTRY(entry, &cache->use_list, struct wined3d_shader_cache_entry, use_entry)
+    {
+        size += wined3d_shader_cache_entry_size(entry->key_size, entry->data_size);
+        if (size > cache->max_size)
+            break;
+        first = entry;
+        ++count;
+    }
+
+    if (!(tmp_path = malloc(strlen(cache->path) + 5)))
+        return;
+    sprintf(tmp_path, "%s.tmp", cache->path);
+
+    file = CreateFileA(tmp_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        WARN("Failed to create %s, error %lu.\n", debugstr_a(tmp_path), GetLastError());
+        free(tmp_path);
+        return;
+    }
+
+    header.magic = WINED3D_SHADER_CACHE_MAGIC;
+    header.version = WINED3D_SHADER_CACHE_VERSION;
+    header.identity_size = strlen(cache->identity);
+    header.entry_count = count;
+    ret = wined3d_shader_cache_write_data(file, &header, sizeof(header))
+            && wined3d_shader_cache_write_data(file, cache->identity, header.identity_size);
+
+    for (cursor = first ? &first->use_entry : NULL; ret && cursor; cursor = list_prev(&cache->use_list, cursor))
+    {
+        struct wined3d_shader_cache_file_entry file_entry;
+
+        entry = LIST_ENTRY(cursor, struct wined3d_shader_cache_entry, use_entry);
+        file_entry.key_size = entry->key_size;
+        file_entry.data_size = entry->data_size;
+        ret = wined3d_shader_cache_write_data(file, &file_entry, sizeof(file_entry))
+                && wined3d_shader_cache_write_data(file, entry->data, entry->key_size + entry->data_size);
+    }
+    CloseHandle(file);
+
+    /* Replace the old file atomically, so that concurrent readers never see a partial cache. */
+    if (!ret || !MoveFileExA(tmp_path, cache->path, MOVEFILE_REPLACE_EXISTING))
+    {
+        WARN("Failed to write shader cache %s.\n", debugstr_a(cache->path));
+        DeleteFileA(tmp_path);
+    }
+    else
+    {
+        TRACE("Wrote %Iu entries to %s.\n", count, debugstr_a(cache->path));
+        cache->dirty = false;
+    }
+
+    free(tmp_path);
+}
+
+static void wined3d_shader_cache_decref(struct wined3d_shader_cache *cache)
+{
+    if (InterlockedDecrement(&cache->refcount))
+        return;
+
+    wine_rb_destroy(&cache->entries, wined3d_shader_cache_free_entry, NULL);
+    cache->cs.DebugInfo->Spare[0] = 0;
+    DeleteCriticalSection(&cache->cs);
+    free(cache->identity);
+    free(cache->path);
+    free(cache);
+}
+
+static void CALLBACK wined3d_shader_cache_load_cb(TP_CALLBACK_INSTANCE *instance, void *context)
+{
+    struct wined3d_shader_cache *cache = context;
+
+    EnterCriticalSection(&cache->cs);
+    wined3d_shader_cache_load(cache);
+    LeaveCriticalSection(&cache->cs);
+    wined3d_shader_cache_decref(cache);
+}
+
+struct wined3d_shader_cache *wined3d_shader_cache_create(const char *name)
+{
+    struct wined3d_shader_cache *cache;
+    const char *dir;
+
+    if (!(dir = wined3d_settings.shader_cache_path) || !*dir)
+        return NULL;
+
+    if (!(cache = calloc(1, sizeof(*cache))))
+        return NULL;
+    if (!(cache->path = malloc(strlen(dir) + strlen(name) + 8)))
+    {
+        free(cache);
+        return NULL;
+    }
+    sprintf(cache->path, "%s\\%s.cache", dir, name);
+    CreateDirectoryA(dir, NULL);
+
+    InitializeCriticalSection(&cache->cs);
+    cache->cs.DebugInfo->Spare[0] = (DWORD_PTR)(__FILE__ ": wined3d_shader_cache.cs");
+    cache->refcount = 1;
+    cache->state = WINED3D_SHADER_CACHE_UNLOADED;
+    cache->max_size = (size_t)wined3d_settings.shader_cache_size << 20;
+    wine_rb_init(&cache->entries, wined3d_shader_cache_entry_compare);
+    list_init(&cache->use_list);
+
+    /* Read the file in the background; the first lookup waits for it. */
+    InterlockedIncrement(&cache->refcount);
+    if (!TrySubmitThreadpoolCallback(wined3d_shader_cache_load_cb, cache, NULL))
+        InterlockedDecrement(&cache->refcount);
+
+    TRACE("Created shader cache %p, path %s.\n", cache, debugstr_a(cache->path));
+
+    return cache;
+}
+
+void wined3d_shader_cache_destroy(struct wined3d_shader_cache *cache)
+{
+    if (!cache)
+        return;
+
+    TRACE("Destroying shader cache %p.\n", cache);
+
+    /* Save now rather than on the last release; the load callback may not
+     * have run yet, and may never run if the process is exiting. */
+    EnterCriticalSection(&cache->cs);
+    wined3d_shader_cache_save(cache);
+    LeaveCriticalSection(&cache->cs);
+    wined3d_shader_cache_decref(cache);
+}
+
+/* Returns a copy of the cached data, to be freed by the caller. */
+void *wined3d_shader_cache_get(struct wined3d_shader_cache *cache, const char *identity,
+        const void *key, size_t key_size, size_t *size)
+{
+    struct wined3d_shader_cache_entry *entry;
+    struct wined3d_shader_cache_key k;
+    struct wine_rb_entry *e;
+    void *data = NULL;
+
+    k.hash = wined3d_shader_cache_hash(key, key_size);
+    k.data = key;
+    k.size = key_size;
+
+    EnterCriticalSection(&cache->cs);
+    if (wined3d_shader_cache_validate(cache, identity) && (e = wine_rb_get(&cache->entries, &k)))
+    {
+        entry = WINE_RB_ENTRY_VALUE(e, struct wined3d_shader_cache_entry, entry);
+        if ((data = malloc(entry->data_size)))
+        {
+            memcpy(data, entry->data + entry->key_size, entry->data_size);
+            *size = entry->data_size;
+            /* Moving the entry only changes eviction order; don't rewrite
+             * the file just for that. */
+            list_remove(&entry->use_entry);
+            list_add_head(&cache->use_list, &entry->use_entry);
+        }
+    }
+    LeaveCriticalSection(&cache->cs);
+
+    TRACE("cache %p, key %s, found %u.\n", cache, wine_dbgstr_longlong(k.hash), !!data);
+
+    return data;
+}
+
+void wined3d_shader_cache_put(struct wined3d_shader_cache *cache, const char *identity,
+        const void *key, size_t key_size, const void *data, size_t size)
+{
+    TRACE("cache %p, key %p, key_size %Iu, data %p, size %Iu.\n", cache, key, key_size, data, size);
+
+    EnterCriticalSection(&cache->cs);
+    if (wined3d_shader_cache_validate(cache, identity)
+            && wined3d_shader_cache_insert(cache, key, key_size, data, size))
+        cache->dirty = true;
+    LeaveCriticalSection(&cache->cs);
+}
@@ -486,6 +486,8 @@ struct wined3d_settings
     enum wined3d_renderer renderer;
     enum wined3d_shader_backend shader_backend;
     BOOL cb_access_map_w;
+    char *shader_cache_path;
+    unsigned int shader_cache_size;
 };
 
 extern struct wined3d_settings wined3d_settings;
@@ -1553,6 +1555,15 @@ extern const struct wined3d_shader_backend_ops none_shader_backend;
 
 const struct wined3d_shader_backend_ops *wined3d_spirv_shader_backend_init_vk(void);
 
+struct wined3d_shader_cache;
+
+struct wined3d_shader_cache *wined3d_shader_cache_create(const char *name);
+void wined3d_shader_cache_destroy(struct wined3d_shader_cache *cache);
+void *wined3d_shader_cache_get(struct wined3d_shader_cache *cache, const char *identity,
+        const void *key, size_t key_size, size_t *size);
+void wined3d_shader_cache_put(struct wined3d_shader_cache *cache, const char *identity,
+        const void *key, size_t key_size, const void *data, size_t size);
+
 #define D3DCOLOR_B_R(dw) (((dw) >> 16) & 0xff)
 #define D3DCOLOR_B_G(dw) (((dw) >>  8) & 0xff)
 #define D3DCOLOR_B_B(dw) (((dw) >>  0) & 0xff)
@@ -418,19 +418,6 @@ static void sync_window_region(struct macdrv_win_data *data, HRGN win_region)
 }
 
 
-/***********************************************************************
- *              add_bounds_rect
- */
-static inline void add_bounds_rect(RECT *bounds, const RECT *rect)
-{
-    if (rect->left >= rect->right || rect->top >= rect->bottom) return;
-    bounds->left   = min(bounds->left, rect->left);
-    bounds->top    = min(bounds->top, rect->top);
-    bounds->right  = max(bounds->right, rect->right);
-    bounds->bottom = max(bounds->bottom, rect->bottom);
-}
-
-
 /***********************************************************************
  *              sync_window_opacity
  */
@@ -460,7 +447,7 @@ static void sync_window_opacity(struct macdrv_win_data *data, BYTE alpha,
         rect = data->whole_rect;
         OffsetRect(&rect, -data->whole_rect.left, -data->whole_rect.top);
         window_surface_lock(data->surface);
-        add_bounds_rect(&data->surface->bounds, &rect);
+        window_surface_add_damage(data->surface, &rect);
         window_surface_unlock(data->surface);
     }
 }
@@ -1587,10 +1587,26 @@ struct x11drv_window_surface
     struct window_surface header;
     Window                window;
     GC                    gc;
-    struct x11drv_image  *image;
+    struct x11drv_image  *image;       /* image used as surface bits, or converted to */
+    struct x11drv_image  *back_image;  /* second image to convert to while the first one is presented */
     BOOL                  byteswap;
+    pthread_mutex_t       lock;        /* protects the pending image and rects */
+    struct x11drv_image  *pending;     /* image to present, NULL if nothing is pending */
+    RECT                  rects[WINDOW_SURFACE_MAX_DAMAGE]; /* rectangles to present from the pending image */
+    UINT                  rect_count;
+    /* fields below are protected by present_mutex */
+    struct list           present_entry; /* entry in the present queue */
+    BOOL                  queued;      /* surface is in the present queue */
+    BOOL                  presenting;  /* surface is being presented by the present thread */
+    struct x11drv_image  *busy;        /* image being presented */
 };
 
+static pthread_mutex_t present_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t present_cond = PTHREAD_COND_INITIALIZER;
+static struct list present_queue = LIST_INIT( present_queue );
+static BOOL present_thread_started;
+static BOOL present_thread_stopped;
+
 static struct x11drv_window_surface *get_x11_surface( struct window_surface *surface )
 {
     return (struct x11drv_window_surface *)surface;
@@ -1785,6 +1801,236 @@ static void x11drv_surface_set_clip( struct window_surface *window_surface, cons
     }
 }
 
+/* copy and convert a rectangle of the surface bits to the XImage data */
+static void copy_surface_rect( const BITMAPINFO *info, const unsigned char *src, unsigned char *dst,
+                               int stride, const RECT *rect, BOOL byteswap, const int *mapping,
+                               unsigned int alpha_bits )
+{
+    int x, y, bpp = info->bmiHeader.biBitCount, width = rect->right - rect->left;
+
+    src += rect->top * stride;
+    dst += rect->top * stride;
+    if (bpp < 8)  /* convert whole rows */
+    {
+        copy_image_byteswap( info, src, dst, stride, stride, rect->bottom - rect->top,
+                             byteswap, mapping, ~0u, alpha_bits );
+        return;
+    }
+
+    src += rect->left * bpp / 8;
+    dst += rect->left * bpp / 8;
+    for (y = rect->top; y < rect->bottom; y++, src += stride, dst += stride)
+    {
+        if (!byteswap && !mapping)
+        {
+            memcpy( dst, src, width * bpp / 8 );
+            continue;
+        }
+        switch (bpp)
+        {
+        case 8:
+            for (x = 0; x < width; x++) dst[x] = mapping[src[x]];
+            break;
+        case 16:
+            for (x = 0; x < width; x++) ((USHORT *)dst)[x] = RtlUshortByteSwap( ((const USHORT *)src)[x] );
+            break;
+        case 24:
+            for (x = 0; x < width; x++)
+            {
+                unsigned char tmp = src[3 * x];
+                dst[3 * x]     = src[3 * x + 2];
+                dst[3 * x + 1] = src[3 * x + 1];
+                dst[3 * x + 2] = tmp;
+            }
+            break;
+        case 32:
+            for (x = 0; x < width; x++) ((ULONG *)dst)[x] = RtlUlongByteSwap( ((const ULONG *)src)[x] | alpha_bits );
+            break;
+        }
+    }
+}
+
+static LONGLONG get_rect_area( const RECT *rect )
+{
+    return (LONGLONG)(rect->right - rect->left) * (rect->bottom - rect->top);
+}
+
+/* add a rectangle to the pending ones, growing it to the area that needs to be updated in the pending image */
+static void add_pending_rect( struct x11drv_window_surface *surface, RECT *rect )
+{
+    LONGLONG growth, min_growth = -1;
+    UINT i, best = 0;
+    RECT tmp;
+
+    for (i = 0; i < surface->rect_count;)
+    {
+        tmp = *rect;
+        add_bounds_rect( &tmp, &surface->rects[i] );
+        if (get_rect_area( &tmp ) > get_rect_area( rect ) + get_rect_area( &surface->rects[i] ))
+        {
+            i++;
+            continue;
+        }
+        *rect = tmp;
+        surface->rects[i] = surface->rects[--surface->rect_count];
+        i = 0;
+    }
+
+    if (surface->rect_count < ARRAY_SIZE(surface->rects))
+    {
+        surface->rects[surface->rect_count++] = *rect;
+        return;
+    }
+
+    for (i = 0; i < surface->rect_count; i++)
+    {
+        tmp = *rect;
+        add_bounds_rect( &tmp, &surface->rects[i] );
+        growth = get_rect_area( &tmp ) - get_rect_area( &surface->rects[i] );
+        if (min_growth != -1 && growth >= min_growth) continue;
+        min_growth = growth;
+        best = i;
+    }
+    add_bounds_rect( rect, &surface->rects[best] );
+    surface->rects[best] = *rect;
+}
+
+/* send the rectangles of an image to the X server */
+static void put_surface_rects( struct x11drv_window_surface *surface, Window window, struct x11drv_image *image,
+                               const RECT *rects, UINT count )
+{
+    const RECT *rect = &surface->header.rect;
+    XImage *ximage = image->ximage;
+    UINT i;
+
+    for (i = 0; i < count; i++)
+    {
+        const RECT *dirty = &rects[i];
+
+        if (!put_shm_image( ximage, &image->shminfo, window, surface->gc, rect, dirty ))
+            XPutImage( gdi_display, window, surface->gc, ximage, dirty->left,
+                       dirty->top, rect->left + dirty->left, rect->top + dirty->top,
+                       dirty->right - dirty->left, dirty->bottom - dirty->top );
+    }
+}
+
+/* start the present thread, present_mutex must be held */
+static BOOL start_present_thread(void)
+{
+    HANDLE thread;
+
+    if (present_thread_started || present_thread_stopped) return present_thread_started;
+    if (!client_present_thread_proc) return FALSE;
+
+    if (NtCreateThreadEx( &thread, THREAD_ALL_ACCESS, NULL, NtCurrentProcess(), client_present_thread_proc,
+                          NULL, 0, 0, 0, 0, NULL ))
+    {
+        WARN( "Failed to start the present thread\n" );
+        client_present_thread_proc = NULL;
+        return FALSE;
+    }
+    NtClose( thread );
+    return (present_thread_started = TRUE);
+}
+
+/* queue the surface for the present thread; return FALSE if it needs to be presented synchronously */
+static BOOL queue_surface_present( struct x11drv_window_surface *surface )
+{
+    BOOL ret;
+
+    pthread_mutex_lock( &present_mutex );
+    if ((ret = start_present_thread() && !present_thread_stopped) && !surface->queued)
+    {
+        list_add_tail( &present_queue, &surface->present_entry );
+        surface->queued = TRUE;
+        pthread_cond_broadcast( &present_cond );
+    }
+    pthread_mutex_unlock( &present_mutex );
+    return ret;
+}
+
+/* present the pending rectangles of a surface */
+static void present_surface( struct x11drv_window_surface *surface )
+{
+    RECT rects[WINDOW_SURFACE_MAX_DAMAGE];
+    struct x11drv_image *image;
+    Window window;
+    UINT count;
+
+    pthread_mutex_lock( &surface->lock );
+    if ((image = surface->pending))
+    {
+        window = surface->window;
+        count = surface->rect_count;
+        memcpy( rects, surface->rects, count * sizeof(*rects) );
+        surface->pending = NULL;
+        surface->rect_count = 0;
+
+        pthread_mutex_lock( &present_mutex );
+        surface->busy = image;
+        pthread_mutex_unlock( &present_mutex );
+    }
+    pthread_mutex_unlock( &surface->lock );
+    if (!image) return;
+
+    if (window) put_surface_rects( surface, window, image, rects, count );
+    /* a converted image can only be written to again once the server is done reading it */
+    if (image->shminfo.shmid != -1 && surface->back_image) XSync( gdi_display, False );
+    else XFlush( gdi_display );
+
+    pthread_mutex_lock( &present_mutex );
+    surface->busy = NULL;
+    pthread_mutex_unlock( &present_mutex );
+}
+
+/***********************************************************************
+ *           x11drv_present_thread
+ *
+ * Thread sending the window surface updates to the X server, so that the
+ * painting threads don't have to wait for it.
+ */
+NTSTATUS x11drv_present_thread( void *arg )
+{
+    struct x11drv_window_surface *surface;
+    struct list *ptr;
+
+    pthread_mutex_lock( &present_mutex );
+    for (;;)
+    {
+        while (!(ptr = list_head( &present_queue )) && !present_thread_stopped)
+            pthread_cond_wait( &present_cond, &present_mutex );
+        if (!ptr) break;
+        surface = LIST_ENTRY( ptr, struct x11drv_window_surface, present_entry );
+        list_remove( &surface->present_entry );
+        surface->queued = FALSE;
+        surface->presenting = TRUE;
+        pthread_mutex_unlock( &present_mutex );
+
+        present_surface( surface );
+
+        pthread_mutex_lock( &present_mutex );
+        surface->presenting = FALSE;
+        pthread_cond_broadcast( &present_cond );
+    }
+    present_thread_started = FALSE;
+    pthread_mutex_unlock( &present_mutex );
+    return 0;
+}
+
+/***********************************************************************
+ *           x11drv_present_thread_stop
+ *
+ * Stop queuing updates to the present thread, and make it exit once it is done.
+ */
+NTSTATUS x11drv_present_thread_stop( void *arg )
+{
+    pthread_mutex_lock( &present_mutex );
+    present_thread_stopped = TRUE;
+    pthread_cond_broadcast( &present_cond );
+    pthread_mutex_unlock( &present_mutex );
+    return 0;
+}
+
 /***********************************************************************
  *           x11drv_surface_flush
  */
@@ -1794,9 +2040,11 @@ static BOOL x11drv_surface_flush( struct window_surface *window_surface, const R
 {
     UINT alpha_mask = window_surface->alpha_mask, alpha_bits = window_surface->alpha_bits;
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
-    XImage *ximage = surface->image->ximage;
-    const unsigned char *src = color_bits;
-    unsigned char *dst = (unsigned char *)ximage->data;
+    const RECT *rects = window_surface->damage_count ? window_surface->damage : dirty;
+    UINT i, count = window_surface->damage_count ? window_surface->damage_count : 1;
+    struct x11drv_image *image = surface->image;
+    XImage *ximage = image->ximage;
+    RECT update;
 
     if (alpha_bits == -1)
     {
@@ -1809,32 +2057,54 @@ static BOOL x11drv_surface_flush( struct window_surface *window_surface, const R
         }
     }
 
-    if (src != dst)
+    pthread_mutex_lock( &surface->lock );
+
+    if (color_bits != ximage->data)
     {
         int map[256], *mapping = get_window_surface_mapping( ximage->bits_per_pixel, map );
-        int width_bytes = ximage->bytes_per_line;
 
-        src += dirty->top * width_bytes;
-        dst += dirty->top * width_bytes;
-        copy_image_byteswap( color_info, src, dst, width_bytes, width_bytes, dirty->bottom - dirty->top,
-                             surface->byteswap, mapping, ~0u, alpha_bits );
+        /* convert to the image that isn't being presented */
+        if (surface->pending) image = surface->pending;
+        else
+        {
+            pthread_mutex_lock( &present_mutex );
+            if (surface->busy == image && surface->back_image) image = surface->back_image;
+            pthread_mutex_unlock( &present_mutex );
+            surface->pending = image;
+        }
+        for (i = 0; i < count; i++)
+        {
+            update = rects[i];
+            add_pending_rect( surface, &update );
+            copy_surface_rect( color_info, color_bits, (unsigned char *)image->ximage->data,
+                               ximage->bytes_per_line, &update, surface->byteswap, mapping, alpha_bits );
+        }
     }
-    else if (alpha_bits)
+    else
     {
         int x, y, stride = ximage->bytes_per_line / sizeof(ULONG);
-        ULONG *ptr = (ULONG *)dst + dirty->top * stride;
 
-        for (y = dirty->top; y < dirty->bottom; y++, ptr += stride)
-            for (x = dirty->left; x < dirty->right; x++)
-                ptr[x] |= alpha_bits;
+        for (i = 0; i < count; i++)
+        {
+            update = rects[i];
+            add_pending_rect( surface, &update );
+            if (!alpha_bits) continue;
+            for (y = rects[i].top; y < rects[i].bottom; y++)
+            {
+                ULONG *ptr = (ULONG *)ximage->data + y * stride;
+                for (x = rects[i].left; x < rects[i].right; x++) ptr[x] |= alpha_bits;
+            }
+        }
+        surface->pending = image;
     }
 
-    if (!put_shm_image( ximage, &surface->image->shminfo, surface->window, surface->gc, rect, dirty ))
-        XPutImage( gdi_display, surface->window, surface->gc, ximage, dirty->left,
-                   dirty->top, rect->left + dirty->left, rect->top + dirty->top,
-                   dirty->right - dirty->left, dirty->bottom - dirty->top );
+    pthread_mutex_unlock( &surface->lock );
 
-    if (shape_changed)
+    /* the surface bits are read when sending them without XShm, so do it while the surface is locked */
+    if ((image->shminfo.shmid == -1 && !surface->back_image) || !queue_surface_present( surface ))
+        present_surface( surface );
+
+    if (shape_changed && surface->window)
     {
 #ifdef HAVE_LIBXSHAPE
         if (!shape_bits)
@@ -1851,10 +2121,9 @@ static BOOL x11drv_surface_flush( struct window_surface *window_surface, const R
             XFreePixmap( gdi_display, shape );
         }
 #endif /* HAVE_LIBXSHAPE */
+        XFlush( gdi_display );
     }
 
-    XFlush( gdi_display );
-
     return TRUE;
 }
 
@@ -1866,8 +2135,17 @@ static void x11drv_surface_destroy( struct window_surface *window_surface )
     struct x11drv_window_surface *surface = get_x11_surface( window_surface );
 
     TRACE( "freeing %p\n", surface );
+
+    /* make sure that the present thread is done with it */
+    pthread_mutex_lock( &present_mutex );
+    if (surface->queued) list_remove( &surface->present_entry );
+    while (surface->presenting) pthread_cond_wait( &present_cond, &present_mutex );
+    pthread_mutex_unlock( &present_mutex );
+
     if (surface->gc) XFreeGC( gdi_display, surface->gc );
     if (surface->image) x11drv_image_destroy( surface->image );
+    if (surface->back_image) x11drv_image_destroy( surface->back_image );
+    pthread_mutex_destroy( &surface->lock );
     free( surface );
 }
 
@@ -1940,6 +2218,10 @@ static struct window_surface *create_surface( HWND hwnd, Window window, const XV
     }
     surface->image = image;
     surface->byteswap = byteswap;
+    pthread_mutex_init( &surface->lock, NULL );
+    /* converted images are double-buffered, so that one can be updated while the other is presented */
+    if (!bitmap && !(surface->back_image = x11drv_image_create( info, vis )))
+        WARN( "Failed to create back buffer image\n" );
 
     if (!window_surface_init( &surface->header, &x11drv_surface_funcs, hwnd, rect, info, bitmap )) goto failed;
 
@@ -1956,6 +2238,29 @@ failed:
     return NULL;
 }
 
+/***********************************************************************
+ *           detach_surface_window
+ *
+ * Stop presenting a surface to its X window, which is about to be destroyed.
+ */
+void detach_surface_window( struct window_surface *window_surface )
+{
+    struct x11drv_window_surface *surface = get_x11_surface( window_surface );
+
+    if (window_surface->funcs != &x11drv_surface_funcs) return;  /* we may get the null surface */
+
+    pthread_mutex_lock( &surface->lock );
+    surface->window = 0;
+    pthread_mutex_unlock( &surface->lock );
+
+    /* wait for the present thread to be done with the window */
+    pthread_mutex_lock( &present_mutex );
+    if (surface->queued) list_remove( &surface->present_entry );
+    surface->queued = FALSE;
+    while (surface->presenting) pthread_cond_wait( &present_cond, &present_mutex );
+    pthread_mutex_unlock( &present_mutex );
+}
+
 /***********************************************************************
  *           expose_surface
  */
@@ -1968,7 +2273,7 @@ HRGN expose_surface( struct window_surface *window_surface, const RECT *rect )
 
     window_surface_lock( window_surface );
     OffsetRect( &rc, -window_surface->rect.left, -window_surface->rect.top );
-    add_bounds_rect( &window_surface->bounds, &rc );
+    window_surface_add_damage( window_surface, &rc );
     if (window_surface->clip_region)
     {
         region = NtGdiCreateRectRgn( rect->left, rect->top, rect->right, rect->bottom );
@@ -37,14 +37,28 @@ static const KERNEL_CALLBACK_PROC kernel_callbacks[] =
 C_ASSERT( NtUserDriverCallbackFirst + ARRAYSIZE(kernel_callbacks) == client_func_last );
 
 
+/* started from the unix side on the first asynchronous surface flush */
+static void WINAPI present_thread_proc( void *arg )
+{
+    HMODULE module;
+
+    /* keep the module loaded while the thread is running */
+    GetModuleHandleExW( GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, (const WCHAR *)present_thread_proc, &module );
+    SetThreadDescription( GetCurrentThread(), L"wine_x11drv_present" );
+    X11DRV_CALL( present_thread, NULL );
+    FreeLibraryAndExitThread( module, 0 );
+}
+
 BOOL WINAPI DllMain( HINSTANCE instance, DWORD reason, void *reserved )
 {
     KERNEL_CALLBACK_PROC *callback_table;
     struct init_params params =
     {
         foreign_window_proc,
+        present_thread_proc,
     };
 
+    if (reason == DLL_PROCESS_DETACH) X11DRV_CALL( present_thread_stop, NULL );
     if (reason != DLL_PROCESS_ATTACH) return TRUE;
 
     DisableThreadLibraryCalls( instance );
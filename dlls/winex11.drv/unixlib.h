@@ -26,6 +26,8 @@ enum x11drv_funcs
     unix_tablet_get_packet,
     unix_tablet_info,
     unix_tablet_load_info,
+    unix_present_thread,
+    unix_present_thread_stop,
     unix_funcs_count,
 };
 
@@ -35,6 +37,7 @@ enum x11drv_funcs
 struct init_params
 {
     WNDPROC foreign_window_proc;
+    PRTL_THREAD_START_ROUTINE present_thread_proc;
 };
 
 /* x11drv_tablet_info params */
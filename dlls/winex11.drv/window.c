@@ -1864,6 +1864,7 @@ static void destroy_whole_window( struct x11drv_win_data *data, BOOL already_des
     else
     {
         XDeleteContext( data->display, data->whole_window, winContext );
+        if (data->surface) detach_surface_window( data->surface );
         if (!already_destroyed)
         {
             XSync( gdi_display, False ); /* make sure XReparentWindow requests have completed before destroying whole_window */
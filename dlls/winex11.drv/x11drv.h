@@ -266,6 +266,7 @@ extern Pixmap create_pixmap_from_image( HDC hdc, const XVisualInfo *vis, const B
 extern DWORD get_pixmap_image( Pixmap pixmap, int width, int height, const XVisualInfo *vis,
                                BITMAPINFO *info, struct gdi_image_bits *bits );
 extern HRGN expose_surface( struct window_surface *window_surface, const RECT *rect );
+extern void detach_surface_window( struct window_surface *window_surface );
 
 extern RGNDATA *X11DRV_GetRegionData( HRGN hrgn, HDC hdc_lptodp );
 extern BOOL add_extra_clipping_region( X11DRV_PDEVICE *dev, HRGN rgn );
@@ -442,6 +443,7 @@ extern int xrender_error_base;
 extern char *process_name;
 extern Display *clipboard_display;
 extern WNDPROC client_foreign_window_proc;
+extern PRTL_THREAD_START_ROUTINE client_present_thread_proc;
 
 /* atoms */
 
@@ -841,6 +843,8 @@ static inline BOOL is_window_rect_mapped( const RECT *rect )
 
 /* unixlib interface */
 
+extern NTSTATUS x11drv_present_thread( void *arg );
+extern NTSTATUS x11drv_present_thread_stop( void *arg );
 extern NTSTATUS x11drv_tablet_attach_queue( void *arg );
 extern NTSTATUS x11drv_tablet_get_packet( void *arg );
 extern NTSTATUS x11drv_tablet_load_info( void *arg );
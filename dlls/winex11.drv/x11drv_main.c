@@ -87,6 +87,7 @@ int alloc_system_colors = 256;
 int xrender_error_base = 0;
 char *process_name = NULL;
 WNDPROC client_foreign_window_proc = NULL;
+PRTL_THREAD_START_ROUTINE client_present_thread_proc = NULL;
 
 static x11drv_error_callback err_callback;   /* current callback for error */
 static Display *err_callback_display;        /* display callback is set for */
@@ -648,6 +649,7 @@ static NTSTATUS x11drv_init( void *arg )
     if (!(display = XOpenDisplay( NULL ))) return STATUS_UNSUCCESSFUL;
 
     client_foreign_window_proc = params->foreign_window_proc;
+    client_present_thread_proc = params->present_thread_proc;
 
     fcntl( ConnectionNumber(display), F_SETFD, 1 ); /* set close on exec flag */
     root_window = DefaultRootWindow( display );
@@ -820,6 +822,8 @@ const unixlib_entry_t __wine_unix_call_funcs[] =
     x11drv_tablet_get_packet,
     x11drv_tablet_info,
     x11drv_tablet_load_info,
+    x11drv_present_thread,
+    x11drv_present_thread_stop,
 };
 
 
@@ -833,10 +837,12 @@ static NTSTATUS x11drv_wow64_init( void *arg )
     struct
     {
         ULONG foreign_window_proc;
+        ULONG present_thread_proc;
     } *params32 = arg;
     struct init_params params;
 
     params.foreign_window_proc = UlongToPtr( params32->foreign_window_proc );
+    params.present_thread_proc = UlongToPtr( params32->present_thread_proc );
     return x11drv_init( &params );
 }
 
@@ -869,6 +875,8 @@ const unixlib_entry_t __wine_unix_call_wow64_funcs[] =
     x11drv_wow64_tablet_get_packet,
     x11drv_wow64_tablet_info,
     x11drv_tablet_load_info,
+    x11drv_present_thread,
+    x11drv_present_thread_stop,
 };
 
 C_ASSERT( ARRAYSIZE(__wine_unix_call_wow64_funcs) == unix_funcs_count );
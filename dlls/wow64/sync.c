@@ -146,6 +146,24 @@ NTSTATUS WINAPI wow64_NtAcceptConnectPort( UINT *args )
 }
 
 
+/**********************************************************************
+ *           wow64_NtAssociateWaitCompletionPacket
+ */
+NTSTATUS WINAPI wow64_NtAssociateWaitCompletionPacket( UINT *args )
+{
+    HANDLE packet = get_handle( &args );
+    HANDLE completion = get_handle( &args );
+    HANDLE target = get_handle( &args );
+    void *key = get_ptr( &args );
+    void *value = get_ptr( &args );
+    NTSTATUS status = get_ulong( &args );
+    ULONG_PTR info = get_ulong( &args );
+    BOOLEAN *signaled = get_ptr( &args );
+
+    return NtAssociateWaitCompletionPacket( packet, completion, target, key, value, status, info, signaled );
+}
+
+
 /**********************************************************************
  *           wow64_NtCancelTimer
  */
@@ -158,6 +176,18 @@ NTSTATUS WINAPI wow64_NtCancelTimer( UINT *args )
 }
 
 
+/**********************************************************************
+ *           wow64_NtCancelWaitCompletionPacket
+ */
+NTSTATUS WINAPI wow64_NtCancelWaitCompletionPacket( UINT *args )
+{
+    HANDLE handle = get_handle( &args );
+    BOOLEAN remove_signaled = get_ulong( &args );
+
+    return NtCancelWaitCompletionPacket( handle, remove_signaled );
+}
+
+
 /**********************************************************************
  *           wow64_NtClearEvent
  */
@@ -470,6 +500,26 @@ NTSTATUS WINAPI wow64_NtCreateTimer( UINT *args )
 }
 
 
+/**********************************************************************
+ *           wow64_NtCreateWaitCompletionPacket
+ */
+NTSTATUS WINAPI wow64_NtCreateWaitCompletionPacket( UINT *args )
+{
+    ULONG *handle_ptr = get_ptr( &args );
+    ACCESS_MASK access = get_ulong( &args );
+    OBJECT_ATTRIBUTES32 *attr32 = get_ptr( &args );
+
+    struct object_attr64 attr;
+    HANDLE handle = 0;
+    NTSTATUS status;
+
+    *handle_ptr = 0;
+    status = NtCreateWaitCompletionPacket( &handle, access, objattr_32to64( &attr, attr32 ));
+    put_handle( handle_ptr, handle );
+    return status;
+}
+
+
 /**********************************************************************
  *           wow64_NtDebugContinue
  */
@@ -179,7 +179,7 @@ struct gdi_dc_funcs
 };
 
 /* increment this when you change the DC function table */
-#define WINE_GDI_DRIVER_VERSION 88
+#define WINE_GDI_DRIVER_VERSION 89
 
 #define GDI_PRIORITY_NULL_DRV        0  /* null driver */
 #define GDI_PRIORITY_FONT_DRV      100  /* any font driver */
@@ -218,6 +218,8 @@ struct window_surface_funcs
     void  (*destroy)( struct window_surface *surface );
 };
 
+#define WINDOW_SURFACE_MAX_DAMAGE 16  /* max. number of dirty rectangles tracked per surface */
+
 struct window_surface
 {
     const struct window_surface_funcs *funcs; /* driver-specific implementations  */
@@ -228,6 +230,8 @@ struct window_surface
 
     pthread_mutex_t                    mutex;        /* mutex needed for any field below */
     RECT                               bounds;       /* dirty area rectangle */
+    RECT                               damage[WINDOW_SURFACE_MAX_DAMAGE]; /* dirty rectangles, within bounds */
+    UINT                               damage_count; /* number of dirty rectangles, 0 if all of bounds is dirty */
     HRGN                               clip_region;  /* visible region of the surface, fully visible if 0 */
     DWORD                              draw_start_ticks; /* start ticks of fresh draw */
     COLORREF                           color_key;    /* layered window surface color key, invalid if CLR_INVALID */
@@ -247,6 +251,7 @@ W32KAPI void window_surface_lock( struct window_surface *surface );
 W32KAPI void window_surface_unlock( struct window_surface *surface );
 W32KAPI void window_surface_set_layered( struct window_surface *surface, COLORREF color_key, UINT alpha_bits, UINT alpha_mask );
 W32KAPI void window_surface_flush( struct window_surface *surface );
+W32KAPI void window_surface_add_damage( struct window_surface *surface, const RECT *rect );
 W32KAPI void window_surface_set_clip( struct window_surface *surface, HRGN clip_region );
 W32KAPI void window_surface_set_shape( struct window_surface *surface, HRGN shape_region );
 W32KAPI void window_surface_set_layered( struct window_surface *surface, COLORREF color_key, UINT alpha_bits, UINT alpha_mask );
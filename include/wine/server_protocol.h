@@ -923,11 +923,29 @@ typedef volatile struct
     int                  keystate_lock;
 } input_shm_t;
 
+typedef volatile struct
+{
+    user_handle_t        handle;
+    user_handle_t        parent;
+    user_handle_t        owner;
+    process_id_t         pid;
+    thread_id_t          tid;
+    unsigned int         style;
+    unsigned int         ex_style;
+    unsigned int         dpi;
+    lparam_t             id;
+    mod_handle_t         instance;
+    lparam_t             user_data;
+    rectangle_t          window_rect;
+    rectangle_t          client_rect;
+} window_shm_t;
+
 typedef volatile union
 {
     desktop_shm_t        desktop;
     queue_shm_t          queue;
     input_shm_t          input;
+    window_shm_t         window;
 } object_shm_t;
 
 typedef volatile struct
@@ -945,6 +963,40 @@ typedef struct
 
 
 
+enum fsync_type
+{
+    FSYNC_NONE = 0,
+    FSYNC_EVENT,
+    FSYNC_MUTEX,
+    FSYNC_SEMAPHORE
+};
+
+typedef volatile struct
+{
+    int                  state;
+    int                  count;
+    int                  waiters;
+    int                  abandoned;
+} fsync_shm_t;
+
+
+#define FSYNC_EVENT_SIGNALED  0x1
+#define FSYNC_EVENT_PULSED    0x2
+#define FSYNC_EVENT_PULSE_GEN 0x4
+
+
+#define FSYNC_THREAD_MUTEXES  31
+typedef volatile struct
+{
+    int                  pending;
+    int                  mutexes[FSYNC_THREAD_MUTEXES];
+} fsync_thread_t;
+
+#define FSYNC_BLOCK_SIZE  0x10000
+#define FSYNC_MAX_BLOCKS  1024
+
+
+
 
 
 struct new_process_request
@@ -1531,6 +1583,46 @@ struct open_event_reply
 
 
 
+struct get_fsync_idx_request
+{
+    struct request_header __header;
+    obj_handle_t  handle;
+};
+struct get_fsync_idx_reply
+{
+    struct reply_header __header;
+    unsigned int  shm_idx;
+    int           type;
+    unsigned int  access;
+    char __pad_20[4];
+};
+
+
+struct fsync_wake_request
+{
+    struct request_header __header;
+    obj_handle_t  handle;
+};
+struct fsync_wake_reply
+{
+    struct reply_header __header;
+};
+
+
+struct get_fsync_thread_idx_request
+{
+    struct request_header __header;
+    char __pad_12[4];
+};
+struct get_fsync_thread_idx_reply
+{
+    struct reply_header __header;
+    unsigned int  shm_idx;
+    char __pad_12[4];
+};
+
+
+
 struct create_keyed_event_request
 {
     struct request_header __header;
@@ -3381,6 +3473,7 @@ struct get_window_info_reply
     int            is_unicode;
     unsigned int   dpi_context;
     char __pad_36[4];
+    obj_locator_t  locator;
 };
 
 
@@ -5326,6 +5419,56 @@ struct query_completion_reply
 
 
 
+struct create_wait_completion_packet_request
+{
+    struct request_header __header;
+    unsigned int access;
+    /* VARARG(objattr,object_attributes); */
+};
+struct create_wait_completion_packet_reply
+{
+    struct reply_header __header;
+    obj_handle_t handle;
+    char __pad_12[4];
+};
+
+
+
+struct associate_wait_completion_packet_request
+{
+    struct request_header __header;
+    obj_handle_t  packet;
+    obj_handle_t  completion;
+    obj_handle_t  target;
+    apc_param_t   ckey;
+    apc_param_t   cvalue;
+    apc_param_t   information;
+    unsigned int  status;
+    char __pad_52[4];
+};
+struct associate_wait_completion_packet_reply
+{
+    struct reply_header __header;
+    int           signaled;
+    char __pad_12[4];
+};
+
+
+
+struct cancel_wait_completion_packet_request
+{
+    struct request_header __header;
+    obj_handle_t  packet;
+    int           remove_signaled;
+    char __pad_20[4];
+};
+struct cancel_wait_completion_packet_reply
+{
+    struct reply_header __header;
+};
+
+
+
 struct set_completion_info_request
 {
     struct request_header __header;
@@ -5758,6 +5901,9 @@ enum request
     REQ_event_op,
     REQ_query_event,
     REQ_open_event,
+    REQ_get_fsync_idx,
+    REQ_fsync_wake,
+    REQ_get_fsync_thread_idx,
     REQ_create_keyed_event,
     REQ_open_keyed_event,
     REQ_create_mutex,
@@ -5985,6 +6131,9 @@ enum request
     REQ_add_completion,
     REQ_remove_completion,
     REQ_query_completion,
+    REQ_create_wait_completion_packet,
+    REQ_associate_wait_completion_packet,
+    REQ_cancel_wait_completion_packet,
     REQ_set_completion_info,
     REQ_add_fd_completion,
     REQ_set_fd_completion_mode,
@@ -6051,6 +6200,9 @@ union generic_request
     struct event_op_request event_op_request;
     struct query_event_request query_event_request;
     struct open_event_request open_event_request;
+    struct get_fsync_idx_request get_fsync_idx_request;
+    struct fsync_wake_request fsync_wake_request;
+    struct get_fsync_thread_idx_request get_fsync_thread_idx_request;
     struct create_keyed_event_request create_keyed_event_request;
     struct open_keyed_event_request open_keyed_event_request;
     struct create_mutex_request create_mutex_request;
@@ -6278,6 +6430,9 @@ union generic_request
     struct add_completion_request add_completion_request;
     struct remove_completion_request remove_completion_request;
     struct query_completion_request query_completion_request;
+    struct create_wait_completion_packet_request create_wait_completion_packet_request;
+    struct associate_wait_completion_packet_request associate_wait_completion_packet_request;
+    struct cancel_wait_completion_packet_request cancel_wait_completion_packet_request;
     struct set_completion_info_request set_completion_info_request;
     struct add_fd_completion_request add_fd_completion_request;
     struct set_fd_completion_mode_request set_fd_completion_mode_request;
@@ -6342,6 +6497,9 @@ union generic_reply
     struct event_op_reply event_op_reply;
     struct query_event_reply query_event_reply;
     struct open_event_reply open_event_reply;
+    struct get_fsync_idx_reply get_fsync_idx_reply;
+    struct fsync_wake_reply fsync_wake_reply;
+    struct get_fsync_thread_idx_reply get_fsync_thread_idx_reply;
     struct create_keyed_event_reply create_keyed_event_reply;
     struct open_keyed_event_reply open_keyed_event_reply;
     struct create_mutex_reply create_mutex_reply;
@@ -6569,6 +6727,9 @@ union generic_reply
     struct add_completion_reply add_completion_reply;
     struct remove_completion_reply remove_completion_reply;
     struct query_completion_reply query_completion_reply;
+    struct create_wait_completion_packet_reply create_wait_completion_packet_reply;
+    struct associate_wait_completion_packet_reply associate_wait_completion_packet_reply;
+    struct cancel_wait_completion_packet_reply cancel_wait_completion_packet_reply;
     struct set_completion_info_reply set_completion_info_reply;
     struct add_fd_completion_reply add_fd_completion_reply;
     struct set_fd_completion_mode_reply set_fd_completion_mode_reply;
@@ -6599,7 +6760,7 @@ union generic_reply
 
 /* ### protocol_version begin ### */
 
-#define SERVER_PROTOCOL_VERSION 837
+#define SERVER_PROTOCOL_VERSION 841
 
 /* ### protocol_version end ### */
 
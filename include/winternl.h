@@ -527,7 +527,8 @@ typedef struct _TEB
     ULONG                        IsImpersonating;                   /* f9c/179c */
     PVOID                        NlsCache;                          /* fa0/17a0 */
     PVOID                        ShimData;                          /* fa4/17a8 */
-    ULONG                        HeapVirtualAffinity;               /* fa8/17b0 */
+    USHORT                       HeapVirtualAffinity;               /* fa8/17b0 */
+    USHORT                       LowFragHeapDataSlot;               /* faa/17b2 */
     PVOID                        CurrentTransactionHandle;          /* fac/17b8 */
     TEB_ACTIVE_FRAME            *ActiveFrame;                       /* fb0/17c0 */
     TEB_FLS_DATA                *FlsSlots;                          /* fb4/17c8 */
@@ -1056,7 +1057,8 @@ typedef struct _TEB32
     ULONG                        IsImpersonating;                   /* 0f9c */
     ULONG                        NlsCache;                          /* 0fa0 */
     ULONG                        ShimData;                          /* 0fa4 */
-    ULONG                        HeapVirtualAffinity;               /* 0fa8 */
+    USHORT                       HeapVirtualAffinity;               /* 0fa8 */
+    USHORT                       LowFragHeapDataSlot;               /* 0faa */
     ULONG                        CurrentTransactionHandle;          /* 0fac */
     ULONG                        ActiveFrame;                       /* 0fb0 */
     ULONG                        FlsSlots;                          /* 0fb4 */
@@ -1162,7 +1164,8 @@ typedef struct _TEB64
     ULONG                        IsImpersonating;                   /* 179c */
     ULONG64                      NlsCache;                          /* 17a0 */
     ULONG64                      ShimData;                          /* 17a8 */
-    ULONG                        HeapVirtualAffinity;               /* 17b0 */
+    USHORT                       HeapVirtualAffinity;               /* 17b0 */
+    USHORT                       LowFragHeapDataSlot;               /* 17b2 */
     ULONG64                      CurrentTransactionHandle;          /* 17b8 */
     ULONG64                      ActiveFrame;                       /* 17c0 */
     ULONG64                      FlsSlots;                          /* 17c8 */
@@ -4402,11 +4405,13 @@ NTSYSAPI NTSTATUS  WINAPI NtAllocateVirtualMemory(HANDLE,PVOID*,ULONG_PTR,SIZE_T
 NTSYSAPI NTSTATUS  WINAPI NtAllocateVirtualMemoryEx(HANDLE,PVOID*,SIZE_T*,ULONG,ULONG,MEM_EXTENDED_PARAMETER*,ULONG);
 NTSYSAPI NTSTATUS  WINAPI NtAreMappedFilesTheSame(PVOID,PVOID);
 NTSYSAPI NTSTATUS  WINAPI NtAssignProcessToJobObject(HANDLE,HANDLE);
+NTSYSAPI NTSTATUS  WINAPI NtAssociateWaitCompletionPacket(HANDLE,HANDLE,HANDLE,void*,void*,NTSTATUS,ULONG_PTR,BOOLEAN*);
 NTSYSAPI NTSTATUS  WINAPI NtCallbackReturn(PVOID,ULONG,NTSTATUS);
 NTSYSAPI NTSTATUS  WINAPI NtCancelIoFile(HANDLE,PIO_STATUS_BLOCK);
 NTSYSAPI NTSTATUS  WINAPI NtCancelIoFileEx(HANDLE,PIO_STATUS_BLOCK,PIO_STATUS_BLOCK);
 NTSYSAPI NTSTATUS  WINAPI NtCancelSynchronousIoFile(HANDLE,PIO_STATUS_BLOCK,PIO_STATUS_BLOCK);
 NTSYSAPI NTSTATUS  WINAPI NtCancelTimer(HANDLE, BOOLEAN*);
+NTSYSAPI NTSTATUS  WINAPI NtCancelWaitCompletionPacket(HANDLE,BOOLEAN);
 NTSYSAPI NTSTATUS  WINAPI NtClearEvent(HANDLE);
 NTSYSAPI NTSTATUS  WINAPI NtClose(HANDLE);
 NTSYSAPI NTSTATUS  WINAPI NtCloseObjectAuditAlarm(PUNICODE_STRING,HANDLE,BOOLEAN);
@@ -4443,6 +4448,7 @@ NTSYSAPI NTSTATUS  WINAPI NtCreateTimer(HANDLE*, ACCESS_MASK, const OBJECT_ATTRI
 NTSYSAPI NTSTATUS  WINAPI NtCreateToken(PHANDLE,ACCESS_MASK,POBJECT_ATTRIBUTES,TOKEN_TYPE,PLUID,PLARGE_INTEGER,PTOKEN_USER,PTOKEN_GROUPS,PTOKEN_PRIVILEGES,PTOKEN_OWNER,PTOKEN_PRIMARY_GROUP,PTOKEN_DEFAULT_DACL,PTOKEN_SOURCE);
 NTSYSAPI NTSTATUS  WINAPI NtCreateTransaction(PHANDLE,ACCESS_MASK,POBJECT_ATTRIBUTES,LPGUID,HANDLE,ULONG,ULONG,ULONG,PLARGE_INTEGER,PUNICODE_STRING);
 NTSYSAPI NTSTATUS  WINAPI NtCreateUserProcess(HANDLE*,HANDLE*,ACCESS_MASK,ACCESS_MASK,OBJECT_ATTRIBUTES*,OBJECT_ATTRIBUTES*,ULONG,ULONG,RTL_USER_PROCESS_PARAMETERS*,PS_CREATE_INFO*,PS_ATTRIBUTE_LIST*);
+NTSYSAPI NTSTATUS  WINAPI NtCreateWaitCompletionPacket(HANDLE*,ACCESS_MASK,OBJECT_ATTRIBUTES*);
 NTSYSAPI NTSTATUS  WINAPI NtDebugActiveProcess(HANDLE,HANDLE);
 NTSYSAPI NTSTATUS  WINAPI NtDebugContinue(HANDLE,CLIENT_ID*,NTSTATUS);
 NTSYSAPI NTSTATUS  WINAPI NtDelayExecution(BOOLEAN,const LARGE_INTEGER*);
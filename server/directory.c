@@ -158,6 +158,7 @@ static struct type_descr *types[] =
     &desktop_type,
     &device_type,
     &completion_type,
+    &wait_completion_packet_type,
     &file_type,
     &mapping_type,
     &key_type,
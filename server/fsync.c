@@ -0,0 +1,450 @@
+/*
+ * Server-side fast synchronization support
+ *
+ * Copyright 2026 agent
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301, USA
+ */
+
+/*
+ * Events, mutexes and semaphores created while fast synchronization is
+ * enabled (WINEFSYNC=1) keep their state in a file shared between the
+ * server and all client processes, so that ntdll can signal and wait on
+ * them with futexes without a server round-trip. The server still owns
+ * the objects; it allocates their slots, performs all operations that
+ * clients can't do themselves (alertable and wait-all waits, waits mixed
+ * with other object types, abandoned mutexes) and reads the shared state
+ * whenever it needs to know whether an object is signaled.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef HAVE_SYS_SYSCALL_H
+# include <sys/syscall.h>
+#endif
+#ifdef __linux__
+# include <linux/futex.h>
+#endif
+
+#include "ntstatus.h"
+#define WIN32_NO_STATUS
+#include "windef.h"
+#include "winternl.h"
+
+#include "handle.h"
+#include "thread.h"
+#include "request.h"
+
+#define FSYNC_OBJS_PER_BLOCK (FSYNC_BLOCK_SIZE / sizeof(fsync_shm_t))
+#define FSYNC_THREAD_SLOTS   (sizeof(fsync_thread_t) / sizeof(fsync_shm_t))
+
+C_ASSERT( sizeof(fsync_thread_t) % sizeof(fsync_shm_t) == 0 );
+C_ASSERT( FSYNC_OBJS_PER_BLOCK % FSYNC_THREAD_SLOTS == 0 );
+
+struct free_list
+{
+    unsigned int *idx;
+    unsigned int  count;
+    unsigned int  size;
+};
+
+static int fsync_enabled = -1;
+static int fsync_fd = -1;
+static fsync_shm_t *fsync_blocks[FSYNC_MAX_BLOCKS];
+static struct object **fsync_objects[FSYNC_MAX_BLOCKS];  /* objects owning the slots */
+static unsigned int fsync_block_count;
+static unsigned int fsync_next_idx = 1;  /* index 0 means no shared state */
+static struct free_list free_objects;
+static struct free_list free_threads;
+
+int do_fsync(void)
+{
+#ifdef __linux__
+    if (fsync_enabled == -1)
+    {
+        const char *env = getenv( "WINEFSYNC" );
+        fsync_enabled = env && atoi( env );
+    }
+    return fsync_enabled;
+#else
+    return 0;
+#endif
+}
+
+/* create the shared file; must be called from the server directory */
+void fsync_init(void)
+{
+    if (!do_fsync()) return;
+
+    if ((fsync_fd = open( "fsync", O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600 )) == -1)
+    {
+        fprintf( stderr, "wineserver: cannot create fsync shared memory: %s\n", strerror( errno ));
+        fsync_enabled = 0;
+        return;
+    }
+    if (debug_level) fprintf( stderr, "wineserver: fast synchronization enabled\n" );
+}
+
+static fsync_shm_t *get_fsync_shm( unsigned int idx )
+{
+    return &fsync_blocks[idx / FSYNC_OBJS_PER_BLOCK][idx % FSYNC_OBJS_PER_BLOCK];
+}
+
+/* make sure the block containing idx is allocated and mapped */
+static int grow_fsync_file( unsigned int idx )
+{
+    unsigned int block = idx / FSYNC_OBJS_PER_BLOCK;
+    struct object **objects;
+    void *ptr;
+
+    if (block >= FSYNC_MAX_BLOCKS) return 0;
+    while (fsync_block_count <= block)
+    {
+        if (!(objects = calloc( FSYNC_OBJS_PER_BLOCK, sizeof(*objects) ))) return 0;
+        if (ftruncate( fsync_fd, (off_t)(fsync_block_count + 1) * FSYNC_BLOCK_SIZE ) == -1 ||
+            (ptr = mmap( NULL, FSYNC_BLOCK_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fsync_fd,
+                         (off_t)fsync_block_count * FSYNC_BLOCK_SIZE )) == MAP_FAILED)
+        {
+            free( objects );
+            return 0;
+        }
+        fsync_objects[fsync_block_count] = objects;
+        fsync_blocks[fsync_block_count++] = ptr;
+    }
+    return 1;
+}
+
+static void push_free_idx( struct free_list *list, unsigned int idx )
+{
+    if (list->count == list->size)
+    {
+        unsigned int new_size = max( 64, list->size * 2 );
+        unsigned int *new_list = realloc( list->idx, new_size * sizeof(*new_list) );
+
+        if (!new_list) return;  /* leak the slot */
+        list->idx  = new_list;
+        list->size = new_size;
+    }
+    list->idx[list->count++] = idx;
+}
+
+/* allocate a slot for a new object; returns 0 if the object has to use the server path */
+unsigned int fsync_alloc_shm( struct object *obj, int state, int count )
+{
+    fsync_shm_t *shm;
+    unsigned int idx;
+
+    if (!do_fsync() || fsync_fd == -1) return 0;
+
+    if (free_objects.count) idx = free_objects.idx[--free_objects.count];
+    else
+    {
+        if (!grow_fsync_file( fsync_next_idx )) return 0;
+        idx = fsync_next_idx++;
+    }
+
+    fsync_objects[idx / FSYNC_OBJS_PER_BLOCK][idx % FSYNC_OBJS_PER_BLOCK] = obj;
+    shm = get_fsync_shm( idx );
+    shm->count     = count;
+    shm->waiters   = 0;
+    shm->abandoned = 0;
+    __atomic_store_n( &shm->state, state, __ATOMIC_SEQ_CST );
+    return idx;
+}
+
+void fsync_free_shm( unsigned int idx )
+{
+    if (!idx) return;
+    fsync_objects[idx / FSYNC_OBJS_PER_BLOCK][idx % FSYNC_OBJS_PER_BLOCK] = NULL;
+    push_free_idx( &free_objects, idx );
+}
+
+/* return the object owning a slot, if any */
+struct object *fsync_get_object( unsigned int idx )
+{
+    if (!idx || idx >= fsync_next_idx) return NULL;
+    return fsync_objects[idx / FSYNC_OBJS_PER_BLOCK][idx % FSYNC_OBJS_PER_BLOCK];
+}
+
+/* allocate the owned mutexes record of a thread; records take several consecutive slots */
+static unsigned int alloc_fsync_thread(void)
+{
+    fsync_thread_t *record;
+    unsigned int idx;
+
+    if (fsync_fd == -1) return 0;
+
+    if (free_threads.count) idx = free_threads.idx[--free_threads.count];
+    else
+    {
+        idx = (fsync_next_idx + FSYNC_THREAD_SLOTS - 1) / FSYNC_THREAD_SLOTS * FSYNC_THREAD_SLOTS;
+        if (!grow_fsync_file( idx )) return 0;
+        /* the slots skipped for alignment can still be used by objects */
+        while (fsync_next_idx < idx) push_free_idx( &free_objects, fsync_next_idx++ );
+        fsync_next_idx = idx + FSYNC_THREAD_SLOTS;
+    }
+
+    record = (fsync_thread_t *)get_fsync_shm( idx );
+    memset( (void *)record, 0, sizeof(*record) );
+    return idx;
+}
+
+void fsync_free_thread( unsigned int idx )
+{
+    if (idx) push_free_idx( &free_threads, idx );
+}
+
+const fsync_thread_t *fsync_get_thread( unsigned int idx )
+{
+    return (const fsync_thread_t *)get_fsync_shm( idx );
+}
+
+/* forget about a mutex in the record of the thread owning it, as its slot is going away */
+void fsync_clear_thread_mutex( unsigned int thread_idx, unsigned int idx )
+{
+    fsync_thread_t *record = (fsync_thread_t *)get_fsync_shm( thread_idx );
+    int expected;
+    unsigned int i;
+
+    for (i = 0; i < FSYNC_THREAD_MUTEXES; i++)
+    {
+        expected = idx;
+        __atomic_compare_exchange_n( &record->mutexes[i], &expected, 0, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+    }
+    expected = idx;
+    __atomic_compare_exchange_n( &record->pending, &expected, 0, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+}
+
+int fsync_get_state( unsigned int idx )
+{
+    return __atomic_load_n( &get_fsync_shm( idx )->state, __ATOMIC_SEQ_CST );
+}
+
+void fsync_set_state( unsigned int idx, int state )
+{
+    __atomic_store_n( &get_fsync_shm( idx )->state, state, __ATOMIC_SEQ_CST );
+}
+
+/* atomically replace the state if it matches; returns the previous state */
+int fsync_cmpxchg_state( unsigned int idx, int expected, int state )
+{
+    __atomic_compare_exchange_n( &get_fsync_shm( idx )->state, &expected, state, 0,
+                                 __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+    return expected;
+}
+
+int fsync_add_state( unsigned int idx, int delta )
+{
+    return __atomic_fetch_add( &get_fsync_shm( idx )->state, delta, __ATOMIC_SEQ_CST );
+}
+
+int fsync_get_event_state( unsigned int idx )
+{
+    return fsync_get_state( idx ) & FSYNC_EVENT_SIGNALED;
+}
+
+void fsync_set_event_state( unsigned int idx, int signaled )
+{
+    fsync_shm_t *shm = get_fsync_shm( idx );
+
+    if (signaled) __atomic_fetch_or( &shm->state, FSYNC_EVENT_SIGNALED, __ATOMIC_SEQ_CST );
+    else __atomic_fetch_and( &shm->state, ~FSYNC_EVENT_SIGNALED, __ATOMIC_SEQ_CST );
+}
+
+/* finish a pulse once the server waiters have been woken: reset the event and start a
+ * new pulse generation, which releases the client threads waiting on the futex */
+void fsync_pulse_event( unsigned int idx, int manual_reset )
+{
+    fsync_shm_t *shm = get_fsync_shm( idx );
+    int state, new_state;
+
+    do
+    {
+        state = __atomic_load_n( &shm->state, __ATOMIC_SEQ_CST );
+        new_state = (unsigned int)(state & ~(FSYNC_EVENT_SIGNALED | FSYNC_EVENT_PULSED)) + FSYNC_EVENT_PULSE_GEN;
+        /* nobody took an auto-reset pulse yet, leave it to a client waiter */
+        if (!manual_reset && (state & FSYNC_EVENT_SIGNALED)) new_state |= FSYNC_EVENT_PULSED;
+    } while (!__atomic_compare_exchange_n( &shm->state, &state, new_state, 0,
+                                           __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ));
+    fsync_wake_futex( idx );
+}
+
+int fsync_get_count( unsigned int idx )
+{
+    return get_fsync_shm( idx )->count;
+}
+
+void fsync_set_count( unsigned int idx, int count )
+{
+    get_fsync_shm( idx )->count = count;
+}
+
+int fsync_get_abandoned( unsigned int idx )
+{
+    return get_fsync_shm( idx )->abandoned;
+}
+
+void fsync_set_abandoned( unsigned int idx, int abandoned )
+{
+    get_fsync_shm( idx )->abandoned = abandoned;
+}
+
+/* wake all client threads waiting on the object futex */
+void fsync_wake_futex( unsigned int idx )
+{
+#ifdef __linux__
+    syscall( __NR_futex, &get_fsync_shm( idx )->state, FUTEX_WAKE, INT_MAX, NULL, 0, 0 );
+#endif
+}
+
+/* add_queue wrapper; the waiter count tells clients that they need to notify the server */
+int fsync_add_queue( struct object *obj, struct wait_queue_entry *entry, unsigned int idx )
+{
+    if (idx) __atomic_fetch_add( &get_fsync_shm( idx )->waiters, 1, __ATOMIC_SEQ_CST );
+    return add_queue( obj, entry );
+}
+
+void fsync_remove_queue( struct object *obj, struct wait_queue_entry *entry, unsigned int idx )
+{
+    if (idx) __atomic_fetch_sub( &get_fsync_shm( idx )->waiters, 1, __ATOMIC_SEQ_CST );
+    remove_queue( obj, entry );
+}
+
+/* take the object for the thread of a wait that is about to be satisfied; clients change
+ * the shared state without the server, so this fails if one of them got there first */
+int fsync_acquire( struct wait_queue_entry *entry )
+{
+    struct object *obj = entry->obj;
+    fsync_shm_t *shm;
+    unsigned int idx;
+    int state, tid;
+
+    if (fsync_fd == -1) return 1;
+
+    if ((idx = get_event_fsync_idx( obj )))
+    {
+        shm = get_fsync_shm( idx );
+        if (shm->count) return 1;  /* manual reset events are not consumed */
+        do
+        {
+            state = __atomic_load_n( &shm->state, __ATOMIC_SEQ_CST );
+            if (!(state & FSYNC_EVENT_SIGNALED)) return 0;
+        } while (!__atomic_compare_exchange_n( &shm->state, &state, state & ~FSYNC_EVENT_SIGNALED, 0,
+                                               __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ));
+        return 1;
+    }
+    if ((idx = get_semaphore_fsync_idx( obj )))
+    {
+        shm = get_fsync_shm( idx );
+        do
+        {
+            state = __atomic_load_n( &shm->state, __ATOMIC_SEQ_CST );
+            if (!state) return 0;
+        } while (!__atomic_compare_exchange_n( &shm->state, &state, state - 1, 0,
+                                               __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ));
+        return 1;
+    }
+    if ((idx = get_mutex_fsync_idx( obj )))
+    {
+        shm = get_fsync_shm( idx );
+        tid = get_wait_queue_thread( entry )->id;
+        state = 0;
+        return __atomic_compare_exchange_n( &shm->state, &state, tid, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST ) ||
+               state == tid;
+    }
+    return 1;
+}
+
+/* give back an object taken by fsync_acquire() for a wait that isn't satisfied after all */
+void fsync_release( struct wait_queue_entry *entry )
+{
+    struct object *obj = entry->obj;
+    fsync_shm_t *shm;
+    unsigned int idx;
+
+    if (fsync_fd == -1) return;
+
+    if ((idx = get_event_fsync_idx( obj )))
+    {
+        shm = get_fsync_shm( idx );
+        if (shm->count) return;
+        __atomic_fetch_or( &shm->state, FSYNC_EVENT_SIGNALED, __ATOMIC_SEQ_CST );
+    }
+    else if ((idx = get_semaphore_fsync_idx( obj )))
+    {
+        __atomic_fetch_add( &get_fsync_shm( idx )->state, 1, __ATOMIC_SEQ_CST );
+    }
+    else if ((idx = get_mutex_fsync_idx( obj )))
+    {
+        shm = get_fsync_shm( idx );
+        if (shm->count) return;  /* it was already owned before */
+        __atomic_store_n( &shm->state, 0, __ATOMIC_SEQ_CST );
+    }
+    else return;
+
+    fsync_wake_futex( idx );
+}
+
+/* retrieve the shared memory index of an object */
+DECL_HANDLER(get_fsync_idx)
+{
+    struct object *obj;
+    unsigned int idx;
+
+    if (!(obj = get_handle_obj( current->process, req->handle, 0, NULL ))) return;
+
+    if ((idx = get_event_fsync_idx( obj ))) reply->type = FSYNC_EVENT;
+    else if ((idx = get_mutex_fsync_idx( obj ))) reply->type = FSYNC_MUTEX;
+    else if ((idx = get_semaphore_fsync_idx( obj ))) reply->type = FSYNC_SEMAPHORE;
+
+    if (idx)
+    {
+        reply->shm_idx = idx;
+        reply->access  = get_handle_access( current->process, req->handle );
+    }
+    else set_error( STATUS_NOT_IMPLEMENTED );
+
+    release_object( obj );
+}
+
+/* wake server-side waiters after a client modified the shared state */
+DECL_HANDLER(fsync_wake)
+{
+    struct object *obj;
+
+    if (!(obj = get_handle_obj( current->process, req->handle, 0, NULL ))) return;
+    wake_up( obj, 0 );
+    release_object( obj );
+}
+
+/* retrieve the owned mutexes record of the current thread */
+DECL_HANDLER(get_fsync_thread_idx)
+{
+    if (!current->fsync_idx && !(current->fsync_idx = alloc_fsync_thread()))
+    {
+        set_error( STATUS_NOT_IMPLEMENTED );
+        return;
+    }
+    reply->shm_idx = current->fsync_idx;
+}
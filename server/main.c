@@ -228,6 +228,7 @@ int main( int argc, char *argv[] )
 
     sock_init();
     open_master_socket();
+    fsync_init();
 
     if (debug_level) fprintf( stderr, "wineserver: starting (pid=%ld)\n", (long) getpid() );
     set_current_time();
@@ -57,9 +57,12 @@ struct mutex
     unsigned int   count;           /* recursion count */
     int            abandoned;       /* has it been abandoned? */
     struct list    entry;           /* entry in owner thread mutex list */
+    unsigned int   fsync_idx;       /* index in the fsync shared memory */
 };
 
 static void mutex_dump( struct object *obj, int verbose );
+static int mutex_add_queue( struct object *obj, struct wait_queue_entry *entry );
+static void mutex_remove_queue( struct object *obj, struct wait_queue_entry *entry );
 static int mutex_signaled( struct object *obj, struct wait_queue_entry *entry );
 static void mutex_satisfied( struct object *obj, struct wait_queue_entry *entry );
 static void mutex_destroy( struct object *obj );
@@ -70,8 +73,8 @@ static const struct object_ops mutex_ops =
     sizeof(struct mutex),      /* size */
     &mutex_type,               /* type */
     mutex_dump,                /* dump */
-    add_queue,                 /* add_queue */
-    remove_queue,              /* remove_queue */
+    mutex_add_queue,           /* add_queue */
+    mutex_remove_queue,        /* remove_queue */
     mutex_signaled,            /* signaled */
     mutex_satisfied,           /* satisfied */
     mutex_signal,              /* signal */
@@ -93,6 +96,21 @@ static const struct object_ops mutex_ops =
 /* grab a mutex for a given thread */
 static void do_grab( struct mutex *mutex, struct thread *thread )
 {
+    if (mutex->fsync_idx)
+    {
+        /* the shared state already names the owner, see fsync_acquire() */
+        unsigned int count = fsync_get_count( mutex->fsync_idx );
+
+        if (!count)
+        {
+            /* it may still be in the list of a previous owner that released it without us */
+            list_remove( &mutex->entry );
+            list_add_head( &thread->mutex_list, &mutex->entry );
+        }
+        fsync_set_count( mutex->fsync_idx, count + 1 );
+        return;
+    }
+
     assert( !mutex->count || (mutex->owner == thread) );
 
     if (!mutex->count++)  /* FIXME: avoid wrap-around */
@@ -106,6 +124,16 @@ static void do_grab( struct mutex *mutex, struct thread *thread )
 /* release a mutex once the recursion count is 0 */
 static void do_release( struct mutex *mutex )
 {
+    if (mutex->fsync_idx)
+    {
+        list_remove( &mutex->entry );
+        list_init( &mutex->entry );
+        fsync_set_state( mutex->fsync_idx, 0 );
+        fsync_wake_futex( mutex->fsync_idx );
+        wake_up( &mutex->obj, 0 );
+        return;
+    }
+
     assert( !mutex->count );
     /* remove the mutex from the thread list of owned mutexes */
     list_remove( &mutex->entry );
@@ -126,38 +154,136 @@ static struct mutex *create_mutex( struct object *root, const struct unicode_str
             mutex->count = 0;
             mutex->owner = NULL;
             mutex->abandoned = 0;
+            list_init( &mutex->entry );
+            mutex->fsync_idx = fsync_alloc_shm( &mutex->obj, owned ? current->id : 0, 0 );
             if (owned) do_grab( mutex, current );
         }
     }
     return mutex;
 }
 
+static void abandon_fsync_mutex( struct mutex *mutex, struct thread *thread )
+{
+    /* clients may have released it or passed it on in the meantime */
+    if (fsync_get_state( mutex->fsync_idx ) != thread->id) return;
+    fsync_set_count( mutex->fsync_idx, 0 );
+    fsync_set_abandoned( mutex->fsync_idx, 1 );
+    do_release( mutex );
+}
+
 void abandon_mutexes( struct thread *thread )
 {
+    const fsync_thread_t *record;
+    struct object *obj;
     struct list *ptr;
+    unsigned int i;
 
     while ((ptr = list_head( &thread->mutex_list )) != NULL)
     {
         struct mutex *mutex = LIST_ENTRY( ptr, struct mutex, entry );
+
+        if (mutex->fsync_idx)
+        {
+            list_remove( &mutex->entry );
+            list_init( &mutex->entry );
+            abandon_fsync_mutex( mutex, thread );
+            continue;
+        }
         assert( mutex->owner == thread );
         mutex->count = 0;
         mutex->abandoned = 1;
         do_release( mutex );
     }
+
+    /* mutexes acquired directly by the client are listed in its shared record */
+    if (!thread->fsync_idx) return;
+    record = fsync_get_thread( thread->fsync_idx );
+    for (i = 0; i <= FSYNC_THREAD_MUTEXES; i++)
+    {
+        obj = fsync_get_object( i < FSYNC_THREAD_MUTEXES ? record->mutexes[i] : record->pending );
+        if (obj && obj->ops == &mutex_ops) abandon_fsync_mutex( (struct mutex *)obj, thread );
+    }
+}
+
+unsigned int get_mutex_fsync_idx( struct object *obj )
+{
+    if (obj->ops != &mutex_ops) return 0;
+    return ((struct mutex *)obj)->fsync_idx;
+}
+
+/* check whether the mutex is owned by another thread than the given one */
+static int is_owned_by_other( struct mutex *mutex, struct thread *thread )
+{
+    if (mutex->fsync_idx)
+    {
+        int owner = fsync_get_state( mutex->fsync_idx );
+        return owner && owner != thread->id;
+    }
+    return mutex->count && mutex->owner != thread;
+}
+
+/* release the mutex once for the current thread; return the previous count */
+static unsigned int release_mutex( struct mutex *mutex )
+{
+    unsigned int count;
+
+    if (mutex->fsync_idx)
+    {
+        if (fsync_get_state( mutex->fsync_idx ) != current->id)
+        {
+            set_error( STATUS_MUTANT_NOT_OWNED );
+            return 0;
+        }
+        count = fsync_get_count( mutex->fsync_idx );
+        fsync_set_count( mutex->fsync_idx, count - 1 );
+        if (count == 1)
+        {
+            if (current->fsync_idx) fsync_clear_thread_mutex( current->fsync_idx, mutex->fsync_idx );
+            do_release( mutex );
+        }
+        return count;
+    }
+
+    if (!mutex->count || (mutex->owner != current))
+    {
+        set_error( STATUS_MUTANT_NOT_OWNED );
+        return 0;
+    }
+    count = mutex->count;
+    if (!--mutex->count) do_release( mutex );
+    return count;
 }
 
 static void mutex_dump( struct object *obj, int verbose )
 {
     struct mutex *mutex = (struct mutex *)obj;
     assert( obj->ops == &mutex_ops );
-    fprintf( stderr, "Mutex count=%u owner=%p\n", mutex->count, mutex->owner );
+    if (mutex->fsync_idx)
+        fprintf( stderr, "Mutex count=%u owner=%04x fsync=%u\n", fsync_get_count( mutex->fsync_idx ),
+                 fsync_get_state( mutex->fsync_idx ), mutex->fsync_idx );
+    else
+        fprintf( stderr, "Mutex count=%u owner=%p\n", mutex->count, mutex->owner );
+}
+
+static int mutex_add_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct mutex *mutex = (struct mutex *)obj;
+    assert( obj->ops == &mutex_ops );
+    return fsync_add_queue( obj, entry, mutex->fsync_idx );
+}
+
+static void mutex_remove_queue( struct object *obj, struct wait_queue_entry *entry )
+{
+    struct mutex *mutex = (struct mutex *)obj;
+    assert( obj->ops == &mutex_ops );
+    fsync_remove_queue( obj, entry, mutex->fsync_idx );
 }
 
 static int mutex_signaled( struct object *obj, struct wait_queue_entry *entry )
 {
     struct mutex *mutex = (struct mutex *)obj;
     assert( obj->ops == &mutex_ops );
-    return (!mutex->count || (mutex->owner == get_wait_queue_thread( entry )));
+    return !is_owned_by_other( mutex, get_wait_queue_thread( entry ));
 }
 
 static void mutex_satisfied( struct object *obj, struct wait_queue_entry *entry )
@@ -166,6 +292,12 @@ static void mutex_satisfied( struct object *obj, struct wait_queue_entry *entry
     assert( obj->ops == &mutex_ops );
 
     do_grab( mutex, get_wait_queue_thread( entry ));
+    if (mutex->fsync_idx)
+    {
+        if (fsync_get_abandoned( mutex->fsync_idx )) make_wait_abandoned( entry );
+        fsync_set_abandoned( mutex->fsync_idx, 0 );
+        return;
+    }
     if (mutex->abandoned) make_wait_abandoned( entry );
     mutex->abandoned = 0;
 }
@@ -180,13 +312,7 @@ static int mutex_signal( struct object *obj, unsigned int access )
         set_error( STATUS_ACCESS_DENIED );
         return 0;
     }
-    if (!mutex->count || (mutex->owner != current))
-    {
-        set_error( STATUS_MUTANT_NOT_OWNED );
-        return 0;
-    }
-    if (!--mutex->count) do_release( mutex );
-    return 1;
+    return release_mutex( mutex ) != 0;
 }
 
 static void mutex_destroy( struct object *obj )
@@ -194,6 +320,13 @@ static void mutex_destroy( struct object *obj )
     struct mutex *mutex = (struct mutex *)obj;
     assert( obj->ops == &mutex_ops );
 
+    if (mutex->fsync_idx)
+    {
+        /* a stale entry in the owner record is harmless, abandon_mutexes checks the owner */
+        list_remove( &mutex->entry );
+        fsync_free_shm( mutex->fsync_idx );
+        return;
+    }
     if (!mutex->count) return;
     mutex->count = 0;
     do_release( mutex );
@@ -240,12 +373,7 @@ DECL_HANDLER(release_mutex)
     if ((mutex = (struct mutex *)get_handle_obj( current->process, req->handle,
                                                  0, &mutex_ops )))
     {
-        if (!mutex->count || (mutex->owner != current)) set_error( STATUS_MUTANT_NOT_OWNED );
-        else
-        {
-            reply->prev_count = mutex->count;
-            if (!--mutex->count) do_release( mutex );
-        }
+        reply->prev_count = release_mutex( mutex );
         release_object( mutex );
     }
 }
@@ -258,9 +386,18 @@ DECL_HANDLER(query_mutex)
     if ((mutex = (struct mutex *)get_handle_obj( current->process, req->handle,
                                                  MUTANT_QUERY_STATE, &mutex_ops )))
     {
-        reply->count = mutex->count;
-        reply->owned = (mutex->owner == current);
-        reply->abandoned = mutex->abandoned;
+        if (mutex->fsync_idx)
+        {
+            reply->count = fsync_get_count( mutex->fsync_idx );
+            reply->owned = (fsync_get_state( mutex->fsync_idx ) == current->id);
+            reply->abandoned = fsync_get_abandoned( mutex->fsync_idx );
+        }
+        else
+        {
+            reply->count = mutex->count;
+            reply->owned = (mutex->owner == current);
+            reply->abandoned = mutex->abandoned;
+        }
 
         release_object( mutex );
     }
@@ -217,9 +217,43 @@ extern struct keyed_event *get_keyed_event_obj( struct process *process, obj_han
 extern void set_event( struct event *event );
 extern void reset_event( struct event *event );
 
+extern unsigned int get_event_fsync_idx( struct object *obj );
+
 /* mutex functions */
 
 extern void abandon_mutexes( struct thread *thread );
+extern unsigned int get_mutex_fsync_idx( struct object *obj );
+
+/* semaphore functions */
+
+extern unsigned int get_semaphore_fsync_idx( struct object *obj );
+
+/* fast synchronization functions */
+
+extern int do_fsync(void);
+extern void fsync_init(void);
+extern unsigned int fsync_alloc_shm( struct object *obj, int state, int count );
+extern void fsync_free_shm( unsigned int idx );
+extern struct object *fsync_get_object( unsigned int idx );
+extern void fsync_free_thread( unsigned int idx );
+extern const fsync_thread_t *fsync_get_thread( unsigned int idx );
+extern void fsync_clear_thread_mutex( unsigned int thread_idx, unsigned int idx );
+extern int fsync_get_state( unsigned int idx );
+extern void fsync_set_state( unsigned int idx, int state );
+extern int fsync_cmpxchg_state( unsigned int idx, int expected, int state );
+extern int fsync_add_state( unsigned int idx, int delta );
+extern int fsync_get_event_state( unsigned int idx );
+extern void fsync_set_event_state( unsigned int idx, int signaled );
+extern void fsync_pulse_event( unsigned int idx, int manual_reset );
+extern int fsync_get_count( unsigned int idx );
+extern void fsync_set_count( unsigned int idx, int count );
+extern int fsync_get_abandoned( unsigned int idx );
+extern void fsync_set_abandoned( unsigned int idx, int abandoned );
+extern void fsync_wake_futex( unsigned int idx );
+extern int fsync_add_queue( struct object *obj, struct wait_queue_entry *entry, unsigned int idx );
+extern void fsync_remove_queue( struct object *obj, struct wait_queue_entry *entry, unsigned int idx );
+extern int fsync_acquire( struct wait_queue_entry *entry );
+extern void fsync_release( struct wait_queue_entry *entry );
 
 /* serial functions */
 
@@ -321,6 +355,7 @@ extern struct type_descr winstation_type;
 extern struct type_descr desktop_type;
 extern struct type_descr device_type;
 extern struct type_descr completion_type;
+extern struct type_descr wait_completion_packet_type;
 extern struct type_descr file_type;
 extern struct type_descr mapping_type;
 extern struct type_descr key_type;
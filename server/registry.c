@@ -83,10 +83,14 @@ struct key
     int               last_subkey; /* last in use subkey */
     int               nb_subkeys;  /* count of allocated subkeys */
     struct key      **subkeys;     /* subkeys array */
+    int               sorted_subkeys; /* count of subkeys sorted by name, others are unsorted */
+    struct key_index *subkey_index; /* hash index of the subkeys of large keys */
     struct key       *wow6432node; /* Wow6432Node subkey */
     int               last_value;  /* last in use value */
     int               nb_values;   /* count of allocated values in array */
     struct key_value *values;      /* values array */
+    int               sorted_values; /* count of values sorted by name, others are unsorted */
+    struct key_index *value_index; /* hash index of the values of large keys */
     unsigned int      flags;       /* flags */
     timeout_t         modif;       /* last modification time */
     struct list       notify_list; /* list of notifications */
@@ -114,6 +118,19 @@ struct key_value
 
 #define MIN_SUBKEYS  8   /* min. number of allocated subkeys per key */
 #define MIN_VALUES   8   /* min. number of allocated values per key */
+#define MIN_INDEXED  256 /* min. number of subkeys or values for a key to be hash indexed */
+
+/* Keys with many subkeys or values (HKCR\CLSID, the font cache...) look their
+ * children up through a hash index instead of a binary search.  New entries of
+ * indexed keys are appended unsorted, and are merged into the sorted part of
+ * the array the next time it is accessed by index (enumeration, saving), so
+ * that insertions don't need to move the whole array. */
+struct key_index
+{
+    unsigned int size;      /* number of slots, a power of 2 */
+    unsigned int count;     /* number of used slots */
+    int          slots[1];  /* array index + 1 of the entries, 0 for free slots */
+};
 
 #define MAX_NAME_LEN  256    /* max. length of a key name */
 #define MAX_VALUE_LEN 16383  /* max. length of a value name */
@@ -285,14 +302,207 @@ static void dump_value( const struct key_value *value, FILE *f )
     fputc( '\n', f );
 }
 
-/* find the named child of a given key and return its index */
-static struct key *find_subkey( const struct key *key, const struct unicode_str *name, int *index )
+typedef void (*get_entry_name_func)( const struct key *key, int i, struct unicode_str *name );
+
+static void get_subkey_name( const struct key *key, int i, struct unicode_str *name )
+{
+    name->str = key->subkeys[i]->obj.name->name;
+    name->len = key->subkeys[i]->obj.name->len;
+}
+
+static void get_value_name( const struct key *key, int i, struct unicode_str *name )
+{
+    name->str = key->values[i].name;
+    name->len = key->values[i].namelen;
+}
+
+/* compare two entry names the same way as the sorted arrays are ordered */
+static int compare_names( const struct unicode_str *name1, const struct unicode_str *name2 )
+{
+    int res = memicmp_strW( name1->str, name2->str, min( name1->len, name2->len ));
+    if (!res) res = name1->len - name2->len;
+    return res;
+}
+
+static int compare_subkeys( const void *p1, const void *p2 )
+{
+    const struct key *key1 = *(struct key * const *)p1;
+    const struct key *key2 = *(struct key * const *)p2;
+    const struct unicode_str name1 = { key1->obj.name->name, key1->obj.name->len };
+    const struct unicode_str name2 = { key2->obj.name->name, key2->obj.name->len };
+
+    return compare_names( &name1, &name2 );
+}
+
+static int compare_values( const void *p1, const void *p2 )
+{
+    const struct key_value *value1 = p1, *value2 = p2;
+    const struct unicode_str name1 = { value1->name, value1->namelen };
+    const struct unicode_str name2 = { value2->name, value2->namelen };
+
+    return compare_names( &name1, &name2 );
+}
+
+/* find the index slot holding a given name, or the free slot where it should go */
+static unsigned int index_find_slot( const struct key *key, const struct key_index *index,
+                                     get_entry_name_func get_name, const struct unicode_str *name )
+{
+    unsigned int pos = hash_strW( name->str, name->len, index->size );
+    struct unicode_str str;
+
+    while (index->slots[pos])
+    {
+        get_name( key, index->slots[pos] - 1, &str );
+        if (str.len == name->len && !memicmp_strW( str.str, name->str, name->len )) break;
+        pos = (pos + 1) & (index->size - 1);
+    }
+    return pos;
+}
+
+/* add the array entry i to the index */
+static void index_add_entry( const struct key *key, struct key_index *index,
+                             get_entry_name_func get_name, int i )
+{
+    struct unicode_str name;
+    unsigned int pos;
+
+    get_name( key, i, &name );
+    pos = index_find_slot( key, index, get_name, &name );
+    assert( !index->slots[pos] );
+    index->slots[pos] = i + 1;
+    index->count++;
+}
+
+/* remove an index slot, moving back the following entries of the probe sequence */
+static void index_remove_slot( const struct key *key, struct key_index *index,
+                               get_entry_name_func get_name, unsigned int pos )
+{
+    unsigned int next, home, mask = index->size - 1;
+    struct unicode_str name;
+
+    for (next = (pos + 1) & mask; index->slots[next]; next = (next + 1) & mask)
+    {
+        get_name( key, index->slots[next] - 1, &name );
+        home = hash_strW( name.str, name.len, index->size );
+        if (((next - home) & mask) < ((next - pos) & mask)) continue;
+        index->slots[pos] = index->slots[next];
+        pos = next;
+    }
+    index->slots[pos] = 0;
+    index->count--;
+}
+
+/* remove the array entry i from the index, and renumber the entries that follow it up to last */
+static void index_remove_entry( const struct key *key, struct key_index *index,
+                                get_entry_name_func get_name, int i, int last )
+{
+    struct unicode_str name;
+    unsigned int pos;
+
+    get_name( key, i, &name );
+    index_remove_slot( key, index, get_name, index_find_slot( key, index, get_name, &name ));
+    if (i == last) return;
+    for (pos = 0; pos < index->size; pos++) if (index->slots[pos] > i + 1) index->slots[pos]--;
+}
+
+/* build an index for the count first entries of an array; return NULL on failure */
+static struct key_index *build_index( const struct key *key, int count, get_entry_name_func get_name )
+{
+    struct key_index *index;
+    unsigned int size = MIN_INDEXED;
+    int i;
+
+    while (size < 2 * count) size *= 2;
+    if (!(index = calloc( 1, offsetof( struct key_index, slots[size] )))) return NULL;
+    index->size = size;
+    for (i = 0; i < count; i++) index_add_entry( key, index, get_name, i );
+    return index;
+}
+
+/* replace an index after the array entries have been moved or added; free it on failure */
+static struct key_index *rebuild_index( const struct key *key, struct key_index *index,
+                                        int count, get_entry_name_func get_name )
+{
+    free( index );
+    return build_index( key, count, get_name );
+}
+
+/* look up a name in an index and return its array index, or -1 if not found */
+static int index_lookup( const struct key *key, const struct key_index *index,
+                         get_entry_name_func get_name, const struct unicode_str *name )
+{
+    unsigned int pos = index_find_slot( key, index, get_name, name );
+    return index->slots[pos] - 1;
+}
+
+/* sort the entries appended after the sorted part of an array, and merge them with it */
+static void merge_sorted( void *array, int sorted, int count, size_t size,
+                          int (*compare)( const void *, const void * ))
+{
+    char *base = array, *tail;
+    int i, j, k;
+
+    qsort( base + sorted * size, count - sorted, size, compare );
+    if (!sorted || compare( base + (sorted - 1) * size, base + sorted * size ) < 0) return;
+
+    if (!(tail = malloc( (count - sorted) * size )))
+    {
+        /* fall back to moving the entries one at a time */
+        char tmp[max( sizeof(struct key *), sizeof(struct key_value) )];
+
+        assert( size <= sizeof(tmp) );
+        for (i = sorted; i < count; i++)
+        {
+            for (j = i; j > 0 && compare( base + (j - 1) * size, base + i * size ) > 0; j--) ;
+            memcpy( tmp, base + i * size, size );
+            memmove( base + (j + 1) * size, base + j * size, (i - j) * size );
+            memcpy( base + j * size, tmp, size );
+        }
+        return;
+    }
+
+    memcpy( tail, base + sorted * size, (count - sorted) * size );
+    i = sorted - 1;
+    j = count - sorted - 1;
+    k = count - 1;
+    while (j >= 0)
+    {
+        if (i >= 0 && compare( base + i * size, tail + j * size ) > 0)
+            memcpy( base + k-- * size, base + i-- * size, size );
+        else
+            memcpy( base + k-- * size, tail + j-- * size, size );
+    }
+    free( tail );
+}
+
+/* make sure the subkeys array is sorted before accessing it by index */
+static void sort_subkeys( struct key *key )
+{
+    if (key->sorted_subkeys > key->last_subkey) return;
+    merge_sorted( key->subkeys, key->sorted_subkeys, key->last_subkey + 1,
+                  sizeof(*key->subkeys), compare_subkeys );
+    key->sorted_subkeys = key->last_subkey + 1;
+    if (key->subkey_index) key->subkey_index = rebuild_index( key, key->subkey_index, key->last_subkey + 1, get_subkey_name );
+}
+
+/* make sure the values array is sorted before accessing it by index */
+static void sort_values( struct key *key )
+{
+    if (key->sorted_values > key->last_value) return;
+    merge_sorted( key->values, key->sorted_values, key->last_value + 1,
+                  sizeof(*key->values), compare_values );
+    key->sorted_values = key->last_value + 1;
+    if (key->value_index) key->value_index = rebuild_index( key, key->value_index, key->last_value + 1, get_value_name );
+}
+
+/* binary search a name in the sorted part of the subkeys array and return its index */
+static struct key *search_subkey( const struct key *key, const struct unicode_str *name, int *index )
 {
     int i, min, max, res;
     data_size_t len;
 
     min = 0;
-    max = key->last_subkey;
+    max = key->sorted_subkeys - 1;
     while (min <= max)
     {
         i = (min + max) / 2;
@@ -311,6 +521,22 @@ static struct key *find_subkey( const struct key *key, const struct unicode_str
     return NULL;
 }
 
+/* find the named child of a given key and return its index */
+static struct key *find_subkey( const struct key *key, const struct unicode_str *name, int *index )
+{
+    int i;
+
+    if (!key->subkey_index) return search_subkey( key, name, index );
+
+    if ((i = index_lookup( key, key->subkey_index, get_subkey_name, name )) != -1)
+    {
+        *index = i;
+        return key->subkeys[i];
+    }
+    *index = key->last_subkey + 1;  /* append it, it will get sorted when needed */
+    return NULL;
+}
+
 /* try to grow the array of subkeys; return 1 if OK, 0 on error */
 static int grow_subkeys( struct key *key )
 {
@@ -337,11 +563,13 @@ static int grow_subkeys( struct key *key )
 }
 
 /* save a registry and all its subkeys to a text file */
-static void save_subkeys( const struct key *key, const struct key *base, FILE *f )
+static void save_subkeys( struct key *key, const struct key *base, FILE *f )
 {
     int i;
 
     if (key->flags & KEY_VOLATILE) return;
+    sort_subkeys( key );
+    sort_values( key );
     /* save key if it has either some values or no subkeys, or needs special options */
     /* keys with no values but subkeys are saved implicitly by saving the subkeys */
     if ((key->last_value >= 0) || (key->last_subkey == -1) || key->class || (key->flags & KEY_SYMLINK))
@@ -577,6 +805,46 @@ static struct object *key_lookup_name( struct object *obj, struct unicode_str *n
     return grab_object( found );
 }
 
+/* update the sorted count and the index after inserting the subkey at position i */
+static void link_subkey_index( struct key *key, int i )
+{
+    int count = key->last_subkey + 1;
+
+    if (!key->subkey_index)
+    {
+        key->sorted_subkeys = count;
+        if (count >= MIN_INDEXED) key->subkey_index = build_index( key, count, get_subkey_name );
+        return;
+    }
+    /* with an index, new subkeys are always appended */
+    assert( i == key->last_subkey );
+    if (key->sorted_subkeys == i && (!i || compare_subkeys( &key->subkeys[i - 1], &key->subkeys[i] ) < 0))
+        key->sorted_subkeys++;
+    if (2 * (key->subkey_index->count + 1) > key->subkey_index->size)
+        key->subkey_index = rebuild_index( key, key->subkey_index, count, get_subkey_name );
+    else
+        index_add_entry( key, key->subkey_index, get_subkey_name, i );
+    /* without an index, the array must be kept sorted */
+    if (!key->subkey_index) sort_subkeys( key );
+}
+
+/* update the sorted count and the index before removing the subkey at position i */
+static void unlink_subkey_index( struct key *key, int i )
+{
+    if (i < key->sorted_subkeys) key->sorted_subkeys--;
+    if (key->subkey_index) index_remove_entry( key, key->subkey_index, get_subkey_name, i, key->last_subkey );
+}
+
+/* drop the index once the key has become small again */
+static void shrink_subkey_index( struct key *key )
+{
+    if (key->last_subkey + 1 >= MIN_INDEXED / 2) return;
+    free( key->subkey_index );
+    key->subkey_index = NULL;
+    /* without an index, the array must be kept sorted */
+    sort_subkeys( key );
+}
+
 static int key_link_name( struct object *obj, struct object_name *name, struct object *parent )
 {
     struct key *key = (struct key *)obj;
@@ -604,6 +872,7 @@ static int key_link_name( struct object *obj, struct object_name *name, struct o
     for (i = ++parent_key->last_subkey; i > index; i--)
         parent_key->subkeys[i] = parent_key->subkeys[i - 1];
     parent_key->subkeys[index] = (struct key *)grab_object( key );
+    link_subkey_index( parent_key, index );
     if (is_wow6432node( name->name, name->len ) &&
         !is_wow6432node( parent_key->obj.name->name, parent_key->obj.name->len ))
         parent_key->wow6432node = key;
@@ -625,10 +894,18 @@ static void key_unlink_name( struct object *obj, struct object_name *name )
         return;
     }
 
-    for (i = 0; i <= parent->last_subkey; i++) if (parent->subkeys[i] == key) break;
-    assert( i <= parent->last_subkey );
-    for ( ; i < parent->last_subkey; i++) parent->subkeys[i] = parent->subkeys[i + 1];
+    if (parent->subkey_index)
+    {
+        struct unicode_str tmp = { name->name, name->len };
+        i = index_lookup( parent, parent->subkey_index, get_subkey_name, &tmp );
+    }
+    else for (i = 0; i <= parent->last_subkey; i++) if (parent->subkeys[i] == key) break;
+    assert( i >= 0 && i <= parent->last_subkey && parent->subkeys[i] == key );
+    unlink_subkey_index( parent, i );
+    memmove( parent->subkeys + i, parent->subkeys + i + 1,
+             (parent->last_subkey - i) * sizeof(*parent->subkeys) );
     parent->last_subkey--;
+    if (parent->subkey_index) shrink_subkey_index( parent );
     name->parent = NULL;
     if (parent->wow6432node == key) parent->wow6432node = NULL;
     release_object( key );
@@ -669,12 +946,14 @@ static void key_destroy( struct object *obj )
         free( key->values[i].data );
     }
     free( key->values );
+    free( key->value_index );
     for (i = 0; i <= key->last_subkey; i++)
     {
         key->subkeys[i]->obj.name->parent = NULL;
         release_object( key->subkeys[i] );
     }
     free( key->subkeys );
+    free( key->subkey_index );
     /* unconditionally notify everything waiting on this key */
     while ((ptr = list_head( &key->notify_list )))
     {
@@ -703,10 +982,14 @@ static struct key *create_key_object( struct object *parent, const struct unicod
             key->last_subkey = -1;
             key->nb_subkeys  = 0;
             key->subkeys     = NULL;
+            key->sorted_subkeys = 0;
+            key->subkey_index = NULL;
             key->wow6432node = NULL;
             key->nb_values   = 0;
             key->last_value  = -1;
             key->values      = NULL;
+            key->sorted_values = 0;
+            key->value_index = NULL;
             key->modif       = modif;
             list_init( &key->notify_list );
 
@@ -923,6 +1206,7 @@ static void enum_key( struct key *key, int index, int info_class, struct enum_ke
             set_error( STATUS_NO_MORE_ENTRIES );
             return;
         }
+        sort_subkeys( key );
         key = key->subkeys[index];
     }
 
@@ -1014,7 +1298,8 @@ static void rename_key( struct key *key, const struct unicode_str *new_name )
     }
 
     /* check for existing subkey with the same name */
-    if (!parent || (subkey = find_subkey( parent, new_name, &index )))
+    if (parent) sort_subkeys( parent );
+    if (!parent || (subkey = search_subkey( parent, new_name, &index )))
     {
         set_error( STATUS_CANNOT_DELETE );
         return;
@@ -1050,6 +1335,9 @@ static void rename_key( struct key *key, const struct unicode_str *new_name )
 
     free( key->obj.name );
     key->obj.name = new_name_ptr;
+    if (parent->subkey_index)
+        parent->subkey_index = rebuild_index( parent, parent->subkey_index,
+                                              parent->last_subkey + 1, get_subkey_name );
 
     if (debug_level > 1) dump_operation( key, NULL, "Rename" );
     touch_key( key, REG_NOTIFY_CHANGE_NAME );
@@ -1116,14 +1404,14 @@ static int grow_values( struct key *key )
     return 1;
 }
 
-/* find the named value of a given key and return its index in the array */
-static struct key_value *find_value( const struct key *key, const struct unicode_str *name, int *index )
+/* binary search a name in the sorted part of the values array and return its index */
+static struct key_value *search_value( const struct key *key, const struct unicode_str *name, int *index )
 {
     int i, min, max, res;
     data_size_t len;
 
     min = 0;
-    max = key->last_value;
+    max = key->sorted_values - 1;
     while (min <= max)
     {
         i = (min + max) / 2;
@@ -1142,6 +1430,68 @@ static struct key_value *find_value( const struct key *key, const struct unicode
     return NULL;
 }
 
+/* find the named value of a given key and return its index in the array */
+static struct key_value *find_value( const struct key *key, const struct unicode_str *name, int *index )
+{
+    int i;
+
+    if (!key->value_index) return search_value( key, name, index );
+
+    if ((i = index_lookup( key, key->value_index, get_value_name, name )) != -1)
+    {
+        *index = i;
+        return &key->values[i];
+    }
+    *index = key->last_value + 1;  /* append it, it will get sorted when needed */
+    return NULL;
+}
+
+/* update the sorted count and the index after inserting the value at position i; return its new position */
+static int link_value_index( struct key *key, int i )
+{
+    int count = key->last_value + 1;
+    struct unicode_str name;
+
+    if (!key->value_index)
+    {
+        key->sorted_values = count;
+        if (count >= MIN_INDEXED) key->value_index = build_index( key, count, get_value_name );
+        return i;
+    }
+    /* with an index, new values are always appended */
+    assert( i == key->last_value );
+    if (key->sorted_values == i && (!i || compare_values( &key->values[i - 1], &key->values[i] ) < 0))
+        key->sorted_values++;
+    if (2 * (key->value_index->count + 1) > key->value_index->size)
+        key->value_index = rebuild_index( key, key->value_index, count, get_value_name );
+    else
+        index_add_entry( key, key->value_index, get_value_name, i );
+    if (key->value_index) return i;
+
+    /* without an index, the array must be kept sorted */
+    get_value_name( key, i, &name );
+    sort_values( key );
+    search_value( key, &name, &i );
+    return i;
+}
+
+/* update the sorted count and the index before removing the value at position i */
+static void unlink_value_index( struct key *key, int i )
+{
+    if (i < key->sorted_values) key->sorted_values--;
+    if (key->value_index) index_remove_entry( key, key->value_index, get_value_name, i, key->last_value );
+}
+
+/* drop the index once the key has become small again */
+static void shrink_value_index( struct key *key )
+{
+    if (key->last_value + 1 >= MIN_INDEXED / 2) return;
+    free( key->value_index );
+    key->value_index = NULL;
+    /* without an index, the array must be kept sorted */
+    sort_values( key );
+}
+
 /* insert a new value; the index must have been returned by find_value */
 static struct key_value *insert_value( struct key *key, const struct unicode_str *name, int index )
 {
@@ -1165,7 +1515,7 @@ static struct key_value *insert_value( struct key *key, const struct unicode_str
     value->namelen = name->len;
     value->len     = 0;
     value->data    = NULL;
-    return value;
+    return &key->values[link_value_index( key, index )];
 }
 
 /* set a key value */
@@ -1265,6 +1615,7 @@ static void enum_value( struct key *key, int i, int info_class, struct enum_key_
         void *data;
         data_size_t namelen, maxlen;
 
+        sort_values( key );
         value = &key->values[i];
         reply->type = value->type;
         namelen = value->namelen;
@@ -1323,10 +1674,12 @@ static void delete_value( struct key *key, const struct unicode_str *name )
         return;
     }
     if (debug_level > 1) dump_operation( key, value, "Delete" );
+    unlink_value_index( key, index );
     free( value->name );
     free( value->data );
     for (i = index; i < key->last_value; i++) key->values[i] = key->values[i + 1];
     key->last_value--;
+    if (key->value_index) shrink_value_index( key );
     touch_key( key, REG_NOTIFY_CHANGE_LAST_SET );
 
     /* try to shrink the array */
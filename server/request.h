@@ -152,6 +152,9 @@ DECL_HANDLER(create_event);
 DECL_HANDLER(event_op);
 DECL_HANDLER(query_event);
 DECL_HANDLER(open_event);
+DECL_HANDLER(get_fsync_idx);
+DECL_HANDLER(fsync_wake);
+DECL_HANDLER(get_fsync_thread_idx);
 DECL_HANDLER(create_keyed_event);
 DECL_HANDLER(open_keyed_event);
 DECL_HANDLER(create_mutex);
@@ -379,6 +382,9 @@ DECL_HANDLER(open_completion);
 DECL_HANDLER(add_completion);
 DECL_HANDLER(remove_completion);
 DECL_HANDLER(query_completion);
+DECL_HANDLER(create_wait_completion_packet);
+DECL_HANDLER(associate_wait_completion_packet);
+DECL_HANDLER(cancel_wait_completion_packet);
 DECL_HANDLER(set_completion_info);
 DECL_HANDLER(add_fd_completion);
 DECL_HANDLER(set_fd_completion_mode);
@@ -444,6 +450,9 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_event_op,
     (req_handler)req_query_event,
     (req_handler)req_open_event,
+    (req_handler)req_get_fsync_idx,
+    (req_handler)req_fsync_wake,
+    (req_handler)req_get_fsync_thread_idx,
     (req_handler)req_create_keyed_event,
     (req_handler)req_open_keyed_event,
     (req_handler)req_create_mutex,
@@ -671,6 +680,9 @@ static const req_handler req_handlers[REQ_NB_REQUESTS] =
     (req_handler)req_add_completion,
     (req_handler)req_remove_completion,
     (req_handler)req_query_completion,
+    (req_handler)req_create_wait_completion_packet,
+    (req_handler)req_associate_wait_completion_packet,
+    (req_handler)req_cancel_wait_completion_packet,
     (req_handler)req_set_completion_info,
     (req_handler)req_add_fd_completion,
     (req_handler)req_set_fd_completion_mode,
@@ -967,6 +979,17 @@ C_ASSERT( FIELD_OFFSET(struct open_event_request, rootdir) == 20 );
 C_ASSERT( sizeof(struct open_event_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct open_event_reply, handle) == 8 );
 C_ASSERT( sizeof(struct open_event_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_fsync_idx_request, handle) == 12 );
+C_ASSERT( sizeof(struct get_fsync_idx_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_fsync_idx_reply, shm_idx) == 8 );
+C_ASSERT( FIELD_OFFSET(struct get_fsync_idx_reply, type) == 12 );
+C_ASSERT( FIELD_OFFSET(struct get_fsync_idx_reply, access) == 16 );
+C_ASSERT( sizeof(struct get_fsync_idx_reply) == 24 );
+C_ASSERT( FIELD_OFFSET(struct fsync_wake_request, handle) == 12 );
+C_ASSERT( sizeof(struct fsync_wake_request) == 16 );
+C_ASSERT( sizeof(struct get_fsync_thread_idx_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct get_fsync_thread_idx_reply, shm_idx) == 8 );
+C_ASSERT( sizeof(struct get_fsync_thread_idx_reply) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_keyed_event_request, access) == 12 );
 C_ASSERT( sizeof(struct create_keyed_event_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct create_keyed_event_reply, handle) == 8 );
@@ -1563,7 +1586,8 @@ C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, tid) == 20 );
 C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, atom) == 24 );
 C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, is_unicode) == 28 );
 C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, dpi_context) == 32 );
-C_ASSERT( sizeof(struct get_window_info_reply) == 40 );
+C_ASSERT( FIELD_OFFSET(struct get_window_info_reply, locator) == 40 );
+C_ASSERT( sizeof(struct get_window_info_reply) == 56 );
 C_ASSERT( FIELD_OFFSET(struct set_window_info_request, flags) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_window_info_request, is_unicode) == 14 );
 C_ASSERT( FIELD_OFFSET(struct set_window_info_request, handle) == 16 );
@@ -2225,6 +2249,23 @@ C_ASSERT( FIELD_OFFSET(struct query_completion_request, handle) == 12 );
 C_ASSERT( sizeof(struct query_completion_request) == 16 );
 C_ASSERT( FIELD_OFFSET(struct query_completion_reply, depth) == 8 );
 C_ASSERT( sizeof(struct query_completion_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_wait_completion_packet_request, access) == 12 );
+C_ASSERT( sizeof(struct create_wait_completion_packet_request) == 16 );
+C_ASSERT( FIELD_OFFSET(struct create_wait_completion_packet_reply, handle) == 8 );
+C_ASSERT( sizeof(struct create_wait_completion_packet_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct associate_wait_completion_packet_request, packet) == 12 );
+C_ASSERT( FIELD_OFFSET(struct associate_wait_completion_packet_request, completion) == 16 );
+C_ASSERT( FIELD_OFFSET(struct associate_wait_completion_packet_request, target) == 20 );
+C_ASSERT( FIELD_OFFSET(struct associate_wait_completion_packet_request, ckey) == 24 );
+C_ASSERT( FIELD_OFFSET(struct associate_wait_completion_packet_request, cvalue) == 32 );
+C_ASSERT( FIELD_OFFSET(struct associate_wait_completion_packet_request, information) == 40 );
+C_ASSERT( FIELD_OFFSET(struct associate_wait_completion_packet_request, status) == 48 );
+C_ASSERT( sizeof(struct associate_wait_completion_packet_request) == 56 );
+C_ASSERT( FIELD_OFFSET(struct associate_wait_completion_packet_reply, signaled) == 8 );
+C_ASSERT( sizeof(struct associate_wait_completion_packet_reply) == 16 );
+C_ASSERT( FIELD_OFFSET(struct cancel_wait_completion_packet_request, packet) == 12 );
+C_ASSERT( FIELD_OFFSET(struct cancel_wait_completion_packet_request, remove_signaled) == 16 );
+C_ASSERT( sizeof(struct cancel_wait_completion_packet_request) == 24 );
 C_ASSERT( FIELD_OFFSET(struct set_completion_info_request, handle) == 12 );
 C_ASSERT( FIELD_OFFSET(struct set_completion_info_request, ckey) == 16 );
 C_ASSERT( FIELD_OFFSET(struct set_completion_info_request, chandle) == 24 );
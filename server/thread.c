@@ -67,6 +67,8 @@ struct thread_wait
     abstime_t               when;
     struct timeout_user    *user;
     int                     status;     /* status to return (unless STATUS_PENDING) */
+    wait_notify_t           notify;     /* callback for waits that don't block the thread */
+    void                   *private;    /* private data for the callback */
     struct wait_queue_entry queues[1];
 };
 
@@ -246,6 +248,7 @@ static inline void init_thread_structure( struct thread *thread )
     thread->token           = NULL;
     thread->desc            = NULL;
     thread->desc_len        = 0;
+    thread->fsync_idx       = 0;
 
     thread->creation_time = current_time;
     thread->exit_time     = 0;
@@ -790,6 +793,7 @@ static int wait_on( const select_op_t *select_op, unsigned int count, struct obj
     wait->user    = NULL;
     wait->when = when;
     wait->abandoned = 0;
+    wait->notify  = NULL;
     current->wait = wait;
 
     for (i = 0, entry = wait->queues; i < count; i++, entry++)
@@ -829,6 +833,19 @@ static int wait_on_handles( const select_op_t *select_op, unsigned int count, co
     return ret;
 }
 
+/* take all the fsync objects of a wait-all, or none of them */
+static int acquire_wait_all( struct thread_wait *wait )
+{
+    struct wait_queue_entry *entry;
+    int i;
+
+    for (i = 0, entry = wait->queues; i < wait->count; i++, entry++)
+        if (!fsync_acquire( entry )) break;
+    if (i == wait->count) return 1;
+    while (i--) fsync_release( --entry );
+    return 0;
+}
+
 /* check if the thread waiting condition is satisfied */
 static int check_wait( struct thread *thread )
 {
@@ -851,12 +868,12 @@ static int check_wait( struct thread *thread )
          * want to do something when signaled, even if others are not */
         for (i = 0, entry = wait->queues; i < wait->count; i++, entry++)
             not_ok |= !entry->obj->ops->signaled( entry->obj, entry );
-        if (!not_ok) return STATUS_WAIT_0;
+        if (!not_ok && acquire_wait_all( wait )) return STATUS_WAIT_0;
     }
     else
     {
         for (i = 0, entry = wait->queues; i < wait->count; i++, entry++)
-            if (entry->obj->ops->signaled( entry->obj, entry )) return i;
+            if (entry->obj->ops->signaled( entry->obj, entry ) && fsync_acquire( entry )) return i;
     }
 
     if ((wait->flags & SELECT_ALERTABLE) && !list_empty(&thread->user_apc)) return STATUS_USER_APC;
@@ -932,6 +949,7 @@ int wake_thread_queue_entry( struct wait_queue_entry *entry )
     if (thread->process->suspend + thread->suspend > 0) return 0;  /* cannot acquire locks */
 
     assert( wait->select != SELECT_WAIT_ALL );
+    if (!fsync_acquire( entry )) return 0;  /* a client took it first */
 
     cookie = wait->cookie;
     signaled = end_wait( thread, entry - wait->queues );
@@ -1057,6 +1075,71 @@ static int select_on( const select_op_t *select_op, data_size_t op_size, client_
     return 0;
 }
 
+/* end a notification wait if its object is signaled; return 1 if it ended */
+static int end_notify_wait( struct thread_wait *wait )
+{
+    struct wait_queue_entry *entry = wait->queues;
+    struct object *obj = entry->obj;
+    unsigned int status = STATUS_WAIT_0;
+
+    if (!obj->ops->signaled( obj, entry ) || !fsync_acquire( entry )) return 0;
+
+    obj->ops->satisfied( obj, entry );
+    if (wait->abandoned) status = STATUS_ABANDONED_WAIT_0;
+    obj->ops->remove_queue( obj, entry );
+    release_object( wait->thread );
+    wait->notify( wait->private, status );
+    free( wait );
+    return 1;
+}
+
+/* wait for a single object on behalf of a thread without blocking it; the notify
+ * callback is called once the object has been signaled and the wait satisfied */
+/* return the wait, or NULL if it already ended or on error */
+struct thread_wait *create_notify_wait( struct thread *thread, struct object *obj,
+                                        wait_notify_t notify, void *private )
+{
+    struct thread_wait *wait;
+    struct wait_queue_entry *entry;
+
+    if (!(wait = mem_alloc( sizeof(*wait) ))) return NULL;
+    wait->next      = NULL;
+    wait->thread    = (struct thread *)grab_object( thread );
+    wait->count     = 1;
+    wait->flags     = 0;
+    wait->select    = SELECT_WAIT;
+    wait->key       = 0;
+    wait->cookie    = 0;
+    wait->user      = NULL;
+    wait->when      = TIMEOUT_INFINITE;
+    wait->abandoned = 0;
+    wait->status    = STATUS_WAIT_0;
+    wait->notify    = notify;
+    wait->private   = private;
+
+    entry = wait->queues;
+    entry->wait = wait;
+    if (!obj->ops->add_queue( obj, entry ))
+    {
+        release_object( thread );
+        free( wait );
+        return NULL;
+    }
+    if (end_notify_wait( wait )) return NULL;
+    return wait;
+}
+
+/* cancel a notification wait that didn't end yet */
+void cancel_notify_wait( struct thread_wait *wait )
+{
+    struct wait_queue_entry *entry = wait->queues;
+
+    assert( wait->notify );
+    entry->obj->ops->remove_queue( entry->obj, entry );
+    release_object( wait->thread );
+    free( wait );
+}
+
 /* attempt to wake threads sleeping on the object wait queue */
 void wake_up( struct object *obj, int max )
 {
@@ -1066,7 +1149,9 @@ void wake_up( struct object *obj, int max )
     LIST_FOR_EACH( ptr, &obj->wait_queue )
     {
         struct wait_queue_entry *entry = LIST_ENTRY( ptr, struct wait_queue_entry, entry );
-        if (!(ret = wake_thread( get_wait_queue_thread( entry )))) continue;
+        if (entry->wait->notify) ret = end_notify_wait( entry->wait );
+        else ret = wake_thread( get_wait_queue_thread( entry ));
+        if (!ret) continue;
         if (ret > 0 && max && !--max) break;
         /* restart at the head of the list since a wake up can change the object wait queue */
         ptr = &obj->wait_queue;
@@ -1289,6 +1374,8 @@ void kill_thread( struct thread *thread, int violent_death )
     }
     kill_console_processes( thread, 0 );
     abandon_mutexes( thread );
+    fsync_free_thread( thread->fsync_idx );
+    thread->fsync_idx = 0;
     wake_up( &thread->obj, 0 );
     if (violent_death) send_thread_signal( thread, SIGQUIT );
     cleanup_thread( thread );
@@ -55,6 +55,7 @@ struct thread
     struct process        *process;
     thread_id_t            id;            /* thread id */
     struct list            mutex_list;    /* list of currently owned mutexes */
+    unsigned int           fsync_idx;     /* index of the fsync thread record */
     unsigned int           system_regs;   /* which system regs have been set */
     struct msg_queue      *queue;         /* message queue */
     struct thread_wait    *wait;          /* current wait condition if sleeping */
@@ -95,6 +96,8 @@ struct thread
 
 extern struct thread *current;
 
+typedef void (*wait_notify_t)( void *private, unsigned int status );
+
 /* thread functions */
 
 extern struct thread *create_thread( int fd, struct process *process,
@@ -115,6 +118,9 @@ extern int add_queue( struct object *obj, struct wait_queue_entry *entry );
 extern void remove_queue( struct object *obj, struct wait_queue_entry *entry );
 extern void kill_thread( struct thread *thread, int violent_death );
 extern void wake_up( struct object *obj, int max );
+extern struct thread_wait *create_notify_wait( struct thread *thread, struct object *obj,
+                                               wait_notify_t notify, void *private );
+extern void cancel_notify_wait( struct thread_wait *wait );
 extern int thread_queue_apc( struct process *process, struct thread *thread, struct object *owner, const apc_call_t *call_data );
 extern void thread_cancel_apc( struct thread *thread, struct object *owner, enum apc_type type );
 extern int thread_add_inflight_fd( struct thread *thread, int client, int server );